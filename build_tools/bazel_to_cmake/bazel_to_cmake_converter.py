@@ -288,6 +288,13 @@ class BuildFileFunctions(object):
     def py_binary(self, *args, **kwargs):
         pass
 
+    # Generated files have no general mapping and must be skipped with CMake
+    # equivalents provided through iree_cmake_extra_content.
+    def genrule(self, name, **kwargs):
+        if self._should_skip_target(**kwargs):
+            return
+        self._convert_unimplemented_function("genrule", name)
+
     def filegroup(self, name, srcs, **kwargs):
         if not srcs:
             return
@@ -629,7 +636,10 @@ class BuildFileFunctions(object):
         static_lib_path=None,
         deps=None,
         testonly=None,
+        **kwargs,
     ):
+        if self._should_skip_target(**kwargs):
+            return
         name_block = self._convert_string_arg_block("NAME", name, quote=False)
         src_block = self._convert_string_arg_block("SRC", src)
         module_name_block = self._convert_string_arg_block(
@@ -4627,6 +4627,11 @@ void populateVMToEmitCPatterns(ConversionTarget &conversionTarget,
                         DenseSet<size_t>({0}), true);
   ADD_CONTAINER_PATTERN(IREE::VM::BufferHashOp, "iree_vm_buffer_hash",
                         DenseSet<size_t>({0}), true);
+  ADD_CONTAINER_PATTERN(IREE::VM::ListCopyFromBufferOp,
+                        "vm_list_copy_from_buffer", DenseSet<size_t>({0, 2}),
+                        true);
+  ADD_CONTAINER_PATTERN(IREE::VM::ListCopyToBufferOp, "vm_list_copy_to_buffer",
+                        DenseSet<size_t>({0, 2}), true);
   ADD_CONTAINER_PATTERN(IREE::VM::ListReserveOp, "iree_vm_list_reserve",
                         DenseSet<size_t>({0}), true);
   ADD_CONTAINER_PATTERN(IREE::VM::ListResizeOp, "iree_vm_list_resize",
@@ -124,3 +124,18 @@ vm.module @my_module {
     vm.return
   }
 }
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: emitc.func private @my_module_list_copy_to_buffer
+  vm.func @list_copy_to_buffer(%arg0: !vm.list<i32>, %arg1: i32, %arg2: !vm.buffer, %arg3: i64) {
+    // CHECK-NEXT: %0 = emitc.apply "*"(%arg3) : (!emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>) -> !emitc.opaque<"iree_vm_ref_t">
+    // CHECK-NEXT: %1 = emitc.call_opaque "iree_vm_list_deref"(%0) : (!emitc.opaque<"iree_vm_ref_t">) -> !emitc.ptr<!emitc.opaque<"iree_vm_list_t">>
+    // CHECK: %[[BUFFER_REF:.+]] = emitc.apply "*"(%arg5) : (!emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>) -> !emitc.opaque<"iree_vm_ref_t">
+    // CHECK-NEXT: %[[BUFFER_PTR:.+]] = emitc.call_opaque "iree_vm_buffer_deref"(%[[BUFFER_REF]]) : (!emitc.opaque<"iree_vm_ref_t">) -> !emitc.ptr<!emitc.opaque<"iree_vm_buffer_t">>
+    // CHECK: %{{.+}} = emitc.call_opaque "vm_list_copy_to_buffer"(%1, %arg4, %[[BUFFER_PTR]], %arg6, %arg4) : (!emitc.ptr<!emitc.opaque<"iree_vm_list_t">>, i32, !emitc.ptr<!emitc.opaque<"iree_vm_buffer_t">>, i64, i32) -> !emitc.opaque<"iree_status_t">
+    vm.list.copy.to.buffer %arg0, %arg1, %arg2, %arg3, %arg1 : !vm.list<i32> -> !vm.buffer
+    vm.return
+  }
+}
@@ -124,3 +124,23 @@ vm.module @module {
     vm.return
   }
 }
+
+// -----
+
+// Bulk copies between primitive lists and buffers.
+vm.module @module {
+  // CHECK-LABEL: @list_copy_buffer
+  vm.func @list_copy_buffer(%arg0: !vm.list<i32>, %arg1: !vm.buffer) {
+    %c0 = vm.const.i32 0
+    %c8 = vm.const.i32 8
+    %c16 = vm.const.i64 16
+
+    // CHECK: vm.list.copy.to.buffer %arg0, %c0, %arg1, %c16, %c8 : !vm.list<i32> -> !vm.buffer
+    vm.list.copy.to.buffer %arg0, %c0, %arg1, %c16, %c8 : !vm.list<i32> -> !vm.buffer
+
+    // CHECK: vm.list.copy.from.buffer %arg1, %c16, %arg0, %c0, %c8 : !vm.buffer -> !vm.list<i32>
+    vm.list.copy.from.buffer %arg1, %c16, %arg0, %c0, %c8 : !vm.buffer -> !vm.list<i32>
+
+    vm.return
+  }
+}
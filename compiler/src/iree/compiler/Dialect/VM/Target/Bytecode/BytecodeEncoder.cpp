@@ -354,10 +354,167 @@ private:
 
 } // namespace
 
+//===----------------------------------------------------------------------===//
+// Superinstruction fusion
+//===----------------------------------------------------------------------===//
+// Common op sequences are encoded as a single fused op to reduce the number of
+// dispatches performed by the interpreter. The fused ops have no equivalent in
+// the IR and are only produced here. Each fusion reuses the register assignment
+// of the original ops and only elides registers that have no other uses.
+
+namespace {
+struct FusedOpcode {
+  StringRef name;
+  Opcode opcode;
+};
+} // namespace
+
+// Returns the fused compare-and-branch opcode for the comparison |op|, if any.
+static std::optional<FusedOpcode> getCondBranchCmpOpcode(Operation *op) {
+  if (isa<IREE::VM::CmpEQI32Op>(op))
+    return FusedOpcode{"CondBranchCmpEQI32", Opcode::CondBranchCmpEQI32};
+  if (isa<IREE::VM::CmpNEI32Op>(op))
+    return FusedOpcode{"CondBranchCmpNEI32", Opcode::CondBranchCmpNEI32};
+  if (isa<IREE::VM::CmpLTI32SOp>(op))
+    return FusedOpcode{"CondBranchCmpLTI32S", Opcode::CondBranchCmpLTI32S};
+  if (isa<IREE::VM::CmpLTI32UOp>(op))
+    return FusedOpcode{"CondBranchCmpLTI32U", Opcode::CondBranchCmpLTI32U};
+  if (isa<IREE::VM::CmpEQI64Op>(op))
+    return FusedOpcode{"CondBranchCmpEQI64", Opcode::CondBranchCmpEQI64};
+  if (isa<IREE::VM::CmpNEI64Op>(op))
+    return FusedOpcode{"CondBranchCmpNEI64", Opcode::CondBranchCmpNEI64};
+  if (isa<IREE::VM::CmpLTI64SOp>(op))
+    return FusedOpcode{"CondBranchCmpLTI64S", Opcode::CondBranchCmpLTI64S};
+  if (isa<IREE::VM::CmpLTI64UOp>(op))
+    return FusedOpcode{"CondBranchCmpLTI64U", Opcode::CondBranchCmpLTI64U};
+  return std::nullopt;
+}
+
+// Fuses a comparison whose only use is the condition of the immediately
+// following vm.cond_br:
+//   %cmp = vm.cmp.lt.i32.s %lhs, %rhs : i32
+//   vm.cond_br %cmp, ^bb1(...), ^bb2(...)
+// The comparison result is never materialized in a register.
+static FailureOr<int> encodeCondBranchCmp(Operation *op,
+                                          V0BytecodeEncoder &encoder) {
+  auto fusedOpcode = getCondBranchCmpOpcode(op);
+  if (!fusedOpcode)
+    return 0;
+  auto condBranchOp =
+      dyn_cast_or_null<IREE::VM::CondBranchOp>(op->getNextNode());
+  if (!condBranchOp || !op->getResult(0).hasOneUse() ||
+      condBranchOp.getCondition() != op->getResult(0)) {
+    return 0;
+  }
+  if (failed(encoder.beginOp(op)) ||
+      failed(encoder.encodeOpcode(fusedOpcode->name,
+                                  static_cast<int>(fusedOpcode->opcode))) ||
+      failed(encoder.encodeOperand(op->getOperand(0), 0)) ||
+      failed(encoder.encodeOperand(op->getOperand(1), 1)) ||
+      failed(encoder.endOp(op))) {
+    return failure();
+  }
+  if (failed(encoder.beginOp(condBranchOp)) ||
+      failed(encoder.encodeBranch(condBranchOp.getTrueDest(),
+                                  condBranchOp.getTrueDestOperands(), 0)) ||
+      failed(encoder.encodeBranch(condBranchOp.getFalseDest(),
+                                  condBranchOp.getFalseDestOperands(), 1)) ||
+      failed(encoder.endOp(condBranchOp))) {
+    return failure();
+  }
+  return 2;
+}
+
+// Fuses a load-add-store sequence on the same global:
+//   %0 = vm.global.load.i32 @g : i32
+//   %1 = vm.add.i32 %0, %addend : i32
+//   vm.global.store.i32 %1, @g : i32
+// The loaded value is never materialized in a register but the sum is as it
+// may have other uses.
+template <typename LoadOpT, typename AddOpT, typename StoreOpT>
+static FailureOr<int> encodeGlobalAdd(Operation *op, StringRef name,
+                                      Opcode opcode, SymbolTable &symbolTable,
+                                      V0BytecodeEncoder &encoder) {
+  auto loadOp = dyn_cast<LoadOpT>(op);
+  if (!loadOp || !loadOp.getResult().hasOneUse())
+    return 0;
+  auto addOp = dyn_cast_or_null<AddOpT>(loadOp->getNextNode());
+  if (!addOp)
+    return 0;
+  auto storeOp = dyn_cast_or_null<StoreOpT>(addOp->getNextNode());
+  if (!storeOp || storeOp.getValue() != addOp.getResult() ||
+      storeOp.getGlobal() != loadOp.getGlobal()) {
+    return 0;
+  }
+  int addendOrdinal = 0;
+  if (addOp.getLhs() == loadOp.getResult()) {
+    addendOrdinal = 1;
+  } else if (addOp.getRhs() != loadOp.getResult()) {
+    return 0;
+  }
+  if (failed(encoder.beginOp(addOp)) ||
+      failed(encoder.encodeOpcode(name, static_cast<int>(opcode))) ||
+      failed(encoder.encodeSymbolOrdinal(symbolTable, loadOp.getGlobal())) ||
+      failed(encoder.encodeOperand(addOp->getOperand(addendOrdinal),
+                                   addendOrdinal)) ||
+      failed(encoder.encodeResult(addOp.getResult())) ||
+      failed(encoder.endOp(addOp))) {
+    return failure();
+  }
+  return 3;
+}
+
+// Marks a call immediately followed by the unconditional branch consuming its
+// results:
+//   %0 = vm.call @fn(...)
+//   vm.br ^bb1(%0 : i32)
+// The call is encoded as usual but with the CallBranch opcode and the branch is
+// left to be encoded as its own op. The runtime executes the branch inline
+// after calls that complete synchronously.
+static FailureOr<int> encodeCallBranch(Operation *op, SymbolTable &symbolTable,
+                                       V0BytecodeEncoder &encoder) {
+  auto callOp = dyn_cast<IREE::VM::CallOp>(op);
+  if (!callOp || !isa_and_nonnull<IREE::VM::BranchOp>(op->getNextNode())) {
+    return 0;
+  }
+  if (failed(encoder.beginOp(callOp)) ||
+      failed(encoder.encodeOpcode("CallBranch",
+                                  static_cast<int>(Opcode::CallBranch))) ||
+      failed(encoder.encodeSymbolOrdinal(symbolTable, callOp.getCallee())) ||
+      failed(encoder.encodeOperands(callOp.getOperands())) ||
+      failed(encoder.encodeResults(callOp.getResults())) ||
+      failed(encoder.endOp(callOp))) {
+    return failure();
+  }
+  return 1;
+}
+
+// Encodes a superinstruction starting at |op| if possible.
+// Returns the number of ops consumed or 0 if no fusion was performed.
+static FailureOr<int> encodeSuperinstruction(Operation *op,
+                                             SymbolTable &symbolTable,
+                                             V0BytecodeEncoder &encoder) {
+  FailureOr<int> consumed = encodeCondBranchCmp(op, encoder);
+  if (failed(consumed) || *consumed)
+    return consumed;
+  consumed = encodeGlobalAdd<IREE::VM::GlobalLoadI32Op, IREE::VM::AddI32Op,
+                             IREE::VM::GlobalStoreI32Op>(
+      op, "GlobalAddI32", Opcode::GlobalAddI32, symbolTable, encoder);
+  if (failed(consumed) || *consumed)
+    return consumed;
+  consumed = encodeGlobalAdd<IREE::VM::GlobalLoadI64Op, IREE::VM::AddI64Op,
+                             IREE::VM::GlobalStoreI64Op>(
+      op, "GlobalAddI64", Opcode::GlobalAddI64, symbolTable, encoder);
+  if (failed(consumed) || *consumed)
+    return consumed;
+  return encodeCallBranch(op, symbolTable, encoder);
+}
+
 // static
 std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
     IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-    SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase) {
+    SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase,
+    bool emitSuperinstructions) {
   EncodedBytecodeFunction result;
 
   // Perform register allocation first so that we can quickly lookup values as
@@ -380,7 +537,8 @@ std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       return std::nullopt;
     }
 
-    for (auto &op : block.getOperations()) {
+    for (auto it = block.begin(); it != block.end(); ++it) {
+      Operation &op = *it;
       auto serializableOp = dyn_cast<IREE::VM::VMSerializableOp>(op);
       if (!serializableOp) {
         if (op.hasTrait<OpTrait::IREE::VM::AssignmentOp>()) {
@@ -392,6 +550,29 @@ std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       }
       sourceMap.locations.push_back(
           {static_cast<int32_t>(encoder.getOffset()), op.getLoc()});
+      if (emitSuperinstructions) {
+        FailureOr<int> consumed =
+            encodeSuperinstruction(&op, symbolTable, encoder);
+        if (failed(consumed)) {
+          op.emitOpError() << "failed to encode superinstruction";
+          return std::nullopt;
+        }
+        if (*consumed > 0) {
+          // The fused op covers all consumed ops and its source map entry
+          // carries all of their locations (such as the cond_br of a fused
+          // compare-and-branch).
+          if (*consumed > 1) {
+            SmallVector<Location> fusedLocs;
+            for (int i = 0; i < *consumed; ++i, ++it) {
+              fusedLocs.push_back(it->getLoc());
+            }
+            --it;
+            sourceMap.locations.back().location =
+                FusedLoc::get(funcOp.getContext(), fusedLocs);
+          }
+          continue;
+        }
+      }
       if (failed(encoder.beginOp(&op)) ||
           failed(serializableOp.encode(symbolTable, encoder)) ||
           failed(encoder.endOp(&op))) {
@@ -48,6 +48,9 @@ struct BytecodeTargetOptions {
   // Strips vm ops with the VM_DebugOnly trait.
   bool stripDebugOps = false;
 
+  // Fuses common op sequences into superinstructions during encoding.
+  bool emitSuperinstructions = true;
+
   // Enables the output .vmfb to be inspected as a ZIP file.
   // This is useful for debugging/diagnosing issues as embedded executables can
   // be extracted and inspected. It adds several KB to the output files and
@@ -281,6 +281,18 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_EXECUTION_TRACING_SRC_LOC_ENABLE 0
 #endif  // !IREE_VM_EXECUTION_TRACING_SRC_LOC_ENABLE
 
+#if !defined(IREE_VM_EXECUTION_PROFILING_ENABLE)
+// Enables support for counting function calls, block executions, and time
+// spent in imports in the bytecode dispatcher. Counting is only performed for
+// modules that opt in with IREE_VM_BYTECODE_MODULE_FLAG_PROFILE_EXECUTION but
+// when compiled in all calls and branches must check whether it is enabled.
+#ifndef NDEBUG
+#define IREE_VM_EXECUTION_PROFILING_ENABLE 1
+#else
+#define IREE_VM_EXECUTION_PROFILING_ENABLE 0
+#endif  // NDEBUG
+#endif  // !IREE_VM_EXECUTION_PROFILING_ENABLE
+
 #if !defined(IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE)
 // Enables the use of compute goto for bytecode dispatch. This can have a
 // moderate performance improvement (~10-20%) on very heavy VMVX workloads but
@@ -295,6 +307,21 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_BYTECODE_VERIFICATION_ENABLE 1
 #endif  // !IREE_VM_BYTECODE_VERIFICATION_ENABLE
 
+#if !defined(IREE_VM_BYTECODE_JIT_ENABLE)
+// Enables the template compiler that translates verified bytecode functions
+// into native code for the host at module load. Only a subset of ops are
+// compiled and functions fall back to the interpreter for the rest. Requires
+// IREE_VM_BYTECODE_VERIFICATION_ENABLE and a platform that allows allocating
+// executable pages; has no effect on architectures other than x86-64/arm64.
+#define IREE_VM_BYTECODE_JIT_ENABLE 0
+#endif  // !IREE_VM_BYTECODE_JIT_ENABLE
+
+#if !defined(IREE_VM_BYTECODE_JIT_ARM_64_ENABLE)
+// Enables the arm64 templates of the bytecode JIT. They are not yet exercised
+// by CI and arm64 hosts interpret all functions unless this is set.
+#define IREE_VM_BYTECODE_JIT_ARM_64_ENABLE 0
+#endif  // !IREE_VM_BYTECODE_JIT_ARM_64_ENABLE
+
 #if !defined(IREE_VM_EXT_F32_ENABLE)
 // Enables the 32-bit floating-point instruction extension.
 // Targeted from the compiler with `-iree-vm-target-extension-f32`.
@@ -159,3 +159,336 @@ void iree_memory_flush_icache(void* base_address, iree_host_size_t length) {
 }
 
 #endif  // IREE_PLATFORM_*
+
+//===----------------------------------------------------------------------===//
+// NUMA placement
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// From linux/mempolicy.h; we avoid the libnuma numaif.h dependency as we only
+// need the raw syscall.
+#define IREE_MEMORY_MPOL_PREFERRED 1
+
+// Maximum node ID we'll build a mask for. Linux defaults to 1024 nodes max.
+#define IREE_MEMORY_MAX_NODE_COUNT 1024
+
+// From linux/mempolicy.h.
+#define IREE_MEMORY_MPOL_MF_MOVE (1 << 1)
+
+// Applies a preferred placement policy on |node_id| to the pages in the given
+// page-aligned range. Failure leaves the existing policy in place.
+static void iree_memory_node_mbind(void* base_address, iree_host_size_t length,
+                                   uint32_t node_id, unsigned int flags) {
+#if defined(SYS_mbind)
+  if (node_id >= IREE_MEMORY_MAX_NODE_COUNT) return;
+  const iree_host_size_t bits_per_word = sizeof(unsigned long) * 8;
+  unsigned long node_mask[IREE_MEMORY_MAX_NODE_COUNT /
+                          (sizeof(unsigned long) * 8)] = {0};
+  node_mask[node_id / bits_per_word] = 1ul << (node_id % bits_per_word);
+  // NOTE: the kernel reads maxnode-1 bits from the mask.
+  syscall(SYS_mbind, base_address, length, IREE_MEMORY_MPOL_PREFERRED,
+          node_mask, (unsigned long)node_id + 2, flags);
+#endif  // SYS_mbind
+}
+
+iree_status_t iree_memory_node_allocate(iree_host_size_t length,
+                                        uint32_t node_id,
+                                        void** out_base_address) {
+  *out_base_address = NULL;
+  void* base_address = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base_address == MAP_FAILED) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "mmap of %" PRIhsz " bytes failed", length);
+  }
+
+  // The mapping has no pages yet so the policy only affects where they fault
+  // in and no migration is needed.
+  iree_memory_node_mbind(base_address, length, node_id, 0);
+
+  *out_base_address = base_address;
+  return iree_ok_status();
+}
+
+void iree_memory_node_bind(void* base_address, iree_host_size_t length,
+                           uint32_t node_id) {
+  // Only whole pages within the range are bound so that neighboring memory we
+  // don't own is left alone.
+  const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+  const uintptr_t range_begin =
+      ((uintptr_t)base_address + page_size - 1) & ~(page_size - 1);
+  const uintptr_t range_end =
+      ((uintptr_t)base_address + length) & ~(page_size - 1);
+  if (range_end <= range_begin) return;
+  iree_memory_node_mbind((void*)range_begin, range_end - range_begin, node_id,
+                         IREE_MEMORY_MPOL_MF_MOVE);
+}
+
+void iree_memory_node_free(void* base_address, iree_host_size_t length) {
+  if (base_address) munmap(base_address, length);
+}
+
+#elif defined(IREE_PLATFORM_WINDOWS)
+
+iree_status_t iree_memory_node_allocate(iree_host_size_t length,
+                                        uint32_t node_id,
+                                        void** out_base_address) {
+  *out_base_address = NULL;
+  void* base_address =
+      VirtualAllocExNuma(GetCurrentProcess(), NULL, length,
+                         MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node_id);
+  if (!base_address) {
+    // The node may not exist; fall back to unplaced memory.
+    base_address =
+        VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  }
+  if (!base_address) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "VirtualAlloc of %" PRIhsz " bytes failed",
+                            length);
+  }
+  *out_base_address = base_address;
+  return iree_ok_status();
+}
+
+void iree_memory_node_free(void* base_address, iree_host_size_t length) {
+  if (base_address) VirtualFree(base_address, 0, MEM_RELEASE);
+}
+
+void iree_memory_node_bind(void* base_address, iree_host_size_t length,
+                           uint32_t node_id) {
+  // Windows has no API for moving already-committed pages between nodes.
+}
+
+#else
+
+iree_status_t iree_memory_node_allocate(iree_host_size_t length,
+                                        uint32_t node_id,
+                                        void** out_base_address) {
+  *out_base_address = NULL;
+  return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+}
+
+void iree_memory_node_free(void* base_address, iree_host_size_t length) {}
+
+void iree_memory_node_bind(void* base_address, iree_host_size_t length,
+                           uint32_t node_id) {}
+
+#endif  // IREE_PLATFORM_*
+
+//===----------------------------------------------------------------------===//
+// Page residency
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+
+#include <errno.h>
+#include <sys/mman.h>
+
+// Number of pages queried per mincore call to bound stack usage.
+#define IREE_MEMORY_RESIDENCY_PAGE_BATCH 1024
+
+iree_status_t iree_memory_query_resident_length(
+    const void* base_address, iree_host_size_t length,
+    iree_host_size_t* out_resident_length) {
+  *out_resident_length = 0;
+  if (!length) return iree_ok_status();
+
+  const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+  const uintptr_t range_begin = (uintptr_t)base_address & ~(page_size - 1);
+  const uintptr_t range_end =
+      ((uintptr_t)base_address + length + page_size - 1) & ~(page_size - 1);
+
+  // Darwin declares the vector as char* and Linux as unsigned char*.
+#if defined(IREE_PLATFORM_APPLE)
+  char page_states[IREE_MEMORY_RESIDENCY_PAGE_BATCH];
+#else
+  unsigned char page_states[IREE_MEMORY_RESIDENCY_PAGE_BATCH];
+#endif  // IREE_PLATFORM_APPLE
+  iree_host_size_t resident_page_count = 0;
+  for (uintptr_t p = range_begin; p < range_end;) {
+    const uintptr_t batch_length =
+        iree_min(range_end - p, IREE_MEMORY_RESIDENCY_PAGE_BATCH * page_size);
+    if (mincore((void*)p, batch_length, page_states) != 0) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "mincore of %" PRIhsz " bytes failed",
+                              (iree_host_size_t)batch_length);
+    }
+    const iree_host_size_t batch_page_count = batch_length / page_size;
+    for (iree_host_size_t i = 0; i < batch_page_count; ++i) {
+      resident_page_count += page_states[i] & 1;
+    }
+    p += batch_length;
+  }
+
+  *out_resident_length =
+      iree_min(length, (iree_host_size_t)(resident_page_count * page_size));
+  return iree_ok_status();
+}
+
+iree_status_t iree_memory_reclaim(void* base_address, iree_host_size_t length) {
+#if defined(MADV_PAGEOUT)
+  // Only reclaim whole pages within the range.
+  const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+  const uintptr_t range_begin =
+      ((uintptr_t)base_address + page_size - 1) & ~(page_size - 1);
+  const uintptr_t range_end =
+      ((uintptr_t)base_address + length) & ~(page_size - 1);
+  if (range_end <= range_begin) return iree_ok_status();
+
+  // NOTE: MADV_DONTNEED would be cheaper but drops the contents of anonymous
+  // and private mappings; MADV_PAGEOUT preserves them for all mapping types.
+  if (madvise((void*)range_begin, range_end - range_begin, MADV_PAGEOUT) != 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "madvise(MADV_PAGEOUT) failed");
+  }
+  return iree_ok_status();
+#else
+  return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+#endif  // MADV_PAGEOUT
+}
+
+#else
+
+iree_status_t iree_memory_query_resident_length(
+    const void* base_address, iree_host_size_t length,
+    iree_host_size_t* out_resident_length) {
+  *out_resident_length = 0;
+  return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+}
+
+iree_status_t iree_memory_reclaim(void* base_address, iree_host_size_t length) {
+  return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+}
+
+#endif  // IREE_PLATFORM_*
+
+//===----------------------------------------------------------------------===//
+// Executable code pages
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+
+#include <errno.h>
+#include <sys/mman.h>
+
+#if defined(IREE_PLATFORM_APPLE) && defined(MAP_JIT)
+
+// Hardened runtimes only allow executable pages mapped with MAP_JIT and do not
+// allow them to be remapped. Pages are mapped RWX up front and writes are
+// toggled per-thread by iree_memory_jit_context_begin/end.
+
+iree_status_t iree_memory_executable_allocate(iree_host_size_t length,
+                                              void** out_base_address) {
+  *out_base_address = NULL;
+  void* base_address =
+      mmap(NULL, length, PROT_READ | PROT_WRITE | PROT_EXEC,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_JIT, -1, 0);
+  if (base_address == MAP_FAILED) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "mmap of %" PRIhsz " JIT code bytes failed",
+                            length);
+  }
+  *out_base_address = base_address;
+  return iree_ok_status();
+}
+
+iree_status_t iree_memory_executable_seal(void* base_address,
+                                          iree_host_size_t length) {
+  // Ensures the calling thread has write protection enabled even if the caller
+  // did not write the pages within a JIT context.
+  iree_memory_jit_context_end();
+  iree_memory_flush_icache(base_address, length);
+  return iree_ok_status();
+}
+
+#else
+
+iree_status_t iree_memory_executable_allocate(iree_host_size_t length,
+                                              void** out_base_address) {
+  *out_base_address = NULL;
+  void* base_address = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base_address == MAP_FAILED) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "mmap of %" PRIhsz " code bytes failed", length);
+  }
+  *out_base_address = base_address;
+  return iree_ok_status();
+}
+
+iree_status_t iree_memory_executable_seal(void* base_address,
+                                          iree_host_size_t length) {
+  if (mprotect(base_address, length, PROT_READ | PROT_EXEC) != 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "mprotect of code pages to RX failed");
+  }
+  iree_memory_flush_icache(base_address, length);
+  return iree_ok_status();
+}
+
+#endif  // IREE_PLATFORM_APPLE && MAP_JIT
+
+void iree_memory_executable_free(void* base_address, iree_host_size_t length) {
+  if (base_address) munmap(base_address, length);
+}
+
+#elif defined(IREE_PLATFORM_WINDOWS)
+
+iree_status_t iree_memory_executable_allocate(iree_host_size_t length,
+                                              void** out_base_address) {
+  *out_base_address = NULL;
+  if (!(iree_memory_query_info().supported_features &
+        IREE_MEMORY_FEATURE_ALLOCATABLE_EXECUTABLE_PAGES)) {
+    return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+  }
+  void* base_address =
+      VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  if (!base_address) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "VirtualAlloc of %" PRIhsz " code bytes failed",
+                            length);
+  }
+  *out_base_address = base_address;
+  return iree_ok_status();
+}
+
+iree_status_t iree_memory_executable_seal(void* base_address,
+                                          iree_host_size_t length) {
+  DWORD old_protect = 0;
+  if (!VirtualProtect(base_address, length, PAGE_EXECUTE_READ, &old_protect)) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "VirtualProtect of code pages to RX failed");
+  }
+  iree_memory_flush_icache(base_address, length);
+  return iree_ok_status();
+}
+
+void iree_memory_executable_free(void* base_address, iree_host_size_t length) {
+  if (base_address) VirtualFree(base_address, 0, MEM_RELEASE);
+}
+
+#else
+
+iree_status_t iree_memory_executable_allocate(iree_host_size_t length,
+                                              void** out_base_address) {
+  *out_base_address = NULL;
+  return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+}
+
+iree_status_t iree_memory_executable_seal(void* base_address,
+                                          iree_host_size_t length) {
+  return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+}
+
+void iree_memory_executable_free(void* base_address, iree_host_size_t length) {}
+
+#endif  // IREE_PLATFORM_*
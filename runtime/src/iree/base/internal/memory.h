@@ -68,6 +68,77 @@ void iree_memory_jit_context_end(void);
 // executing code from any pages that have been written during load.
 void iree_memory_flush_icache(void* base_address, iree_host_size_t length);
 
+// Allocates |length| bytes of zeroed read-write memory aligned to the normal
+// page size whose pages are preferentially placed on NUMA memory node
+// |node_id|. The placement policy is applied before any page is touched so
+// that pages are first-faulted on the node and nothing needs to be migrated.
+//
+// Placement is only a hint: the system may still place pages elsewhere if the
+// node is out of memory and platforms without placement APIs return unplaced
+// memory. Callers should allocate large ranges and suballocate from them as
+// each call is a system call that creates a new mapping.
+iree_status_t iree_memory_node_allocate(iree_host_size_t length,
+                                        uint32_t node_id,
+                                        void** out_base_address);
+
+// Frees pages allocated with iree_memory_node_allocate.
+void iree_memory_node_free(void* base_address, iree_host_size_t length);
+
+// Preferentially places the whole pages within the given range on NUMA memory
+// node |node_id|. Pages not yet faulted in will be placed on the node when
+// first touched and pages already resident are migrated if the system is able
+// to (pages shared with other processes are left where they are).
+//
+// Like iree_memory_node_allocate this is only a hint and no errors are
+// reported. Used for memory owned by others such as imported allocations.
+void iree_memory_node_bind(void* base_address, iree_host_size_t length,
+                           uint32_t node_id);
+
+//===----------------------------------------------------------------------===//
+// Page residency
+//===----------------------------------------------------------------------===//
+
+// Queries how many bytes of the given range are backed by pages resident in
+// physical memory. Pages are counted in full if they overlap the range and the
+// result is clamped to |length|. Returns IREE_STATUS_UNAVAILABLE if the
+// platform cannot report residency.
+iree_status_t iree_memory_query_resident_length(
+    const void* base_address, iree_host_size_t length,
+    iree_host_size_t* out_resident_length);
+
+// Advises the system that the pages fully contained within the given range of
+// bytes are not expected to be used soon and may be reclaimed. Contents are
+// preserved: file-backed pages are re-read from their file and anonymous pages
+// are restored from swap (if any) on their next access. Partial pages at the
+// ends of the range are left untouched.
+//
+// This is only a hint and the system may keep the pages resident. Returns
+// IREE_STATUS_UNAVAILABLE if the platform has no way to reclaim pages without
+// discarding their contents.
+iree_status_t iree_memory_reclaim(void* base_address, iree_host_size_t length);
+
+//===----------------------------------------------------------------------===//
+// Executable code pages
+//===----------------------------------------------------------------------===//
+
+// Allocates |length| bytes of zeroed read-write memory aligned to the normal
+// page size that can later be made executable with
+// iree_memory_executable_seal. Returns IREE_STATUS_UNAVAILABLE if the platform
+// does not support allocating executable pages. Writes must be made within an
+// iree_memory_jit_context_begin/end region as on Apple platforms the pages are
+// allocated with MAP_JIT and are only writable by threads within one.
+iree_status_t iree_memory_executable_allocate(iree_host_size_t length,
+                                              void** out_base_address);
+
+// Changes the pages in the given range from read-write to read-execute and
+// flushes the instruction cache. The range must have been allocated with
+// iree_memory_executable_allocate and must not be written afterward.
+iree_status_t iree_memory_executable_seal(void* base_address,
+                                          iree_host_size_t length);
+
+// Frees pages allocated with iree_memory_executable_allocate.
+void iree_memory_executable_free(void* base_address, iree_host_size_t length);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -57,42 +57,6 @@
 #define IREE_DISABLE_THREAD_SAFETY_ANALYSIS \
   IREE_THREAD_ANNOTATION_ATTRIBUTE(no_thread_safety_analysis)
 
-//==============================================================================
-// Cross-platform processor yield (where supported)
-//==============================================================================
-
-#if defined(IREE_COMPILER_MSVC_COMPAT)
-
-// MSVC uses architecture-specific intrinsics.
-
-static inline void iree_processor_yield(void) {
-#if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
-  // https://docs.microsoft.com/en-us/cpp/intrinsics/x86-intrinsics-list
-  _mm_pause();
-#elif defined(IREE_ARCH_ARM_64)
-  // https://docs.microsoft.com/en-us/cpp/intrinsics/arm64-intrinsics
-  __yield();
-#else
-  // None available; we'll spin hard.
-#endif  // IREE_ARCH_*
-}
-
-#else
-
-// Clang/GCC and compatibles use architecture-specific inline assembly.
-
-static inline void iree_processor_yield(void) {
-#if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
-  asm volatile("pause");
-#elif defined(IREE_ARCH_ARM_32) || defined(IREE_ARCH_ARM_64)
-  asm volatile("yield");
-#else
-  // None available; we'll spin hard.
-#endif  // IREE_ARCH_*
-}
-
-#endif  // IREE_COMPILER_*
-
 //==============================================================================
 // Cross-platform futex mappings (where supported)
 //==============================================================================
@@ -191,6 +155,41 @@ static inline void iree_futex_wake(void* address, int32_t count) {
           NULL, 0);
 }
 
+// Linux supports tagging waiters with a bitset such that a single wake can
+// target any subset of the waiters on an address.
+#define IREE_FUTEX_HAS_BITSET 1
+
+// Waits like iree_futex_wait but only wakes when a wake includes any of the
+// bits in |wait_mask|.
+static inline iree_status_code_t iree_futex_wait_bitset(
+    void* address, uint32_t expected_value, uint32_t wait_mask,
+    iree_time_t deadline_ns) {
+  // NOTE: FUTEX_WAIT_BITSET takes an absolute timeout and with
+  // FUTEX_CLOCK_REALTIME it matches the iree_time_t clock.
+  struct timespec deadline = {
+      .tv_sec = (time_t)(deadline_ns / 1000000000ll),
+      .tv_nsec = (long)(deadline_ns % 1000000000ll),
+  };
+  int rc = syscall(
+      SYS_futex, address,
+      FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG | FUTEX_CLOCK_REALTIME,
+      expected_value,
+      deadline_ns == IREE_TIME_INFINITE_FUTURE ? NULL : &deadline, NULL,
+      wait_mask);
+  if (IREE_LIKELY(rc == 0) || errno == EAGAIN || errno == EINTR) {
+    return IREE_STATUS_OK;
+  } else if (errno == ETIMEDOUT) {
+    return IREE_STATUS_DEADLINE_EXCEEDED;
+  }
+  return IREE_STATUS_UNAVAILABLE;
+}
+
+// Wakes all threads waiting on |address| with any of the bits in |wake_mask|.
+static inline void iree_futex_wake_bitset(void* address, uint32_t wake_mask) {
+  syscall(SYS_futex, address, FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, INT32_MAX,
+          NULL, NULL, wake_mask);
+}
+
 #endif  // IREE_PLATFORM_*
 
 #endif  // IREE_RUNTIME_USE_FUTEX
@@ -619,6 +618,11 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
 
 void iree_notification_cancel_wait(iree_notification_t* notification) {}
 
+bool iree_notification_has_posted(iree_notification_t* notification,
+                                  iree_wait_token_t wait_token) {
+  return true;
+}
+
 #elif !defined(IREE_RUNTIME_USE_FUTEX)
 
 // Emulation of a lock-free futex-backed notification using pthreads.
@@ -710,6 +714,14 @@ void iree_notification_cancel_wait(iree_notification_t* notification) {
   pthread_mutex_unlock(&notification->mutex);
 }
 
+bool iree_notification_has_posted(iree_notification_t* notification,
+                                  iree_wait_token_t wait_token) {
+  pthread_mutex_lock(&notification->mutex);
+  bool result = notification->epoch != wait_token;
+  pthread_mutex_unlock(&notification->mutex);
+  return result;
+}
+
 #else
 
 // The 64-bit value used to atomically read-modify-write (RMW) the state is
@@ -786,10 +798,15 @@ static iree_notification_result_t iree_notification_test_wait_condition(
              : IREE_NOTIFICATION_RESULT_UNRESOLVED;
 }
 
-bool iree_notification_commit_wait(iree_notification_t* notification,
-                                   iree_wait_token_t wait_token,
-                                   iree_duration_t spin_ns,
-                                   iree_time_t deadline_ns) {
+// Commits a wait on |notification|. If |set| is provided the system wait is
+// performed on the shared set address with the given |wake_mask| instead of the
+// notification itself.
+static bool iree_notification_commit_wait_on(iree_notification_t* notification,
+                                             iree_wait_token_t wait_token,
+                                             iree_notification_set_t* set,
+                                             uint64_t wake_mask,
+                                             iree_duration_t spin_ns,
+                                             iree_time_t deadline_ns) {
   // Quick check to see if the wait has already succeeded (the epoch advances
   // from when it was captured in iree_notification_prepare_wait).
   iree_notification_result_t result =
@@ -816,9 +833,29 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
   // during iree_notification_prepare_wait.
   if (deadline_ns != IREE_TIME_INFINITE_PAST) {
     while (result == IREE_NOTIFICATION_RESULT_UNRESOLVED) {
-      iree_status_code_t status_code =
-          iree_futex_wait(iree_notification_epoch_address(notification),
-                          wait_token, deadline_ns);
+      iree_status_code_t status_code = IREE_STATUS_OK;
+#if defined(IREE_FUTEX_HAS_BITSET)
+      if (set) {
+        // The set epoch must be captured before rechecking the notification so
+        // that any post that lands after the check also changes the set epoch
+        // and the wait is rejected by the kernel.
+        const int half = (uint32_t)wake_mask ? 0 : 1;
+        iree_atomic_int32_t* set_epoch_address = &set->epochs[half];
+        const uint32_t set_epoch = (uint32_t)iree_atomic_load_int32(
+            set_epoch_address, iree_memory_order_acquire);
+        result =
+            iree_notification_test_wait_condition(notification, wait_token);
+        if (result != IREE_NOTIFICATION_RESULT_UNRESOLVED) break;
+        status_code = iree_futex_wait_bitset(
+            set_epoch_address, set_epoch, (uint32_t)(wake_mask >> (half * 32)),
+            deadline_ns);
+      } else
+#endif  // IREE_FUTEX_HAS_BITSET
+      {
+        status_code =
+            iree_futex_wait(iree_notification_epoch_address(notification),
+                            wait_token, deadline_ns);
+      }
       if (status_code != IREE_STATUS_OK) {
         result = IREE_NOTIFICATION_RESULT_REJECTED;
         break;
@@ -838,6 +875,15 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
   return result == IREE_NOTIFICATION_RESULT_RESOLVED;
 }
 
+bool iree_notification_commit_wait(iree_notification_t* notification,
+                                   iree_wait_token_t wait_token,
+                                   iree_duration_t spin_ns,
+                                   iree_time_t deadline_ns) {
+  return iree_notification_commit_wait_on(notification, wait_token,
+                                          /*set=*/NULL, /*wake_mask=*/0,
+                                          spin_ns, deadline_ns);
+}
+
 void iree_notification_cancel_wait(iree_notification_t* notification) {
   // TODO(benvanik): benchmark under real workloads.
   // iree_memory_order_relaxed would suffice for correctness but the faster
@@ -848,6 +894,12 @@ void iree_notification_cancel_wait(iree_notification_t* notification) {
   SYNC_ASSERT((previous_value & IREE_NOTIFICATION_WAITER_MASK) != 0);
 }
 
+bool iree_notification_has_posted(iree_notification_t* notification,
+                                  iree_wait_token_t wait_token) {
+  return iree_notification_test_wait_condition(notification, wait_token) ==
+         IREE_NOTIFICATION_RESULT_RESOLVED;
+}
+
 #endif  // DISABLED / HAS_FUTEX
 
 bool iree_notification_await(iree_notification_t* notification,
@@ -883,3 +935,71 @@ bool iree_notification_await(iree_notification_t* notification,
 
   return true;
 }
+
+//==============================================================================
+// iree_notification_set_t
+//==============================================================================
+
+void iree_notification_set_initialize(iree_notification_set_t* out_set) {
+  memset(out_set, 0, sizeof(*out_set));
+}
+
+void iree_notification_set_deinitialize(iree_notification_set_t* set) {}
+
+#if !IREE_SYNCHRONIZATION_DISABLE_UNSAFE && \
+    defined(IREE_RUNTIME_USE_FUTEX) && defined(IREE_FUTEX_HAS_BITSET)
+
+bool iree_notification_post_deferred(iree_notification_t* notification) {
+  uint64_t previous_value = iree_atomic_fetch_add_int64(
+      &notification->value, IREE_NOTIFICATION_EPOCH_INC,
+      iree_memory_order_acq_rel);
+  return (previous_value & IREE_NOTIFICATION_WAITER_MASK) != 0;
+}
+
+void iree_notification_set_wake(iree_notification_set_t* set,
+                                uint64_t wake_mask) {
+  for (int half = 0; half < 2; ++half) {
+    const uint32_t half_mask = (uint32_t)(wake_mask >> (half * 32));
+    if (!half_mask) continue;
+    // Advance the epoch so that any waiter that has captured the old epoch but
+    // not yet entered the kernel will have its wait rejected.
+    iree_atomic_fetch_add_int32(&set->epochs[half], 1,
+                                iree_memory_order_acq_rel);
+    iree_futex_wake_bitset(&set->epochs[half], half_mask);
+  }
+}
+
+bool iree_notification_commit_wait_in_set(iree_notification_t* notification,
+                                          iree_wait_token_t wait_token,
+                                          iree_notification_set_t* set,
+                                          uint64_t wake_mask,
+                                          iree_duration_t spin_ns,
+                                          iree_time_t deadline_ns) {
+  SYNC_ASSERT(!((uint32_t)wake_mask && (uint32_t)(wake_mask >> 32)));
+  return iree_notification_commit_wait_on(notification, wait_token, set,
+                                          wake_mask, spin_ns, deadline_ns);
+}
+
+#else
+
+// Fallback that wakes each notification individually.
+
+bool iree_notification_post_deferred(iree_notification_t* notification) {
+  iree_notification_post(notification, IREE_ALL_WAITERS);
+  return false;
+}
+
+void iree_notification_set_wake(iree_notification_set_t* set,
+                                uint64_t wake_mask) {}
+
+bool iree_notification_commit_wait_in_set(iree_notification_t* notification,
+                                          iree_wait_token_t wait_token,
+                                          iree_notification_set_t* set,
+                                          uint64_t wake_mask,
+                                          iree_duration_t spin_ns,
+                                          iree_time_t deadline_ns) {
+  return iree_notification_commit_wait(notification, wait_token, spin_ns,
+                                       deadline_ns);
+}
+
+#endif  // IREE_FUTEX_HAS_BITSET
@@ -18,6 +18,10 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/atomics.h"
 
+#if defined(IREE_COMPILER_MSVC_COMPAT)
+#include <intrin.h>
+#endif  // IREE_COMPILER_MSVC_COMPAT
+
 // NOTE: clang cannot support thread annotations in C code due to some
 // representational bugs... which means that we can't use it here. Boo.
 // There's some workarounds I've seen but getting TSAN working would be much
@@ -333,6 +337,45 @@ bool iree_slim_mutex_try_lock(iree_slim_mutex_t* mutex)
 void iree_slim_mutex_unlock(iree_slim_mutex_t* mutex)
     IREE_THREAD_ANNOTATION_ATTRIBUTE(release_capability(mutex));
 
+//==============================================================================
+// Cross-platform processor yield (where supported)
+//==============================================================================
+
+// Hints to the processor that the caller is in a spin-wait loop. This may
+// reduce power consumption and yield execution resources to sibling hardware
+// threads (on SMT cores) but does not yield to the OS scheduler.
+#if defined(IREE_COMPILER_MSVC_COMPAT)
+
+// MSVC uses architecture-specific intrinsics.
+
+static inline void iree_processor_yield(void) {
+#if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
+  // https://docs.microsoft.com/en-us/cpp/intrinsics/x86-intrinsics-list
+  _mm_pause();
+#elif defined(IREE_ARCH_ARM_64)
+  // https://docs.microsoft.com/en-us/cpp/intrinsics/arm64-intrinsics
+  __yield();
+#else
+  // None available; we'll spin hard.
+#endif  // IREE_ARCH_*
+}
+
+#else
+
+// Clang/GCC and compatibles use architecture-specific inline assembly.
+
+static inline void iree_processor_yield(void) {
+#if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
+  asm volatile("pause");
+#elif defined(IREE_ARCH_ARM_32) || defined(IREE_ARCH_ARM_64)
+  asm volatile("yield");
+#else
+  // None available; we'll spin hard.
+#endif  // IREE_ARCH_*
+}
+
+#endif  // IREE_COMPILER_*
+
 //==============================================================================
 // iree_notification_t
 //==============================================================================
@@ -432,6 +475,17 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
 //   guaranteed.
 void iree_notification_cancel_wait(iree_notification_t* notification);
 
+// Returns true if |notification| has been posted since |wait_token| was
+// returned from iree_notification_prepare_wait. The token remains usable after
+// the wait has been cancelled such that callers can poll for posts (such as
+// when spinning) without being registered as a waiter and requiring posters to
+// make a system call to wake them.
+//
+// Acts as (at least) a memory_order_acquire operation on the notification
+// object when returning true.
+bool iree_notification_has_posted(iree_notification_t* notification,
+                                  iree_wait_token_t wait_token);
+
 // Returns true if the condition is true.
 // |arg| is the |condition_arg| passed to the await function.
 // Implementations must ensure they are coherent with their state values.
@@ -457,6 +511,71 @@ bool iree_notification_await(iree_notification_t* notification,
                              iree_condition_fn_t condition_fn,
                              void* condition_arg, iree_timeout_t timeout);
 
+//==============================================================================
+// iree_notification_set_t
+//==============================================================================
+
+// Number of distinct wake bits available in an iree_notification_set_t.
+#define IREE_NOTIFICATION_SET_WAKE_BIT_COUNT 64
+
+// A shared wait address that allows any subset of a group of notifications to
+// be woken with a single system call where supported (FUTEX_WAKE_BITSET on
+// Linux/Android). Each notification waits on the set with a wake bit and
+// posters first update every notification with iree_notification_post_deferred
+// before waking all of those with waiters with one iree_notification_set_wake.
+//
+// Wake bits are a limited resource and notifications may share them; a shared
+// bit only results in a spurious wake of the other waiters which will recheck
+// their notification and go back to waiting.
+//
+// System bitsets are 32 bits so each half of the 64-bit wake mask has its own
+// wait address and a wake spanning both halves takes two system calls.
+//
+// On platforms without a targeted wake the set is unused and notifications are
+// woken individually as part of iree_notification_post_deferred.
+typedef struct iree_notification_set_t {
+  // Epochs used as the shared wait addresses of the low and high 32 wake bits.
+  // Incremented on each wake of any bit in their half.
+  iree_atomic_int32_t epochs[2];
+} iree_notification_set_t;
+
+// Initializes a notification set with no waiters.
+void iree_notification_set_initialize(iree_notification_set_t* out_set);
+
+// Deinitializes |set|. No threads may be waiting on the set.
+void iree_notification_set_deinitialize(iree_notification_set_t* set);
+
+// Returns the wake bit used for the notification with the given |index|.
+static inline uint64_t iree_notification_set_wake_bit(iree_host_size_t index) {
+  return 1ull << (index % IREE_NOTIFICATION_SET_WAKE_BIT_COUNT);
+}
+
+// Notifies all waiters of |notification| without waking them.
+// Returns true if there may be waiters in a set that must be woken by including
+// the wake bit of the notification in a subsequent iree_notification_set_wake.
+// Where targeted wakes are unsupported the waiters are woken immediately and
+// false is returned.
+//
+// Acts as (at least) a memory_order_release operation on the notification.
+bool iree_notification_post_deferred(iree_notification_t* notification);
+
+// Wakes all waiters in |set| whose wake bit is included in |wake_mask|.
+// No-op if |wake_mask| is 0.
+void iree_notification_set_wake(iree_notification_set_t* set,
+                                uint64_t wake_mask);
+
+// Commits a pending wait operation on |notification| like
+// iree_notification_commit_wait while waiting in |set| with the given
+// |wake_mask| bits, which must all be within the same 32-bit half. Posts to the
+// notification must use iree_notification_post_deferred and
+// iree_notification_set_wake.
+bool iree_notification_commit_wait_in_set(iree_notification_t* notification,
+                                          iree_wait_token_t wait_token,
+                                          iree_notification_set_t* set,
+                                          uint64_t wake_mask,
+                                          iree_duration_t spin_ns,
+                                          iree_time_t deadline_ns);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -4,8 +4,13 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "iree/base/internal/synchronization.h"
@@ -253,4 +258,120 @@ BENCHMARK_TEMPLATE(BM_Contended, std::mutex)
 // mutex/futex (as that's what is used), but at the moment we don't really
 // care beyond that.
 
+//==============================================================================
+// iree_notification_set_t
+//==============================================================================
+
+// Measures the time taken to wake N parked waiters each waiting on their own
+// notification. With |kUseSet| all notifications are posted deferred and woken
+// with a single iree_notification_set_wake (as task executors wake workers)
+// and otherwise each notification is posted individually.
+//
+// The reported wake_latency_us counter is the average time from the first post
+// to the last waiter observing its wake - the tail latency of waking the full
+// set of waiters.
+template <bool kUseSet>
+void BM_NotificationWake(benchmark::State& state) {
+  const int waiter_count = static_cast<int>(state.range(0));
+  struct Waiter {
+    iree_notification_t notification;
+  };
+  std::unique_ptr<Waiter[]> waiters(new Waiter[waiter_count]);
+  iree_notification_set_t set;
+  iree_notification_set_initialize(&set);
+  std::atomic<int> generation = {0};
+  std::atomic<int> woken_count = {0};
+  std::atomic<iree_time_t> last_wake_ns = {0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < waiter_count; ++i) {
+    iree_notification_initialize(&waiters[i].notification);
+  }
+  for (int i = 0; i < waiter_count; ++i) {
+    threads.emplace_back([&, i]() {
+      iree_notification_t* notification = &waiters[i].notification;
+      int seen_generation = 0;
+      while (true) {
+        iree_wait_token_t wait_token =
+            iree_notification_prepare_wait(notification);
+        const int current_generation = generation.load();
+        if (current_generation == seen_generation) {
+          if (kUseSet) {
+            iree_notification_commit_wait_in_set(
+                notification, wait_token, &set,
+                iree_notification_set_wake_bit(i), IREE_DURATION_ZERO,
+                IREE_TIME_INFINITE_FUTURE);
+          } else {
+            iree_notification_commit_wait(notification, wait_token,
+                                          IREE_DURATION_ZERO,
+                                          IREE_TIME_INFINITE_FUTURE);
+          }
+          continue;
+        }
+        iree_notification_cancel_wait(notification);
+        if (current_generation < 0) break;
+        seen_generation = current_generation;
+        iree_time_t now_ns = iree_time_now();
+        iree_time_t latest_ns = last_wake_ns.load();
+        while (latest_ns < now_ns &&
+               !last_wake_ns.compare_exchange_weak(latest_ns, now_ns)) {
+        }
+        ++woken_count;
+      }
+    });
+  }
+
+  auto wake_all = [&]() {
+    if (kUseSet) {
+      uint64_t wake_mask = 0;
+      for (int i = 0; i < waiter_count; ++i) {
+        if (iree_notification_post_deferred(&waiters[i].notification)) {
+          wake_mask |= iree_notification_set_wake_bit(i);
+        }
+      }
+      iree_notification_set_wake(&set, wake_mask);
+    } else {
+      for (int i = 0; i < waiter_count; ++i) {
+        iree_notification_post(&waiters[i].notification, IREE_ALL_WAITERS);
+      }
+    }
+  };
+
+  iree_duration_t total_wake_latency_ns = 0;
+  for (auto _ : state) {
+    // Let all waiters park themselves in the kernel.
+    state.PauseTiming();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    woken_count = 0;
+    state.ResumeTiming();
+
+    iree_time_t post_ns = iree_time_now();
+    ++generation;
+    wake_all();
+    while (woken_count.load() < waiter_count) {
+      iree_processor_yield();
+    }
+    total_wake_latency_ns += last_wake_ns.load() - post_ns;
+  }
+  state.counters["wake_latency_us"] = benchmark::Counter(
+      total_wake_latency_ns / 1000.0, benchmark::Counter::kAvgIterations);
+
+  generation = -1;
+  wake_all();
+  for (auto& thread : threads) thread.join();
+  for (int i = 0; i < waiter_count; ++i) {
+    iree_notification_deinitialize(&waiters[i].notification);
+  }
+  iree_notification_set_deinitialize(&set);
+}
+BENCHMARK_TEMPLATE(BM_NotificationWake, false)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_NotificationWake, true)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
 }  // namespace
@@ -6,7 +6,10 @@
 
 #include "iree/base/internal/synchronization.h"
 
+#include <atomic>
+#include <chrono>
 #include <thread>
+#include <vector>
 
 #include "iree/testing/gtest.h"
 
@@ -217,4 +220,90 @@ TEST(NotificationTest, Timeout) {
   iree_notification_deinitialize(&notification);
 }
 
+//==============================================================================
+// iree_notification_set_t
+//==============================================================================
+
+TEST(NotificationSetTest, Timeout) {
+  iree_notification_set_t set;
+  iree_notification_set_initialize(&set);
+  iree_notification_t notification;
+  iree_notification_initialize(&notification);
+
+  iree_time_t start_ns = iree_time_now();
+
+  iree_wait_token_t wait_token = iree_notification_prepare_wait(&notification);
+  EXPECT_FALSE(iree_notification_commit_wait_in_set(
+      &notification, wait_token, &set, iree_notification_set_wake_bit(0),
+      IREE_DURATION_ZERO, start_ns + 100 * 1000000ll));
+
+  iree_duration_t delta_ns = iree_time_now() - start_ns;
+  iree_duration_t delta_ms = delta_ns / 1000000;
+  EXPECT_GE(delta_ms, 50);  // slop
+
+  iree_notification_deinitialize(&notification);
+  iree_notification_set_deinitialize(&set);
+}
+
+// Tests that only the waiters included in a wake mask are woken. The waiters
+// use bits in each half of the wake mask.
+TEST(NotificationSetTest, WakeSubset) {
+  iree_notification_set_t set;
+  iree_notification_set_initialize(&set);
+  const iree_host_size_t wake_indices[2] = {0, 40};
+
+  struct Waiter {
+    iree_notification_t notification;
+    std::atomic<bool> posted = {false};
+    std::atomic<bool> woken = {false};
+  } waiters[2];
+  for (int i = 0; i < 2; ++i) {
+    iree_notification_initialize(&waiters[i].notification);
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; ++i) {
+    threads.emplace_back([&, i]() {
+      Waiter& waiter = waiters[i];
+      while (true) {
+        iree_wait_token_t wait_token =
+            iree_notification_prepare_wait(&waiter.notification);
+        if (waiter.posted) {
+          iree_notification_cancel_wait(&waiter.notification);
+          break;
+        }
+        iree_notification_commit_wait_in_set(
+            &waiter.notification, wait_token, &set,
+            iree_notification_set_wake_bit(wake_indices[i]),
+            IREE_DURATION_ZERO, IREE_TIME_INFINITE_FUTURE);
+      }
+      waiter.woken = true;
+    });
+  }
+  auto post = [&](int i) {
+    waiters[i].posted = true;
+    uint64_t wake_mask = 0;
+    if (iree_notification_post_deferred(&waiters[i].notification)) {
+      wake_mask |= iree_notification_set_wake_bit(wake_indices[i]);
+    }
+    iree_notification_set_wake(&set, wake_mask);
+  };
+
+  // Wake only the first waiter.
+  post(0);
+  threads[0].join();
+  EXPECT_TRUE(waiters[0].woken);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(waiters[1].woken);
+
+  // Wake the second waiter.
+  post(1);
+  threads[1].join();
+  EXPECT_TRUE(waiters[1].woken);
+
+  for (int i = 0; i < 2; ++i) {
+    iree_notification_deinitialize(&waiters[i].notification);
+  }
+  iree_notification_set_deinitialize(&set);
+}
+
 }  // namespace
@@ -20,6 +20,10 @@
 // 1ms may result in 10-15ms.
 #define IREE_LOOP_SYNC_DELAY_SLOP_NS (2 /*ms*/ * 1000000)
 
+// Interval at which wait sources that cannot be exported as system wait handles
+// (such as HAL semaphores) are polled while other waits are pending.
+#define IREE_LOOP_SYNC_POLL_INTERVAL_NS (1 /*ms*/ * 1000000)
+
 // NOTE: all callbacks should be at offset 0. This allows for easily zipping
 // through the params lists and issuing callbacks.
 static_assert(offsetof(iree_loop_call_params_t, callback) == 0,
@@ -324,6 +328,11 @@ static iree_status_t iree_loop_wait_list_register_wait_source(
       iree_wait_handle_wrap_primitive(wait_primitive.type, wait_primitive.value,
                                       &wait_handle);
       status = iree_wait_source_import(wait_primitive, wait_source);
+    } else if (iree_status_is_unavailable(status)) {
+      // No system handle; the source is left as-is and polled on each scan.
+      iree_status_ignore(status);
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
     }
   }
 
@@ -580,6 +589,32 @@ static void iree_loop_wait_list_handle_wake(iree_loop_wait_list_t* wait_list,
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns true if |wait_source| is pending and has no system wait handle in the
+// wait set such that it must be polled.
+static bool iree_loop_wait_source_is_polled(iree_wait_source_t* wait_source) {
+  return !iree_wait_source_is_immediate(*wait_source) &&
+         !iree_wait_handle_from_source(wait_source);
+}
+
+// Returns true if any of the sources of the pending |op| must be polled.
+static bool iree_loop_wait_op_is_polled(iree_loop_wait_op_t* op) {
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      return iree_loop_wait_source_is_polled(&op->params.wait_one.wait_source);
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+      for (iree_host_size_t i = 0; i < op->params.wait_multi.count; ++i) {
+        if (iree_loop_wait_source_is_polled(
+                &op->params.wait_multi.wait_sources[i])) {
+          return true;
+        }
+      }
+      return false;
+    default:
+      return false;
+  }
+}
+
 static iree_status_t iree_loop_wait_list_scan(
     iree_loop_wait_list_t* wait_list, iree_loop_run_ring_t* run_ring,
     iree_time_t* out_earliest_deadline_ns) {
@@ -623,6 +658,11 @@ static iree_status_t iree_loop_wait_list_scan(
       // issued ASAP and will let the main loop pump again to actually wait if
       // needed.
       *out_earliest_deadline_ns = IREE_TIME_INFINITE_PAST;
+    } else if (iree_loop_wait_op_is_polled(&wait_list->ops[i])) {
+      // Nothing will wake the system wait when the source resolves.
+      *out_earliest_deadline_ns =
+          iree_min(*out_earliest_deadline_ns,
+                   now_ns + IREE_LOOP_SYNC_POLL_INTERVAL_NS);
     }
   }
 
@@ -261,6 +261,71 @@ TEST_P(command_buffer_test, CopySubBuffer) {
   iree_hal_buffer_release(host_buffer);
 }
 
+TEST_P(command_buffer_test, SubmitReusable) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, /*mode=*/0, IREE_HAL_COMMAND_CATEGORY_TRANSFER,
+      IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0, &command_buffer));
+
+  iree_hal_buffer_params_t device_params = {0};
+  device_params.type =
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  device_params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                        IREE_HAL_BUFFER_USAGE_TRANSFER |
+                        IREE_HAL_BUFFER_USAGE_MAPPING;
+  iree_hal_buffer_t* source_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_, device_params, kDefaultAllocationSize,
+      &source_buffer));
+  iree_hal_buffer_t* target_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_, device_params, kDefaultAllocationSize,
+      &target_buffer));
+
+  // Fill the source buffer and copy it to the target buffer.
+  uint8_t i8_val = 0x3C;
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, source_buffer, /*target_offset=*/0,
+      /*length=*/kDefaultAllocationSize, &i8_val,
+      /*pattern_length=*/sizeof(i8_val)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer, IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, /*memory_barrier_count=*/0,
+      /*memory_barriers=*/NULL, /*buffer_barrier_count=*/0,
+      /*buffer_barriers=*/NULL));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, /*source_buffer=*/source_buffer, /*source_offset=*/0,
+      /*target_buffer=*/target_buffer, /*target_offset=*/0,
+      /*length=*/kDefaultAllocationSize));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  std::vector<uint8_t> reference_buffer(kDefaultAllocationSize, i8_val);
+  std::vector<uint8_t> zero_buffer(kDefaultAllocationSize, 0);
+  for (int i = 0; i < 2; ++i) {
+    // Clear the target buffer such that each submission must rewrite it.
+    IREE_ASSERT_OK(iree_hal_device_transfer_h2d(
+        device_, zero_buffer.data(), target_buffer, 0, zero_buffer.size(),
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+
+    IREE_ASSERT_OK(SubmitCommandBufferAndWait(command_buffer));
+
+    std::vector<uint8_t> actual_data(kDefaultAllocationSize);
+    IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+        device_, target_buffer, /*source_offset=*/0,
+        /*target_buffer=*/actual_data.data(),
+        /*data_length=*/kDefaultAllocationSize,
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    EXPECT_THAT(actual_data, ContainerEq(reference_buffer));
+  }
+
+  // Must release the command buffer before resources used by it.
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_buffer_release(source_buffer);
+}
+
 TEST_P(command_buffer_test, FillBuffer_pattern1_size1_offset0_length1) {
   iree_device_size_t buffer_size = 1;
   iree_device_size_t target_offset = 0;
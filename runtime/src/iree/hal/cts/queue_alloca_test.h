@@ -0,0 +1,118 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
+#define IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/cts/cts_test_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace cts {
+
+class queue_alloca_test : public CtsTestBase {
+ protected:
+  static iree_hal_buffer_params_t TransientParams() {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT |
+                   IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED;
+    return params;
+  }
+
+  // Returns a list signaling (or waiting on) |semaphore| reaching |*value|.
+  static iree_hal_semaphore_list_t MakeList(iree_hal_semaphore_t** semaphore,
+                                            uint64_t* value) {
+    iree_hal_semaphore_list_t list = {1, semaphore, value};
+    return list;
+  }
+};
+
+TEST_P(queue_alloca_test, AllocateAndDeallocate) {
+  iree_hal_semaphore_t* semaphore = CreateSemaphore();
+  uint64_t alloca_value = 1;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      MakeList(&semaphore, &alloca_value), IREE_HAL_ALLOCATOR_POOL_DEFAULT,
+      TransientParams(), 1000, &buffer));
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, alloca_value,
+                                         iree_infinite_timeout()));
+  EXPECT_GE(iree_hal_buffer_byte_length(buffer), 1000);
+
+  uint64_t dealloca_value = 2;
+  IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, MakeList(&semaphore, &alloca_value),
+      MakeList(&semaphore, &dealloca_value), buffer));
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, dealloca_value,
+                                         iree_infinite_timeout()));
+  CheckSemaphoreValue(semaphore, dealloca_value);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Chains alloca/fill/dealloca sequences of varying sizes on one timeline as
+// programs with transient buffers do. Implementations may reuse the memory of
+// each deallocation for the next allocation.
+TEST_P(queue_alloca_test, ChainedAllocations) {
+  iree_hal_semaphore_t* semaphore = CreateSemaphore();
+  const iree_device_size_t sizes[] = {4096, 4000, 4096, 100, 8192, 4096};
+  uint64_t value = 0;
+  for (int iteration = 0; iteration < 4; ++iteration) {
+    for (iree_device_size_t size : sizes) {
+      uint64_t wait_value = value;
+      uint64_t alloca_value = ++value;
+      iree_hal_buffer_t* buffer = NULL;
+      IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+          device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+          MakeList(&semaphore, &wait_value),
+          MakeList(&semaphore, &alloca_value),
+          IREE_HAL_ALLOCATOR_POOL_DEFAULT, TransientParams(), size, &buffer));
+
+      const uint8_t pattern = (uint8_t)value;
+      uint64_t fill_value = ++value;
+      IREE_ASSERT_OK(iree_hal_device_queue_fill(
+          device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+          MakeList(&semaphore, &alloca_value),
+          MakeList(&semaphore, &fill_value), buffer, 0, size, &pattern,
+          sizeof(pattern)));
+      IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, fill_value,
+                                             iree_infinite_timeout()));
+      std::vector<uint8_t> contents(size);
+      IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+          device_, buffer, 0, contents.data(), contents.size(),
+          IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+      EXPECT_EQ(contents.front(), pattern);
+      EXPECT_EQ(contents.back(), pattern);
+
+      uint64_t dealloca_value = ++value;
+      IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+          device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+          MakeList(&semaphore, &fill_value),
+          MakeList(&semaphore, &dealloca_value), buffer));
+      iree_hal_buffer_release(buffer);
+    }
+  }
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, value, iree_infinite_timeout()));
+  CheckSemaphoreValue(semaphore, value);
+  iree_hal_semaphore_release(semaphore);
+}
+
+}  // namespace cts
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
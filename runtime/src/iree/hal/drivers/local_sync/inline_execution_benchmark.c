@@ -0,0 +1,355 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures the latency of a single tiny dispatch submitted the way the HAL
+// module does for compiled programs: create a one-shot command buffer, record
+// the dispatch, submit it with a signal fence, and wait on the fence.
+//
+// Three execution modes are compared:
+//   task: local-task device with deferred command buffer issue on workers.
+//   sync: local-sync device recording into a deferred command buffer that is
+//         replayed on submission.
+//   sync_inline: local-sync device executing as the dispatch is recorded
+//                (IREE_HAL_MODULE_FLAG_INLINE_EXECUTION).
+
+#include <stdint.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/loaders/static_library_loader.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
+#include "iree/testing/benchmark.h"
+
+//===----------------------------------------------------------------------===//
+// Tiny executable library
+//===----------------------------------------------------------------------===//
+
+#define IREE_BENCHMARK_ELEMENT_COUNT 4
+
+// binding[1][x] = binding[0][x] + push_constant[0]
+static int iree_benchmark_add_dispatch(
+    const iree_hal_executable_environment_v0_t* environment,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state) {
+  const uint32_t* src = (const uint32_t*)dispatch_state->binding_ptrs[0];
+  uint32_t* dst = (uint32_t*)dispatch_state->binding_ptrs[1];
+  const uint32_t x = workgroup_state->workgroup_id_x;
+  dst[x] = src[x] + dispatch_state->push_constants[0];
+  return 0;
+}
+
+static const iree_hal_executable_library_header_t
+    iree_benchmark_library_header = {
+        .version = IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
+        .name = "inline_execution_benchmark",
+        .features = IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE,
+        .sanitizer = IREE_HAL_EXECUTABLE_LIBRARY_SANITIZER_NONE,
+};
+static const iree_hal_executable_dispatch_v0_t
+    iree_benchmark_library_entry_points[1] = {
+        iree_benchmark_add_dispatch,
+};
+static const iree_hal_executable_library_v0_t iree_benchmark_library = {
+    .header = &iree_benchmark_library_header,
+    .imports =
+        {
+            .count = 0,
+            .symbols = NULL,
+        },
+    .exports =
+        {
+            .count = 1,
+            .ptrs = iree_benchmark_library_entry_points,
+        },
+    .constants =
+        {
+            .count = 0,
+        },
+};
+
+static const iree_hal_executable_library_header_t**
+iree_benchmark_library_query(
+    iree_hal_executable_library_version_t max_version,
+    const iree_hal_executable_environment_v0_t* environment) {
+  if (max_version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) return NULL;
+  return (const iree_hal_executable_library_header_t**)&iree_benchmark_library;
+}
+
+//===----------------------------------------------------------------------===//
+// Benchmark setup
+//===----------------------------------------------------------------------===//
+
+typedef enum iree_benchmark_execution_mode_e {
+  IREE_BENCHMARK_EXECUTION_MODE_TASK = 0,
+  IREE_BENCHMARK_EXECUTION_MODE_SYNC,
+  IREE_BENCHMARK_EXECUTION_MODE_SYNC_INLINE,
+} iree_benchmark_execution_mode_t;
+
+typedef struct iree_benchmark_resources_t {
+  iree_hal_device_t* device;
+  iree_hal_executable_cache_t* executable_cache;
+  iree_hal_descriptor_set_layout_t* set_layout;
+  iree_hal_pipeline_layout_t* pipeline_layout;
+  iree_hal_executable_t* executable;
+  iree_hal_buffer_t* buffers[2];
+  iree_hal_semaphore_t* semaphore;
+  iree_status_t loop_status;
+} iree_benchmark_resources_t;
+
+static iree_status_t iree_benchmark_create_device(
+    iree_benchmark_execution_mode_t mode, iree_allocator_t host_allocator,
+    iree_hal_device_t** out_device) {
+  const iree_hal_executable_library_query_fn_t libraries[] = {
+      iree_benchmark_library_query,
+  };
+  iree_hal_executable_loader_t* loader = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_static_library_loader_create(
+      IREE_ARRAYSIZE(libraries), libraries,
+      iree_hal_executable_import_provider_null(), host_allocator, &loader));
+
+  iree_string_view_t identifier = mode == IREE_BENCHMARK_EXECUTION_MODE_TASK
+                                      ? IREE_SV("local-task")
+                                      : IREE_SV("local-sync");
+  iree_hal_allocator_t* device_allocator = NULL;
+  iree_status_t status = iree_hal_allocator_create_heap(
+      identifier, host_allocator, host_allocator, &device_allocator);
+
+  if (iree_status_is_ok(status) && mode == IREE_BENCHMARK_EXECUTION_MODE_TASK) {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(1, &topology);
+    iree_task_executor_t* executor = NULL;
+    status = iree_task_executor_create(options, &topology, host_allocator,
+                                       &executor);
+    iree_task_topology_deinitialize(&topology);
+    if (iree_status_is_ok(status)) {
+      iree_hal_task_device_params_t params;
+      iree_hal_task_device_params_initialize(&params);
+      status = iree_hal_task_device_create(
+          identifier, &params, /*queue_count=*/1, &executor,
+          /*loader_count=*/1, &loader, device_allocator, host_allocator,
+          out_device);
+    }
+    iree_task_executor_release(executor);
+  } else if (iree_status_is_ok(status)) {
+    iree_hal_sync_device_params_t params;
+    iree_hal_sync_device_params_initialize(&params);
+    status = iree_hal_sync_device_create(identifier, &params,
+                                         /*loader_count=*/1, &loader,
+                                         device_allocator, host_allocator,
+                                         out_device);
+  }
+
+  iree_hal_allocator_release(device_allocator);
+  iree_hal_executable_loader_release(loader);
+  return status;
+}
+
+static void iree_benchmark_resources_deinitialize(
+    iree_benchmark_resources_t* resources) {
+  iree_hal_semaphore_release(resources->semaphore);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources->buffers); ++i) {
+    iree_hal_buffer_release(resources->buffers[i]);
+  }
+  iree_hal_executable_release(resources->executable);
+  iree_hal_pipeline_layout_release(resources->pipeline_layout);
+  iree_hal_descriptor_set_layout_release(resources->set_layout);
+  iree_hal_executable_cache_release(resources->executable_cache);
+  iree_hal_device_release(resources->device);
+  iree_status_ignore(resources->loop_status);
+  memset(resources, 0, sizeof(*resources));
+}
+
+static iree_status_t iree_benchmark_resources_initialize(
+    iree_benchmark_execution_mode_t mode, iree_allocator_t host_allocator,
+    iree_benchmark_resources_t* out_resources) {
+  memset(out_resources, 0, sizeof(*out_resources));
+  iree_benchmark_resources_t* resources = out_resources;
+  resources->loop_status = iree_ok_status();
+
+  iree_status_t status =
+      iree_benchmark_create_device(mode, host_allocator, &resources->device);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_executable_cache_create(
+        resources->device, iree_string_view_empty(),
+        iree_loop_inline(&resources->loop_status),
+        &resources->executable_cache);
+  }
+
+  if (iree_status_is_ok(status)) {
+    const iree_hal_descriptor_set_layout_binding_t bindings[2] = {
+        {0, IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+         IREE_HAL_DESCRIPTOR_FLAG_NONE},
+        {1, IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+         IREE_HAL_DESCRIPTOR_FLAG_NONE},
+    };
+    status = iree_hal_descriptor_set_layout_create(
+        resources->device, IREE_HAL_DESCRIPTOR_SET_LAYOUT_FLAG_NONE,
+        IREE_ARRAYSIZE(bindings), bindings, &resources->set_layout);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_pipeline_layout_create(
+        resources->device, /*push_constants=*/1, /*set_layout_count=*/1,
+        &resources->set_layout, &resources->pipeline_layout);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_executable_params_t executable_params;
+    iree_hal_executable_params_initialize(&executable_params);
+    executable_params.caching_mode =
+        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+    executable_params.executable_format = IREE_SV("static");
+    executable_params.executable_data = iree_make_const_byte_span(
+        iree_benchmark_library_header.name,
+        strlen(iree_benchmark_library_header.name));
+    executable_params.pipeline_layout_count = 1;
+    executable_params.pipeline_layouts = &resources->pipeline_layout;
+    status = iree_hal_executable_cache_prepare_executable(
+        resources->executable_cache, &executable_params,
+        &resources->executable);
+  }
+
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(resources->buffers) && iree_status_is_ok(status);
+       ++i) {
+    iree_hal_buffer_params_t params = {
+        .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+        .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+    };
+    status = iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(resources->device), params,
+        IREE_BENCHMARK_ELEMENT_COUNT * sizeof(uint32_t),
+        &resources->buffers[i]);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_create(resources->device, 0ull,
+                                       &resources->semaphore);
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_benchmark_resources_deinitialize(resources);
+  }
+  return status;
+}
+
+// Records and submits a single dispatch and waits for it to complete.
+static iree_status_t iree_benchmark_submit_dispatch(
+    iree_benchmark_resources_t* resources,
+    iree_hal_command_buffer_mode_t mode, uint64_t signal_value,
+    iree_allocator_t host_allocator) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_command_buffer_create(
+      resources->device, mode, IREE_HAL_COMMAND_CATEGORY_DISPATCH,
+      IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0, &command_buffer));
+
+  iree_status_t status = iree_hal_command_buffer_begin(command_buffer);
+  if (iree_status_is_ok(status)) {
+    const uint32_t push_constant = 1;
+    status = iree_hal_command_buffer_push_constants(
+        command_buffer, resources->pipeline_layout, 0, &push_constant,
+        sizeof(push_constant));
+  }
+  if (iree_status_is_ok(status)) {
+    const iree_hal_descriptor_set_binding_t bindings[2] = {
+        {0, 0, resources->buffers[0], 0, IREE_WHOLE_BUFFER},
+        {1, 0, resources->buffers[1], 0, IREE_WHOLE_BUFFER},
+    };
+    status = iree_hal_command_buffer_push_descriptor_set(
+        command_buffer, resources->pipeline_layout, /*set=*/0,
+        IREE_ARRAYSIZE(bindings), bindings);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_dispatch(
+        command_buffer, resources->executable, /*entry_point=*/0,
+        IREE_BENCHMARK_ELEMENT_COUNT, 1, 1);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_end(command_buffer);
+  }
+
+  iree_hal_fence_t* signal_fence = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fence_create_at(resources->semaphore, signal_value,
+                                      host_allocator, &signal_fence);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_device_queue_execute(
+        resources->device, IREE_HAL_QUEUE_AFFINITY_ANY,
+        iree_hal_semaphore_list_empty(),
+        iree_hal_fence_semaphore_list(signal_fence), 1, &command_buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fence_wait(signal_fence, iree_infinite_timeout());
+  }
+
+  iree_hal_fence_release(signal_fence);
+  iree_hal_command_buffer_release(command_buffer);
+  return status;
+}
+
+// user_data is the iree_benchmark_execution_mode_t.
+static iree_status_t iree_benchmark_dispatch_latency(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_benchmark_execution_mode_t mode =
+      (iree_benchmark_execution_mode_t)(uintptr_t)benchmark_def->user_data;
+
+  iree_benchmark_resources_t resources;
+  IREE_RETURN_IF_ERROR(
+      iree_benchmark_resources_initialize(mode, host_allocator, &resources));
+
+  iree_hal_command_buffer_mode_t command_buffer_mode =
+      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT;
+  if (mode == IREE_BENCHMARK_EXECUTION_MODE_SYNC_INLINE) {
+    command_buffer_mode |= IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION;
+  }
+
+  iree_status_t status = iree_ok_status();
+  uint64_t signal_value = 0;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    status = iree_benchmark_submit_dispatch(&resources, command_buffer_mode,
+                                            ++signal_value, host_allocator);
+  }
+
+  iree_benchmark_resources_deinitialize(&resources);
+  return status;
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  iree_benchmark_def_t benchmark_def = {
+      .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+               IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+      .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+      .minimum_duration_ns = 0,
+      .iteration_count = 0,
+      .run = iree_benchmark_dispatch_latency,
+  };
+  benchmark_def.user_data =
+      (void*)(uintptr_t)IREE_BENCHMARK_EXECUTION_MODE_TASK;
+  iree_benchmark_register(IREE_SV("dispatch_latency_task"), &benchmark_def);
+  benchmark_def.user_data =
+      (void*)(uintptr_t)IREE_BENCHMARK_EXECUTION_MODE_SYNC;
+  iree_benchmark_register(IREE_SV("dispatch_latency_sync"), &benchmark_def);
+  benchmark_def.user_data =
+      (void*)(uintptr_t)IREE_BENCHMARK_EXECUTION_MODE_SYNC_INLINE;
+  iree_benchmark_register(IREE_SV("dispatch_latency_sync_inline"),
+                          &benchmark_def);
+
+  iree_benchmark_run_specified();
+  return 0;
+}
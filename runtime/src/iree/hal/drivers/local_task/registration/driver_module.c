@@ -20,6 +20,20 @@ IREE_FLAG(
     bool, task_abort_on_failure, false,
     "Aborts the program on the first failure within a task system queue.");
 
+IREE_FLAG(
+    bool, task_numa_placement, false,
+    "Places device buffers on the NUMA memory node of the task executor\n"
+    "servicing the queue they are allocated for. Only applies\n"
+    "when executor topologies are pinned to a single node each (such as with\n"
+    "--task_topology_nodes=all).");
+
+IREE_FLAG(
+    bool, task_numa_migrate_imports, false,
+    "With --task_numa_placement also binds imported host allocations to the\n"
+    "NUMA memory node of the queue they are imported for and migrates their\n"
+    "resident pages. Only use when imported memory is not shared with\n"
+    "threads or devices on other nodes.");
+
 static iree_status_t iree_hal_local_task_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -49,6 +63,12 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
   if (FLAG_task_abort_on_failure) {
     default_params.queue_scope_flags |= IREE_TASK_SCOPE_FLAG_ABORT_ON_FAILURE;
   }
+  if (FLAG_task_numa_placement) {
+    default_params.memory_placement =
+        FLAG_task_numa_migrate_imports
+            ? IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_QUEUE_NODE_AND_IMPORTS
+            : IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_QUEUE_NODE;
+  }
 
   // Create executors for each topology specified by flags.
   // Stack allocated storage today but we can query for the total count and
@@ -0,0 +1,615 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_allocator.h"
+
+#include <string.h>
+
+#include "iree/base/internal/memory.h"
+#include "iree/base/internal/synchronization.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_task_node_arena_t
+//===----------------------------------------------------------------------===//
+
+// Smallest block size as a power of two; all small blocks are a power of two.
+#define IREE_HAL_TASK_NODE_ARENA_MIN_CLASS_SHIFT 6
+// Number of small block size classes (64B to 256KB).
+#define IREE_HAL_TASK_NODE_ARENA_CLASS_COUNT 13
+// Largest block (including its header) carved from a slab. Larger blocks get
+// their own mapping.
+#define IREE_HAL_TASK_NODE_ARENA_MAX_SMALL_SIZE                    \
+  ((iree_host_size_t)1 << (IREE_HAL_TASK_NODE_ARENA_MIN_CLASS_SHIFT + \
+                           IREE_HAL_TASK_NODE_ARENA_CLASS_COUNT - 1))
+// Size of each slab small blocks are carved from.
+#define IREE_HAL_TASK_NODE_ARENA_SLAB_SIZE (2 * 1024 * 1024)
+// Total size of freed large mappings retained for reuse before they are
+// returned to the system.
+#define IREE_HAL_TASK_NODE_ARENA_MAX_CACHED_SIZE (256 * 1024 * 1024)
+
+// Header preceding every block handed out by the arena.
+typedef struct iree_hal_task_node_block_t {
+  // Next block in a free list or the mapping cache while not in use.
+  struct iree_hal_task_node_block_t* next;
+  // Total size of the block including this header. Small blocks are a power
+  // of two <= IREE_HAL_TASK_NODE_ARENA_MAX_SMALL_SIZE and large blocks are
+  // whole mappings larger than that.
+  iree_host_size_t length;
+} iree_hal_task_node_block_t;
+
+// Header at the start of every slab mapping.
+typedef struct iree_hal_task_node_slab_t {
+  struct iree_hal_task_node_slab_t* next;
+} iree_hal_task_node_slab_t;
+
+#define IREE_HAL_TASK_NODE_BLOCK_HEADER_SIZE \
+  iree_host_align(sizeof(iree_hal_task_node_block_t), iree_max_align_t)
+#define IREE_HAL_TASK_NODE_SLAB_HEADER_SIZE \
+  iree_host_align(sizeof(iree_hal_task_node_slab_t), iree_max_align_t)
+
+// Host memory allocator whose pages are all placed on a single NUMA node.
+// Memory is reserved from the system in large mappings that have their
+// placement policy applied once before any page is touched and blocks are
+// suballocated from them:
+//   * small blocks are carved from shared slabs and recycled through
+//     per-size-class free lists for the lifetime of the arena;
+//   * large blocks receive a dedicated mapping that is cached after being
+//     freed so that subsequent allocations of a similar size reuse the
+//     already-placed pages.
+// Thread-safe; blocks may be freed from any thread.
+typedef struct iree_hal_task_node_arena_t {
+  iree_slim_mutex_t mutex;
+  uint32_t node_id;
+  iree_host_size_t page_size;
+  // All slabs with the one currently being carved at the head.
+  iree_hal_task_node_slab_t* slab_head IREE_GUARDED_BY(mutex);
+  // Offset of the next unused byte in slab_head.
+  iree_host_size_t slab_offset IREE_GUARDED_BY(mutex);
+  // Freed small blocks by size class.
+  iree_hal_task_node_block_t* free_blocks[IREE_HAL_TASK_NODE_ARENA_CLASS_COUNT]
+      IREE_GUARDED_BY(mutex);
+  // Freed large mappings available for reuse.
+  iree_hal_task_node_block_t* cached_mappings IREE_GUARDED_BY(mutex);
+  iree_host_size_t cached_size IREE_GUARDED_BY(mutex);
+} iree_hal_task_node_arena_t;
+
+// Returns the header of the block whose contents start at |ptr|.
+static iree_hal_task_node_block_t* iree_hal_task_node_block_from_ptr(
+    void* ptr) {
+  return (iree_hal_task_node_block_t*)((uint8_t*)ptr -
+                                       IREE_HAL_TASK_NODE_BLOCK_HEADER_SIZE);
+}
+
+static void iree_hal_task_node_arena_initialize(
+    uint32_t node_id, iree_hal_task_node_arena_t* out_arena) {
+  memset(out_arena, 0, sizeof(*out_arena));
+  iree_slim_mutex_initialize(&out_arena->mutex);
+  out_arena->node_id = node_id;
+  out_arena->page_size = iree_memory_query_info().normal_page_size;
+}
+
+// Returns all cached large mappings to the system.
+static void iree_hal_task_node_arena_trim(iree_hal_task_node_arena_t* arena) {
+  iree_slim_mutex_lock(&arena->mutex);
+  iree_hal_task_node_block_t* block = arena->cached_mappings;
+  arena->cached_mappings = NULL;
+  arena->cached_size = 0;
+  iree_slim_mutex_unlock(&arena->mutex);
+  while (block) {
+    iree_hal_task_node_block_t* next = block->next;
+    iree_memory_node_free(block, block->length);
+    block = next;
+  }
+}
+
+// Releases all memory owned by the arena. All blocks must have been freed.
+static void iree_hal_task_node_arena_deinitialize(
+    iree_hal_task_node_arena_t* arena) {
+  iree_hal_task_node_arena_trim(arena);
+  iree_hal_task_node_slab_t* slab = arena->slab_head;
+  while (slab) {
+    iree_hal_task_node_slab_t* next = slab->next;
+    iree_memory_node_free(slab, IREE_HAL_TASK_NODE_ARENA_SLAB_SIZE);
+    slab = next;
+  }
+  iree_slim_mutex_deinitialize(&arena->mutex);
+}
+
+// Allocates a small block of |block_size| bytes (a power of two) from the
+// free list of |class_index| or the current slab.
+static iree_status_t iree_hal_task_node_arena_allocate_small(
+    iree_hal_task_node_arena_t* arena, iree_host_size_t class_index,
+    iree_host_size_t block_size, bool* out_zeroed,
+    iree_hal_task_node_block_t** out_block) {
+  iree_slim_mutex_lock(&arena->mutex);
+  iree_hal_task_node_block_t* block = arena->free_blocks[class_index];
+  if (block) {
+    arena->free_blocks[class_index] = block->next;
+    iree_slim_mutex_unlock(&arena->mutex);
+    *out_zeroed = false;
+    *out_block = block;
+    return iree_ok_status();
+  }
+
+  // Start a new slab if the current one cannot fit the block. The tail of the
+  // previous slab is abandoned; it is at most one maximum-size small block.
+  if (!arena->slab_head ||
+      arena->slab_offset + block_size > IREE_HAL_TASK_NODE_ARENA_SLAB_SIZE) {
+    iree_hal_task_node_slab_t* slab = NULL;
+    iree_status_t status = iree_memory_node_allocate(
+        IREE_HAL_TASK_NODE_ARENA_SLAB_SIZE, arena->node_id, (void**)&slab);
+    if (!iree_status_is_ok(status)) {
+      iree_slim_mutex_unlock(&arena->mutex);
+      return status;
+    }
+    slab->next = arena->slab_head;
+    arena->slab_head = slab;
+    arena->slab_offset = IREE_HAL_TASK_NODE_SLAB_HEADER_SIZE;
+  }
+  block = (iree_hal_task_node_block_t*)((uint8_t*)arena->slab_head +
+                                        arena->slab_offset);
+  arena->slab_offset += block_size;
+  iree_slim_mutex_unlock(&arena->mutex);
+
+  // Slab pages are zero until first handed out.
+  block->length = block_size;
+  *out_zeroed = true;
+  *out_block = block;
+  return iree_ok_status();
+}
+
+// Allocates a large block of |mapping_length| bytes (a page multiple) by
+// reusing a cached mapping of a similar size or creating a new one.
+static iree_status_t iree_hal_task_node_arena_allocate_large(
+    iree_hal_task_node_arena_t* arena, iree_host_size_t mapping_length,
+    bool* out_zeroed, iree_hal_task_node_block_t** out_block) {
+  // Reuse the first cached mapping that fits without wasting more than a
+  // quarter of its pages.
+  iree_slim_mutex_lock(&arena->mutex);
+  iree_hal_task_node_block_t** link = &arena->cached_mappings;
+  while (*link) {
+    iree_hal_task_node_block_t* block = *link;
+    if (block->length >= mapping_length &&
+        block->length - mapping_length <= block->length / 4) {
+      *link = block->next;
+      arena->cached_size -= block->length;
+      iree_slim_mutex_unlock(&arena->mutex);
+      *out_zeroed = false;
+      *out_block = block;
+      return iree_ok_status();
+    }
+    link = &block->next;
+  }
+  iree_slim_mutex_unlock(&arena->mutex);
+
+  iree_hal_task_node_block_t* block = NULL;
+  IREE_RETURN_IF_ERROR(iree_memory_node_allocate(mapping_length,
+                                                 arena->node_id,
+                                                 (void**)&block));
+  block->length = mapping_length;
+  *out_zeroed = true;
+  *out_block = block;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_task_node_arena_allocate(
+    iree_hal_task_node_arena_t* arena, iree_host_size_t byte_length,
+    bool zero_contents, void** out_ptr) {
+  *out_ptr = NULL;
+  const iree_host_size_t header_size = IREE_HAL_TASK_NODE_BLOCK_HEADER_SIZE;
+  if (byte_length > IREE_HOST_SIZE_MAX - arena->page_size - header_size) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "allocation of %" PRIhsz " bytes too large",
+                            byte_length);
+  }
+  const iree_host_size_t required_size = header_size + byte_length;
+
+  bool zeroed = false;
+  iree_hal_task_node_block_t* block = NULL;
+  if (required_size <= IREE_HAL_TASK_NODE_ARENA_MAX_SMALL_SIZE) {
+    iree_host_size_t class_index = 0;
+    iree_host_size_t block_size = (iree_host_size_t)1
+                                  << IREE_HAL_TASK_NODE_ARENA_MIN_CLASS_SHIFT;
+    while (block_size < required_size) {
+      block_size <<= 1;
+      ++class_index;
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_task_node_arena_allocate_small(
+        arena, class_index, block_size, &zeroed, &block));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_hal_task_node_arena_allocate_large(
+        arena, iree_host_align(required_size, arena->page_size), &zeroed,
+        &block));
+  }
+
+  void* ptr = (uint8_t*)block + header_size;
+  if (zero_contents && !zeroed) memset(ptr, 0, byte_length);
+  *out_ptr = ptr;
+  return iree_ok_status();
+}
+
+static void iree_hal_task_node_arena_free(iree_hal_task_node_arena_t* arena,
+                                          void* ptr) {
+  if (!ptr) return;
+  iree_hal_task_node_block_t* block = iree_hal_task_node_block_from_ptr(ptr);
+  iree_slim_mutex_lock(&arena->mutex);
+  if (block->length <= IREE_HAL_TASK_NODE_ARENA_MAX_SMALL_SIZE) {
+    iree_host_size_t class_index = 0;
+    while (((iree_host_size_t)1
+            << (IREE_HAL_TASK_NODE_ARENA_MIN_CLASS_SHIFT + class_index)) <
+           block->length) {
+      ++class_index;
+    }
+    block->next = arena->free_blocks[class_index];
+    arena->free_blocks[class_index] = block;
+    iree_slim_mutex_unlock(&arena->mutex);
+  } else if (arena->cached_size + block->length <=
+             IREE_HAL_TASK_NODE_ARENA_MAX_CACHED_SIZE) {
+    block->next = arena->cached_mappings;
+    arena->cached_mappings = block;
+    arena->cached_size += block->length;
+    iree_slim_mutex_unlock(&arena->mutex);
+  } else {
+    iree_slim_mutex_unlock(&arena->mutex);
+    iree_memory_node_free(block, block->length);
+  }
+}
+
+static iree_status_t iree_hal_task_node_arena_ctl(
+    void* self, iree_allocator_command_t command, const void* params,
+    void** inout_ptr) {
+  iree_hal_task_node_arena_t* arena = (iree_hal_task_node_arena_t*)self;
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC:
+      return iree_hal_task_node_arena_allocate(
+          arena, ((const iree_allocator_alloc_params_t*)params)->byte_length,
+          command == IREE_ALLOCATOR_COMMAND_CALLOC, inout_ptr);
+    case IREE_ALLOCATOR_COMMAND_REALLOC: {
+      const iree_host_size_t byte_length =
+          ((const iree_allocator_alloc_params_t*)params)->byte_length;
+      void* old_ptr = *inout_ptr;
+      void* new_ptr = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_task_node_arena_allocate(
+          arena, byte_length, /*zero_contents=*/false, &new_ptr));
+      if (old_ptr) {
+        const iree_host_size_t old_length =
+            iree_hal_task_node_block_from_ptr(old_ptr)->length -
+            IREE_HAL_TASK_NODE_BLOCK_HEADER_SIZE;
+        memcpy(new_ptr, old_ptr, iree_min(byte_length, old_length));
+        iree_hal_task_node_arena_free(arena, old_ptr);
+      }
+      *inout_ptr = new_ptr;
+      return iree_ok_status();
+    }
+    case IREE_ALLOCATOR_COMMAND_FREE:
+      iree_hal_task_node_arena_free(arena, *inout_ptr);
+      return iree_ok_status();
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported allocator command");
+  }
+}
+
+static iree_allocator_t iree_hal_task_node_arena_allocator(
+    iree_hal_task_node_arena_t* arena) {
+  iree_allocator_t allocator = {
+      .self = arena,
+      .ctl = iree_hal_task_node_arena_ctl,
+  };
+  return allocator;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_task_allocator_t
+//===----------------------------------------------------------------------===//
+
+// Memory placed on a single NUMA node.
+typedef struct iree_hal_task_allocator_node_t {
+  iree_task_topology_node_id_t node_id;
+  // Heap allocator producing buffers with storage from |arena|.
+  iree_hal_allocator_t* heap_allocator;
+  iree_hal_task_node_arena_t arena;
+} iree_hal_task_allocator_node_t;
+
+typedef struct iree_hal_task_allocator_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_task_allocator_flags_t flags;
+  // Underlying allocator used for memory that has no node preference and for
+  // imports/exports.
+  iree_hal_allocator_t* device_allocator;
+  // Node shared by all queues or IREE_TASK_TOPOLOGY_NODE_ID_ANY.
+  iree_task_topology_node_id_t common_node_id;
+  // One entry per distinct known node in |queue_node_ids|.
+  iree_host_size_t node_count;
+  iree_hal_task_allocator_node_t* nodes;
+  iree_host_size_t queue_count;
+  iree_task_topology_node_id_t queue_node_ids[];
+} iree_hal_task_allocator_t;
+
+static const iree_hal_allocator_vtable_t iree_hal_task_allocator_vtable;
+
+static iree_hal_task_allocator_t* iree_hal_task_allocator_cast(
+    iree_hal_allocator_t* IREE_RESTRICT base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_task_allocator_vtable);
+  return (iree_hal_task_allocator_t*)base_value;
+}
+
+static void iree_hal_task_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator);
+
+iree_status_t iree_hal_task_allocator_create(
+    iree_hal_task_allocator_flags_t flags,
+    iree_hal_allocator_t* device_allocator, iree_host_size_t queue_count,
+    const iree_task_topology_node_id_t* queue_node_ids,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(!queue_count || queue_node_ids);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  if (queue_count == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at least one queue is required");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Count the distinct nodes we'll need arenas for.
+  iree_host_size_t node_count = 0;
+  for (iree_host_size_t i = 0; i < queue_count; ++i) {
+    if (queue_node_ids[i] == IREE_TASK_TOPOLOGY_NODE_ID_ANY) continue;
+    bool is_duplicate = false;
+    for (iree_host_size_t j = 0; j < i; ++j) {
+      if (queue_node_ids[j] == queue_node_ids[i]) {
+        is_duplicate = true;
+        break;
+      }
+    }
+    if (!is_duplicate) ++node_count;
+  }
+
+  iree_hal_task_allocator_t* allocator = NULL;
+  iree_host_size_t nodes_offset = iree_host_align(
+      sizeof(*allocator) + queue_count * sizeof(allocator->queue_node_ids[0]),
+      iree_max_align_t);
+  iree_host_size_t total_size =
+      nodes_offset + node_count * sizeof(allocator->nodes[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, total_size, (void**)&allocator));
+  iree_hal_resource_initialize(&iree_hal_task_allocator_vtable,
+                               &allocator->resource);
+  allocator->host_allocator = host_allocator;
+  allocator->flags = flags;
+  allocator->device_allocator = device_allocator;
+  iree_hal_allocator_retain(device_allocator);
+
+  allocator->queue_count = queue_count;
+  allocator->common_node_id = queue_node_ids[0];
+  for (iree_host_size_t i = 0; i < queue_count; ++i) {
+    allocator->queue_node_ids[i] = queue_node_ids[i];
+    if (queue_node_ids[i] != allocator->common_node_id) {
+      allocator->common_node_id = IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+    }
+  }
+
+  // Each node gets its own heap allocator backed by an arena placed on it.
+  allocator->nodes =
+      (iree_hal_task_allocator_node_t*)((uint8_t*)allocator + nodes_offset);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < queue_count && iree_status_is_ok(status);
+       ++i) {
+    iree_task_topology_node_id_t node_id = queue_node_ids[i];
+    if (node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) continue;
+    bool is_duplicate = false;
+    for (iree_host_size_t j = 0; j < allocator->node_count; ++j) {
+      if (allocator->nodes[j].node_id == node_id) {
+        is_duplicate = true;
+        break;
+      }
+    }
+    if (is_duplicate) continue;
+    iree_hal_task_allocator_node_t* node =
+        &allocator->nodes[allocator->node_count++];
+    node->node_id = node_id;
+    iree_hal_task_node_arena_initialize(node_id, &node->arena);
+    status = iree_hal_allocator_create_heap(
+        IREE_SV("local-task-node"),
+        iree_hal_task_node_arena_allocator(&node->arena), host_allocator,
+        &node->heap_allocator);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  } else {
+    iree_hal_task_allocator_destroy((iree_hal_allocator_t*)allocator);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_task_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_task_allocator_t* allocator =
+      iree_hal_task_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < allocator->node_count; ++i) {
+    iree_hal_task_allocator_node_t* node = &allocator->nodes[i];
+    iree_hal_allocator_release(node->heap_allocator);
+    iree_hal_task_node_arena_deinitialize(&node->arena);
+  }
+  iree_hal_allocator_release(allocator->device_allocator);
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_task_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_task_allocator_t* allocator =
+      (iree_hal_task_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_task_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_task_allocator_t* allocator =
+      iree_hal_task_allocator_cast(base_allocator);
+  for (iree_host_size_t i = 0; i < allocator->node_count; ++i) {
+    iree_hal_task_node_arena_trim(&allocator->nodes[i].arena);
+  }
+  return iree_hal_allocator_trim(allocator->device_allocator);
+}
+
+static void iree_hal_task_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  iree_hal_task_allocator_t* allocator =
+      iree_hal_task_allocator_cast(base_allocator);
+  iree_hal_allocator_query_statistics(allocator->device_allocator,
+                                      out_statistics);
+  IREE_STATISTICS({
+    for (iree_host_size_t i = 0; i < allocator->node_count; ++i) {
+      iree_hal_allocator_statistics_t node_statistics;
+      iree_hal_allocator_query_statistics(allocator->nodes[i].heap_allocator,
+                                          &node_statistics);
+      out_statistics->host_bytes_peak += node_statistics.host_bytes_peak;
+      out_statistics->host_bytes_allocated +=
+          node_statistics.host_bytes_allocated;
+      out_statistics->host_bytes_freed += node_statistics.host_bytes_freed;
+      out_statistics->device_bytes_peak += node_statistics.device_bytes_peak;
+      out_statistics->device_bytes_allocated +=
+          node_statistics.device_bytes_allocated;
+      out_statistics->device_bytes_freed += node_statistics.device_bytes_freed;
+    }
+  });
+}
+
+static iree_status_t iree_hal_task_allocator_query_memory_heaps(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
+    iree_host_size_t* IREE_RESTRICT out_count) {
+  iree_hal_task_allocator_t* allocator =
+      iree_hal_task_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_memory_heaps(allocator->device_allocator,
+                                               capacity, heaps, out_count);
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_task_allocator_query_buffer_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t* IREE_RESTRICT allocation_size) {
+  iree_hal_task_allocator_t* allocator =
+      iree_hal_task_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_buffer_compatibility(
+      allocator->device_allocator, *params, *allocation_size, params,
+      allocation_size);
+}
+
+// Returns the node that memory used by |queue_affinity| should be placed on.
+// This must match the queue selection performed by the device.
+static iree_task_topology_node_id_t iree_hal_task_allocator_select_node_id(
+    iree_hal_task_allocator_t* allocator,
+    iree_hal_queue_affinity_t queue_affinity) {
+  return queue_affinity == IREE_HAL_QUEUE_AFFINITY_ANY
+             ? allocator->common_node_id
+             : allocator
+                   ->queue_node_ids[queue_affinity % allocator->queue_count];
+}
+
+// Returns the allocator that memory used by |queue_affinity| should be
+// allocated from.
+static iree_hal_allocator_t* iree_hal_task_allocator_select_allocator(
+    iree_hal_task_allocator_t* allocator,
+    iree_hal_queue_affinity_t queue_affinity) {
+  iree_task_topology_node_id_t node_id =
+      iree_hal_task_allocator_select_node_id(allocator, queue_affinity);
+  for (iree_host_size_t i = 0; i < allocator->node_count; ++i) {
+    if (allocator->nodes[i].node_id == node_id) {
+      return allocator->nodes[i].heap_allocator;
+    }
+  }
+  return allocator->device_allocator;
+}
+
+static iree_status_t iree_hal_task_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_task_allocator_t* allocator =
+      iree_hal_task_allocator_cast(base_allocator);
+  return iree_hal_allocator_allocate_buffer(
+      iree_hal_task_allocator_select_allocator(allocator,
+                                               params->queue_affinity),
+      *params, allocation_size, out_buffer);
+}
+
+static void iree_hal_task_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer) {
+  // Buffers are owned by the underlying allocators and are never routed here.
+  iree_hal_buffer_destroy(buffer);
+}
+
+static iree_status_t iree_hal_task_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_task_allocator_t* allocator =
+      iree_hal_task_allocator_cast(base_allocator);
+  // Imported host memory is owned by the caller and can't be reallocated but
+  // when requested we bind its pages to the node of the queues that will use
+  // it. Pages not yet touched (such as those of mapped files) fault in on the
+  // node and resident pages are migrated when possible.
+  if (iree_all_bits_set(allocator->flags,
+                        IREE_HAL_TASK_ALLOCATOR_FLAG_MIGRATE_IMPORTS) &&
+      external_buffer->type == IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION) {
+    iree_task_topology_node_id_t node_id =
+        iree_hal_task_allocator_select_node_id(allocator,
+                                               params->queue_affinity);
+    if (node_id != IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      iree_memory_node_bind(external_buffer->handle.host_allocation.ptr,
+                            (iree_host_size_t)external_buffer->size, node_id);
+    }
+  }
+  return iree_hal_allocator_import_buffer(allocator->device_allocator, *params,
+                                          external_buffer, release_callback,
+                                          out_buffer);
+}
+
+static iree_status_t iree_hal_task_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  iree_hal_task_allocator_t* allocator =
+      iree_hal_task_allocator_cast(base_allocator);
+  return iree_hal_allocator_export_buffer(allocator->device_allocator, buffer,
+                                          requested_type, requested_flags,
+                                          out_external_buffer);
+}
+
+static const iree_hal_allocator_vtable_t iree_hal_task_allocator_vtable = {
+    .destroy = iree_hal_task_allocator_destroy,
+    .host_allocator = iree_hal_task_allocator_host_allocator,
+    .trim = iree_hal_task_allocator_trim,
+    .query_statistics = iree_hal_task_allocator_query_statistics,
+    .query_memory_heaps = iree_hal_task_allocator_query_memory_heaps,
+    .query_buffer_compatibility =
+        iree_hal_task_allocator_query_buffer_compatibility,
+    .allocate_buffer = iree_hal_task_allocator_allocate_buffer,
+    .deallocate_buffer = iree_hal_task_allocator_deallocate_buffer,
+    .import_buffer = iree_hal_task_allocator_import_buffer,
+    .export_buffer = iree_hal_task_allocator_export_buffer,
+};
@@ -0,0 +1,56 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_LOCAL_TASK_TASK_ALLOCATOR_H_
+#define IREE_HAL_DRIVERS_LOCAL_TASK_TASK_ALLOCATOR_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/task/topology.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Controls the behavior of an iree_hal_task_allocator_t.
+enum iree_hal_task_allocator_flag_bits_t {
+  IREE_HAL_TASK_ALLOCATOR_FLAG_NONE = 0u,
+  // Binds the pages of imported host allocations to the node of the queues
+  // selected and migrates those already resident. Imported memory is owned by
+  // the caller and may be shared with other devices or threads on other nodes
+  // so it is left in place unless requested.
+  IREE_HAL_TASK_ALLOCATOR_FLAG_MIGRATE_IMPORTS = 1u << 0,
+};
+typedef uint32_t iree_hal_task_allocator_flags_t;
+
+// Wraps |device_allocator| such that buffers allocated for a particular queue
+// affinity are placed on the NUMA memory node of the queues selected.
+// |queue_node_ids| contains one node per queue (matching the device queue
+// selection of `queue_affinity % queue_count`) and may contain
+// IREE_TASK_TOPOLOGY_NODE_ID_ANY for queues whose executors span nodes.
+//
+// Each distinct node gets a heap allocator backed by a per-node arena that
+// reserves memory from the system in large mappings placed on the node before
+// their pages are first touched and suballocates buffers from them. Imported
+// host allocations have their pages bound to the node in place only with
+// IREE_HAL_TASK_ALLOCATOR_FLAG_MIGRATE_IMPORTS. Requests that do not resolve to
+// a single node, imports, and exports are forwarded to |device_allocator|.
+// Placement is a hint and buffers are still returned if the system is unable
+// to place them.
+//
+// As with other allocators all buffers allocated must be released before the
+// allocator is destroyed.
+iree_status_t iree_hal_task_allocator_create(
+    iree_hal_task_allocator_flags_t flags,
+    iree_hal_allocator_t* device_allocator, iree_host_size_t queue_count,
+    const iree_task_topology_node_id_t* queue_node_ids,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_LOCAL_TASK_TASK_ALLOCATOR_H_
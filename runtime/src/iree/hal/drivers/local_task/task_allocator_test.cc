@@ -0,0 +1,222 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+#if defined(IREE_PLATFORM_LINUX)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_LINUX
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Placement policy of a page as reported by the system.
+enum class Placement {
+  kUnknown,
+  kDefault,
+  kPreferred,
+};
+
+// Returns the placement policy of the page containing |ptr|. Systems without
+// a placement API (or that deny querying it) return kUnknown.
+Placement QueryPlacement(const void* ptr) {
+#if defined(IREE_PLATFORM_LINUX) && defined(SYS_get_mempolicy)
+  int mode = -1;
+  // MPOL_F_ADDR: query the policy of the range containing the address.
+  if (syscall(SYS_get_mempolicy, &mode, NULL, 0, ptr, 2) != 0) {
+    return Placement::kUnknown;
+  }
+  // MPOL_DEFAULT = 0, MPOL_PREFERRED = 1.
+  if (mode == 0) return Placement::kDefault;
+  if (mode == 1) return Placement::kPreferred;
+#endif  // IREE_PLATFORM_LINUX && SYS_get_mempolicy
+  return Placement::kUnknown;
+}
+
+// Node 0 always exists when NUMA placement is available at all.
+constexpr iree_task_topology_node_id_t kNode0 = 0;
+
+class TaskAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), iree_allocator_system(), iree_allocator_system(),
+        &device_allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(allocator_);
+    iree_hal_allocator_release(device_allocator_);
+  }
+
+  void CreateAllocator(std::vector<iree_task_topology_node_id_t> node_ids,
+                       iree_hal_task_allocator_flags_t flags =
+                           IREE_HAL_TASK_ALLOCATOR_FLAG_NONE) {
+    IREE_ASSERT_OK(iree_hal_task_allocator_create(
+        flags, device_allocator_, node_ids.size(), node_ids.data(),
+        iree_allocator_system(), &allocator_));
+  }
+
+  iree_hal_buffer_t* Allocate(iree_hal_queue_affinity_t queue_affinity,
+                              iree_device_size_t size) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    params.queue_affinity = queue_affinity;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(
+        iree_hal_allocator_allocate_buffer(allocator_, params, size, &buffer));
+    return buffer;
+  }
+
+  // Fills |buffer| with a pattern and checks it reads back. Returns the host
+  // address of the buffer contents.
+  static uint8_t* FillAndCheck(iree_hal_buffer_t* buffer, uint8_t pattern) {
+    iree_hal_buffer_mapping_t mapping;
+    IREE_CHECK_OK(iree_hal_buffer_map_range(
+        buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_ALL, 0,
+        IREE_WHOLE_BUFFER, &mapping));
+    std::memset(mapping.contents.data, pattern, mapping.contents.data_length);
+    EXPECT_EQ(mapping.contents.data[0], pattern);
+    EXPECT_EQ(mapping.contents.data[mapping.contents.data_length - 1],
+              pattern);
+    uint8_t* data = mapping.contents.data;
+    IREE_CHECK_OK(iree_hal_buffer_unmap_range(&mapping));
+    return data;
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_allocator_t* allocator_ = NULL;
+};
+
+// Affinities select queues as the device does (affinity % queue count) and
+// buffers for queues on a known node come from that node's arena.
+TEST_F(TaskAllocatorTest, RoutesAffinitiesToNodes) {
+  CreateAllocator({kNode0, IREE_TASK_TOPOLOGY_NODE_ID_ANY});
+
+  // Queue 0 is on node 0 and its buffers are placed.
+  iree_hal_buffer_t* node_buffer = Allocate(/*queue_affinity=*/2, 64 * 1024);
+  uint8_t* node_data = FillAndCheck(node_buffer, 0xAB);
+  Placement node_placement = QueryPlacement(node_data);
+  if (node_placement == Placement::kUnknown) {
+    iree_hal_buffer_release(node_buffer);
+    GTEST_SKIP() << "NUMA placement not queryable";
+  }
+  EXPECT_EQ(node_placement, Placement::kPreferred);
+
+  // Queue 1 spans nodes and gets unplaced memory as do requests for any queue
+  // as the queues are not all on the same node.
+  iree_hal_buffer_t* any_buffer = Allocate(/*queue_affinity=*/1, 64 * 1024);
+  EXPECT_EQ(QueryPlacement(FillAndCheck(any_buffer, 0xCD)),
+            Placement::kDefault);
+  iree_hal_buffer_t* common_buffer =
+      Allocate(IREE_HAL_QUEUE_AFFINITY_ANY, 64 * 1024);
+  EXPECT_EQ(QueryPlacement(FillAndCheck(common_buffer, 0xEF)),
+            Placement::kDefault);
+
+  iree_hal_buffer_release(common_buffer);
+  iree_hal_buffer_release(any_buffer);
+  iree_hal_buffer_release(node_buffer);
+}
+
+// Queues that all share a node place memory allocated for any affinity.
+TEST_F(TaskAllocatorTest, PlacesCommonNode) {
+  CreateAllocator({kNode0, kNode0});
+  iree_hal_buffer_t* buffer = Allocate(IREE_HAL_QUEUE_AFFINITY_ANY, 4096);
+  Placement placement = QueryPlacement(FillAndCheck(buffer, 0x12));
+  EXPECT_NE(placement, Placement::kDefault);
+  iree_hal_buffer_release(buffer);
+}
+
+// Arenas service small buffers from shared slabs and large buffers from their
+// own mappings and recycle both.
+TEST_F(TaskAllocatorTest, RecyclesArenaMemory) {
+  CreateAllocator({kNode0});
+  for (iree_device_size_t size : {16, 100, 4096, 100000, 4 * 1024 * 1024}) {
+    iree_hal_buffer_t* buffer0 = Allocate(IREE_HAL_QUEUE_AFFINITY_ANY, size);
+    iree_hal_buffer_t* buffer1 = Allocate(IREE_HAL_QUEUE_AFFINITY_ANY, size);
+    uint8_t* data0 = FillAndCheck(buffer0, 0x01);
+    uint8_t* data1 = FillAndCheck(buffer1, 0x02);
+    EXPECT_NE(data0, data1);
+    EXPECT_EQ(data0[0], 0x01);
+    iree_hal_buffer_release(buffer0);
+    iree_hal_buffer_release(buffer1);
+    iree_hal_buffer_t* buffer2 = Allocate(IREE_HAL_QUEUE_AFFINITY_ANY, size);
+    FillAndCheck(buffer2, 0x03);
+    iree_hal_buffer_release(buffer2);
+  }
+  IREE_ASSERT_OK(iree_hal_allocator_trim(allocator_));
+}
+
+// Nodes that don't exist on the host (such as on single-node systems) still
+// produce usable, unplaced memory.
+TEST_F(TaskAllocatorTest, FallsBackOnMissingNodes) {
+  CreateAllocator({kNode0, 1000});
+  iree_hal_buffer_t* buffer = Allocate(/*queue_affinity=*/1, 64 * 1024);
+  FillAndCheck(buffer, 0x34);
+  iree_hal_buffer_release(buffer);
+}
+
+#if defined(IREE_PLATFORM_LINUX)
+
+// Imports only have their pages rebound when requested.
+TEST_F(TaskAllocatorTest, MigratesImportsOnlyWhenRequested) {
+  for (bool migrate : {false, true}) {
+    CreateAllocator({kNode0}, migrate
+                                  ? IREE_HAL_TASK_ALLOCATOR_FLAG_MIGRATE_IMPORTS
+                                  : IREE_HAL_TASK_ALLOCATOR_FLAG_NONE);
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t length = 4 * page_size;
+    void* ptr = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(ptr, MAP_FAILED);
+    std::memset(ptr, 0x56, length);
+    if (QueryPlacement(ptr) == Placement::kUnknown) {
+      munmap(ptr, length);
+      GTEST_SKIP() << "NUMA placement not queryable";
+    }
+
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_external_buffer_t external_buffer = {};
+    external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+    external_buffer.size = length;
+    external_buffer.handle.host_allocation.ptr = ptr;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_import_buffer(
+        allocator_, params, &external_buffer,
+        iree_hal_buffer_release_callback_null(), &buffer));
+    EXPECT_EQ(QueryPlacement(ptr),
+              migrate ? Placement::kPreferred : Placement::kDefault);
+    EXPECT_EQ(((uint8_t*)ptr)[length - 1], 0x56);
+
+    iree_hal_buffer_release(buffer);
+    munmap(ptr, length);
+    iree_hal_allocator_release(allocator_);
+    allocator_ = NULL;
+  }
+}
+
+#endif  // IREE_PLATFORM_LINUX
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -26,6 +26,98 @@
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// Maximum number of buffer range accesses tracked while recording. Accesses
+// are pruned as they are superseded by later writes but when a command buffer
+// touches many distinct ranges without ever overwriting them we fall back to a
+// global barrier and start tracking fresh.
+#define IREE_HAL_TASK_CMD_MAX_TRACKED_ACCESSES 128
+
+typedef struct iree_hal_task_cmd_node_t iree_hal_task_cmd_node_t;
+
+// A dispatch binding sourced from a binding table slot.
+// The buffer is only known when the command buffer is executed with a binding
+// table and the dispatch binding pointers are patched on each instantiation.
+typedef struct iree_hal_task_cmd_binding_ref_t {
+  // Index of the binding in the dense dispatch binding tables.
+  uint32_t binding_index;
+  // Binding table slot the buffer is sourced from.
+  uint32_t slot;
+  // Range of the binding relative to the binding table entry.
+  iree_device_size_t offset;
+  iree_device_size_t length;
+} iree_hal_task_cmd_binding_ref_t;
+
+// A link to a node in the task DAG, used both for successor edges and lists.
+typedef struct iree_hal_task_cmd_edge_t {
+  struct iree_hal_task_cmd_edge_t* next;
+  iree_hal_task_cmd_node_t* node;
+} iree_hal_task_cmd_edge_t;
+
+// A task in the command buffer DAG under construction.
+// As each task can only have a single completion task the edges are tracked
+// here during recording and the task relationships are only established when
+// recording ends and all successors are known.
+struct iree_hal_task_cmd_node_t {
+  // Next node in recording order.
+  iree_hal_task_cmd_node_t* next;
+  // Next node in the frontier list, most recently recorded first.
+  iree_hal_task_cmd_node_t* frontier_next;
+  // Ordinal of the node in recording order.
+  iree_host_size_t ordinal;
+  // Task executing the command (or a barrier joining other nodes). The task is
+  // the header of a command structure of |cmd_size| bytes.
+  iree_task_t* task;
+  iree_host_size_t cmd_size;
+  // Dispatch bindings that are resolved from the binding table.
+  iree_host_size_t binding_ref_count;
+  iree_hal_task_cmd_binding_ref_t* binding_refs;
+  // Nodes that must execute after this one, most recently added first.
+  iree_hal_task_cmd_edge_t* successors;
+  iree_host_size_t successor_count;
+  iree_host_size_t predecessor_count;
+};
+
+// A range of an allocated buffer accessed by a recorded command.
+typedef struct iree_hal_task_cmd_access_t {
+  // Node of the command performing the access.
+  iree_hal_task_cmd_node_t* node;
+  // Allocated buffer the range is within. Buffers are retained by the resource
+  // set for the lifetime of the command buffer.
+  iree_hal_buffer_t* buffer;
+  // Absolute byte range [offset, end) within the allocated buffer.
+  iree_device_size_t offset;
+  iree_device_size_t end;
+  // Execution barrier epoch the access was recorded in.
+  uint32_t epoch;
+  // True if the command may write to the range.
+  bool is_write;
+} iree_hal_task_cmd_access_t;
+
+// Compact recorded form of a DAG node used to instantiate tasks.
+// Reusable command buffers keep the recorded commands pristine and copy them
+// each time they are issued: the task structures are mutated as they execute
+// and the same command buffer may be in-flight multiple times.
+typedef struct iree_hal_task_cmd_template_t {
+  // Recorded command with the task as its header.
+  iree_task_t* task;
+  iree_host_size_t cmd_size;
+  // Indices of the nodes that execute after this one in recording order.
+  iree_host_size_t successor_count;
+  const uint32_t* successors;
+  // Dispatch bindings that are resolved from the binding table.
+  iree_host_size_t binding_ref_count;
+  const iree_hal_task_cmd_binding_ref_t* binding_refs;
+  // True if the node has no predecessors and is ready when issued.
+  bool is_root;
+} iree_hal_task_cmd_template_t;
+
+// A command buffer event and the node that signals it.
+typedef struct iree_hal_task_cmd_event_t {
+  struct iree_hal_task_cmd_event_t* next;
+  const iree_hal_event_t* event;
+  iree_hal_task_cmd_node_t* node;
+} iree_hal_task_cmd_event_t;
+
 // iree/task/-based command buffer.
 // We track a minimal amount of state here and incrementally build out the task
 // DAG that we can submit to the task system directly. There's no intermediate
@@ -34,6 +126,14 @@
 // additional allocations required during recording or execution. That means our
 // command buffer here is essentially just a builder for the task system types
 // and manager of the lifetime of the tasks.
+//
+// Execution barriers do not join all prior work: instead we track the buffer
+// ranges each command accesses and only add edges between commands separated
+// by a barrier when they have a read-after-write, write-after-read, or
+// write-after-write hazard. Independent commands (such as parallel branches of
+// a model) are able to execute concurrently even across barriers. Events
+// signaled within the command buffer become join tasks that commands recorded
+// after a wait on them depend on.
 typedef struct iree_hal_task_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
@@ -47,36 +147,49 @@ typedef struct iree_hal_task_command_buffer_t {
   // Reset on each begin.
   iree_hal_resource_set_t* resource_set;
 
-  // One or more tasks at the root of the command buffer task DAG.
-  // These tasks are all able to execute concurrently and will be the initial
-  // ready task set in the submission.
-  iree_task_list_t root_tasks;
+  // Recorded task DAG in recording order, populated when recording ends.
+  // Tasks with no predecessors are the roots of the DAG and are all able to
+  // execute concurrently as the initial ready task set in the submission.
+  // Only once all leaf tasks (those without successors) have completed
+  // execution will the command buffer be considered completed as a whole.
+  iree_host_size_t template_count;
+  iree_hal_task_cmd_template_t* templates;
 
-  // One or more tasks at the leaves of the DAG.
-  // Only once all these tasks have completed execution will the command buffer
-  // be considered completed as a whole.
-  //
-  // An empty list indicates that root_tasks are also the leaves.
-  iree_task_list_t leaf_tasks;
+  // Total bytes required to instantiate the DAG for execution.
+  iree_host_size_t instance_size;
+
+  // True once the command buffer has been recorded.
+  bool is_recorded;
 
   // TODO(benvanik): move this out of the struct and allocate from the arena -
-  // we only need this during recording and it's ~4KB of waste otherwise.
+  // we only need this during recording and it's ~10KB of waste otherwise.
   // State tracked within the command buffer during recording only.
   struct {
-    // The last global barrier that was inserted, if any.
-    // The barrier is allocated and inserted into the DAG when requested but the
-    // actual barrier dependency list is only allocated and set on flushes.
-    // This lets us allocate the appropriately sized barrier task list from the
-    // arena even though when the barrier is recorded we don't yet know what
-    // other tasks we'll be emitting as we walk the command stream.
-    iree_task_barrier_t* open_barrier;
+    // All nodes in the DAG in recording order.
+    iree_host_size_t node_count;
+    iree_hal_task_cmd_node_t* node_head;
+    iree_hal_task_cmd_node_t* node_tail;
+
+    // Nodes recorded since the last join, most recently recorded first. All
+    // nodes without successors are in the list but the list may also contain
+    // nodes that have since gained successors as they are only removed by the
+    // next join. All nodes recorded before the last join have successors.
+    iree_hal_task_cmd_node_t* frontier_head;
+
+    // Current execution barrier epoch. Commands recorded in the same epoch may
+    // execute concurrently regardless of the resources they access.
+    uint32_t epoch;
 
-    // The number of tasks in the open barrier (|open_tasks|), used to quickly
-    // allocate storage for the task list without needing to walk the list.
-    iree_host_size_t open_task_count;
+    // Nodes that all subsequently recorded commands must execute after. These
+    // come from waits on events and global barriers.
+    iree_hal_task_cmd_edge_t* wait_nodes;
 
-    // All execution tasks emitted that must execute after |open_barrier|.
-    iree_task_list_t open_tasks;
+    // Events signaled within the command buffer.
+    iree_hal_task_cmd_event_t* events;
+
+    // Buffer ranges accessed by commands that later commands may depend on.
+    iree_host_size_t access_count;
+    iree_hal_task_cmd_access_t accesses[IREE_HAL_TASK_CMD_MAX_TRACKED_ACCESSES];
 
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -89,6 +202,20 @@ typedef struct iree_hal_task_command_buffer_t {
         binding_lengths[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
                         IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
 
+    // Allocated buffer and absolute offset of each binding used to track the
+    // ranges accessed by dispatches. Indirect bindings have no buffer and
+    // instead the offset is relative to the binding table slot.
+    iree_hal_buffer_t*
+        binding_buffers[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                        IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+    iree_device_size_t
+        binding_offsets[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                        IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+
+    // Binding table slot + 1 of each indirect binding or 0 if direct.
+    uint32_t binding_slots[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                           IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+
     // All available push constants updated each time push_constants is called.
     // Reset only with the command buffer and otherwise will maintain its values
     // during recording to allow for partial push_constants updates.
@@ -115,25 +242,6 @@ iree_status_t iree_hal_task_command_buffer_create(
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
-  }
-  if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
-  }
-
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_task_command_buffer_t* command_buffer = NULL;
@@ -146,8 +254,10 @@ iree_status_t iree_hal_task_command_buffer_create(
     command_buffer->host_allocator = host_allocator;
     command_buffer->scope = scope;
     iree_arena_initialize(block_pool, &command_buffer->arena);
-    iree_task_list_initialize(&command_buffer->root_tasks);
-    iree_task_list_initialize(&command_buffer->leaf_tasks);
+    command_buffer->template_count = 0;
+    command_buffer->templates = NULL;
+    command_buffer->instance_size = 0;
+    command_buffer->is_recorded = false;
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
@@ -170,8 +280,8 @@ static void iree_hal_task_command_buffer_destroy(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
-  iree_task_list_discard(&command_buffer->root_tasks);
-  iree_task_list_discard(&command_buffer->leaf_tasks);
+  command_buffer->template_count = 0;
+  command_buffer->templates = NULL;
   iree_arena_deinitialize(&command_buffer->arena);
   iree_hal_resource_set_free(command_buffer->resource_set);
   iree_allocator_free(host_allocator, command_buffer);
@@ -189,158 +299,451 @@ bool iree_hal_task_command_buffer_isa(
 // iree_hal_task_command_buffer_t recording
 //===----------------------------------------------------------------------===//
 
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
-    iree_hal_task_command_buffer_t* command_buffer);
-
 static iree_status_t iree_hal_task_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  if (!iree_task_list_is_empty(&command_buffer->root_tasks)) {
+  if (command_buffer->is_recorded) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "command buffer cannot be re-recorded");
   }
   return iree_ok_status();
 }
 
+static iree_status_t iree_hal_task_command_buffer_build_templates(
+    iree_hal_task_command_buffer_t* command_buffer);
+
 static iree_status_t iree_hal_task_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // Flush any open barriers.
+  // Compact the DAG now that we know the successors of every task.
   IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
-
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
-  }
+      iree_hal_task_command_buffer_build_templates(command_buffer));
+  command_buffer->is_recorded = true;
 
   iree_hal_resource_set_freeze(command_buffer->resource_set);
 
   return iree_ok_status();
 }
 
-// Flushes all open tasks to the previous barrier and prepares for more
-// recording. The root tasks are also populated here when required as this is
-// the one place where we can see both halves of the most recent synchronization
-// event: those tasks recorded prior (if any) and the task that marks the set of
-// tasks that will be recorded after (if any).
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
-    iree_hal_task_command_buffer_t* command_buffer) {
-  iree_task_barrier_t* open_barrier = command_buffer->state.open_barrier;
-  if (open_barrier != NULL) {
-    // There is an open barrier we need to fixup the fork out to all of the open
-    // tasks that were recorded after it.
-    iree_task_t* task_head =
-        iree_task_list_front(&command_buffer->state.open_tasks);
-    iree_host_size_t dependent_task_count =
-        command_buffer->state.open_task_count;
-    if (dependent_task_count == 1) {
-      // Special-case: only one open task so we can avoid the additional barrier
-      // overhead by reusing the completion task.
-      iree_task_set_completion_task(&open_barrier->header, task_head);
-    } else if (dependent_task_count > 1) {
-      // Allocate the list of tasks we'll stash back on the previous barrier.
-      // Since we couldn't know at the time how many tasks would end up in the
-      // barrier we had to defer it until now.
-      iree_task_t** dependent_tasks = NULL;
-      IREE_RETURN_IF_ERROR(iree_arena_allocate(
-          &command_buffer->arena, dependent_task_count * sizeof(iree_task_t*),
-          (void**)&dependent_tasks));
-      iree_task_t* task = task_head;
-      for (iree_host_size_t i = 0; i < dependent_task_count; ++i) {
-        dependent_tasks[i] = task;
-        task = task->next_task;
-      }
-      iree_task_barrier_set_dependent_tasks(open_barrier, dependent_task_count,
-                                            dependent_tasks);
-    }
+//===----------------------------------------------------------------------===//
+// iree_hal_task_command_buffer_t dependency tracking
+//===----------------------------------------------------------------------===//
+
+// Adds an edge ensuring |to| executes after |from|.
+// Edges are only ever added to the most recently recorded node and any existing
+// edge between the two will be at the head of the successor list.
+static iree_status_t iree_hal_task_command_buffer_add_edge(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* from, iree_hal_task_cmd_node_t* to) {
+  if (from == to) return iree_ok_status();
+  if (from->successors && from->successors->node == to) {
+    return iree_ok_status();
+  }
+  iree_hal_task_cmd_edge_t* edge = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*edge), (void**)&edge));
+  edge->next = from->successors;
+  edge->node = to;
+  from->successors = edge;
+  ++from->successor_count;
+  ++to->predecessor_count;
+  return iree_ok_status();
+}
+
+// Appends |task| to the DAG as a new node ordered after any pending waits.
+// |cmd_size| is the total size of the command the task is the header of.
+static iree_status_t iree_hal_task_command_buffer_append_node(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_host_size_t cmd_size, iree_hal_task_cmd_node_t** out_node) {
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*node), (void**)&node));
+  memset(node, 0, sizeof(*node));
+  node->ordinal = command_buffer->state.node_count++;
+  node->task = task;
+  node->cmd_size = cmd_size;
+  if (command_buffer->state.node_tail) {
+    command_buffer->state.node_tail->next = node;
+  } else {
+    command_buffer->state.node_head = node;
   }
-  command_buffer->state.open_barrier = NULL;
-
-  // Move the open tasks to the tail as they represent the first half of the
-  // *next* barrier that will be inserted.
-  if (command_buffer->state.open_task_count > 0) {
-    iree_task_list_move(&command_buffer->state.open_tasks,
-                        &command_buffer->leaf_tasks);
-    command_buffer->state.open_task_count = 0;
+  command_buffer->state.node_tail = node;
+  node->frontier_next = command_buffer->state.frontier_head;
+  command_buffer->state.frontier_head = node;
+  for (iree_hal_task_cmd_edge_t* wait = command_buffer->state.wait_nodes;
+       wait != NULL; wait = wait->next) {
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edge(
+        command_buffer, wait->node, node));
   }
+  *out_node = node;
+  return iree_ok_status();
+}
 
+// Appends a barrier node that executes after all nodes recorded so far.
+// Only nodes on the frontier (those without successors) need edges as all other
+// nodes are transitively ordered before them. Each node is visited by at most
+// one join such that recording remains linear in the number of nodes.
+static iree_status_t iree_hal_task_command_buffer_append_join(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t** out_node) {
+  iree_task_barrier_t* barrier = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*barrier), (void**)&barrier));
+  iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_node(
+      command_buffer, &barrier->header, sizeof(*barrier), &node));
+  for (iree_hal_task_cmd_node_t* frontier = node->frontier_next;
+       frontier != NULL; frontier = frontier->frontier_next) {
+    if (frontier->successor_count > 0) continue;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_command_buffer_add_edge(command_buffer, frontier, node));
+  }
+  // The join is now the only node without successors.
+  node->frontier_next = NULL;
+  *out_node = node;
   return iree_ok_status();
 }
 
 // Emits a global barrier, splitting execution into all prior recorded tasks
-// and all subsequent recorded tasks. This is currently the critical piece that
-// limits our concurrency: changing to fine-grained barriers (via barrier
-// buffers or events) will allow more work to overlap at the cost of more brain
-// to build out the proper task graph.
+// and all subsequent recorded tasks. This is only used when we are unable to
+// track dependencies precisely (waits on unknown events or too many accesses).
 static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
     iree_hal_task_command_buffer_t* command_buffer) {
-  // Flush open tasks to the previous barrier. This resets our state such that
-  // we can assign the new open barrier and start recording tasks for it.
-  // Previous tasks will be moved into the leaf_tasks list.
+  if (!command_buffer->state.node_head) {
+    // Nothing recorded yet that subsequent tasks need to wait on.
+    return iree_ok_status();
+  }
+  iree_hal_task_cmd_node_t* node = NULL;
   IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
+      iree_hal_task_command_buffer_append_join(command_buffer, &node));
 
-  // Allocate the new open barrier.
-  // As we are recording forward we can't yet assign the dependent tasks (the
-  // second half of the synchronization domain) and instead are just inserting
-  // it so we can setup the join from previous tasks (the first half of the
-  // synchronization domain).
-  iree_task_barrier_t* barrier = NULL;
+  // All subsequent tasks execute after the join so any prior waits and
+  // accesses are satisfied.
+  iree_hal_task_cmd_edge_t* wait = NULL;
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
-                                           sizeof(*barrier), (void**)&barrier));
-  iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+                                           sizeof(*wait), (void**)&wait));
+  wait->next = NULL;
+  wait->node = node;
+  command_buffer->state.wait_nodes = wait;
+  command_buffer->state.access_count = 0;
+  ++command_buffer->state.epoch;
+
+  return iree_ok_status();
+}
+
+// Drops tracked accesses that are fully covered by a later write from a prior
+// epoch. Any future access conflicting with the dropped range also conflicts
+// with the covering write which itself executes after the dropped access.
+static void iree_hal_task_command_buffer_compact_accesses(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  iree_hal_task_cmd_access_t* accesses = command_buffer->state.accesses;
+  const uint32_t epoch = command_buffer->state.epoch;
+  iree_host_size_t access_count = 0;
+  for (iree_host_size_t i = 0; i < command_buffer->state.access_count; ++i) {
+    const iree_hal_task_cmd_access_t* access = &accesses[i];
+    bool is_covered = false;
+    for (iree_host_size_t j = i + 1; j < command_buffer->state.access_count;
+         ++j) {
+      const iree_hal_task_cmd_access_t* write = &accesses[j];
+      if (!write->is_write || write->epoch <= access->epoch ||
+          write->epoch >= epoch) {
+        continue;
+      }
+      if (!write->buffer ||
+          (write->buffer == access->buffer && write->offset <= access->offset &&
+           write->end >= access->end)) {
+        is_covered = true;
+        break;
+      }
+    }
+    if (!is_covered) accesses[access_count++] = *access;
+  }
+  command_buffer->state.access_count = access_count;
+}
+
+// Ensures there is capacity for tracking |count| additional accesses. Must be
+// called before the node performing the accesses is appended so that if we
+// need to fall back to a global barrier the node executes after it.
+static iree_status_t iree_hal_task_command_buffer_reserve_accesses(
+    iree_hal_task_command_buffer_t* command_buffer, iree_host_size_t count) {
+  if (command_buffer->state.access_count + count <=
+      IREE_HAL_TASK_CMD_MAX_TRACKED_ACCESSES) {
+    return iree_ok_status();
+  }
+  iree_hal_task_command_buffer_compact_accesses(command_buffer);
+  if (command_buffer->state.access_count + count <=
+      IREE_HAL_TASK_CMD_MAX_TRACKED_ACCESSES) {
+    return iree_ok_status();
+  }
+  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+}
+
+// Records that |node| accesses [offset, offset + length) of the allocated
+// |buffer| and adds edges from any prior conflicting accesses separated from it
+// by an execution barrier (read-after-write, write-after-read, and
+// write-after-write). Capacity must have been reserved.
+//
+// A NULL |buffer| indicates an access to an unknown buffer (such as one sourced
+// from a binding table) that conflicts with all other accesses.
+//
+// NOTE: aliasing between distinct allocated buffers (such as two imports of the
+// same host memory) is not tracked.
+static iree_status_t iree_hal_task_command_buffer_track_access(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_hal_buffer_t* buffer,
+    iree_device_size_t offset, iree_device_size_t length, bool is_write) {
+  const uint32_t epoch = command_buffer->state.epoch;
+  const iree_device_size_t end = offset + length;
+  for (iree_host_size_t i = 0; i < command_buffer->state.access_count; ++i) {
+    const iree_hal_task_cmd_access_t* access =
+        &command_buffer->state.accesses[i];
+    if (access->epoch == epoch) continue;
+    if (!is_write && !access->is_write) continue;
+    if (buffer && access->buffer) {
+      if (access->buffer != buffer) continue;
+      if (access->offset >= end || offset >= access->end) continue;
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edge(
+        command_buffer, access->node, node));
+  }
+  IREE_ASSERT_LT(command_buffer->state.access_count,
+                 IREE_HAL_TASK_CMD_MAX_TRACKED_ACCESSES);
+  iree_hal_task_cmd_access_t* access =
+      &command_buffer->state.accesses[command_buffer->state.access_count++];
+  access->node = node;
+  access->buffer = buffer;
+  access->offset = offset;
+  access->end = end;
+  access->epoch = epoch;
+  access->is_write = is_write;
+  return iree_ok_status();
+}
+
+// Tracks an access to the given range of |buffer| by |node|. The range is
+// resolved to the underlying allocated buffer such that subspans are checked
+// against each other.
+static iree_status_t iree_hal_task_command_buffer_track_buffer_access(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_hal_buffer_t* buffer,
+    iree_device_size_t offset, iree_device_size_t length, bool is_write) {
+  if (length == IREE_WHOLE_BUFFER) {
+    length = iree_hal_buffer_byte_length(buffer) - offset;
+  }
+  return iree_hal_task_command_buffer_track_access(
+      command_buffer, node, iree_hal_buffer_allocated_buffer(buffer),
+      iree_hal_buffer_byte_offset(buffer) + offset, length, is_write);
+}
+
+// Compacts the recorded DAG into templates that can be instantiated for
+// execution and computes the storage required for doing so.
+static iree_status_t iree_hal_task_command_buffer_build_templates(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  const bool is_one_shot =
+      iree_all_bits_set(command_buffer->base.mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+  iree_host_size_t template_count = command_buffer->state.node_count;
+  iree_host_size_t edge_count = 0;
+  for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head;
+       node != NULL; node = node->next) {
+    edge_count += node->successor_count;
+  }
 
-  // If there were previous tasks then join them to the barrier.
-  for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
-       task != NULL; task = task->next_task) {
-    iree_task_set_completion_task(task, &barrier->header);
+  iree_hal_task_cmd_template_t* templates = NULL;
+  uint32_t* successors = NULL;
+  if (template_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena, template_count * sizeof(*templates),
+        (void**)&templates));
+  }
+  if (edge_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                             edge_count * sizeof(*successors),
+                                             (void**)&successors));
   }
 
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
+  // Instances need a table mapping node ordinals to their tasks, storage for
+  // fork barriers and their dependent task lists, and (if the command buffer
+  // may be reused) copies of the commands.
+  iree_host_size_t instance_size =
+      iree_host_align(template_count * sizeof(iree_task_t*), iree_max_align_t);
+  iree_hal_task_cmd_template_t* cmd_template = templates;
+  for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head;
+       node != NULL; node = node->next, ++cmd_template) {
+    cmd_template->task = node->task;
+    cmd_template->cmd_size = node->cmd_size;
+    cmd_template->successor_count = node->successor_count;
+    cmd_template->successors = successors;
+    cmd_template->binding_ref_count = node->binding_ref_count;
+    cmd_template->binding_refs = node->binding_refs;
+    cmd_template->is_root = node->predecessor_count == 0;
+
+    // Successors are tracked most recent first; flip them back into recording
+    // order so that they are enqueued in the order they were recorded.
+    iree_host_size_t i = node->successor_count;
+    for (iree_hal_task_cmd_edge_t* edge = node->successors; edge != NULL;
+         edge = edge->next) {
+      successors[--i] = (uint32_t)edge->node->ordinal;
+    }
+    successors += node->successor_count;
+
+    if (!is_one_shot) {
+      instance_size += iree_host_align(node->cmd_size, iree_max_align_t);
+    }
+    const bool is_barrier = node->task->type == IREE_TASK_TYPE_BARRIER;
+    if (node->successor_count > 1 || (is_barrier && node->successor_count)) {
+      instance_size += iree_host_align(
+          node->successor_count * sizeof(iree_task_t*), iree_max_align_t);
+    }
+    if (node->successor_count > 1 && !is_barrier) {
+      instance_size +=
+          iree_host_align(sizeof(iree_task_barrier_t), iree_max_align_t);
+    }
   }
 
-  // Reset the tail of the command buffer to the barrier. This leaves us in a
-  // consistent state if the recording ends immediate after this (the barrier
-  // will be the last task).
-  iree_task_list_t* target_task_list =
-      iree_task_list_is_empty(&command_buffer->root_tasks)
-          ? &command_buffer->root_tasks
-          : &command_buffer->leaf_tasks;
-  iree_task_list_initialize(target_task_list);
-  iree_task_list_push_back(target_task_list, &barrier->header);
+  command_buffer->template_count = template_count;
+  command_buffer->templates = templates;
+  command_buffer->instance_size = instance_size;
 
-  // NOTE: all new tasks emitted will be executed after this barrier.
-  command_buffer->state.open_barrier = barrier;
-  command_buffer->state.open_task_count = 0;
+  // The recording state is no longer needed; the templates own the DAG now.
+  memset(&command_buffer->state, 0, sizeof(command_buffer->state));
 
   return iree_ok_status();
 }
 
-// Emits a the given execution |task| into the current open synchronization
-// scope (after state.open_barrier and before the next barrier).
-static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
-    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
-  if (command_buffer->state.open_barrier == NULL) {
-    // If there is no open barrier then we are at the head and going right into
-    // the task DAG.
-    iree_task_list_push_back(&command_buffer->leaf_tasks, task);
-  } else {
-    // Append to the open task list that will be flushed to the open barrier.
-    iree_task_list_push_back(&command_buffer->state.open_tasks, task);
-    ++command_buffer->state.open_task_count;
+static iree_status_t iree_hal_cmd_dispatch_resolve_bindings(
+    iree_task_t* task, iree_host_size_t binding_ref_count,
+    const iree_hal_task_cmd_binding_ref_t* binding_refs,
+    iree_hal_buffer_binding_table_t binding_table);
+
+// Clones the command of |cmd_template| into |storage| such that it can be
+// issued independently of any other instance. Indirect bindings are resolved
+// from |binding_table|.
+static iree_status_t iree_hal_task_cmd_template_clone(
+    const iree_hal_task_cmd_template_t* cmd_template,
+    iree_hal_buffer_binding_table_t binding_table, void* storage,
+    iree_task_t** out_task) {
+  iree_task_t* task = (iree_task_t*)storage;
+  memcpy(task, cmd_template->task, cmd_template->cmd_size);
+
+  // Commands use themselves as the closure context and need to reference the
+  // clone instead of the recorded command.
+  switch (task->type) {
+    case IREE_TASK_TYPE_CALL: {
+      iree_task_call_t* call_task = (iree_task_call_t*)task;
+      if (call_task->closure.user_context == cmd_template->task) {
+        call_task->closure.user_context = task;
+      }
+      break;
+    }
+    case IREE_TASK_TYPE_DISPATCH: {
+      iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+      if (dispatch_task->closure.user_context == cmd_template->task) {
+        dispatch_task->closure.user_context = task;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+
+  if (cmd_template->binding_ref_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_hal_cmd_dispatch_resolve_bindings(
+        task, cmd_template->binding_ref_count, cmd_template->binding_refs,
+        binding_table));
   }
+
+  *out_task = task;
+  return iree_ok_status();
+}
+
+// Instantiates the recorded DAG for execution from |arena|. Reusable command
+// buffers clone each recorded command while one-shot command buffers link the
+// recorded tasks in-place. Leaf tasks complete into |completion_task| and the
+// root tasks are appended to |out_root_tasks|.
+static iree_status_t iree_hal_task_command_buffer_instantiate(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_arena_allocator_t* arena, iree_task_t* completion_task,
+    iree_task_list_t* out_root_tasks) {
+  const bool is_one_shot =
+      iree_all_bits_set(command_buffer->base.mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+  const iree_host_size_t template_count = command_buffer->template_count;
+  const iree_hal_task_cmd_template_t* templates = command_buffer->templates;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)template_count);
+
+  // All storage for the instance comes from a single allocation.
+  uint8_t* storage = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(arena, command_buffer->instance_size,
+                              (void**)&storage));
+  iree_task_t** tasks = (iree_task_t**)storage;
+  storage +=
+      iree_host_align(template_count * sizeof(iree_task_t*), iree_max_align_t);
+  for (iree_host_size_t i = 0; i < template_count; ++i) {
+    const iree_hal_task_cmd_template_t* cmd_template = &templates[i];
+    if (is_one_shot) {
+      tasks[i] = cmd_template->task;
+      if (cmd_template->binding_ref_count > 0) {
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_hal_cmd_dispatch_resolve_bindings(
+                    tasks[i], cmd_template->binding_ref_count,
+                    cmd_template->binding_refs, binding_table));
+      }
+    } else {
+      IREE_RETURN_AND_END_ZONE_IF_ERROR(
+          z0, iree_hal_task_cmd_template_clone(cmd_template, binding_table,
+                                               storage, &tasks[i]));
+      storage += iree_host_align(cmd_template->cmd_size, iree_max_align_t);
+    }
+  }
+
+  // Link each task to its successors. Tasks with a single successor use it as
+  // their completion task and those with multiple successors fork out via a
+  // barrier.
+  for (iree_host_size_t i = 0; i < template_count; ++i) {
+    const iree_hal_task_cmd_template_t* cmd_template = &templates[i];
+    iree_task_t* task = tasks[i];
+    if (cmd_template->is_root) {
+      iree_task_list_push_back(out_root_tasks, task);
+    }
+    const bool is_barrier = task->type == IREE_TASK_TYPE_BARRIER;
+    if (cmd_template->successor_count == 0) {
+      // Leaf task; the command buffer is complete after all leaves complete.
+      if (completion_task) iree_task_set_completion_task(task, completion_task);
+      continue;
+    } else if (cmd_template->successor_count == 1 && !is_barrier) {
+      // Special-case: only one successor so we can avoid the additional barrier
+      // overhead by reusing the completion task.
+      iree_task_set_completion_task(task, tasks[cmd_template->successors[0]]);
+      continue;
+    }
+    iree_task_t** dependent_tasks = (iree_task_t**)storage;
+    storage += iree_host_align(
+        cmd_template->successor_count * sizeof(iree_task_t*), iree_max_align_t);
+    for (iree_host_size_t j = 0; j < cmd_template->successor_count; ++j) {
+      dependent_tasks[j] = tasks[cmd_template->successors[j]];
+    }
+    iree_task_barrier_t* barrier = NULL;
+    if (is_barrier) {
+      barrier = (iree_task_barrier_t*)task;
+    } else {
+      barrier = (iree_task_barrier_t*)storage;
+      storage +=
+          iree_host_align(sizeof(iree_task_barrier_t), iree_max_align_t);
+      iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+      iree_task_set_completion_task(task, &barrier->header);
+    }
+    iree_task_barrier_set_dependent_tasks(
+        barrier, cmd_template->successor_count, dependent_tasks);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
 
@@ -357,34 +760,28 @@ iree_status_t iree_hal_task_command_buffer_issue(
   IREE_ASSERT_TRUE(command_buffer);
 
   // If the command buffer is empty (valid!) then we are a no-op.
-  bool has_root_tasks = !iree_task_list_is_empty(&command_buffer->root_tasks);
-  if (!has_root_tasks) {
+  if (command_buffer->template_count == 0) {
     return iree_ok_status();
   }
 
-  bool has_leaf_tasks = !iree_task_list_is_empty(&command_buffer->leaf_tasks);
-  if (has_leaf_tasks) {
-    // Chain the retire task onto the leaf tasks as their completion indicates
-    // that all commands have completed.
-    for (iree_task_t* task = command_buffer->leaf_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
-  } else {
-    // If we have no leaf tasks it means that this is a single layer DAG and
-    // after the root tasks complete the entire command buffer has completed.
-    for (iree_task_t* task = command_buffer->root_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
+  // Instantiate the DAG with the leaf tasks chained to the retire task as their
+  // completion indicates that all commands have completed.
+  iree_task_list_t root_tasks;
+  iree_task_list_initialize(&root_tasks);
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_instantiate(
+      command_buffer, iree_hal_buffer_binding_table_empty(), arena, retire_task,
+      &root_tasks));
+
+  // One-shot command buffers issue their recorded tasks directly and cannot
+  // be issued again.
+  if (iree_all_bits_set(command_buffer->base.mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
+    command_buffer->template_count = 0;
   }
 
   // Enqueue all root tasks that are ready to run immediately.
-  // After this all of the command buffer tasks are owned by the submission and
-  // we need to ensure the command buffer doesn't try to discard them.
-  iree_task_submission_enqueue_list(pending_submission,
-                                    &command_buffer->root_tasks);
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
+  // After this all of the command buffer tasks are owned by the submission.
+  iree_task_submission_enqueue_list(pending_submission, &root_tasks);
 
   return iree_ok_status();
 }
@@ -421,9 +818,13 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // TODO(benvanik): actual DAG construction. Right now we are just doing simple
-  // global barriers each time and forcing a join-fork point.
-  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+  // Commands recorded after the barrier depend only on the commands prior to
+  // it that access overlapping buffer ranges. The edges are added as the
+  // commands are recorded and all we need to do here is start a new epoch.
+  // Memory and buffer barriers are implied as the local device is coherent.
+  ++command_buffer->state.epoch;
+
+  return iree_ok_status();
 }
 
 //===----------------------------------------------------------------------===//
@@ -433,7 +834,29 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
 static iree_status_t iree_hal_task_command_buffer_signal_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+
+  // The event is signaled once all prior commands have completed. We model
+  // that with a join task that waits can depend on.
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_append_join(command_buffer, &node));
+
+  iree_hal_task_cmd_event_t* entry = NULL;
+  for (entry = command_buffer->state.events; entry != NULL;
+       entry = entry->next) {
+    if (entry->event == event) break;
+  }
+  if (!entry) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                             sizeof(*entry), (void**)&entry));
+    entry->next = command_buffer->state.events;
+    entry->event = event;
+    command_buffer->state.events = entry;
+  }
+  entry->node = node;
+
   return iree_ok_status();
 }
 
@@ -444,7 +867,12 @@ static iree_status_t iree_hal_task_command_buffer_signal_event(
 static iree_status_t iree_hal_task_command_buffer_reset_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+  for (iree_hal_task_cmd_event_t* entry = command_buffer->state.events;
+       entry != NULL; entry = entry->next) {
+    if (entry->event == event) entry->node = NULL;
+  }
   return iree_ok_status();
 }
 
@@ -463,8 +891,33 @@ static iree_status_t iree_hal_task_command_buffer_wait_events(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  // TODO(#4518): implement events. For now we just insert global barriers.
-  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+
+  // All commands recorded after the wait execute after the join tasks of the
+  // waited events. Events not signaled within this command buffer (or that
+  // have been reset) have no task we can depend on and we conservatively wait
+  // for everything recorded so far.
+  for (iree_host_size_t i = 0; i < event_count; ++i) {
+    iree_hal_task_cmd_event_t* entry = command_buffer->state.events;
+    for (; entry != NULL; entry = entry->next) {
+      if (entry->event == events[i]) break;
+    }
+    if (!entry || !entry->node) {
+      return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+    }
+  }
+  for (iree_host_size_t i = 0; i < event_count; ++i) {
+    iree_hal_task_cmd_event_t* entry = command_buffer->state.events;
+    for (; entry->event != events[i]; entry = entry->next) {
+    }
+    iree_hal_task_cmd_edge_t* wait = NULL;
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                             sizeof(*wait), (void**)&wait));
+    wait->next = command_buffer->state.wait_nodes;
+    wait->node = entry->node;
+    command_buffer->state.wait_nodes = wait;
+  }
+
+  return iree_ok_status();
 }
 
 //===----------------------------------------------------------------------===//
@@ -555,8 +1008,14 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_reserve_accesses(command_buffer, 1));
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_node(
+      command_buffer, &cmd->task.header, sizeof(*cmd), &node));
+  return iree_hal_task_command_buffer_track_buffer_access(
+      command_buffer, node, target_buffer, target_offset, length,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -611,8 +1070,14 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   memcpy(cmd->source_buffer, (const uint8_t*)source_buffer + source_offset,
          cmd->length);
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_reserve_accesses(command_buffer, 1));
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_node(
+      command_buffer, &cmd->task.header, total_cmd_size, &node));
+  return iree_hal_task_command_buffer_track_buffer_access(
+      command_buffer, node, target_buffer, target_offset, length,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -695,8 +1160,17 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
   cmd->target_offset = target_offset;
   cmd->length = length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_reserve_accesses(command_buffer, 2));
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_node(
+      command_buffer, &cmd->task.header, sizeof(*cmd), &node));
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_buffer_access(
+      command_buffer, node, source_buffer, source_offset, length,
+      /*is_write=*/false));
+  return iree_hal_task_command_buffer_track_buffer_access(
+      command_buffer, node, target_buffer, target_offset, length,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -784,13 +1258,13 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
     }
     iree_host_size_t binding_ordinal = binding_base + bindings[i].binding;
 
-    // TODO(benvanik): batch insert by getting the resources in their own list.
-    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-        command_buffer->resource_set, 1, &bindings[i].buffer));
-
     // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
     iree_hal_buffer_mapping_t buffer_mapping = {{0}};
     if (bindings[i].buffer) {
+      // TODO(benvanik): batch insert by getting the resources in their own
+      // list.
+      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+          command_buffer->resource_set, 1, &bindings[i].buffer));
       IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
           bindings[i].buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
           IREE_HAL_MEMORY_ACCESS_ANY, bindings[i].offset, bindings[i].length,
@@ -799,10 +1273,28 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
           buffer_mapping.contents.data;
       command_buffer->state.binding_lengths[binding_ordinal] =
           buffer_mapping.contents.data_length;
+      command_buffer->state.binding_buffers[binding_ordinal] =
+          iree_hal_buffer_allocated_buffer(bindings[i].buffer);
+      command_buffer->state.binding_offsets[binding_ordinal] =
+          iree_hal_buffer_byte_offset(bindings[i].buffer) + bindings[i].offset;
+      command_buffer->state.binding_slots[binding_ordinal] = 0;
     } else {
-      // TODO(#10144): stash indirect binding reference in the state table.
-      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                              "binding table lookup not yet supported");
+      // Indirect binding resolved from the binding table each time the
+      // command buffer is executed.
+      if (IREE_UNLIKELY(bindings[i].buffer_slot >=
+                        command_buffer->base.binding_capacity)) {
+        return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                "binding table slot %u out of range",
+                                (uint32_t)bindings[i].buffer_slot);
+      }
+      command_buffer->state.bindings[binding_ordinal] = NULL;
+      command_buffer->state.binding_lengths[binding_ordinal] =
+          bindings[i].length;
+      command_buffer->state.binding_buffers[binding_ordinal] = NULL;
+      command_buffer->state.binding_offsets[binding_ordinal] =
+          bindings[i].offset;
+      command_buffer->state.binding_slots[binding_ordinal] =
+          bindings[i].buffer_slot + 1;
     }
   }
 
@@ -882,10 +1374,50 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
   return status;
 }
 
+// Resolves the indirect bindings of the dispatch |task| from |binding_table|.
+static iree_status_t iree_hal_cmd_dispatch_resolve_bindings(
+    iree_task_t* task, iree_host_size_t binding_ref_count,
+    const iree_hal_task_cmd_binding_ref_t* binding_refs,
+    iree_hal_buffer_binding_table_t binding_table) {
+  iree_hal_cmd_dispatch_t* cmd = (iree_hal_cmd_dispatch_t*)task;
+  uint8_t* cmd_ptr = (uint8_t*)cmd + sizeof(*cmd);
+  cmd_ptr += cmd->push_constant_count * sizeof(uint32_t);
+  void** binding_ptrs = (void**)cmd_ptr;
+  cmd_ptr += cmd->binding_count * sizeof(*binding_ptrs);
+  size_t* binding_lengths = (size_t*)cmd_ptr;
+  for (iree_host_size_t i = 0; i < binding_ref_count; ++i) {
+    const iree_hal_task_cmd_binding_ref_t* binding_ref = &binding_refs[i];
+    if (IREE_UNLIKELY(binding_ref->slot >= binding_table.count)) {
+      return iree_make_status(
+          IREE_STATUS_OUT_OF_RANGE,
+          "binding table slot %u out of range (count=%" PRIhsz ")",
+          binding_ref->slot, binding_table.count);
+    }
+    const iree_hal_buffer_binding_t* binding =
+        &binding_table.bindings[binding_ref->slot];
+    if (IREE_UNLIKELY(!binding->buffer)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding table slot %u has no buffer",
+                              binding_ref->slot);
+    }
+    // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
+    iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+        binding->buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+        IREE_HAL_MEMORY_ACCESS_ANY, binding->offset + binding_ref->offset,
+        binding_ref->length, &buffer_mapping));
+    binding_ptrs[binding_ref->binding_index] = buffer_mapping.contents.data;
+    binding_lengths[binding_ref->binding_index] =
+        buffer_mapping.contents.data_length;
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_command_buffer_build_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
     uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z,
+    iree_hal_buffer_t* workgroups_buffer, iree_device_size_t workgroups_offset,
     iree_hal_cmd_dispatch_t** out_cmd) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
@@ -962,6 +1494,10 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   cmd_ptr += used_binding_count * sizeof(*binding_ptrs);
   size_t* binding_lengths = (size_t*)cmd_ptr;
   cmd_ptr += used_binding_count * sizeof(*binding_lengths);
+  //
+  // Indirect bindings are left NULL and patched with the binding table buffers
+  // each time the command buffer is instantiated for execution.
+  iree_host_size_t binding_ref_count = 0;
   iree_host_size_t binding_base = 0;
   for (iree_host_size_t i = 0; i < used_binding_count; ++i) {
     int mask_offset = iree_math_count_trailing_zeros_u64(used_binding_mask);
@@ -970,15 +1506,68 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
     used_binding_mask = iree_shr(used_binding_mask, mask_offset + 1);
     binding_ptrs[i] = command_buffer->state.bindings[binding_ordinal];
     binding_lengths[i] = command_buffer->state.binding_lengths[binding_ordinal];
-    if (!binding_ptrs[i]) {
+    if (command_buffer->state.binding_slots[binding_ordinal]) {
+      ++binding_ref_count;
+    } else if (!binding_ptrs[i]) {
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                               "(flat) binding %d is NULL", binding_ordinal);
     }
   }
 
+  // Track the ranges of each binding accessed by the dispatch. Bindings not
+  // declared read-only in the layout are conservatively treated as written.
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_reserve_accesses(
+      command_buffer, used_binding_count + (workgroups_buffer ? 1 : 0)));
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_node(
+      command_buffer, &cmd->task.header, total_cmd_size, &node));
+  if (binding_ref_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena, binding_ref_count * sizeof(*node->binding_refs),
+        (void**)&node->binding_refs));
+  }
+  used_binding_mask = local_layout->used_bindings;
+  binding_base = 0;
+  for (iree_host_size_t i = 0; i < used_binding_count; ++i) {
+    int mask_offset = iree_math_count_trailing_zeros_u64(used_binding_mask);
+    int binding_ordinal = binding_base + mask_offset;
+    binding_base += mask_offset + 1;
+    used_binding_mask = iree_shr(used_binding_mask, mask_offset + 1);
+    const bool is_read_only =
+        iree_all_bits_set(local_layout->read_only_bindings,
+                          1ull << binding_ordinal);
+    const uint32_t binding_slot =
+        command_buffer->state.binding_slots[binding_ordinal];
+    if (binding_slot) {
+      // The buffer is unknown until execution and may alias any other.
+      iree_hal_task_cmd_binding_ref_t* binding_ref =
+          &node->binding_refs[node->binding_ref_count++];
+      binding_ref->binding_index = (uint32_t)i;
+      binding_ref->slot = binding_slot - 1;
+      binding_ref->offset =
+          command_buffer->state.binding_offsets[binding_ordinal];
+      binding_ref->length =
+          command_buffer->state.binding_lengths[binding_ordinal];
+      IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_access(
+          command_buffer, node, /*buffer=*/NULL, 0, IREE_DEVICE_SIZE_MAX,
+          /*is_write=*/!is_read_only));
+      continue;
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_access(
+        command_buffer, node,
+        command_buffer->state.binding_buffers[binding_ordinal],
+        command_buffer->state.binding_offsets[binding_ordinal],
+        command_buffer->state.binding_lengths[binding_ordinal],
+        /*is_write=*/!is_read_only));
+  }
+  if (workgroups_buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_buffer_access(
+        command_buffer, node, workgroups_buffer, workgroups_offset,
+        3 * sizeof(uint32_t), /*is_write=*/false));
+  }
+
   *out_cmd = cmd;
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch(
@@ -992,7 +1581,7 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
   iree_hal_cmd_dispatch_t* cmd = NULL;
   return iree_hal_task_command_buffer_build_dispatch(
       base_command_buffer, executable, entry_point, workgroup_x, workgroup_y,
-      workgroup_z, &cmd);
+      workgroup_z, /*workgroups_buffer=*/NULL, /*workgroups_offset=*/0, &cmd);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
@@ -1016,7 +1605,8 @@ static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
 
   iree_hal_cmd_dispatch_t* cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_build_dispatch(
-      base_command_buffer, executable, entry_point, 0, 0, 0, &cmd));
+      base_command_buffer, executable, entry_point, 0, 0, 0, workgroups_buffer,
+      workgroups_offset, &cmd));
   cmd->task.workgroup_count.ptr = (const uint32_t*)buffer_mapping.contents.data;
   cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_INDIRECT;
   return iree_ok_status();
@@ -1030,16 +1620,63 @@ static iree_status_t iree_hal_task_command_buffer_execute_commands(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* base_commands,
     iree_hal_buffer_binding_table_t binding_table) {
-  // TODO(#10144): support indirect command buffers by using deferred command
-  // buffers or caching the task topology (probably not worth the tracking).
-  // If we could separate the topology that referenced the binding table we'd
-  // be able to reissue but not concurrently (as each task can only be in flight
-  // as a singleton) - which may be enough in many cases but adds complexity to
-  // tracking as we'd need to either enforce serialization of subsequent
-  // submissions or copy-on-write-style clone the topology for each additional
-  // concurrent submission.
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "indirect command buffers not yet implemented");
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+  if (!iree_hal_task_command_buffer_isa(base_commands)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "only task command buffers can be executed from "
+                            "task command buffers");
+  }
+  iree_hal_task_command_buffer_t* commands =
+      iree_hal_task_command_buffer_cast(base_commands);
+  if (!commands->is_recorded) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "nested command buffer has not been recorded");
+  }
+
+  // The cloned commands reference resources retained by the nested command
+  // buffer in addition to the buffers in the binding table.
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &base_commands));
+  for (iree_host_size_t i = 0; i < binding_table.count; ++i) {
+    if (!binding_table.bindings[i].buffer) continue;
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+        command_buffer->resource_set, 1, &binding_table.bindings[i].buffer));
+  }
+  if (commands->template_count == 0) return iree_ok_status();
+
+  // We don't track the accesses of the nested commands and instead order them
+  // after all prior commands and all subsequent commands after them. Within
+  // the nested commands the recorded DAG is preserved.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_emit_global_barrier(command_buffer));
+
+  // Clone the nested commands with the binding table resolved so that they
+  // become part of this command buffer as if recorded directly.
+  iree_hal_task_cmd_node_t** nodes = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, commands->template_count * sizeof(*nodes),
+      (void**)&nodes));
+  for (iree_host_size_t i = 0; i < commands->template_count; ++i) {
+    const iree_hal_task_cmd_template_t* cmd_template = &commands->templates[i];
+    void* storage = NULL;
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena, cmd_template->cmd_size, &storage));
+    iree_task_t* task = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_task_cmd_template_clone(
+        cmd_template, binding_table, storage, &task));
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_node(
+        command_buffer, task, cmd_template->cmd_size, &nodes[i]));
+  }
+  for (iree_host_size_t i = 0; i < commands->template_count; ++i) {
+    const iree_hal_task_cmd_template_t* cmd_template = &commands->templates[i];
+    for (iree_host_size_t j = 0; j < cmd_template->successor_count; ++j) {
+      IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edge(
+          command_buffer, nodes[i], nodes[cmd_template->successors[j]]));
+    }
+  }
+
+  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
 }
 
 //===----------------------------------------------------------------------===//
@@ -40,6 +40,9 @@ bool iree_hal_task_command_buffer_isa(
 //
 // Any new tasks that are allocated as part of the issue operation (such as
 // barrier tasks to handle event synchronization) will be acquired from |arena|.
+// Command buffers without IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT may be issued
+// any number of times (including concurrently) and clone their recorded
+// commands into |arena| on each issue.
 // The lifetime of |arena| must be at least that of |retire_task| ensuring that
 // all of the allocated commands issued have completed and their memory in the
 // arena can be recycled.
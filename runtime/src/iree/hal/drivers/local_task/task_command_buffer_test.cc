@@ -0,0 +1,547 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_command_buffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/loaders/static_library_loader.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Test executable
+//===----------------------------------------------------------------------===//
+
+// Maximum number of dispatches that can be recorded in a single test.
+constexpr uint32_t kMaxDispatchCount = 128;
+
+// Execution log of all test dispatches. Each dispatch records a global sequence
+// number when it starts and ends such that tests can check whether two
+// dispatches were ordered or overlapped.
+std::atomic<uint32_t> g_sequence;
+std::atomic<uint32_t> g_start_sequence[kMaxDispatchCount];
+std::atomic<uint32_t> g_end_sequence[kMaxDispatchCount];
+std::atomic<uint32_t> g_rendezvous_arrivals;
+std::atomic<uint32_t> g_rendezvous_timeouts;
+
+void ResetDispatchLog() {
+  g_sequence = 0;
+  for (uint32_t i = 0; i < kMaxDispatchCount; ++i) {
+    g_start_sequence[i] = 0;
+    g_end_sequence[i] = 0;
+  }
+  g_rendezvous_arrivals = 0;
+  g_rendezvous_timeouts = 0;
+}
+
+// binding[1][0] = binding[0][0] + 1
+//
+// Push constants:
+//   [0]: dispatch ID used to index the execution log.
+//   [1]: microseconds to sleep before producing the result.
+//   [2]: number of dispatches that must arrive at the rendezvous before any of
+//        them may proceed (0 to skip). Only succeeds if they run concurrently.
+int TestDispatch(const iree_hal_executable_environment_v0_t* environment,
+                 const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+                 const iree_hal_executable_workgroup_state_v0_t* workgroup) {
+  const uint32_t id = dispatch_state->push_constants[0];
+  const uint32_t delay_us = dispatch_state->push_constants[1];
+  const uint32_t rendezvous_count = dispatch_state->push_constants[2];
+  g_start_sequence[id] = ++g_sequence;
+  if (rendezvous_count) {
+    ++g_rendezvous_arrivals;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (g_rendezvous_arrivals.load() < rendezvous_count) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        ++g_rendezvous_timeouts;
+        break;
+      }
+      std::this_thread::yield();
+    }
+  }
+  if (delay_us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+  }
+  const uint32_t* src = (const uint32_t*)dispatch_state->binding_ptrs[0];
+  uint32_t* dst = (uint32_t*)dispatch_state->binding_ptrs[1];
+  dst[0] = src[0] + 1;
+  g_end_sequence[id] = ++g_sequence;
+  return 0;
+}
+
+const iree_hal_executable_library_header_t kTestLibraryHeader = {
+    /*version=*/IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
+    /*name=*/"task_command_buffer_test",
+    /*features=*/IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE,
+    /*sanitizer=*/IREE_HAL_EXECUTABLE_LIBRARY_SANITIZER_NONE,
+};
+const iree_hal_executable_dispatch_v0_t kTestLibraryEntryPoints[1] = {
+    TestDispatch,
+};
+const iree_hal_executable_library_v0_t kTestLibrary = {
+    /*header=*/&kTestLibraryHeader,
+    /*imports=*/{0, NULL},
+    /*exports=*/{1, kTestLibraryEntryPoints},
+};
+
+const iree_hal_executable_library_header_t** TestLibraryQuery(
+    iree_hal_executable_library_version_t max_version,
+    const iree_hal_executable_environment_v0_t* environment) {
+  if (max_version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) return NULL;
+  return (const iree_hal_executable_library_header_t**)&kTestLibrary;
+}
+
+//===----------------------------------------------------------------------===//
+// Test fixture
+//===----------------------------------------------------------------------===//
+
+// A range of a buffer bound to a dispatch. If |buffer| is NULL the range is
+// relative to the binding table entry in |slot|.
+struct BufferRange {
+  iree_hal_buffer_t* buffer;
+  iree_device_size_t offset;
+  iree_device_size_t length;
+  uint32_t slot = 0;
+};
+
+class TaskCommandBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ResetDispatchLog();
+    iree_allocator_t host_allocator = iree_allocator_system();
+
+    const iree_hal_executable_library_query_fn_t libraries[] = {
+        TestLibraryQuery,
+    };
+    iree_hal_executable_loader_t* loader = NULL;
+    IREE_ASSERT_OK(iree_hal_static_library_loader_create(
+        IREE_ARRAYSIZE(libraries), libraries,
+        iree_hal_executable_import_provider_null(), host_allocator, &loader));
+
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("local-task"), host_allocator, host_allocator,
+        &device_allocator));
+
+    // Multiple workers are required for independent dispatches to overlap.
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(4, &topology);
+    iree_task_executor_t* executor = NULL;
+    IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                             host_allocator, &executor));
+    iree_task_topology_deinitialize(&topology);
+
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_task_device_create(
+        IREE_SV("local-task"), &params, /*queue_count=*/1, &executor,
+        /*loader_count=*/1, &loader, device_allocator, host_allocator,
+        &device_));
+    iree_task_executor_release(executor);
+    iree_hal_allocator_release(device_allocator);
+    iree_hal_executable_loader_release(loader);
+
+    IREE_ASSERT_OK(iree_hal_executable_cache_create(
+        device_, iree_string_view_empty(), iree_loop_inline(&loop_status_),
+        &executable_cache_));
+
+    // Binding 0 is read-only and binding 1 is written.
+    const iree_hal_descriptor_set_layout_binding_t bindings[2] = {
+        {0, IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+         IREE_HAL_DESCRIPTOR_FLAG_READ_ONLY},
+        {1, IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+         IREE_HAL_DESCRIPTOR_FLAG_NONE},
+    };
+    IREE_ASSERT_OK(iree_hal_descriptor_set_layout_create(
+        device_, IREE_HAL_DESCRIPTOR_SET_LAYOUT_FLAG_NONE,
+        IREE_ARRAYSIZE(bindings), bindings, &set_layout_));
+    IREE_ASSERT_OK(iree_hal_pipeline_layout_create(
+        device_, /*push_constants=*/3, /*set_layout_count=*/1, &set_layout_,
+        &pipeline_layout_));
+
+    iree_hal_executable_params_t executable_params;
+    iree_hal_executable_params_initialize(&executable_params);
+    executable_params.caching_mode =
+        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+    executable_params.executable_format = IREE_SV("static");
+    executable_params.executable_data = iree_make_const_byte_span(
+        kTestLibraryHeader.name, strlen(kTestLibraryHeader.name));
+    executable_params.pipeline_layout_count = 1;
+    executable_params.pipeline_layouts = &pipeline_layout_;
+    IREE_ASSERT_OK(iree_hal_executable_cache_prepare_executable(
+        executable_cache_, &executable_params, &executable_));
+
+    IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_));
+  }
+
+  void TearDown() override {
+    for (iree_hal_buffer_t* buffer : buffers_) iree_hal_buffer_release(buffer);
+    iree_hal_semaphore_release(semaphore_);
+    iree_hal_executable_release(executable_);
+    iree_hal_pipeline_layout_release(pipeline_layout_);
+    iree_hal_descriptor_set_layout_release(set_layout_);
+    iree_hal_executable_cache_release(executable_cache_);
+    iree_hal_device_release(device_);
+    iree_status_ignore(loop_status_);
+  }
+
+  // Allocates a buffer of |length| bytes filled with |value| words that is
+  // released when the test ends.
+  iree_hal_buffer_t* AllocateBuffer(iree_device_size_t length,
+                                    uint32_t value = 0) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device_), params, length, &buffer));
+    IREE_CHECK_OK(iree_hal_buffer_map_fill(buffer, 0, IREE_WHOLE_BUFFER,
+                                           &value, sizeof(value)));
+    buffers_.push_back(buffer);
+    return buffer;
+  }
+
+  // Returns the word at |offset| in |buffer|.
+  uint32_t ReadWord(iree_hal_buffer_t* buffer, iree_device_size_t offset = 0) {
+    uint32_t value = 0;
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_read(buffer, offset, &value, sizeof(value)));
+    return value;
+  }
+
+  // Creates a command buffer and begins recording.
+  iree_hal_command_buffer_t* BeginCommandBuffer(
+      iree_hal_command_buffer_mode_t mode =
+          IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      iree_host_size_t binding_capacity = 0) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_CHECK_OK(iree_hal_command_buffer_create(
+        device_, mode, IREE_HAL_COMMAND_CATEGORY_ANY,
+        IREE_HAL_QUEUE_AFFINITY_ANY, binding_capacity, &command_buffer));
+    IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+    return command_buffer;
+  }
+
+  // Records a dispatch with ID |id| that reads the first word of |src| and
+  // writes it incremented by one to the first word of |dst|.
+  void RecordDispatch(iree_hal_command_buffer_t* command_buffer, uint32_t id,
+                      BufferRange src, BufferRange dst, uint32_t delay_us = 0,
+                      uint32_t rendezvous_count = 0) {
+    const uint32_t push_constants[3] = {id, delay_us, rendezvous_count};
+    IREE_ASSERT_OK(iree_hal_command_buffer_push_constants(
+        command_buffer, pipeline_layout_, 0, push_constants,
+        sizeof(push_constants)));
+    const iree_hal_descriptor_set_binding_t bindings[2] = {
+        {0, src.slot, src.buffer, src.offset, src.length},
+        {1, dst.slot, dst.buffer, dst.offset, dst.length},
+    };
+    IREE_ASSERT_OK(iree_hal_command_buffer_push_descriptor_set(
+        command_buffer, pipeline_layout_, /*set=*/0, IREE_ARRAYSIZE(bindings),
+        bindings));
+    IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(
+        command_buffer, executable_, /*entry_point=*/0, 1, 1, 1));
+  }
+
+  // Records a full execution barrier.
+  void RecordBarrier(iree_hal_command_buffer_t* command_buffer) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+        command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+        IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+  }
+
+  // Records a wait on |event|.
+  void RecordWaitEvent(iree_hal_command_buffer_t* command_buffer,
+                       iree_hal_event_t* event) {
+    const iree_hal_event_t* events[1] = {event};
+    IREE_ASSERT_OK(iree_hal_command_buffer_wait_events(
+        command_buffer, IREE_ARRAYSIZE(events), events,
+        IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+        IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE, 0, NULL, 0, NULL));
+  }
+
+  // Ends recording of |command_buffer|, submits it, and waits for it to
+  // complete. The command buffer is not released.
+  iree_status_t EndAndSubmit(iree_hal_command_buffer_t* command_buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_end(command_buffer));
+    return Submit(1, &command_buffer);
+  }
+
+  // Submits the recorded |command_buffers| in a single batch and waits for
+  // them to complete.
+  iree_status_t Submit(iree_host_size_t command_buffer_count,
+                       iree_hal_command_buffer_t* const* command_buffers) {
+    uint64_t signal_value = ++semaphore_value_;
+    iree_hal_semaphore_list_t signal_semaphores = {
+        /*count=*/1,
+        /*semaphores=*/&semaphore_,
+        /*payload_values=*/&signal_value,
+    };
+    IREE_RETURN_IF_ERROR(iree_hal_device_queue_execute(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, command_buffer_count, command_buffers));
+    return iree_hal_semaphore_wait(semaphore_, signal_value,
+                                   iree_infinite_timeout());
+  }
+
+  // Returns true if dispatch |before| ended before dispatch |after| started.
+  static bool IsOrderedBefore(uint32_t before, uint32_t after) {
+    return g_end_sequence[before] != 0 && g_start_sequence[after] != 0 &&
+           g_end_sequence[before] < g_start_sequence[after];
+  }
+
+  iree_status_t loop_status_ = iree_ok_status();
+  iree_hal_device_t* device_ = NULL;
+  iree_hal_executable_cache_t* executable_cache_ = NULL;
+  iree_hal_descriptor_set_layout_t* set_layout_ = NULL;
+  iree_hal_pipeline_layout_t* pipeline_layout_ = NULL;
+  iree_hal_executable_t* executable_ = NULL;
+  iree_hal_semaphore_t* semaphore_ = NULL;
+  uint64_t semaphore_value_ = 0;
+  std::vector<iree_hal_buffer_t*> buffers_;
+};
+
+// Delay applied to the first of two dependent dispatches such that a missing
+// dependency edge reliably lets the second start before the first ends.
+constexpr uint32_t kOrderingDelayUs = 20 * 1000;
+
+// Read-after-write: a dispatch reading a range written before a barrier must
+// wait for the write.
+TEST_F(TaskCommandBufferTest, ReadAfterWrite) {
+  iree_hal_buffer_t* a = AllocateBuffer(16, 10);
+  iree_hal_buffer_t* b = AllocateBuffer(16);
+  iree_hal_buffer_t* c = AllocateBuffer(16);
+  iree_hal_command_buffer_t* command_buffer = BeginCommandBuffer();
+  RecordDispatch(command_buffer, 0, {a, 0, 16}, {b, 0, 16}, kOrderingDelayUs);
+  RecordBarrier(command_buffer);
+  RecordDispatch(command_buffer, 1, {b, 0, 16}, {c, 0, 16});
+  IREE_ASSERT_OK(EndAndSubmit(command_buffer));
+  iree_hal_command_buffer_release(command_buffer);
+  EXPECT_TRUE(IsOrderedBefore(0, 1));
+  EXPECT_EQ(12u, ReadWord(c));
+}
+
+// Write-after-read: a dispatch writing a range read before a barrier must wait
+// for the read.
+TEST_F(TaskCommandBufferTest, WriteAfterRead) {
+  iree_hal_buffer_t* a = AllocateBuffer(16, 10);
+  iree_hal_buffer_t* b = AllocateBuffer(16);
+  iree_hal_buffer_t* c = AllocateBuffer(16, 20);
+  iree_hal_command_buffer_t* command_buffer = BeginCommandBuffer();
+  RecordDispatch(command_buffer, 0, {a, 0, 16}, {b, 0, 16}, kOrderingDelayUs);
+  RecordBarrier(command_buffer);
+  RecordDispatch(command_buffer, 1, {c, 0, 16}, {a, 0, 16});
+  IREE_ASSERT_OK(EndAndSubmit(command_buffer));
+  iree_hal_command_buffer_release(command_buffer);
+  EXPECT_TRUE(IsOrderedBefore(0, 1));
+  EXPECT_EQ(11u, ReadWord(b));
+  EXPECT_EQ(21u, ReadWord(a));
+}
+
+// Write-after-write: a dispatch writing a range written before a barrier must
+// wait for the first write such that the last write wins.
+TEST_F(TaskCommandBufferTest, WriteAfterWrite) {
+  iree_hal_buffer_t* a = AllocateBuffer(16, 10);
+  iree_hal_buffer_t* b = AllocateBuffer(16);
+  iree_hal_buffer_t* c = AllocateBuffer(16, 20);
+  iree_hal_command_buffer_t* command_buffer = BeginCommandBuffer();
+  RecordDispatch(command_buffer, 0, {a, 0, 16}, {b, 0, 16}, kOrderingDelayUs);
+  RecordBarrier(command_buffer);
+  RecordDispatch(command_buffer, 1, {c, 0, 16}, {b, 0, 16});
+  IREE_ASSERT_OK(EndAndSubmit(command_buffer));
+  iree_hal_command_buffer_release(command_buffer);
+  EXPECT_TRUE(IsOrderedBefore(0, 1));
+  EXPECT_EQ(21u, ReadWord(b));
+}
+
+// Dispatches separated by a barrier that access disjoint ranges (including
+// disjoint ranges of the same buffer) are not ordered and run concurrently.
+TEST_F(TaskCommandBufferTest, IndependentBranchesRunConcurrently) {
+  iree_hal_buffer_t* a = AllocateBuffer(16, 10);
+  iree_hal_buffer_t* b = AllocateBuffer(32);
+  iree_hal_command_buffer_t* command_buffer = BeginCommandBuffer();
+  RecordDispatch(command_buffer, 0, {a, 0, 16}, {b, 0, 16},
+                 /*delay_us=*/0, /*rendezvous_count=*/2);
+  RecordBarrier(command_buffer);
+  RecordDispatch(command_buffer, 1, {a, 0, 16}, {b, 16, 16},
+                 /*delay_us=*/0, /*rendezvous_count=*/2);
+  IREE_ASSERT_OK(EndAndSubmit(command_buffer));
+  iree_hal_command_buffer_release(command_buffer);
+  EXPECT_EQ(0u, g_rendezvous_timeouts.load());
+  EXPECT_EQ(11u, ReadWord(b, 0));
+  EXPECT_EQ(11u, ReadWord(b, 16));
+}
+
+// Commands recorded after a wait on an event signaled within the command buffer
+// execute after all commands recorded before the signal but not those recorded
+// between the signal and the wait.
+TEST_F(TaskCommandBufferTest, EventJoin) {
+  iree_hal_buffer_t* a = AllocateBuffer(16, 10);
+  iree_hal_buffer_t* b = AllocateBuffer(16);
+  iree_hal_buffer_t* c = AllocateBuffer(16);
+  iree_hal_buffer_t* d = AllocateBuffer(16);
+  iree_hal_event_t* event = NULL;
+  IREE_ASSERT_OK(iree_hal_event_create(device_, &event));
+  iree_hal_command_buffer_t* command_buffer = BeginCommandBuffer();
+  RecordDispatch(command_buffer, 0, {a, 0, 16}, {b, 0, 16}, kOrderingDelayUs,
+                 /*rendezvous_count=*/2);
+  IREE_ASSERT_OK(iree_hal_command_buffer_signal_event(
+      command_buffer, event, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE));
+  RecordDispatch(command_buffer, 1, {a, 0, 16}, {c, 0, 16}, /*delay_us=*/0,
+                 /*rendezvous_count=*/2);
+  RecordWaitEvent(command_buffer, event);
+  RecordDispatch(command_buffer, 2, {a, 0, 16}, {d, 0, 16});
+  IREE_ASSERT_OK(EndAndSubmit(command_buffer));
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_event_release(event);
+  EXPECT_EQ(0u, g_rendezvous_timeouts.load());
+  EXPECT_TRUE(IsOrderedBefore(0, 2));
+  EXPECT_EQ(11u, ReadWord(d));
+}
+
+// Waits on events that were reset (or never signaled) within the command
+// buffer have no join to depend on and fall back to a full barrier.
+TEST_F(TaskCommandBufferTest, ResetEventFallsBackToFullBarrier) {
+  iree_hal_buffer_t* a = AllocateBuffer(16, 10);
+  iree_hal_buffer_t* b = AllocateBuffer(16);
+  iree_hal_buffer_t* c = AllocateBuffer(16);
+  iree_hal_buffer_t* d = AllocateBuffer(16);
+  iree_hal_event_t* event = NULL;
+  IREE_ASSERT_OK(iree_hal_event_create(device_, &event));
+  iree_hal_event_t* external_event = NULL;
+  IREE_ASSERT_OK(iree_hal_event_create(device_, &external_event));
+  iree_hal_command_buffer_t* command_buffer = BeginCommandBuffer();
+  RecordDispatch(command_buffer, 0, {a, 0, 16}, {b, 0, 16}, kOrderingDelayUs);
+  IREE_ASSERT_OK(iree_hal_command_buffer_signal_event(
+      command_buffer, event, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE));
+  IREE_ASSERT_OK(iree_hal_command_buffer_reset_event(
+      command_buffer, event, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE));
+  RecordWaitEvent(command_buffer, event);
+  RecordDispatch(command_buffer, 1, {a, 0, 16}, {c, 0, 16}, kOrderingDelayUs);
+  RecordWaitEvent(command_buffer, external_event);
+  RecordDispatch(command_buffer, 2, {a, 0, 16}, {d, 0, 16});
+  IREE_ASSERT_OK(EndAndSubmit(command_buffer));
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_event_release(external_event);
+  iree_hal_event_release(event);
+  EXPECT_TRUE(IsOrderedBefore(0, 1));
+  EXPECT_TRUE(IsOrderedBefore(1, 2));
+}
+
+// When more distinct ranges are accessed than can be tracked the command buffer
+// emits a full barrier: commands recorded before it may still run concurrently
+// but the command overflowing the table runs after all of them.
+TEST_F(TaskCommandBufferTest, AccessOverflowDegradesToFullBarrier) {
+  // Each dispatch tracks two accesses (one read and one write) of distinct
+  // ranges and the table holds 128 accesses: the 65th dispatch overflows.
+  constexpr uint32_t kTrackedDispatchCount = 64;
+  constexpr iree_device_size_t kStride = 16;
+  iree_hal_buffer_t* src =
+      AllocateBuffer((kTrackedDispatchCount + 1) * kStride, 10);
+  iree_hal_buffer_t* dst = AllocateBuffer((kTrackedDispatchCount + 1) * kStride);
+  iree_hal_command_buffer_t* command_buffer = BeginCommandBuffer();
+  for (uint32_t i = 0; i <= kTrackedDispatchCount; ++i) {
+    const iree_device_size_t offset = i * kStride;
+    RecordDispatch(command_buffer, i, {src, offset, kStride},
+                   {dst, offset, kStride},
+                   /*delay_us=*/i == 0 ? kOrderingDelayUs : 0,
+                   /*rendezvous_count=*/i < 2 ? 2 : 0);
+  }
+  IREE_ASSERT_OK(EndAndSubmit(command_buffer));
+  iree_hal_command_buffer_release(command_buffer);
+  EXPECT_EQ(0u, g_rendezvous_timeouts.load());
+  for (uint32_t i = 0; i < kTrackedDispatchCount; ++i) {
+    EXPECT_TRUE(IsOrderedBefore(i, kTrackedDispatchCount)) << "dispatch " << i;
+  }
+  for (uint32_t i = 0; i <= kTrackedDispatchCount; ++i) {
+    EXPECT_EQ(11u, ReadWord(dst, i * kStride));
+  }
+}
+
+// A reusable command buffer with bindings sourced from a binding table can be
+// executed multiple times with different tables, including while another
+// execution of it is in flight.
+TEST_F(TaskCommandBufferTest, ReusableWithBindingTable) {
+  iree_hal_command_buffer_t* nested_command_buffer = BeginCommandBuffer(
+      IREE_HAL_COMMAND_BUFFER_MODE_NESTED, /*binding_capacity=*/3);
+  RecordDispatch(nested_command_buffer, 0, {NULL, 0, 16, /*slot=*/0},
+                 {NULL, 0, 16, /*slot=*/1});
+  RecordBarrier(nested_command_buffer);
+  RecordDispatch(nested_command_buffer, 1, {NULL, 0, 16, /*slot=*/1},
+                 {NULL, 0, 16, /*slot=*/2});
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(nested_command_buffer));
+
+  // Each table uses distinct buffers; the second binds subranges to check that
+  // the table offsets are applied.
+  iree_hal_buffer_t* a = AllocateBuffer(16, 10);
+  iree_hal_buffer_t* b = AllocateBuffer(16);
+  iree_hal_buffer_t* c = AllocateBuffer(16);
+  iree_hal_buffer_t* d = AllocateBuffer(64, 20);
+  const iree_hal_buffer_binding_t bindings[2][3] = {
+      {{a, 0, 16}, {b, 0, 16}, {c, 0, 16}},
+      {{d, 0, 16}, {d, 16, 16}, {d, 32, 16}},
+  };
+  auto execute_with_table = [&](int table_index) {
+    iree_hal_command_buffer_t* command_buffer = BeginCommandBuffer();
+    iree_hal_buffer_binding_table_t binding_table = {
+        IREE_ARRAYSIZE(bindings[table_index]), bindings[table_index]};
+    IREE_CHECK_OK(iree_hal_command_buffer_execute_commands(
+        command_buffer, nested_command_buffer, binding_table));
+    IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer));
+    return command_buffer;
+  };
+
+  // Execute with each table in turn.
+  for (int i = 0; i < 2; ++i) {
+    iree_hal_command_buffer_t* command_buffer = execute_with_table(i);
+    IREE_ASSERT_OK(Submit(1, &command_buffer));
+    iree_hal_command_buffer_release(command_buffer);
+  }
+  EXPECT_EQ(11u, ReadWord(b));
+  EXPECT_EQ(12u, ReadWord(c));
+  EXPECT_EQ(21u, ReadWord(d, 16));
+  EXPECT_EQ(22u, ReadWord(d, 32));
+
+  // Execute with both tables in the same submission.
+  IREE_ASSERT_OK(iree_hal_buffer_map_zero(b, 0, IREE_WHOLE_BUFFER));
+  IREE_ASSERT_OK(iree_hal_buffer_map_zero(c, 0, IREE_WHOLE_BUFFER));
+  IREE_ASSERT_OK(iree_hal_buffer_map_zero(d, 16, 32));
+  iree_hal_command_buffer_t* command_buffers[2] = {
+      execute_with_table(0),
+      execute_with_table(1),
+  };
+  IREE_ASSERT_OK(Submit(IREE_ARRAYSIZE(command_buffers), command_buffers));
+  iree_hal_command_buffer_release(command_buffers[0]);
+  iree_hal_command_buffer_release(command_buffers[1]);
+  EXPECT_EQ(12u, ReadWord(c));
+  EXPECT_EQ(22u, ReadWord(d, 32));
+
+  iree_hal_command_buffer_release(nested_command_buffer);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -12,15 +12,17 @@
 
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/cpu.h"
+#include "iree/hal/drivers/local_task/task_allocator.h"
 #include "iree/hal/drivers/local_task/task_command_buffer.h"
 #include "iree/hal/drivers/local_task/task_event.h"
+#include "iree/hal/drivers/local_task/task_pool.h"
 #include "iree/hal/drivers/local_task/task_queue.h"
 #include "iree/hal/drivers/local_task/task_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
-#include "iree/hal/utils/memory_file.h"
 
 typedef struct iree_hal_task_device_t {
   iree_hal_resource_t resource;
@@ -42,6 +44,10 @@ typedef struct iree_hal_task_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Pools used for queue-ordered allocations with one per queue or NULL if
+  // queue-ordered allocations are disabled.
+  iree_hal_task_pool_t** queue_pools;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -58,6 +64,9 @@ void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
   out_params->queue_scope_flags = IREE_TASK_SCOPE_FLAG_NONE;
+  out_params->memory_placement = IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_DEFAULT;
+  out_params->queue_ordered_allocations = true;
+  out_params->queue_pool_release_threshold = 256 * 1024 * 1024;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -73,12 +82,42 @@ static iree_status_t iree_hal_task_device_check_params(
   return iree_ok_status();
 }
 
-// Returns an event pool used for device-wide system event handles.
-// Each queue executor will have its own (potentially shared) pool and prefer
-// that but generic resource requests (creating semaphores, etc) will use this.
-iree_event_pool_t* iree_hal_task_device_shared_event_pool(
+// Returns the executor used for device-wide resources and host waits.
+// Each queue executor will have its own (potentially shared) event pool and
+// prefer that but generic resource requests (creating semaphores, etc) will use
+// this. Threads blocking on the device are donated to it such that threadless
+// executors make progress.
+static iree_task_executor_t* iree_hal_task_device_shared_executor(
     iree_hal_task_device_t* device) {
-  return iree_task_executor_event_pool(device->queues[0].executor);
+  return device->queues[0].executor;
+}
+
+// Wraps |device_allocator| with one that places memory on the NUMA node of
+// each queue's executor. If no queue has a known node then |device_allocator|
+// is returned as-is as there's nothing to place.
+static iree_status_t iree_hal_task_device_create_placement_allocator(
+    iree_hal_task_allocator_flags_t flags, iree_host_size_t queue_count,
+    iree_task_executor_t* const* queue_executors,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator) {
+  iree_task_topology_node_id_t* queue_node_ids =
+      (iree_task_topology_node_id_t*)iree_alloca(queue_count *
+                                                 sizeof(queue_node_ids[0]));
+  bool any_node_known = false;
+  for (iree_host_size_t i = 0; i < queue_count; ++i) {
+    queue_node_ids[i] = iree_task_executor_memory_node(queue_executors[i]);
+    if (queue_node_ids[i] != IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      any_node_known = true;
+    }
+  }
+  if (!any_node_known) {
+    iree_hal_allocator_retain(device_allocator);
+    *out_allocator = device_allocator;
+    return iree_ok_status();
+  }
+  return iree_hal_task_allocator_create(flags, device_allocator, queue_count,
+                                        queue_node_ids, host_allocator,
+                                        out_allocator);
 }
 
 iree_status_t iree_hal_task_device_create(
@@ -98,10 +137,29 @@ iree_status_t iree_hal_task_device_create(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_task_device_check_params(params, queue_count));
 
+  // Optionally wrap the allocator so that memory is placed near the workers.
+  if (params->memory_placement ==
+          IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_QUEUE_NODE ||
+      params->memory_placement ==
+          IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_QUEUE_NODE_AND_IMPORTS) {
+    const iree_hal_task_allocator_flags_t allocator_flags =
+        params->memory_placement ==
+                IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_QUEUE_NODE_AND_IMPORTS
+            ? IREE_HAL_TASK_ALLOCATOR_FLAG_MIGRATE_IMPORTS
+            : IREE_HAL_TASK_ALLOCATOR_FLAG_NONE;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_task_device_create_placement_allocator(
+                allocator_flags, queue_count, queue_executors,
+                device_allocator, host_allocator, &device_allocator));
+  } else {
+    iree_hal_allocator_retain(device_allocator);
+  }
+
   iree_hal_task_device_t* device = NULL;
   iree_host_size_t struct_size = sizeof(*device) +
                                  queue_count * sizeof(*device->queues) +
-                                 loader_count * sizeof(*device->loaders);
+                                 loader_count * sizeof(*device->loaders) +
+                                 queue_count * sizeof(*device->queue_pools);
   iree_host_size_t total_size = struct_size + identifier.size;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, total_size, (void**)&device);
@@ -113,7 +171,6 @@ iree_status_t iree_hal_task_device_create(
                                       (char*)device + struct_size);
     device->host_allocator = host_allocator;
     device->device_allocator = device_allocator;
-    iree_hal_allocator_retain(device_allocator);
 
     iree_arena_block_pool_initialize(4096, host_allocator,
                                      &device->small_block_pool);
@@ -138,10 +195,24 @@ iree_status_t iree_hal_task_device_create(
     }
   }
 
+  if (iree_status_is_ok(status) && params->queue_ordered_allocations) {
+    device->queue_pools =
+        (iree_hal_task_pool_t**)((uint8_t*)device->loaders +
+                                 loader_count * sizeof(*device->loaders));
+    for (iree_host_size_t i = 0; i < queue_count; ++i) {
+      status = iree_hal_task_pool_create(params->queue_pool_release_threshold,
+                                         host_allocator,
+                                         &device->queue_pools[i]);
+      if (!iree_status_is_ok(status)) break;
+    }
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
-  } else {
+  } else if (device) {
     iree_hal_device_release((iree_hal_device_t*)device);
+  } else {
+    iree_hal_allocator_release(device_allocator);
   }
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -156,6 +227,13 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
 
+  // Pools may outlive the device if any buffers allocated from them are live.
+  if (device->queue_pools) {
+    for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+      iree_hal_task_pool_release(device->queue_pools[i]);
+    }
+  }
+
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -212,6 +290,7 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
   // on to blocks.
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_trim(&device->queues[i]);
+    if (device->queue_pools) iree_hal_task_pool_trim(device->queue_pools[i]);
   }
   IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->device_allocator));
 
@@ -339,14 +418,8 @@ static iree_status_t iree_hal_task_device_import_file(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
     iree_hal_external_file_flags_t flags, iree_hal_file_t** out_file) {
-  if (iree_io_file_handle_type(handle) !=
-      IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    return iree_make_status(
-        IREE_STATUS_UNAVAILABLE,
-        "implementation does not support the external file type");
-  }
-  return iree_hal_memory_file_wrap(
-      queue_affinity, access, handle, iree_hal_device_allocator(base_device),
+  return iree_hal_file_from_handle(
+      iree_hal_device_allocator(base_device), queue_affinity, access, handle,
       iree_hal_device_host_allocator(base_device), out_file);
 }
 
@@ -365,7 +438,7 @@ static iree_status_t iree_hal_task_device_create_semaphore(
     iree_hal_semaphore_t** out_semaphore) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   return iree_hal_task_semaphore_create(
-      iree_hal_task_device_shared_event_pool(device), initial_value,
+      iree_hal_task_device_shared_executor(device), initial_value,
       device->host_allocator, out_semaphore);
 }
 
@@ -391,14 +464,34 @@ static iree_status_t iree_hal_task_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(
-      iree_hal_allocator_allocate_buffer(iree_hal_device_allocator(base_device),
-                                         params, allocation_size, out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (!device->queue_pools) {
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
+                                                      iree_infinite_timeout()));
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        device->device_allocator, params, allocation_size, out_buffer));
+    return iree_hal_semaphore_list_signal(signal_semaphore_list);
+  }
+
+  // The memory is reserved immediately from the queue pool such that commands
+  // can be recorded against it and only the availability of the buffer is
+  // ordered on the queue. The pool ensures that memory reused from a prior
+  // deallocation on the queue is only handed out if the allocation is ordered
+  // after it.
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_pool_allocate(
+      device->queue_pools[queue_index], device->device_allocator,
+      wait_semaphore_list, params, allocation_size, &buffer));
+  iree_status_t status = iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_task_device_queue_dealloca(
@@ -406,9 +499,13 @@ static iree_status_t iree_hal_task_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
   IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
+
+  // The memory of pooled buffers returns to the pool once all references to
+  // the buffer have been released and is only reused by allocations ordered
+  // after the signal. Buffers not from a pool are owned by the caller.
+  iree_hal_task_pool_deallocate(buffer, signal_semaphore_list);
   return iree_ok_status();
 }
 
@@ -485,8 +582,7 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   return iree_hal_task_semaphore_multi_wait(
       wait_mode, semaphore_list, timeout,
-      iree_hal_task_device_shared_event_pool(device),
-      &device->large_block_pool);
+      iree_hal_task_device_shared_executor(device), &device->large_block_pool);
 }
 
 static iree_status_t iree_hal_task_device_profiling_begin(
@@ -16,6 +16,21 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Controls where device memory is placed on systems with multiple NUMA nodes.
+typedef enum iree_hal_task_device_memory_placement_e {
+  // Memory is placed by the system default policy (usually on the node of the
+  // thread that first touches each page).
+  IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_DEFAULT = 0,
+  // Memory allocated with a queue affinity is placed on the NUMA node of the
+  // executor servicing the selected queue. Queues whose executors span
+  // multiple nodes and imported memory use the default placement.
+  IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_QUEUE_NODE,
+  // As with IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_QUEUE_NODE but imported host
+  // allocations are also bound to the node and their resident pages migrated.
+  // Only use when imported memory is not shared with other nodes.
+  IREE_HAL_TASK_DEVICE_MEMORY_PLACEMENT_QUEUE_NODE_AND_IMPORTS,
+} iree_hal_task_device_memory_placement_t;
+
 // Parameters configuring an iree_hal_task_device_t.
 // Must be initialized with iree_hal_task_device_params_initialize prior to use.
 typedef struct iree_hal_task_device_params_t {
@@ -25,6 +40,16 @@ typedef struct iree_hal_task_device_params_t {
   iree_host_size_t arena_block_size;
   // Default flags for the iree_task_scope_t used for each queue.
   iree_task_scope_flags_t queue_scope_flags;
+  // Controls where buffers allocated or imported by the device allocator are
+  // placed. Only applies to the allocator provided on creation.
+  iree_hal_task_device_memory_placement_t memory_placement;
+  // Whether queue_alloca/queue_dealloca are serviced by per-queue pools that
+  // recycle memory in queue order. When disabled allocations block the caller
+  // until their waits are satisfied and are serviced by the device allocator.
+  bool queue_ordered_allocations;
+  // Soft maximum number of bytes of unused memory retained by each queue pool.
+  // Memory released beyond this is returned to the device allocator.
+  iree_device_size_t queue_pool_release_threshold;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
@@ -0,0 +1,451 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_pool.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+
+// Minimum granularity of block sizes. Matches IREE_HAL_HEAP_BUFFER_ALIGNMENT
+// so that blocks can be wrapped as heap buffers.
+#define IREE_HAL_TASK_POOL_MIN_GRANULARITY 64
+
+typedef struct iree_hal_task_pool_block_t {
+  // Next block in the free list. Unused while live.
+  struct iree_hal_task_pool_block_t* next;
+  // Pool the block belongs to. Retained while the block is live.
+  iree_hal_task_pool_t* pool;
+
+  // Buffer allocated from the device allocator providing the block memory.
+  iree_hal_buffer_t* backing_buffer;
+  // Persistent mapping of |backing_buffer|.
+  iree_hal_buffer_mapping_t mapping;
+  // Parameters of the buffers the block may be used for.
+  iree_hal_memory_type_t memory_type;
+  iree_hal_memory_access_t allowed_access;
+  iree_hal_buffer_usage_t allowed_usage;
+  iree_device_size_t block_size;
+
+  // Timepoint at which the deallocation of the block completes, if any.
+  iree_hal_semaphore_t* release_semaphore;
+  uint64_t release_value;
+} iree_hal_task_pool_block_t;
+
+// Buffer wrapping a live block. The block is reachable from the buffer such
+// that deallocations find it without searching the pool.
+typedef struct iree_hal_task_pool_buffer_t {
+  iree_hal_buffer_t base;
+  iree_hal_task_pool_block_t* block;
+} iree_hal_task_pool_buffer_t;
+
+static const iree_hal_buffer_vtable_t iree_hal_task_pool_buffer_vtable;
+
+struct iree_hal_task_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_device_size_t release_threshold;
+
+  iree_slim_mutex_t mutex;
+  // Unused blocks in most-recently-released order.
+  iree_hal_task_pool_block_t* free_head IREE_GUARDED_BY(mutex);
+  // Total size of all blocks in the free list.
+  iree_device_size_t free_size IREE_GUARDED_BY(mutex);
+};
+
+// Returns the size of the block used to service an allocation of |size|.
+// Sizes are quantized to four classes per power of two such that padding is
+// bounded to 25% while similarly sized allocations share blocks.
+static iree_device_size_t iree_hal_task_pool_block_size(
+    iree_device_size_t size) {
+  if (size <= IREE_HAL_TASK_POOL_MIN_GRANULARITY) {
+    return IREE_HAL_TASK_POOL_MIN_GRANULARITY;
+  }
+  const iree_device_size_t granularity =
+      iree_max(IREE_HAL_TASK_POOL_MIN_GRANULARITY,
+               iree_math_round_up_to_pow2_u64(size) / 8);
+  return iree_device_align(size, granularity);
+}
+
+static void iree_hal_task_pool_block_free(iree_hal_task_pool_block_t* block,
+                                          iree_allocator_t host_allocator) {
+  iree_hal_semaphore_release(block->release_semaphore);
+  iree_status_ignore(iree_hal_buffer_unmap_range(&block->mapping));
+  iree_hal_buffer_release(block->backing_buffer);
+  iree_allocator_free(host_allocator, block);
+}
+
+// Returns true if an allocation waiting on |wait_semaphore_list| is ordered
+// after the deallocation of |block| completes.
+static bool iree_hal_task_pool_block_is_ordered_before(
+    const iree_hal_task_pool_block_t* block,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  if (!block->release_semaphore) return true;
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    if (wait_semaphore_list.semaphores[i] == block->release_semaphore &&
+        wait_semaphore_list.payload_values[i] >= block->release_value) {
+      return true;
+    }
+  }
+  return false;
+}
+
+iree_status_t iree_hal_task_pool_create(iree_device_size_t release_threshold,
+                                        iree_allocator_t host_allocator,
+                                        iree_hal_task_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_task_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  memset(pool, 0, sizeof(*pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->release_threshold = release_threshold;
+  iree_slim_mutex_initialize(&pool->mutex);
+
+  *out_pool = pool;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_task_pool_destroy(iree_hal_task_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_task_pool_trim(pool);
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  iree_allocator_free(pool->host_allocator, pool);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_hal_task_pool_retain(iree_hal_task_pool_t* pool) {
+  iree_atomic_ref_count_inc(&pool->ref_count);
+}
+
+void iree_hal_task_pool_release(iree_hal_task_pool_t* pool) {
+  if (pool && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_task_pool_destroy(pool);
+  }
+}
+
+void iree_hal_task_pool_trim(iree_hal_task_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_task_pool_block_t* free_head = pool->free_head;
+  pool->free_head = NULL;
+  pool->free_size = 0;
+  iree_slim_mutex_unlock(&pool->mutex);
+  while (free_head) {
+    iree_hal_task_pool_block_t* next = free_head->next;
+    iree_hal_task_pool_block_free(free_head, pool->host_allocator);
+    free_head = next;
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Returns |block| to the pool when the buffer wrapping it is destroyed.
+// All uses of the buffer are complete but the block may still be tagged with a
+// pending deallocation timepoint that allocations must be ordered after.
+static void iree_hal_task_pool_block_release(
+    iree_hal_task_pool_block_t* block) {
+  iree_hal_task_pool_t* pool = block->pool;
+  block->pool = NULL;
+
+  iree_slim_mutex_lock(&pool->mutex);
+  const bool is_retained =
+      pool->free_size + block->block_size <= pool->release_threshold;
+  if (is_retained) {
+    block->next = pool->free_head;
+    pool->free_head = block;
+    pool->free_size += block->block_size;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  if (!is_retained) {
+    iree_hal_task_pool_block_free(block, pool->host_allocator);
+  }
+  iree_hal_task_pool_release(pool);
+}
+
+// Removes and returns the first unused block in the pool compatible with
+// |params| and |block_size|. |out_is_ordered| indicates whether the
+// deallocation of the block is known to be ordered before an allocation
+// waiting on |wait_semaphore_list|. Blocks that are known to be ordered are
+// preferred.
+static iree_hal_task_pool_block_t* iree_hal_task_pool_take_block(
+    iree_hal_task_pool_t* pool, const iree_hal_buffer_params_t* params,
+    iree_device_size_t block_size,
+    const iree_hal_semaphore_list_t wait_semaphore_list, bool* out_is_ordered) {
+  *out_is_ordered = false;
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_task_pool_block_t** pending_link = NULL;
+  iree_hal_task_pool_block_t** link = &pool->free_head;
+  for (; *link != NULL; link = &(*link)->next) {
+    iree_hal_task_pool_block_t* block = *link;
+    if (block->block_size != block_size ||
+        block->memory_type != params->type ||
+        block->allowed_access != params->access ||
+        block->allowed_usage != params->usage) {
+      continue;
+    }
+    if (iree_hal_task_pool_block_is_ordered_before(block,
+                                                   wait_semaphore_list)) {
+      *out_is_ordered = true;
+      break;
+    } else if (!pending_link) {
+      pending_link = link;
+    }
+  }
+  if (!*out_is_ordered) link = pending_link;
+  iree_hal_task_pool_block_t* block = NULL;
+  if (link) {
+    block = *link;
+    *link = block->next;
+    block->next = NULL;
+    pool->free_size -= block->block_size;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  return block;
+}
+
+// Returns |block| to the free list without changing its state.
+static void iree_hal_task_pool_put_block(iree_hal_task_pool_t* pool,
+                                         iree_hal_task_pool_block_t* block) {
+  iree_slim_mutex_lock(&pool->mutex);
+  block->next = pool->free_head;
+  pool->free_head = block;
+  pool->free_size += block->block_size;
+  iree_slim_mutex_unlock(&pool->mutex);
+}
+
+// Acquires an unused block from the pool that an allocation waiting on
+// |wait_semaphore_list| may reuse, if any.
+static iree_hal_task_pool_block_t* iree_hal_task_pool_acquire_block(
+    iree_hal_task_pool_t* pool, const iree_hal_buffer_params_t* params,
+    iree_device_size_t block_size,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  bool is_ordered = false;
+  iree_hal_task_pool_block_t* block = iree_hal_task_pool_take_block(
+      pool, params, block_size, wait_semaphore_list, &is_ordered);
+  if (!block || is_ordered) return block;
+
+  // The block has a pending deallocation the allocation is not ordered after.
+  // If the deallocation has since completed the block can be reused. The query
+  // happens outside of the pool lock as semaphores may release buffers.
+  uint64_t current_value = 0;
+  iree_status_t status =
+      iree_hal_semaphore_query(block->release_semaphore, &current_value);
+  if (iree_status_is_ok(status) && current_value >= block->release_value) {
+    return block;
+  }
+  iree_status_ignore(status);
+  iree_hal_task_pool_put_block(pool, block);
+  return NULL;
+}
+
+// Allocates a new block for buffers with |params| from |device_allocator|.
+static iree_status_t iree_hal_task_pool_allocate_block(
+    iree_hal_task_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    const iree_hal_buffer_params_t* params, iree_device_size_t block_size,
+    iree_hal_task_pool_block_t** out_block) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)block_size);
+
+  iree_hal_task_pool_block_t* block = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(pool->host_allocator, sizeof(*block),
+                                (void**)&block));
+  memset(block, 0, sizeof(*block));
+  block->memory_type = params->type;
+  block->allowed_access = params->access;
+  block->allowed_usage = params->usage;
+  block->block_size = block_size;
+
+  // Blocks are always persistently mapped so that they can be wrapped. The
+  // local device allocators are host-visible and support this for all buffers.
+  iree_hal_buffer_params_t backing_params = *params;
+  backing_params.type |= IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  backing_params.usage |= IREE_HAL_BUFFER_USAGE_MAPPING_PERSISTENT;
+  iree_status_t status = iree_hal_allocator_allocate_buffer(
+      device_allocator, backing_params, block_size, &block->backing_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_map_range(
+        block->backing_buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+        iree_hal_buffer_allowed_access(block->backing_buffer), 0, block_size,
+        &block->mapping);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_block = block;
+  } else {
+    iree_hal_buffer_release(block->backing_buffer);
+    iree_allocator_free(pool->host_allocator, block);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_task_pool_allocate(
+    iree_hal_task_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)allocation_size);
+
+  // Resolve the parameters the device allocator would use for the buffer such
+  // that blocks are only shared between equivalent buffers.
+  iree_hal_buffer_params_canonicalize(&params);
+  iree_hal_buffer_params_t compat_params = params;
+  if (!iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                             device_allocator, params, allocation_size,
+                             &compat_params, &allocation_size),
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot allocate a buffer with the given parameters");
+  }
+  const iree_device_size_t block_size =
+      iree_hal_task_pool_block_size(allocation_size);
+
+  iree_hal_task_pool_block_t* block = iree_hal_task_pool_acquire_block(
+      pool, &compat_params, block_size, wait_semaphore_list);
+  iree_status_t status = iree_ok_status();
+  if (block) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "reused");
+    iree_hal_semaphore_release(block->release_semaphore);
+    block->release_semaphore = NULL;
+    block->release_value = 0;
+  } else {
+    status = iree_hal_task_pool_allocate_block(
+        pool, device_allocator, &compat_params, block_size, &block);
+  }
+
+  // Wrap the block in a buffer that returns it to the pool when released.
+  iree_hal_task_pool_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(pool->host_allocator, sizeof(*buffer),
+                                   (void**)&buffer);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_task_pool_put_block(pool, block);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_initialize(pool->host_allocator, device_allocator,
+                               &buffer->base, allocation_size, 0,
+                               allocation_size, compat_params.type,
+                               compat_params.access, compat_params.usage,
+                               &iree_hal_task_pool_buffer_vtable,
+                               &buffer->base);
+    iree_hal_task_pool_retain(pool);
+    block->pool = pool;
+    buffer->block = block;
+    *out_buffer = &buffer->base;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+bool iree_hal_task_pool_deallocate(
+    iree_hal_buffer_t* buffer,
+    const iree_hal_semaphore_list_t signal_semaphore_list) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_resource_is(allocated_buffer,
+                            &iree_hal_task_pool_buffer_vtable)) {
+    return false;
+  }
+  iree_hal_task_pool_block_t* block =
+      ((iree_hal_task_pool_buffer_t*)allocated_buffer)->block;
+  iree_hal_task_pool_t* pool = block->pool;
+
+  // All semaphores are signaled together when the deallocation completes so
+  // the first is sufficient to order subsequent allocations.
+  iree_hal_semaphore_t* release_semaphore =
+      signal_semaphore_list.count > 0 ? signal_semaphore_list.semaphores[0]
+                                      : NULL;
+  uint64_t release_value =
+      signal_semaphore_list.count > 0 ? signal_semaphore_list.payload_values[0]
+                                      : 0;
+  iree_hal_semaphore_retain(release_semaphore);
+
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_semaphore_t* old_semaphore = block->release_semaphore;
+  block->release_semaphore = release_semaphore;
+  block->release_value = release_value;
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  iree_hal_semaphore_release(old_semaphore);
+  return true;
+}
+
+static void iree_hal_task_pool_buffer_destroy(iree_hal_buffer_t* base_buffer) {
+  iree_hal_task_pool_buffer_t* buffer =
+      (iree_hal_task_pool_buffer_t*)base_buffer;
+  iree_allocator_t host_allocator = base_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_task_pool_block_release(buffer->block);
+  iree_allocator_free(host_allocator, buffer);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_hal_task_pool_buffer_map_range(
+    iree_hal_buffer_t* base_buffer, iree_hal_mapping_mode_t mapping_mode,
+    iree_hal_memory_access_t memory_access,
+    iree_device_size_t local_byte_offset, iree_device_size_t local_byte_length,
+    iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_task_pool_buffer_t* buffer =
+      (iree_hal_task_pool_buffer_t*)base_buffer;
+  mapping->contents = iree_make_byte_span(
+      buffer->block->mapping.contents.data + local_byte_offset,
+      local_byte_length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_task_pool_buffer_unmap_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
+  // No-op as blocks are persistently mapped.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_task_pool_buffer_invalidate_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_hal_task_pool_buffer_t* buffer =
+      (iree_hal_task_pool_buffer_t*)base_buffer;
+  return iree_hal_buffer_mapping_invalidate_range(
+      &buffer->block->mapping, local_byte_offset, local_byte_length);
+}
+
+static iree_status_t iree_hal_task_pool_buffer_flush_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_hal_task_pool_buffer_t* buffer =
+      (iree_hal_task_pool_buffer_t*)base_buffer;
+  return iree_hal_buffer_mapping_flush_range(
+      &buffer->block->mapping, local_byte_offset, local_byte_length);
+}
+
+static const iree_hal_buffer_vtable_t iree_hal_task_pool_buffer_vtable = {
+    .recycle = iree_hal_buffer_recycle,
+    .destroy = iree_hal_task_pool_buffer_destroy,
+    .map_range = iree_hal_task_pool_buffer_map_range,
+    .unmap_range = iree_hal_task_pool_buffer_unmap_range,
+    .invalidate_range = iree_hal_task_pool_buffer_invalidate_range,
+    .flush_range = iree_hal_task_pool_buffer_flush_range,
+};
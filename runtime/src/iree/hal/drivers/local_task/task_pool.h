@@ -0,0 +1,77 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_LOCAL_TASK_TASK_POOL_H_
+#define IREE_HAL_DRIVERS_LOCAL_TASK_TASK_POOL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A pool of device memory blocks used to service queue-ordered allocations.
+//
+// Buffers returned from the pool wrap blocks of memory allocated from the
+// device allocator. When the last reference to a buffer is released its block
+// returns to the pool and can be handed out again for a compatible allocation.
+// Block sizes are quantized such that allocations of similar sizes (such as
+// those of dynamically shaped transients) can share blocks.
+//
+// Blocks deallocated with iree_hal_task_pool_deallocate are tagged with the
+// semaphore timepoint at which the deallocation completes on the queue. A
+// tagged block is only reused by allocations that are ordered after that
+// timepoint - either because it has already been reached or because the
+// allocation waits on it - and otherwise the allocation is serviced by another
+// block. This lets a sequence of alloca/execute/dealloca submissions chained by
+// semaphores recycle the same memory without ever blocking the host.
+//
+// Thread-safe. Buffers may be released from any thread, including workers.
+// The pool is reference counted by each live buffer and may outlive the device
+// that created it.
+typedef struct iree_hal_task_pool_t iree_hal_task_pool_t;
+
+// Creates a new empty pool. At most |release_threshold| bytes of unused blocks
+// are retained and any blocks released beyond that are freed immediately.
+iree_status_t iree_hal_task_pool_create(iree_device_size_t release_threshold,
+                                        iree_allocator_t host_allocator,
+                                        iree_hal_task_pool_t** out_pool);
+
+// Releases the caller's reference to |pool|. Live buffers keep the pool alive
+// until they are released.
+void iree_hal_task_pool_release(iree_hal_task_pool_t* pool);
+
+// Frees all unused blocks held by the pool.
+void iree_hal_task_pool_trim(iree_hal_task_pool_t* pool);
+
+// Allocates a buffer of |allocation_size| bytes with |params| from the pool.
+// New blocks are allocated from |device_allocator| when no unused compatible
+// block is available for reuse. |wait_semaphore_list| is the list of
+// semaphores the allocation is ordered after on the queue and is used to reuse
+// blocks whose deallocation has not yet completed.
+//
+// |out_buffer| must be released by the caller.
+iree_status_t iree_hal_task_pool_allocate(
+    iree_hal_task_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+// Marks |buffer| as deallocated once |signal_semaphore_list| is signaled.
+// The memory of the buffer is returned to the pool it was allocated from when
+// the buffer is released and will not be reused by allocations ordered before
+// the signal. The pool is found from the buffer in constant time.
+// Returns false if |buffer| was not allocated from a pool.
+bool iree_hal_task_pool_deallocate(
+    iree_hal_buffer_t* buffer,
+    const iree_hal_semaphore_list_t signal_semaphore_list);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_LOCAL_TASK_TASK_POOL_H_
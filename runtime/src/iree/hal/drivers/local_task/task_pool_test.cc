@@ -0,0 +1,235 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_pool.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/hal/drivers/local_task/task_semaphore.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Allocator forwarding to the system allocator that tracks the number of live
+// allocations such that tests can observe when pool blocks are freed.
+struct CountingAllocator {
+  std::atomic<int> live_count{0};
+
+  iree_allocator_t allocator() { return {this, Ctl}; }
+
+  static iree_status_t Ctl(void* self, iree_allocator_command_t command,
+                           const void* params, void** inout_ptr) {
+    auto* counting = static_cast<CountingAllocator*>(self);
+    iree_allocator_t system = iree_allocator_system();
+    if (command == IREE_ALLOCATOR_COMMAND_MALLOC ||
+        command == IREE_ALLOCATOR_COMMAND_CALLOC) {
+      ++counting->live_count;
+    } else if (command == IREE_ALLOCATOR_COMMAND_FREE) {
+      --counting->live_count;
+    }
+    return system.ctl(system.self, command, params, inout_ptr);
+  }
+};
+
+class TaskPoolTest : public ::testing::Test {
+ protected:
+  static constexpr iree_device_size_t kReleaseThreshold = 64 * 1024;
+
+  void SetUp() override {
+    iree_allocator_t host_allocator = iree_allocator_system();
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), data_allocator_.allocator(),
+        data_allocator_.allocator(), &device_allocator_));
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(1, &topology);
+    IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                             host_allocator, &executor_));
+    iree_task_topology_deinitialize(&topology);
+    IREE_ASSERT_OK(
+        iree_hal_task_pool_create(kReleaseThreshold, host_allocator, &pool_));
+    IREE_ASSERT_OK(iree_hal_task_semaphore_create(executor_, 0ull,
+                                                  host_allocator, &semaphore_));
+  }
+
+  void TearDown() override {
+    iree_hal_semaphore_release(semaphore_);
+    iree_hal_task_pool_release(pool_);
+    iree_task_executor_release(executor_);
+    iree_hal_allocator_release(device_allocator_);
+    EXPECT_EQ(data_allocator_.live_count.load(), 0);
+  }
+
+  iree_hal_buffer_t* Allocate(
+      iree_device_size_t size,
+      iree_hal_semaphore_list_t wait_list = iree_hal_semaphore_list_empty()) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_task_pool_allocate(pool_, device_allocator_,
+                                              wait_list, params, size,
+                                              &buffer));
+    return buffer;
+  }
+
+  // Returns the host address of the block backing |buffer|.
+  static uint8_t* BlockData(iree_hal_buffer_t* buffer) {
+    iree_hal_buffer_mapping_t mapping;
+    IREE_CHECK_OK(iree_hal_buffer_map_range(
+        buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_ANY, 0,
+        IREE_WHOLE_BUFFER, &mapping));
+    uint8_t* data = mapping.contents.data;
+    IREE_CHECK_OK(iree_hal_buffer_unmap_range(&mapping));
+    return data;
+  }
+
+  // Deallocates |buffer| once |semaphore_| reaches |value| and releases it.
+  void Deallocate(iree_hal_buffer_t* buffer, uint64_t value) {
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore_, &value};
+    EXPECT_TRUE(iree_hal_task_pool_deallocate(buffer, signal_list));
+    iree_hal_buffer_release(buffer);
+  }
+
+  CountingAllocator data_allocator_;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_task_executor_t* executor_ = NULL;
+  iree_hal_task_pool_t* pool_ = NULL;
+  iree_hal_semaphore_t* semaphore_ = NULL;
+};
+
+// Allocations of similar sizes share quantized blocks.
+TEST_F(TaskPoolTest, QuantizesBlockSizes) {
+  iree_hal_buffer_t* buffer0 = Allocate(1000);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer0), 1000);
+  uint8_t* data0 = BlockData(buffer0);
+  iree_hal_buffer_release(buffer0);
+
+  // 1000 and 1020 both round up to 1024 and share a block.
+  iree_hal_buffer_t* buffer1 = Allocate(1020);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer1), 1020);
+  EXPECT_EQ(BlockData(buffer1), data0);
+
+  // 1100 rounds up to 1280 and needs its own block.
+  iree_hal_buffer_t* buffer2 = Allocate(1100);
+  EXPECT_NE(BlockData(buffer2), data0);
+  iree_hal_buffer_release(buffer2);
+  iree_hal_buffer_release(buffer1);
+}
+
+// Blocks with a pending deallocation are only reused by allocations ordered
+// after it.
+TEST_F(TaskPoolTest, ReusesBlocksOrderedAfterDeallocation) {
+  iree_hal_buffer_t* buffer0 = Allocate(4096);
+  uint8_t* data0 = BlockData(buffer0);
+  Deallocate(buffer0, 1);
+
+  // Unordered allocations can't use the block until the semaphore is reached.
+  iree_hal_buffer_t* buffer1 = Allocate(4096);
+  EXPECT_NE(BlockData(buffer1), data0);
+
+  // Allocations waiting on the deallocation reuse the block.
+  uint64_t wait_value = 1;
+  iree_hal_semaphore_list_t wait_list = {1, &semaphore_, &wait_value};
+  iree_hal_buffer_t* buffer2 = Allocate(4096, wait_list);
+  EXPECT_EQ(BlockData(buffer2), data0);
+  Deallocate(buffer2, 2);
+
+  // Waiting on an earlier timepoint is not sufficient.
+  iree_hal_buffer_t* buffer3 = Allocate(4096, wait_list);
+  EXPECT_NE(BlockData(buffer3), data0);
+
+  // Once the deallocation completes any allocation may reuse the block.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphore_, 2));
+  iree_hal_buffer_t* buffer4 = Allocate(4096);
+  EXPECT_EQ(BlockData(buffer4), data0);
+
+  iree_hal_buffer_release(buffer4);
+  iree_hal_buffer_release(buffer3);
+  iree_hal_buffer_release(buffer1);
+}
+
+// Unused blocks beyond the release threshold are freed immediately and the
+// rest when trimmed.
+TEST_F(TaskPoolTest, ReleasesBlocksBeyondThreshold) {
+  const int baseline_count = data_allocator_.live_count.load();
+  iree_hal_buffer_t* buffer0 = Allocate(kReleaseThreshold);
+  iree_hal_buffer_t* buffer1 = Allocate(kReleaseThreshold);
+  const int allocated_count = data_allocator_.live_count.load();
+  EXPECT_GT(allocated_count, baseline_count);
+  const int block_count = (allocated_count - baseline_count) / 2;
+
+  // The first block fills the pool and the second is freed.
+  iree_hal_buffer_release(buffer0);
+  EXPECT_EQ(data_allocator_.live_count.load(), allocated_count);
+  iree_hal_buffer_release(buffer1);
+  EXPECT_EQ(data_allocator_.live_count.load(), allocated_count - block_count);
+
+  iree_hal_task_pool_trim(pool_);
+  EXPECT_EQ(data_allocator_.live_count.load(), baseline_count);
+}
+
+// Buffers keep their pool alive and return their blocks to it when released.
+TEST_F(TaskPoolTest, BuffersOutlivePool) {
+  iree_hal_buffer_t* buffer = Allocate(4096);
+  iree_hal_task_pool_release(pool_);
+  pool_ = NULL;
+  IREE_ASSERT_OK(iree_hal_buffer_map_fill(buffer, 0, IREE_WHOLE_BUFFER,
+                                          "\xCD", 1));
+  EXPECT_EQ(BlockData(buffer)[4095], 0xCD);
+  Deallocate(buffer, 1);
+}
+
+// Buffers allocated by queue-ordered allocations outlive the device and its
+// queue pools.
+TEST_F(TaskPoolTest, BuffersOutliveDevice) {
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  params.queue_ordered_allocations = true;
+  iree_hal_device_t* device = NULL;
+  IREE_ASSERT_OK(iree_hal_task_device_create(
+      IREE_SV("local-task"), &params, /*queue_count=*/1, &executor_,
+      /*loader_count=*/0, NULL, device_allocator_, iree_allocator_system(),
+      &device));
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device, 0ull, &semaphore));
+  uint64_t signal_value = 1;
+  iree_hal_semaphore_list_t signal_list = {1, &semaphore, &signal_value};
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+  buffer_params.usage =
+      IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      signal_list, IREE_HAL_ALLOCATOR_POOL_DEFAULT, buffer_params, 4096,
+      &buffer));
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 1, iree_infinite_timeout()));
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_device_release(device);
+
+  IREE_ASSERT_OK(iree_hal_buffer_map_fill(buffer, 0, IREE_WHOLE_BUFFER,
+                                          "\xCD", 1));
+  EXPECT_EQ(BlockData(buffer)[0], 0xCD);
+  iree_hal_buffer_release(buffer);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
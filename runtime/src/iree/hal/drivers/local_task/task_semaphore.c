@@ -49,6 +49,9 @@ static iree_status_t iree_hal_task_semaphore_timepoint_callback(
 typedef struct iree_hal_task_semaphore_t {
   iree_hal_semaphore_t base;
   iree_allocator_t host_allocator;
+  // Executor that waiting threads are donated to. Retained.
+  iree_task_executor_t* executor;
+  // Executor event pool used for timepoints. Unowned.
   iree_event_pool_t* event_pool;
 
   // Guards all mutable fields. We expect low contention on semaphores and since
@@ -74,9 +77,9 @@ static iree_hal_task_semaphore_t* iree_hal_task_semaphore_cast(
 }
 
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
+    iree_task_executor_t* executor, uint64_t initial_value,
     iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
-  IREE_ASSERT_ARGUMENT(event_pool);
+  IREE_ASSERT_ARGUMENT(executor);
   IREE_ASSERT_ARGUMENT(out_semaphore);
   *out_semaphore = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -88,7 +91,9 @@ iree_status_t iree_hal_task_semaphore_create(
     iree_hal_semaphore_initialize(&iree_hal_task_semaphore_vtable,
                                   &semaphore->base);
     semaphore->host_allocator = host_allocator;
-    semaphore->event_pool = event_pool;
+    semaphore->executor = executor;
+    iree_task_executor_retain(executor);
+    semaphore->event_pool = iree_task_executor_event_pool(executor);
 
     iree_slim_mutex_initialize(&semaphore->mutex);
     semaphore->current_value = initial_value;
@@ -110,6 +115,7 @@ static void iree_hal_task_semaphore_destroy(
 
   iree_slim_mutex_deinitialize(&semaphore->mutex);
   iree_status_ignore(semaphore->failure_status);
+  iree_task_executor_release(semaphore->executor);
 
   iree_hal_semaphore_deinitialize(&semaphore->base);
   iree_allocator_free(host_allocator, semaphore);
@@ -309,10 +315,17 @@ static iree_status_t iree_hal_task_semaphore_wait(
   iree_slim_mutex_unlock(&semaphore->mutex);
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) return status;
 
-  // Wait until the timepoint resolves.
+  // Wait until the timepoint resolves. Threadless executors need this thread
+  // to make progress so it is donated for the duration.
   // If satisfied the timepoint is automatically cleaned up and we are done. If
   // the deadline is reached before satisfied then we have to clean it up.
-  status = iree_wait_one(&timepoint.event, deadline_ns);
+  if (iree_task_executor_is_threadless(semaphore->executor)) {
+    status = iree_task_executor_donate_caller(
+        semaphore->executor, iree_event_await(&timepoint.event),
+        iree_make_deadline(deadline_ns));
+  } else {
+    status = iree_wait_one(&timepoint.event, deadline_ns);
+  }
   if (!iree_status_is_ok(status)) {
     iree_hal_semaphore_cancel_timepoint(&semaphore->base, &timepoint.base);
   }
@@ -321,10 +334,46 @@ static iree_status_t iree_hal_task_semaphore_wait(
   return status;
 }
 
+// Wait source resolving when the wait set stored in |self| is satisfied
+// according to the iree_hal_wait_mode_t stored in |data|.
+static iree_status_t iree_hal_task_semaphore_wait_set_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  iree_wait_set_t* wait_set = (iree_wait_set_t*)wait_source.self;
+  iree_hal_wait_mode_t wait_mode = (iree_hal_wait_mode_t)wait_source.data;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY:
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      iree_time_t deadline_ns =
+          command == IREE_WAIT_SOURCE_COMMAND_WAIT_ONE
+              ? iree_timeout_as_deadline_ns(
+                    ((const iree_wait_source_wait_params_t*)params)->timeout)
+              : IREE_TIME_INFINITE_PAST;
+      iree_status_t status =
+          wait_mode == IREE_HAL_WAIT_MODE_ANY
+              ? iree_wait_any(wait_set, deadline_ns, /*out_wake_handle=*/NULL)
+              : iree_wait_all(wait_set, deadline_ns);
+      if (command == IREE_WAIT_SOURCE_COMMAND_WAIT_ONE) return status;
+      iree_status_code_t* out_wait_status_code =
+          (iree_status_code_t*)inout_ptr;
+      if (iree_status_is_deadline_exceeded(status)) {
+        iree_status_ignore(status);
+        *out_wait_status_code = IREE_STATUS_DEFERRED;
+        return iree_ok_status();
+      }
+      *out_wait_status_code = iree_status_code(status);
+      return status;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
 iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
-    iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool) {
+    iree_task_executor_t* executor, iree_arena_block_pool_t* block_pool) {
   if (semaphore_list.count == 0) {
     return iree_ok_status();
   } else if (semaphore_list.count == 1) {
@@ -384,9 +433,17 @@ iree_status_t iree_hal_task_semaphore_multi_wait(
     }
   }
 
-  // Perform the wait.
+  // Perform the wait, donating the caller if the executor is threadless.
   if (iree_status_is_ok(status) && needs_wait) {
-    if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
+    if (iree_task_executor_is_threadless(executor)) {
+      iree_wait_source_t wait_source = {
+          .self = wait_set,
+          .data = (uint64_t)wait_mode,
+          .ctl = iree_hal_task_semaphore_wait_set_ctl,
+      };
+      status = iree_task_executor_donate_caller(
+          executor, wait_source, iree_make_deadline(deadline_ns));
+    } else if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
       status = iree_wait_any(wait_set, deadline_ns, /*out_wake_handle=*/NULL);
     } else {
       status = iree_wait_all(wait_set, deadline_ns);
@@ -399,7 +456,8 @@ iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_semaphore_t* semaphore = timepoints[i].semaphore;
     if (semaphore) {
       iree_hal_semaphore_cancel_timepoint(semaphore, &timepoints[i].base);
-      iree_event_pool_release(event_pool, 1, &timepoints[i].event);
+      iree_event_pool_release(iree_task_executor_event_pool(executor), 1,
+                              &timepoints[i].event);
     }
   }
   iree_wait_set_free(wait_set);
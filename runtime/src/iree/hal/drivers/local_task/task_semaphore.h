@@ -11,8 +11,8 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/arena.h"
-#include "iree/base/internal/event_pool.h"
 #include "iree/hal/api.h"
+#include "iree/task/executor.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
 
@@ -22,8 +22,10 @@ extern "C" {
 
 // Creates a semaphore that integrates with the task system to allow for
 // pipelined wait and signal operations.
+// |executor| is retained and used for its event pool. Threads blocking on the
+// semaphore are donated to it only if it is threadless.
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
+    iree_task_executor_t* executor, uint64_t initial_value,
     iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore);
 
 // Returns true if |semaphore| is a task system semaphore.
@@ -40,12 +42,14 @@ iree_status_t iree_hal_task_semaphore_enqueue_timepoint(
     iree_task_submission_t* submission);
 
 // Performs a multi-wait on one or more semaphores.
+// The calling thread is donated to |executor| while waiting if it is
+// threadless.
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if the wait does not complete before
 // |deadline_ns| elapses.
 iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
-    iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool);
+    iree_task_executor_t* executor, iree_arena_block_pool_t* block_pool);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -72,11 +72,10 @@ static iree_hal_inline_command_buffer_t* iree_hal_inline_command_buffer_cast(
   return (iree_hal_inline_command_buffer_t*)base_value;
 }
 
-static void iree_hal_inline_command_buffer_reset(
+// Sets up the cached dispatch state pointers that don't change.
+// Expects the state to have been zeroed.
+static void iree_hal_inline_command_buffer_initialize_state(
     iree_hal_inline_command_buffer_t* command_buffer) {
-  memset(&command_buffer->state, 0, sizeof(command_buffer->state));
-
-  // Setup the cached dispatch state pointers that don't change.
   iree_hal_executable_dispatch_state_v0_t* dispatch_state =
       &command_buffer->state.dispatch_state;
   dispatch_state->push_constants = command_buffer->state.push_constants;
@@ -85,6 +84,12 @@ static void iree_hal_inline_command_buffer_reset(
       command_buffer->state.packed_binding_lengths;
 }
 
+static void iree_hal_inline_command_buffer_reset(
+    iree_hal_inline_command_buffer_t* command_buffer) {
+  memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+  iree_hal_inline_command_buffer_initialize_state(command_buffer);
+}
+
 iree_host_size_t iree_hal_inline_command_buffer_size(void) {
   return sizeof(iree_hal_inline_command_buffer_t);
 }
@@ -130,7 +135,7 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
       device, mode, command_categories, queue_affinity, binding_capacity,
       &iree_hal_inline_command_buffer_vtable, &command_buffer->base);
   command_buffer->host_allocator = host_allocator;
-  iree_hal_inline_command_buffer_reset(command_buffer);
+  iree_hal_inline_command_buffer_initialize_state(command_buffer);
 
   *out_command_buffer = &command_buffer->base;
 
@@ -183,7 +188,7 @@ static void iree_hal_inline_command_buffer_destroy(
   iree_allocator_t host_allocator = command_buffer->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_inline_command_buffer_deinitialize(base_command_buffer);
+  // No need to reset the state as we hold no resources and are freeing it.
   iree_allocator_free(host_allocator, command_buffer);
 
   IREE_TRACE_ZONE_END(z0);
@@ -0,0 +1,845 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: must be first before _any_ system includes (for O_DIRECT).
+#define _GNU_SOURCE
+
+#include "iree/hal/utils/fd_file.h"
+
+#include "iree/base/internal/synchronization.h"
+
+//===----------------------------------------------------------------------===//
+// Configuration
+//===----------------------------------------------------------------------===//
+
+// File descriptors are supported on platforms providing pread/pwrite.
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+#define IREE_HAL_FD_FILE_HAVE_FD 1
+#else
+#define IREE_HAL_FD_FILE_HAVE_FD 0
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+
+// When 1 large transfers are issued via io_uring with many chunks in flight.
+// Android application sandboxes block the io_uring syscalls so it is disabled
+// there by default.
+#if !defined(IREE_HAL_FD_FILE_IO_URING_ENABLE)
+#if IREE_HAL_FD_FILE_HAVE_FD && defined(IREE_PLATFORM_LINUX) && \
+    !defined(IREE_PLATFORM_ANDROID)
+#define IREE_HAL_FD_FILE_IO_URING_ENABLE 1
+#else
+#define IREE_HAL_FD_FILE_IO_URING_ENABLE 0
+#endif  // IREE_PLATFORM_LINUX && !IREE_PLATFORM_ANDROID
+#endif  // !IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+#if !defined(IREE_HAL_FD_FILE_IO_URING_CHUNK_SIZE)
+// Bytes per io_uring read/write request. NVMe devices reach peak bandwidth with
+// requests of a few hundred KB as long as enough of them are in flight.
+#define IREE_HAL_FD_FILE_IO_URING_CHUNK_SIZE (1 * 1024 * 1024)
+#endif  // !IREE_HAL_FD_FILE_IO_URING_CHUNK_SIZE
+
+#if !defined(IREE_HAL_FD_FILE_IO_URING_QUEUE_DEPTH)
+// Maximum number of requests in flight at a time. Must be a power of two.
+#define IREE_HAL_FD_FILE_IO_URING_QUEUE_DEPTH 32
+#endif  // !IREE_HAL_FD_FILE_IO_URING_QUEUE_DEPTH
+
+#if !defined(IREE_HAL_FD_FILE_IO_URING_MIN_LENGTH)
+// Transfers smaller than this are performed with a single pread/pwrite as the
+// cost of setting up a ring outweighs the benefit of overlapping requests.
+#define IREE_HAL_FD_FILE_IO_URING_MIN_LENGTH \
+  (4 * IREE_HAL_FD_FILE_IO_URING_CHUNK_SIZE)
+#endif  // !IREE_HAL_FD_FILE_IO_URING_MIN_LENGTH
+
+// Alignment of file offsets, lengths, and host addresses required for O_DIRECT
+// transfers. 4096 satisfies the logical block size of all common devices.
+#define IREE_HAL_FD_FILE_DIRECT_ALIGNMENT 4096
+
+// Size of each buffer registered with io_uring; the kernel limits registered
+// buffers to 1GB each.
+#define IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_SIZE (1024 * 1024 * 1024)
+
+// Maximum number of buffers registered at a time. Transfers larger than this
+// many registered buffers use unregistered requests.
+#define IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_MAX_COUNT 1024
+
+#if IREE_HAL_FD_FILE_HAVE_FD
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if IREE_HAL_FD_FILE_IO_URING_ENABLE
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif  // IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+// Describes the direction of a transfer.
+typedef enum iree_hal_fd_file_direction_e {
+  // Reading from the file into host memory.
+  IREE_HAL_FD_FILE_DIRECTION_READ = 0,
+  // Writing from host memory into the file.
+  IREE_HAL_FD_FILE_DIRECTION_WRITE,
+} iree_hal_fd_file_direction_t;
+
+static iree_status_t iree_hal_fd_file_make_errno_status(
+    iree_hal_fd_file_direction_t direction, int error_number,
+    uint64_t file_offset) {
+  return iree_make_status(
+      iree_status_code_from_errno(error_number),
+      "file %s failed at offset %" PRIu64 " (%d: %s)",
+      direction == IREE_HAL_FD_FILE_DIRECTION_READ ? "read" : "write",
+      file_offset, error_number, strerror(error_number));
+}
+
+//===----------------------------------------------------------------------===//
+// Synchronous positional IO
+//===----------------------------------------------------------------------===//
+
+// Transfers |length| bytes at |file_offset| of |fd| with pread/pwrite.
+// Short transfers are continued until the whole range has been processed.
+static iree_status_t iree_hal_fd_file_transfer_sync(
+    int fd, iree_hal_fd_file_direction_t direction, uint64_t file_offset,
+    uint8_t* host_ptr, iree_host_size_t length) {
+  while (length > 0) {
+    ssize_t result =
+        direction == IREE_HAL_FD_FILE_DIRECTION_READ
+            ? pread(fd, host_ptr, length, (off_t)file_offset)
+            : pwrite(fd, host_ptr, length, (off_t)file_offset);
+    if (result < 0) {
+      if (errno == EINTR) continue;
+      return iree_hal_fd_file_make_errno_status(direction, errno, file_offset);
+    } else if (result == 0) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "unexpected end of file at offset %" PRIu64,
+                              file_offset);
+    }
+    file_offset += (uint64_t)result;
+    host_ptr += result;
+    length -= (iree_host_size_t)result;
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// io_uring transfers
+//===----------------------------------------------------------------------===//
+// We use the raw syscalls instead of liburing to avoid the dependency; the
+// subset needed for batched reads/writes is small.
+
+#if IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+// An io_uring instance with its submission and completion rings mapped.
+typedef struct iree_hal_fd_file_ring_t {
+  int ring_fd;
+  void* sq_ring;
+  size_t sq_ring_size;
+  void* cq_ring;
+  size_t cq_ring_size;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+  uint32_t* sq_head;
+  uint32_t* sq_tail;
+  uint32_t sq_mask;
+  uint32_t* sq_array;
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t cq_mask;
+  struct io_uring_cqe* cqes;
+  // Host memory range registered as fixed buffers or NULL/0 if none.
+  uint8_t* registered_ptr;
+  iree_host_size_t registered_length;
+} iree_hal_fd_file_ring_t;
+
+// Closing the ring implicitly unregisters any registered buffers.
+static void iree_hal_fd_file_ring_deinitialize(iree_hal_fd_file_ring_t* ring) {
+  if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+    munmap(ring->cq_ring, ring->cq_ring_size);
+  }
+  if (ring->sq_ring) munmap(ring->sq_ring, ring->sq_ring_size);
+  if (ring->ring_fd >= 0) close(ring->ring_fd);
+  memset(ring, 0, sizeof(*ring));
+  ring->ring_fd = -1;
+}
+
+// Creates a ring with |queue_depth| entries. Fails if io_uring is unavailable
+// or lacks the IORING_OP_READ/WRITE opcodes (added in Linux 5.6).
+static iree_status_t iree_hal_fd_file_ring_initialize(
+    uint32_t queue_depth, iree_hal_fd_file_ring_t* out_ring) {
+  memset(out_ring, 0, sizeof(*out_ring));
+  out_ring->ring_fd = -1;
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = (int)syscall(__NR_io_uring_setup, queue_depth, &params);
+  if (ring_fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring_setup failed (%d: %s)", errno,
+                            strerror(errno));
+  }
+  out_ring->ring_fd = ring_fd;
+  if (!iree_all_bits_set(params.features, IORING_FEAT_RW_CUR_POS)) {
+    iree_hal_fd_file_ring_deinitialize(out_ring);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "io_uring lacks IORING_OP_READ/WRITE support");
+  }
+
+  out_ring->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  out_ring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap =
+      iree_all_bits_set(params.features, IORING_FEAT_SINGLE_MMAP);
+  if (single_mmap) {
+    out_ring->sq_ring_size = out_ring->cq_ring_size =
+        iree_max(out_ring->sq_ring_size, out_ring->cq_ring_size);
+  }
+  void* sq_ring =
+      mmap(NULL, out_ring->sq_ring_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    iree_hal_fd_file_ring_deinitialize(out_ring);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring submission ring mmap failed");
+  }
+  out_ring->sq_ring = sq_ring;
+  void* cq_ring = sq_ring;
+  if (!single_mmap) {
+    cq_ring = mmap(NULL, out_ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      iree_hal_fd_file_ring_deinitialize(out_ring);
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "io_uring completion ring mmap failed");
+    }
+  }
+  out_ring->cq_ring = cq_ring;
+  out_ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(NULL, out_ring->sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    iree_hal_fd_file_ring_deinitialize(out_ring);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring submission entries mmap failed");
+  }
+  out_ring->sqes = (struct io_uring_sqe*)sqes;
+
+  uint8_t* sq_base = (uint8_t*)sq_ring;
+  out_ring->sq_head = (uint32_t*)(sq_base + params.sq_off.head);
+  out_ring->sq_tail = (uint32_t*)(sq_base + params.sq_off.tail);
+  out_ring->sq_mask = *(uint32_t*)(sq_base + params.sq_off.ring_mask);
+  out_ring->sq_array = (uint32_t*)(sq_base + params.sq_off.array);
+  uint8_t* cq_base = (uint8_t*)cq_ring;
+  out_ring->cq_head = (uint32_t*)(cq_base + params.cq_off.head);
+  out_ring->cq_tail = (uint32_t*)(cq_base + params.cq_off.tail);
+  out_ring->cq_mask = *(uint32_t*)(cq_base + params.cq_off.ring_mask);
+  out_ring->cqes = (struct io_uring_cqe*)(cq_base + params.cq_off.cqes);
+  return iree_ok_status();
+}
+
+// Unregisters the fixed buffers of |ring|, if any.
+static void iree_hal_fd_file_ring_unregister_buffers(
+    iree_hal_fd_file_ring_t* ring) {
+  if (!ring->registered_length) return;
+  syscall(__NR_io_uring_register, ring->ring_fd, IORING_UNREGISTER_BUFFERS,
+          NULL, 0);
+  ring->registered_ptr = NULL;
+  ring->registered_length = 0;
+}
+
+// Returns true if |host_ptr|..|host_ptr|+|length| is within the fixed buffers
+// registered with |ring|.
+static bool iree_hal_fd_file_ring_is_registered(
+    const iree_hal_fd_file_ring_t* ring, const uint8_t* host_ptr,
+    iree_host_size_t length) {
+  return ring->registered_length > 0 && host_ptr >= ring->registered_ptr &&
+         length <= ring->registered_length &&
+         (iree_host_size_t)(host_ptr - ring->registered_ptr) <=
+             ring->registered_length - length;
+}
+
+// Tries to register |host_ptr|..|host_ptr|+|length| as fixed buffers so that
+// the kernel does not need to pin and map pages on every request, replacing
+// any previously registered buffers. Registered buffers are split every
+// IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_SIZE bytes. Registration
+// commonly fails due to RLIMIT_MEMLOCK or file-backed mappings in which case
+// transfers proceed with unregistered requests.
+static bool iree_hal_fd_file_ring_try_register_buffers(
+    iree_hal_fd_file_ring_t* ring, uint8_t* host_ptr, iree_host_size_t length) {
+  iree_hal_fd_file_ring_unregister_buffers(ring);
+  const iree_host_size_t buffer_count = iree_host_size_ceil_div(
+      length, IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_SIZE);
+  if (buffer_count > IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_MAX_COUNT) {
+    return false;
+  }
+  struct iovec* iovecs =
+      (struct iovec*)iree_alloca(buffer_count * sizeof(struct iovec));
+  for (iree_host_size_t i = 0; i < buffer_count; ++i) {
+    const iree_host_size_t offset =
+        i * IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_SIZE;
+    iovecs[i].iov_base = host_ptr + offset;
+    iovecs[i].iov_len = iree_min(
+        length - offset, IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_SIZE);
+  }
+  if (syscall(__NR_io_uring_register, ring->ring_fd, IORING_REGISTER_BUFFERS,
+              iovecs, (unsigned)buffer_count) != 0) {
+    return false;
+  }
+  ring->registered_ptr = host_ptr;
+  ring->registered_length = length;
+  return true;
+}
+
+// A chunk request slot; the user_data of each request is its slot index.
+typedef struct iree_hal_fd_file_ring_slot_t {
+  // Offset of the remaining chunk range relative to the transfer start.
+  iree_host_size_t offset;
+  // Remaining length of the chunk.
+  uint32_t length;
+} iree_hal_fd_file_ring_slot_t;
+
+// Enqueues a request for |slot| into the submission ring.
+// The ring always has space as at most one request per slot is in flight.
+static void iree_hal_fd_file_ring_enqueue(
+    iree_hal_fd_file_ring_t* ring, int fd,
+    iree_hal_fd_file_direction_t direction, uint64_t file_offset,
+    uint8_t* host_ptr, bool registered, uint32_t slot_index,
+    const iree_hal_fd_file_ring_slot_t* slot) {
+  const uint32_t tail = *ring->sq_tail;
+  const uint32_t index = tail & ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  if (direction == IREE_HAL_FD_FILE_DIRECTION_READ) {
+    sqe->opcode = registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  } else {
+    sqe->opcode = registered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+  }
+  sqe->fd = fd;
+  sqe->off = file_offset + slot->offset;
+  sqe->addr = (uint64_t)(uintptr_t)(host_ptr + slot->offset);
+  sqe->len = slot->length;
+  if (registered) {
+    sqe->buf_index =
+        (uint16_t)((iree_host_size_t)(host_ptr + slot->offset -
+                                      ring->registered_ptr) /
+                   IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_SIZE);
+  }
+  sqe->user_data = slot_index;
+  ring->sq_array[index] = index;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// Transfers |length| bytes at |file_offset| of |fd| using |ring| by keeping up
+// to IREE_HAL_FD_FILE_IO_URING_QUEUE_DEPTH chunk requests in flight. Requests
+// use the fixed buffers registered with |ring| if they cover the host range.
+// Always waits for all issued requests to complete before returning, even on
+// failure, so that the host memory is no longer in use by the kernel.
+static iree_status_t iree_hal_fd_file_ring_transfer(
+    iree_hal_fd_file_ring_t* ring, int fd,
+    iree_hal_fd_file_direction_t direction, uint64_t file_offset,
+    uint8_t* host_ptr, iree_host_size_t length) {
+  const bool registered =
+      iree_hal_fd_file_ring_is_registered(ring, host_ptr, length);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)length);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, registered ? "registered" : "unregistered");
+
+  iree_hal_fd_file_ring_slot_t slots[IREE_HAL_FD_FILE_IO_URING_QUEUE_DEPTH];
+  uint32_t free_slots[IREE_HAL_FD_FILE_IO_URING_QUEUE_DEPTH];
+  uint32_t free_slot_count = IREE_HAL_FD_FILE_IO_URING_QUEUE_DEPTH;
+  for (uint32_t i = 0; i < free_slot_count; ++i) free_slots[i] = i;
+
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t transfer_head = 0;
+  uint32_t pending_submit_count = 0;
+  uint32_t in_flight_count = 0;
+  do {
+    // Fill all free slots with new chunks unless we are draining due to error.
+    while (iree_status_is_ok(status) && free_slot_count > 0 &&
+           transfer_head < length) {
+      const uint32_t slot_index = free_slots[--free_slot_count];
+      iree_hal_fd_file_ring_slot_t* slot = &slots[slot_index];
+      iree_host_size_t chunk_length = iree_min(
+          length - transfer_head, IREE_HAL_FD_FILE_IO_URING_CHUNK_SIZE);
+      if (registered) {
+        // Requests must not span registered buffers.
+        const iree_host_size_t registered_offset =
+            (iree_host_size_t)(host_ptr + transfer_head - ring->registered_ptr);
+        chunk_length = iree_min(
+            chunk_length,
+            IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_SIZE -
+                registered_offset %
+                    IREE_HAL_FD_FILE_IO_URING_REGISTERED_BUFFER_SIZE);
+      }
+      slot->offset = transfer_head;
+      slot->length = (uint32_t)chunk_length;
+      transfer_head += slot->length;
+      iree_hal_fd_file_ring_enqueue(ring, fd, direction, file_offset, host_ptr,
+                                    registered, slot_index, slot);
+      ++pending_submit_count;
+      ++in_flight_count;
+    }
+    if (in_flight_count == 0) break;
+
+    // Submit new requests and wait for at least one completion.
+    int result = (int)syscall(__NR_io_uring_enter, ring->ring_fd,
+                              pending_submit_count, 1, IORING_ENTER_GETEVENTS,
+                              NULL, 0);
+    if (result < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+      status = iree_status_join(
+          status,
+          iree_make_status(iree_status_code_from_errno(errno),
+                           "io_uring_enter failed (%d: %s)", errno,
+                           strerror(errno)));
+      // Unsubmitted requests will never complete but those submitted earlier
+      // must still be waited on so that the host memory is no longer in use
+      // when we return.
+      const bool had_pending_submits = pending_submit_count > 0;
+      in_flight_count -= pending_submit_count;
+      pending_submit_count = 0;
+      if (!had_pending_submits) break;
+      continue;
+    }
+    pending_submit_count -= iree_min((uint32_t)result, pending_submit_count);
+
+    // Reap all available completions.
+    uint32_t cq_head = *ring->cq_head;
+    const uint32_t cq_tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; cq_head != cq_tail; ++cq_head) {
+      const struct io_uring_cqe* cqe = &ring->cqes[cq_head & ring->cq_mask];
+      const uint32_t slot_index = (uint32_t)cqe->user_data;
+      iree_hal_fd_file_ring_slot_t* slot = &slots[slot_index];
+      --in_flight_count;
+      if (cqe->res < 0 && cqe->res != -EINTR && cqe->res != -EAGAIN) {
+        if (iree_status_is_ok(status)) {
+          status = iree_hal_fd_file_make_errno_status(
+              direction, -cqe->res, file_offset + slot->offset);
+        }
+      } else if (cqe->res == 0) {
+        if (iree_status_is_ok(status)) {
+          status = iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "unexpected end of file at offset %" PRIu64,
+              file_offset + slot->offset);
+        }
+      } else if (iree_status_is_ok(status) &&
+                 (cqe->res < 0 || (uint32_t)cqe->res < slot->length)) {
+        // Retry interrupted requests and continue short ones in place.
+        if (cqe->res > 0) {
+          slot->offset += (uint32_t)cqe->res;
+          slot->length -= (uint32_t)cqe->res;
+        }
+        iree_hal_fd_file_ring_enqueue(ring, fd, direction, file_offset,
+                                      host_ptr, registered, slot_index, slot);
+        ++pending_submit_count;
+        ++in_flight_count;
+        continue;
+      }
+      free_slots[free_slot_count++] = slot_index;
+    }
+    __atomic_store_n(ring->cq_head, cq_head, __ATOMIC_RELEASE);
+  } while (in_flight_count > 0 ||
+           (iree_status_is_ok(status) && transfer_head < length));
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+typedef struct iree_hal_fd_file_ring_t iree_hal_fd_file_ring_t;
+
+#endif  // IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+// Transfers |length| bytes at |file_offset| of |fd|, using |ring| for large
+// transfers when available.
+static iree_status_t iree_hal_fd_file_transfer_bulk(
+    iree_hal_fd_file_ring_t* ring, int fd,
+    iree_hal_fd_file_direction_t direction, uint64_t file_offset,
+    uint8_t* host_ptr, iree_host_size_t length) {
+#if IREE_HAL_FD_FILE_IO_URING_ENABLE
+  if (ring && length >= IREE_HAL_FD_FILE_IO_URING_MIN_LENGTH) {
+    return iree_hal_fd_file_ring_transfer(ring, fd, direction, file_offset,
+                                          host_ptr, length);
+  }
+#endif  // IREE_HAL_FD_FILE_IO_URING_ENABLE
+  return iree_hal_fd_file_transfer_sync(fd, direction, file_offset, host_ptr,
+                                        length);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_fd_file_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_fd_file_t {
+  iree_hal_resource_t resource;
+  // Used to allocate this structure.
+  iree_allocator_t host_allocator;
+  // Allowed access bits.
+  iree_hal_memory_access_t access;
+  // Base file handle, retained.
+  iree_io_file_handle_t* handle;
+  // Total length of the file when it was imported.
+  uint64_t length;
+  // Descriptor from the handle opened with O_DIRECT or -1 if not direct.
+  int direct_fd;
+  // Descriptor used for buffered (and any unaligned) IO. Either the handle
+  // descriptor or a reopened descriptor owned by the file if the handle
+  // descriptor is direct.
+  int buffered_fd;
+#if IREE_HAL_FD_FILE_IO_URING_ENABLE
+  // Serializes bulk transfers on |ring|.
+  iree_slim_mutex_t ring_mutex;
+  // True once creating |ring| has been attempted.
+  bool ring_queried;
+  // Ring shared by all bulk transfers or ring_fd -1 if io_uring is unavailable
+  // (old kernel/seccomp/etc). Created on the first large transfer.
+  iree_hal_fd_file_ring_t ring;
+  // Host-local buffer whose memory is registered with |ring|, retained so that
+  // the registered pages remain in use by it until replaced or the file is
+  // destroyed.
+  iree_hal_buffer_t* registered_buffer;
+#endif  // IREE_HAL_FD_FILE_IO_URING_ENABLE
+} iree_hal_fd_file_t;
+
+static const iree_hal_file_vtable_t iree_hal_fd_file_vtable;
+
+static iree_hal_fd_file_t* iree_hal_fd_file_cast(
+    iree_hal_file_t* IREE_RESTRICT base_value) {
+  return (iree_hal_fd_file_t*)base_value;
+}
+
+// Returns a buffered descriptor on the same file as the O_DIRECT |direct_fd|.
+// |direct_fd_flags| are the file status flags of |direct_fd|.
+static iree_status_t iree_hal_fd_file_reopen_buffered(int direct_fd,
+                                                      int direct_fd_flags,
+                                                      int* out_fd) {
+  *out_fd = -1;
+  char fd_path[64];
+  snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", direct_fd);
+  int fd = open(fd_path, (direct_fd_flags & O_ACCMODE) | O_CLOEXEC);
+  if (fd == -1) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to reopen O_DIRECT file for unaligned "
+                            "access (%d: %s)",
+                            errno, strerror(errno));
+  }
+  *out_fd = fd;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_from_handle(
+    iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+  if (iree_io_file_handle_type(handle) != IREE_IO_FILE_HANDLE_TYPE_FD) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "file handle is not a file descriptor");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  uint64_t length = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_file_handle_query_length(handle, &length));
+
+  iree_hal_fd_file_t* file = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*file), (void**)&file));
+  iree_hal_resource_initialize(&iree_hal_fd_file_vtable, &file->resource);
+  file->host_allocator = host_allocator;
+  file->access = access;
+  file->handle = handle;
+  iree_io_file_handle_retain(handle);
+  file->length = length;
+#if IREE_HAL_FD_FILE_IO_URING_ENABLE
+  iree_slim_mutex_initialize(&file->ring_mutex);
+  file->ring_queried = false;
+  memset(&file->ring, 0, sizeof(file->ring));
+  file->ring.ring_fd = -1;
+  file->registered_buffer = NULL;
+#endif  // IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+  const int fd = iree_io_file_handle_value(handle).fd;
+  file->direct_fd = -1;
+  file->buffered_fd = fd;
+  iree_status_t status = iree_ok_status();
+#if defined(O_DIRECT)
+  const int fd_flags = fcntl(fd, F_GETFL);
+  if (fd_flags != -1 && iree_all_bits_set(fd_flags, O_DIRECT)) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "O_DIRECT");
+    file->direct_fd = fd;
+    status = iree_hal_fd_file_reopen_buffered(fd, fd_flags,
+                                              &file->buffered_fd);
+  }
+#endif  // O_DIRECT
+
+  if (iree_status_is_ok(status)) {
+    *out_file = (iree_hal_file_t*)file;
+  } else {
+    iree_hal_file_release((iree_hal_file_t*)file);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_fd_file_destroy(iree_hal_file_t* IREE_RESTRICT base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  iree_allocator_t host_allocator = file->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+#if IREE_HAL_FD_FILE_IO_URING_ENABLE
+  iree_hal_fd_file_ring_deinitialize(&file->ring);
+  iree_hal_buffer_release(file->registered_buffer);
+  iree_slim_mutex_deinitialize(&file->ring_mutex);
+#endif  // IREE_HAL_FD_FILE_IO_URING_ENABLE
+  if (file->direct_fd != -1 && file->buffered_fd != -1) {
+    close(file->buffered_fd);
+  }
+  iree_io_file_handle_release(file->handle);
+
+  iree_allocator_free(host_allocator, file);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_hal_memory_access_t iree_hal_fd_file_allowed_access(
+    iree_hal_file_t* base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  return file->access;
+}
+
+static uint64_t iree_hal_fd_file_length(iree_hal_file_t* base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  return file->length;
+}
+
+static iree_hal_buffer_t* iree_hal_fd_file_storage_buffer(
+    iree_hal_file_t* base_file) {
+  // Descriptors cannot be accessed by devices directly.
+  return NULL;
+}
+
+#if IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+// Acquires exclusive use of the file ring for a transfer of |length| bytes
+// to/from |host_ptr| mapped from |buffer|. Returns NULL if io_uring is
+// unavailable or the transfer is too small to use it. The memory of host-local
+// buffers stays registered with the ring across transfers such that repeated
+// transfers to/from the same buffer avoid pinning pages on each request; other
+// buffers may be backed by transient mappings and are only registered for the
+// duration of the transfer. Must be paired with iree_hal_fd_file_release_ring.
+static iree_hal_fd_file_ring_t* iree_hal_fd_file_acquire_ring(
+    iree_hal_fd_file_t* file, iree_hal_buffer_t* buffer, uint8_t* host_ptr,
+    iree_host_size_t length) {
+  if (length < IREE_HAL_FD_FILE_IO_URING_MIN_LENGTH) return NULL;
+  iree_slim_mutex_lock(&file->ring_mutex);
+  if (!file->ring_queried) {
+    file->ring_queried = true;
+    // Unavailable (old kernel/seccomp/etc); fall back to synchronous IO.
+    iree_status_ignore(iree_hal_fd_file_ring_initialize(
+        IREE_HAL_FD_FILE_IO_URING_QUEUE_DEPTH, &file->ring));
+  }
+  if (file->ring.ring_fd == -1) {
+    iree_slim_mutex_unlock(&file->ring_mutex);
+    return NULL;
+  }
+
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (file->registered_buffer != allocated_buffer ||
+      !iree_hal_fd_file_ring_is_registered(&file->ring, host_ptr, length)) {
+    iree_hal_buffer_release(file->registered_buffer);
+    file->registered_buffer = NULL;
+    if (iree_hal_fd_file_ring_try_register_buffers(&file->ring, host_ptr,
+                                                   length) &&
+        iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                          IREE_HAL_MEMORY_TYPE_HOST_LOCAL)) {
+      file->registered_buffer = allocated_buffer;
+      iree_hal_buffer_retain(allocated_buffer);
+    }
+  }
+  return &file->ring;
+}
+
+// Releases the file ring acquired with iree_hal_fd_file_acquire_ring.
+static void iree_hal_fd_file_release_ring(iree_hal_fd_file_t* file,
+                                          iree_hal_fd_file_ring_t* ring) {
+  if (!ring) return;
+  if (!file->registered_buffer) {
+    iree_hal_fd_file_ring_unregister_buffers(ring);
+  }
+  iree_slim_mutex_unlock(&file->ring_mutex);
+}
+
+#else
+
+static iree_hal_fd_file_ring_t* iree_hal_fd_file_acquire_ring(
+    iree_hal_fd_file_t* file, iree_hal_buffer_t* buffer, uint8_t* host_ptr,
+    iree_host_size_t length) {
+  return NULL;
+}
+
+static void iree_hal_fd_file_release_ring(iree_hal_fd_file_t* file,
+                                          iree_hal_fd_file_ring_t* ring) {}
+
+#endif  // IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+// Transfers |length| bytes at |file_offset| to/from |host_ptr| mapped from
+// |buffer|.
+// When the file is direct the largest aligned interior range is transferred
+// with the direct descriptor and the unaligned head and tail (if any) with the
+// buffered descriptor.
+static iree_status_t iree_hal_fd_file_transfer(
+    iree_hal_fd_file_t* file, iree_hal_fd_file_direction_t direction,
+    iree_hal_buffer_t* buffer, uint64_t file_offset, uint8_t* host_ptr,
+    iree_host_size_t length) {
+  iree_hal_fd_file_ring_t* ring =
+      iree_hal_fd_file_acquire_ring(file, buffer, host_ptr, length);
+  iree_status_t status = iree_ok_status();
+  if (file->direct_fd == -1) {
+    status = iree_hal_fd_file_transfer_bulk(ring, file->buffered_fd, direction,
+                                            file_offset, host_ptr, length);
+    iree_hal_fd_file_release_ring(file, ring);
+    return status;
+  }
+
+  // O_DIRECT requires the file offset, length, and host address to all be
+  // aligned. Find the aligned interior of the range and check that the host
+  // pointer has the same alignment relative to the file offset.
+  const uint64_t alignment = IREE_HAL_FD_FILE_DIRECT_ALIGNMENT;
+  const uint64_t body_begin = iree_host_align(file_offset, alignment);
+  const uint64_t body_end = (file_offset + length) & ~(alignment - 1);
+  const iree_host_size_t head_length =
+      (iree_host_size_t)(body_begin - file_offset);
+  if (body_begin >= body_end ||
+      !iree_host_size_has_alignment((uintptr_t)(host_ptr + head_length),
+                                    alignment)) {
+    // No aligned interior or the host memory is misaligned relative to the
+    // file; transfer everything buffered.
+    status = iree_hal_fd_file_transfer_bulk(ring, file->buffered_fd, direction,
+                                            file_offset, host_ptr, length);
+    iree_hal_fd_file_release_ring(file, ring);
+    return status;
+  }
+  const iree_host_size_t body_length =
+      (iree_host_size_t)(body_end - body_begin);
+  const iree_host_size_t tail_length = length - head_length - body_length;
+  if (head_length > 0) {
+    status = iree_hal_fd_file_transfer_sync(file->buffered_fd, direction,
+                                            file_offset, host_ptr, head_length);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fd_file_transfer_bulk(ring, file->direct_fd, direction,
+                                            body_begin, host_ptr + head_length,
+                                            body_length);
+  }
+  if (iree_status_is_ok(status) && tail_length > 0) {
+    status = iree_hal_fd_file_transfer_sync(
+        file->buffered_fd, direction, body_end,
+        host_ptr + head_length + body_length, tail_length);
+  }
+  iree_hal_fd_file_release_ring(file, ring);
+  return status;
+}
+
+static iree_status_t iree_hal_fd_file_read(iree_hal_file_t* base_file,
+                                           uint64_t file_offset,
+                                           iree_hal_buffer_t* buffer,
+                                           iree_device_size_t buffer_offset,
+                                           iree_device_size_t length) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  if (!iree_all_bits_set(file->access, IREE_HAL_MEMORY_ACCESS_READ)) {
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "file was not imported with read access");
+  }
+  if (length == 0) return iree_ok_status();
+  if (file_offset > file->length || length > file->length - file_offset) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "file read of %" PRIdsz " bytes at offset %" PRIu64
+        " exceeds file length %" PRIu64,
+        length, file_offset, file->length);
+  }
+
+  // Read directly into the buffer memory.
+  iree_hal_buffer_mapping_t mapping;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE, buffer_offset, length, &mapping));
+  iree_status_t status = iree_hal_fd_file_transfer(
+      file, IREE_HAL_FD_FILE_DIRECTION_READ, buffer, file_offset,
+      mapping.contents.data, mapping.contents.data_length);
+  if (iree_status_is_ok(status) &&
+      !iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status =
+        iree_hal_buffer_mapping_flush_range(&mapping, 0, IREE_WHOLE_BUFFER);
+  }
+  iree_hal_buffer_unmap_range(&mapping);
+  return status;
+}
+
+static iree_status_t iree_hal_fd_file_write(iree_hal_file_t* base_file,
+                                            uint64_t file_offset,
+                                            iree_hal_buffer_t* buffer,
+                                            iree_device_size_t buffer_offset,
+                                            iree_device_size_t length) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  if (!iree_all_bits_set(file->access, IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "file was not imported with write access");
+  }
+  if (length == 0) return iree_ok_status();
+
+  // Write directly from the buffer memory.
+  iree_hal_buffer_mapping_t mapping;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ,
+      buffer_offset, length, &mapping));
+  iree_status_t status = iree_ok_status();
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status = iree_hal_buffer_mapping_invalidate_range(&mapping, 0,
+                                                      IREE_WHOLE_BUFFER);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fd_file_transfer(
+        file, IREE_HAL_FD_FILE_DIRECTION_WRITE, buffer, file_offset,
+        mapping.contents.data, mapping.contents.data_length);
+  }
+  iree_hal_buffer_unmap_range(&mapping);
+  return status;
+}
+
+static const iree_hal_file_vtable_t iree_hal_fd_file_vtable = {
+    .destroy = iree_hal_fd_file_destroy,
+    .allowed_access = iree_hal_fd_file_allowed_access,
+    .length = iree_hal_fd_file_length,
+    .storage_buffer = iree_hal_fd_file_storage_buffer,
+    .read = iree_hal_fd_file_read,
+    .write = iree_hal_fd_file_write,
+};
+
+#else
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_from_handle(
+    iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file descriptor-backed files are not available on "
+                          "this platform");
+}
+
+#endif  // IREE_HAL_FD_FILE_HAVE_FD
@@ -0,0 +1,42 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_FD_FILE_H_
+#define IREE_HAL_UTILS_FD_FILE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/io/file_handle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_fd_file_t
+//===----------------------------------------------------------------------===//
+
+// Creates a file backed by the file descriptor of |handle|.
+// |handle| must be of type IREE_IO_FILE_HANDLE_TYPE_FD and will be retained for
+// the lifetime of the file.
+//
+// Reads and writes are performed with positional IO against the descriptor and
+// never modify its file position. On Linux large transfers are split into
+// chunks and issued with many in flight at a time via io_uring, falling back to
+// pread/pwrite when io_uring is unavailable (old kernels, seccomp filters,
+// etc). If the descriptor was opened with O_DIRECT (see
+// IREE_IO_FILE_MODE_DIRECT) the aligned portion of each transfer bypasses the
+// page cache and any unaligned head/tail is serviced through a buffered
+// descriptor reopened on the same file.
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_from_handle(
+    iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_FD_FILE_H_
@@ -0,0 +1,225 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/fd_file.h"
+
+#include "iree/base/config.h"
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "iree/base/internal/file_io.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+std::string GetUniquePath(const char* unique_name) {
+  const char* test_tmpdir = getenv("TEST_TMPDIR");
+  if (!test_tmpdir) test_tmpdir = getenv("TMPDIR");
+  if (!test_tmpdir) test_tmpdir = "/tmp";
+  std::random_device d;
+  char unique_path[256];
+  snprintf(unique_path, sizeof(unique_path), "%s/iree_test_%08x%08x_%s",
+           test_tmpdir, d(), d(), unique_name);
+  return unique_path;
+}
+
+class FdFileTest : public ::testing::Test {
+ protected:
+  // Large enough to be split into many in-flight chunks with an odd tail.
+  static constexpr size_t kFileSize = 24 * 1024 * 1024 + 123;
+
+  void SetUp() override {
+    path_ = GetUniquePath("fd_file");
+    contents_.resize(kFileSize);
+    for (size_t i = 0; i < contents_.size(); ++i) {
+      contents_[i] = static_cast<uint8_t>((i * 7) ^ (i >> 12));
+    }
+    IREE_ASSERT_OK(iree_file_write_contents(
+        path_.c_str(),
+        iree_make_const_byte_span(contents_.data(), contents_.size())));
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), iree_allocator_system(), iree_allocator_system(),
+        &device_allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(device_allocator_);
+    remove(path_.c_str());
+  }
+
+  iree_hal_file_t* OpenFile(iree_io_file_mode_t mode) {
+    iree_io_file_handle_t* handle = NULL;
+    IREE_CHECK_OK(iree_io_file_handle_open(
+        mode, iree_make_cstring_view(path_.c_str()), iree_allocator_system(),
+        &handle));
+    iree_hal_file_t* file = NULL;
+    IREE_CHECK_OK(iree_hal_fd_file_from_handle(
+        IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE, handle,
+        iree_allocator_system(), &file));
+    iree_io_file_handle_release(handle);
+    return file;
+  }
+
+  iree_hal_buffer_t* AllocateBuffer(iree_device_size_t size) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(device_allocator_, params,
+                                                     size, &buffer));
+    return buffer;
+  }
+
+  // Reads |length| bytes at |file_offset| and compares them to the contents.
+  // The buffer is positioned such that the host memory has the same 4096 byte
+  // alignment as the file offset plus |misalignment| bytes.
+  void ExpectRead(iree_hal_file_t* file, uint64_t file_offset,
+                  iree_device_size_t length, size_t misalignment = 0) {
+    iree_hal_buffer_t* buffer = AllocateBuffer(length + 8192);
+    iree_hal_buffer_mapping_t mapping;
+    IREE_ASSERT_OK(iree_hal_buffer_map_range(
+        buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
+        IREE_WHOLE_BUFFER, &mapping));
+    const uintptr_t base_ptr = (uintptr_t)mapping.contents.data;
+    iree_hal_buffer_unmap_range(&mapping);
+    const iree_device_size_t buffer_offset =
+        ((file_offset - base_ptr) & 4095) + misalignment;
+
+    IREE_ASSERT_OK(
+        iree_hal_file_read(file, file_offset, buffer, buffer_offset, length));
+    std::vector<uint8_t> result(length);
+    IREE_ASSERT_OK(iree_hal_buffer_map_read(buffer, buffer_offset,
+                                            result.data(), result.size()));
+    EXPECT_TRUE(std::memcmp(result.data(), contents_.data() + file_offset,
+                            length) == 0);
+    iree_hal_buffer_release(buffer);
+  }
+
+  std::string path_;
+  std::vector<uint8_t> contents_;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+};
+
+TEST_F(FdFileTest, Read) {
+  iree_hal_file_t* file = OpenFile(IREE_IO_FILE_MODE_READ);
+  EXPECT_EQ(iree_hal_file_length(file), kFileSize);
+  ExpectRead(file, 0, kFileSize);
+  ExpectRead(file, 4093, 9 * 1024 * 1024, /*misalignment=*/1);
+  ExpectRead(file, kFileSize - 5, 5);
+  iree_hal_file_release(file);
+}
+
+TEST_F(FdFileTest, ReadOutOfRange) {
+  iree_hal_file_t* file = OpenFile(IREE_IO_FILE_MODE_READ);
+  iree_hal_buffer_t* buffer = AllocateBuffer(16);
+  iree_status_t status = iree_hal_file_read(file, kFileSize - 8, buffer, 0, 16);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_OUT_OF_RANGE, status);
+  iree_status_free(status);
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+TEST_F(FdFileTest, Write) {
+  iree_hal_file_t* file =
+      OpenFile(IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_WRITE);
+  const iree_device_size_t length = 6 * 1024 * 1024 + 3;
+  const uint64_t file_offset = 511;
+  iree_hal_buffer_t* buffer = AllocateBuffer(length);
+  IREE_ASSERT_OK(iree_hal_buffer_map_fill(buffer, 0, length, "\xCD", 1));
+  IREE_ASSERT_OK(iree_hal_file_write(file, file_offset, buffer, 0, length));
+  std::memset(contents_.data() + file_offset, 0xCD, length);
+  ExpectRead(file, 0, kFileSize);
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+// Files only allow the access they were imported with.
+TEST_F(FdFileTest, AccessDenied) {
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_WRITE,
+      iree_make_cstring_view(path_.c_str()), iree_allocator_system(),
+      &handle));
+  iree_hal_buffer_t* buffer = AllocateBuffer(16);
+  iree_hal_file_t* read_file = NULL;
+  IREE_ASSERT_OK(iree_hal_fd_file_from_handle(IREE_HAL_MEMORY_ACCESS_READ,
+                                              handle, iree_allocator_system(),
+                                              &read_file));
+  iree_status_t status = iree_hal_file_write(read_file, 0, buffer, 0, 16);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_PERMISSION_DENIED, status);
+  iree_status_free(status);
+  iree_hal_file_release(read_file);
+  iree_hal_file_t* write_file = NULL;
+  IREE_ASSERT_OK(iree_hal_fd_file_from_handle(IREE_HAL_MEMORY_ACCESS_WRITE,
+                                              handle, iree_allocator_system(),
+                                              &write_file));
+  status = iree_hal_file_read(write_file, 0, buffer, 0, 16);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_PERMISSION_DENIED, status);
+  iree_status_free(status);
+  iree_hal_file_release(write_file);
+  iree_hal_buffer_release(buffer);
+  iree_io_file_handle_release(handle);
+}
+
+// Transfers to/from the same buffer reuse the registration of its memory and
+// transfers of other buffers or ranges replace it.
+TEST_F(FdFileTest, ReuseBuffer) {
+  iree_hal_file_t* file =
+      OpenFile(IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_WRITE);
+  const iree_device_size_t length = 8 * 1024 * 1024 + 5;
+  iree_hal_buffer_t* buffer = AllocateBuffer(kFileSize);
+  for (uint64_t file_offset : {0ull, 1ull, 12345ull, 0ull}) {
+    IREE_ASSERT_OK(iree_hal_file_read(file, file_offset, buffer,
+                                      /*buffer_offset=*/file_offset, length));
+    std::vector<uint8_t> result(length);
+    IREE_ASSERT_OK(iree_hal_buffer_map_read(buffer, file_offset,
+                                            result.data(), result.size()));
+    EXPECT_TRUE(std::memcmp(result.data(), contents_.data() + file_offset,
+                            length) == 0);
+  }
+  IREE_ASSERT_OK(iree_hal_buffer_map_fill(buffer, 0, length, "\xEF", 1));
+  IREE_ASSERT_OK(iree_hal_file_write(file, 0, buffer, 0, length));
+  std::memset(contents_.data(), 0xEF, length);
+  ExpectRead(file, 0, kFileSize);
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+// Direct IO splits transfers into a buffered head/tail and an aligned body.
+TEST_F(FdFileTest, ReadDirect) {
+  iree_io_file_handle_t* handle = NULL;
+  iree_status_t status = iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_DIRECT,
+      iree_make_cstring_view(path_.c_str()), iree_allocator_system(), &handle);
+  if (!iree_status_is_ok(status)) {
+    // Some file systems (tmpfs) do not support O_DIRECT.
+    iree_status_ignore(status);
+    GTEST_SKIP() << "O_DIRECT unsupported";
+  }
+  iree_hal_file_t* file = NULL;
+  IREE_ASSERT_OK(iree_hal_fd_file_from_handle(IREE_HAL_MEMORY_ACCESS_READ,
+                                              handle, iree_allocator_system(),
+                                              &file));
+  iree_io_file_handle_release(handle);
+  ExpectRead(file, 0, kFileSize);
+  ExpectRead(file, 4095, 8 * 1024 * 1024 + 2);
+  ExpectRead(file, 4095, 8 * 1024 * 1024 + 2, /*misalignment=*/1);
+  iree_hal_file_release(file);
+}
+
+}  // namespace
+
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
@@ -7,7 +7,6 @@
 #include "iree/hal/utils/file_transfer.h"
 
 #include "iree/base/internal/math.h"
-#include "iree/hal/utils/memory_file.h"
 
 //===----------------------------------------------------------------------===//
 // Configuration
@@ -17,31 +16,50 @@
 // can prune code paths or flags (somehow).
 
 #if !defined(IREE_HAL_TRANSFER_WORKER_LIMIT)
-// Maximum number of workers that will be used. This is something we can derive
-// from the transfer size and the loop; small transfers or synchronous loops
-// should have 1 and we can measure to see how many others we need.
-#define IREE_HAL_TRANSFER_WORKER_LIMIT 1
+// Maximum number of workers that will be used. Each worker owns one staging
+// chunk and with two or more the host can fill one chunk from the file while
+// the device drains another. Each worker may have one loop operation pending
+// at a time and this must stay under what the inline loop can hold (7).
+#define IREE_HAL_TRANSFER_WORKER_LIMIT 4
 #endif  // !IREE_HAL_TRANSFER_WORKER_LIMIT
 
+#if !defined(IREE_HAL_TRANSFER_MIN_CHUNK_SIZE)
+// Minimum bytes per worker chunk selected by default. Below this the fixed
+// per-chunk costs (file read, queue copy, and loop wait) dominate.
+#define IREE_HAL_TRANSFER_MIN_CHUNK_SIZE (1 * 1024 * 1024)
+#endif  // !IREE_HAL_TRANSFER_MIN_CHUNK_SIZE
+
 #if !defined(IREE_HAL_TRANSFER_CHUNK_SIZE)
-// Bytes per worker to stage chunks of data. Larger chunks will result in less
-// overhead as fewer copy operations are required.
+// Maximum bytes per worker chunk selected by default. Larger chunks will result
+// in less overhead as fewer copy operations are required but increase staging
+// memory consumption and the time to fill/drain the pipeline.
 #define IREE_HAL_TRANSFER_CHUNK_SIZE (64 * 1024 * 1024)
 #endif  // !IREE_HAL_TRANSFER_CHUNK_SIZE
 
+#if !defined(IREE_HAL_TRANSFER_TARGET_CHUNK_COUNT)
+// Number of chunks transfers are split into by default when the resulting
+// chunk size is within the min/max chunk size bounds.
+#define IREE_HAL_TRANSFER_TARGET_CHUNK_COUNT 16
+#endif  // !IREE_HAL_TRANSFER_TARGET_CHUNK_COUNT
+
 #if !defined(IREE_HAL_TRANSFER_CHUNKS_PER_WORKER)
 // Estimated number of chunks each worker should process used to determine how
 // many workers are needed as part of a transfer operation. Larger numbers will
 // reduce memory overhead at the cost of latency reductions.
-#define IREE_HAL_TRANSFER_CHUNKS_PER_WORKER 8
+#define IREE_HAL_TRANSFER_CHUNKS_PER_WORKER 4
 #endif  // IREE_HAL_TRANSFER_CHUNKS_PER_WORKER
 
+#if !defined(IREE_HAL_TRANSFER_STAGING_ALIGNMENT)
+// Minimum alignment of staging chunks. Page alignment allows files opened for
+// direct IO to transfer page-aligned ranges without bouncing through the page
+// cache. Devices requiring larger alignment will have it honored instead.
+#define IREE_HAL_TRANSFER_STAGING_ALIGNMENT 4096
+#endif  // !IREE_HAL_TRANSFER_STAGING_ALIGNMENT
+
 //===----------------------------------------------------------------------===//
 // iree_hal_transfer_operation_t
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): move to utils/ without relying on iree_hal_memory_file_t.
-
 // Maximum number of transfer workers that can be used; common usage should be
 // 1-4 but on very large systems with lots of bandwidth we may be able to
 // use more.
@@ -132,6 +150,8 @@ typedef struct iree_hal_transfer_operation_t {
   // We avoid a subspan buffer here to reduce overheads.
   iree_hal_buffer_t* staging_buffer;
   iree_device_size_t staging_buffer_size;
+  // Alignment of the staging buffer and each worker chunk within it.
+  iree_device_size_t staging_alignment;
 
   // Offset to where the transfer head is in the operation.
   // Ranges from 0 at the start and length at the end.
@@ -152,6 +172,9 @@ typedef struct iree_hal_transfer_operation_t {
   // the final staging buffer dealloca can be asynchronously chained.
   // When writing workers exit after flushing their final chunk to the file.
   iree_hal_transfer_worker_bitmask_t live_workers;
+  // True while workers are being started. The operation will not complete
+  // while set even if all workers started so far have exited.
+  bool is_launching;
 } iree_hal_transfer_operation_t;
 
 static void iree_hal_transfer_operation_release(
@@ -159,6 +182,93 @@ static void iree_hal_transfer_operation_release(
 static void iree_hal_transfer_operation_destroy(
     iree_hal_transfer_operation_t* operation);
 
+// Returns the parameters used to allocate the staging buffer for a transfer in
+// |direction|. Staging buffers get allocated based on the direction we are
+// transferring. This optimizes for access patterns such as sequential writes
+// from the host when staging into the buffer and sequential cached reads from
+// the host when staging out of the buffer.
+static iree_hal_buffer_params_t iree_hal_transfer_staging_buffer_params(
+    iree_hal_transfer_direction_t direction,
+    iree_hal_queue_affinity_t queue_affinity,
+    iree_device_size_t min_alignment) {
+  iree_hal_buffer_params_t params = {
+      .access = IREE_HAL_MEMORY_ACCESS_ALL,
+      .min_alignment = min_alignment,
+      .queue_affinity = queue_affinity,
+  };
+  if (direction == IREE_HAL_TRANSFER_READ_FILE_TO_BUFFER) {
+    params.type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
+                  IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+                   IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED |
+                   IREE_HAL_BUFFER_USAGE_MAPPING_ACCESS_SEQUENTIAL_WRITE;
+  } else {
+    params.type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
+                  IREE_HAL_MEMORY_TYPE_HOST_CACHED |
+                  IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+                   IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED |
+                   IREE_HAL_BUFFER_USAGE_MAPPING_ACCESS_RANDOM;
+  }
+  return params;
+}
+
+// Queries the alignment and maximum size of staging allocations from the first
+// (most preferred) device memory heap usable for staging. Devices that do not
+// report a usable heap get the defaults.
+static void iree_hal_transfer_query_staging_limits(
+    iree_hal_device_t* device, iree_device_size_t* out_alignment,
+    iree_device_size_t* out_max_size) {
+  *out_alignment = IREE_HAL_TRANSFER_STAGING_ALIGNMENT;
+  *out_max_size = IREE_DEVICE_SIZE_MAX;
+  iree_hal_allocator_t* device_allocator = iree_hal_device_allocator(device);
+  if (!device_allocator) return;
+
+  iree_host_size_t heap_count = 0;
+  iree_status_ignore(iree_hal_allocator_query_memory_heaps(
+      device_allocator, 0, NULL, &heap_count));
+  if (heap_count == 0) return;
+  iree_hal_allocator_memory_heap_t* heaps =
+      (iree_hal_allocator_memory_heap_t*)iree_alloca(heap_count *
+                                                     sizeof(heaps[0]));
+  if (!iree_status_is_ok(iree_hal_allocator_query_memory_heaps(
+          device_allocator, heap_count, heaps, &heap_count))) {
+    return;
+  }
+  const iree_hal_memory_type_t required_type =
+      IREE_HAL_MEMORY_TYPE_HOST_VISIBLE | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+  const iree_hal_buffer_usage_t required_usage =
+      IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED;
+  for (iree_host_size_t i = 0; i < heap_count; ++i) {
+    const iree_hal_allocator_memory_heap_t* heap = &heaps[i];
+    if (!iree_all_bits_set(heap->type, required_type) ||
+        !iree_all_bits_set(heap->allowed_usage, required_usage)) {
+      continue;
+    }
+    if (iree_device_size_is_power_of_two(heap->min_alignment)) {
+      *out_alignment = iree_max(*out_alignment, heap->min_alignment);
+    }
+    if (heap->max_allocation_size > 0) {
+      *out_max_size = heap->max_allocation_size;
+    }
+    break;
+  }
+}
+
+// Selects the size of each worker chunk for a transfer of |length| bytes.
+// Small transfers are staged in a single chunk while larger ones are split into
+// roughly IREE_HAL_TRANSFER_TARGET_CHUNK_COUNT chunks (within the min/max chunk
+// size bounds) so that multiple workers can overlap file IO with device copies.
+static iree_device_size_t iree_hal_transfer_select_chunk_size(
+    iree_device_size_t length, iree_device_size_t alignment) {
+  iree_device_size_t chunk_size =
+      iree_device_size_ceil_div(length, IREE_HAL_TRANSFER_TARGET_CHUNK_COUNT);
+  chunk_size = iree_max(chunk_size, IREE_HAL_TRANSFER_MIN_CHUNK_SIZE);
+  chunk_size = iree_min(chunk_size, IREE_HAL_TRANSFER_CHUNK_SIZE);
+  chunk_size = iree_min(chunk_size, length);
+  return iree_device_align(chunk_size, alignment);
+}
+
 static iree_status_t iree_hal_transfer_operation_create(
     iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t signal_semaphore_list,
@@ -174,21 +284,43 @@ static iree_status_t iree_hal_transfer_operation_create(
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(device);
 
   // Determine how many workers are required and their staging reservation.
+  iree_device_size_t staging_alignment = 0;
+  iree_device_size_t staging_max_size = 0;
+  iree_hal_transfer_query_staging_limits(device, &staging_alignment,
+                                         &staging_max_size);
   iree_device_size_t worker_chunk_size = options.chunk_size;
   if (worker_chunk_size == IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT) {
-    worker_chunk_size = iree_min(IREE_HAL_TRANSFER_CHUNK_SIZE, length);
+    worker_chunk_size =
+        iree_hal_transfer_select_chunk_size(length, staging_alignment);
+  } else {
+    worker_chunk_size = iree_device_align(worker_chunk_size, staging_alignment);
+  }
+  if (worker_chunk_size > staging_max_size) {
+    worker_chunk_size = staging_max_size & ~(staging_alignment - 1);
+  }
+  if (worker_chunk_size == 0) {
+    // Zero-length transfers still run a worker to complete the operation.
+    worker_chunk_size = staging_alignment;
   }
   iree_device_size_t total_chunk_count =
       iree_device_size_ceil_div(length, worker_chunk_size);
   iree_host_size_t worker_count = options.chunk_count;
   if (worker_count == IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT) {
-    // Try to give each worker a couple chunks.
+    // Try to give each worker a couple chunks and always double-buffer when
+    // there are multiple chunks so that staging overlaps with device copies.
     worker_count = (iree_host_size_t)iree_device_size_ceil_div(
         total_chunk_count, IREE_HAL_TRANSFER_CHUNKS_PER_WORKER);
+    worker_count = iree_max(worker_count,
+                            (iree_host_size_t)iree_min(total_chunk_count, 2));
   }
   worker_count =
       iree_min(worker_count, iree_min(IREE_HAL_TRANSFER_WORKER_LIMIT,
                                       IREE_HAL_TRANSFER_WORKER_MAX_COUNT));
+  // No more workers than there are chunks or that fit in a staging buffer.
+  worker_count = (iree_host_size_t)iree_min(
+      (iree_device_size_t)worker_count,
+      iree_min(total_chunk_count, staging_max_size / worker_chunk_size));
+  worker_count = iree_max(worker_count, 1);
 
   // Calculate total size of the structure with all its associated data.
   iree_hal_transfer_operation_t* operation = NULL;
@@ -223,6 +355,7 @@ static iree_status_t iree_hal_transfer_operation_create(
   operation->buffer_offset = buffer_offset;
   operation->length = length;
   operation->staging_buffer_size = worker_count * worker_chunk_size;
+  operation->staging_alignment = staging_alignment;
   operation->transfer_head = 0;
   operation->remaining_chunks = (iree_host_size_t)total_chunk_count;
   operation->worker_count = worker_count;
@@ -435,9 +568,9 @@ static iree_status_t iree_hal_transfer_worker_exit(
   iree_host_size_t worker_index =
       (iree_host_size_t)(worker - operation->workers);
   operation->live_workers &= ~(1ull << worker_index);
-  if (operation->live_workers > 0) {
-    // Other workers are still live - this is just one worker exiting by not
-    // rescheduling itself.
+  if (operation->live_workers > 0 || operation->is_launching) {
+    // Other workers are still live (or have yet to be started) - this is just
+    // one worker exiting by not rescheduling itself.
     iree_hal_transfer_operation_release(operation);
     IREE_TRACE_ZONE_END(z0);
     return iree_ok_status();
@@ -492,14 +625,15 @@ static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_offset);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_length);
 
-  // Timeline increments by one.
+  // Timeline increments by one. The worker timepoint is only advanced once the
+  // copy signaling it has been queued so that failures leave it reachable.
   uint64_t wait_timepoint = worker->pending_timepoint;
   iree_hal_semaphore_list_t wait_semaphore_list = {
       .count = 1,
       .semaphores = &worker->semaphore,
       .payload_values = &wait_timepoint,
   };
-  uint64_t signal_timepoint = ++worker->pending_timepoint;
+  uint64_t signal_timepoint = wait_timepoint + 1;
   iree_hal_semaphore_list_t signal_semaphore_list = {
       .count = 1,
       .semaphores = &worker->semaphore,
@@ -525,6 +659,9 @@ static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
         worker->staging_buffer_offset, operation->buffer,
         operation->buffer_offset + transfer_offset, transfer_length);
   }
+  if (iree_status_is_ok(status)) {
+    worker->pending_timepoint = signal_timepoint;
+  }
 
   // Wait for the copy to complete and tick again if we expect there to be more
   // work. If there are no more chunks to copy (or they are spoken for by other
@@ -556,85 +693,6 @@ static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
   return status;
 }
 
-// Begins the transfer operation after |wait_semaphore_list| is satisfied.
-// Note that if this fails then the transfer never started and it's safe to
-// immediately tear down.
-static iree_status_t iree_hal_transfer_operation_launch_read(
-    iree_hal_transfer_operation_t* operation,
-    iree_hal_semaphore_list_t wait_semaphore_list, iree_loop_t loop) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->trace_id);
-  IREE_ASSERT(operation->direction == IREE_HAL_TRANSFER_READ_FILE_TO_BUFFER);
-
-  // Staging buffers get allocated based on the direction we are transferring.
-  // This optimizes for access patterns such as sequential writes from the host
-  // when staging into the buffer and sequential cached reads from the host when
-  // staging out of the buffer.
-  iree_hal_buffer_params_t staging_buffer_params = {
-      .access = IREE_HAL_MEMORY_ACCESS_ALL,
-      // TODO(benvanik): make staging alignment an option/device query?
-      .min_alignment = 64,
-      .queue_affinity = operation->queue_affinity,
-      .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
-              IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
-      .usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
-               IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED |
-               IREE_HAL_BUFFER_USAGE_MAPPING_ACCESS_SEQUENTIAL_WRITE,
-  };
-
-  // Queue the staging buffer allocation.
-  // When it completes we'll do the first host->device copy via mapping.
-  iree_hal_semaphore_list_t alloca_semaphore_list = {
-      .count = operation->worker_count,
-      .semaphores =
-          iree_alloca(sizeof(iree_hal_semaphore_t*) * operation->worker_count),
-      .payload_values = iree_alloca(sizeof(uint64_t) * operation->worker_count),
-  };
-  for (iree_host_size_t i = 0; i < operation->worker_count; ++i) {
-    iree_hal_transfer_worker_t* worker = &operation->workers[i];
-    alloca_semaphore_list.semaphores[i] = worker->semaphore;
-    alloca_semaphore_list.payload_values[i] = ++worker->pending_timepoint;
-  }
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_device_queue_alloca(
-              operation->device, operation->queue_affinity, wait_semaphore_list,
-              alloca_semaphore_list, IREE_HAL_ALLOCATOR_POOL_DEFAULT,
-              staging_buffer_params, operation->staging_buffer_size,
-              &operation->staging_buffer));
-
-  // After the alloca completes each worker will be at the same starting point.
-  // We'll wait on each and start the worker-specific coroutines.
-  iree_status_t status = iree_ok_status();
-  for (iree_host_size_t worker_index = 0;
-       worker_index < operation->worker_count; ++worker_index) {
-    iree_hal_transfer_worker_t* worker = &operation->workers[worker_index];
-    operation->live_workers |= 1ull << worker_index;
-    iree_hal_transfer_operation_retain(operation);
-    status = iree_loop_wait_one(
-        loop,
-        iree_hal_semaphore_await(worker->semaphore, worker->pending_timepoint),
-        iree_infinite_timeout(), iree_hal_transfer_worker_copy_file_to_buffer,
-        worker);
-    if (!iree_status_is_ok(status)) {
-      operation->live_workers &= ~(1ull << worker_index);
-      iree_hal_transfer_operation_release(operation);
-      break;
-    }
-
-    // It's possible that the entire operation completed inline.
-    if (operation->remaining_chunks == 0) break;
-  }
-  if (!iree_status_is_ok(status)) {
-    // Failed to wait on one of the workers. This is a fatal error but we may
-    // have already waited on some workers and need to instead set the sticky
-    // error flag so that when any complete they stop processing.
-    operation->error_status = status;
-  }
-
-  IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();  // return ok as loop is fine but operation is not
-}
-
 static iree_status_t iree_hal_transfer_worker_copy_staging_to_file(
     void* user_data, iree_loop_t loop, iree_status_t status);
 
@@ -665,17 +723,19 @@ static iree_status_t iree_hal_transfer_worker_copy_buffer_to_staging(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_offset);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_length);
 
-  // Timeline increments by one.
+  // Timeline increments by one. The worker timepoint is only advanced once the
+  // copy signaling it has been queued so that failures leave it reachable.
+  uint64_t wait_timepoint = worker->pending_timepoint;
   iree_hal_semaphore_list_t wait_semaphore_list = {
       .count = 1,
       .semaphores = &worker->semaphore,
-      .payload_values = &worker->pending_timepoint,
+      .payload_values = &wait_timepoint,
   };
-  ++worker->pending_timepoint;
+  uint64_t signal_timepoint = wait_timepoint + 1;
   iree_hal_semaphore_list_t signal_semaphore_list = {
       .count = 1,
       .semaphores = &worker->semaphore,
-      .payload_values = &worker->pending_timepoint,
+      .payload_values = &signal_timepoint,
   };
 
   // Track the pending copy operation so we know where to place it in the file.
@@ -691,6 +751,7 @@ static iree_status_t iree_hal_transfer_worker_copy_buffer_to_staging(
 
   // Wait for the copy to complete so we can write it to the file.
   if (iree_status_is_ok(status)) {
+    worker->pending_timepoint = signal_timepoint;
     status = iree_loop_wait_one(
         loop,
         iree_hal_semaphore_await(worker->semaphore, worker->pending_timepoint),
@@ -747,35 +808,96 @@ static iree_status_t iree_hal_transfer_worker_copy_staging_to_file(
                                                          loop);
 }
 
+// Starts all workers of |operation| once the staging buffer alloca has been
+// queued. This runs as a loop callback so that each worker's first step is
+// enqueued on the loop before any of them run: with the inline loop this
+// interleaves the workers such that one fills its staging chunk while the
+// copies of the others are in-flight on the device instead of the first worker
+// running the entire transfer to completion by itself.
+static iree_status_t iree_hal_transfer_operation_start_workers(
+    void* user_data, iree_loop_t loop, iree_status_t status) {
+  iree_hal_transfer_operation_t* operation =
+      (iree_hal_transfer_operation_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->trace_id);
+
+  // After the alloca completes each worker will be at the same starting point.
+  // We'll wait on each and start the worker-specific coroutines. Workers
+  // without a chunk to process are never started.
+  const iree_host_size_t start_count =
+      iree_min(operation->worker_count, operation->remaining_chunks);
+  for (iree_host_size_t worker_index = 0; worker_index < start_count;
+       ++worker_index) {
+    // Stop if the loop or a previously started worker failed. Re-entrant
+    // loops may also have run the started workers far enough that they have
+    // already claimed every chunk.
+    if (!iree_status_is_ok(status) ||
+        !iree_status_is_ok(operation->error_status) ||
+        operation->remaining_chunks == 0) {
+      break;
+    }
+    iree_hal_transfer_worker_t* worker = &operation->workers[worker_index];
+    operation->live_workers |= 1ull << worker_index;
+    iree_hal_transfer_operation_retain(operation);
+    if (operation->direction == IREE_HAL_TRANSFER_READ_FILE_TO_BUFFER) {
+      status = iree_loop_wait_one(
+          loop,
+          iree_hal_semaphore_await(worker->semaphore,
+                                   worker->pending_timepoint),
+          iree_infinite_timeout(),
+          iree_hal_transfer_worker_copy_file_to_buffer, worker);
+      if (!iree_status_is_ok(status)) {
+        operation->live_workers &= ~(1ull << worker_index);
+        iree_hal_transfer_operation_release(operation);
+      }
+    } else {
+      // Issue the initial asynchronous copy from the source buffer to the
+      // worker chunk. This will wait for the alloca to complete so that the
+      // staging buffer is available for use. After the copy completes the
+      // worker will tick itself so long as there are chunks remaining to write.
+      // Failures are handled by the worker exiting itself.
+      status = iree_hal_transfer_worker_copy_buffer_to_staging(operation,
+                                                               worker, loop);
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    // Failed to start one of the workers. This is a fatal error but we may
+    // have already started some workers and need to instead set the sticky
+    // error flag so that when any complete they stop processing.
+    if (iree_status_is_ok(operation->error_status)) {
+      operation->error_status = status;
+    } else {
+      iree_status_ignore(status);
+    }
+  }
+
+  // If every started worker has already exited (or none could be started) then
+  // we are responsible for completing the operation.
+  operation->is_launching = false;
+  if (operation->live_workers == 0) {
+    iree_hal_transfer_operation_notify_completion(operation);
+  }
+  iree_hal_transfer_operation_release(operation);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();  // errors are propagated via semaphores
+}
+
 // Begins the transfer operation after |wait_semaphore_list| is satisfied.
 // Note that if this fails then the transfer never started and it's safe to
 // immediately tear down.
-static iree_status_t iree_hal_transfer_operation_launch_write(
+static iree_status_t iree_hal_transfer_operation_launch(
     iree_hal_transfer_operation_t* operation,
     iree_hal_semaphore_list_t wait_semaphore_list, iree_loop_t loop) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->trace_id);
-  IREE_ASSERT(operation->direction == IREE_HAL_TRANSFER_WRITE_BUFFER_TO_FILE);
-
-  // Staging buffers get allocated based on the direction we are transferring.
-  // This optimizes for access patterns such as sequential writes from the host
-  // when staging into the buffer and sequential cached reads from the host when
-  // staging out of the buffer.
-  iree_hal_buffer_params_t staging_buffer_params = {
-      .access = IREE_HAL_MEMORY_ACCESS_ALL,
-      // TODO(benvanik): make staging alignment an option/device query?
-      .min_alignment = 64,
-      .queue_affinity = operation->queue_affinity,
-      .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
-              IREE_HAL_MEMORY_TYPE_HOST_CACHED |
-              IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
-      .usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
-               IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED |
-               IREE_HAL_BUFFER_USAGE_MAPPING_ACCESS_RANDOM,
-  };
 
-  // Queue the staging buffer allocation.
-  // When it completes we'll signal each worker to start its first transfer.
+  // Queue the staging buffer allocation with each worker's timeline advanced
+  // to a shared starting point signaled when the alloca completes.
+  iree_hal_buffer_params_t staging_buffer_params =
+      iree_hal_transfer_staging_buffer_params(operation->direction,
+                                              operation->queue_affinity,
+                                              operation->staging_alignment);
   iree_hal_semaphore_list_t alloca_semaphore_list = {
       .count = operation->worker_count,
       .semaphores =
@@ -794,35 +916,201 @@ static iree_status_t iree_hal_transfer_operation_launch_write(
               staging_buffer_params, operation->staging_buffer_size,
               &operation->staging_buffer));
 
-  // After the alloca completes each worker will be at the same starting point.
-  // We'll wait on each and start the worker-specific coroutines.
-  iree_status_t status = iree_ok_status();
-  for (iree_host_size_t worker_index = 0;
-       worker_index < operation->worker_count; ++worker_index) {
-    iree_hal_transfer_worker_t* worker = &operation->workers[worker_index];
-    operation->live_workers |= 1ull << worker_index;
-    iree_hal_transfer_operation_retain(operation);
+  // Start the workers from the loop. The loop guarantees the callback is issued
+  // if enqueuing succeeds and it will complete the operation.
+  operation->is_launching = true;
+  iree_hal_transfer_operation_retain(operation);
+  iree_status_t status =
+      iree_loop_call(loop, IREE_LOOP_PRIORITY_DEFAULT,
+                     iree_hal_transfer_operation_start_workers, operation);
+  if (!iree_status_is_ok(status)) {
+    // The staging buffer alloca is queued and must be balanced by the dealloca
+    // issued when completing the operation with the error.
+    operation->is_launching = false;
+    operation->error_status = status;
+    iree_hal_transfer_operation_notify_completion(operation);
+    iree_hal_transfer_operation_release(operation);
+  }
 
-    // Issue the initial asynchronous copy from the source buffer to the worker
-    // chunk. This will wait for the alloca to complete so that the staging
-    // buffer is available for use. After the copy completes the worker will
-    // tick itself so long as there are chunks remaining to write.
-    status = iree_hal_transfer_worker_copy_buffer_to_staging(operation, worker,
-                                                             loop);
-    if (!iree_status_is_ok(status)) break;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();  // return ok as loop is fine but operation is not
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_transfer_direct_operation_t
+//===----------------------------------------------------------------------===//
+
+// Returns true if |buffer| can be mapped into host memory such that files can
+// be read into or written from it directly without staging.
+static bool iree_hal_transfer_buffer_is_host_mappable(
+    iree_hal_buffer_t* buffer) {
+  return iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                           IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+         iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                           IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED);
+}
+
+// A transfer between a file and a host-mappable buffer performed by the host
+// with a single synchronous file read/write once the waits are satisfied.
+// This avoids the staging buffer and device copies entirely and lets the file
+// implementation use whatever bulk IO it has available (such as io_uring).
+typedef struct iree_hal_transfer_direct_operation_t {
+  // Used to allocate this structure.
+  iree_allocator_t host_allocator;
+  // Direction of the operation (read file->buffer or write buffer->file).
+  iree_hal_transfer_direction_t direction;
+  // Retained file resource.
+  iree_hal_file_t* file;
+  // Offset into the file where the operation begins.
+  uint64_t file_offset;
+  // Retained buffer resource.
+  iree_hal_buffer_t* buffer;
+  // Offset into the buffer where the operation begins.
+  iree_device_size_t buffer_offset;
+  // Total length of the operation.
+  iree_device_size_t length;
+  // Original user semaphores to signal at the end of the transfer operation.
+  // Contents are stored at the end of the struct.
+  iree_hal_semaphore_list_t signal_semaphore_list;
+  // Wait sources for the original user wait semaphores.
+  // Contents are stored at the end of the struct.
+  iree_host_size_t wait_source_count;
+  iree_wait_source_t* wait_sources;
+} iree_hal_transfer_direct_operation_t;
 
-    // It's possible that the entire operation completed inline.
-    if (operation->remaining_chunks == 0) break;
+static void iree_hal_transfer_direct_operation_destroy(
+    iree_hal_transfer_direct_operation_t* operation) {
+  for (iree_host_size_t i = 0; i < operation->signal_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_release(operation->signal_semaphore_list.semaphores[i]);
+  }
+  iree_hal_buffer_release(operation->buffer);
+  iree_hal_file_release(operation->file);
+  iree_allocator_free(operation->host_allocator, operation);
+}
+
+// Performs the transfer after all waits have been satisfied (or failed) and
+// signals (or fails) the user semaphores. Consumes the operation.
+static iree_status_t iree_hal_transfer_direct_operation_run(
+    void* user_data, iree_loop_t loop, iree_status_t status) {
+  iree_hal_transfer_direct_operation_t* operation =
+      (iree_hal_transfer_direct_operation_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->length);
+
+  if (iree_status_is_ok(status)) {
+    if (operation->direction == IREE_HAL_TRANSFER_READ_FILE_TO_BUFFER) {
+      status = iree_hal_file_read(operation->file, operation->file_offset,
+                                  operation->buffer, operation->buffer_offset,
+                                  operation->length);
+    } else {
+      status = iree_hal_file_write(operation->file, operation->file_offset,
+                                   operation->buffer, operation->buffer_offset,
+                                   operation->length);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_list_signal(operation->signal_semaphore_list);
   }
   if (!iree_status_is_ok(status)) {
-    // Failed to wait on one of the workers. This is a fatal error but we may
-    // have already waited on some workers and need to instead set the sticky
-    // error flag so that when any complete they stop processing.
-    operation->error_status = status;
+    iree_hal_semaphore_list_fail(operation->signal_semaphore_list, status);
   }
 
+  iree_hal_transfer_direct_operation_destroy(operation);
   IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();  // return ok as loop is fine but operation is not
+  return iree_ok_status();  // errors are propagated via semaphores
+}
+
+// Launches a direct transfer on |loop| that runs once |wait_semaphore_list| is
+// satisfied. If this returns a failure the transfer was not started and the
+// signal semaphores are untouched.
+static iree_status_t iree_hal_transfer_direct_operation_launch(
+    iree_hal_device_t* device,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_transfer_direction_t direction, iree_hal_file_t* file,
+    uint64_t file_offset, iree_hal_buffer_t* buffer,
+    iree_device_size_t buffer_offset, iree_device_size_t length,
+    iree_loop_t loop) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = iree_hal_device_host_allocator(device);
+
+  // Calculate total size of the structure with all its associated data.
+  iree_hal_transfer_direct_operation_t* operation = NULL;
+  iree_host_size_t total_size = sizeof(*operation);
+  iree_host_size_t semaphores_offset =
+      iree_host_align(total_size, iree_max_align_t);
+  total_size = semaphores_offset + sizeof(signal_semaphore_list.semaphores[0]) *
+                                       signal_semaphore_list.count;
+  iree_host_size_t payload_values_offset =
+      iree_host_align(total_size, iree_max_align_t);
+  total_size =
+      payload_values_offset + sizeof(signal_semaphore_list.payload_values[0]) *
+                                  signal_semaphore_list.count;
+  iree_host_size_t wait_sources_offset =
+      iree_host_align(total_size, iree_max_align_t);
+  total_size = wait_sources_offset +
+               sizeof(operation->wait_sources[0]) * wait_semaphore_list.count;
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, total_size, (void**)&operation));
+  operation->host_allocator = host_allocator;
+  operation->direction = direction;
+  operation->file = file;
+  iree_hal_file_retain(file);
+  operation->file_offset = file_offset;
+  operation->buffer = buffer;
+  iree_hal_buffer_retain(buffer);
+  operation->buffer_offset = buffer_offset;
+  operation->length = length;
+
+  // Retain each signal semaphore for ourselves as we don't know if the caller
+  // will hold them for the lifetime of the operation.
+  operation->signal_semaphore_list.count = signal_semaphore_list.count;
+  operation->signal_semaphore_list.semaphores =
+      (iree_hal_semaphore_t**)((uintptr_t)operation + semaphores_offset);
+  operation->signal_semaphore_list.payload_values =
+      (uint64_t*)((uintptr_t)operation + payload_values_offset);
+  memcpy(operation->signal_semaphore_list.semaphores,
+         signal_semaphore_list.semaphores,
+         sizeof(signal_semaphore_list.semaphores[0]) *
+             signal_semaphore_list.count);
+  memcpy(operation->signal_semaphore_list.payload_values,
+         signal_semaphore_list.payload_values,
+         sizeof(signal_semaphore_list.payload_values[0]) *
+             signal_semaphore_list.count);
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    iree_hal_semaphore_retain(signal_semaphore_list.semaphores[i]);
+  }
+
+  // The wait semaphores are only referenced by the wait sources until the
+  // loop wait completes; callers must keep them live as with any queue op.
+  operation->wait_source_count = wait_semaphore_list.count;
+  operation->wait_sources =
+      (iree_wait_source_t*)((uintptr_t)operation + wait_sources_offset);
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    operation->wait_sources[i] =
+        iree_hal_semaphore_await(wait_semaphore_list.semaphores[i],
+                                 wait_semaphore_list.payload_values[i]);
+  }
+
+  // Run the transfer immediately (or as soon as the loop gets to it) when there
+  // is nothing to wait on. The loop guarantees the callback is issued (and the
+  // operation consumed) if enqueuing succeeds.
+  iree_status_t status = iree_ok_status();
+  if (operation->wait_source_count == 0) {
+    status = iree_loop_call(loop, IREE_LOOP_PRIORITY_DEFAULT,
+                            iree_hal_transfer_direct_operation_run, operation);
+  } else {
+    status = iree_loop_wait_all(
+        loop, operation->wait_source_count, operation->wait_sources,
+        iree_infinite_timeout(), iree_hal_transfer_direct_operation_run,
+        operation);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 //===----------------------------------------------------------------------===//
@@ -874,6 +1162,15 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_read_streaming(
         target_offset, length);
   }
 
+  // If the target buffer is host-mappable the file can be read directly into
+  // it without any staging.
+  if (iree_hal_transfer_buffer_is_host_mappable(target_buffer)) {
+    return iree_hal_transfer_direct_operation_launch(
+        device, wait_semaphore_list, signal_semaphore_list,
+        IREE_HAL_TRANSFER_READ_FILE_TO_BUFFER, source_file, source_offset,
+        target_buffer, target_offset, length, options.loop);
+  }
+
   // Allocate full transfer operation.
   iree_hal_transfer_operation_t* operation = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_transfer_operation_create(
@@ -885,7 +1182,7 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_read_streaming(
   // This will queue allocation of the staging buffer and then issue one or more
   // copy commands. The operation will manage its own lifetime and emit errors
   // as part of signal semaphore failures.
-  iree_status_t status = iree_hal_transfer_operation_launch_read(
+  iree_status_t status = iree_hal_transfer_operation_launch(
       operation, wait_semaphore_list, options.loop);
 
   iree_hal_transfer_operation_release(operation);
@@ -901,7 +1198,6 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_write_streaming(
     iree_hal_file_t* target_file, uint64_t target_offset,
     iree_device_size_t length, uint32_t flags,
     iree_hal_file_transfer_options_t options) {
-  // EXPERIMENTAL: assume memory files only today (as that's all we have).
   IREE_RETURN_IF_ERROR(
       iree_hal_file_validate_access(target_file, IREE_HAL_MEMORY_ACCESS_WRITE));
 
@@ -915,6 +1211,15 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_write_streaming(
         (iree_device_size_t)target_offset, length);
   }
 
+  // If the source buffer is host-mappable the file can be written directly
+  // from it without any staging.
+  if (iree_hal_transfer_buffer_is_host_mappable(source_buffer)) {
+    return iree_hal_transfer_direct_operation_launch(
+        device, wait_semaphore_list, signal_semaphore_list,
+        IREE_HAL_TRANSFER_WRITE_BUFFER_TO_FILE, target_file, target_offset,
+        source_buffer, source_offset, length, options.loop);
+  }
+
   // Allocate full transfer operation.
   iree_hal_transfer_operation_t* operation = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_transfer_operation_create(
@@ -926,7 +1231,7 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_write_streaming(
   // This will queue allocation of the staging buffer and then issue one or more
   // copy commands. The operation will manage its own lifetime and emit errors
   // as part of signal semaphore failures.
-  iree_status_t status = iree_hal_transfer_operation_launch_write(
+  iree_status_t status = iree_hal_transfer_operation_launch(
       operation, wait_semaphore_list, options.loop);
 
   iree_hal_transfer_operation_release(operation);
@@ -30,11 +30,12 @@ typedef struct iree_hal_file_transfer_options_t {
   // Setting to >1 will allow for overlapped staging and transfer at the cost
   // of additional staging buffer memory consumption.
   // IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT can be used to have the
-  // implementation select a chunk size based on whether the device can benefit
-  // from overlapping staging.
+  // implementation select a chunk count based on the number of chunks in the
+  // transfer; any transfer with more than one chunk is at least
+  // double-buffered.
   iree_device_size_t chunk_count;
   // Maximum size of chunks in bytes. The size may be adjusted to meet alignment
-  // requirements of the implementation.
+  // requirements of the implementation and the device staging memory.
   // IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT can be used to have the
   // implementation select a chunk size based on the size of the transfer.
   iree_device_size_t chunk_size;
@@ -49,11 +50,14 @@ typedef struct iree_hal_file_transfer_options_t {
 // each chunk and |options.chunk_count| specifies how many chunks will be
 // allocated at once.
 //
+// If |target_buffer| is host-mappable the file is read directly into it by the
+// host once |wait_semaphore_list| is satisfied and no staging is performed.
+//
 // The provided |options.loop| is used for any asynchronous host operations
 // performed as part of the transfer.
 //
-// WARNING: this only works with memory files as created via
-// iree_hal_memory_file_wrap.
+// WARNING: this only works with files implementing the EXPERIMENTAL synchronous
+// file API such as those created via iree_hal_file_from_handle.
 IREE_API_EXPORT iree_status_t iree_hal_device_queue_read_streaming(
     iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -72,11 +76,14 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_read_streaming(
 // each chunk and |options.chunk_count| specifies how many chunks will be
 // allocated at once.
 //
+// If |source_buffer| is host-mappable the file is written directly from it by
+// the host once |wait_semaphore_list| is satisfied and no staging is performed.
+//
 // The provided |options.loop| is used for any asynchronous host operations
 // performed as part of the transfer.
 //
-// WARNING: this only works with memory files as created via
-// iree_hal_memory_file_wrap.
+// WARNING: this only works with files implementing the EXPERIMENTAL synchronous
+// file API such as those created via iree_hal_file_from_handle.
 IREE_API_EXPORT iree_status_t iree_hal_device_queue_write_streaming(
     iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -0,0 +1,278 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures the throughput of staged file reads (file -> host staging buffer ->
+// device-local buffer) as performed by iree_hal_device_queue_read_streaming
+// when the target buffer is not host-mappable.
+//
+// Two staging configurations are compared:
+//   serial: a single worker with one chunk of up to 64MB (the behavior prior
+//           to adaptive chunking) such that file reads and device copies
+//           alternate.
+//   parallel: the default worker count and chunk size selected from the
+//             transfer size and device properties.
+//
+// The local-task heap allocator makes every buffer host-mappable which would
+// route all transfers to the direct (unstaged) path. To emulate a discrete
+// device the target buffers wrap host memory with a device-local memory type
+// and no mapping usage: the transfer code only sees the buffer metadata while
+// the local device is still able to copy into it.
+//
+// Files are sparse temporary files so that the measurement is dominated by the
+// transfer pipeline and not the storage device. Transfers that cannot be
+// allocated on the current machine (such as the 10GB ones) are skipped.
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/hal/utils/file_transfer.h"
+#include "iree/io/file_handle.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
+#include "iree/testing/benchmark.h"
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+
+#include <unistd.h>
+
+//===----------------------------------------------------------------------===//
+// Benchmark setup
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_benchmark_transfer_config_t {
+  const char* name;
+  uint64_t length;
+  bool parallel;
+} iree_benchmark_transfer_config_t;
+
+static const iree_benchmark_transfer_config_t iree_benchmark_configs[] = {
+    {"file_read_staged_serial/1MB", 1ull * 1024 * 1024, false},
+    {"file_read_staged_parallel/1MB", 1ull * 1024 * 1024, true},
+    {"file_read_staged_serial/16MB", 16ull * 1024 * 1024, false},
+    {"file_read_staged_parallel/16MB", 16ull * 1024 * 1024, true},
+    {"file_read_staged_serial/256MB", 256ull * 1024 * 1024, false},
+    {"file_read_staged_parallel/256MB", 256ull * 1024 * 1024, true},
+    {"file_read_staged_serial/1GB", 1ull * 1024 * 1024 * 1024, false},
+    {"file_read_staged_parallel/1GB", 1ull * 1024 * 1024 * 1024, true},
+    {"file_read_staged_serial/10GB", 10ull * 1024 * 1024 * 1024, false},
+    {"file_read_staged_parallel/10GB", 10ull * 1024 * 1024 * 1024, true},
+};
+
+static iree_status_t iree_benchmark_create_device(
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  iree_string_view_t identifier = IREE_SV("local-task");
+  iree_hal_allocator_t* device_allocator = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_create_heap(
+      identifier, host_allocator, host_allocator, &device_allocator));
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(1, &topology);
+  iree_task_executor_t* executor = NULL;
+  iree_status_t status =
+      iree_task_executor_create(options, &topology, host_allocator, &executor);
+  iree_task_topology_deinitialize(&topology);
+  if (iree_status_is_ok(status)) {
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    status = iree_hal_task_device_create(
+        identifier, &params, /*queue_count=*/1, &executor,
+        /*loader_count=*/0, NULL, device_allocator, host_allocator, out_device);
+  }
+  iree_task_executor_release(executor);
+
+  iree_hal_allocator_release(device_allocator);
+  return status;
+}
+
+static void iree_benchmark_file_release(
+    void* user_data, iree_io_file_handle_primitive_t handle_primitive) {
+  close(handle_primitive.value.fd);
+}
+
+// Creates an unlinked sparse temporary file of |length| bytes.
+static iree_status_t iree_benchmark_create_file(
+    uint64_t length, iree_allocator_t host_allocator,
+    iree_io_file_handle_t** out_handle) {
+  const char* tmpdir = getenv("TEST_TMPDIR");
+  if (!tmpdir) tmpdir = getenv("TMPDIR");
+  if (!tmpdir) tmpdir = "/tmp";
+  char path[256];
+  snprintf(path, sizeof(path), "%s/iree_file_transfer_XXXXXX", tmpdir);
+  int fd = mkstemp(path);
+  if (fd == -1) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to create temporary file in '%s'", tmpdir);
+  }
+  unlink(path);
+  if (ftruncate(fd, (off_t)length) == -1) {
+    close(fd);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to size temporary file to %" PRIu64,
+                            length);
+  }
+  iree_io_file_handle_release_callback_t release_callback = {
+      .fn = iree_benchmark_file_release,
+      .user_data = NULL,
+  };
+  iree_status_t status = iree_io_file_handle_wrap_fd(
+      IREE_IO_FILE_ACCESS_READ, fd, release_callback, host_allocator,
+      out_handle);
+  if (!iree_status_is_ok(status)) close(fd);
+  return status;
+}
+
+// user_data is the data allocated from the system allocator.
+static void iree_benchmark_device_buffer_release(void* user_data,
+                                                 iree_hal_buffer_t* buffer) {
+  iree_allocator_free_aligned(iree_allocator_system(), user_data);
+}
+
+// Allocates a |length| byte buffer that is not host-visible or mappable so that
+// transfers into it must be staged.
+static iree_status_t iree_benchmark_allocate_device_buffer(
+    iree_hal_device_t* device, iree_device_size_t length,
+    iree_hal_buffer_t** out_buffer) {
+  void* data = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_aligned(
+      iree_allocator_system(), (iree_host_size_t)length,
+      IREE_HAL_HEAP_BUFFER_ALIGNMENT, 0, &data));
+  iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_benchmark_device_buffer_release,
+      .user_data = data,
+  };
+  iree_status_t status = iree_hal_heap_buffer_wrap(
+      iree_hal_device_allocator(device), IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      IREE_HAL_MEMORY_ACCESS_ALL,
+      IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE,
+      length, iree_make_byte_span(data, (iree_host_size_t)length),
+      release_callback, out_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free_aligned(iree_allocator_system(), data);
+  }
+  return status;
+}
+
+// user_data is the iree_benchmark_transfer_config_t.
+static iree_status_t iree_benchmark_file_read_staged(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  const iree_benchmark_transfer_config_t* config =
+      (const iree_benchmark_transfer_config_t*)benchmark_def->user_data;
+  const iree_device_size_t length = (iree_device_size_t)config->length;
+
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_benchmark_create_device(host_allocator, &device));
+
+  // Device-local buffers without mapping usage force the staged path.
+  iree_hal_buffer_t* target_buffer = NULL;
+  iree_status_t status = iree_benchmark_allocate_device_buffer(
+      device, length, &target_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    iree_hal_device_release(device);
+    iree_benchmark_skip(benchmark_state, "unable to allocate target buffer");
+    return iree_ok_status();
+  }
+
+  iree_io_file_handle_t* handle = NULL;
+  iree_hal_file_t* file = NULL;
+  status = iree_benchmark_create_file(config->length, host_allocator, &handle);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_file_import(device, IREE_HAL_QUEUE_AFFINITY_ANY,
+                                  IREE_HAL_MEMORY_ACCESS_READ, handle,
+                                  IREE_HAL_EXTERNAL_FILE_FLAG_NONE, &file);
+  }
+  iree_hal_semaphore_t* semaphore = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_create(device, 0ull, &semaphore);
+  }
+
+  iree_status_t loop_status = iree_ok_status();
+  iree_hal_file_transfer_options_t options = {
+      .loop = iree_loop_inline(&loop_status),
+      .chunk_count = IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT,
+      .chunk_size = IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT,
+  };
+  if (!config->parallel) {
+    options.chunk_count = 1;
+    options.chunk_size = iree_min(length, 64 * 1024 * 1024);
+  }
+
+  int64_t iteration_count = 0;
+  uint64_t signal_value = 0;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    uint64_t payload_value = ++signal_value;
+    iree_hal_semaphore_list_t signal_semaphore_list = {
+        .count = 1,
+        .semaphores = &semaphore,
+        .payload_values = &payload_value,
+    };
+    status = iree_hal_device_queue_read_streaming(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphore_list, file, /*source_offset=*/0, target_buffer,
+        /*target_offset=*/0, length, /*flags=*/0, options);
+    if (iree_status_is_ok(status)) {
+      status = loop_status;
+      loop_status = iree_ok_status();
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_semaphore_wait(semaphore, payload_value,
+                                       iree_infinite_timeout());
+    }
+    ++iteration_count;
+  }
+  if (iree_status_is_ok(status)) {
+    iree_benchmark_set_bytes_processed(benchmark_state,
+                                       iteration_count * (int64_t)length);
+  }
+
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_file_release(file);
+  iree_io_file_handle_release(handle);
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_device_release(device);
+  return status;
+}
+
+static void iree_benchmark_register_all(void) {
+  iree_benchmark_def_t benchmark_def = {
+      .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+               IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+      .time_unit = IREE_BENCHMARK_UNIT_MILLISECOND,
+      .minimum_duration_ns = 0,
+      .iteration_count = 0,
+      .run = iree_benchmark_file_read_staged,
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(iree_benchmark_configs);
+       ++i) {
+    benchmark_def.user_data = (void*)&iree_benchmark_configs[i];
+    iree_benchmark_register(
+        iree_make_cstring_view(iree_benchmark_configs[i].name), &benchmark_def);
+  }
+}
+
+#else
+
+static void iree_benchmark_register_all(void) {}
+
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+  iree_benchmark_register_all();
+  iree_benchmark_run_specified();
+  return 0;
+}
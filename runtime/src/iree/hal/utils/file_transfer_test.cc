@@ -0,0 +1,345 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/file_transfer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Test file
+//===----------------------------------------------------------------------===//
+
+// An in-memory file that records how it is accessed and can fail on demand.
+// It has no storage buffer so transfers must go through the file read/write
+// calls.
+struct TestFile {
+  iree_hal_resource_t resource;
+  std::vector<uint8_t> contents;
+  // 1-based ordinal of the read/write call that fails or 0 to never fail.
+  int fail_on_access = 0;
+  std::atomic<int> access_count{0};
+  std::atomic<iree_device_size_t> max_access_length{0};
+};
+
+extern const iree_hal_file_vtable_t kTestFileVtable;
+
+TestFile* CastTestFile(iree_hal_file_t* file) {
+  return reinterpret_cast<TestFile*>(file);
+}
+
+iree_status_t TestFileAccess(TestFile* file, iree_device_size_t length) {
+  iree_device_size_t max_length = file->max_access_length.load();
+  while (length > max_length &&
+         !file->max_access_length.compare_exchange_weak(max_length, length)) {
+  }
+  if (++file->access_count == file->fail_on_access) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS, "injected file failure");
+  }
+  return iree_ok_status();
+}
+
+void TestFileDestroy(iree_hal_file_t* file) { delete CastTestFile(file); }
+
+iree_hal_memory_access_t TestFileAllowedAccess(iree_hal_file_t* file) {
+  return IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE;
+}
+
+uint64_t TestFileLength(iree_hal_file_t* file) {
+  return CastTestFile(file)->contents.size();
+}
+
+iree_hal_buffer_t* TestFileStorageBuffer(iree_hal_file_t* file) {
+  return NULL;
+}
+
+iree_status_t TestFileRead(iree_hal_file_t* base_file, uint64_t file_offset,
+                           iree_hal_buffer_t* buffer,
+                           iree_device_size_t buffer_offset,
+                           iree_device_size_t length) {
+  TestFile* file = CastTestFile(base_file);
+  IREE_RETURN_IF_ERROR(TestFileAccess(file, length));
+  return iree_hal_buffer_map_write(
+      buffer, buffer_offset, file->contents.data() + file_offset, length);
+}
+
+iree_status_t TestFileWrite(iree_hal_file_t* base_file, uint64_t file_offset,
+                            iree_hal_buffer_t* buffer,
+                            iree_device_size_t buffer_offset,
+                            iree_device_size_t length) {
+  TestFile* file = CastTestFile(base_file);
+  IREE_RETURN_IF_ERROR(TestFileAccess(file, length));
+  return iree_hal_buffer_map_read(
+      buffer, buffer_offset, file->contents.data() + file_offset, length);
+}
+
+const iree_hal_file_vtable_t kTestFileVtable = {
+    /*.destroy=*/TestFileDestroy,
+    /*.allowed_access=*/TestFileAllowedAccess,
+    /*.length=*/TestFileLength,
+    /*.storage_buffer=*/TestFileStorageBuffer,
+    /*.read=*/TestFileRead,
+    /*.write=*/TestFileWrite,
+};
+
+//===----------------------------------------------------------------------===//
+// Synchronous loop
+//===----------------------------------------------------------------------===//
+
+// A loop that runs every operation immediately on the calling thread, blocking
+// on waits. Unlike the inline loop this re-enters callbacks from within the
+// enqueuing call which lets workers exit while the transfer is still launching.
+iree_status_t SyncLoopCtl(void* self, iree_loop_command_t command,
+                          const void* params, void** inout_ptr) {
+  iree_loop_t loop = {self, SyncLoopCtl};
+  switch (command) {
+    case IREE_LOOP_COMMAND_CALL: {
+      auto* call_params = (const iree_loop_call_params_t*)params;
+      return call_params->callback.fn(call_params->callback.user_data, loop,
+                                      iree_ok_status());
+    }
+    case IREE_LOOP_COMMAND_WAIT_ONE: {
+      auto* wait_params = (const iree_loop_wait_one_params_t*)params;
+      iree_status_t status = iree_wait_source_wait_one(
+          wait_params->wait_source,
+          iree_make_deadline(wait_params->deadline_ns));
+      return wait_params->callback.fn(wait_params->callback.user_data, loop,
+                                      status);
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported loop command");
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Test fixture
+//===----------------------------------------------------------------------===//
+
+void ReleaseDeviceBuffer(void* user_data, iree_hal_buffer_t* buffer) {
+  iree_allocator_free_aligned(iree_allocator_system(), user_data);
+}
+
+class FileTransferTest : public ::testing::Test {
+ protected:
+  // Large enough to be split into many chunks with an odd tail.
+  static constexpr iree_device_size_t kLength = 1 * 1024 * 1024 + 123;
+  static constexpr iree_device_size_t kChunkSize = 64 * 1024;
+  static constexpr iree_device_size_t kChunkCount =
+      (kLength + kChunkSize - 1) / kChunkSize;
+
+  void SetUp() override {
+    iree_allocator_t host_allocator = iree_allocator_system();
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("local-task"), host_allocator, host_allocator,
+        &device_allocator));
+
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(2, &topology);
+    iree_task_executor_t* executor = NULL;
+    IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                             host_allocator, &executor));
+    iree_task_topology_deinitialize(&topology);
+
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_task_device_create(
+        IREE_SV("local-task"), &params, /*queue_count=*/1, &executor,
+        /*loader_count=*/0, NULL, device_allocator, host_allocator, &device_));
+    iree_task_executor_release(executor);
+    iree_hal_allocator_release(device_allocator);
+
+    IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_));
+
+    file_ = new TestFile();
+    iree_hal_resource_initialize(&kTestFileVtable, &file_->resource);
+    file_->contents.resize(kLength);
+    for (size_t i = 0; i < file_->contents.size(); ++i) {
+      file_->contents[i] = static_cast<uint8_t>((i * 7) ^ (i >> 12));
+    }
+  }
+
+  void TearDown() override {
+    iree_hal_file_release(file());
+    iree_hal_buffer_release(buffer_);
+    iree_hal_semaphore_release(semaphore_);
+    iree_hal_device_release(device_);
+  }
+
+  iree_hal_file_t* file() { return reinterpret_cast<iree_hal_file_t*>(file_); }
+
+  // Allocates a buffer that is neither host-visible nor mappable so that
+  // transfers must be staged. Returns the backing storage in |out_data| so the
+  // test can still inspect it.
+  void AllocateDeviceBuffer(uint8_t** out_data) {
+    void* data = NULL;
+    IREE_ASSERT_OK(iree_allocator_malloc_aligned(
+        iree_allocator_system(), kLength, IREE_HAL_HEAP_BUFFER_ALIGNMENT, 0,
+        &data));
+    iree_hal_buffer_release_callback_t release_callback = {
+        ReleaseDeviceBuffer,
+        data,
+    };
+    IREE_ASSERT_OK(iree_hal_heap_buffer_wrap(
+        iree_hal_device_allocator(device_), IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+        IREE_HAL_MEMORY_ACCESS_ALL,
+        IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE,
+        kLength, iree_make_byte_span(data, kLength), release_callback,
+        &buffer_));
+    *out_data = (uint8_t*)data;
+  }
+
+  iree_hal_file_transfer_options_t MakeOptions(iree_loop_t loop) {
+    iree_hal_file_transfer_options_t options;
+    options.loop = loop;
+    options.chunk_count = 4;
+    options.chunk_size = kChunkSize;
+    return options;
+  }
+
+  iree_status_t Read(iree_hal_file_transfer_options_t options) {
+    uint64_t signal_value = 1ull;
+    iree_hal_semaphore_list_t signal_semaphore_list = {
+        1,
+        &semaphore_,
+        &signal_value,
+    };
+    return iree_hal_device_queue_read_streaming(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphore_list, file(), /*source_offset=*/0, buffer_,
+        /*target_offset=*/0, kLength, /*flags=*/0, options);
+  }
+
+  iree_status_t Write(iree_hal_file_transfer_options_t options) {
+    uint64_t signal_value = 1ull;
+    iree_hal_semaphore_list_t signal_semaphore_list = {
+        1,
+        &semaphore_,
+        &signal_value,
+    };
+    return iree_hal_device_queue_write_streaming(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphore_list, buffer_, /*source_offset=*/0, file(),
+        /*target_offset=*/0, kLength, /*flags=*/0, options);
+  }
+
+  // Waits for the transfer to complete and returns the final semaphore value.
+  // Failed transfers signal IREE_HAL_SEMAPHORE_FAILURE_VALUE.
+  uint64_t WaitForCompletion() {
+    iree_status_ignore(
+        iree_hal_semaphore_wait(semaphore_, 1ull, iree_infinite_timeout()));
+    uint64_t value = 0ull;
+    iree_status_ignore(iree_hal_semaphore_query(semaphore_, &value));
+    return value;
+  }
+
+  // Checks that the transfer was split into staged chunks by multiple workers.
+  void ExpectStaged() {
+    EXPECT_EQ(file_->access_count.load(), (int)kChunkCount);
+    EXPECT_LE(file_->max_access_length.load(), kChunkSize);
+  }
+
+  iree_hal_device_t* device_ = NULL;
+  iree_hal_semaphore_t* semaphore_ = NULL;
+  TestFile* file_ = NULL;
+  iree_hal_buffer_t* buffer_ = NULL;
+};
+
+TEST_F(FileTransferTest, ReadStagedInline) {
+  uint8_t* data = NULL;
+  AllocateDeviceBuffer(&data);
+  iree_status_t loop_status = iree_ok_status();
+  IREE_ASSERT_OK(Read(MakeOptions(iree_loop_inline(&loop_status))));
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_EQ(WaitForCompletion(), 1ull);
+  ExpectStaged();
+  EXPECT_EQ(0, memcmp(data, file_->contents.data(), kLength));
+}
+
+TEST_F(FileTransferTest, ReadStagedReentrant) {
+  // Workers run to completion while later workers are still being started.
+  uint8_t* data = NULL;
+  AllocateDeviceBuffer(&data);
+  IREE_ASSERT_OK(Read(MakeOptions(iree_loop_t{NULL, SyncLoopCtl})));
+  EXPECT_EQ(WaitForCompletion(), 1ull);
+  ExpectStaged();
+  EXPECT_EQ(0, memcmp(data, file_->contents.data(), kLength));
+}
+
+TEST_F(FileTransferTest, WriteStagedInline) {
+  uint8_t* data = NULL;
+  AllocateDeviceBuffer(&data);
+  for (iree_device_size_t i = 0; i < kLength; ++i) {
+    data[i] = static_cast<uint8_t>(i * 13);
+  }
+  iree_status_t loop_status = iree_ok_status();
+  IREE_ASSERT_OK(Write(MakeOptions(iree_loop_inline(&loop_status))));
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_EQ(WaitForCompletion(), 1ull);
+  ExpectStaged();
+  EXPECT_EQ(0, memcmp(data, file_->contents.data(), kLength));
+}
+
+TEST_F(FileTransferTest, WriteStagedReentrant) {
+  uint8_t* data = NULL;
+  AllocateDeviceBuffer(&data);
+  for (iree_device_size_t i = 0; i < kLength; ++i) {
+    data[i] = static_cast<uint8_t>(i * 13);
+  }
+  IREE_ASSERT_OK(Write(MakeOptions(iree_loop_t{NULL, SyncLoopCtl})));
+  EXPECT_EQ(WaitForCompletion(), 1ull);
+  ExpectStaged();
+  EXPECT_EQ(0, memcmp(data, file_->contents.data(), kLength));
+}
+
+TEST_F(FileTransferTest, ReadFailsMidTransfer) {
+  uint8_t* data = NULL;
+  AllocateDeviceBuffer(&data);
+  file_->fail_on_access = 3;
+  iree_status_t loop_status = iree_ok_status();
+  IREE_ASSERT_OK(Read(MakeOptions(iree_loop_inline(&loop_status))));
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_EQ(WaitForCompletion(), IREE_HAL_SEMAPHORE_FAILURE_VALUE);
+  // Workers stop picking up chunks once the failure is observed.
+  EXPECT_LT(file_->access_count.load(), (int)kChunkCount);
+}
+
+TEST_F(FileTransferTest, ReadFailsWhileLaunching) {
+  // The first worker fails before the second one is started: the launch must
+  // stop starting workers and complete the operation itself.
+  uint8_t* data = NULL;
+  AllocateDeviceBuffer(&data);
+  file_->fail_on_access = 1;
+  IREE_ASSERT_OK(Read(MakeOptions(iree_loop_t{NULL, SyncLoopCtl})));
+  EXPECT_EQ(WaitForCompletion(), IREE_HAL_SEMAPHORE_FAILURE_VALUE);
+  EXPECT_EQ(file_->access_count.load(), 1);
+}
+
+TEST_F(FileTransferTest, WriteFailsWhileLaunching) {
+  uint8_t* data = NULL;
+  AllocateDeviceBuffer(&data);
+  file_->fail_on_access = 1;
+  IREE_ASSERT_OK(Write(MakeOptions(iree_loop_t{NULL, SyncLoopCtl})));
+  EXPECT_EQ(WaitForCompletion(), IREE_HAL_SEMAPHORE_FAILURE_VALUE);
+  EXPECT_EQ(file_->access_count.load(), 1);
+}
+
+}  // namespace
@@ -4,10 +4,28 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+// NOTE: must be first before _any_ system includes (for O_DIRECT).
+#define _GNU_SOURCE
+
 #include "iree/io/file_handle.h"
 
 #include "iree/base/internal/atomics.h"
 #include "iree/io/memory_stream.h"
+#include "iree/io/stdio_stream.h"
+
+// File descriptors are supported on platforms providing pread/pwrite.
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+#define IREE_IO_FILE_HANDLE_HAVE_FD 1
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define IREE_IO_FILE_HANDLE_HAVE_FD 0
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
 
 //===----------------------------------------------------------------------===//
 // iree_io_file_handle_t
@@ -60,6 +78,95 @@ IREE_API_EXPORT iree_status_t iree_io_file_handle_wrap_host_allocation(
                                   release_callback, host_allocator, out_handle);
 }
 
+IREE_API_EXPORT iree_status_t iree_io_file_handle_wrap_fd(
+    iree_io_file_access_t allowed_access, int fd,
+    iree_io_file_handle_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle) {
+  iree_io_file_handle_primitive_t handle_primitive = {
+      .type = IREE_IO_FILE_HANDLE_TYPE_FD,
+      .value =
+          {
+              .fd = fd,
+          },
+  };
+  return iree_io_file_handle_wrap(allowed_access, handle_primitive,
+                                  release_callback, host_allocator, out_handle);
+}
+
+#if IREE_IO_FILE_HANDLE_HAVE_FD
+
+// Closes the file descriptor owned by a handle opened with
+// iree_io_file_handle_open.
+static void iree_io_file_handle_fd_close(
+    void* user_data, iree_io_file_handle_primitive_t handle_primitive) {
+  close(handle_primitive.value.fd);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_file_handle_open(
+    iree_io_file_mode_t mode, iree_string_view_t path,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle) {
+  IREE_ASSERT_ARGUMENT(out_handle);
+  *out_handle = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
+
+  iree_io_file_access_t allowed_access = 0;
+  int flags = O_CLOEXEC;
+  if (iree_all_bits_set(mode,
+                        IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_WRITE)) {
+    allowed_access = IREE_IO_FILE_ACCESS_READ | IREE_IO_FILE_ACCESS_WRITE;
+    flags |= O_RDWR;
+  } else if (iree_all_bits_set(mode, IREE_IO_FILE_MODE_WRITE)) {
+    allowed_access = IREE_IO_FILE_ACCESS_WRITE;
+    flags |= O_WRONLY;
+  } else {
+    allowed_access = IREE_IO_FILE_ACCESS_READ;
+    flags |= O_RDONLY;
+  }
+#if defined(O_DIRECT)
+  if (iree_all_bits_set(mode, IREE_IO_FILE_MODE_DIRECT)) {
+    flags |= O_DIRECT;
+  }
+#endif  // O_DIRECT
+
+  char* open_path = (char*)iree_alloca(path.size + 1);
+  memcpy(open_path, path.data, path.size);
+  open_path[path.size] = 0;  // NUL
+
+  int fd = open(open_path, flags);
+  if (fd == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to open file `%.*s` (%d: %s)",
+                            (int)path.size, path.data, errno, strerror(errno));
+  }
+
+  iree_io_file_handle_release_callback_t release_callback = {
+      .fn = iree_io_file_handle_fd_close,
+      .user_data = NULL,
+  };
+  iree_status_t status = iree_io_file_handle_wrap_fd(
+      allowed_access, fd, release_callback, host_allocator, out_handle);
+  if (!iree_status_is_ok(status)) close(fd);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+IREE_API_EXPORT iree_status_t iree_io_file_handle_open(
+    iree_io_file_mode_t mode, iree_string_view_t path,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle) {
+  IREE_ASSERT_ARGUMENT(out_handle);
+  *out_handle = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file descriptor-backed file handles are not "
+                          "available on this platform");
+}
+
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
+
 static void iree_io_file_handle_destroy(iree_io_file_handle_t* handle) {
   IREE_ASSERT_ARGUMENT(handle);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -101,6 +208,36 @@ iree_io_file_handle_primitive(const iree_io_file_handle_t* handle) {
   return handle->primitive;
 }
 
+IREE_API_EXPORT iree_status_t iree_io_file_handle_query_length(
+    iree_io_file_handle_t* handle, uint64_t* out_length) {
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(out_length);
+  *out_length = 0;
+  switch (handle->primitive.type) {
+    case IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION: {
+      *out_length = handle->primitive.value.host_allocation.data_length;
+      return iree_ok_status();
+    }
+#if IREE_IO_FILE_HANDLE_HAVE_FD
+    case IREE_IO_FILE_HANDLE_TYPE_FD: {
+      struct stat fd_stat;
+      if (fstat(handle->primitive.value.fd, &fd_stat) == -1) {
+        return iree_make_status(iree_status_code_from_errno(errno),
+                                "unable to stat file (%d: %s)", errno,
+                                strerror(errno));
+      }
+      *out_length = (uint64_t)fd_stat.st_size;
+      return iree_ok_status();
+    }
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
+    default: {
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "length query not supported on handle type %d",
+                              (int)handle->primitive.type);
+    }
+  }
+}
+
 IREE_API_EXPORT iree_status_t
 iree_io_file_handle_flush(iree_io_file_handle_t* handle) {
   IREE_ASSERT_ARGUMENT(handle);
@@ -111,6 +248,16 @@ iree_io_file_handle_flush(iree_io_file_handle_t* handle) {
       // No-op (though we could flush when known mapped).
       break;
     }
+#if IREE_IO_FILE_HANDLE_HAVE_FD
+    case IREE_IO_FILE_HANDLE_TYPE_FD: {
+      if (fsync(handle->primitive.value.fd) == -1) {
+        status = iree_make_status(iree_status_code_from_errno(errno),
+                                  "unable to flush file (%d: %s)", errno,
+                                  strerror(errno));
+      }
+      break;
+    }
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
     default: {
       status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                                 "flush not supported on handle type %d",
@@ -132,6 +279,36 @@ static void iree_io_memory_stream_file_release(void* user_data,
   iree_io_file_handle_release(file_handle);
 }
 
+#if IREE_IO_FILE_HANDLE_HAVE_FD
+
+// Opens a new descriptor on the same file as |fd| for use by a stream.
+//
+// Streams need their own open file description: descriptors from dup() share
+// their file position with the original and all other duplicates (so
+// concurrent streams would corrupt each other) and inherit O_DIRECT (which
+// would require every buffered stdio read and write to be aligned). Platforms
+// that can't reopen descriptors fall back to dup() and the stream position is
+// shared with other streams opened on the same handle.
+static int iree_io_file_handle_reopen_fd(int fd) {
+  const int fd_flags = fcntl(fd, F_GETFL);
+  if (fd_flags == -1) return -1;
+  const int open_flags = (fd_flags & O_ACCMODE) | O_CLOEXEC;
+#if defined(IREE_PLATFORM_APPLE)
+  char fd_path[PATH_MAX];
+  if (fcntl(fd, F_GETPATH, fd_path) == -1) return -1;
+  return open(fd_path, open_flags);
+#elif defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_ANDROID)
+  char fd_path[64];
+  snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", fd);
+  return open(fd_path, open_flags);
+#else
+  (void)open_flags;
+  return dup(fd);
+#endif  // IREE_PLATFORM_*
+}
+
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
+
 IREE_API_EXPORT iree_status_t iree_io_stream_open(
     iree_io_stream_mode_t mode, iree_io_file_handle_t* file_handle,
     uint64_t file_offset, iree_allocator_t host_allocator,
@@ -169,6 +346,37 @@ IREE_API_EXPORT iree_status_t iree_io_stream_open(
       if (!iree_status_is_ok(status)) iree_io_file_handle_release(file_handle);
       break;
     }
+#if IREE_IO_FILE_HANDLE_HAVE_FD
+    case IREE_IO_FILE_HANDLE_TYPE_FD: {
+      // The stream gets its own descriptor so that its position does not
+      // interfere with any other users of the handle.
+      const char* fdopen_mode =
+          iree_all_bits_set(mode, IREE_IO_STREAM_MODE_WRITABLE)
+              ? (iree_all_bits_set(mode, IREE_IO_STREAM_MODE_READABLE) ? "r+b"
+                                                                       : "wb")
+              : "rb";
+      int stream_fd = iree_io_file_handle_reopen_fd(file_primitive.value.fd);
+      FILE* stream_file = stream_fd != -1 ? fdopen(stream_fd, fdopen_mode)
+                                          : NULL;
+      if (!stream_file) {
+        status = iree_make_status(iree_status_code_from_errno(errno),
+                                  "unable to open stream on file (%d: %s)",
+                                  errno, strerror(errno));
+        if (stream_fd != -1) close(stream_fd);
+        break;
+      }
+      status = iree_io_stdio_stream_wrap(
+          mode | IREE_IO_STREAM_MODE_SEEKABLE, stream_file,
+          /*owns_handle=*/true, host_allocator, &stream);
+      if (iree_status_is_ok(status)) {
+        status = iree_io_stream_seek(stream, IREE_IO_STREAM_SEEK_SET,
+                                     (iree_io_stream_pos_t)file_offset);
+      } else {
+        fclose(stream_file);
+      }
+      break;
+    }
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
     default: {
       status =
           iree_make_status(IREE_STATUS_UNIMPLEMENTED,
@@ -46,7 +46,14 @@ typedef enum iree_io_file_handle_type_e {
   // as long as the file handle referencing it.
   IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION = 0u,
 
-  // TODO(benvanik): file descriptor, FILE*, HANDLE, etc.
+  // A POSIX file descriptor supporting positional reads and writes
+  // (pread/pwrite). The descriptor may have been opened with O_DIRECT in which
+  // case implementations must respect the platform alignment requirements.
+  // The handle creator is responsible for ensuring the descriptor remains open
+  // for as long as the file handle referencing it.
+  IREE_IO_FILE_HANDLE_TYPE_FD = 1u,
+
+  // TODO(benvanik): FILE*, HANDLE, etc.
 } iree_io_file_handle_type_t;
 
 // A platform handle to a file primitive.
@@ -55,6 +62,8 @@ typedef enum iree_io_file_handle_type_e {
 typedef union iree_io_file_handle_primitive_value_t {
   // IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION
   iree_byte_span_t host_allocation;
+  // IREE_IO_FILE_HANDLE_TYPE_FD
+  int fd;
 } iree_io_file_handle_primitive_value_t;
 
 // A (type, value) pair describing a system file primitive handle.
@@ -112,6 +121,37 @@ IREE_API_EXPORT iree_status_t iree_io_file_handle_wrap_host_allocation(
     iree_io_file_handle_release_callback_t release_callback,
     iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle);
 
+// Wraps a file descriptor |fd| in a reference-counted file handle.
+// |allowed_access| declares which operations are allowed on the handle and may
+// be more restrictive than the mode the descriptor was opened with.
+// The optional provided |release_callback| will be issued when the last
+// reference to the handle is released and can be used to close the descriptor.
+IREE_API_EXPORT iree_status_t iree_io_file_handle_wrap_fd(
+    iree_io_file_access_t allowed_access, int fd,
+    iree_io_file_handle_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle);
+
+// Bits controlling how a file is opened with iree_io_file_handle_open.
+enum iree_io_file_mode_bits_t {
+  // Opens the file for reading.
+  IREE_IO_FILE_MODE_READ = 1u << 0,
+  // Opens the file for writing. The file must already exist.
+  IREE_IO_FILE_MODE_WRITE = 1u << 1,
+  // Bypasses the platform page cache (O_DIRECT) when supported. Bulk transfers
+  // of aligned ranges will avoid an extra copy through kernel memory and not
+  // pollute the page cache. Ignored on platforms without support.
+  IREE_IO_FILE_MODE_DIRECT = 1u << 2,
+};
+typedef uint32_t iree_io_file_mode_t;
+
+// Opens the file at |path| as a file descriptor-backed file handle.
+// The descriptor is owned by the handle and closed when the last reference is
+// released. Fails with IREE_STATUS_UNAVAILABLE on platforms without file
+// descriptor support.
+IREE_API_EXPORT iree_status_t iree_io_file_handle_open(
+    iree_io_file_mode_t mode, iree_string_view_t path,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle);
+
 // Retains the file |handle| for the caller.
 IREE_API_EXPORT void iree_io_file_handle_retain(iree_io_file_handle_t* handle);
 
@@ -147,6 +187,10 @@ static inline iree_io_file_handle_primitive_value_t iree_io_file_handle_value(
   return iree_io_file_handle_primitive(handle).value;
 }
 
+// Queries the total length of the file |handle| in bytes.
+IREE_API_EXPORT iree_status_t iree_io_file_handle_query_length(
+    iree_io_file_handle_t* handle, uint64_t* out_length);
+
 // Flushes pending writes of |handle| to its backing storage.
 IREE_API_EXPORT iree_status_t
 iree_io_file_handle_flush(iree_io_file_handle_t* handle);
@@ -160,6 +204,8 @@ iree_io_file_handle_flush(iree_io_file_handle_t* handle);
 
 // Opens a stream from the given |file_handle| at the absolute |file_offset|.
 // The returned stream will retain the file until it is released.
+// Streams over host allocations treat |file_offset| as position 0 while streams
+// over file descriptors are positioned at |file_offset| within the whole file.
 IREE_API_EXPORT iree_status_t iree_io_stream_open(
     iree_io_stream_mode_t mode, iree_io_file_handle_t* file_handle,
     uint64_t file_offset, iree_allocator_t host_allocator,
@@ -0,0 +1,111 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/file_handle.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+
+class FileHandleStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const char* tmpdir = getenv("TEST_TMPDIR");
+    if (!tmpdir) tmpdir = getenv("TMPDIR");
+    if (!tmpdir) tmpdir = "/tmp";
+    std::random_device d;
+    path_ = std::string(tmpdir) + "/iree_file_handle_test_" +
+            std::to_string(d()) + ".bin";
+    contents_.resize(64 * 1024);
+    for (size_t i = 0; i < contents_.size(); ++i) {
+      contents_[i] = static_cast<uint8_t>(i * 7 + i / 256);
+    }
+    IREE_ASSERT_OK(iree_file_write_contents(
+        path_.c_str(),
+        iree_make_const_byte_span(contents_.data(), contents_.size())));
+  }
+
+  void TearDown() override { remove(path_.c_str()); }
+
+  // Reads |length| bytes from |stream| and expects them to match the file
+  // contents at |offset|.
+  void ExpectRead(iree_io_stream_t* stream, size_t offset, size_t length) {
+    std::vector<uint8_t> buffer(length);
+    iree_host_size_t read_length = 0;
+    IREE_ASSERT_OK(
+        iree_io_stream_read(stream, length, buffer.data(), &read_length));
+    ASSERT_EQ(read_length, length);
+    EXPECT_EQ(0, memcmp(buffer.data(), contents_.data() + offset, length));
+  }
+
+  std::string path_;
+  std::vector<uint8_t> contents_;
+};
+
+// Streams opened on the same handle each track their own position.
+TEST_F(FileHandleStreamTest, IndependentPositions) {
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ, iree_make_string_view(path_.data(), path_.size()),
+      iree_allocator_system(), &handle));
+  iree_io_stream_t* stream0 = NULL;
+  IREE_ASSERT_OK(iree_io_stream_open(IREE_IO_STREAM_MODE_READABLE, handle,
+                                     /*file_offset=*/0, iree_allocator_system(),
+                                     &stream0));
+  iree_io_stream_t* stream1 = NULL;
+  IREE_ASSERT_OK(iree_io_stream_open(IREE_IO_STREAM_MODE_READABLE, handle,
+                                     /*file_offset=*/100,
+                                     iree_allocator_system(), &stream1));
+
+  // Reads are larger than the stdio buffer to force them to the descriptor.
+  ExpectRead(stream0, 0, 13);
+  ExpectRead(stream1, 100, 20000);
+  ExpectRead(stream0, 13, 20000);
+  ExpectRead(stream1, 20100, 7);
+  EXPECT_EQ(iree_io_stream_offset(stream0), 20013);
+  EXPECT_EQ(iree_io_stream_offset(stream1), 20107);
+
+  iree_io_stream_release(stream1);
+  iree_io_stream_release(stream0);
+  iree_io_file_handle_release(handle);
+}
+
+// Streams on handles opened for direct I/O support unaligned access.
+TEST_F(FileHandleStreamTest, UnalignedDirectAccess) {
+  iree_io_file_handle_t* handle = NULL;
+  iree_status_t status = iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_DIRECT,
+      iree_make_string_view(path_.data(), path_.size()),
+      iree_allocator_system(), &handle);
+  if (!iree_status_is_ok(status)) {
+    // Not all file systems support direct I/O.
+    iree_status_ignore(status);
+    GTEST_SKIP() << "direct I/O unsupported";
+  }
+  iree_io_stream_t* stream = NULL;
+  IREE_ASSERT_OK(iree_io_stream_open(IREE_IO_STREAM_MODE_READABLE, handle,
+                                     /*file_offset=*/3, iree_allocator_system(),
+                                     &stream));
+  ExpectRead(stream, 3, 5);
+  ExpectRead(stream, 8, 10001);
+  iree_io_stream_release(stream);
+  iree_io_file_handle_release(handle);
+}
+
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+
+}  // namespace
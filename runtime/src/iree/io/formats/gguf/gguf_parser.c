@@ -8,6 +8,8 @@
 
 #include <ctype.h>
 
+#include "iree/io/stream.h"
+
 // File format:
 // https://github.com/ggerganov/ggml/blob/master/docs/gguf.md
 //
@@ -427,64 +429,102 @@ static iree_status_t iree_io_gguf_calculate_storage_size(
   return iree_ok_status();
 }
 
-static iree_status_t iree_io_gguf_parse_value(iree_const_byte_span_t* contents,
+// Cursor over the in-memory contents of a file. The contents may be only a
+// prefix of the file when parsing from a stream; reads that run past the end of
+// the contents are then distinguished from reads that run past the end of the
+// file so that callers can tell a short prefix from a corrupt length.
+typedef struct iree_io_gguf_reader_t {
+  // File offset 0 in memory.
+  const uint8_t* origin;
+  // Remaining in-memory contents starting at the current read position.
+  iree_const_byte_span_t contents;
+  // Total length of the file in bytes, including any portion not in memory.
+  uint64_t file_length;
+  // Set to the file length required to complete a read that ran past the end
+  // of |contents| but not past the end of the file. Left unchanged otherwise.
+  uint64_t* required_length;
+} iree_io_gguf_reader_t;
+
+// Ensures |length| bytes are available at the current read position.
+static iree_status_t iree_io_gguf_reader_require(iree_io_gguf_reader_t* reader,
+                                                 uint64_t length) {
+  if (reader->contents.data_length >= length) return iree_ok_status();
+  const uint64_t offset = (uint64_t)(reader->contents.data - reader->origin);
+  if (length > reader->file_length - offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "declared length of %" PRIu64
+                            " bytes at offset %" PRIu64
+                            " extends past the end of the %" PRIu64
+                            " byte file",
+                            length, offset, reader->file_length);
+  }
+  *reader->required_length = offset + length;
+  return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                          "file buffer underrun parsing %" PRIu64
+                          " bytes at offset %" PRIu64,
+                          length, offset);
+}
+
+static void iree_io_gguf_reader_advance(iree_io_gguf_reader_t* reader,
+                                        iree_host_size_t length) {
+  reader->contents.data += length;
+  reader->contents.data_length -= length;
+}
+
+static iree_status_t iree_io_gguf_parse_value(iree_io_gguf_reader_t* reader,
                                               iree_host_size_t length,
                                               void* out_value) {
-  if (contents->data_length < length) {
-    return iree_make_status(
-        IREE_STATUS_OUT_OF_RANGE,
-        "file buffer underrun parsing %" PRIhsz " byte value", length);
-  }
-  memcpy(out_value, contents->data, length);
-  contents->data += length;
-  contents->data_length -= length;
+  IREE_RETURN_IF_ERROR(iree_io_gguf_reader_require(reader, length));
+  memcpy(out_value, reader->contents.data, length);
+  iree_io_gguf_reader_advance(reader, length);
   return iree_ok_status();
 }
-static iree_status_t iree_io_gguf_parse_uint32(iree_const_byte_span_t* contents,
+static iree_status_t iree_io_gguf_parse_uint32(iree_io_gguf_reader_t* reader,
                                                uint32_t* out_value) {
-  return iree_io_gguf_parse_value(contents, sizeof(*out_value), out_value);
+  return iree_io_gguf_parse_value(reader, sizeof(*out_value), out_value);
 }
-static iree_status_t iree_io_gguf_parse_uint64(iree_const_byte_span_t* contents,
+static iree_status_t iree_io_gguf_parse_uint64(iree_io_gguf_reader_t* reader,
                                                uint64_t* out_value) {
-  return iree_io_gguf_parse_value(contents, sizeof(*out_value), out_value);
+  return iree_io_gguf_parse_value(reader, sizeof(*out_value), out_value);
 }
 
-static iree_status_t iree_io_gguf_parse_array(iree_const_byte_span_t* contents,
+static iree_status_t iree_io_gguf_parse_array(iree_io_gguf_reader_t* reader,
                                               uint64_t element_count,
                                               uint64_t element_size,
                                               const uint8_t** out_base_ptr) {
+  if (element_size && element_count > UINT64_MAX / element_size) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "array of %" PRIu64 " elements overflows",
+                            element_count);
+  }
   uint64_t total_length = element_count * element_size;
+  IREE_RETURN_IF_ERROR(iree_io_gguf_reader_require(reader, total_length));
   if (total_length > IREE_HOST_SIZE_MAX) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "attempting to load a 64-bit file on a 32-bit arch "
                             "(out of bounds array length)");
   }
-  if (contents->data_length < (iree_host_size_t)total_length) {
-    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
-                            "file buffer underrun parsing array");
-  }
-  *out_base_ptr = contents->data;
-  contents->data += (iree_host_size_t)total_length;
-  contents->data_length -= (iree_host_size_t)total_length;
+  *out_base_ptr = reader->contents.data;
+  iree_io_gguf_reader_advance(reader, (iree_host_size_t)total_length);
   return iree_ok_status();
 }
 
-static iree_status_t iree_io_gguf_parse_string(iree_const_byte_span_t* contents,
+static iree_status_t iree_io_gguf_parse_string(iree_io_gguf_reader_t* reader,
                                                iree_string_view_t* out_value) {
   uint64_t length = 0;
-  IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint64(contents, &length));
+  IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint64(reader, &length));
   if (length > IREE_HOST_SIZE_MAX) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "attempting to load a 64-bit file on a 32-bit arch "
                             "(out of bounds string length)");
   }
   out_value->size = (iree_host_size_t)length;
-  return iree_io_gguf_parse_array(contents, length, sizeof(char),
+  return iree_io_gguf_parse_array(reader, length, sizeof(char),
                                   (const uint8_t**)&out_value->data);
 }
 
 static iree_status_t iree_io_gguf_skip_metadata_array(
-    iree_const_byte_span_t* contents, gguf_metadata_value_type_t value_type,
+    iree_io_gguf_reader_t* reader, gguf_metadata_value_type_t value_type,
     uint64_t count) {
   switch (value_type) {
     default:
@@ -503,12 +543,12 @@ static iree_status_t iree_io_gguf_skip_metadata_array(
     case GGUF_METADATA_VALUE_TYPE_FLOAT64: {
       const uint8_t* values = NULL;
       return iree_io_gguf_parse_array(
-          contents, count, gguf_metadata_value_type_sizes[value_type], &values);
+          reader, count, gguf_metadata_value_type_sizes[value_type], &values);
     }
     case GGUF_METADATA_VALUE_TYPE_STRING: {
       iree_string_view_t value = iree_string_view_empty();
       for (uint64_t i = 0; i < count; ++i) {
-        IREE_RETURN_IF_ERROR(iree_io_gguf_parse_string(contents, &value));
+        IREE_RETURN_IF_ERROR(iree_io_gguf_parse_string(reader, &value));
       }
       return iree_ok_status();
     }
@@ -519,7 +559,7 @@ static iree_status_t iree_io_gguf_skip_metadata_array(
 }
 
 static iree_status_t iree_io_gguf_parse_metadata_value(
-    iree_const_byte_span_t* contents, gguf_metadata_value_type_t value_type,
+    iree_io_gguf_reader_t* reader, gguf_metadata_value_type_t value_type,
     gguf_metadata_value_t* out_value) {
   switch (value_type) {
     default:
@@ -537,19 +577,19 @@ static iree_status_t iree_io_gguf_parse_metadata_value(
     case GGUF_METADATA_VALUE_TYPE_INT64:
     case GGUF_METADATA_VALUE_TYPE_FLOAT64:
       return iree_io_gguf_parse_value(
-          contents, gguf_metadata_value_type_sizes[value_type], out_value);
+          reader, gguf_metadata_value_type_sizes[value_type], out_value);
     case GGUF_METADATA_VALUE_TYPE_STRING:
-      return iree_io_gguf_parse_string(contents, &out_value->string);
+      return iree_io_gguf_parse_string(reader, &out_value->string);
     case GGUF_METADATA_VALUE_TYPE_ARRAY: {
       IREE_RETURN_IF_ERROR(
-          iree_io_gguf_parse_uint32(contents, &out_value->array.type));
+          iree_io_gguf_parse_uint32(reader, &out_value->array.type));
       IREE_RETURN_IF_ERROR(
-          iree_io_gguf_parse_uint64(contents, &out_value->array.len));
+          iree_io_gguf_parse_uint64(reader, &out_value->array.len));
       // We don't support arrays right now because they require allocation due
       // to the variable length nature of things. We do still have to calculate
       // the total size which is annoying due to the nested variable-length
       // strings.
-      return iree_io_gguf_skip_metadata_array(contents, out_value->array.type,
+      return iree_io_gguf_skip_metadata_array(reader, out_value->array.type,
                                               out_value->array.len);
     }
   }
@@ -558,14 +598,14 @@ static iree_status_t iree_io_gguf_parse_metadata_value(
 typedef iree_status_t(IREE_API_PTR* iree_io_gguf_metadata_kv_callback_fn_t)(
     void* user_data, const gguf_metadata_kv_t* kv);
 static iree_status_t iree_io_gguf_enumerate_metadata_kv(
-    iree_const_byte_span_t* contents, uint64_t count,
+    iree_io_gguf_reader_t* reader, uint64_t count,
     iree_io_gguf_metadata_kv_callback_fn_t callback, void* user_data) {
   for (uint64_t i = 0; i < count; ++i) {
     gguf_metadata_kv_t kv = {0};
-    IREE_RETURN_IF_ERROR(iree_io_gguf_parse_string(contents, &kv.key));
-    IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint32(contents, &kv.value_type));
+    IREE_RETURN_IF_ERROR(iree_io_gguf_parse_string(reader, &kv.key));
+    IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint32(reader, &kv.value_type));
     IREE_RETURN_IF_ERROR(
-        iree_io_gguf_parse_metadata_value(contents, kv.value_type, &kv.value));
+        iree_io_gguf_parse_metadata_value(reader, kv.value_type, &kv.value));
     IREE_RETURN_IF_ERROR(callback(user_data, &kv));
   }
   return iree_ok_status();
@@ -574,21 +614,21 @@ static iree_status_t iree_io_gguf_enumerate_metadata_kv(
 typedef iree_status_t(IREE_API_PTR* iree_io_gguf_tensor_info_callback_fn_t)(
     void* user_data, const gguf_tensor_info_t* tensor_info);
 static iree_status_t iree_io_gguf_enumerate_tensor_info(
-    iree_const_byte_span_t* contents, uint64_t count,
+    iree_io_gguf_reader_t* reader, uint64_t count,
     iree_io_gguf_tensor_info_callback_fn_t callback, void* user_data) {
   for (uint64_t i = 0; i < count; ++i) {
     gguf_tensor_info_t tensor_info = {0};
     IREE_RETURN_IF_ERROR(
-        iree_io_gguf_parse_string(contents, &tensor_info.name));
+        iree_io_gguf_parse_string(reader, &tensor_info.name));
     IREE_RETURN_IF_ERROR(
-        iree_io_gguf_parse_uint32(contents, &tensor_info.n_dimensions));
+        iree_io_gguf_parse_uint32(reader, &tensor_info.n_dimensions));
     IREE_RETURN_IF_ERROR(iree_io_gguf_parse_array(
-        contents, tensor_info.n_dimensions, sizeof(tensor_info.dimensions[0]),
+        reader, tensor_info.n_dimensions, sizeof(tensor_info.dimensions[0]),
         (const uint8_t**)&tensor_info.dimensions));
     IREE_RETURN_IF_ERROR(
-        iree_io_gguf_parse_uint32(contents, &tensor_info.type));
+        iree_io_gguf_parse_uint32(reader, &tensor_info.type));
     IREE_RETURN_IF_ERROR(
-        iree_io_gguf_parse_uint64(contents, &tensor_info.offset));
+        iree_io_gguf_parse_uint64(reader, &tensor_info.offset));
     if (callback) {
       IREE_RETURN_IF_ERROR(callback(user_data, &tensor_info));
     }
@@ -652,17 +692,31 @@ static iree_status_t iree_io_gguf_append_tensor_info(
   return iree_io_parameter_index_add(parser->index, &entry);
 }
 
+// Parses the index from |file_contents| holding a prefix of a file of
+// |file_length| bytes that should contain at least the entire header (the
+// tensor data may be omitted). If the header extends past the end of
+// |file_contents| but not past the end of the file this fails with
+// IREE_STATUS_OUT_OF_RANGE and sets |out_required_length| to the prefix length
+// needed to make progress; no entries are added to |index| in that case.
+// |out_required_length| is left as 0 for all other failures.
 static iree_status_t iree_io_parse_gguf_index_from_memory(
     iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
-    iree_io_parameter_index_t* index) {
+    uint64_t file_length, iree_io_parameter_index_t* index,
+    uint64_t* out_required_length) {
+  *out_required_length = 0;
   // Read the header enough to check for file validity and version.
   // Unfortunately the format has a variable-length header (vs being
   // table-based) and that means we have to actually parse the header fully
   // (including all nested variable-length elements) in order to even know if
   // the whole header is present or where data lives. Yuck.
-  iree_const_byte_span_t contents = file_contents;
+  iree_io_gguf_reader_t reader = {
+      .origin = file_contents.data,
+      .contents = file_contents,
+      .file_length = file_length,
+      .required_length = out_required_length,
+  };
   uint32_t magic = 0;
-  IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint32(&contents, &magic));
+  IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint32(&reader, &magic));
   if (magic != GGUF_MAGIC) {
     return iree_make_status(
         IREE_STATUS_INVALID_ARGUMENT,
@@ -670,7 +724,7 @@ static iree_status_t iree_io_parse_gguf_index_from_memory(
         GGUF_MAGIC);
   }
   uint32_t version = 0;
-  IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint32(&contents, &version));
+  IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint32(&reader, &version));
   if (version != GGUF_VERSION) {
     return iree_make_status(
         IREE_STATUS_UNIMPLEMENTED,
@@ -678,10 +732,10 @@ static iree_status_t iree_io_parse_gguf_index_from_memory(
         GGUF_VERSION);
   }
   uint64_t tensor_count = 0;
-  IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint64(&contents, &tensor_count));
+  IREE_RETURN_IF_ERROR(iree_io_gguf_parse_uint64(&reader, &tensor_count));
   uint64_t metadata_kv_count = 0;
   IREE_RETURN_IF_ERROR(
-      iree_io_gguf_parse_uint64(&contents, &metadata_kv_count));
+      iree_io_gguf_parse_uint64(&reader, &metadata_kv_count));
 
   // If there are no tensors then no-op the parse. Probably not what the user
   // wanted but it's legal.
@@ -699,53 +753,140 @@ static iree_status_t iree_io_parse_gguf_index_from_memory(
   // Upon return the contents will start immediately after the header and at
   // the start of tensor info.
   IREE_RETURN_IF_ERROR(iree_io_gguf_enumerate_metadata_kv(
-      &contents, metadata_kv_count, iree_io_gguf_parse_metadata, &parser));
+      &reader, metadata_kv_count, iree_io_gguf_parse_metadata, &parser));
 
   // Scan forward through the tensor info to find where the tensor data base
   // offset is in the file. Unfortunately GGUF was designed without this offset
   // and because tensor info is variable length we cannot determine absolute
   // file offsets without doing two scans.
-  iree_const_byte_span_t tensor_info_contents = contents;
+  iree_io_gguf_reader_t tensor_info_reader = reader;
   IREE_RETURN_IF_ERROR(iree_io_gguf_enumerate_tensor_info(
-      &tensor_info_contents, tensor_count, NULL, &parser));
+      &tensor_info_reader, tensor_count, NULL, &parser));
 
   // Calculate where the tensor data begins in the file. This respects the
   // default alignment or the general.alignment specified by the file.
   parser.tensor_data_offset = iree_align_uint64(
-      (uint64_t)(tensor_info_contents.data - file_contents.data),
+      (uint64_t)(tensor_info_reader.contents.data - file_contents.data),
       parser.alignment);
-  parser.tensor_data_size =
-      file_contents.data_length - parser.tensor_data_offset;
+  if (parser.tensor_data_offset > file_length) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "file buffer underrun locating tensor data");
+  }
+  parser.tensor_data_size = file_length - parser.tensor_data_offset;
 
   // Scan forward through the tensor info now that we know the tensor data
   // offset and add the tensor entries.
   IREE_RETURN_IF_ERROR(iree_io_gguf_enumerate_tensor_info(
-      &contents, tensor_count, iree_io_gguf_append_tensor_info, &parser));
+      &reader, tensor_count, iree_io_gguf_append_tensor_info, &parser));
 
   return iree_ok_status();
 }
 
+// Initial number of bytes read when parsing from a stream. Most headers are
+// dominated by tokenizer vocabularies and fit in this.
+#define IREE_IO_GGUF_STREAM_INITIAL_READ_LENGTH (1 * 1024 * 1024)
+
+// Maximum number of bytes read when parsing from a stream. Even the largest
+// vocabularies are a few tens of MB and anything requiring more than this is
+// treated as corrupt instead of being read into memory.
+#define IREE_IO_GGUF_STREAM_MAX_HEADER_LENGTH (256 * 1024 * 1024)
+
+// Parses the index from |stream| positioned at the start of the file.
+// GGUF does not record the size of its header and the only way to find where
+// it ends is to parse it. Instead of reading the whole file we read a prefix
+// and parse it, at least doubling the prefix and retrying only when the header
+// runs past it. Tensor data is referenced by offset and never read.
+static iree_status_t iree_io_parse_gguf_index_from_stream(
+    iree_io_file_handle_t* file_handle, iree_io_stream_t* stream,
+    iree_io_parameter_index_t* index) {
+  const uint64_t file_length = (uint64_t)iree_io_stream_length(stream);
+  uint64_t required_length = 0;
+  if (file_length == 0) {
+    // Produces the usual truncation error.
+    return iree_io_parse_gguf_index_from_memory(
+        file_handle, iree_const_byte_span_empty(), file_length, index,
+        &required_length);
+  }
+  iree_allocator_t host_allocator =
+      iree_io_parameter_index_host_allocator(index);
+  uint8_t* prefix = NULL;
+  iree_host_size_t prefix_length = 0;
+  iree_host_size_t target_length = IREE_IO_GGUF_STREAM_INITIAL_READ_LENGTH;
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    // Extend the prefix by reading the next range of the file.
+    if ((uint64_t)target_length > file_length) {
+      target_length = (iree_host_size_t)file_length;
+    }
+    status =
+        iree_allocator_realloc(host_allocator, target_length, (void**)&prefix);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_stream_read(stream, target_length - prefix_length,
+                                   prefix + prefix_length, NULL);
+    }
+    if (!iree_status_is_ok(status)) break;
+    prefix_length = target_length;
+
+    // Parse what we have; only reads that need bytes between the end of the
+    // prefix and the end of the file extend the prefix. Lengths that run past
+    // the end of the file are corrupt and fail immediately.
+    status = iree_io_parse_gguf_index_from_memory(
+        file_handle, iree_make_const_byte_span(prefix, prefix_length),
+        file_length, index, &required_length);
+    if (iree_status_is_out_of_range(status) &&
+        required_length > (uint64_t)prefix_length) {
+      if (required_length > IREE_IO_GGUF_STREAM_MAX_HEADER_LENGTH) {
+        iree_status_ignore(status);
+        status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                                  "GGUF header requires at least %" PRIu64
+                                  " bytes and exceeds the %d byte limit",
+                                  required_length,
+                                  IREE_IO_GGUF_STREAM_MAX_HEADER_LENGTH);
+        break;
+      }
+      status = iree_status_ignore(status);
+      uint64_t next_length = (uint64_t)prefix_length * 2;
+      if (next_length < required_length) next_length = required_length;
+      if (next_length > IREE_IO_GGUF_STREAM_MAX_HEADER_LENGTH) {
+        next_length = IREE_IO_GGUF_STREAM_MAX_HEADER_LENGTH;
+      }
+      target_length = (iree_host_size_t)next_length;
+      continue;
+    }
+    break;
+  }
+  iree_allocator_free(host_allocator, prefix);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_io_parse_gguf_index(
     iree_io_file_handle_t* file_handle, iree_io_parameter_index_t* index) {
   IREE_ASSERT_ARGUMENT(index);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Today we only support memory files.
-  // TODO(benvanik): support iree_io_stream_t wrapping for parsing the index.
-  if (iree_io_file_handle_type(file_handle) !=
+  // Memory files are parsed in-place and all others are read through a stream.
+  iree_status_t status = iree_ok_status();
+  uint64_t required_length = 0;
+  if (iree_io_file_handle_type(file_handle) ==
       IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "non-memory gguf files not yet supported");
+    iree_byte_span_t host_allocation =
+        iree_io_file_handle_primitive(file_handle).value.host_allocation;
+    status = iree_io_parse_gguf_index_from_memory(
+        file_handle,
+        iree_make_const_byte_span(host_allocation.data,
+                                  host_allocation.data_length),
+        host_allocation.data_length, index, &required_length);
+  } else {
+    iree_io_stream_t* stream = NULL;
+    status = iree_io_stream_open(
+        IREE_IO_STREAM_MODE_READABLE | IREE_IO_STREAM_MODE_SEEKABLE,
+        file_handle, /*file_offset=*/0,
+        iree_io_parameter_index_host_allocator(index), &stream);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parse_gguf_index_from_stream(file_handle, stream, index);
+    }
+    iree_io_stream_release(stream);
   }
-  iree_byte_span_t host_allocation =
-      iree_io_file_handle_primitive(file_handle).value.host_allocation;
-
-  iree_status_t status = iree_io_parse_gguf_index_from_memory(
-      file_handle,
-      iree_make_const_byte_span(host_allocation.data,
-                                host_allocation.data_length),
-      index);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
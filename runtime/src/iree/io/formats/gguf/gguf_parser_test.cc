@@ -6,7 +6,11 @@
 
 #include "iree/io/formats/gguf/gguf_parser.h"
 
+#include <cstring>
+#include <string>
+
 #include "iree/io/formats/gguf/testdata/gguf_files.h"
+#include "iree/io/formats/testing/parser_test_util.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -32,6 +36,38 @@ static iree_io_file_handle_t* OpenTestFile(const char* name) {
   return NULL;
 }
 
+static void AppendUint32(std::string* contents, uint32_t value) {
+  contents->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+static void AppendUint64(std::string* contents, uint64_t value) {
+  contents->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+static void AppendString(std::string* contents, const std::string& value) {
+  AppendUint64(contents, value.size());
+  contents->append(value);
+}
+
+// Builds a GGUF v3 file with a single string metadata value of
+// |metadata_length| bytes and a single 4xf32 tensor named `tensor0`.
+static std::string MakeGgufFile(size_t metadata_length) {
+  std::string contents;
+  AppendUint32(&contents, 0x46554747);  // GGUF_MAGIC
+  AppendUint32(&contents, 3);           // GGUF_VERSION
+  AppendUint64(&contents, 1);           // tensor_count
+  AppendUint64(&contents, 1);           // metadata_kv_count
+  AppendString(&contents, "tokenizer.vocab");
+  AppendUint32(&contents, 8);  // GGUF_METADATA_VALUE_TYPE_STRING
+  AppendString(&contents, std::string(metadata_length, 'x'));
+  AppendString(&contents, "tensor0");
+  AppendUint32(&contents, 1);  // n_dimensions
+  AppendUint64(&contents, 4);  // dimensions[0]
+  AppendUint32(&contents, 0);  // GGML_TYPE_F32
+  AppendUint64(&contents, 0);  // offset
+  contents.resize((contents.size() + 31) & ~size_t(31), '\0');
+  contents.append(4 * sizeof(float), '\0');
+  return contents;
+}
+
 TEST(GgufFormatTest, Empty) {
   iree_io_parameter_index_t* index = NULL;
   IREE_ASSERT_OK(
@@ -100,5 +136,62 @@ TEST(GgufFormatTest, MultipleTensors) {
   iree_io_parameter_index_release(index);
 }
 
+// Files that are not in memory are parsed through a stream and must produce
+// the same index as parsing in-place.
+TEST(GgufFormatTest, StreamMatchesMemory) {
+  iree_io_file_handle_t* memory_handle = OpenTestFile("multiple.gguf");
+  io::ExpectStreamMatchesMemory(iree_io_parse_gguf_index, "multiple.gguf",
+                                memory_handle);
+  iree_io_file_handle_release(memory_handle);
+}
+
+// Headers larger than the initial stream prefix are read in full.
+TEST(GgufFormatTest, StreamLargeHeader) {
+  std::string contents = MakeGgufFile(3 * 1024 * 1024);
+  iree_io_file_handle_t* file_handle = io::OpenContentsFromDisk(
+      "large_header.gguf",
+      iree_make_const_byte_span(contents.data(), contents.size()));
+  if (!file_handle) GTEST_SKIP() << "file descriptors not supported";
+
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  IREE_ASSERT_OK(iree_io_parse_gguf_index(file_handle, index));
+
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_lookup(index, IREE_SV("tensor0"), &entry));
+  EXPECT_EQ(entry->storage.file.offset, contents.size() - 4 * sizeof(float));
+  EXPECT_EQ(entry->length, 4 * sizeof(float));
+
+  iree_io_parameter_index_release(index);
+  iree_io_file_handle_release(file_handle);
+}
+
+// Lengths declared past the end of the file fail without reading the file.
+TEST(GgufFormatTest, StreamCorruptLength) {
+  std::string contents = MakeGgufFile(16);
+  // Patch the metadata value length (after the fixed header, the key, and the
+  // value type) to run past the end of the file.
+  const size_t value_length_offset = 4 + 4 + 8 + 8 + 8 + 15 + 4;
+  uint64_t corrupt_length = 1ull << 40;
+  memcpy(&contents[value_length_offset], &corrupt_length,
+         sizeof(corrupt_length));
+  iree_io_file_handle_t* file_handle = io::OpenContentsFromDisk(
+      "corrupt_length.gguf",
+      iree_make_const_byte_span(contents.data(), contents.size()));
+  if (!file_handle) GTEST_SKIP() << "file descriptors not supported";
+
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_OUT_OF_RANGE,
+                        iree_io_parse_gguf_index(file_handle, index));
+  EXPECT_EQ(iree_io_parameter_index_count(index), 0);
+
+  iree_io_parameter_index_release(index);
+  iree_io_file_handle_release(file_handle);
+}
+
 }  // namespace
 }  // namespace iree
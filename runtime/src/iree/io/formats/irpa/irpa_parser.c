@@ -6,30 +6,27 @@
 
 #include "iree/io/formats/irpa/irpa_parser.h"
 
+#include "iree/io/stream.h"
 #include "iree/schemas/parameter_archive.h"
 
 static iree_status_t iree_io_verify_irpa_v0_file_range(
-    iree_const_byte_span_t file_contents, iree_io_physical_offset_t base_offset,
+    uint64_t file_length, iree_io_physical_offset_t base_offset,
     iree_io_parameter_archive_range_t range) {
   if (range.length == 0) return iree_ok_status();
-  if (base_offset + range.offset + range.length > file_contents.data_length) {
+  if (base_offset + range.offset + range.length > file_length) {
     return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
                             "file segment out of range (%" PRIu64 " to %" PRIu64
-                            " for %" PRIu64 ", file_size=%" PRIhsz ")",
+                            " for %" PRIu64 ", file_size=%" PRIu64 ")",
                             base_offset + range.offset,
                             base_offset + range.offset + range.length - 1,
-                            range.length, file_contents.data_length);
+                            range.length, file_length);
   }
   return iree_ok_status();
 }
 
-static iree_status_t iree_io_resolve_irpa_v0_string(
-    iree_const_byte_span_t file_contents, iree_io_physical_offset_t base_offset,
+static iree_status_t iree_io_verify_irpa_v0_metadata_ref(
     const iree_io_parameter_archive_header_v0_t* header,
-    iree_io_parameter_archive_metadata_ref_t range,
-    iree_string_view_t* out_view) {
-  *out_view = iree_string_view_empty();
-  if (range.length == 0) return iree_ok_status();
+    iree_io_parameter_archive_metadata_ref_t range) {
   if (range.offset + range.length > header->metadata_segment.length) {
     return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
                             "metadata segment reference out of range (%" PRIu64
@@ -38,37 +35,39 @@ static iree_status_t iree_io_resolve_irpa_v0_string(
                             range.offset, range.offset + range.length - 1,
                             range.length, header->metadata_segment.length);
   }
-  iree_io_physical_offset_t view_offset =
-      base_offset + header->metadata_segment.offset + range.offset;
+  return iree_ok_status();
+}
+
+// Resolves a string |range| within the |metadata_segment| contents.
+static iree_status_t iree_io_resolve_irpa_v0_string(
+    iree_const_byte_span_t metadata_segment,
+    const iree_io_parameter_archive_header_v0_t* header,
+    iree_io_parameter_archive_metadata_ref_t range,
+    iree_string_view_t* out_view) {
+  *out_view = iree_string_view_empty();
+  if (range.length == 0) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_io_verify_irpa_v0_metadata_ref(header, range));
   *out_view = iree_make_string_view(
-      (const char*)file_contents.data + view_offset, range.length);
+      (const char*)metadata_segment.data + range.offset, range.length);
   return iree_ok_status();
 }
 
+// Resolves a byte |range| within the |metadata_segment| contents.
 static iree_status_t iree_io_resolve_irpa_v0_metadata(
-    iree_const_byte_span_t file_contents, iree_io_physical_offset_t base_offset,
+    iree_const_byte_span_t metadata_segment,
     const iree_io_parameter_archive_header_v0_t* header,
     iree_io_parameter_archive_metadata_ref_t range,
     iree_const_byte_span_t* out_span) {
   *out_span = iree_const_byte_span_empty();
   if (range.length == 0) return iree_ok_status();
-  if (range.offset + range.length > header->metadata_segment.length) {
-    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
-                            "metadata segment reference out of range (%" PRIu64
-                            " to %" PRIu64 " for %" PRIu64
-                            ", segment_size=%" PRIu64 ")",
-                            range.offset, range.offset + range.length - 1,
-                            range.length, header->metadata_segment.length);
-  }
-  iree_io_physical_offset_t span_offset =
-      base_offset + header->metadata_segment.offset + range.offset;
-  *out_span =
-      iree_make_const_byte_span(file_contents.data + span_offset, range.length);
+  IREE_RETURN_IF_ERROR(iree_io_verify_irpa_v0_metadata_ref(header, range));
+  *out_span = iree_make_const_byte_span(metadata_segment.data + range.offset,
+                                        range.length);
   return iree_ok_status();
 }
 
 static iree_status_t iree_io_resolve_irpa_v0_storage(
-    iree_const_byte_span_t file_contents, iree_io_physical_offset_t base_offset,
+    iree_io_physical_offset_t base_offset,
     const iree_io_parameter_archive_header_v0_t* header,
     iree_io_parameter_archive_storage_ref_t range,
     iree_io_physical_offset_t* out_offset) {
@@ -123,8 +122,7 @@ static iree_status_t iree_io_parse_irpa_v0_splat_entry(
 }
 
 static iree_status_t iree_io_parse_irpa_v0_data_entry(
-    iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
-    iree_io_physical_offset_t base_offset,
+    iree_io_file_handle_t* file_handle, iree_io_physical_offset_t base_offset,
     const iree_io_parameter_archive_header_v0_t* header,
     const iree_io_parameter_archive_data_entry_t* data_entry,
     iree_string_view_t name, iree_const_byte_span_t metadata,
@@ -134,9 +132,8 @@ static iree_status_t iree_io_parse_irpa_v0_data_entry(
                             "data entry length underflow");
   }
   iree_io_physical_offset_t storage_offset = 0;
-  IREE_RETURN_IF_ERROR(
-      iree_io_resolve_irpa_v0_storage(file_contents, base_offset, header,
-                                      data_entry->storage, &storage_offset));
+  IREE_RETURN_IF_ERROR(iree_io_resolve_irpa_v0_storage(
+      base_offset, header, data_entry->storage, &storage_offset));
   iree_io_parameter_index_entry_t entry = {
       .key = name,
       .metadata = metadata,
@@ -154,12 +151,9 @@ static iree_status_t iree_io_parse_irpa_v0_data_entry(
   return iree_io_parameter_index_add(index, &entry);
 }
 
-static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
-    iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
-    iree_io_physical_offset_t base_offset,
-    const iree_io_parameter_archive_header_prefix_t* header_prefix,
-    iree_io_parameter_index_t* index) {
-  // Get the full header struct.
+// Verifies the v0 |header_prefix| describes a header this parser supports.
+static iree_status_t iree_io_verify_irpa_v0_header_prefix(
+    const iree_io_parameter_archive_header_prefix_t* header_prefix) {
   if (header_prefix->version_minor > 0) {
     return iree_make_status(
         IREE_STATUS_UNIMPLEMENTED,
@@ -175,26 +169,38 @@ static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
                             sizeof(iree_io_parameter_archive_header_v0_t),
                             header_prefix->header_size);
   }
-  const iree_io_parameter_archive_header_v0_t* header =
-      (const iree_io_parameter_archive_header_v0_t*)file_contents.data;
+  return iree_ok_status();
+}
 
-  // Verify the base data ranges; this lets all subsequent checks be against the
-  // header instead of needing to know about the view into the file.
+// Verifies the base data ranges of |header| are within the file; this lets all
+// subsequent checks be against the header instead of needing to know about the
+// view into the file.
+static iree_status_t iree_io_verify_irpa_v0_header(
+    uint64_t file_length, iree_io_physical_offset_t base_offset,
+    const iree_io_parameter_archive_header_v0_t* header) {
   IREE_RETURN_IF_ERROR(iree_io_verify_irpa_v0_file_range(
-                           file_contents, base_offset, header->entry_segment),
+                           file_length, base_offset, header->entry_segment),
                        "verifying entry table");
-  IREE_RETURN_IF_ERROR(
-      iree_io_verify_irpa_v0_file_range(file_contents, base_offset,
-                                        header->metadata_segment),
-      "verifying metadata segment");
   IREE_RETURN_IF_ERROR(iree_io_verify_irpa_v0_file_range(
-                           file_contents, base_offset, header->storage_segment),
+                           file_length, base_offset, header->metadata_segment),
+                       "verifying metadata segment");
+  IREE_RETURN_IF_ERROR(iree_io_verify_irpa_v0_file_range(
+                           file_length, base_offset, header->storage_segment),
                        "verifying storage segment");
+  return iree_ok_status();
+}
 
+// Walks the |entry_segment| table and adds its entries to |index|. Names and
+// metadata are resolved from the |metadata_segment| contents and storage is
+// referenced by offset into |file_handle|.
+static iree_status_t iree_io_parse_irpa_v0_entries(
+    iree_io_file_handle_t* file_handle, iree_io_physical_offset_t base_offset,
+    const iree_io_parameter_archive_header_v0_t* header,
+    iree_const_byte_span_t entry_segment,
+    iree_const_byte_span_t metadata_segment, iree_io_parameter_index_t* index) {
   // Walk the entry table, which has variable-length entries.
-  iree_io_physical_offset_t entry_offset =
-      base_offset + header->entry_segment.offset;
-  iree_io_physical_size_t entry_size_remaining = header->entry_segment.length;
+  const uint8_t* entry_ptr = entry_segment.data;
+  iree_io_physical_size_t entry_size_remaining = entry_segment.data_length;
   for (iree_io_physical_size_t i = 0; i < header->entry_count; ++i) {
     // Ensure there's enough space in the table for the base entry header.
     if (entry_size_remaining <
@@ -206,8 +212,7 @@ static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
 
     // Ensure there's enough space for the declared entry size (if any larger).
     const iree_io_parameter_archive_entry_header_t* entry_header =
-        (const iree_io_parameter_archive_entry_header_t*)(file_contents.data +
-                                                          entry_offset);
+        (const iree_io_parameter_archive_entry_header_t*)entry_ptr;
     if (entry_header->entry_size < sizeof(*entry_header) ||
         entry_size_remaining < entry_header->entry_size) {
       return iree_make_status(
@@ -217,18 +222,22 @@ static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
     // TODO(benvanik): make this explicit with iree_io_stream_seek_to_alignment.
     iree_io_physical_offset_t aligned_entry_size = iree_align_uint64(
         entry_header->entry_size, IREE_IO_PARAMETER_ARCHIVE_ENTRY_ALIGNMENT);
-    entry_offset += aligned_entry_size;
+    if (aligned_entry_size > entry_size_remaining) {
+      // The final entry need not be padded.
+      aligned_entry_size = entry_size_remaining;
+    }
+    entry_ptr += aligned_entry_size;
     entry_size_remaining -= aligned_entry_size;
 
     // Resolve entry metadata from the archive metadata segment.
     iree_string_view_t name = iree_string_view_empty();
     IREE_RETURN_IF_ERROR(
-        iree_io_resolve_irpa_v0_string(file_contents, base_offset, header,
+        iree_io_resolve_irpa_v0_string(metadata_segment, header,
                                        entry_header->name, &name),
         "resolving entry name");
     iree_const_byte_span_t metadata = iree_const_byte_span_empty();
     IREE_RETURN_IF_ERROR(
-        iree_io_resolve_irpa_v0_metadata(file_contents, base_offset, header,
+        iree_io_resolve_irpa_v0_metadata(metadata_segment, header,
                                          entry_header->metadata, &metadata),
         "resolving entry metadata");
 
@@ -245,7 +254,7 @@ static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
       }
       case IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_DATA: {
         IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_data_entry(
-            file_handle, file_contents, base_offset, header,
+            file_handle, base_offset, header,
             (const iree_io_parameter_archive_data_entry_t*)entry_header, name,
             metadata, index));
         break;
@@ -260,57 +269,90 @@ static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
   return iree_ok_status();
 }
 
-static iree_status_t iree_io_parse_irpa_index_from_memory(
-    iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
-    iree_io_physical_offset_t base_offset, iree_io_parameter_index_t* index) {
-  // Check the basic header information is something we can process.
-  if (file_contents.data_length <
-      base_offset + sizeof(iree_io_parameter_archive_header_prefix_t)) {
-    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                            "not enough bytes for a valid IRPA header; file "
-                            "may be empty or truncated");
-  }
-  const iree_io_parameter_archive_header_prefix_t* header_prefix =
-      (const iree_io_parameter_archive_header_prefix_t*)(file_contents.data +
-                                                         base_offset);
+// Verifies the |header_prefix| at |base_offset| in a file of |file_length|
+// bytes is an archive header and that any linked header is within the file.
+static iree_status_t iree_io_verify_irpa_header_prefix(
+    uint64_t file_length, iree_io_physical_offset_t base_offset,
+    const iree_io_parameter_archive_header_prefix_t* header_prefix) {
   if (header_prefix->magic != IREE_IO_PARAMETER_ARCHIVE_MAGIC) {
     return iree_make_status(
         IREE_STATUS_INVALID_ARGUMENT,
         "IRPA file magic missing or invalid %08X; expected %08X",
         header_prefix->magic, IREE_IO_PARAMETER_ARCHIVE_MAGIC);
   }
-  if (header_prefix->header_size > file_contents.data_length) {
+  if (base_offset + header_prefix->header_size > file_length) {
     return iree_make_status(
         IREE_STATUS_OUT_OF_RANGE,
         "file buffer underrun parsing header of reported size %" PRIu64
-        " (only %" PRIhsz " bytes available)",
-        header_prefix->header_size, file_contents.data_length);
+        " (only %" PRIu64 " bytes available)",
+        header_prefix->header_size, file_length - base_offset);
   }
   if (header_prefix->next_header_offset != 0 &&
-      file_contents.data_length <
-          base_offset + header_prefix->next_header_offset +
-              sizeof(iree_io_parameter_archive_header_prefix_t)) {
+      file_length < base_offset + header_prefix->next_header_offset +
+                        sizeof(iree_io_parameter_archive_header_prefix_t)) {
     return iree_make_status(
         IREE_STATUS_OUT_OF_RANGE,
         "file buffer underrun verifying linked header at offset %" PRIu64
-        " (only %" PRIhsz " bytes available)",
-        base_offset + header_prefix->next_header_offset,
-        file_contents.data_length);
+        " (only %" PRIu64 " bytes available)",
+        base_offset + header_prefix->next_header_offset, file_length);
   }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_io_verify_irpa_file_length(
+    uint64_t file_length, iree_io_physical_offset_t base_offset) {
+  if (file_length <
+      base_offset + sizeof(iree_io_parameter_archive_header_prefix_t)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "not enough bytes for a valid IRPA header; file "
+                            "may be empty or truncated");
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_io_make_irpa_version_unimplemented_status(
+    const iree_io_parameter_archive_header_prefix_t* header_prefix) {
+  return iree_make_status(
+      IREE_STATUS_UNIMPLEMENTED,
+      "IRPA major version %u.%u not supported by this runtime",
+      header_prefix->version_major, header_prefix->version_minor);
+}
+
+static iree_status_t iree_io_parse_irpa_index_from_memory(
+    iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
+    iree_io_physical_offset_t base_offset, iree_io_parameter_index_t* index) {
+  // Check the basic header information is something we can process.
+  const uint64_t file_length = file_contents.data_length;
+  IREE_RETURN_IF_ERROR(
+      iree_io_verify_irpa_file_length(file_length, base_offset));
+  const iree_io_parameter_archive_header_prefix_t* header_prefix =
+      (const iree_io_parameter_archive_header_prefix_t*)(file_contents.data +
+                                                         base_offset);
+  IREE_RETURN_IF_ERROR(iree_io_verify_irpa_header_prefix(
+      file_length, base_offset, header_prefix));
 
   // Route major versions to their parsers, allowing us to change everything but
   // the prefix without breaking compatibility.
   switch (header_prefix->version_major) {
     case 0: {
-      IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_index_from_memory(
-          file_handle, file_contents, base_offset, header_prefix, index));
+      IREE_RETURN_IF_ERROR(
+          iree_io_verify_irpa_v0_header_prefix(header_prefix));
+      const iree_io_parameter_archive_header_v0_t* header =
+          (const iree_io_parameter_archive_header_v0_t*)header_prefix;
+      IREE_RETURN_IF_ERROR(
+          iree_io_verify_irpa_v0_header(file_length, base_offset, header));
+      const uint8_t* base_ptr = file_contents.data + base_offset;
+      IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_entries(
+          file_handle, base_offset, header,
+          iree_make_const_byte_span(base_ptr + header->entry_segment.offset,
+                                    header->entry_segment.length),
+          iree_make_const_byte_span(base_ptr + header->metadata_segment.offset,
+                                    header->metadata_segment.length),
+          index));
       break;
     }
     default: {
-      return iree_make_status(
-          IREE_STATUS_UNIMPLEMENTED,
-          "IRPA major version %u.%u not supported by this runtime",
-          header_prefix->version_major, header_prefix->version_minor);
+      return iree_io_make_irpa_version_unimplemented_status(header_prefix);
     }
   }
 
@@ -321,27 +363,141 @@ static iree_status_t iree_io_parse_irpa_index_from_memory(
       base_offset + header_prefix->next_header_offset, index);
 }
 
+// Reads |range| relative to |base_offset| from |stream| into a new allocation
+// returned in |out_contents|. The caller must free the data with
+// |host_allocator|.
+static iree_status_t iree_io_read_irpa_segment(
+    iree_io_stream_t* stream, iree_io_physical_offset_t base_offset,
+    iree_io_parameter_archive_range_t range, iree_allocator_t host_allocator,
+    iree_byte_span_t* out_contents) {
+  *out_contents = iree_byte_span_empty();
+  if (range.length == 0) return iree_ok_status();
+  if (range.length > IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "attempting to load a 64-bit file on a 32-bit arch "
+                            "(out of bounds segment length)");
+  }
+  IREE_RETURN_IF_ERROR(iree_io_stream_seek(
+      stream, IREE_IO_STREAM_SEEK_SET,
+      (iree_io_stream_pos_t)(base_offset + range.offset)));
+  uint8_t* data = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, (iree_host_size_t)range.length, (void**)&data));
+  iree_status_t status =
+      iree_io_stream_read(stream, (iree_host_size_t)range.length, data, NULL);
+  if (iree_status_is_ok(status)) {
+    *out_contents = iree_make_byte_span(data, (iree_host_size_t)range.length);
+  } else {
+    iree_allocator_free(host_allocator, data);
+  }
+  return status;
+}
+
+static iree_status_t iree_io_parse_irpa_v0_index_from_stream(
+    iree_io_file_handle_t* file_handle, iree_io_stream_t* stream,
+    uint64_t file_length, iree_io_physical_offset_t base_offset,
+    iree_io_parameter_index_t* index) {
+  iree_io_parameter_archive_header_v0_t header;
+  IREE_RETURN_IF_ERROR(iree_io_stream_seek(stream, IREE_IO_STREAM_SEEK_SET,
+                                           (iree_io_stream_pos_t)base_offset));
+  IREE_RETURN_IF_ERROR(
+      iree_io_stream_read(stream, sizeof(header), &header, NULL));
+  IREE_RETURN_IF_ERROR(
+      iree_io_verify_irpa_v0_header(file_length, base_offset, &header));
+
+  // Only the entry table and metadata segment are read; storage is referenced
+  // by offset and fetched on demand by whoever uses the index.
+  iree_allocator_t host_allocator =
+      iree_io_parameter_index_host_allocator(index);
+  iree_byte_span_t entry_segment = iree_byte_span_empty();
+  iree_byte_span_t metadata_segment = iree_byte_span_empty();
+  iree_status_t status =
+      iree_io_read_irpa_segment(stream, base_offset, header.entry_segment,
+                                host_allocator, &entry_segment);
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_io_read_irpa_segment(stream, base_offset, header.metadata_segment,
+                                  host_allocator, &metadata_segment);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parse_irpa_v0_entries(
+        file_handle, base_offset, &header,
+        iree_make_const_byte_span(entry_segment.data,
+                                  entry_segment.data_length),
+        iree_make_const_byte_span(metadata_segment.data,
+                                  metadata_segment.data_length),
+        index);
+  }
+  iree_allocator_free(host_allocator, metadata_segment.data);
+  iree_allocator_free(host_allocator, entry_segment.data);
+  return status;
+}
+
+static iree_status_t iree_io_parse_irpa_index_from_stream(
+    iree_io_file_handle_t* file_handle, iree_io_stream_t* stream,
+    iree_io_physical_offset_t base_offset, iree_io_parameter_index_t* index) {
+  // Check the basic header information is something we can process.
+  const uint64_t file_length = (uint64_t)iree_io_stream_length(stream);
+  IREE_RETURN_IF_ERROR(
+      iree_io_verify_irpa_file_length(file_length, base_offset));
+  iree_io_parameter_archive_header_prefix_t header_prefix;
+  IREE_RETURN_IF_ERROR(iree_io_stream_seek(stream, IREE_IO_STREAM_SEEK_SET,
+                                           (iree_io_stream_pos_t)base_offset));
+  IREE_RETURN_IF_ERROR(
+      iree_io_stream_read(stream, sizeof(header_prefix), &header_prefix, NULL));
+  IREE_RETURN_IF_ERROR(iree_io_verify_irpa_header_prefix(
+      file_length, base_offset, &header_prefix));
+
+  // Route major versions to their parsers, allowing us to change everything but
+  // the prefix without breaking compatibility.
+  switch (header_prefix.version_major) {
+    case 0: {
+      IREE_RETURN_IF_ERROR(
+          iree_io_verify_irpa_v0_header_prefix(&header_prefix));
+      IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_index_from_stream(
+          file_handle, stream, file_length, base_offset, index));
+      break;
+    }
+    default: {
+      return iree_io_make_irpa_version_unimplemented_status(&header_prefix);
+    }
+  }
+
+  // If there's a linked header then tail-call process it.
+  if (header_prefix.next_header_offset == 0) return iree_ok_status();
+  return iree_io_parse_irpa_index_from_stream(
+      file_handle, stream, base_offset + header_prefix.next_header_offset,
+      index);
+}
+
 IREE_API_EXPORT iree_status_t iree_io_parse_irpa_index(
     iree_io_file_handle_t* file_handle, iree_io_parameter_index_t* index) {
   IREE_ASSERT_ARGUMENT(index);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Today we only support memory files.
-  // TODO(benvanik): support iree_io_stream_t wrapping for parsing the index.
-  if (iree_io_file_handle_type(file_handle) !=
+  // Memory files are parsed in-place and all others are read through a stream.
+  iree_status_t status = iree_ok_status();
+  if (iree_io_file_handle_type(file_handle) ==
       IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "non-memory irpa files not yet supported");
+    iree_byte_span_t host_allocation =
+        iree_io_file_handle_primitive(file_handle).value.host_allocation;
+    status = iree_io_parse_irpa_index_from_memory(
+        file_handle,
+        iree_make_const_byte_span(host_allocation.data,
+                                  host_allocation.data_length),
+        /*base_offset=*/0, index);
+  } else {
+    iree_io_stream_t* stream = NULL;
+    status = iree_io_stream_open(
+        IREE_IO_STREAM_MODE_READABLE | IREE_IO_STREAM_MODE_SEEKABLE,
+        file_handle, /*file_offset=*/0,
+        iree_io_parameter_index_host_allocator(index), &stream);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parse_irpa_index_from_stream(file_handle, stream,
+                                                    /*base_offset=*/0, index);
+    }
+    iree_io_stream_release(stream);
   }
-  iree_byte_span_t host_allocation =
-      iree_io_file_handle_primitive(file_handle).value.host_allocation;
-
-  iree_status_t status = iree_io_parse_irpa_index_from_memory(
-      file_handle,
-      iree_make_const_byte_span(host_allocation.data,
-                                host_allocation.data_length),
-      /*base_offset=*/0, index);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
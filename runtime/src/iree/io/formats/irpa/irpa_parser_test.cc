@@ -7,6 +7,7 @@
 #include "iree/io/formats/irpa/irpa_parser.h"
 
 #include "iree/io/formats/irpa/testdata/irpa_files.h"
+#include "iree/io/formats/testing/parser_test_util.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -153,5 +154,14 @@ TEST(IrpaFormatTest, MixedDataAndSplats) {
   iree_io_parameter_index_release(index);
 }
 
+// Files that are not in memory are parsed through a stream and must produce
+// the same index as parsing in-place.
+TEST(IrpaFormatTest, StreamMatchesMemory) {
+  iree_io_file_handle_t* memory_handle = OpenTestFile("mixed.irpa");
+  io::ExpectStreamMatchesMemory(iree_io_parse_irpa_index, "mixed.irpa",
+                                memory_handle);
+  iree_io_file_handle_release(memory_handle);
+}
+
 }  // namespace
 }  // namespace iree
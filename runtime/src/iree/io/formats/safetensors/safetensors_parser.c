@@ -8,6 +8,8 @@
 
 #include <ctype.h>
 
+#include "iree/io/stream.h"
+
 // File format:
 // - uint64_t header_length;
 // - uint8_t header_json[header_length];
@@ -455,25 +457,29 @@ static iree_status_t iree_io_enumerate_safetensors_entries(
   return iree_io_parameter_index_add(entry_state->index, &entry);
 }
 
-static iree_status_t iree_io_parse_safetensors_index_from_memory(
-    iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
+// Parses a safetensors |header_json| blob and emits entries to |index|.
+// Each entry is bounds checked against the |data_size| of the file (bytes
+// excluding the header, relative to |base_offset|).
+static iree_status_t iree_io_parse_safetensors_header(
+    iree_io_file_handle_t* file_handle, iree_string_view_t header_json,
+    uint64_t base_offset, uint64_t data_size,
     iree_io_parameter_index_t* index) {
-  // Reads the header JSON blob out of the file contents and calculates the base
-  // offset that all data ranges are relative to. Verifies that the header and
-  // base offset is in range but each entry data range still needs to be
-  // verified.
-  uint64_t remaining_bytes = file_contents.data_length;
-  uint64_t header_length = 0;
-  if (remaining_bytes < sizeof(header_length)) {
-    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
-                            "insufficient capacity for safetensors header "
-                            "length (need at least %" PRIhsz
-                            " bytes but have %" PRIu64 ")",
-                            sizeof(header_length), remaining_bytes);
-  }
-  header_length =
-      iree_unaligned_load_le_u64((const uint64_t*)file_contents.data);
-  remaining_bytes -= sizeof(header_length);
+  iree_io_enumerate_safetensors_entry_state_t enumerate_state = {
+      .file_handle = file_handle,
+      .base_offset = base_offset,
+      .data_size = data_size,
+      .index = index,
+  };
+  return iree_json_enumerate_object(
+      header_json, iree_io_enumerate_safetensors_entries, &enumerate_state);
+}
+
+// Verifies the declared |header_length| fits within a file of |file_length|
+// bytes and returns the number of bytes following the header.
+static iree_status_t iree_io_verify_safetensors_header_length(
+    uint64_t file_length, uint64_t header_length,
+    uint64_t* out_remaining_bytes) {
+  uint64_t remaining_bytes = file_length - sizeof(header_length);
   if (remaining_bytes < header_length) {
     return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
                             "insufficient capacity for safetensors header "
@@ -481,23 +487,81 @@ static iree_status_t iree_io_parse_safetensors_index_from_memory(
                             " but only %" PRIu64 " bytes available)",
                             header_length, remaining_bytes);
   }
+  if (header_length > IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "attempting to load a 64-bit file on a 32-bit arch "
+                            "(out of bounds header length)");
+  }
+  *out_remaining_bytes = remaining_bytes - header_length;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_io_verify_safetensors_file_length(
+    uint64_t file_length) {
+  if (file_length < sizeof(uint64_t)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "insufficient capacity for safetensors header "
+                            "length (need at least %" PRIhsz
+                            " bytes but have %" PRIu64 ")",
+                            sizeof(uint64_t), file_length);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_io_parse_safetensors_index_from_memory(
+    iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
+    iree_io_parameter_index_t* index) {
+  // Reads the header JSON blob out of the file contents and calculates the base
+  // offset that all data ranges are relative to. Verifies that the header and
+  // base offset is in range but each entry data range still needs to be
+  // verified.
+  IREE_RETURN_IF_ERROR(
+      iree_io_verify_safetensors_file_length(file_contents.data_length));
+  const uint64_t header_length =
+      iree_unaligned_load_le_u64((const uint64_t*)file_contents.data);
+  uint64_t remaining_bytes = 0;
+  IREE_RETURN_IF_ERROR(iree_io_verify_safetensors_header_length(
+      file_contents.data_length, header_length, &remaining_bytes));
   const iree_string_view_t header_json = iree_make_string_view(
       (const char*)file_contents.data + sizeof(header_length),
       (iree_host_size_t)header_length);
-  const uint64_t base_offset = sizeof(header_length) + header_length;
-  remaining_bytes -= header_length;
+  return iree_io_parse_safetensors_header(
+      file_handle, header_json, sizeof(header_length) + header_length,
+      remaining_bytes, index);
+}
 
-  // Parses a safetensors |header_json| blob and emits entries to |index|.
-  // Each entry is bounds checked against the |data_size| of the file (bytes
-  // excluding the header, relative to |base_offset|).
-  iree_io_enumerate_safetensors_entry_state_t enumerate_state = {
-      .file_handle = file_handle,
-      .base_offset = base_offset,
-      .data_size = remaining_bytes,
-      .index = index,
-  };
-  return iree_json_enumerate_object(
-      header_json, iree_io_enumerate_safetensors_entries, &enumerate_state);
+// Parses the index from |stream| positioned at the start of the file. Only the
+// header is read; tensor data is referenced by offset and never touched.
+static iree_status_t iree_io_parse_safetensors_index_from_stream(
+    iree_io_file_handle_t* file_handle, iree_io_stream_t* stream,
+    iree_io_parameter_index_t* index) {
+  const uint64_t file_length = (uint64_t)iree_io_stream_length(stream);
+  IREE_RETURN_IF_ERROR(iree_io_verify_safetensors_file_length(file_length));
+  uint64_t header_length = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_io_stream_read(stream, sizeof(header_length), &header_length, NULL));
+  header_length = iree_unaligned_load_le_u64(&header_length);
+  uint64_t remaining_bytes = 0;
+  IREE_RETURN_IF_ERROR(iree_io_verify_safetensors_header_length(
+      file_length, header_length, &remaining_bytes));
+
+  // The JSON has no internal structure we can use to parse it in pieces so
+  // the header is read whole; it is usually a tiny fraction of the file.
+  iree_allocator_t host_allocator =
+      iree_io_parameter_index_host_allocator(index);
+  char* header_json = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, (iree_host_size_t)header_length, (void**)&header_json));
+  iree_status_t status = iree_io_stream_read(
+      stream, (iree_host_size_t)header_length, header_json, NULL);
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parse_safetensors_header(
+        file_handle,
+        iree_make_string_view(header_json, (iree_host_size_t)header_length),
+        sizeof(header_length) + header_length, remaining_bytes, index);
+  }
+  iree_allocator_free(host_allocator, header_json);
+  return status;
 }
 
 IREE_API_EXPORT iree_status_t iree_io_parse_safetensors_index(
@@ -505,22 +569,29 @@ IREE_API_EXPORT iree_status_t iree_io_parse_safetensors_index(
   IREE_ASSERT_ARGUMENT(index);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Today we only support memory files.
-  // TODO(benvanik): support iree_io_stream_t wrapping for parsing the index.
-  if (iree_io_file_handle_type(file_handle) !=
+  // Memory files are parsed in-place and all others are read through a stream.
+  iree_status_t status = iree_ok_status();
+  if (iree_io_file_handle_type(file_handle) ==
       IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "non-memory safetensors files not yet supported");
+    iree_byte_span_t host_allocation =
+        iree_io_file_handle_primitive(file_handle).value.host_allocation;
+    status = iree_io_parse_safetensors_index_from_memory(
+        file_handle,
+        iree_make_const_byte_span(host_allocation.data,
+                                  host_allocation.data_length),
+        index);
+  } else {
+    iree_io_stream_t* stream = NULL;
+    status = iree_io_stream_open(
+        IREE_IO_STREAM_MODE_READABLE | IREE_IO_STREAM_MODE_SEEKABLE,
+        file_handle, /*file_offset=*/0,
+        iree_io_parameter_index_host_allocator(index), &stream);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parse_safetensors_index_from_stream(file_handle, stream,
+                                                           index);
+    }
+    iree_io_stream_release(stream);
   }
-  iree_byte_span_t host_allocation =
-      iree_io_file_handle_primitive(file_handle).value.host_allocation;
-
-  iree_status_t status = iree_io_parse_safetensors_index_from_memory(
-      file_handle,
-      iree_make_const_byte_span(host_allocation.data,
-                                host_allocation.data_length),
-      index);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -7,6 +7,7 @@
 #include "iree/io/formats/safetensors/safetensors_parser.h"
 
 #include "iree/io/formats/safetensors/testdata/safetensors_files.h"
+#include "iree/io/formats/testing/parser_test_util.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -100,5 +101,14 @@ TEST(SafetensorsFormatTest, MultipleTensors) {
   iree_io_parameter_index_release(index);
 }
 
+// Files that are not in memory are parsed through a stream and must produce
+// the same index as parsing in-place.
+TEST(SafetensorsFormatTest, StreamMatchesMemory) {
+  iree_io_file_handle_t* memory_handle = OpenTestFile("multiple.safetensors");
+  io::ExpectStreamMatchesMemory(iree_io_parse_safetensors_index,
+                                "multiple.safetensors", memory_handle);
+  iree_io_file_handle_release(memory_handle);
+}
+
 }  // namespace
 }  // namespace iree
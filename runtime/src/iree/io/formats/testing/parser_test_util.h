@@ -0,0 +1,108 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_FORMATS_TESTING_PARSER_TEST_UTIL_H_
+#define IREE_IO_FORMATS_TESTING_PARSER_TEST_UTIL_H_
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/io/file_handle.h"
+#include "iree/io/parameter_index.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace io {
+
+// Parses the file with |file_handle| and appends its entries to |index|.
+typedef iree_status_t (*ParseIndexFn)(iree_io_file_handle_t* file_handle,
+                                      iree_io_parameter_index_t* index);
+
+// Writes |contents| to disk as |name| and opens it as a file descriptor-backed
+// handle so that it is parsed through a stream. Returns NULL if the platform
+// does not support file descriptors.
+static inline iree_io_file_handle_t* OpenContentsFromDisk(
+    const char* name, iree_const_byte_span_t contents) {
+  const char* tmpdir = getenv("TEST_TMPDIR");
+  if (!tmpdir) tmpdir = getenv("TMPDIR");
+  if (!tmpdir) tmpdir = "/tmp";
+  std::string path = std::string(tmpdir) + "/" + name;
+  IREE_CHECK_OK(iree_file_write_contents(path.c_str(), contents));
+  iree_io_file_handle_t* file_handle = NULL;
+  iree_status_t status = iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ, iree_make_cstring_view(path.c_str()),
+      iree_allocator_system(), &file_handle);
+  remove(path.c_str());
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    return NULL;
+  }
+  IREE_CHECK_OK(status);
+  return file_handle;
+}
+
+// Writes the contents of the host allocation |memory_handle| to disk as |name|
+// and opens it like OpenContentsFromDisk.
+static inline iree_io_file_handle_t* OpenMemoryFileFromDisk(
+    const char* name, iree_io_file_handle_t* memory_handle) {
+  iree_byte_span_t contents =
+      iree_io_file_handle_value(memory_handle).host_allocation;
+  return OpenContentsFromDisk(
+      name, iree_make_const_byte_span(contents.data, contents.data_length));
+}
+
+// Files that are not in memory are parsed through a stream and must produce
+// the same index as parsing in-place. Parses the host allocation
+// |memory_handle| and a copy of it written to disk as |name| with |parse_fn|
+// and expects the indices to match. Skips the test if the platform does not
+// support file descriptors.
+static inline void ExpectStreamMatchesMemory(
+    ParseIndexFn parse_fn, const char* name,
+    iree_io_file_handle_t* memory_handle) {
+  iree_io_file_handle_t* disk_handle =
+      OpenMemoryFileFromDisk(name, memory_handle);
+  if (!disk_handle) GTEST_SKIP() << "file descriptors not supported";
+
+  iree_io_parameter_index_t* memory_index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &memory_index));
+  IREE_ASSERT_OK(parse_fn(memory_handle, memory_index));
+  iree_io_parameter_index_t* disk_index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &disk_index));
+  IREE_ASSERT_OK(parse_fn(disk_handle, disk_index));
+
+  ASSERT_EQ(iree_io_parameter_index_count(memory_index),
+            iree_io_parameter_index_count(disk_index));
+  for (iree_host_size_t i = 0;
+       i < iree_io_parameter_index_count(memory_index); ++i) {
+    const iree_io_parameter_index_entry_t* expected = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_get(memory_index, i, &expected));
+    const iree_io_parameter_index_entry_t* actual = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_get(disk_index, i, &actual));
+    EXPECT_TRUE(iree_string_view_equal(expected->key, actual->key));
+    EXPECT_EQ(expected->metadata.data_length, actual->metadata.data_length);
+    EXPECT_EQ(expected->type, actual->type);
+    EXPECT_EQ(expected->length, actual->length);
+    if (actual->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+      EXPECT_EQ(actual->storage.file.handle, disk_handle);
+      EXPECT_EQ(expected->storage.file.offset, actual->storage.file.offset);
+    }
+  }
+
+  iree_io_parameter_index_release(disk_index);
+  iree_io_parameter_index_release(memory_index);
+  iree_io_file_handle_release(disk_handle);
+}
+
+}  // namespace io
+}  // namespace iree
+
+#endif  // IREE_IO_FORMATS_TESTING_PARSER_TEST_UTIL_H_
@@ -0,0 +1,1130 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_cache.h"
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/io/stream.h"
+
+// Maximum length of the namespace prefix of segment names.
+#define IREE_IO_PARAMETER_CACHE_MAX_NAMESPACE_LENGTH 64
+
+// Size of the bounce buffer used when reading parameters through streams.
+#define IREE_IO_PARAMETER_CACHE_READ_CHUNK_SIZE (4 * 1024 * 1024)
+
+//===----------------------------------------------------------------------===//
+// Content hashing
+//===----------------------------------------------------------------------===//
+
+// 128-bit content hash computed as two independently seeded XXH64 lanes in a
+// single pass over the data. Not cryptographic; the hash is only used to
+// identify identical parameters among cooperating processes.
+
+#define IREE_IO_HASH_PRIME64_1 0x9E3779B185EBCA87ull
+#define IREE_IO_HASH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define IREE_IO_HASH_PRIME64_3 0x165667B19E3779F9ull
+#define IREE_IO_HASH_PRIME64_4 0x85EBCA77C2B2AE63ull
+#define IREE_IO_HASH_PRIME64_5 0x27D4EB2F165667C5ull
+
+static const uint64_t iree_io_hash_seeds[2] = {
+    0x0ull,
+    0x6C62272E07BB0142ull,
+};
+
+typedef struct iree_io_hash_state_t {
+  uint64_t lanes[2][4];
+  uint64_t total_length;
+  uint8_t buffer[32];
+  iree_host_size_t buffer_length;
+} iree_io_hash_state_t;
+
+typedef struct iree_io_hash_t {
+  uint64_t value[2];
+} iree_io_hash_t;
+
+static inline uint64_t iree_io_hash_rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t iree_io_hash_read64(const uint8_t* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline uint32_t iree_io_hash_read32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline uint64_t iree_io_hash_round(uint64_t acc, uint64_t input) {
+  acc += input * IREE_IO_HASH_PRIME64_2;
+  acc = iree_io_hash_rotl64(acc, 31);
+  return acc * IREE_IO_HASH_PRIME64_1;
+}
+
+static inline uint64_t iree_io_hash_merge_round(uint64_t acc, uint64_t value) {
+  acc ^= iree_io_hash_round(0, value);
+  return acc * IREE_IO_HASH_PRIME64_1 + IREE_IO_HASH_PRIME64_4;
+}
+
+static void iree_io_hash_initialize(iree_io_hash_state_t* state) {
+  memset(state, 0, sizeof(*state));
+  for (int i = 0; i < 2; ++i) {
+    const uint64_t seed = iree_io_hash_seeds[i];
+    state->lanes[i][0] = seed + IREE_IO_HASH_PRIME64_1 + IREE_IO_HASH_PRIME64_2;
+    state->lanes[i][1] = seed + IREE_IO_HASH_PRIME64_2;
+    state->lanes[i][2] = seed;
+    state->lanes[i][3] = seed - IREE_IO_HASH_PRIME64_1;
+  }
+}
+
+static inline void iree_io_hash_stripe(iree_io_hash_state_t* state,
+                                       const uint8_t* p) {
+  for (int j = 0; j < 4; ++j) {
+    const uint64_t input = iree_io_hash_read64(p + j * 8);
+    state->lanes[0][j] = iree_io_hash_round(state->lanes[0][j], input);
+    state->lanes[1][j] = iree_io_hash_round(state->lanes[1][j], input);
+  }
+}
+
+static void iree_io_hash_update(iree_io_hash_state_t* state,
+                                const uint8_t* data, iree_host_size_t length) {
+  state->total_length += length;
+  if (state->buffer_length) {
+    const iree_host_size_t fill =
+        iree_min(length, sizeof(state->buffer) - state->buffer_length);
+    memcpy(state->buffer + state->buffer_length, data, fill);
+    state->buffer_length += fill;
+    data += fill;
+    length -= fill;
+    if (state->buffer_length < sizeof(state->buffer)) return;
+    iree_io_hash_stripe(state, state->buffer);
+    state->buffer_length = 0;
+  }
+  while (length >= 32) {
+    iree_io_hash_stripe(state, data);
+    data += 32;
+    length -= 32;
+  }
+  memcpy(state->buffer, data, length);
+  state->buffer_length = length;
+}
+
+static iree_io_hash_t iree_io_hash_finalize(const iree_io_hash_state_t* state) {
+  iree_io_hash_t hash;
+  for (int i = 0; i < 2; ++i) {
+    const uint64_t* v = state->lanes[i];
+    uint64_t h = 0;
+    if (state->total_length >= 32) {
+      h = iree_io_hash_rotl64(v[0], 1) + iree_io_hash_rotl64(v[1], 7) +
+          iree_io_hash_rotl64(v[2], 12) + iree_io_hash_rotl64(v[3], 18);
+      for (int j = 0; j < 4; ++j) h = iree_io_hash_merge_round(h, v[j]);
+    } else {
+      h = iree_io_hash_seeds[i] + IREE_IO_HASH_PRIME64_5;
+    }
+    h += state->total_length;
+    const uint8_t* p = state->buffer;
+    iree_host_size_t remaining = state->buffer_length;
+    for (; remaining >= 8; p += 8, remaining -= 8) {
+      h ^= iree_io_hash_round(0, iree_io_hash_read64(p));
+      h = iree_io_hash_rotl64(h, 27) * IREE_IO_HASH_PRIME64_1 +
+          IREE_IO_HASH_PRIME64_4;
+    }
+    if (remaining >= 4) {
+      h ^= (uint64_t)iree_io_hash_read32(p) * IREE_IO_HASH_PRIME64_1;
+      h = iree_io_hash_rotl64(h, 23) * IREE_IO_HASH_PRIME64_2 +
+          IREE_IO_HASH_PRIME64_3;
+      p += 4;
+      remaining -= 4;
+    }
+    for (; remaining > 0; ++p, --remaining) {
+      h ^= (*p) * IREE_IO_HASH_PRIME64_5;
+      h = iree_io_hash_rotl64(h, 11) * IREE_IO_HASH_PRIME64_1;
+    }
+    h ^= h >> 33;
+    h *= IREE_IO_HASH_PRIME64_2;
+    h ^= h >> 29;
+    h *= IREE_IO_HASH_PRIME64_3;
+    h ^= h >> 32;
+    hash.value[i] = h;
+  }
+  return hash;
+}
+
+//===----------------------------------------------------------------------===//
+// Parameter content access
+//===----------------------------------------------------------------------===//
+
+// Hashes the contents of the file-backed |entry|.
+static iree_status_t iree_io_parameter_cache_hash_entry(
+    const iree_io_parameter_index_entry_t* entry,
+    iree_allocator_t host_allocator, iree_io_hash_t* out_hash) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, entry->length);
+  iree_io_hash_state_t state;
+  iree_io_hash_initialize(&state);
+
+  iree_io_file_handle_t* handle = entry->storage.file.handle;
+  iree_status_t status = iree_ok_status();
+  if (iree_io_file_handle_type(handle) ==
+      IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
+    iree_byte_span_t host_allocation =
+        iree_io_file_handle_value(handle).host_allocation;
+    iree_io_hash_update(&state,
+                        host_allocation.data + entry->storage.file.offset,
+                        (iree_host_size_t)entry->length);
+  } else {
+    iree_io_stream_t* stream = NULL;
+    uint8_t* chunk = NULL;
+    status = iree_io_stream_open(IREE_IO_STREAM_MODE_READABLE, handle,
+                                 entry->storage.file.offset, host_allocator,
+                                 &stream);
+    if (iree_status_is_ok(status)) {
+      status = iree_allocator_malloc(host_allocator,
+                                     IREE_IO_PARAMETER_CACHE_READ_CHUNK_SIZE,
+                                     (void**)&chunk);
+    }
+    for (uint64_t remaining = entry->length;
+         iree_status_is_ok(status) && remaining > 0;) {
+      iree_host_size_t chunk_length = (iree_host_size_t)iree_min(
+          remaining, (uint64_t)IREE_IO_PARAMETER_CACHE_READ_CHUNK_SIZE);
+      status = iree_io_stream_read(stream, chunk_length, chunk, NULL);
+      if (iree_status_is_ok(status)) {
+        iree_io_hash_update(&state, chunk, chunk_length);
+        remaining -= chunk_length;
+      }
+    }
+    iree_allocator_free(host_allocator, chunk);
+    iree_io_stream_release(stream);
+  }
+
+  if (iree_status_is_ok(status)) *out_hash = iree_io_hash_finalize(&state);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Copies the contents of the file-backed |entry| into |target|.
+static iree_status_t iree_io_parameter_cache_copy_entry(
+    const iree_io_parameter_index_entry_t* entry,
+    iree_allocator_t host_allocator, uint8_t* target) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, entry->length);
+
+  iree_io_file_handle_t* handle = entry->storage.file.handle;
+  iree_status_t status = iree_ok_status();
+  if (iree_io_file_handle_type(handle) ==
+      IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
+    iree_byte_span_t host_allocation =
+        iree_io_file_handle_value(handle).host_allocation;
+    memcpy(target, host_allocation.data + entry->storage.file.offset,
+           (iree_host_size_t)entry->length);
+  } else {
+    iree_io_stream_t* stream = NULL;
+    status = iree_io_stream_open(IREE_IO_STREAM_MODE_READABLE, handle,
+                                 entry->storage.file.offset, host_allocator,
+                                 &stream);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_stream_read(stream, (iree_host_size_t)entry->length,
+                                   target, NULL);
+    }
+    iree_io_stream_release(stream);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_cache_t
+//===----------------------------------------------------------------------===//
+
+struct iree_io_parameter_cache_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_io_parameter_cache_flags_t flags;
+  iree_duration_t populate_timeout;
+  iree_string_view_t namespace_name;
+  iree_slim_mutex_t mutex;
+  iree_io_parameter_cache_statistics_t statistics;
+};
+
+// Outcome of resolving a parameter used to update statistics.
+typedef enum iree_io_parameter_cache_result_e {
+  IREE_IO_PARAMETER_CACHE_RESULT_HIT = 0,
+  IREE_IO_PARAMETER_CACHE_RESULT_MISS,
+  IREE_IO_PARAMETER_CACHE_RESULT_ALIAS_HIT,
+} iree_io_parameter_cache_result_t;
+
+static void iree_io_parameter_cache_record(
+    iree_io_parameter_cache_t* cache, iree_io_parameter_cache_result_t result,
+    uint64_t length) {
+  iree_slim_mutex_lock(&cache->mutex);
+  if (result == IREE_IO_PARAMETER_CACHE_RESULT_MISS) {
+    ++cache->statistics.miss_count;
+    cache->statistics.miss_bytes += length;
+  } else {
+    ++cache->statistics.hit_count;
+    cache->statistics.hit_bytes += length;
+    if (result == IREE_IO_PARAMETER_CACHE_RESULT_ALIAS_HIT) {
+      ++cache->statistics.alias_hit_count;
+    }
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+}
+
+// Metadata identifying the version of a file that parameters were loaded from.
+// Files change identity whenever they are modified.
+typedef struct iree_io_parameter_cache_file_identity_t {
+  // False if the file has no stable identity and parameters must be hashed.
+  bool is_valid;
+  // Device, inode, size, and modification time (seconds and nanoseconds).
+  uint64_t fields[5];
+} iree_io_parameter_cache_file_identity_t;
+
+#if defined(IREE_PLATFORM_LINUX)
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Segments are created directly in the POSIX shared memory file system. This
+// is what shm_open does on Linux but avoids the librt dependency on older C
+// libraries.
+#define IREE_IO_PARAMETER_CACHE_SHM_ROOT "/dev/shm/"
+
+#define IREE_IO_PARAMETER_CACHE_SEGMENT_MAGIC 0x32474553434F4949ull  // IIOCSEG2
+#define IREE_IO_PARAMETER_CACHE_ALIAS_MAGIC 0x31534C41434F4949ull    // IIOCALS1
+
+// Maximum length of a segment path including the root and NUL terminator.
+#define IREE_IO_PARAMETER_CACHE_MAX_PATH_LENGTH 128
+
+typedef enum iree_io_parameter_cache_segment_state_e {
+  IREE_IO_PARAMETER_CACHE_SEGMENT_STATE_POPULATING = 0,
+  IREE_IO_PARAMETER_CACHE_SEGMENT_STATE_READY = 1,
+  IREE_IO_PARAMETER_CACHE_SEGMENT_STATE_FAILED = 2,
+} iree_io_parameter_cache_segment_state_t;
+
+// Header at the start of each content segment. The parameter contents follow
+// at the next page boundary so that they can be mapped read-only.
+typedef struct iree_io_parameter_cache_segment_header_t {
+  uint64_t magic;
+  uint64_t length;
+  iree_io_hash_t hash;
+  // iree_io_parameter_cache_segment_state_t.
+  iree_atomic_int32_t state;
+} iree_io_parameter_cache_segment_header_t;
+
+// Contents of an alias segment mapping a file identity to a content segment.
+typedef struct iree_io_parameter_cache_alias_t {
+  uint64_t magic;
+  uint64_t length;
+  iree_io_hash_t hash;
+  // XOR of all other fields; detects aliases that are still being written.
+  uint64_t check;
+} iree_io_parameter_cache_alias_t;
+
+static uint64_t iree_io_parameter_cache_alias_check(
+    const iree_io_parameter_cache_alias_t* alias) {
+  return alias->magic ^ alias->length ^ alias->hash.value[0] ^
+         alias->hash.value[1];
+}
+
+// A mapping of a content segment owned by a file handle.
+typedef struct iree_io_parameter_cache_mapping_t {
+  iree_allocator_t host_allocator;
+  bool persistent;
+  // Segment file descriptor holding a shared lock for the mapping lifetime.
+  int fd;
+  iree_io_parameter_cache_segment_header_t* header;
+  iree_host_size_t header_size;
+  uint8_t* data;
+  iree_host_size_t data_length;
+  iree_io_hash_t hash;
+  char path[IREE_IO_PARAMETER_CACHE_MAX_PATH_LENGTH];
+  // Name prefix of aliases in the cache namespace.
+  char alias_prefix[IREE_IO_PARAMETER_CACHE_MAX_NAMESPACE_LENGTH + 4];
+} iree_io_parameter_cache_mapping_t;
+
+// Returns true if |path| currently names the file open as |fd|.
+static bool iree_io_parameter_cache_fd_matches_path(int fd, const char* path) {
+  struct stat fd_stat, path_stat;
+  return fstat(fd, &fd_stat) == 0 && stat(path, &path_stat) == 0 &&
+         fd_stat.st_dev == path_stat.st_dev &&
+         fd_stat.st_ino == path_stat.st_ino;
+}
+
+static bool iree_io_parameter_cache_read_alias(
+    const char* path, iree_io_parameter_cache_alias_t* out_alias) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+  if (fd == -1) return false;
+  ssize_t read_length = pread(fd, out_alias, sizeof(*out_alias), 0);
+  close(fd);
+  return read_length == (ssize_t)sizeof(*out_alias) &&
+         out_alias->magic == IREE_IO_PARAMETER_CACHE_ALIAS_MAGIC &&
+         out_alias->check == iree_io_parameter_cache_alias_check(out_alias);
+}
+
+// Removes the alias at |path| if it resolves to |hash| and |length|.
+static void iree_io_parameter_cache_remove_alias(const char* path,
+                                                 iree_io_hash_t hash,
+                                                 uint64_t length) {
+  iree_io_parameter_cache_alias_t alias;
+  if (iree_io_parameter_cache_read_alias(path, &alias) &&
+      alias.length == length &&
+      memcmp(&alias.hash, &hash, sizeof(hash)) == 0) {
+    unlink(path);
+  }
+}
+
+// Removes all aliases named with |alias_prefix| that resolve to |hash| and
+// |length|. Segments are removed rarely (when the last process releases them)
+// and namespaces hold aliases only for the files their processes load so a scan
+// is cheaper than tracking the aliases of each segment across processes.
+static void iree_io_parameter_cache_remove_aliases(const char* alias_prefix,
+                                                   iree_io_hash_t hash,
+                                                   uint64_t length) {
+  DIR* dir = opendir(IREE_IO_PARAMETER_CACHE_SHM_ROOT);
+  if (!dir) return;
+  const size_t alias_prefix_length = strlen(alias_prefix);
+  char path[IREE_IO_PARAMETER_CACHE_MAX_PATH_LENGTH];
+  for (struct dirent* dirent = readdir(dir); dirent; dirent = readdir(dir)) {
+    if (strncmp(dirent->d_name, alias_prefix, alias_prefix_length) != 0) {
+      continue;
+    }
+    snprintf(path, sizeof(path), IREE_IO_PARAMETER_CACHE_SHM_ROOT "%s",
+             dirent->d_name);
+    iree_io_parameter_cache_remove_alias(path, hash, length);
+  }
+  closedir(dir);
+}
+
+static void iree_io_parameter_cache_mapping_release(
+    void* user_data, iree_io_file_handle_primitive_t handle_primitive) {
+  iree_io_parameter_cache_mapping_t* mapping =
+      (iree_io_parameter_cache_mapping_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  munmap(mapping->data, mapping->data_length);
+  munmap(mapping->header, mapping->header_size);
+  // Every mapping in every process holds a shared lock on the segment (that the
+  // OS drops if the process exits) so only the last one to release it can
+  // upgrade to an exclusive lock. That process removes a non-persistent segment
+  // and the aliases resolving to it unless the path has since been replaced by
+  // a new segment. Processes mapping the segment concurrently verify it is
+  // still linked once they hold their lock and otherwise create a new one.
+  if (!mapping->persistent && flock(mapping->fd, LOCK_EX | LOCK_NB) == 0 &&
+      iree_io_parameter_cache_fd_matches_path(mapping->fd, mapping->path)) {
+    unlink(mapping->path);
+    iree_io_parameter_cache_remove_aliases(
+        mapping->alias_prefix, mapping->hash, mapping->data_length);
+  }
+  close(mapping->fd);
+  iree_allocator_free(mapping->host_allocator, mapping);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_io_parameter_cache_format_content_path(
+    iree_io_parameter_cache_t* cache, iree_io_hash_t hash, uint64_t length,
+    char* path) {
+  snprintf(path, IREE_IO_PARAMETER_CACHE_MAX_PATH_LENGTH,
+           IREE_IO_PARAMETER_CACHE_SHM_ROOT "%.*s.c.%016" PRIx64 "%016" PRIx64
+                                            ".%" PRIx64,
+           (int)cache->namespace_name.size, cache->namespace_name.data,
+           hash.value[0], hash.value[1], length);
+}
+
+static void iree_io_parameter_cache_format_alias_path(
+    iree_io_parameter_cache_t* cache, iree_io_hash_t identity, char* path) {
+  snprintf(path, IREE_IO_PARAMETER_CACHE_MAX_PATH_LENGTH,
+           IREE_IO_PARAMETER_CACHE_SHM_ROOT "%.*s.a.%016" PRIx64 "%016" PRIx64,
+           (int)cache->namespace_name.size, cache->namespace_name.data,
+           identity.value[0], identity.value[1]);
+}
+
+// Creates a new content segment at |path| and returns its file descriptor.
+// The process populating a segment holds an exclusive lock on it that the OS
+// releases if the process exits before finishing so that waiters can detect
+// abandoned segments. Segments are created and locked under a temporary name
+// and then linked into place so that they are never visible unlocked before
+// they are populated. Returns -1 with errno set to EEXIST if |path| exists.
+static int iree_io_parameter_cache_create_segment(
+    iree_io_parameter_cache_t* cache, const char* path) {
+  static iree_atomic_int32_t next_temp_id = IREE_ATOMIC_VAR_INIT(0);
+  char temp_path[IREE_IO_PARAMETER_CACHE_MAX_PATH_LENGTH];
+  int fd = -1;
+  for (int attempt = 0; attempt < 8 && fd == -1; ++attempt) {
+    snprintf(temp_path, sizeof(temp_path),
+             IREE_IO_PARAMETER_CACHE_SHM_ROOT "%.*s.t.%x.%x",
+             (int)cache->namespace_name.size, cache->namespace_name.data,
+             (unsigned)getpid(),
+             (unsigned)iree_atomic_fetch_add_int32(&next_temp_id, 1,
+                                                   iree_memory_order_relaxed));
+    fd = open(temp_path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW,
+              0600);
+    if (fd == -1 && errno != EEXIST) return -1;
+  }
+  if (fd == -1) return -1;
+  int result = flock(fd, LOCK_EX | LOCK_NB);
+  if (result == 0) result = link(temp_path, path);
+  const int link_errno = errno;
+  unlink(temp_path);
+  if (result == -1) {
+    close(fd);
+    errno = link_errno;
+    return -1;
+  }
+  return fd;
+}
+
+// Returns true if a process is populating the content segment on |fd|. Locks
+// that can't be queried are conservatively assumed to be held.
+static bool iree_io_parameter_cache_is_populating(int fd) {
+  if (flock(fd, LOCK_SH | LOCK_NB) == -1) return true;
+  flock(fd, LOCK_UN);
+  return false;
+}
+
+// Removes the content segment at |path| opened as |fd| if its populator exited
+// before finishing it. Other processes may have already replaced it.
+static void iree_io_parameter_cache_remove_abandoned_segment(int fd,
+                                                             const char* path) {
+  // Holding the lock keeps other processes from removing the segment
+  // concurrently and the identity check keeps us from removing a replacement.
+  if (flock(fd, LOCK_EX | LOCK_NB) == -1) return;
+  if (iree_io_parameter_cache_fd_matches_path(fd, path)) unlink(path);
+  flock(fd, LOCK_UN);
+}
+
+// Sleeps briefly while waiting on another process. Returns false if |deadline|
+// has elapsed.
+static bool iree_io_parameter_cache_backoff(iree_time_t deadline_ns) {
+  if (iree_time_now() >= deadline_ns) return false;
+  iree_wait_until(iree_time_now() + 1000000ll);  // 1ms
+  return true;
+}
+
+// Maps the content segment at |path| from |fd| and takes a shared lock on it.
+// Waits until the segment has been populated by its creator. If |is_locked|
+// the caller already holds a shared lock on |fd|. The mapping takes ownership
+// of |fd| on success. Returns IREE_STATUS_ABORTED if the creator exited before
+// populating it or the segment was removed before the lock was taken.
+static iree_status_t iree_io_parameter_cache_map_segment(
+    iree_io_parameter_cache_t* cache, int fd, const char* path,
+    iree_io_hash_t hash, uint64_t length, bool is_locked,
+    iree_io_parameter_cache_mapping_t** out_mapping) {
+  *out_mapping = NULL;
+  const iree_host_size_t header_size = (iree_host_size_t)sysconf(_SC_PAGESIZE);
+  const iree_time_t deadline_ns =
+      iree_relative_timeout_to_deadline_ns(cache->populate_timeout);
+
+  // Wait for the creator to size the segment; mapping it before then would
+  // fault on access. Creators size segments before releasing their lock so one
+  // more check after finding the lock released determines whether they exited.
+  bool is_populating = true;
+  struct stat segment_stat;
+  for (;;) {
+    if (fstat(fd, &segment_stat) == -1) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "unable to stat cache segment '%s'", path);
+    }
+    if ((uint64_t)segment_stat.st_size == header_size + length) break;
+    if (segment_stat.st_size != 0) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "cache segment '%s' has an unexpected size",
+                              path);
+    }
+    if (!is_populating) {
+      return iree_make_status(IREE_STATUS_ABORTED,
+                              "cache segment '%s' was abandoned", path);
+    }
+    is_populating = iree_io_parameter_cache_is_populating(fd);
+    if (is_populating && !iree_io_parameter_cache_backoff(deadline_ns)) {
+      return iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED,
+                              "timed out waiting on cache segment '%s'", path);
+    }
+  }
+
+  iree_io_parameter_cache_mapping_t* mapping = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      cache->host_allocator, sizeof(*mapping), (void**)&mapping));
+  mapping->host_allocator = cache->host_allocator;
+  mapping->persistent =
+      iree_all_bits_set(cache->flags, IREE_IO_PARAMETER_CACHE_FLAG_PERSISTENT);
+  mapping->fd = fd;
+  mapping->header_size = header_size;
+  mapping->data_length = (iree_host_size_t)length;
+  mapping->hash = hash;
+  iree_string_view_to_cstring(iree_make_cstring_view(path), mapping->path,
+                              sizeof(mapping->path));
+  snprintf(mapping->alias_prefix, sizeof(mapping->alias_prefix), "%.*s.a.",
+           (int)cache->namespace_name.size, cache->namespace_name.data);
+
+  iree_status_t status = iree_ok_status();
+  void* header = mmap(NULL, header_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd, 0);
+  void* data = header != MAP_FAILED
+                   ? mmap(NULL, mapping->data_length, PROT_READ, MAP_SHARED,
+                          fd, (off_t)header_size)
+                   : MAP_FAILED;
+  if (header == MAP_FAILED || data == MAP_FAILED) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "unable to map cache segment '%s'", path);
+    if (header != MAP_FAILED) munmap(header, header_size);
+  } else {
+    mapping->header = (iree_io_parameter_cache_segment_header_t*)header;
+    mapping->data = (uint8_t*)data;
+  }
+
+  // Wait for the creator to finish populating the segment.
+  is_populating = true;
+  while (iree_status_is_ok(status)) {
+    int32_t state = iree_atomic_load_int32(&mapping->header->state,
+                                           iree_memory_order_acquire);
+    if (state == IREE_IO_PARAMETER_CACHE_SEGMENT_STATE_READY) {
+      break;
+    } else if (state == IREE_IO_PARAMETER_CACHE_SEGMENT_STATE_FAILED) {
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "cache segment '%s' failed to populate", path);
+    } else if (!is_populating) {
+      status = iree_make_status(IREE_STATUS_ABORTED,
+                                "cache segment '%s' was abandoned", path);
+    } else {
+      is_populating = iree_io_parameter_cache_is_populating(fd);
+      if (is_populating && !iree_io_parameter_cache_backoff(deadline_ns)) {
+        status = iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED,
+                                  "timed out waiting on cache segment '%s'",
+                                  path);
+      }
+    }
+  }
+  if (iree_status_is_ok(status) &&
+      (mapping->header->magic != IREE_IO_PARAMETER_CACHE_SEGMENT_MAGIC ||
+       mapping->header->length != length ||
+       memcmp(&mapping->header->hash, &hash, sizeof(hash)) != 0)) {
+    status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "cache segment '%s' does not match its name",
+                              path);
+  }
+
+
+  // Lock the segment for the lifetime of the mapping. A process releasing the
+  // last other mapping may have removed the segment before we took the lock in
+  // which case the caller must retry with a new segment.
+  bool is_locked_here = false;
+  while (iree_status_is_ok(status) && !is_locked) {
+    if (flock(fd, LOCK_SH | LOCK_NB) == 0) {
+      is_locked = is_locked_here = true;
+    } else if (!iree_io_parameter_cache_backoff(deadline_ns)) {
+      status = iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED,
+                                "timed out locking cache segment '%s'", path);
+    }
+  }
+  if (iree_status_is_ok(status) &&
+      !iree_io_parameter_cache_fd_matches_path(fd, path)) {
+    status = iree_make_status(IREE_STATUS_ABORTED,
+                              "cache segment '%s' was removed", path);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_mapping = mapping;
+  } else {
+    if (is_locked_here) flock(fd, LOCK_UN);
+    if (mapping->data) munmap(mapping->data, mapping->data_length);
+    if (mapping->header) munmap(mapping->header, header_size);
+    iree_allocator_free(cache->host_allocator, mapping);
+  }
+  return status;
+}
+
+// Populates the newly created content segment at |path| on |fd| from |entry|.
+static iree_status_t iree_io_parameter_cache_populate_segment(
+    iree_io_parameter_cache_t* cache, int fd, const char* path,
+    const iree_io_parameter_index_entry_t* entry, iree_io_hash_t hash) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, entry->length);
+  const iree_host_size_t header_size = (iree_host_size_t)sysconf(_SC_PAGESIZE);
+  const iree_host_size_t total_size =
+      header_size + (iree_host_size_t)entry->length;
+
+  if (ftruncate(fd, (off_t)total_size) == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to size cache segment '%s' to %" PRIhsz
+                            " bytes",
+                            path, total_size);
+  }
+  uint8_t* base = (uint8_t*)mmap(NULL, total_size, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED, fd, 0);
+  if ((void*)base == MAP_FAILED) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to map cache segment '%s'", path);
+  }
+
+  iree_io_parameter_cache_segment_header_t* header =
+      (iree_io_parameter_cache_segment_header_t*)base;
+  header->magic = IREE_IO_PARAMETER_CACHE_SEGMENT_MAGIC;
+  header->length = entry->length;
+  header->hash = hash;
+  iree_status_t status = iree_io_parameter_cache_copy_entry(
+      entry, cache->host_allocator, base + header_size);
+  iree_atomic_store_int32(&header->state,
+                          iree_status_is_ok(status)
+                              ? IREE_IO_PARAMETER_CACHE_SEGMENT_STATE_READY
+                              : IREE_IO_PARAMETER_CACHE_SEGMENT_STATE_FAILED,
+                          iree_memory_order_release);
+  munmap(base, total_size);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Resolves the content segment for |hash| and |length|. If |entry| is provided
+// the segment is created and populated from it when not already cached and
+// otherwise IREE_STATUS_NOT_FOUND is returned. Segments abandoned by processes
+// that exited while populating them are removed and (with |entry|) replaced.
+static iree_status_t iree_io_parameter_cache_resolve_segment(
+    iree_io_parameter_cache_t* cache,
+    const iree_io_parameter_index_entry_t* entry, iree_io_hash_t hash,
+    uint64_t length, iree_io_parameter_cache_mapping_t** out_mapping,
+    bool* out_created) {
+  *out_mapping = NULL;
+  *out_created = false;
+  char path[IREE_IO_PARAMETER_CACHE_MAX_PATH_LENGTH];
+  iree_io_parameter_cache_format_content_path(cache, hash, length, path);
+
+  const int open_flags = O_RDWR | O_CLOEXEC | O_NOFOLLOW;
+  // Retry as segments may be removed between our create and open attempts.
+  for (int attempt = 0; attempt < 8; ++attempt) {
+    int fd = -1;
+    bool created = false;
+    if (entry) {
+      fd = iree_io_parameter_cache_create_segment(cache, path);
+      if (fd != -1) {
+        created = true;
+      } else if (errno != EEXIST) {
+        return iree_make_status(iree_status_code_from_errno(errno),
+                                "unable to create cache segment '%s'", path);
+      }
+    }
+    if (fd == -1) {
+      fd = open(path, open_flags);
+      if (fd == -1 && errno == ENOENT && entry) continue;
+      if (fd == -1) {
+        return iree_make_status(iree_status_code_from_errno(errno),
+                                "unable to open cache segment '%s'", path);
+      }
+    }
+
+    iree_status_t status = iree_ok_status();
+    if (created) {
+      status = iree_io_parameter_cache_populate_segment(cache, fd, path, entry,
+                                                        hash);
+      // Remove failed segments so that other processes don't wait on them.
+      // Populated segments are downgraded to the shared lock of the mapping.
+      if (!iree_status_is_ok(status)) unlink(path);
+      flock(fd, iree_status_is_ok(status) ? LOCK_SH : LOCK_UN);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parameter_cache_map_segment(
+          cache, fd, path, hash, length, /*is_locked=*/created, out_mapping);
+    }
+    if (iree_status_is_aborted(status)) {
+      if (created) flock(fd, LOCK_UN);
+      iree_io_parameter_cache_remove_abandoned_segment(fd, path);
+    }
+    if (!iree_status_is_ok(status)) close(fd);
+
+    if (iree_status_is_aborted(status) && entry) {
+      status = iree_status_ignore(status);
+      continue;
+    }
+    if (iree_status_is_ok(status)) *out_created = created;
+    return status;
+  }
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "cache segment '%s' is being concurrently removed",
+                          path);
+}
+
+static void iree_io_parameter_cache_identity_from_stat(
+    const struct stat* file_stat,
+    iree_io_parameter_cache_file_identity_t* out_identity) {
+  out_identity->is_valid = S_ISREG(file_stat->st_mode);
+  out_identity->fields[0] = (uint64_t)file_stat->st_dev;
+  out_identity->fields[1] = (uint64_t)file_stat->st_ino;
+  out_identity->fields[2] = (uint64_t)file_stat->st_size;
+  out_identity->fields[3] = (uint64_t)file_stat->st_mtim.tv_sec;
+  out_identity->fields[4] = (uint64_t)file_stat->st_mtim.tv_nsec;
+}
+
+// Identifies the file at |path|. Files that can't be identified get an
+// invalid identity.
+static void iree_io_parameter_cache_identify_path(
+    iree_string_view_t path,
+    iree_io_parameter_cache_file_identity_t* out_identity) {
+  memset(out_identity, 0, sizeof(*out_identity));
+  char path_str[2048];
+  if (path.size >= sizeof(path_str)) return;
+  iree_string_view_to_cstring(path, path_str, sizeof(path_str));
+  struct stat file_stat;
+  if (stat(path_str, &file_stat) == -1) return;
+  iree_io_parameter_cache_identity_from_stat(&file_stat, out_identity);
+}
+
+// Identifies the file behind |handle| if it is a file descriptor. Other handles
+// get an invalid identity.
+static void iree_io_parameter_cache_identify_handle(
+    iree_io_file_handle_t* handle,
+    iree_io_parameter_cache_file_identity_t* out_identity) {
+  memset(out_identity, 0, sizeof(*out_identity));
+  if (iree_io_file_handle_type(handle) != IREE_IO_FILE_HANDLE_TYPE_FD) return;
+  struct stat file_stat;
+  if (fstat(iree_io_file_handle_value(handle).fd, &file_stat) == -1) return;
+  iree_io_parameter_cache_identity_from_stat(&file_stat, out_identity);
+}
+
+// Computes the identity of the file-backed |entry| from the identity of the
+// file it references. Returns false if the file has no stable identity.
+static bool iree_io_parameter_cache_identify_entry(
+    const iree_io_parameter_index_entry_t* entry,
+    const iree_io_parameter_cache_file_identity_t* file_identity,
+    iree_io_hash_t* out_identity) {
+  if (!file_identity->is_valid) return false;
+  const uint64_t fields[] = {
+      file_identity->fields[0],  file_identity->fields[1],
+      file_identity->fields[2],  file_identity->fields[3],
+      file_identity->fields[4],  entry->storage.file.offset,
+      entry->length,
+  };
+  iree_io_hash_state_t state;
+  iree_io_hash_initialize(&state);
+  iree_io_hash_update(&state, (const uint8_t*)fields, sizeof(fields));
+  *out_identity = iree_io_hash_finalize(&state);
+  return true;
+}
+
+static void iree_io_parameter_cache_write_alias(const char* path,
+                                                iree_io_hash_t hash,
+                                                uint64_t length) {
+  iree_io_parameter_cache_alias_t alias = {
+      .magic = IREE_IO_PARAMETER_CACHE_ALIAS_MAGIC,
+      .length = length,
+      .hash = hash,
+  };
+  alias.check = iree_io_parameter_cache_alias_check(&alias);
+  // Aliases are immutable: the identity changes whenever the file does. If
+  // another process already wrote it there's nothing to do.
+  int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW,
+                0600);
+  if (fd == -1) return;
+  if (pwrite(fd, &alias, sizeof(alias), 0) != (ssize_t)sizeof(alias)) {
+    unlink(path);
+  }
+  close(fd);
+}
+
+static iree_status_t iree_io_parameter_cache_lookup_mapping(
+    iree_io_parameter_cache_t* cache,
+    const iree_io_parameter_index_entry_t* entry,
+    const iree_io_parameter_cache_file_identity_t* file_identity,
+    iree_io_parameter_cache_mapping_t** out_mapping) {
+  // Fast path: processes that have already cached the file recorded where its
+  // contents live and we can map them without touching the file.
+  iree_io_hash_t identity;
+  const bool has_identity =
+      iree_io_parameter_cache_identify_entry(entry, file_identity, &identity);
+  char alias_path[IREE_IO_PARAMETER_CACHE_MAX_PATH_LENGTH];
+  if (has_identity) {
+    iree_io_parameter_cache_format_alias_path(cache, identity, alias_path);
+  }
+  iree_io_parameter_cache_alias_t alias;
+  if (has_identity &&
+      iree_io_parameter_cache_read_alias(alias_path, &alias) &&
+      alias.length == entry->length) {
+    bool created = false;
+    iree_status_t status = iree_io_parameter_cache_resolve_segment(
+        cache, /*entry=*/NULL, alias.hash, alias.length, out_mapping, &created);
+    if (iree_status_is_ok(status)) {
+      iree_io_parameter_cache_record(
+          cache, IREE_IO_PARAMETER_CACHE_RESULT_ALIAS_HIT, entry->length);
+      return status;
+    }
+    // The content was removed since the alias was written (such as by a
+    // process that exited while we were reading the alias). Remove the stale
+    // alias so that it is replaced below.
+    if (iree_status_is_not_found(status)) {
+      iree_io_parameter_cache_remove_alias(alias_path, alias.hash,
+                                           alias.length);
+    }
+    iree_status_ignore(status);
+  }
+
+  // Slow path: hash the contents and find or create the segment.
+  iree_io_hash_t hash;
+  IREE_RETURN_IF_ERROR(
+      iree_io_parameter_cache_hash_entry(entry, cache->host_allocator, &hash));
+  bool created = false;
+  IREE_RETURN_IF_ERROR(iree_io_parameter_cache_resolve_segment(
+      cache, entry, hash, entry->length, out_mapping, &created));
+  iree_io_parameter_cache_record(cache,
+                                 created ? IREE_IO_PARAMETER_CACHE_RESULT_MISS
+                                         : IREE_IO_PARAMETER_CACHE_RESULT_HIT,
+                                 entry->length);
+  if (has_identity) {
+    iree_io_parameter_cache_write_alias(alias_path, hash, entry->length);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_io_parameter_cache_check_platform(void) {
+  return iree_ok_status();
+}
+
+#else
+
+typedef struct iree_io_parameter_cache_mapping_t {
+  uint8_t* data;
+  iree_host_size_t data_length;
+} iree_io_parameter_cache_mapping_t;
+
+static void iree_io_parameter_cache_mapping_release(
+    void* user_data, iree_io_file_handle_primitive_t handle_primitive) {}
+
+static void iree_io_parameter_cache_identify_path(
+    iree_string_view_t path,
+    iree_io_parameter_cache_file_identity_t* out_identity) {
+  memset(out_identity, 0, sizeof(*out_identity));
+}
+
+static void iree_io_parameter_cache_identify_handle(
+    iree_io_file_handle_t* handle,
+    iree_io_parameter_cache_file_identity_t* out_identity) {
+  memset(out_identity, 0, sizeof(*out_identity));
+}
+
+static iree_status_t iree_io_parameter_cache_lookup_mapping(
+    iree_io_parameter_cache_t* cache,
+    const iree_io_parameter_index_entry_t* entry,
+    const iree_io_parameter_cache_file_identity_t* file_identity,
+    iree_io_parameter_cache_mapping_t** out_mapping) {
+  *out_mapping = NULL;
+  return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+}
+
+static iree_status_t iree_io_parameter_cache_check_platform(void) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared parameter caches are not supported on this "
+                          "platform");
+}
+
+#endif  // IREE_PLATFORM_LINUX
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_cache_create(
+    iree_io_parameter_cache_options_t options, iree_allocator_t host_allocator,
+    iree_io_parameter_cache_t** out_cache) {
+  IREE_ASSERT_ARGUMENT(out_cache);
+  *out_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0,
+                                    iree_io_parameter_cache_check_platform());
+
+  iree_string_view_t namespace_name = options.namespace_name;
+  if (iree_string_view_is_empty(namespace_name)) {
+    namespace_name =
+        iree_make_cstring_view(IREE_IO_PARAMETER_CACHE_DEFAULT_NAMESPACE);
+  }
+  if (namespace_name.size > IREE_IO_PARAMETER_CACHE_MAX_NAMESPACE_LENGTH ||
+      iree_string_view_find_char(namespace_name, '/', 0) !=
+          IREE_STRING_VIEW_NPOS) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "parameter cache namespace '%.*s' must be at most "
+                            "%d characters and not contain '/'",
+                            (int)namespace_name.size, namespace_name.data,
+                            IREE_IO_PARAMETER_CACHE_MAX_NAMESPACE_LENGTH);
+  }
+
+  iree_io_parameter_cache_t* cache = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator,
+                                sizeof(*cache) + namespace_name.size,
+                                (void**)&cache));
+  iree_atomic_ref_count_init(&cache->ref_count);
+  cache->host_allocator = host_allocator;
+  cache->flags = options.flags;
+  cache->populate_timeout = options.populate_timeout;
+  cache->namespace_name = iree_make_string_view(
+      (const char*)cache + sizeof(*cache), namespace_name.size);
+  memcpy((void*)cache->namespace_name.data, namespace_name.data,
+         namespace_name.size);
+  iree_slim_mutex_initialize(&cache->mutex);
+
+  *out_cache = cache;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_io_parameter_cache_destroy(iree_io_parameter_cache_t* cache) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = cache->host_allocator;
+  iree_slim_mutex_deinitialize(&cache->mutex);
+  iree_allocator_free(host_allocator, cache);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_io_parameter_cache_retain(
+    iree_io_parameter_cache_t* cache) {
+  if (IREE_LIKELY(cache)) {
+    iree_atomic_ref_count_inc(&cache->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_io_parameter_cache_release(
+    iree_io_parameter_cache_t* cache) {
+  if (IREE_LIKELY(cache) &&
+      iree_atomic_ref_count_dec(&cache->ref_count) == 1) {
+    iree_io_parameter_cache_destroy(cache);
+  }
+}
+
+// Looks up |entry| using |file_identity| to identify the file it references.
+static iree_status_t iree_io_parameter_cache_lookup_entry(
+    iree_io_parameter_cache_t* cache,
+    const iree_io_parameter_index_entry_t* entry,
+    const iree_io_parameter_cache_file_identity_t* file_identity,
+    iree_io_file_handle_t** out_handle) {
+  *out_handle = NULL;
+  if (entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "only file-backed parameters can be cached");
+  }
+  if (entry->length == 0 || entry->length > IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parameter `%.*s` length %" PRIu64
+                            " cannot be cached",
+                            (int)entry->key.size, entry->key.data,
+                            entry->length);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, entry->key.data, entry->key.size);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, entry->length);
+
+  iree_io_parameter_cache_mapping_t* mapping = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_cache_lookup_mapping(cache, entry, file_identity,
+                                                 &mapping));
+
+  iree_io_file_handle_release_callback_t release_callback = {
+      .fn = iree_io_parameter_cache_mapping_release,
+      .user_data = mapping,
+  };
+  iree_status_t status = iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(mapping->data, mapping->data_length),
+      release_callback, cache->host_allocator, out_handle);
+  if (!iree_status_is_ok(status)) {
+    iree_io_parameter_cache_mapping_release(
+        mapping, (iree_io_file_handle_primitive_t){0});
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_cache_lookup(
+    iree_io_parameter_cache_t* cache,
+    const iree_io_parameter_index_entry_t* entry,
+    iree_io_file_handle_t** out_handle) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(entry);
+  IREE_ASSERT_ARGUMENT(out_handle);
+  *out_handle = NULL;
+  iree_io_parameter_cache_file_identity_t file_identity;
+  memset(&file_identity, 0, sizeof(file_identity));
+  if (entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+    iree_io_parameter_cache_identify_handle(entry->storage.file.handle,
+                                            &file_identity);
+  }
+  return iree_io_parameter_cache_lookup_entry(cache, entry, &file_identity,
+                                              out_handle);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_cache_share_index(
+    iree_io_parameter_cache_t* cache, iree_string_view_t source_path,
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(source_index);
+  IREE_ASSERT_ARGUMENT(target_index);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The file is only identified once for all of its entries.
+  iree_io_parameter_cache_file_identity_t path_identity;
+  memset(&path_identity, 0, sizeof(path_identity));
+  if (!iree_string_view_is_empty(source_path)) {
+    iree_io_parameter_cache_identify_path(source_path, &path_identity);
+  }
+
+  const iree_host_size_t count = iree_io_parameter_index_count(source_index);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_index_reserve(
+              target_index, iree_io_parameter_index_count(target_index) + count));
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < count && iree_status_is_ok(status); ++i) {
+    const iree_io_parameter_index_entry_t* source_entry = NULL;
+    status = iree_io_parameter_index_get(source_index, i, &source_entry);
+    if (!iree_status_is_ok(status)) break;
+
+    iree_io_file_handle_t* cached_handle = NULL;
+    if (source_entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE &&
+        source_entry->length > 0) {
+      // File descriptors identify themselves and anything else (such as
+      // files read or mapped into memory) uses the identity of the path.
+      iree_io_parameter_cache_file_identity_t file_identity;
+      iree_io_parameter_cache_identify_handle(source_entry->storage.file.handle,
+                                              &file_identity);
+      if (!file_identity.is_valid) file_identity = path_identity;
+      status = iree_io_parameter_cache_lookup_entry(
+          cache, source_entry, &file_identity, &cached_handle);
+      if (iree_status_is_unavailable(status) ||
+          iree_status_is_deadline_exceeded(status)) {
+        // Another process holds or abandoned the segment; use the original.
+        status = iree_status_ignore(status);
+      }
+    }
+    if (!iree_status_is_ok(status)) break;
+
+    iree_io_parameter_index_entry_t target_entry = *source_entry;
+    if (cached_handle) {
+      target_entry.storage.file.handle = cached_handle;
+      target_entry.storage.file.offset = 0;
+    }
+    status = iree_io_parameter_index_add(target_index, &target_entry);
+    iree_io_file_handle_release(cached_handle);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_io_parameter_cache_query_statistics(
+    iree_io_parameter_cache_t* cache,
+    iree_io_parameter_cache_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_slim_mutex_lock(&cache->mutex);
+  *out_statistics = cache->statistics;
+  iree_slim_mutex_unlock(&cache->mutex);
+}
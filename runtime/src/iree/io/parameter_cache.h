@@ -0,0 +1,149 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARAMETER_CACHE_H_
+#define IREE_IO_PARAMETER_CACHE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/io/file_handle.h"
+#include "iree/io/parameter_index.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_cache_t
+//===----------------------------------------------------------------------===//
+
+// Default namespace of cache segments when none is specified.
+#define IREE_IO_PARAMETER_CACHE_DEFAULT_NAMESPACE "iree"
+
+enum iree_io_parameter_cache_flag_bits_t {
+  IREE_IO_PARAMETER_CACHE_FLAG_NONE = 0u,
+  // Keeps cached parameters in shared memory after the last process using them
+  // releases them so that future processes start warm. Segments persist until
+  // removed (such as by deleting them from /dev/shm/) or the host reboots.
+  IREE_IO_PARAMETER_CACHE_FLAG_PERSISTENT = 1u << 0,
+};
+typedef uint32_t iree_io_parameter_cache_flags_t;
+
+typedef struct iree_io_parameter_cache_options_t {
+  // Namespace used to prefix all shared memory segment names. Processes only
+  // share parameters with other processes using the same namespace.
+  // Defaults to IREE_IO_PARAMETER_CACHE_DEFAULT_NAMESPACE if empty.
+  iree_string_view_t namespace_name;
+  // Flags controlling cache behavior.
+  iree_io_parameter_cache_flags_t flags;
+  // Maximum time to wait for another process to finish populating a parameter
+  // before falling back to a private copy.
+  iree_duration_t populate_timeout;
+} iree_io_parameter_cache_options_t;
+
+// Returns default cache options.
+static inline iree_io_parameter_cache_options_t
+iree_io_parameter_cache_options_default(void) {
+  iree_io_parameter_cache_options_t options = {
+      iree_make_cstring_view(IREE_IO_PARAMETER_CACHE_DEFAULT_NAMESPACE),
+      IREE_IO_PARAMETER_CACHE_FLAG_NONE,
+      60 * 1000000000ll,  // 60s
+  };
+  return options;
+}
+
+typedef struct iree_io_parameter_cache_statistics_t {
+  // Parameters resolved to an existing shared segment.
+  uint64_t hit_count;
+  // Parameters copied into a new shared segment by this process.
+  uint64_t miss_count;
+  // Hits resolved from the file identity alone without reading the file.
+  uint64_t alias_hit_count;
+  // Bytes served from existing shared segments.
+  uint64_t hit_bytes;
+  // Bytes copied into new shared segments by this process.
+  uint64_t miss_bytes;
+} iree_io_parameter_cache_statistics_t;
+
+// A cross-process cache of parameter contents in named shared memory.
+//
+// Parameters are keyed by a 128-bit hash of their contents and stored once per
+// host in a shared memory segment regardless of how many processes or files
+// reference them. Each mapping of a segment holds a shared lock on it that the
+// OS releases if the process exits and (unless persistent) segments are removed
+// along with the aliases that led to them when the last process releases them.
+//
+// Parameters backed by file descriptors or shared from a known file path
+// additionally record an alias from the file identity (device, inode, size,
+// modification time) and parameter range to the content hash so that
+// processes starting while the parameter is cached only need a lookup and
+// never read the file.
+//
+// Files that are memory mapped already share their pages across processes
+// through the page cache and should not be cached: the cache is intended for
+// parameters that otherwise require a private copy in each process (preloaded,
+// heap allocated, or converted contents).
+//
+// Processes populating a parameter hold a lock on its segment that is released
+// if they exit early; processes waiting on the parameter then remove the
+// abandoned segment and populate it themselves.
+//
+// Only supported on Linux; other platforms fail creation with
+// IREE_STATUS_UNAVAILABLE. Segments are created with owner-only permissions
+// and the content hash is not cryptographic: processes sharing a namespace
+// must trust each other.
+//
+// Thread-safe.
+typedef struct iree_io_parameter_cache_t iree_io_parameter_cache_t;
+
+// Creates a parameter cache with the given |options|.
+IREE_API_EXPORT iree_status_t iree_io_parameter_cache_create(
+    iree_io_parameter_cache_options_t options, iree_allocator_t host_allocator,
+    iree_io_parameter_cache_t** out_cache);
+
+// Retains the given |cache| for the caller.
+IREE_API_EXPORT void iree_io_parameter_cache_retain(
+    iree_io_parameter_cache_t* cache);
+
+// Releases the given |cache| from the caller. File handles returned from the
+// cache remain valid after the cache is released.
+IREE_API_EXPORT void iree_io_parameter_cache_release(
+    iree_io_parameter_cache_t* cache);
+
+// Resolves the contents of the file-backed |entry| to a read-only host
+// allocation file handle over shared memory containing just the parameter
+// (offset 0, length |entry->length|). The handle keeps the shared segment
+// referenced until released.
+IREE_API_EXPORT iree_status_t iree_io_parameter_cache_lookup(
+    iree_io_parameter_cache_t* cache,
+    const iree_io_parameter_index_entry_t* entry,
+    iree_io_file_handle_t** out_handle);
+
+// Adds all entries of |source_index| to |target_index| with the storage of
+// file-backed entries redirected to the shared cache. Splat entries are added
+// unchanged. Entries that cannot be shared (such as when another process
+// failed to populate them in time) are added unchanged as well.
+//
+// |source_path| optionally names the file the entries were loaded from. When
+// provided entries backed by host allocations (such as preloaded files) are
+// identified by the path so that cached parameters resolve without reading the
+// allocation. The allocation contents must match the file contents.
+IREE_API_EXPORT iree_status_t iree_io_parameter_cache_share_index(
+    iree_io_parameter_cache_t* cache, iree_string_view_t source_path,
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index);
+
+// Returns the statistics of lookups performed through |cache|.
+IREE_API_EXPORT void iree_io_parameter_cache_query_statistics(
+    iree_io_parameter_cache_t* cache,
+    iree_io_parameter_cache_statistics_t* out_statistics);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARAMETER_CACHE_H_
@@ -0,0 +1,497 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_cache.h"
+
+#include "iree/base/api.h"
+
+#if defined(IREE_PLATFORM_LINUX)
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "iree/base/internal/file_io.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+class ParameterCacheTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kParameterSize = 64 * 1024 + 7;
+
+  void SetUp() override {
+    std::random_device d;
+    char unique_name[64];
+    snprintf(unique_name, sizeof(unique_name), "iree_test_%08x%08x", d(), d());
+    namespace_ = unique_name;
+
+    // Parameters 0 and 2 have identical contents.
+    contents_.resize(3 * kParameterSize);
+    for (size_t i = 0; i < kParameterSize; ++i) {
+      contents_[i] = static_cast<uint8_t>(i * 7);
+      contents_[kParameterSize + i] = static_cast<uint8_t>(i * 13 + 1);
+      contents_[2 * kParameterSize + i] = static_cast<uint8_t>(i * 7);
+    }
+  }
+
+  void TearDown() override {
+    // Remove any segments left behind.
+    if (DIR* dir = opendir("/dev/shm")) {
+      while (struct dirent* dirent = readdir(dir)) {
+        if (strncmp(dirent->d_name, namespace_.c_str(), namespace_.size()) ==
+            0) {
+          unlink(("/dev/shm/" + std::string(dirent->d_name)).c_str());
+        }
+      }
+      closedir(dir);
+    }
+  }
+
+  // Returns the paths of all segments in the test namespace.
+  std::vector<std::string> ListSegments(const char* kind) {
+    std::string prefix = namespace_ + "." + kind + ".";
+    std::vector<std::string> paths;
+    if (DIR* dir = opendir("/dev/shm")) {
+      while (struct dirent* dirent = readdir(dir)) {
+        if (strncmp(dirent->d_name, prefix.c_str(), prefix.size()) == 0) {
+          paths.push_back("/dev/shm/" + std::string(dirent->d_name));
+        }
+      }
+      closedir(dir);
+    }
+    return paths;
+  }
+
+  // Returns the number of segments in the test namespace.
+  int CountSegments(const char* kind) {
+    return static_cast<int>(ListSegments(kind).size());
+  }
+
+  iree_io_parameter_cache_t* CreateCache(
+      iree_io_parameter_cache_flags_t flags = IREE_IO_PARAMETER_CACHE_FLAG_NONE,
+      iree_duration_t populate_timeout = 60 * 1000000000ll) {
+    iree_io_parameter_cache_options_t options =
+        iree_io_parameter_cache_options_default();
+    options.namespace_name =
+        iree_make_string_view(namespace_.data(), namespace_.size());
+    options.flags = flags;
+    options.populate_timeout = populate_timeout;
+    iree_io_parameter_cache_t* cache = NULL;
+    IREE_CHECK_OK(
+        iree_io_parameter_cache_create(options, iree_allocator_system(), &cache));
+    return cache;
+  }
+
+  // Creates an index with one entry per parameter in |handle|.
+  iree_io_parameter_index_t* CreateIndex(iree_io_file_handle_t* handle) {
+    iree_io_parameter_index_t* index = NULL;
+    IREE_CHECK_OK(
+        iree_io_parameter_index_create(iree_allocator_system(), &index));
+    for (int i = 0; i < 3; ++i) {
+      std::string key = "p" + std::to_string(i);
+      iree_io_parameter_index_entry_t entry = {};
+      entry.key = iree_make_string_view(key.data(), key.size());
+      entry.length = kParameterSize;
+      entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+      entry.storage.file.handle = handle;
+      entry.storage.file.offset = i * kParameterSize;
+      IREE_CHECK_OK(iree_io_parameter_index_add(index, &entry));
+    }
+    return index;
+  }
+
+  iree_io_parameter_index_t* ShareIndex(
+      iree_io_parameter_cache_t* cache, iree_io_parameter_index_t* source,
+      iree_string_view_t source_path = iree_string_view_empty()) {
+    iree_io_parameter_index_t* target = NULL;
+    IREE_CHECK_OK(
+        iree_io_parameter_index_create(iree_allocator_system(), &target));
+    IREE_CHECK_OK(iree_io_parameter_cache_share_index(cache, source_path,
+                                                      source, target));
+    return target;
+  }
+
+  // Writes the parameter contents to a temporary file and returns its path.
+  std::string WriteFile() {
+    const char* tmpdir = getenv("TEST_TMPDIR");
+    if (!tmpdir) tmpdir = getenv("TMPDIR");
+    if (!tmpdir) tmpdir = "/tmp";
+    std::string path = std::string(tmpdir) + "/" + namespace_ + ".bin";
+    IREE_CHECK_OK(iree_file_write_contents(
+        path.c_str(),
+        iree_make_const_byte_span(contents_.data(), contents_.size())));
+    return path;
+  }
+
+  void ExpectContents(iree_io_parameter_index_t* index) {
+    ASSERT_EQ(iree_io_parameter_index_count(index), 3);
+    for (int i = 0; i < 3; ++i) {
+      const iree_io_parameter_index_entry_t* entry = NULL;
+      IREE_ASSERT_OK(iree_io_parameter_index_get(index, i, &entry));
+      ASSERT_EQ(iree_io_file_handle_type(entry->storage.file.handle),
+                IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION);
+      iree_byte_span_t span =
+          iree_io_file_handle_value(entry->storage.file.handle).host_allocation;
+      ASSERT_EQ(span.data_length, kParameterSize);
+      EXPECT_EQ(entry->storage.file.offset, 0);
+      EXPECT_EQ(std::memcmp(span.data, contents_.data() + i * kParameterSize,
+                            kParameterSize),
+                0);
+    }
+  }
+
+  // Caches the parameters of |source| in persistent segments and then resets
+  // the segments to how a process that exited before sizing them would have
+  // left them. Returns open file descriptors of the segments.
+  std::vector<int> AbandonSegments(iree_io_parameter_index_t* source) {
+    iree_io_parameter_cache_t* cache =
+        CreateCache(IREE_IO_PARAMETER_CACHE_FLAG_PERSISTENT);
+    iree_io_parameter_index_t* target = ShareIndex(cache, source);
+    iree_io_parameter_index_release(target);
+    iree_io_parameter_cache_release(cache);
+    std::vector<int> fds;
+    for (const std::string& path : ListSegments("c")) {
+      int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+      EXPECT_NE(fd, -1);
+      if (fd == -1) continue;
+      EXPECT_EQ(ftruncate(fd, 0), 0);
+      fds.push_back(fd);
+    }
+    return fds;
+  }
+
+  std::string namespace_;
+  std::vector<uint8_t> contents_;
+};
+
+// Identical parameters are stored once and shared by later lookups.
+TEST_F(ParameterCacheTest, DeduplicatesHostAllocations) {
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(contents_.data(), contents_.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &handle));
+  iree_io_parameter_index_t* source = CreateIndex(handle);
+
+  iree_io_parameter_cache_t* cache0 = CreateCache();
+  iree_io_parameter_index_t* target0 = ShareIndex(cache0, source);
+  ExpectContents(target0);
+  iree_io_parameter_cache_statistics_t statistics;
+  iree_io_parameter_cache_query_statistics(cache0, &statistics);
+  EXPECT_EQ(statistics.miss_count, 2);
+  EXPECT_EQ(statistics.hit_count, 1);
+  EXPECT_EQ(CountSegments("c"), 2);
+
+  // A second cache (as another process would have) finds everything.
+  iree_io_parameter_cache_t* cache1 = CreateCache();
+  iree_io_parameter_index_t* target1 = ShareIndex(cache1, source);
+  ExpectContents(target1);
+  iree_io_parameter_cache_query_statistics(cache1, &statistics);
+  EXPECT_EQ(statistics.miss_count, 0);
+  EXPECT_EQ(statistics.hit_count, 3);
+  EXPECT_EQ(statistics.alias_hit_count, 0);
+
+  // Segments are removed when the last user releases them.
+  iree_io_parameter_index_release(target0);
+  iree_io_parameter_cache_release(cache0);
+  EXPECT_EQ(CountSegments("c"), 2);
+  iree_io_parameter_index_release(target1);
+  iree_io_parameter_cache_release(cache1);
+  EXPECT_EQ(CountSegments("c"), 0);
+
+  iree_io_parameter_index_release(source);
+  iree_io_file_handle_release(handle);
+}
+
+// Segments are not kept alive by processes that exit without releasing them.
+TEST_F(ParameterCacheTest, IgnoresExitedProcesses) {
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(contents_.data(), contents_.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &handle));
+  iree_io_parameter_index_t* source = CreateIndex(handle);
+
+  pid_t pid = fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    iree_io_parameter_cache_t* cache = CreateCache();
+    ShareIndex(cache, source);
+    _exit(0);
+  }
+  int wait_status = 0;
+  ASSERT_EQ(waitpid(pid, &wait_status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(wait_status));
+  EXPECT_EQ(CountSegments("c"), 2);
+
+  iree_io_parameter_cache_t* cache = CreateCache();
+  iree_io_parameter_index_t* target = ShareIndex(cache, source);
+  ExpectContents(target);
+  iree_io_parameter_cache_statistics_t statistics;
+  iree_io_parameter_cache_query_statistics(cache, &statistics);
+  EXPECT_EQ(statistics.hit_count, 3);
+  iree_io_parameter_index_release(target);
+  iree_io_parameter_cache_release(cache);
+  EXPECT_EQ(CountSegments("c"), 0);
+
+  iree_io_parameter_index_release(source);
+  iree_io_file_handle_release(handle);
+}
+
+// Releasing a segment that was removed and replaced by another process keeps
+// the replacement.
+TEST_F(ParameterCacheTest, KeepsReplacedSegments) {
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(contents_.data(), contents_.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &handle));
+  iree_io_parameter_index_t* source = CreateIndex(handle);
+
+  iree_io_parameter_cache_t* cache0 = CreateCache();
+  iree_io_parameter_index_t* target0 = ShareIndex(cache0, source);
+  for (const std::string& path : ListSegments("c")) {
+    EXPECT_EQ(unlink(path.c_str()), 0);
+  }
+
+  iree_io_parameter_cache_t* cache1 = CreateCache();
+  iree_io_parameter_index_t* target1 = ShareIndex(cache1, source);
+  iree_io_parameter_cache_statistics_t statistics;
+  iree_io_parameter_cache_query_statistics(cache1, &statistics);
+  EXPECT_EQ(statistics.miss_count, 2);
+  EXPECT_EQ(CountSegments("c"), 2);
+
+  iree_io_parameter_index_release(target0);
+  iree_io_parameter_cache_release(cache0);
+  EXPECT_EQ(CountSegments("c"), 2);
+  ExpectContents(target1);
+  iree_io_parameter_index_release(target1);
+  iree_io_parameter_cache_release(cache1);
+  EXPECT_EQ(CountSegments("c"), 0);
+
+  iree_io_parameter_index_release(source);
+  iree_io_file_handle_release(handle);
+}
+
+// Segments abandoned by processes that exited while populating them are
+// replaced without waiting for the populate timeout.
+TEST_F(ParameterCacheTest, ReplacesAbandonedSegments) {
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(contents_.data(), contents_.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &handle));
+  iree_io_parameter_index_t* source = CreateIndex(handle);
+  std::vector<int> fds = AbandonSegments(source);
+  EXPECT_EQ(fds.size(), 2);
+  for (int fd : fds) close(fd);
+
+  iree_io_parameter_cache_t* cache = CreateCache();
+  iree_time_t start_ns = iree_time_now();
+  iree_io_parameter_index_t* target = ShareIndex(cache, source);
+  EXPECT_LT(iree_time_now() - start_ns, 10 * 1000000000ll);
+  ExpectContents(target);
+  iree_io_parameter_cache_statistics_t statistics;
+  iree_io_parameter_cache_query_statistics(cache, &statistics);
+  EXPECT_EQ(statistics.miss_count, 2);
+  EXPECT_EQ(statistics.hit_count, 1);
+
+  iree_io_parameter_index_release(target);
+  iree_io_parameter_cache_release(cache);
+  EXPECT_EQ(CountSegments("c"), 0);
+  iree_io_parameter_index_release(source);
+  iree_io_file_handle_release(handle);
+}
+
+// Segments still locked by their populator are waited on and not replaced.
+TEST_F(ParameterCacheTest, WaitsOnLivePopulators) {
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(contents_.data(), contents_.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &handle));
+  iree_io_parameter_index_t* source = CreateIndex(handle);
+  std::vector<int> fds = AbandonSegments(source);
+  for (int fd : fds) ASSERT_EQ(flock(fd, LOCK_EX | LOCK_NB), 0);
+
+  // Entries fall back to their original storage once the timeout elapses.
+  iree_io_parameter_cache_t* cache = CreateCache(
+      IREE_IO_PARAMETER_CACHE_FLAG_NONE, /*populate_timeout=*/10000000ll);
+  iree_io_parameter_index_t* target = ShareIndex(cache, source);
+  ASSERT_EQ(iree_io_parameter_index_count(target), 3);
+  for (int i = 0; i < 3; ++i) {
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_get(target, i, &entry));
+    EXPECT_EQ(entry->storage.file.handle, handle);
+  }
+  iree_io_parameter_cache_statistics_t statistics;
+  iree_io_parameter_cache_query_statistics(cache, &statistics);
+  EXPECT_EQ(statistics.miss_count, 0);
+  EXPECT_EQ(statistics.hit_count, 0);
+  EXPECT_EQ(CountSegments("c"), 2);
+
+  iree_io_parameter_index_release(target);
+  iree_io_parameter_cache_release(cache);
+  for (int fd : fds) close(fd);
+  iree_io_parameter_index_release(source);
+  iree_io_file_handle_release(handle);
+}
+
+// Files with a stable identity are resolved without reading them again.
+TEST_F(ParameterCacheTest, AliasesFiles) {
+  std::string path = WriteFile();
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ, iree_make_string_view(path.data(), path.size()),
+      iree_allocator_system(), &handle));
+  iree_io_parameter_index_t* source = CreateIndex(handle);
+
+  iree_io_parameter_cache_t* cache = CreateCache();
+  iree_io_parameter_index_t* target0 = ShareIndex(cache, source);
+  ExpectContents(target0);
+  EXPECT_EQ(CountSegments("a"), 3);
+  iree_io_parameter_index_t* target1 = ShareIndex(cache, source);
+  ExpectContents(target1);
+  iree_io_parameter_cache_statistics_t statistics;
+  iree_io_parameter_cache_query_statistics(cache, &statistics);
+  EXPECT_EQ(statistics.miss_count, 2);
+  EXPECT_EQ(statistics.hit_count, 4);
+  EXPECT_EQ(statistics.alias_hit_count, 3);
+
+  // Aliases are removed along with the segments they resolve to.
+  iree_io_parameter_index_release(target0);
+  iree_io_parameter_index_release(target1);
+  iree_io_parameter_cache_release(cache);
+  EXPECT_EQ(CountSegments("c"), 0);
+  EXPECT_EQ(CountSegments("a"), 0);
+  iree_io_parameter_index_release(source);
+  iree_io_file_handle_release(handle);
+  remove(path.c_str());
+}
+
+// Aliases left behind by processes that exited while removing their segments
+// are replaced when found stale.
+TEST_F(ParameterCacheTest, ReplacesStaleAliases) {
+  std::string path = WriteFile();
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ, iree_make_string_view(path.data(), path.size()),
+      iree_allocator_system(), &handle));
+  iree_io_parameter_index_t* source = CreateIndex(handle);
+
+  iree_io_parameter_cache_t* cache = CreateCache();
+  iree_io_parameter_index_t* target0 = ShareIndex(cache, source);
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> aliases;
+  for (const std::string& alias_path : ListSegments("a")) {
+    iree_file_contents_t* contents = NULL;
+    IREE_ASSERT_OK(iree_file_read_contents(alias_path.c_str(),
+                                           IREE_FILE_READ_FLAG_DEFAULT,
+                                           iree_allocator_system(), &contents));
+    aliases.emplace_back(
+        alias_path,
+        std::vector<uint8_t>(contents->const_buffer.data,
+                             contents->const_buffer.data +
+                                 contents->const_buffer.data_length));
+    iree_file_contents_free(contents);
+  }
+  EXPECT_EQ(aliases.size(), 3);
+  iree_io_parameter_index_release(target0);
+  EXPECT_EQ(CountSegments("c"), 0);
+  EXPECT_EQ(CountSegments("a"), 0);
+  for (const auto& alias : aliases) {
+    IREE_ASSERT_OK(iree_file_write_contents(
+        alias.first.c_str(), iree_make_const_byte_span(alias.second.data(),
+                                                       alias.second.size())));
+  }
+
+  // Stale aliases fall back to hashing the contents and are rewritten. The
+  // alias of parameter 2 resolves again once parameter 0 repopulates the
+  // contents they share.
+  iree_io_parameter_index_t* target1 = ShareIndex(cache, source);
+  ExpectContents(target1);
+  iree_io_parameter_cache_statistics_t statistics;
+  iree_io_parameter_cache_query_statistics(cache, &statistics);
+  EXPECT_EQ(statistics.miss_count, 4);
+  EXPECT_EQ(statistics.alias_hit_count, 1);
+  iree_io_parameter_index_t* target2 = ShareIndex(cache, source);
+  iree_io_parameter_cache_query_statistics(cache, &statistics);
+  EXPECT_EQ(statistics.alias_hit_count, 4);
+
+  iree_io_parameter_index_release(target1);
+  iree_io_parameter_index_release(target2);
+  iree_io_parameter_cache_release(cache);
+  EXPECT_EQ(CountSegments("a"), 0);
+  iree_io_parameter_index_release(source);
+  iree_io_file_handle_release(handle);
+  remove(path.c_str());
+}
+
+// Host allocations loaded from a known path are resolved by the path identity
+// without reading the allocation again.
+TEST_F(ParameterCacheTest, AliasesHostAllocationsByPath) {
+  std::string path = WriteFile();
+  iree_string_view_t path_view = iree_make_string_view(path.data(), path.size());
+  iree_io_file_handle_t* handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(contents_.data(), contents_.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &handle));
+  iree_io_parameter_index_t* source = CreateIndex(handle);
+
+  iree_io_parameter_cache_t* cache = CreateCache();
+  iree_io_parameter_index_t* target0 = ShareIndex(cache, source, path_view);
+  ExpectContents(target0);
+  EXPECT_EQ(CountSegments("a"), 3);
+
+  // The allocation isn't read when the path is already cached: contents that
+  // differ from the file (which callers must never provide) go unnoticed.
+  std::vector<uint8_t> other_contents(contents_.size(), 0xCD);
+  iree_io_file_handle_t* other_handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(other_contents.data(), other_contents.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &other_handle));
+  iree_io_parameter_index_t* other_source = CreateIndex(other_handle);
+  iree_io_parameter_index_t* target1 =
+      ShareIndex(cache, other_source, path_view);
+  ExpectContents(target1);
+  iree_io_parameter_cache_statistics_t statistics;
+  iree_io_parameter_cache_query_statistics(cache, &statistics);
+  EXPECT_EQ(statistics.miss_count, 2);
+  EXPECT_EQ(statistics.hit_count, 4);
+  EXPECT_EQ(statistics.alias_hit_count, 3);
+
+  iree_io_parameter_index_release(target0);
+  iree_io_parameter_index_release(target1);
+  iree_io_parameter_cache_release(cache);
+  iree_io_parameter_index_release(other_source);
+  iree_io_file_handle_release(other_handle);
+  iree_io_parameter_index_release(source);
+  iree_io_file_handle_release(handle);
+  remove(path.c_str());
+}
+
+}  // namespace
+
+#endif  // IREE_PLATFORM_LINUX
@@ -93,6 +93,12 @@ IREE_API_EXPORT void iree_io_parameter_index_release(
   }
 }
 
+IREE_API_EXPORT iree_allocator_t
+iree_io_parameter_index_host_allocator(iree_io_parameter_index_t* index) {
+  IREE_ASSERT_ARGUMENT(index);
+  return index->host_allocator;
+}
+
 IREE_API_EXPORT iree_host_size_t
 iree_io_parameter_index_count(iree_io_parameter_index_t* index) {
   IREE_ASSERT_ARGUMENT(index);
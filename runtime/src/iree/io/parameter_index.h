@@ -89,6 +89,11 @@ IREE_API_EXPORT void iree_io_parameter_index_retain(
 IREE_API_EXPORT void iree_io_parameter_index_release(
     iree_io_parameter_index_t* index);
 
+// Returns the allocator used by |index| for its own storage. Parsers may use it
+// for transient allocations when populating the index.
+IREE_API_EXPORT iree_allocator_t
+iree_io_parameter_index_host_allocator(iree_io_parameter_index_t* index);
+
 // Returns the number of entries in the index at the time the method is called.
 // New entries may be added by other threads between when the value is queried
 // and when the caller enumerates entries. Use this only for debugging.
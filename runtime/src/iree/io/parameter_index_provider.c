@@ -20,6 +20,9 @@ typedef struct iree_io_parameter_index_provider_t {
   iree_string_view_t scope;
   iree_io_parameter_index_t* index;
   iree_hal_file_cache_t* file_cache;
+  iree_io_parameter_residency_mode_t residency_mode;
+  // Tracks host memory backed parameters when residency_mode is LAZY.
+  iree_io_parameter_residency_t residency;
 } iree_io_parameter_index_provider_t;
 
 static const iree_io_parameter_provider_vtable_t
@@ -35,6 +38,19 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_string_view_t scope, iree_io_parameter_index_t* index,
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
     iree_io_parameter_provider_t** out_provider) {
+  return iree_io_parameter_index_provider_create_with_residency(
+      scope, index, max_concurrent_operations,
+      iree_io_parameter_residency_options_default(), host_allocator,
+      out_provider);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_create_with_residency(
+    iree_string_view_t scope, iree_io_parameter_index_t* index,
+    iree_host_size_t max_concurrent_operations,
+    iree_io_parameter_residency_options_t residency_options,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider) {
   IREE_ASSERT_ARGUMENT(index);
   IREE_ASSERT_ARGUMENT(out_provider);
   *out_provider = NULL;
@@ -61,8 +77,18 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
   provider->index = index;
   iree_io_parameter_index_retain(index);
 
+  provider->residency_mode = residency_options.mode;
+  iree_io_parameter_residency_initialize(residency_options.budget,
+                                         host_allocator, &provider->residency);
+
   iree_status_t status =
       iree_hal_file_cache_create(host_allocator, &provider->file_cache);
+  if (iree_status_is_ok(status) &&
+      residency_options.mode == IREE_IO_PARAMETER_RESIDENCY_MODE_LAZY &&
+      residency_options.trim_interval > 0) {
+    status = iree_io_parameter_residency_start_trimming(
+        &provider->residency, residency_options.trim_interval);
+  }
 
   if (iree_status_is_ok(status)) {
     *out_provider = (iree_io_parameter_provider_t*)provider;
@@ -82,6 +108,7 @@ static void iree_io_parameter_index_provider_destroy(
 
   iree_hal_file_cache_release(provider->file_cache);
   iree_io_parameter_index_release(provider->index);
+  iree_io_parameter_residency_deinitialize(&provider->residency);
 
   iree_allocator_free(host_allocator, provider);
 
@@ -99,6 +126,8 @@ static iree_status_t iree_io_parameter_index_provider_notify(
     case IREE_IO_PARAMETER_PROVIDER_SIGNAL_SUSPEND:
     case IREE_IO_PARAMETER_PROVIDER_SIGNAL_LOW_MEMORY:
       iree_hal_file_cache_trim(provider->file_cache);
+      // Lazily resident parameters fault back in when next used.
+      iree_io_parameter_residency_trim(&provider->residency, 0);
       break;
     default:
       break;
@@ -115,6 +144,76 @@ static bool iree_io_parameter_index_provider_query_support(
   return iree_string_view_equal(scope, provider->scope);
 }
 
+static iree_status_t iree_io_parameter_index_provider_query_statistics(
+    iree_io_parameter_provider_t* base_provider,
+    iree_io_parameter_provider_statistics_t* out_statistics) {
+  iree_io_parameter_index_provider_t* provider =
+      iree_io_parameter_index_provider_cast(base_provider);
+  iree_io_parameter_residency_query_statistics(&provider->residency,
+                                               out_statistics);
+  return iree_ok_status();
+}
+
+// Records an access to the |span| of |entry| when tracking lazy residency.
+// Only parameters backed by host memory are tracked as the memory of other
+// file types is owned by the system (page cache, device memory, etc).
+// Residency is measured by the tracker; this only establishes recency and the
+// bytes the access may fault in.
+static iree_status_t iree_io_parameter_index_provider_touch(
+    iree_io_parameter_index_provider_t* provider,
+    const iree_io_parameter_index_entry_t* entry,
+    iree_io_parameter_span_t span) {
+  if (provider->residency_mode != IREE_IO_PARAMETER_RESIDENCY_MODE_LAZY ||
+      entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE ||
+      iree_io_file_handle_type(entry->storage.file.handle) !=
+          IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
+    return iree_ok_status();
+  }
+  iree_byte_span_t host_allocation =
+      iree_io_file_handle_primitive(entry->storage.file.handle)
+          .value.host_allocation;
+  iree_byte_span_t parameter = iree_make_byte_span(
+      host_allocation.data + entry->storage.file.offset,
+      (iree_host_size_t)entry->length);
+  iree_byte_span_t access =
+      iree_make_byte_span(parameter.data + span.parameter_offset,
+                          (iree_host_size_t)span.length);
+  return iree_io_parameter_residency_touch(&provider->residency, entry,
+                                           parameter, access);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_record_access(
+    iree_io_parameter_provider_t* base_provider, iree_string_view_t key,
+    uint64_t offset, uint64_t length) {
+  IREE_ASSERT_ARGUMENT(base_provider);
+  if (base_provider->vtable != &iree_io_parameter_index_provider_vtable) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "provider is not a parameter index provider");
+  }
+  iree_io_parameter_index_provider_t* provider =
+      iree_io_parameter_index_provider_cast(base_provider);
+  if (provider->residency_mode != IREE_IO_PARAMETER_RESIDENCY_MODE_LAZY) {
+    return iree_ok_status();
+  }
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_io_parameter_index_lookup(provider->index, key, &entry));
+  if (offset > entry->length || length > entry->length - offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "access [%" PRIu64 ", %" PRIu64
+                            ") out of range of parameter `%.*s` with %" PRIu64
+                            " bytes",
+                            offset, offset + length, (int)key.size, key.data,
+                            entry->length);
+  }
+  iree_io_parameter_span_t span = {
+      .parameter_offset = offset,
+      .buffer_offset = 0,
+      .length = (iree_device_size_t)length,
+  };
+  return iree_io_parameter_index_provider_touch(provider, entry, span);
+}
+
 // Resolves a parameter with |key| for use on the given |device|.
 // Returns the entry containing the parameter metadata and a retained
 // HAL file that stores it (must be released by the caller).
@@ -710,6 +809,8 @@ static iree_status_t iree_io_parameter_index_provider_load(
       IREE_TRACE_ZONE_APPEND_TEXT(z_entry, source_entry->key.data,
                                   source_entry->key.size);
       IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, span.length);
+      status =
+          iree_io_parameter_index_provider_touch(provider, source_entry, span);
     }
 
     // TODO(benvanik): refactor iree_io_parameter_index_provider_resolve so that
@@ -865,6 +966,8 @@ static iree_status_t iree_io_parameter_index_provider_gather(
       IREE_TRACE_ZONE_APPEND_TEXT(z_entry, source_entry->key.data,
                                   source_entry->key.size);
       IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, span.length);
+      status =
+          iree_io_parameter_index_provider_touch(provider, source_entry, span);
     }
 
     // Enqueue the transfer/file operation.
@@ -989,4 +1092,5 @@ static const iree_io_parameter_provider_vtable_t
         .load = iree_io_parameter_index_provider_load,
         .gather = iree_io_parameter_index_provider_gather,
         .scatter = iree_io_parameter_index_provider_scatter,
+        .query_statistics = iree_io_parameter_index_provider_query_statistics,
 };
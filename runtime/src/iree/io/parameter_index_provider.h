@@ -13,6 +13,7 @@
 #include "iree/hal/api.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/parameter_provider.h"
+#include "iree/io/parameter_residency.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +36,37 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
     iree_io_parameter_provider_t** out_provider);
 
+// Creates a parameter provider serving from the provided |index| as with
+// iree_io_parameter_index_provider_create with the given |residency_options|.
+//
+// With IREE_IO_PARAMETER_RESIDENCY_MODE_LAZY parameters backed by host memory
+// (such as mapped files) are imported without touching them and cold
+// parameters are reclaimed in least-recently-used order to stay within
+// |residency_options.budget|. Accesses are recorded when parameters are loaded
+// or gathered. Imported parameters are used directly by device work after that
+// and those uses are observed by the periodic background trims enabled with
+// |residency_options.trim_interval| as memory they fault in; callers that know
+// when such uses happen can also record them with
+// iree_io_parameter_index_provider_record_access. Hit and miss counters are
+// available via iree_io_parameter_provider_query_statistics.
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_create_with_residency(
+    iree_string_view_t scope, iree_io_parameter_index_t* index,
+    iree_host_size_t max_concurrent_operations,
+    iree_io_parameter_residency_options_t residency_options,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider);
+
+// Records an access to |length| bytes at |offset| of the parameter with |key|
+// made outside of the provider (such as by device work using an imported
+// parameter). The parameter becomes the most recently used for the purposes of
+// reclaiming memory. Has no effect unless |provider| was created with
+// IREE_IO_PARAMETER_RESIDENCY_MODE_LAZY and the parameter is backed by host
+// memory.
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_record_access(
+    iree_io_parameter_provider_t* provider, iree_string_view_t key,
+    uint64_t offset, uint64_t length);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -53,6 +53,16 @@ IREE_API_EXPORT bool iree_io_parameter_provider_query_support(
   return provider->vtable->query_support(provider, scope);
 }
 
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_query_statistics(
+    iree_io_parameter_provider_t* provider,
+    iree_io_parameter_provider_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(provider);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  if (!provider->vtable->query_statistics) return iree_ok_status();
+  return provider->vtable->query_statistics(provider, out_statistics);
+}
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_provider_load(
     iree_io_parameter_provider_t* provider, iree_hal_device_t* device,
     iree_hal_queue_affinity_t queue_affinity,
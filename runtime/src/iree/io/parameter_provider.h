@@ -36,6 +36,23 @@ typedef enum iree_io_parameter_provider_signal_e {
   IREE_IO_PARAMETER_PROVIDER_SIGNAL_LOW_MEMORY = 2,
 } iree_io_parameter_provider_signal_t;
 
+// Statistics describing how parameters have been served by a provider.
+// Providers that do not track residency report zeros.
+typedef struct iree_io_parameter_provider_statistics_t {
+  // Number of parameter accesses whose backing memory was fully resident.
+  uint64_t hit_count;
+  // Number of parameter accesses that had to fault or read in any of their
+  // backing memory.
+  uint64_t miss_count;
+  // Number of times a parameter had its backing memory reclaimed.
+  uint64_t eviction_count;
+  // Total bytes of parameter backing memory resident when last measured. The
+  // system may fault in or reclaim pages between measurements.
+  uint64_t resident_bytes;
+  // Resident memory budget in bytes or 0 if unlimited.
+  uint64_t budget_bytes;
+} iree_io_parameter_provider_statistics_t;
+
 typedef struct iree_io_parameter_span_t {
   uint64_t parameter_offset;
   iree_device_size_t buffer_offset;
@@ -74,6 +91,12 @@ iree_io_parameter_provider_notify(iree_io_parameter_provider_t* provider,
 IREE_API_EXPORT bool iree_io_parameter_provider_query_support(
     iree_io_parameter_provider_t* provider, iree_string_view_t scope);
 
+// Queries statistics about parameter residency in |provider|.
+// Providers that do not track statistics return all zeros.
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_query_statistics(
+    iree_io_parameter_provider_t* provider,
+    iree_io_parameter_provider_statistics_t* out_statistics);
+
 typedef iree_status_t(IREE_API_PTR* iree_io_parameter_enumerator_fn_t)(
     void* user_data, iree_host_size_t i, iree_string_view_t* out_key,
     iree_io_parameter_span_t* out_span);
@@ -220,6 +243,11 @@ typedef struct iree_io_parameter_provider_vtable_t {
       const iree_hal_semaphore_list_t signal_semaphore_list,
       iree_hal_buffer_t* source_buffer, iree_string_view_t target_scope,
       iree_host_size_t count, iree_io_parameter_enumerator_t enumerator);
+
+  // Optional; providers without statistics may leave this NULL.
+  iree_status_t(IREE_API_PTR* query_statistics)(
+      iree_io_parameter_provider_t* provider,
+      iree_io_parameter_provider_statistics_t* out_statistics);
 } iree_io_parameter_provider_vtable_t;
 
 struct iree_io_parameter_provider_t {
@@ -0,0 +1,576 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_residency.h"
+
+#include "iree/base/internal/memory.h"
+
+#define IREE_IO_PARAMETER_RESIDENCY_NONE UINT32_MAX
+
+struct iree_io_parameter_residency_record_t {
+  // Unique key of the parameter (usually its index entry).
+  const void* key;
+  // Backing memory of the parameter.
+  iree_byte_span_t parameter;
+  // Bytes of the parameter resident when last measured.
+  uint64_t resident_length;
+  // Bytes accessed since last measured that were not resident at the time and
+  // may have since been faulted in.
+  uint64_t pending_length;
+  // True if the record is in the LRU list.
+  bool is_linked;
+  // Links in the LRU list; only valid when is_linked.
+  uint32_t prev;
+  uint32_t next;
+  // Bytes resident when last measured while not in the LRU list. Memory that
+  // was not paged out when reclaimed is not mistaken for a new use.
+  uint64_t unlinked_length;
+  // Incremented each time the record is moved to the head of the LRU list.
+  // Used to detect records touched while a trim has the mutex released.
+  uint32_t touch_count;
+};
+
+IREE_API_EXPORT void iree_io_parameter_residency_initialize(
+    uint64_t budget, iree_allocator_t host_allocator,
+    iree_io_parameter_residency_t* out_residency) {
+  IREE_ASSERT_ARGUMENT(out_residency);
+  memset(out_residency, 0, sizeof(*out_residency));
+  out_residency->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&out_residency->mutex);
+  out_residency->budget = budget;
+  out_residency->lru_head = IREE_IO_PARAMETER_RESIDENCY_NONE;
+  out_residency->lru_tail = IREE_IO_PARAMETER_RESIDENCY_NONE;
+  out_residency->statistics.budget_bytes = budget;
+  iree_notification_initialize(&out_residency->trim_notification);
+  iree_atomic_store_int32(&out_residency->trim_exit_requested, 0,
+                          iree_memory_order_relaxed);
+}
+
+static bool iree_io_parameter_residency_is_trim_exit_requested(
+    iree_io_parameter_residency_t* residency) {
+  return iree_atomic_load_int32(&residency->trim_exit_requested,
+                                iree_memory_order_acquire) != 0;
+}
+
+// Main function of the background trim thread.
+static int iree_io_parameter_residency_trim_main(void* entry_arg) {
+  iree_io_parameter_residency_t* residency =
+      (iree_io_parameter_residency_t*)entry_arg;
+  while (!iree_notification_await(
+      &residency->trim_notification,
+      (iree_condition_fn_t)iree_io_parameter_residency_is_trim_exit_requested,
+      residency, iree_make_timeout_ns(residency->trim_interval))) {
+    iree_io_parameter_residency_trim(residency, residency->budget);
+  }
+  return 0;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_residency_start_trimming(
+    iree_io_parameter_residency_t* residency, iree_duration_t interval) {
+  IREE_ASSERT_ARGUMENT(residency);
+  if (!residency->budget || residency->trim_thread) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  residency->trim_interval = interval;
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = IREE_SV("iree-parameter-trim");
+  params.priority_class = IREE_THREAD_PRIORITY_CLASS_LOW;
+  iree_status_t status = iree_thread_create(
+      iree_io_parameter_residency_trim_main, residency, params,
+      residency->host_allocator, &residency->trim_thread);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_io_parameter_residency_deinitialize(
+    iree_io_parameter_residency_t* residency) {
+  IREE_ASSERT_ARGUMENT(residency);
+  if (residency->trim_thread) {
+    // Releasing the thread joins it once it observes the exit request.
+    iree_atomic_store_int32(&residency->trim_exit_requested, 1,
+                            iree_memory_order_release);
+    iree_notification_post(&residency->trim_notification, IREE_ALL_WAITERS);
+    iree_thread_release(residency->trim_thread);
+  }
+  iree_notification_deinitialize(&residency->trim_notification);
+  iree_allocator_free(residency->host_allocator, residency->slots);
+  iree_allocator_free(residency->host_allocator, residency->records);
+  iree_slim_mutex_deinitialize(&residency->mutex);
+  memset(residency, 0, sizeof(*residency));
+}
+
+static iree_host_size_t iree_io_parameter_residency_hash(const void* key) {
+  // Fibonacci hashing; keys are pointers so the low bits carry little entropy.
+  return (iree_host_size_t)(((uint64_t)(uintptr_t)key >> 3) *
+                                0x9E3779B97F4A7C15ull >>
+                            32);
+}
+
+// Returns the ordinal of the record with |key| or NONE if not found.
+static uint32_t iree_io_parameter_residency_find(
+    iree_io_parameter_residency_t* residency, const void* key) {
+  if (!residency->slot_capacity) return IREE_IO_PARAMETER_RESIDENCY_NONE;
+  const iree_host_size_t mask = residency->slot_capacity - 1;
+  for (iree_host_size_t i = iree_io_parameter_residency_hash(key) & mask;;
+       i = (i + 1) & mask) {
+    const uint32_t slot = residency->slots[i];
+    if (!slot) return IREE_IO_PARAMETER_RESIDENCY_NONE;
+    if (residency->records[slot - 1].key == key) return slot - 1;
+  }
+}
+
+// Inserts |ordinal| into the slot table which must have a free slot.
+static void iree_io_parameter_residency_insert_slot(
+    iree_io_parameter_residency_t* residency, uint32_t ordinal) {
+  const iree_host_size_t mask = residency->slot_capacity - 1;
+  iree_host_size_t i =
+      iree_io_parameter_residency_hash(residency->records[ordinal].key) & mask;
+  while (residency->slots[i]) i = (i + 1) & mask;
+  residency->slots[i] = ordinal + 1;
+}
+
+// Adds a new non-resident record and returns its ordinal.
+static iree_status_t iree_io_parameter_residency_add(
+    iree_io_parameter_residency_t* residency, const void* key,
+    iree_byte_span_t parameter, uint32_t* out_ordinal) {
+  if (residency->record_count + 1 >= IREE_IO_PARAMETER_RESIDENCY_NONE) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "too many parameters tracked");
+  }
+
+  // Grow the record storage; ordinals remain stable.
+  if (residency->record_count == residency->record_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(64, residency->record_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        residency->host_allocator, new_capacity * sizeof(residency->records[0]),
+        (void**)&residency->records));
+    residency->record_capacity = new_capacity;
+  }
+
+  // Keep the slot table at most half full and rehash when growing.
+  if ((residency->record_count + 1) * 2 > residency->slot_capacity) {
+    iree_host_size_t new_capacity = iree_max(128, residency->slot_capacity * 2);
+    uint32_t* new_slots = NULL;
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(residency->host_allocator,
+                                               new_capacity * sizeof(uint32_t),
+                                               (void**)&new_slots));
+    iree_allocator_free(residency->host_allocator, residency->slots);
+    residency->slots = new_slots;
+    residency->slot_capacity = new_capacity;
+    for (uint32_t i = 0; i < residency->record_count; ++i) {
+      iree_io_parameter_residency_insert_slot(residency, i);
+    }
+  }
+
+  const uint32_t ordinal = (uint32_t)residency->record_count++;
+  iree_io_parameter_residency_record_t* record = &residency->records[ordinal];
+  memset(record, 0, sizeof(*record));
+  record->key = key;
+  record->parameter = parameter;
+  record->prev = IREE_IO_PARAMETER_RESIDENCY_NONE;
+  record->next = IREE_IO_PARAMETER_RESIDENCY_NONE;
+  iree_io_parameter_residency_insert_slot(residency, ordinal);
+  *out_ordinal = ordinal;
+  return iree_ok_status();
+}
+
+static void iree_io_parameter_residency_unlink(
+    iree_io_parameter_residency_t* residency, uint32_t ordinal) {
+  iree_io_parameter_residency_record_t* record = &residency->records[ordinal];
+  if (record->prev != IREE_IO_PARAMETER_RESIDENCY_NONE) {
+    residency->records[record->prev].next = record->next;
+  } else {
+    residency->lru_head = record->next;
+  }
+  if (record->next != IREE_IO_PARAMETER_RESIDENCY_NONE) {
+    residency->records[record->next].prev = record->prev;
+  } else {
+    residency->lru_tail = record->prev;
+  }
+  record->prev = IREE_IO_PARAMETER_RESIDENCY_NONE;
+  record->next = IREE_IO_PARAMETER_RESIDENCY_NONE;
+  record->is_linked = false;
+}
+
+static void iree_io_parameter_residency_link_head(
+    iree_io_parameter_residency_t* residency, uint32_t ordinal) {
+  iree_io_parameter_residency_record_t* record = &residency->records[ordinal];
+  record->is_linked = true;
+  record->prev = IREE_IO_PARAMETER_RESIDENCY_NONE;
+  record->next = residency->lru_head;
+  if (residency->lru_head != IREE_IO_PARAMETER_RESIDENCY_NONE) {
+    residency->records[residency->lru_head].prev = ordinal;
+  } else {
+    residency->lru_tail = ordinal;
+  }
+  residency->lru_head = ordinal;
+}
+
+// Updates the residency of the record at |ordinal| to |resident_length| bytes
+// with |pending_length| bytes accessed since that may be faulted in later.
+static void iree_io_parameter_residency_update_record(
+    iree_io_parameter_residency_t* residency, uint32_t ordinal,
+    uint64_t resident_length, uint64_t pending_length) {
+  iree_io_parameter_residency_record_t* record = &residency->records[ordinal];
+  residency->statistics.resident_bytes -= record->resident_length;
+  residency->statistics.resident_bytes += resident_length;
+  residency->pending_bytes -= record->pending_length;
+  residency->pending_bytes += pending_length;
+  record->resident_length = resident_length;
+  record->pending_length = pending_length;
+}
+
+static void iree_io_parameter_residency_link_tail(
+    iree_io_parameter_residency_t* residency, uint32_t ordinal) {
+  iree_io_parameter_residency_record_t* record = &residency->records[ordinal];
+  record->is_linked = true;
+  record->prev = residency->lru_tail;
+  record->next = IREE_IO_PARAMETER_RESIDENCY_NONE;
+  if (residency->lru_tail != IREE_IO_PARAMETER_RESIDENCY_NONE) {
+    residency->records[residency->lru_tail].next = ordinal;
+  } else {
+    residency->lru_head = ordinal;
+  }
+  residency->lru_tail = ordinal;
+}
+
+// Returns true if the measured resident total plus pending accesses exceeds
+// |target_bytes|. Must be called with the mutex held.
+static bool iree_io_parameter_residency_is_over_locked(
+    iree_io_parameter_residency_t* residency, uint64_t target_bytes) {
+  return residency->statistics.resident_bytes + residency->pending_bytes >
+         target_bytes;
+}
+
+// A record measured or reclaimed by a trim batch outside of the mutex.
+typedef struct iree_io_parameter_residency_batch_entry_t {
+  uint32_t ordinal;
+  // Record touch_count when captured; the entry is stale if it changed.
+  uint32_t touch_count;
+  iree_byte_span_t parameter;
+  // Resident bytes measured outside of the mutex.
+  uint64_t resident_length;
+  // True if the record was reclaimed by the batch.
+  bool is_reclaimed;
+} iree_io_parameter_residency_batch_entry_t;
+
+// Records measured per trim batch. Each batch is measured with the mutex
+// released so touches are only blocked while the results are applied.
+#define IREE_IO_PARAMETER_RESIDENCY_BATCH_CAPACITY 32
+
+// Returns true if |entry| still describes its record after the mutex was
+// released: records touched or reclaimed since are skipped.
+static bool iree_io_parameter_residency_batch_entry_is_valid(
+    iree_io_parameter_residency_t* residency,
+    const iree_io_parameter_residency_batch_entry_t* entry) {
+  const iree_io_parameter_residency_record_t* record =
+      &residency->records[entry->ordinal];
+  return record->is_linked && record->touch_count == entry->touch_count;
+}
+
+// Measures the parameters dropped from the LRU list by earlier trims and links
+// those with more memory resident than when last measured (faulted back in by
+// a use that was not reported) as the most recently used.
+// Must be called with the mutex held; the mutex is released while measuring.
+static void iree_io_parameter_residency_observe_unlinked_locked(
+    iree_io_parameter_residency_t* residency) {
+  iree_io_parameter_residency_batch_entry_t
+      batch[IREE_IO_PARAMETER_RESIDENCY_BATCH_CAPACITY];
+  for (uint32_t next_ordinal = 0; next_ordinal < residency->record_count;) {
+    iree_host_size_t batch_count = 0;
+    for (; next_ordinal < residency->record_count &&
+           batch_count < IREE_ARRAYSIZE(batch);
+         ++next_ordinal) {
+      const iree_io_parameter_residency_record_t* record =
+          &residency->records[next_ordinal];
+      if (record->is_linked) continue;
+      batch[batch_count++] = (iree_io_parameter_residency_batch_entry_t){
+          .ordinal = next_ordinal,
+          .touch_count = record->touch_count,
+          .parameter = record->parameter,
+          .resident_length = 0,
+          .is_reclaimed = false,
+      };
+    }
+    if (!batch_count) break;
+
+    iree_slim_mutex_unlock(&residency->mutex);
+    for (iree_host_size_t i = 0; i < batch_count; ++i) {
+      iree_host_size_t resident_length = 0;
+      iree_status_t status = iree_memory_query_resident_length(
+          batch[i].parameter.data, batch[i].parameter.data_length,
+          &resident_length);
+      if (iree_status_is_ok(status)) {
+        batch[i].resident_length = resident_length;
+      } else {
+        iree_status_ignore(status);
+      }
+    }
+    iree_slim_mutex_lock(&residency->mutex);
+
+    for (iree_host_size_t i = 0; i < batch_count; ++i) {
+      const uint32_t ordinal = batch[i].ordinal;
+      iree_io_parameter_residency_record_t* record =
+          &residency->records[ordinal];
+      if (record->is_linked || record->touch_count != batch[i].touch_count) {
+        continue;
+      }
+      if (batch[i].resident_length <= record->unlinked_length) {
+        record->unlinked_length = batch[i].resident_length;
+        continue;
+      }
+      iree_io_parameter_residency_link_head(residency, ordinal);
+      ++record->touch_count;
+      iree_io_parameter_residency_update_record(
+          residency, ordinal, batch[i].resident_length, 0);
+    }
+  }
+}
+
+// Measures and reclaims parameters from the least recently used end of the LRU
+// list in batches until at most |target_bytes| are resident (including pending
+// accesses). |keep_ordinal| is never measured or reclaimed as its accessor has
+// yet to fault it in. When |measure_all| is set every tracked parameter is
+// measured even once under the target, including those previously dropped.
+//
+// Parameters measured with more resident memory than recorded accesses account
+// for were used by something that did not report it (such as device work using
+// an imported parameter) and become the most recently used.
+//
+// Must be called with the mutex held; the mutex is released while measuring
+// and reclaiming memory.
+static void iree_io_parameter_residency_trim_locked(
+    iree_io_parameter_residency_t* residency, uint64_t target_bytes,
+    uint32_t keep_ordinal, bool measure_all) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, target_bytes);
+
+  if (measure_all) {
+    iree_io_parameter_residency_observe_unlinked_locked(residency);
+  }
+
+  iree_io_parameter_residency_batch_entry_t
+      batch[IREE_IO_PARAMETER_RESIDENCY_BATCH_CAPACITY];
+  uint32_t cursor = residency->lru_tail;
+  // Bounds the work when concurrent touches reorder the list.
+  iree_host_size_t remaining_count = residency->record_count;
+  while (remaining_count > 0) {
+    // The next record may have been reclaimed while the mutex was released.
+    if (cursor != IREE_IO_PARAMETER_RESIDENCY_NONE &&
+        !residency->records[cursor].is_linked) {
+      cursor = residency->lru_tail;
+    }
+    if (cursor == IREE_IO_PARAMETER_RESIDENCY_NONE) break;
+    if (!measure_all &&
+        !iree_io_parameter_residency_is_over_locked(residency, target_bytes)) {
+      break;
+    }
+
+    // Capture the next batch walking from the cold end toward the head.
+    iree_host_size_t batch_count = 0;
+    for (; cursor != IREE_IO_PARAMETER_RESIDENCY_NONE &&
+           batch_count < IREE_ARRAYSIZE(batch);
+         cursor = residency->records[cursor].prev) {
+      if (cursor == keep_ordinal) continue;
+      const iree_io_parameter_residency_record_t* record =
+          &residency->records[cursor];
+      batch[batch_count++] = (iree_io_parameter_residency_batch_entry_t){
+          .ordinal = cursor,
+          .touch_count = record->touch_count,
+          .parameter = record->parameter,
+          .resident_length = record->resident_length,
+          .is_reclaimed = false,
+      };
+    }
+    remaining_count -= iree_min(remaining_count, batch_count);
+
+    // Measure without blocking touches as this may walk many pages.
+    iree_slim_mutex_unlock(&residency->mutex);
+    for (iree_host_size_t i = 0; i < batch_count; ++i) {
+      iree_host_size_t resident_length = 0;
+      iree_status_t status = iree_memory_query_resident_length(
+          batch[i].parameter.data, batch[i].parameter.data_length,
+          &resident_length);
+      if (iree_status_is_ok(status)) {
+        batch[i].resident_length = resident_length;
+      } else {
+        // Keep the last known residency if it cannot be measured.
+        iree_status_ignore(status);
+      }
+    }
+    iree_slim_mutex_lock(&residency->mutex);
+
+    // Apply the measurements to records not touched while unlocked.
+    for (iree_host_size_t i = 0; i < batch_count; ++i) {
+      if (!iree_io_parameter_residency_batch_entry_is_valid(residency,
+                                                            &batch[i])) {
+        continue;
+      }
+      const uint32_t ordinal = batch[i].ordinal;
+      const iree_io_parameter_residency_record_t* record =
+          &residency->records[ordinal];
+      const bool was_used = batch[i].resident_length >
+                            record->resident_length + record->pending_length;
+      iree_io_parameter_residency_update_record(
+          residency, ordinal, batch[i].resident_length, 0);
+      if (was_used) {
+        // Promoted records are no longer candidates for reclaiming below.
+        iree_io_parameter_residency_unlink(residency, ordinal);
+        iree_io_parameter_residency_link_head(residency, ordinal);
+        ++residency->records[ordinal].touch_count;
+      }
+    }
+
+    // Reclaim the coldest parameters of the batch while over the target.
+    iree_host_size_t reclaim_count = 0;
+    for (iree_host_size_t i = 0;
+         i < batch_count && !residency->reclaim_unavailable &&
+         iree_io_parameter_residency_is_over_locked(residency, target_bytes);
+         ++i) {
+      if (!iree_io_parameter_residency_batch_entry_is_valid(residency,
+                                                            &batch[i])) {
+        continue;
+      }
+      const uint32_t ordinal = batch[i].ordinal;
+      // Parameters the system already paged out are dropped without reclaiming.
+      if (residency->records[ordinal].resident_length > 0) {
+        batch[i].is_reclaimed = true;
+        ++reclaim_count;
+        ++residency->statistics.eviction_count;
+      }
+      residency->records[ordinal].unlinked_length = batch[i].resident_length;
+      iree_io_parameter_residency_update_record(residency, ordinal, 0, 0);
+      iree_io_parameter_residency_unlink(residency, ordinal);
+    }
+    if (!reclaim_count) continue;
+
+    // Reclaiming pages out memory and is done without blocking touches. The
+    // memory remains valid and a parameter touched in the meantime is faulted
+    // back in when used.
+    iree_slim_mutex_unlock(&residency->mutex);
+    iree_status_t status = iree_ok_status();
+    iree_host_size_t failed_i = batch_count;
+    for (iree_host_size_t i = 0; i < batch_count; ++i) {
+      if (!batch[i].is_reclaimed) continue;
+      status = iree_memory_reclaim(batch[i].parameter.data,
+                                   batch[i].parameter.data_length);
+      if (!iree_status_is_ok(status)) {
+        failed_i = i;
+        break;
+      }
+    }
+    iree_slim_mutex_lock(&residency->mutex);
+    if (iree_status_is_ok(status)) continue;
+
+    // Reclaiming is a hint: put parameters that were not reclaimed back at the
+    // cold end with their measured residency and retry on the next trim.
+    if (iree_status_is_unavailable(status)) {
+      // Nothing can be reclaimed on this platform; keep tracking only.
+      residency->reclaim_unavailable = true;
+    }
+    iree_status_ignore(status);
+    for (iree_host_size_t i = failed_i; i < batch_count; ++i) {
+      if (!batch[i].is_reclaimed) continue;
+      --residency->statistics.eviction_count;
+      const uint32_t ordinal = batch[i].ordinal;
+      if (residency->records[ordinal].is_linked) continue;  // touched since
+      iree_io_parameter_residency_link_tail(residency, ordinal);
+      iree_io_parameter_residency_update_record(
+          residency, ordinal, batch[i].resident_length, 0);
+    }
+    break;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_residency_touch(
+    iree_io_parameter_residency_t* residency, const void* key,
+    iree_byte_span_t parameter, iree_byte_span_t access) {
+  IREE_ASSERT_ARGUMENT(residency);
+  IREE_ASSERT_ARGUMENT(key);
+
+  // Query residency outside of the lock as it may walk many pages.
+  iree_host_size_t access_resident_length = 0;
+  iree_host_size_t parameter_resident_length = 0;
+  iree_status_t status = iree_memory_query_resident_length(
+      access.data, access.data_length, &access_resident_length);
+  if (iree_status_is_ok(status)) {
+    if (access.data == parameter.data &&
+        access.data_length == parameter.data_length) {
+      parameter_resident_length = access_resident_length;
+    } else {
+      status = iree_memory_query_resident_length(
+          parameter.data, parameter.data_length, &parameter_resident_length);
+    }
+  }
+  if (iree_status_is_unavailable(status)) {
+    // Assume everything misses on platforms that cannot tell.
+    status = iree_status_ignore(status);
+  }
+  IREE_RETURN_IF_ERROR(status);
+
+  iree_slim_mutex_lock(&residency->mutex);
+
+  uint32_t ordinal = iree_io_parameter_residency_find(residency, key);
+  if (ordinal == IREE_IO_PARAMETER_RESIDENCY_NONE) {
+    status =
+        iree_io_parameter_residency_add(residency, key, parameter, &ordinal);
+  }
+
+  if (iree_status_is_ok(status)) {
+    if (access_resident_length >= access.data_length) {
+      ++residency->statistics.hit_count;
+    } else {
+      ++residency->statistics.miss_count;
+    }
+
+    // The parameter becomes the most recently used. Accessed bytes that are
+    // not yet resident are pending until the next measurement as the accessor
+    // will fault them in (if it hasn't already).
+    if (residency->records[ordinal].is_linked) {
+      iree_io_parameter_residency_unlink(residency, ordinal);
+    }
+    iree_io_parameter_residency_link_head(residency, ordinal);
+    ++residency->records[ordinal].touch_count;
+    iree_io_parameter_residency_update_record(
+        residency, ordinal, parameter_resident_length,
+        access.data_length - access_resident_length);
+
+    // Only measure when the budget may have been exceeded and then only from
+    // the cold end of the list until back under budget. Memory faulted in by
+    // unreported uses of other parameters is picked up by full trims.
+    if (residency->budget && iree_io_parameter_residency_is_over_locked(
+                                 residency, residency->budget)) {
+      iree_io_parameter_residency_trim_locked(residency, residency->budget,
+                                              ordinal, /*measure_all=*/false);
+    }
+  }
+
+  iree_slim_mutex_unlock(&residency->mutex);
+  return status;
+}
+
+IREE_API_EXPORT void iree_io_parameter_residency_trim(
+    iree_io_parameter_residency_t* residency, uint64_t target_bytes) {
+  IREE_ASSERT_ARGUMENT(residency);
+  iree_slim_mutex_lock(&residency->mutex);
+  iree_io_parameter_residency_trim_locked(residency, target_bytes,
+                                          IREE_IO_PARAMETER_RESIDENCY_NONE,
+                                          /*measure_all=*/true);
+  iree_slim_mutex_unlock(&residency->mutex);
+}
+
+IREE_API_EXPORT void iree_io_parameter_residency_query_statistics(
+    iree_io_parameter_residency_t* residency,
+    iree_io_parameter_provider_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(residency);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_slim_mutex_lock(&residency->mutex);
+  *out_statistics = residency->statistics;
+  iree_slim_mutex_unlock(&residency->mutex);
+}
@@ -0,0 +1,163 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARAMETER_RESIDENCY_H_
+#define IREE_IO_PARAMETER_RESIDENCY_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/io/parameter_provider.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_residency_t
+//===----------------------------------------------------------------------===//
+
+// Controls how parameter backing memory is made resident.
+typedef enum iree_io_parameter_residency_mode_e {
+  // Parameters are made resident by whichever path serves them and residency
+  // is not tracked.
+  IREE_IO_PARAMETER_RESIDENCY_MODE_EAGER = 0,
+  // Parameters backed by host memory (such as mapped files) are served without
+  // being touched and are faulted in by the system on first use. Accesses are
+  // recorded per parameter, residency is measured from the system (observing
+  // unreported uses that fault memory in), and the least-recently-used
+  // parameters are reclaimed when the resident total exceeds the budget.
+  IREE_IO_PARAMETER_RESIDENCY_MODE_LAZY = 1,
+} iree_io_parameter_residency_mode_t;
+
+typedef struct iree_io_parameter_residency_options_t {
+  // Residency mode of parameters served by a provider.
+  iree_io_parameter_residency_mode_t mode;
+  // Maximum bytes of parameter backing memory to keep resident when lazy or 0
+  // for unlimited. Parameters are reclaimed in least-recently-used order and
+  // the most recently used parameter is always kept even if over budget.
+  uint64_t budget;
+  // Interval between background trims when lazy with a budget or 0 to only
+  // trim when accesses are recorded. Background trims measure all parameters
+  // to observe uses that were not recorded (such as device work using imported
+  // parameters) and reclaim memory faulted in by them.
+  iree_duration_t trim_interval;
+} iree_io_parameter_residency_options_t;
+
+// Returns default residency options (eager, unlimited budget).
+static inline iree_io_parameter_residency_options_t
+iree_io_parameter_residency_options_default(void) {
+  iree_io_parameter_residency_options_t options = {
+      IREE_IO_PARAMETER_RESIDENCY_MODE_EAGER,
+      0,
+      0,
+  };
+  return options;
+}
+
+typedef struct iree_io_parameter_residency_record_t
+    iree_io_parameter_residency_record_t;
+
+// Tracks the residency of parameters backed by host memory and reclaims the
+// least-recently-used ones to stay under a memory budget. Reclaimed memory is
+// only paged out (never discarded) so parameters remain valid and are faulted
+// back in by the system when used again.
+//
+// Recency comes from the accesses reported via
+// iree_io_parameter_residency_touch and from measurements: residency is
+// measured from the pages the system reports as resident (mincore) and a
+// parameter with more resident memory than its reported accesses account for
+// was used by something that did not report it and becomes the most recently
+// used. Reported accesses that may exceed the budget measure and reclaim
+// parameters from the least-recently-used end only until back under budget;
+// full trims (iree_io_parameter_residency_trim, optionally run periodically on
+// a background thread) measure all parameters. Measuring and reclaiming memory
+// is done without holding the tracker lock.
+//
+// Thread-safe.
+typedef struct iree_io_parameter_residency_t {
+  iree_allocator_t host_allocator;
+  iree_slim_mutex_t mutex;
+  // Resident memory budget in bytes or 0 if unlimited.
+  uint64_t budget;
+  // Set once the platform reports it cannot reclaim memory to avoid retrying.
+  bool reclaim_unavailable;
+  // Records in insertion order. Indices are stable for the tracker lifetime.
+  iree_host_size_t record_count;
+  iree_host_size_t record_capacity;
+  iree_io_parameter_residency_record_t* records;
+  // Open-addressed table of record ordinal + 1 (0 if empty) keyed by record
+  // key. Power-of-two capacity.
+  iree_host_size_t slot_capacity;
+  uint32_t* slots;
+  // Most and least recently used records or UINT32_MAX if none.
+  uint32_t lru_head;
+  uint32_t lru_tail;
+  // Bytes accessed since last measured that were not resident at the time.
+  // Added to the measured resident bytes this bounds the actual residency.
+  uint64_t pending_bytes;
+  // Running statistics; budget_bytes mirrors |budget|.
+  iree_io_parameter_provider_statistics_t statistics;
+  // Background thread running periodic trims or NULL if not started.
+  iree_thread_t* trim_thread;
+  // Interval between background trims.
+  iree_duration_t trim_interval;
+  // Posted when the background thread is requested to exit.
+  iree_notification_t trim_notification;
+  // Set to 1 when the background thread is requested to exit.
+  iree_atomic_int32_t trim_exit_requested;
+} iree_io_parameter_residency_t;
+
+// Initializes |out_residency| to track parameters with the given |budget| in
+// bytes (0 for unlimited).
+IREE_API_EXPORT void iree_io_parameter_residency_initialize(
+    uint64_t budget, iree_allocator_t host_allocator,
+    iree_io_parameter_residency_t* out_residency);
+
+// Starts a background thread trimming |residency| to its budget every
+// |interval|. Has no effect if the budget is unlimited. The thread is stopped
+// when the tracker is deinitialized.
+IREE_API_EXPORT iree_status_t iree_io_parameter_residency_start_trimming(
+    iree_io_parameter_residency_t* residency, iree_duration_t interval);
+
+// Deinitializes |residency|. Tracked memory is left as-is.
+IREE_API_EXPORT void iree_io_parameter_residency_deinitialize(
+    iree_io_parameter_residency_t* residency);
+
+// Records an access to the |access| range of the parameter identified by |key|
+// whose backing memory is |parameter|. The access counts as a hit if all of the
+// accessed memory is already resident and a miss otherwise. The parameter
+// becomes the most recently used and colder parameters are reclaimed if the
+// resident total (including the bytes the access will fault in) may exceed the
+// budget. Accesses may be recorded before or after they are made.
+//
+// |key| must uniquely identify the parameter for the lifetime of the tracker
+// (such as the address of its index entry) and |access| must be contained
+// within |parameter|.
+IREE_API_EXPORT iree_status_t iree_io_parameter_residency_touch(
+    iree_io_parameter_residency_t* residency, const void* key,
+    iree_byte_span_t parameter, iree_byte_span_t access);
+
+// Measures the residency of all tracked parameters and reclaims
+// least-recently-used ones until at most |target_bytes| are resident.
+// Parameters observed to have been used since last measured become the most
+// recently used before any are reclaimed.
+IREE_API_EXPORT void iree_io_parameter_residency_trim(
+    iree_io_parameter_residency_t* residency, uint64_t target_bytes);
+
+// Returns the current residency statistics in |out_statistics|.
+IREE_API_EXPORT void iree_io_parameter_residency_query_statistics(
+    iree_io_parameter_residency_t* residency,
+    iree_io_parameter_provider_statistics_t* out_statistics);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARAMETER_RESIDENCY_H_
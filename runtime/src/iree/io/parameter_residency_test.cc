@@ -0,0 +1,251 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_residency.h"
+
+#include "iree/base/api.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+
+#include <sys/mman.h>
+
+#include <cstring>
+
+#include "iree/base/internal/memory.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+class ParameterResidencyTest : public ::testing::Test {
+ protected:
+  static constexpr iree_host_size_t kPagesPerParameter = 2;
+  static constexpr iree_host_size_t kParameterCount = 3;
+
+  void SetUp() override {
+    page_size_ = iree_memory_query_info().normal_page_size;
+    parameter_size_ = kPagesPerParameter * page_size_;
+    // Anonymous pages are not resident until first written.
+    base_ = (uint8_t*)mmap(NULL, kParameterCount * parameter_size_,
+                           PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1, 0);
+    ASSERT_NE(base_, MAP_FAILED);
+  }
+
+  void TearDown() override {
+    munmap(base_, kParameterCount * parameter_size_);
+  }
+
+  iree_byte_span_t Parameter(iree_host_size_t i) {
+    return iree_make_byte_span(base_ + i * parameter_size_, parameter_size_);
+  }
+
+  // Records an access to all of parameter |i| using the span address as the
+  // key without accessing it.
+  void Touch(iree_io_parameter_residency_t* residency, iree_host_size_t i) {
+    IREE_ASSERT_OK(iree_io_parameter_residency_touch(
+        residency, Parameter(i).data, Parameter(i), Parameter(i)));
+  }
+
+  // Records an access to all of parameter |i| and then makes it.
+  void Use(iree_io_parameter_residency_t* residency, iree_host_size_t i) {
+    Touch(residency, i);
+    std::memset(Parameter(i).data, 0xCD, parameter_size_);
+  }
+
+  iree_io_parameter_provider_statistics_t Query(
+      iree_io_parameter_residency_t* residency) {
+    iree_io_parameter_provider_statistics_t statistics;
+    iree_io_parameter_residency_query_statistics(residency, &statistics);
+    return statistics;
+  }
+
+  // Measures residency without reclaiming anything and returns the statistics.
+  iree_io_parameter_provider_statistics_t Measure(
+      iree_io_parameter_residency_t* residency) {
+    iree_io_parameter_residency_trim(residency, UINT64_MAX);
+    return Query(residency);
+  }
+
+  iree_host_size_t page_size_ = 0;
+  iree_host_size_t parameter_size_ = 0;
+  uint8_t* base_ = NULL;
+};
+
+TEST_F(ParameterResidencyTest, HitsAndMisses) {
+  iree_io_parameter_residency_t residency;
+  iree_io_parameter_residency_initialize(/*budget=*/0, iree_allocator_system(),
+                                         &residency);
+
+  // Untouched memory misses and is not resident until the access is made.
+  Touch(&residency, 0);
+  auto statistics = Query(&residency);
+  EXPECT_EQ(statistics.hit_count, 0);
+  EXPECT_EQ(statistics.miss_count, 1);
+  EXPECT_EQ(statistics.resident_bytes, 0);
+
+  // Once faulted in the parameter hits and is measured as resident.
+  std::memset(Parameter(0).data, 0xCD, parameter_size_);
+  Touch(&residency, 0);
+  statistics = Query(&residency);
+  EXPECT_EQ(statistics.hit_count, 1);
+  EXPECT_EQ(statistics.miss_count, 1);
+  EXPECT_EQ(statistics.resident_bytes, parameter_size_);
+  EXPECT_EQ(statistics.eviction_count, 0);
+
+  iree_io_parameter_residency_deinitialize(&residency);
+}
+
+// Memory faulted in after an access is recorded is measured when trimming.
+TEST_F(ParameterResidencyTest, MeasuresFaultedMemory) {
+  iree_io_parameter_residency_t residency;
+  iree_io_parameter_residency_initialize(/*budget=*/0, iree_allocator_system(),
+                                         &residency);
+  Use(&residency, 0);
+  Use(&residency, 1);
+  EXPECT_EQ(Query(&residency).resident_bytes, 0);
+  EXPECT_EQ(Measure(&residency).resident_bytes, 2 * parameter_size_);
+  EXPECT_EQ(Query(&residency).eviction_count, 0);
+  iree_io_parameter_residency_deinitialize(&residency);
+}
+
+TEST_F(ParameterResidencyTest, EvictsLeastRecentlyUsed) {
+  iree_status_t reclaim_status = iree_memory_reclaim(base_, page_size_);
+  if (iree_status_is_unavailable(reclaim_status)) {
+    iree_status_ignore(reclaim_status);
+    GTEST_SKIP() << "platform cannot reclaim pages";
+  }
+  IREE_ASSERT_OK(reclaim_status);
+
+  iree_io_parameter_residency_t residency;
+  iree_io_parameter_residency_initialize(
+      /*budget=*/2 * parameter_size_, iree_allocator_system(), &residency);
+
+  // Fill the budget with 0 and 1 and then use 1 so that 0 is the coldest.
+  Use(&residency, 0);
+  Use(&residency, 1);
+  Use(&residency, 1);
+  auto statistics = Measure(&residency);
+  EXPECT_EQ(statistics.eviction_count, 0);
+  EXPECT_EQ(statistics.resident_bytes, 2 * parameter_size_);
+  EXPECT_EQ(statistics.budget_bytes, 2 * parameter_size_);
+
+  // Going over budget reclaims 0 before 2 is faulted in.
+  Use(&residency, 2);
+  statistics = Query(&residency);
+  EXPECT_EQ(statistics.eviction_count, 1);
+
+  // Using 0 again makes 1 the coldest.
+  Use(&residency, 0);
+  statistics = Query(&residency);
+  EXPECT_EQ(statistics.eviction_count, 2);
+
+  // Trimming reclaims everything.
+  iree_io_parameter_residency_trim(&residency, 0);
+  statistics = Query(&residency);
+  EXPECT_EQ(statistics.eviction_count, 4);
+  EXPECT_EQ(statistics.resident_bytes, 0);
+
+  iree_io_parameter_residency_deinitialize(&residency);
+}
+
+// A single parameter larger than the budget is kept while in use.
+TEST_F(ParameterResidencyTest, KeepsMostRecentlyUsed) {
+  iree_io_parameter_residency_t residency;
+  iree_io_parameter_residency_initialize(
+      /*budget=*/page_size_, iree_allocator_system(), &residency);
+  Use(&residency, 0);
+  Touch(&residency, 0);
+  auto statistics = Query(&residency);
+  EXPECT_EQ(statistics.eviction_count, 0);
+  EXPECT_EQ(statistics.resident_bytes, parameter_size_);
+  iree_io_parameter_residency_deinitialize(&residency);
+}
+
+// Parameters faulted in without a recorded access (such as by device work
+// using an imported parameter) are observed when measuring and become the most
+// recently used.
+TEST_F(ParameterResidencyTest, ObservesUnrecordedUse) {
+  iree_status_t reclaim_status = iree_memory_reclaim(base_, page_size_);
+  if (iree_status_is_unavailable(reclaim_status)) {
+    iree_status_ignore(reclaim_status);
+    GTEST_SKIP() << "platform cannot reclaim pages";
+  }
+  IREE_ASSERT_OK(reclaim_status);
+
+  iree_io_parameter_residency_t residency;
+  iree_io_parameter_residency_initialize(
+      /*budget=*/2 * parameter_size_, iree_allocator_system(), &residency);
+
+  // 0 is the coldest once both are used.
+  Use(&residency, 0);
+  Use(&residency, 1);
+  EXPECT_EQ(Measure(&residency).resident_bytes, 2 * parameter_size_);
+
+  // The system drops 0 and then a page of it is used without recording it.
+  ASSERT_EQ(madvise(Parameter(0).data, parameter_size_, MADV_DONTNEED), 0);
+  EXPECT_EQ(Measure(&residency).resident_bytes, parameter_size_);
+  std::memset(Parameter(0).data, 0xCD, page_size_);
+  EXPECT_EQ(Measure(&residency).resident_bytes, parameter_size_ + page_size_);
+
+  // 0 is now the most recently used so trimming reclaims only 1.
+  iree_io_parameter_residency_trim(&residency, page_size_);
+  auto statistics = Query(&residency);
+  EXPECT_EQ(statistics.eviction_count, 1);
+  EXPECT_EQ(statistics.resident_bytes, page_size_);
+
+  iree_io_parameter_residency_deinitialize(&residency);
+}
+
+// Background trims observe unrecorded uses and reclaim memory they fault in.
+TEST_F(ParameterResidencyTest, TrimsInBackground) {
+  iree_status_t reclaim_status = iree_memory_reclaim(base_, page_size_);
+  if (iree_status_is_unavailable(reclaim_status)) {
+    iree_status_ignore(reclaim_status);
+    GTEST_SKIP() << "platform cannot reclaim pages";
+  }
+  IREE_ASSERT_OK(reclaim_status);
+
+  iree_io_parameter_residency_t residency;
+  iree_io_parameter_residency_initialize(
+      /*budget=*/parameter_size_, iree_allocator_system(), &residency);
+
+  // Record loads of 0 and 1 without using them; 0 is dropped as it is not
+  // resident when 1 goes over budget.
+  Touch(&residency, 0);
+  Touch(&residency, 1);
+  IREE_ASSERT_OK(iree_io_parameter_residency_start_trimming(
+      &residency, /*interval=*/1000000));
+
+  // Waits for a background trim to produce |predicate| statistics.
+  auto wait_for = [&](auto predicate) {
+    for (int i = 0; i < 5000; ++i) {
+      if (predicate(Query(&residency))) return true;
+      iree_wait_until(iree_time_now() + 1000000);
+    }
+    return false;
+  };
+
+  // Using 0 without recording it is observed as resident.
+  std::memset(Parameter(0).data, 0xCD, parameter_size_);
+  EXPECT_TRUE(wait_for([&](const iree_io_parameter_provider_statistics_t& s) {
+    return s.resident_bytes == parameter_size_;
+  }));
+  EXPECT_EQ(Query(&residency).eviction_count, 0);
+
+  // Using 1 as well goes over budget and reclaims 0 as the colder one.
+  std::memset(Parameter(1).data, 0xCD, parameter_size_);
+  EXPECT_TRUE(wait_for([&](const iree_io_parameter_provider_statistics_t& s) {
+    return s.eviction_count >= 1;
+  }));
+
+  iree_io_parameter_residency_deinitialize(&residency);
+}
+
+}  // namespace
+
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_APPLE || IREE_PLATFORM_LINUX
@@ -318,6 +318,10 @@ static iree_status_t iree_io_stdio_stream_read(
     }
     bytes_read += read_size;
   }
+  if (iree_status_is_ok(status) && out_buffer_length &&
+      bytes_read == buffer_capacity) {
+    *out_buffer_length = bytes_read;
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -19,6 +19,10 @@
 // The order of these functions must be sorted ascending by name in a way
 // compatible with iree_string_view_compare.
 //
+// EXPORT_FN_REGISTER additionally provides a register-call target used by the
+// bytecode interpreter to pass arguments and results in its registers. Only
+// hot functions where the ABI marshaling is measurable should provide one.
+//
 // Users are meant to `#define EXPORT_FN` to be able to access the information.
 // #define EXPORT_FN(name, arg_type, ret_type, target_fn)
 
@@ -35,7 +39,7 @@ EXPORT_FN("buffer.subspan", iree_hal_module_buffer_subspan, rII, r)
 
 EXPORT_FN("buffer_view.assert", iree_hal_module_buffer_view_assert, rriiCID, v)
 EXPORT_FN("buffer_view.buffer", iree_hal_module_buffer_view_buffer, r, r)
-EXPORT_FN("buffer_view.create", iree_hal_module_buffer_view_create, rIIiiCID, r)
+EXPORT_FN_REGISTER("buffer_view.create", iree_hal_module_buffer_view_create, iree_hal_module_buffer_view_create_registers, rIIiiCID, r)
 EXPORT_FN("buffer_view.dim", iree_hal_module_buffer_view_dim, ri, I)
 EXPORT_FN("buffer_view.element_type", iree_hal_module_buffer_view_element_type, r, i)
 EXPORT_FN("buffer_view.encoding_type", iree_hal_module_buffer_view_encoding_type, r, i)
@@ -50,7 +54,7 @@ EXPORT_FN("command_buffer.begin_debug_group", iree_hal_module_command_buffer_beg
 EXPORT_FN("command_buffer.collective", iree_hal_module_command_buffer_collective, rriirIIrIII, v)
 EXPORT_FN("command_buffer.copy_buffer", iree_hal_module_command_buffer_copy_buffer, rrIrII, v)
 EXPORT_FN("command_buffer.create", iree_hal_module_command_buffer_create, riii, r)
-EXPORT_FN("command_buffer.dispatch", iree_hal_module_command_buffer_dispatch, rriiii, v)
+EXPORT_FN_REGISTER("command_buffer.dispatch", iree_hal_module_command_buffer_dispatch, iree_hal_module_command_buffer_dispatch_registers, rriiii, v)
 EXPORT_FN("command_buffer.dispatch.indirect", iree_hal_module_command_buffer_dispatch_indirect, rrirI, v)
 EXPORT_FN("command_buffer.end_debug_group", iree_hal_module_command_buffer_end_debug_group, r, v)
 EXPORT_FN("command_buffer.execute.commands", iree_hal_module_command_buffer_execute_commands, rrCrIID, v)
@@ -132,6 +132,37 @@ iree_hal_module_free_state(void* self, iree_vm_module_state_t* module_state) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+static iree_status_t IREE_API_PTR iree_hal_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_state,
+    iree_allocator_t host_allocator,
+    iree_vm_module_state_t** out_module_state) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Executable caches are shared with the parent so that executables loaded
+  // during initialization of the parent are reused by the fork.
+  iree_hal_module_state_t* parent = (iree_hal_module_state_t*)parent_state;
+  iree_hal_module_state_t* state = NULL;
+  iree_host_size_t total_size =
+      sizeof(*state) +
+      parent->device_count * sizeof(state->executable_caches[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&state));
+  memset(state, 0, total_size);
+  state->host_allocator = host_allocator;
+  state->flags = parent->flags;
+  state->device_count = parent->device_count;
+  state->devices = parent->devices;
+  state->loop_status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < state->device_count; ++i) {
+    state->executable_caches[i] = parent->executable_caches[i];
+    iree_hal_executable_cache_retain(state->executable_caches[i]);
+  }
+
+  *out_module_state = (iree_vm_module_state_t*)state;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 // Returns an unretained reference to the executable cache for the given device.
 // If the same device is registered multiple times the first cache is returned.
 static iree_status_t iree_hal_module_state_lookup_executable_cache(
@@ -486,20 +517,17 @@ IREE_VM_ABI_EXPORT(iree_hal_module_buffer_store,  //
 // iree_hal_buffer_view_t
 //===----------------------------------------------------------------------===//
 
-IREE_VM_ABI_EXPORT(iree_hal_module_buffer_view_create,  //
-                   iree_hal_module_state_t,             //
-                   rIIiiCID, r) {
+// Shared by the ABI and register-call exports of buffer_view.create.
+static iree_status_t iree_hal_module_buffer_view_create_common(
+    iree_vm_stack_t* stack, iree_hal_module_state_t* state,
+    iree_vm_ref_t source_buffer_ref, iree_device_size_t source_offset,
+    iree_device_size_t source_length, iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type, iree_host_size_t shape_rank,
+    const iree_hal_dim_t* shape_dims,
+    iree_hal_buffer_view_t** out_buffer_view) {
   iree_hal_buffer_t* source_buffer = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_check_deref(args->r0, &source_buffer));
-  iree_device_size_t source_offset = iree_hal_cast_device_size(args->i1);
-  iree_device_size_t source_length = iree_hal_cast_device_size(args->i2);
-  iree_hal_element_type_t element_type = (iree_hal_element_type_t)args->i3;
-  iree_hal_encoding_type_t encoding_type = (iree_hal_encoding_type_t)args->i4;
-  iree_host_size_t shape_rank = 0;
-  iree_hal_dim_t* shape_dims = NULL;
-  // TODO(benvanik): avoid the cast/alloca if not required.
-  IREE_VM_ABI_VLA_STACK_CAST(args, a5_count, a5, iree_hal_dim_t, 128,
-                             &shape_rank, &shape_dims);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_buffer_check_deref(source_buffer_ref, &source_buffer));
 
   iree_hal_buffer_t* subspan_buffer = NULL;
   if (source_offset != 0 ||
@@ -512,17 +540,75 @@ IREE_VM_ABI_EXPORT(iree_hal_module_buffer_view_create,  //
         source_offset, source_length);
   }
 
-  iree_hal_buffer_view_t* buffer_view = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_view_create(
+  iree_status_t status = iree_hal_buffer_view_create(
       subspan_buffer ? subspan_buffer : source_buffer, shape_rank, shape_dims,
-      element_type, encoding_type, state->host_allocator, &buffer_view));
+      element_type, encoding_type,
+      iree_vm_stack_object_allocator(stack, state->host_allocator),
+      out_buffer_view);
 
   iree_hal_buffer_release(subspan_buffer);
+  return status;
+}
 
+IREE_VM_ABI_EXPORT(iree_hal_module_buffer_view_create,  //
+                   iree_hal_module_state_t,             //
+                   rIIiiCID, r) {
+  iree_device_size_t source_offset = iree_hal_cast_device_size(args->i1);
+  iree_device_size_t source_length = iree_hal_cast_device_size(args->i2);
+  iree_hal_element_type_t element_type = (iree_hal_element_type_t)args->i3;
+  iree_hal_encoding_type_t encoding_type = (iree_hal_encoding_type_t)args->i4;
+  iree_host_size_t shape_rank = 0;
+  iree_hal_dim_t* shape_dims = NULL;
+  // TODO(benvanik): avoid the cast/alloca if not required.
+  IREE_VM_ABI_VLA_STACK_CAST(args, a5_count, a5, iree_hal_dim_t, 128,
+                             &shape_rank, &shape_dims);
+
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_module_buffer_view_create_common(
+      stack, state, args->r0, source_offset, source_length, element_type,
+      encoding_type, shape_rank, shape_dims, &buffer_view));
   rets->r0 = iree_hal_buffer_view_move_ref(buffer_view);
   return iree_ok_status();
 }
 
+// Register-call variant of buffer_view.create (rIIiiCID -> r).
+// The shape dims are the flattened span starting at argument 5 with the count
+// stored in the segment size of the span (cconv position 5).
+static iree_status_t iree_hal_module_buffer_view_create_registers(
+    iree_vm_stack_t* IREE_RESTRICT stack, void* IREE_RESTRICT module,
+    iree_hal_module_state_t* IREE_RESTRICT state,
+    const iree_vm_native_register_call_t* IREE_RESTRICT call) {
+  iree_device_size_t source_offset =
+      iree_hal_cast_device_size(iree_vm_native_register_call_arg_i64(call, 1));
+  iree_device_size_t source_length =
+      iree_hal_cast_device_size(iree_vm_native_register_call_arg_i64(call, 2));
+  iree_hal_element_type_t element_type =
+      (iree_hal_element_type_t)iree_vm_native_register_call_arg_i32(call, 3);
+  iree_hal_encoding_type_t encoding_type =
+      (iree_hal_encoding_type_t)iree_vm_native_register_call_arg_i32(call, 4);
+  iree_host_size_t shape_rank =
+      call->segment_sizes ? (uint16_t)call->segment_sizes->registers[5] : 0;
+  if (IREE_UNLIKELY(shape_rank > 128)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE, "count %u > %u",
+                            (uint32_t)shape_rank, 128u);
+  }
+  iree_hal_dim_t* shape_dims =
+      (iree_hal_dim_t*)iree_alloca(shape_rank * sizeof(iree_hal_dim_t));
+  for (iree_host_size_t i = 0; i < shape_rank; ++i) {
+    shape_dims[i] =
+        (iree_hal_dim_t)iree_vm_native_register_call_arg_i64(call, 5 + i);
+  }
+
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_module_buffer_view_create_common(
+      stack, state, *iree_vm_native_register_call_arg_ref(call, 0),
+      source_offset, source_length, element_type, encoding_type, shape_rank,
+      shape_dims, &buffer_view));
+  iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_move_ref(buffer_view);
+  iree_vm_native_register_call_move_ref(call, 0, &buffer_view_ref);
+  return iree_ok_status();
+}
+
 IREE_VM_ABI_EXPORT(iree_hal_module_buffer_view_assert,  //
                    iree_hal_module_state_t,             //
                    rriiCID, v) {
@@ -687,6 +773,16 @@ IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_create,  //
                             IREE_HAL_MODULE_MAX_COMMAND_BUFFER_BINDING_COUNT);
   }
 
+  // When the hosting application has guaranteed that all work executes in
+  // program order we can let one-shot command buffers execute as they are
+  // recorded. Devices that can't execute inline ignore the mode bit.
+  if (iree_all_bits_set(state->flags, IREE_HAL_MODULE_FLAG_INLINE_EXECUTION) &&
+      iree_all_bits_set(modes, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT) &&
+      !iree_any_bit_set(modes, IREE_HAL_COMMAND_BUFFER_MODE_NESTED) &&
+      binding_capacity == 0) {
+    modes |= IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION;
+  }
+
   iree_hal_command_buffer_t* command_buffer = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_command_buffer_create(
       device, modes, command_categories, IREE_HAL_QUEUE_AFFINITY_ANY,
@@ -901,6 +997,31 @@ IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_dispatch,  //
                                           workgroup_z);
 }
 
+// Register-call variant of command_buffer.dispatch (rriiii -> v).
+static iree_status_t iree_hal_module_command_buffer_dispatch_registers(
+    iree_vm_stack_t* IREE_RESTRICT stack, void* IREE_RESTRICT module,
+    iree_hal_module_state_t* IREE_RESTRICT state,
+    const iree_vm_native_register_call_t* IREE_RESTRICT call) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_command_buffer_check_deref(
+      *iree_vm_native_register_call_arg_ref(call, 0), &command_buffer));
+  iree_hal_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_executable_check_deref(
+      *iree_vm_native_register_call_arg_ref(call, 1), &executable));
+  uint32_t entry_point =
+      (uint32_t)iree_vm_native_register_call_arg_i32(call, 2);
+  uint32_t workgroup_x =
+      (uint32_t)iree_vm_native_register_call_arg_i32(call, 3);
+  uint32_t workgroup_y =
+      (uint32_t)iree_vm_native_register_call_arg_i32(call, 4);
+  uint32_t workgroup_z =
+      (uint32_t)iree_vm_native_register_call_arg_i32(call, 5);
+
+  return iree_hal_command_buffer_dispatch(command_buffer, executable,
+                                          entry_point, workgroup_x, workgroup_y,
+                                          workgroup_z);
+}
+
 IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_dispatch_indirect,  //
                    iree_hal_module_state_t,                           //
                    rrirI, v) {
@@ -1256,8 +1377,8 @@ IREE_VM_ABI_EXPORT(iree_hal_module_fence_create,  //
 
   // Create fence with room for our single semaphore.
   iree_hal_fence_t* fence = NULL;
-  iree_status_t status =
-      iree_hal_fence_create(1, state->host_allocator, &fence);
+  iree_status_t status = iree_hal_fence_create(
+      1, iree_vm_stack_object_allocator(stack, state->host_allocator), &fence);
   if (iree_status_is_ok(status)) {
     status = iree_hal_fence_insert(fence, semaphore, 1ull);
   }
@@ -1304,7 +1425,9 @@ IREE_VM_ABI_EXPORT(iree_hal_module_fence_join,  //
   // deduplication.
   iree_hal_fence_t* joined_fence = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_fence_create(
-      total_timepoint_capacity, state->host_allocator, &joined_fence));
+      total_timepoint_capacity,
+      iree_vm_stack_object_allocator(stack, state->host_allocator),
+      &joined_fence));
 
   // Insert all timepoints from all fences. This is slow in cases where there
   // are a lot of unique fences.
@@ -1598,7 +1721,17 @@ static const iree_vm_native_function_ptr_t iree_hal_module_funcs_[] = {
           iree_vm_shim_##arg_types##_##ret_types,              \
       .target = (iree_vm_native_function_target_t)(target_fn), \
   },
+#define EXPORT_FN_REGISTER(name, target_fn, register_fn, arg_types, \
+                           ret_types)                               \
+  {                                                                 \
+      .shim = (iree_vm_native_function_shim_t)                      \
+          iree_vm_shim_##arg_types##_##ret_types,                   \
+      .target = (iree_vm_native_function_target_t)(target_fn),      \
+      .register_target =                                            \
+          (iree_vm_native_function_register_target_t)(register_fn), \
+  },
 #include "iree/modules/hal/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN_REGISTER
 #undef EXPORT_FN
 };
 
@@ -1614,7 +1747,11 @@ static const iree_vm_native_export_descriptor_t iree_hal_module_exports_[] = {
       .attr_count = 0,                                             \
       .attrs = NULL,                                               \
   },
+#define EXPORT_FN_REGISTER(name, target_fn, register_fn, arg_types, \
+                           ret_types)                               \
+  EXPORT_FN(name, target_fn, arg_types, ret_types)
 #include "iree/modules/hal/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN_REGISTER
 #undef EXPORT_FN
 };
 static_assert(IREE_ARRAYSIZE(iree_hal_module_funcs_) ==
@@ -1653,6 +1790,7 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
       .destroy = iree_hal_module_destroy,
       .alloc_state = iree_hal_module_alloc_state,
       .free_state = iree_hal_module_free_state,
+      .fork_state = iree_hal_module_fork_state,
       .notify = iree_hal_module_notify,
   };
 
@@ -23,6 +23,18 @@ enum iree_hal_module_flag_bits_t {
 
   // Forces HAL methods to block instead of yielding as a coroutine.
   IREE_HAL_MODULE_FLAG_SYNCHRONOUS = 1u << 0,
+
+  // Allows one-shot command buffers created by programs to execute inline as
+  // they are recorded (IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION).
+  // Devices supporting inline execution such as local-sync then run dispatches
+  // directly from the VM without recording into and replaying a deferred
+  // command buffer on submission.
+  //
+  // Only valid for single-device deployments where all device work executes
+  // synchronously in program order: the waits of a command buffer submission
+  // must already be satisfied when the command buffer is recorded. Hosting
+  // applications must not pass unsignaled wait fences to invocations.
+  IREE_HAL_MODULE_FLAG_INLINE_EXECUTION = 1u << 1,
 };
 typedef uint32_t iree_hal_module_flags_t;
 
@@ -67,6 +67,15 @@ static void IREE_API_PTR iree_io_parameters_module_free_state(
   IREE_TRACE_ZONE_END(z0);
 }
 
+static iree_status_t IREE_API_PTR iree_io_parameters_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_state,
+    iree_allocator_t host_allocator,
+    iree_vm_module_state_t** out_module_state) {
+  // Providers are owned by the module and the state has nothing to copy.
+  return iree_io_parameters_module_alloc_state(self, host_allocator,
+                                               out_module_state);
+}
+
 static iree_status_t IREE_API_PTR iree_io_parameters_module_notify(
     void* self, iree_vm_module_state_t* module_state, iree_vm_signal_t signal) {
   iree_io_parameters_module_t* module = IREE_IO_PARAMETERS_MODULE_CAST(self);
@@ -475,6 +484,7 @@ IREE_API_EXPORT iree_status_t iree_io_parameters_module_create(
       .destroy = iree_io_parameters_module_destroy,
       .alloc_state = iree_io_parameters_module_alloc_state,
       .free_state = iree_io_parameters_module_free_state,
+      .fork_state = iree_io_parameters_module_fork_state,
       .notify = iree_io_parameters_module_notify,
   };
 
@@ -7,6 +7,9 @@
 #ifndef IREE_TASK_AFFINITY_SET_H_
 #define IREE_TASK_AFFINITY_SET_H_
 
+#include <stdbool.h>
+#include <string.h>
+
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/math.h"
 #include "iree/task/tuning.h"
@@ -25,17 +28,27 @@ extern "C" {
 // iree_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
+// A compact 64-bit affinity mask stored on each task.
+//
+// Each bit selects a worker *cluster*: a contiguous range of executor workers.
+// Executors with 64 or fewer workers use single-worker clusters such that bit N
+// maps directly to worker N. Larger executors group their workers into
+// power-of-two sized clusters (2 workers per bit for up to 128 workers, 4 for
+// up to 256, etc) so that the task header can stay small while a single
+// executor scales past 64 workers. Executors expand the affinity set into an
+// iree_task_worker_set_t when selecting workers.
 typedef uint64_t iree_task_affinity_set_t;
 
-// Allows for only a specific worker to be selected.
+// Allows for only a specific worker cluster to be selected.
+// When the executor has <= 64 workers this is the worker with the same index.
 static inline iree_task_affinity_set_t iree_task_affinity_for_worker(
-    uint8_t worker_index) {
+    iree_host_size_t worker_index) {
   return 1ull << worker_index;
 }
 
-// Allows for a range of workers to be selected.
+// Allows for a range of worker clusters to be selected.
 static inline iree_task_affinity_set_t iree_task_affinity_for_worker_range(
-    uint8_t worker_start, uint8_t worker_end) {
+    iree_host_size_t worker_start, iree_host_size_t worker_end) {
   return ((1ull << (worker_start - 1)) - 1) ^ ((1ull << worker_end) - 1);
 }
 
@@ -53,6 +66,124 @@ static inline iree_task_affinity_set_t iree_task_affinity_for_any_worker(void) {
 #define iree_task_affinity_set_count_ones(set) iree_math_count_ones_u64(set)
 #define iree_task_affinity_set_rotr(set, count) iree_math_rotr_u64(set, count)
 
+//===----------------------------------------------------------------------===//
+// iree_task_worker_set_t
+//===----------------------------------------------------------------------===//
+
+// Total number of 64-bit words required to hold one bit per worker.
+#define IREE_TASK_WORKER_SET_WORD_COUNT \
+  ((IREE_TASK_EXECUTOR_MAX_WORKER_COUNT + 63) / 64)
+
+// A bitset with one bit per executor-local worker index.
+// Used by executors to track worker state (live, idle, pending posts, etc) at
+// full worker granularity regardless of how many workers are present.
+typedef struct iree_task_worker_set_t {
+  uint64_t words[IREE_TASK_WORKER_SET_WORD_COUNT];
+} iree_task_worker_set_t;
+
+// Clears all bits in |set|.
+static inline void iree_task_worker_set_clear(iree_task_worker_set_t* set) {
+  memset(set, 0, sizeof(*set));
+}
+
+// Sets the first |count| bits in |set| and clears all others.
+static inline void iree_task_worker_set_fill_ones(iree_task_worker_set_t* set,
+                                                  iree_host_size_t count) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    if (count >= 64) {
+      set->words[i] = UINT64_MAX;
+      count -= 64;
+    } else {
+      set->words[i] = count ? iree_task_affinity_set_ones(count) : 0;
+      count = 0;
+    }
+  }
+}
+
+// Sets all bits in |set|.
+static inline void iree_task_worker_set_fill(iree_task_worker_set_t* set) {
+  memset(set, 0xFF, sizeof(*set));
+}
+
+// Sets the bit for |worker_index| in |set|.
+static inline void iree_task_worker_set_insert(iree_task_worker_set_t* set,
+                                               iree_host_size_t worker_index) {
+  set->words[worker_index / 64] |= 1ull << (worker_index % 64);
+}
+
+// Clears the bit for |worker_index| in |set|.
+static inline void iree_task_worker_set_erase(iree_task_worker_set_t* set,
+                                              iree_host_size_t worker_index) {
+  set->words[worker_index / 64] &= ~(1ull << (worker_index % 64));
+}
+
+// Returns true if the bit for |worker_index| is set in |set|.
+static inline bool iree_task_worker_set_contains(
+    const iree_task_worker_set_t* set, iree_host_size_t worker_index) {
+  return (set->words[worker_index / 64] >> (worker_index % 64)) & 1;
+}
+
+// Returns true if no bits are set in |set|.
+static inline bool iree_task_worker_set_is_empty(
+    const iree_task_worker_set_t* set) {
+  uint64_t any = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    any |= set->words[i];
+  }
+  return any == 0;
+}
+
+// Returns the total number of bits set in |set|.
+static inline int iree_task_worker_set_count_ones(
+    const iree_task_worker_set_t* set) {
+  int count = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    count += iree_math_count_ones_u64(set->words[i]);
+  }
+  return count;
+}
+
+// Performs |set| &= |other|.
+static inline void iree_task_worker_set_and(iree_task_worker_set_t* set,
+                                            const iree_task_worker_set_t* other) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    set->words[i] &= other->words[i];
+  }
+}
+
+// Performs |set| &= ~|other|.
+static inline void iree_task_worker_set_and_not(
+    iree_task_worker_set_t* set, const iree_task_worker_set_t* other) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    set->words[i] &= ~other->words[i];
+  }
+}
+
+// Performs |set| |= |other|.
+static inline void iree_task_worker_set_or(iree_task_worker_set_t* set,
+                                           const iree_task_worker_set_t* other) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    set->words[i] |= other->words[i];
+  }
+}
+
+// Returns the index of the first set bit at or after |start_index| or -1 if
+// there are no more bits set. Iterate over all set bits with:
+//   for (int i = iree_task_worker_set_find_next(set, 0); i >= 0;
+//        i = iree_task_worker_set_find_next(set, i + 1)) { ... }
+static inline int iree_task_worker_set_find_next(
+    const iree_task_worker_set_t* set, iree_host_size_t start_index) {
+  iree_host_size_t word_index = start_index / 64;
+  if (word_index >= IREE_TASK_WORKER_SET_WORD_COUNT) return -1;
+  uint64_t word = iree_shr(set->words[word_index], start_index % 64)
+                  << (start_index % 64);
+  while (!word) {
+    if (++word_index >= IREE_TASK_WORKER_SET_WORD_COUNT) return -1;
+    word = set->words[word_index];
+  }
+  return (int)(word_index * 64) + iree_math_count_trailing_zeros_u64(word);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_atomic_task_affinity_set_t
 //===----------------------------------------------------------------------===//
@@ -82,6 +213,66 @@ static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_fetch_or(
   return iree_atomic_fetch_or_int64(set, value, order);
 }
 
+//===----------------------------------------------------------------------===//
+// iree_atomic_task_worker_set_t
+//===----------------------------------------------------------------------===//
+
+// An iree_task_worker_set_t where each word is individually atomic.
+// Loads of the entire set are not atomic with respect to each other and callers
+// must be ok with observing tears across words; sets used in this way are only
+// ever hints (idle/live masks) and single-bit updates are always atomic.
+typedef struct iree_atomic_task_worker_set_t {
+  iree_atomic_int64_t words[IREE_TASK_WORKER_SET_WORD_COUNT];
+} iree_atomic_task_worker_set_t;
+
+static inline void iree_atomic_task_worker_set_load(
+    iree_atomic_task_worker_set_t* set, iree_memory_order_t order,
+    iree_task_worker_set_t* out_value) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    out_value->words[i] = (uint64_t)iree_atomic_load_int64(&set->words[i],
+                                                           order);
+  }
+}
+
+static inline void iree_atomic_task_worker_set_store(
+    iree_atomic_task_worker_set_t* set, const iree_task_worker_set_t* value,
+    iree_memory_order_t order) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    iree_atomic_store_int64(&set->words[i], (int64_t)value->words[i], order);
+  }
+}
+
+// Atomically sets the bit for |worker_index| and returns the prior value of
+// the word containing it.
+static inline uint64_t iree_atomic_task_worker_set_insert(
+    iree_atomic_task_worker_set_t* set, iree_host_size_t worker_index,
+    iree_memory_order_t order) {
+  return (uint64_t)iree_atomic_fetch_or_int64(
+      &set->words[worker_index / 64], (int64_t)(1ull << (worker_index % 64)),
+      order);
+}
+
+// Atomically clears the bit for |worker_index| and returns the prior value of
+// the word containing it.
+static inline uint64_t iree_atomic_task_worker_set_erase(
+    iree_atomic_task_worker_set_t* set, iree_host_size_t worker_index,
+    iree_memory_order_t order) {
+  return (uint64_t)iree_atomic_fetch_and_int64(
+      &set->words[worker_index / 64], (int64_t)~(1ull << (worker_index % 64)),
+      order);
+}
+
+// Returns the total number of bits set across all words in |set|.
+static inline int iree_atomic_task_worker_set_count_ones(
+    iree_atomic_task_worker_set_t* set, iree_memory_order_t order) {
+  int count = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    count += iree_math_count_ones_u64(
+        (uint64_t)iree_atomic_load_int64(&set->words[i], order));
+  }
+  return count;
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
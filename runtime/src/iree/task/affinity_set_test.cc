@@ -0,0 +1,112 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/affinity_set.h"
+
+#include <vector>
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+// Returns all set bit indices in |set| in ascending order.
+static std::vector<int> SetBits(const iree_task_worker_set_t* set) {
+  std::vector<int> bits;
+  for (int i = iree_task_worker_set_find_next(set, 0); i >= 0;
+       i = iree_task_worker_set_find_next(set, i + 1)) {
+    bits.push_back(i);
+  }
+  return bits;
+}
+
+TEST(WorkerSetTest, Empty) {
+  iree_task_worker_set_t set;
+  iree_task_worker_set_clear(&set);
+  EXPECT_TRUE(iree_task_worker_set_is_empty(&set));
+  EXPECT_EQ(0, iree_task_worker_set_count_ones(&set));
+  EXPECT_EQ(-1, iree_task_worker_set_find_next(&set, 0));
+  EXPECT_EQ(-1, iree_task_worker_set_find_next(
+                    &set, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT));
+}
+
+TEST(WorkerSetTest, FillOnes) {
+  iree_task_worker_set_t set;
+  iree_task_worker_set_fill_ones(&set, 0);
+  EXPECT_TRUE(iree_task_worker_set_is_empty(&set));
+  iree_task_worker_set_fill_ones(&set, 3);
+  EXPECT_EQ(3, iree_task_worker_set_count_ones(&set));
+  EXPECT_EQ((std::vector<int>{0, 1, 2}), SetBits(&set));
+  iree_task_worker_set_fill_ones(&set, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+  EXPECT_EQ(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT,
+            iree_task_worker_set_count_ones(&set));
+}
+
+TEST(WorkerSetTest, InsertEraseAcrossWords) {
+  if (IREE_TASK_EXECUTOR_MAX_WORKER_COUNT <= 64) {
+    GTEST_SKIP() << "multi-word worker sets not enabled";
+  }
+  iree_task_worker_set_t set;
+  iree_task_worker_set_clear(&set);
+  iree_task_worker_set_insert(&set, 0);
+  iree_task_worker_set_insert(&set, 63);
+  iree_task_worker_set_insert(&set, 64);
+  iree_task_worker_set_insert(&set, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1);
+  EXPECT_EQ(4, iree_task_worker_set_count_ones(&set));
+  EXPECT_TRUE(iree_task_worker_set_contains(&set, 63));
+  EXPECT_TRUE(iree_task_worker_set_contains(&set, 64));
+  EXPECT_FALSE(iree_task_worker_set_contains(&set, 65));
+  EXPECT_EQ((std::vector<int>{0, 63, 64,
+                              IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1}),
+            SetBits(&set));
+  EXPECT_EQ(63, iree_task_worker_set_find_next(&set, 1));
+  EXPECT_EQ(64, iree_task_worker_set_find_next(&set, 64));
+
+  iree_task_worker_set_erase(&set, 64);
+  EXPECT_FALSE(iree_task_worker_set_contains(&set, 64));
+  EXPECT_EQ(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1,
+            iree_task_worker_set_find_next(&set, 64));
+}
+
+TEST(WorkerSetTest, BitwiseOps) {
+  iree_task_worker_set_t a;
+  iree_task_worker_set_fill_ones(&a, 8);
+  iree_task_worker_set_t b;
+  iree_task_worker_set_clear(&b);
+  iree_task_worker_set_insert(&b, 2);
+  iree_task_worker_set_insert(&b, 12);
+
+  iree_task_worker_set_t c = a;
+  iree_task_worker_set_and(&c, &b);
+  EXPECT_EQ((std::vector<int>{2}), SetBits(&c));
+
+  c = a;
+  iree_task_worker_set_and_not(&c, &b);
+  EXPECT_EQ((std::vector<int>{0, 1, 3, 4, 5, 6, 7}), SetBits(&c));
+
+  c = a;
+  iree_task_worker_set_or(&c, &b);
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 12}), SetBits(&c));
+}
+
+TEST(AtomicWorkerSetTest, InsertErase) {
+  iree_atomic_task_worker_set_t atomic_set;
+  iree_task_worker_set_t set;
+  iree_task_worker_set_clear(&set);
+  iree_atomic_task_worker_set_store(&atomic_set, &set,
+                                    iree_memory_order_relaxed);
+  const iree_host_size_t high_index = IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1;
+  iree_atomic_task_worker_set_insert(&atomic_set, 1, iree_memory_order_relaxed);
+  iree_atomic_task_worker_set_insert(&atomic_set, high_index,
+                                     iree_memory_order_relaxed);
+  EXPECT_EQ(2, iree_atomic_task_worker_set_count_ones(
+                   &atomic_set, iree_memory_order_relaxed));
+  iree_atomic_task_worker_set_erase(&atomic_set, 1, iree_memory_order_relaxed);
+  iree_atomic_task_worker_set_load(&atomic_set, iree_memory_order_relaxed,
+                                   &set);
+  EXPECT_EQ((std::vector<int>{(int)high_index}), SetBits(&set));
+}
+
+}  // namespace
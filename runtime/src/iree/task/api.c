@@ -22,7 +22,8 @@ IREE_FLAG(
     "additional work. In almost all cases this should be 0 as spinning is\n"
     "often extremely harmful to system health. Only set to non-zero values\n"
     "when latency is the #1 priority (vs. thermals, system-wide scheduling,\n"
-    "etc).");
+    "etc). Workers adapt how long they spin within this budget and back off\n"
+    "when the system is oversubscribed.");
 
 IREE_FLAG(
     int32_t, task_worker_stack_size, 128 * 1024,
@@ -44,10 +45,46 @@ IREE_FLAG(
     "be configured to make at least that amount of local memory available.\n"
     "By default the CPU L2 cache size is used if such queries are supported.");
 
+IREE_FLAG(
+    string, task_scheduling_mode, "fifo",
+    "Selects how tasks are ordered when scheduled to workers as a\n"
+    "comma-separated list of [`fifo`, `priority`, `sjf`]. `priority` orders\n"
+    "work from higher priority scopes first and allows it to preempt lower\n"
+    "priority dispatches. `sjf` orders work with fewer workgroups first.");
+
+// Parses the --task_scheduling_mode flag into a scheduling mode bitfield.
+static iree_status_t iree_task_scheduling_mode_parse_from_flags(
+    iree_task_scheduling_mode_t* out_scheduling_mode) {
+  *out_scheduling_mode = IREE_TASK_SCHEDULING_MODE_FIFO;
+  iree_string_view_t remaining =
+      iree_make_cstring_view(FLAG_task_scheduling_mode);
+  while (!iree_string_view_is_empty(remaining)) {
+    iree_string_view_t mode_str = iree_string_view_empty();
+    iree_string_view_split(remaining, ',', &mode_str, &remaining);
+    mode_str = iree_string_view_trim(mode_str);
+    if (iree_string_view_is_empty(mode_str) ||
+        iree_string_view_equal(mode_str, IREE_SV("fifo"))) {
+      continue;
+    } else if (iree_string_view_equal(mode_str, IREE_SV("priority"))) {
+      *out_scheduling_mode |= IREE_TASK_SCHEDULING_MODE_PRIORITY;
+    } else if (iree_string_view_equal(mode_str, IREE_SV("sjf"))) {
+      *out_scheduling_mode |= IREE_TASK_SCHEDULING_MODE_SHORTEST_JOB_FIRST;
+    } else {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unknown task scheduling mode '%.*s'; expected "
+                              "one or more of `fifo`, `priority`, `sjf`",
+                              (int)mode_str.size, mode_str.data);
+    }
+  }
+  return iree_ok_status();
+}
+
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
   IREE_ASSERT_ARGUMENT(out_options);
   iree_task_executor_options_initialize(out_options);
+  IREE_RETURN_IF_ERROR(iree_task_scheduling_mode_parse_from_flags(
+      &out_options->scheduling_mode));
   out_options->worker_spin_ns =
       (iree_duration_t)FLAG_task_worker_spin_us * 1000;
   out_options->worker_stack_size =
@@ -72,7 +109,10 @@ IREE_FLAG(
     " 'physical_cores':\n"
     "   Creates one executor per NUMA node in --task_topology_nodes= and one\n"
     "   group per physical core in each NUMA node up to the value specified\n"
-    "   by --task_topology_max_group_count=.");
+    "   by --task_topology_max_group_count=.\n"
+    " 'threadless':\n"
+    "   Creates executors without any worker threads that only execute work\n"
+    "   on threads blocking on results (such as when waiting on semaphores).");
 
 IREE_FLAG(
     int32_t, task_topology_group_count, 0,
@@ -198,6 +238,9 @@ iree_status_t iree_task_topology_initialize_from_flags(
     return iree_task_topology_initialize_from_physical_cores(
         node_id, performance_level, FLAG_task_topology_max_group_count,
         out_topology);
+  } else if (strcmp(FLAG_task_topology_mode, "threadless") == 0) {
+    // No groups; all work is performed by donated caller threads.
+    return iree_ok_status();
   } else {
     return iree_make_status(
         IREE_STATUS_INVALID_ARGUMENT,
@@ -233,6 +276,11 @@ static void iree_task_flags_dump_task_topology(
     const iree_task_topology_group_t* group = &topology->groups[j];
     fprintf(stdout, "# group[%d]: '%s'\n", group->group_index, group->name);
     fprintf(stdout, "#      processor: %u\n", group->processor_index);
+    if (group->node_id != IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      fprintf(stdout, "#    memory node: %u\n", group->node_id);
+    } else {
+      fprintf(stdout, "#    memory node: (unknown)\n");
+    }
     fprintf(stdout, "#       affinity: ");
     if (group->ideal_thread_affinity.specified) {
       fprintf(
@@ -247,21 +295,20 @@ static void iree_task_flags_dump_task_topology(
             group->caches.l2_data);
 
     fprintf(stdout, "#  last level cache sharing: ");
-    if (group->constructive_sharing_mask == 0) {
+    const iree_task_topology_group_mask_t* sharing_mask =
+        &group->constructive_sharing_mask;
+    int sharing_count = iree_task_worker_set_count_ones(sharing_mask);
+    if (sharing_count == 0) {
       fprintf(stdout, "(none)\n");
-    } else if (group->constructive_sharing_mask ==
-               IREE_TASK_TOPOLOGY_GROUP_MASK_ALL) {
+    } else if (sharing_count == IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
       fprintf(stdout, "(all/undefined)\n");
     } else {
-      fprintf(stdout, "%d group(s): ",
-              iree_math_count_ones_u64(group->constructive_sharing_mask));
-      for (iree_host_size_t ic = 0, jc = 0;
-           ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
-        if ((group->constructive_sharing_mask >> ic) & 1) {
-          if (jc > 0) fprintf(stdout, ", ");
-          fprintf(stdout, "%" PRIhsz, ic);
-          ++jc;
-        }
+      fprintf(stdout, "%d group(s): ", sharing_count);
+      for (int ic = iree_task_worker_set_find_next(sharing_mask, 0), jc = 0;
+           ic >= 0; ic = iree_task_worker_set_find_next(sharing_mask, ic + 1)) {
+        if (jc > 0) fprintf(stdout, ", ");
+        fprintf(stdout, "%d", ic);
+        ++jc;
       }
       fprintf(stdout, "\n");
     }
@@ -27,6 +27,8 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor);
 void iree_task_executor_options_initialize(
     iree_task_executor_options_t* out_options) {
   memset(out_options, 0, sizeof(*out_options));
+  out_options->worker_dispatch_record_capacity =
+      IREE_TASK_WORKER_DEFAULT_DISPATCH_RECORD_CAPACITY;
 }
 
 // Returns the size of the worker local memory required by |group| in bytes.
@@ -47,6 +49,20 @@ static iree_host_size_t iree_task_topology_group_local_memory_size(
                          iree_hardware_destructive_interference_size);
 }
 
+// Returns the size of the dispatch record ring storage of each worker in bytes.
+static iree_host_size_t iree_task_executor_record_storage_size(
+    iree_task_executor_options_t options) {
+#if IREE_STATISTICS_ENABLE
+  if (!options.worker_dispatch_record_capacity) return 0;
+  iree_host_size_t capacity = iree_math_round_up_to_pow2_u32(
+      (uint32_t)options.worker_dispatch_record_capacity);
+  return iree_host_align(capacity * sizeof(iree_task_dispatch_record_t),
+                         iree_hardware_destructive_interference_size);
+#else
+  return 0;
+#endif  // IREE_STATISTICS_ENABLE
+}
+
 iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
                                         const iree_task_topology_t* topology,
                                         iree_allocator_t allocator,
@@ -59,24 +75,31 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
                             worker_count, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
   }
 
-  // TODO(benvanik): support a threadless mode where we have one dummy worker
-  // that just holds the lists but is pumped from donate_caller.
-  if (worker_count == 0) {
-    return iree_make_status(
-        IREE_STATUS_UNIMPLEMENTED,
-        "threadless donate-only executor mode not yet implemented");
+  // Threadless mode has one worker without a thread that holds the lists and
+  // is pumped from donate_caller. It is configured like a default worker.
+  const bool threadless = worker_count == 0;
+  iree_task_topology_group_t caller_group;
+  if (threadless) {
+    worker_count = 1;
+    iree_task_topology_group_initialize(/*group_index=*/0, &caller_group);
+    // NOTE: without platform queries we can't figure out cache sizes and just
+    // make a conservative guess (matching the default topology).
+    caller_group.caches.l1_data = 32 * 1024;
+    caller_group.caches.l2_data = 128 * 1024;
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_executor);
   *out_executor = NULL;
 
-  // The executor is followed in memory by worker[] + worker_local_memory[].
+  // The executor is followed in memory by worker[] + worker_local_memory[] +
+  // worker_record_storage[].
   iree_host_size_t total_worker_local_memory_size = 0;
   for (iree_host_size_t i = 0; i < worker_count; ++i) {
     total_worker_local_memory_size +=
         iree_task_topology_group_local_memory_size(
-            options, iree_task_topology_get_group(topology, i));
+            options, threadless ? &caller_group
+                                : iree_task_topology_get_group(topology, i));
   }
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)total_worker_local_memory_size);
 
@@ -86,8 +109,11 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   iree_host_size_t worker_list_size =
       iree_host_align(worker_count * sizeof(iree_task_worker_t),
                       iree_hardware_destructive_interference_size);
+  iree_host_size_t record_storage_size =
+      iree_task_executor_record_storage_size(options);
   iree_host_size_t executor_size =
-      executor_base_size + worker_list_size + total_worker_local_memory_size;
+      executor_base_size + worker_list_size + total_worker_local_memory_size +
+      worker_count * record_storage_size;
 
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -95,10 +121,14 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   memset(executor, 0, executor_size);
   iree_atomic_ref_count_init(&executor->ref_count);
   executor->allocator = allocator;
+  executor->threadless = threadless;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
+  iree_notification_set_initialize(&executor->worker_wake_set);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
+  iree_slim_mutex_initialize(&executor->donation_mutex);
+  iree_slim_mutex_initialize(&executor->record_drain_mutex);
 
   IREE_TRACE({
     static iree_atomic_int32_t executor_id = IREE_ATOMIC_VAR_INIT(0);
@@ -166,32 +196,43 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   if (iree_status_is_ok(status)) {
     executor->worker_base_index = options.worker_base_index;
     executor->worker_count = worker_count;
+    executor->memory_node_id = iree_task_topology_memory_node(topology);
     executor->workers =
         (iree_task_worker_t*)((uint8_t*)executor + executor_base_size);
     uint8_t* worker_local_memory =
         (uint8_t*)executor->workers + worker_list_size;
+    uint8_t* worker_record_storage =
+        worker_local_memory + total_worker_local_memory_size;
+
+    // Each bit of a task affinity set covers 2^shift workers such that all
+    // workers are addressable with 64 bits.
+    while ((64ull << executor->worker_cluster_shift) < worker_count) {
+      ++executor->worker_cluster_shift;
+    }
 
-    iree_task_affinity_set_t worker_mask =
-        iree_task_affinity_set_ones(worker_count);
+    iree_task_worker_set_t worker_mask;
+    iree_task_worker_set_fill_ones(&worker_mask, worker_count);
 
     for (iree_host_size_t i = 0; i < worker_count; ++i) {
       const iree_task_topology_group_t* group =
-          iree_task_topology_get_group(topology, i);
+          threadless ? &caller_group : iree_task_topology_get_group(topology, i);
       iree_host_size_t worker_local_memory_size =
           iree_task_topology_group_local_memory_size(options, group);
       iree_task_worker_t* worker = &executor->workers[i];
       status = iree_task_worker_initialize(
           executor, i, group, options.worker_stack_size,
           iree_make_byte_span(worker_local_memory, worker_local_memory_size),
+          iree_make_byte_span(worker_record_storage, record_storage_size),
           &seed_prng, worker);
       worker_local_memory += worker_local_memory_size;
+      worker_record_storage += record_storage_size;
       if (!iree_status_is_ok(status)) break;
     }
 
-    iree_atomic_task_affinity_set_store(&executor->worker_idle_mask,
-                                        worker_mask, iree_memory_order_release);
-    iree_atomic_task_affinity_set_store(&executor->worker_live_mask,
-                                        worker_mask, iree_memory_order_release);
+    iree_atomic_task_worker_set_store(&executor->worker_idle_mask,
+                                      &worker_mask, iree_memory_order_release);
+    iree_atomic_task_worker_set_store(&executor->worker_live_mask,
+                                      &worker_mask, iree_memory_order_release);
   }
 
   if (!iree_status_is_ok(status)) {
@@ -241,7 +282,10 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
   iree_task_poller_deinitialize(&executor->poller);
 
   iree_event_pool_free(executor->event_pool);
+  iree_slim_mutex_deinitialize(&executor->record_drain_mutex);
+  iree_slim_mutex_deinitialize(&executor->donation_mutex);
   iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
+  iree_notification_set_deinitialize(&executor->worker_wake_set);
   iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
   iree_task_pool_deinitialize(&executor->transient_task_pool);
   iree_allocator_free(executor->allocator, executor);
@@ -275,6 +319,87 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+bool iree_task_executor_is_threadless(iree_task_executor_t* executor) {
+  return executor->threadless;
+}
+
+iree_task_topology_node_id_t iree_task_executor_memory_node(
+    iree_task_executor_t* executor) {
+  return executor->memory_node_id;
+}
+
+iree_status_t iree_task_executor_query_worker_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    iree_task_worker_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(executor);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+#if IREE_STATISTICS_ENABLE
+  if (worker_index >= executor->worker_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "worker index %" PRIhsz
+                            " out of range (executor has %" PRIhsz " workers)",
+                            worker_index, executor->worker_count);
+  }
+  iree_task_worker_query_statistics(&executor->workers[worker_index],
+                                    out_statistics);
+  return iree_ok_status();
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "statistics disabled (IREE_STATISTICS_ENABLE=0)");
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+iree_host_size_t iree_task_executor_drain_dispatch_records(
+    iree_task_executor_t* executor, iree_host_size_t capacity,
+    iree_task_dispatch_record_t* out_records) {
+  IREE_ASSERT_ARGUMENT(executor);
+  IREE_ASSERT_ARGUMENT(!capacity || out_records);
+  iree_host_size_t count = 0;
+  iree_slim_mutex_lock(&executor->record_drain_mutex);
+  for (iree_host_size_t i = 0; i < executor->worker_count && count < capacity;
+       ++i) {
+    count += iree_task_worker_drain_records(
+        &executor->workers[i], capacity - count, out_records + count);
+  }
+  iree_slim_mutex_unlock(&executor->record_drain_mutex);
+  return count;
+}
+
+void iree_task_executor_expand_affinity_set(
+    iree_task_executor_t* executor, iree_task_affinity_set_t affinity_set,
+    iree_task_worker_set_t* out_worker_set) {
+  const uint32_t shift = executor->worker_cluster_shift;
+  if (affinity_set == UINT64_MAX) {
+    // Fast-path for the common "any worker" case.
+    iree_task_worker_set_fill_ones(out_worker_set, executor->worker_count);
+    return;
+  } else if (shift == 0) {
+    // 1:1 cluster:worker mapping.
+    iree_task_worker_set_clear(out_worker_set);
+    out_worker_set->words[0] =
+        affinity_set & iree_task_affinity_set_ones(executor->worker_count);
+    return;
+  }
+
+  // Each set cluster bit expands to 2^shift contiguous worker bits. As the
+  // cluster size is a power of two <= 64 the run of bits never straddles words.
+  iree_task_worker_set_clear(out_worker_set);
+  const uint64_t cluster_bits = iree_task_affinity_set_ones(1u << shift);
+  for (int cluster_index = 0; affinity_set != 0; ++cluster_index) {
+    int offset = iree_task_affinity_set_count_trailing_zeros(affinity_set);
+    cluster_index += offset;
+    affinity_set = iree_shr(affinity_set, offset + 1);
+    iree_host_size_t worker_start = (iree_host_size_t)cluster_index << shift;
+    if (worker_start >= executor->worker_count) break;
+    out_worker_set->words[worker_start / 64] |= cluster_bits
+                                                << (worker_start % 64);
+  }
+  iree_task_worker_set_t worker_mask;
+  iree_task_worker_set_fill_ones(&worker_mask, executor->worker_count);
+  iree_task_worker_set_and(out_worker_set, &worker_mask);
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
@@ -308,6 +433,21 @@ static void iree_task_executor_relay_to_worker(
   iree_task_post_batch_enqueue(post_batch, worker_index, task);
 }
 
+bool iree_task_executor_task_less(void* user_data, const iree_task_t* lhs,
+                                  const iree_task_t* rhs) {
+  iree_task_executor_t* executor = (iree_task_executor_t*)user_data;
+  if (executor->scheduling_mode & IREE_TASK_SCHEDULING_MODE_PRIORITY) {
+    const int32_t lhs_priority = iree_task_scheduling_priority(lhs);
+    const int32_t rhs_priority = iree_task_scheduling_priority(rhs);
+    if (lhs_priority != rhs_priority) return lhs_priority > rhs_priority;
+  }
+  if (executor->scheduling_mode &
+      IREE_TASK_SCHEDULING_MODE_SHORTEST_JOB_FIRST) {
+    return iree_task_scheduling_cost(lhs) < iree_task_scheduling_cost(rhs);
+  }
+  return false;
+}
+
 // Schedules all ready tasks in the |pending_submission| list.
 // Task may enqueue zero or more new tasks (or newly-ready/waiting tasks) to
 // |pending_submission| or queue work for posting to workers via the
@@ -323,8 +463,26 @@ void iree_task_executor_schedule_ready_tasks(
     iree_task_executor_t* executor, iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch) {
   IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Issue ready tasks in scheduling order. Tasks readied while scheduling
+  // (such as those following barriers) are appended and handled in FIFO order.
+  // Priorities are captured here as the tasks are not yet in any ordered queue
+  // and stay fixed until the tasks are next issued.
+  const bool is_ordered =
+      executor->scheduling_mode != IREE_TASK_SCHEDULING_MODE_FIFO;
+  if (is_ordered) {
+    for (iree_task_t* task = pending_submission->ready_list.head; task;
+         task = task->next_task) {
+      iree_task_scheduling_refresh_priority(task);
+    }
+    iree_task_list_sort(&pending_submission->ready_list,
+                        iree_task_executor_task_less, executor);
+  }
+
   iree_task_t* task = NULL;
   while ((task = iree_task_list_pop_front(&pending_submission->ready_list))) {
+    if (is_ordered) iree_task_scheduling_refresh_priority(task);
+
     // If the scope has been marked as failing then we abort the task.
     // This needs to happen as a poll here because one or more of the tasks we
     // are joining may have failed.
@@ -511,35 +669,31 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
   IREE_TRACE_ZONE_END(z0);
 }
 
-static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
-    iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
-    uint32_t max_theft_attempts, int rotation_offset,
+static iree_task_t* iree_task_executor_try_steal_task_from_worker_set(
+    iree_task_executor_t* executor, const iree_task_worker_set_t* victim_mask,
+    uint32_t max_theft_attempts, iree_host_size_t rotation_offset,
     iree_task_queue_t* local_task_queue) {
-  if (!victim_mask) return NULL;
-  max_theft_attempts = iree_min(max_theft_attempts,
-                                iree_task_affinity_set_count_ones(victim_mask));
-  victim_mask = iree_task_affinity_set_rotr(victim_mask, rotation_offset);
-
-  int worker_index = rotation_offset;
-  iree_task_affinity_set_t mask =
-      iree_task_affinity_set_rotr(victim_mask, worker_index);
+  // Walk the set bits starting at |rotation_offset| and wrapping around to the
+  // start of the set. This avoids the need for doing a full O(n) scan and
+  // instead gets us at O(popcnt) * O(ctz) per word.
+  //
+  // Example: victim mask = 0b01010101
+  //          rotation_offset = 3 (randomly selected)
+  //          visits workers 4, 6, 0, 2
+  int victim_index = iree_task_worker_set_find_next(victim_mask,
+                                                    rotation_offset);
+  bool wrapped = false;
   for (uint32_t i = 0; i < max_theft_attempts; ++i) {
-    // Find the last set bit and skip to it. This avoids the need for doing
-    // a full O(n) scan and instead gets us at O(popcnt) * O(ctz).
-    //
-    // Example: sharing mask = 0b01010101
-    //          mask_rotation = 3 (randomly selected)
-    //          mask = 0b01010101 rotr 3 = 0b10101010
-    //          for (i = 0; i < 4; ++i)
-    //            offset = ctz(0b10101010) = 1
-    //            mask_rotation += 1 = 4
-    //            mask >>= 1 = 0b01010101
-    //            victim_index = 4 % 64 = 4
-    int offset = iree_task_affinity_set_count_trailing_zeros(mask);
-    int victim_index = (worker_index + offset) % executor->worker_count;
-    worker_index += offset + 1;
-    mask = iree_shr(mask, offset + 1);
+    if (victim_index < 0) {
+      if (wrapped) break;
+      wrapped = true;
+      victim_index = iree_task_worker_set_find_next(victim_mask, 0);
+      if (victim_index < 0) break;
+    }
+    if (wrapped && (iree_host_size_t)victim_index >= rotation_offset) break;
+
     iree_task_worker_t* victim_worker = &executor->workers[victim_index];
+    victim_index = iree_task_worker_set_find_next(victim_mask, victim_index + 1);
     if (iree_atomic_load_int32(&victim_worker->state,
                                iree_memory_order_acquire) !=
         IREE_TASK_WORKER_STATE_RUNNING) {
@@ -562,6 +716,19 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
   return NULL;
 }
 
+// Returns a random worker index in [0, |worker_count|).
+// A single 8-bit draw would cap at 255 and be biased for counts that are not
+// powers of two so four draws are combined; the remaining modulo bias is at
+// most |worker_count| / 2^32.
+static iree_host_size_t iree_task_executor_random_worker_index(
+    iree_host_size_t worker_count, iree_prng_minilcg128_state_t* prng) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    value = (value << 8) | iree_prng_minilcg128_next_uint8(prng);
+  }
+  return (iree_host_size_t)(value % worker_count);
+}
+
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
@@ -578,43 +745,51 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // our search and then go in-order.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
-    iree_task_affinity_set_t constructive_sharing_mask,
+    const iree_task_worker_set_t* constructive_sharing_mask,
     uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_live_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_live_mask,
-                                         iree_memory_order_relaxed);
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_idle_mask,
-                                         iree_memory_order_relaxed);
+  iree_task_worker_set_t worker_live_mask;
+  iree_atomic_task_worker_set_load(&executor->worker_live_mask,
+                                   iree_memory_order_relaxed,
+                                   &worker_live_mask);
+  iree_task_worker_set_t worker_idle_mask;
+  iree_atomic_task_worker_set_load(&executor->worker_idle_mask,
+                                   iree_memory_order_relaxed,
+                                   &worker_idle_mask);
   // Limit the workers we will steal from to the ones that are currently live
   // and not idle.
-  iree_task_affinity_set_t victim_mask = worker_live_mask & ~worker_idle_mask;
+  iree_task_worker_set_t victim_mask = worker_live_mask;
+  iree_task_worker_set_and_not(&victim_mask, &worker_idle_mask);
 
   // TODO(benvanik): it may be possible to rework this such that we better
   // use the prng; for example, instead of all this rotating stuff we could just
   // generate an 8-bit number (or even split it into two 4-bit numbers) per
   // theft attempt. The current rotation strategy is biased toward the same try
   // ordering vs. what we may really want with an unbiased random selection.
-  int rotation_offset = iree_prng_minilcg128_next_uint8(theft_prng) &
-                        (8 * sizeof(iree_task_affinity_set_t) - 1);
+  iree_host_size_t rotation_offset = iree_task_executor_random_worker_index(
+      executor->worker_count, theft_prng);
 
   // Try first with the workers we may have some caches shared with. This
   // helps to prevent cache invalidations/availability updates as it's likely
   // that we won't need to go back to main memory (or higher cache tiers) in the
   // event that the thief and victim are running close to each other in time.
-  iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
+  iree_task_worker_set_t local_victim_mask = victim_mask;
+  iree_task_worker_set_and(&local_victim_mask, constructive_sharing_mask);
+  iree_task_t* task = iree_task_executor_try_steal_task_from_worker_set(
+      executor, &local_victim_mask, max_theft_attempts, rotation_offset,
+      local_task_queue);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
   } else {
-    task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
-        rotation_offset, local_task_queue);
+    iree_task_worker_set_t remote_victim_mask = victim_mask;
+    iree_task_worker_set_and_not(&remote_victim_mask,
+                                 constructive_sharing_mask);
+    task = iree_task_executor_try_steal_task_from_worker_set(
+        executor, &remote_victim_mask, max_theft_attempts, rotation_offset,
+        local_task_queue);
     if (task) {
       IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
     }
@@ -624,11 +799,129 @@ iree_task_t* iree_task_executor_try_steal_task(
   return task;
 }
 
+// Returns a wait handle that resolves when |wait_source| does or an immediate
+// handle if the wait source cannot be exported.
+static iree_wait_handle_t iree_task_executor_export_donation_wait(
+    iree_wait_source_t wait_source) {
+  iree_wait_handle_t* wait_handle_ptr =
+      iree_wait_handle_from_source(&wait_source);
+  if (wait_handle_ptr) return *wait_handle_ptr;
+  iree_wait_handle_t wait_handle = iree_wait_handle_immediate();
+  iree_wait_primitive_t wait_primitive = iree_wait_primitive_immediate();
+  iree_status_t status =
+      iree_wait_source_export(wait_source, IREE_WAIT_PRIMITIVE_TYPE_ANY,
+                              iree_immediate_timeout(), &wait_primitive);
+  if (iree_status_is_ok(status)) {
+    iree_wait_handle_wrap_primitive(wait_primitive.type, wait_primitive.value,
+                                    &wait_handle);
+  } else {
+    iree_status_ignore(status);
+  }
+  return wait_handle;
+}
+
+// Pumps the single worker and poller of a threadless |executor| on the calling
+// thread until |wait_source| resolves or |timeout| elapses.
+//
+// The thread holding the donation lock runs all ready work and retires resolved
+// waits. When idle it blocks on |wait_source| together with the poller wait
+// set, which is woken whenever work or waits are posted to the executor from
+// other threads. Threads that fail to acquire the donation lock (or wait
+// sources that cannot be exported to a wait handle) fall back to waiting in
+// intervals so that they can take over pumping once the lock is released.
+static iree_status_t iree_task_executor_donate_caller_threadless(
+    iree_task_executor_t* executor, iree_wait_source_t wait_source,
+    iree_timeout_t timeout) {
+  iree_task_worker_t* worker = &executor->workers[0];
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  iree_wait_handle_t wait_handle = iree_wait_handle_immediate();
+  bool exported_wait_handle = false;
+  while (true) {
+    // Check whether the wait has resolved before doing any work so that we
+    // return to the caller as soon as possible.
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    IREE_RETURN_IF_ERROR(iree_wait_source_query(wait_source, &wait_status_code));
+    if (wait_status_code != IREE_STATUS_DEFERRED) {
+      return iree_status_from_code(wait_status_code);
+    }
+
+    // Only one thread may pump the worker at a time. If another thread is
+    // already doing so then we just wait for our wait source below.
+    if (iree_slim_mutex_try_lock(&executor->donation_mutex)) {
+      // Retire resolved waits first: this resets the poller wake event such
+      // that any work posted while we are pumping the worker will wake the
+      // wait below instead of being missed.
+      iree_time_t wait_deadline_ns =
+          iree_task_poller_pump_caller(&executor->poller);
+
+      // Schedule all incoming tasks to the worker and run them. Any tasks they
+      // ready will be scheduled on the next iteration.
+      iree_task_executor_coordinate(executor, worker);
+      if (iree_task_worker_pump_caller(worker)) {
+        iree_slim_mutex_unlock(&executor->donation_mutex);
+        continue;
+      }
+
+      // Nothing to do; wait for the wait source to resolve, a wait task to
+      // resolve or its delay to elapse, or new work to arrive.
+      iree_time_t now_ns = iree_time_now();
+      if (now_ns >= deadline_ns) {
+        iree_slim_mutex_unlock(&executor->donation_mutex);
+        return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      }
+      if (!exported_wait_handle) {
+        wait_handle = iree_task_executor_export_donation_wait(wait_source);
+        exported_wait_handle = true;
+      }
+      wait_deadline_ns = iree_min(wait_deadline_ns, deadline_ns);
+      if (iree_wait_handle_is_immediate(wait_handle)) {
+        wait_deadline_ns = iree_min(
+            wait_deadline_ns,
+            now_ns + IREE_TASK_EXECUTOR_DONATION_POLL_INTERVAL_NS);
+      }
+      iree_status_t status = iree_task_poller_wait_caller(
+          &executor->poller, wait_handle, wait_deadline_ns);
+      iree_slim_mutex_unlock(&executor->donation_mutex);
+      if (iree_status_is_deadline_exceeded(status)) {
+        iree_status_ignore(status);
+      } else {
+        IREE_RETURN_IF_ERROR(status);
+      }
+      continue;  // wait source and deadline checked on the next iteration
+    }
+
+    // Another thread is pumping; wait for our wait source in intervals so that
+    // we can take over once it returns to its caller.
+    iree_time_t now_ns = iree_time_now();
+    if (now_ns >= deadline_ns) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+    iree_time_t poll_deadline_ns = iree_min(
+        deadline_ns, now_ns + IREE_TASK_EXECUTOR_DONATION_POLL_INTERVAL_NS);
+    iree_status_t status = iree_wait_source_wait_one(
+        wait_source, iree_make_deadline(poll_deadline_ns));
+    if (iree_status_is_deadline_exceeded(status)) {
+      iree_status_ignore(status);
+      continue;  // deadline checked above on the next iteration
+    } else {
+      return status;
+    }
+  }
+}
+
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
                                                iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  if (executor->threadless) {
+    iree_status_t status =
+        iree_task_executor_donate_caller_threadless(executor, wait_source,
+                                                    timeout);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   // Perform an immediate flush/coordination (in case the caller queued).
   iree_task_executor_flush(executor);
 
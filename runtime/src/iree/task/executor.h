@@ -220,9 +220,15 @@ extern "C" {
 // Scaling Up
 //==============================================================================
 //
-// The task system has an implicit limit of 64 workers. This intentional
-// limitation simplifies several parts of the code while also preventing misuse:
-// it rarely (if ever) makes sense to have more than 64 compute-dominated
+// The task system supports up to IREE_TASK_EXECUTOR_MAX_WORKER_COUNT workers
+// (256 by default) within a single executor. Workers are tracked internally in
+// multi-word bitsets while tasks continue to carry a compact 64-bit affinity
+// set: on executors with more than 64 workers each affinity bit selects a
+// cluster of adjacent workers (which topology construction places near each
+// other in the cache hierarchy). Work stealing operates across all workers in
+// the executor and prefers victims that constructively share caches.
+//
+// That said, it rarely makes sense to have hundreds of compute-dominated
 // threads working on a single problem. Achieving high performance in such
 // situations requires extremely careful control over the OS scheduler, memory
 // bandwidth consumption, and synchronization. It's always possible to make the
@@ -251,20 +257,39 @@ extern "C" {
 
 // A bitfield specifying the scheduling mode used for configuring how (or if)
 // work is balanced across queues.
+//
+// The default FIFO mode processes tasks in roughly the order they became ready
+// and is optimal for throughput when all work submitted to the executor is of
+// equal importance. Servers mixing latency-critical requests with large batch
+// jobs on the same executor can enable ordering so that short or important
+// work isn't stuck behind long-running waves of dispatch shards.
+//
+// When any ordering bit is set tasks are ordered (stably) by the coordinator
+// when issued and by each worker as they arrive in its local queue. Ordering is
+// applied by priority first and then by job size when both are set.
+//
+// We could also look into what GPUs do in hardware for balancing things or
+// scheduling strategies such as preferring the widest tasks available from
+// any queue such that we are keeping as many workers active as possible to
+// reach peak utilization or artificially limiting which tasks we allow
+// through to keep certain CPU cores asleep unless absolutely required.
 enum iree_task_scheduling_mode_bits_t {
-  // TODO(benvanik): batch, round-robin, FCFS, SJF, etc.
-  // We can also allow for custom scheduling, though I'm skeptical of the value
-  // of that. We should look into what GPUs do in hardware for balancing things
-  // (if anything this sophisticated at all). The potential benefit here is that
-  // we can optimize for offline workloads by allowing each queue to be drained
-  // until blocking - hopefully optimizing cache coherency and reducing the
-  // total memory high-water mark - or optimize for latency across all queues by
-  // taking tasks from all queues equally. There are other more interesting
-  // scheduling strategies such as preferring the widest tasks available from
-  // any queue such that we are keeping as many workers active as possible to
-  // reach peak utilization or artificially limiting which tasks we allow
-  // through to keep certain CPU cores asleep unless absolutely required.
-  IREE_TASK_SCHEDULING_MODE_RESERVED = 0u,
+  // Tasks are processed in first-in-first-out order.
+  IREE_TASK_SCHEDULING_MODE_FIFO = 0u,
+
+  // Tasks from scopes with a higher iree_task_scope_priority_t are ordered
+  // ahead of those with lower priorities. Workers executing dispatch shards
+  // from a lower priority scope will yield between tile reservations when
+  // higher priority work is posted to them so that it does not need to wait
+  // for the lower priority dispatch to drain.
+  IREE_TASK_SCHEDULING_MODE_PRIORITY = 1u << 0,
+
+  // Tasks with less work are ordered ahead of those with more. Dispatches are
+  // sized by their total workgroup count (with indirect dispatches treated as
+  // unbounded until issued) and dispatch shards by the total tile count of
+  // their dispatch. Control tasks (barriers, fences, etc) are always
+  // considered the shortest as they unblock others.
+  IREE_TASK_SCHEDULING_MODE_SHORTEST_JOB_FIRST = 1u << 1,
 };
 typedef uint32_t iree_task_scheduling_mode_t;
 
@@ -282,10 +307,16 @@ typedef struct iree_task_executor_options_t {
   // scope-related waits coming from outside of the task system.
 
   // Maximum duration in nanoseconds each worker should spin waiting for
-  // additional work. In almost all cases this should be IREE_DURATION_ZERO as
-  // spinning is often extremely harmful to system health. Only set to non-zero
-  // values when latency is the #1 priority (over thermals, system-wide
-  // scheduling, and the environment).
+  // additional work before parking. In almost all cases this should be
+  // IREE_DURATION_ZERO as spinning is often extremely harmful to system health.
+  // Only set to non-zero values when latency is the #1 priority (over thermals,
+  // system-wide scheduling, and the environment).
+  //
+  // This is a budget: each worker adapts how long it spins based on whether
+  // work has recently arrived while spinning or shortly after parking and backs
+  // off when it detects it is being descheduled (the system is oversubscribed).
+  // Spinning workers are not registered as waiters and posting work to them
+  // does not require a system call.
   iree_duration_t worker_spin_ns;
 
   // Minimum size in bytes of each worker thread stack.
@@ -303,6 +334,13 @@ typedef struct iree_task_executor_options_t {
   // required.
   // By default the CPU L2 cache size is used if such queries are supported.
   iree_host_size_t worker_local_memory_size;
+
+  // Number of dispatch shard records each worker retains until they are
+  // drained with iree_task_executor_drain_dispatch_records. Will be rounded up
+  // to the next power of two. May be 0 to disable records; cumulative worker
+  // statistics are always maintained when IREE_STATISTICS_ENABLE is set.
+  // Defaults to IREE_TASK_WORKER_DEFAULT_DISPATCH_RECORD_CAPACITY.
+  iree_host_size_t worker_dispatch_record_capacity;
 } iree_task_executor_options_t;
 
 // Initializes |out_options| to default values.
@@ -317,6 +355,14 @@ typedef struct iree_task_executor_t iree_task_executor_t;
 // callers and then overridden as required.
 // |topology| is only used during creation and need not live beyond this call.
 // |out_executor| must be released by the caller.
+//
+// If |topology| has no groups the executor is created in threadless mode: no
+// worker threads are created and all tasks are executed by threads donated via
+// iree_task_executor_donate_caller. The executor has a single caller-pumped
+// worker with the same queue semantics as a threaded worker such that users
+// need not change how they build or submit task graphs. Only one donated thread
+// executes tasks at a time; others wait until it finishes or their own wait
+// source resolves.
 iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
                                         const iree_task_topology_t* topology,
                                         iree_allocator_t allocator,
@@ -333,9 +379,59 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 
 // Returns the number of live workers usable by the executor.
 // The actual number used for any particular operation is dynamic.
+// Threadless executors report their single caller-pumped worker.
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Returns true if the executor was created without worker threads and only
+// makes progress while callers are donated via iree_task_executor_donate_caller.
+bool iree_task_executor_is_threadless(iree_task_executor_t* executor);
+
+// Returns the NUMA memory node all workers of the executor run on or
+// IREE_TASK_TOPOLOGY_NODE_ID_ANY if they span nodes (or it is unknown).
+// Memory primarily accessed by work scheduled on the executor should be placed
+// on this node.
+iree_task_topology_node_id_t iree_task_executor_memory_node(
+    iree_task_executor_t* executor);
+
+// Cumulative statistics of the work performed by a single worker.
+typedef struct iree_task_worker_statistics_t {
+  // Total number of tasks executed by the worker.
+  uint64_t task_count;
+  // Total number of dispatch shards executed (including resumed shards).
+  uint64_t shard_count;
+  // Total number of dispatch tiles executed.
+  uint64_t tile_count;
+  // Total number of tasks the worker stole from other workers.
+  uint64_t steal_count;
+  // Total time the worker spent executing tasks.
+  iree_duration_t busy_time_ns;
+  // Total number of dispatch records dropped because the ring was full.
+  uint64_t dropped_record_count;
+} iree_task_worker_statistics_t;
+
+// Queries the cumulative statistics of the worker at executor-local
+// |worker_index| in [0, iree_task_executor_worker_count).
+// Counters are updated by workers with relaxed atomics and may tear. Returns
+// IREE_STATUS_UNAVAILABLE if statistics are disabled (IREE_STATISTICS_ENABLE).
+//
+// Safe to call from any thread.
+iree_status_t iree_task_executor_query_worker_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    iree_task_worker_statistics_t* out_statistics);
+
+// Drains up to |capacity| dispatch shard records from the per-worker rings
+// into |out_records| and returns the number of records drained. Records of
+// each worker are in execution order but records are not ordered across
+// workers. Workers never block on full rings and instead drop new records
+// (see iree_task_worker_statistics_t::dropped_record_count) so callers wanting
+// continuous telemetry should drain periodically.
+//
+// Safe to call from any thread.
+iree_host_size_t iree_task_executor_drain_dispatch_records(
+    iree_task_executor_t* executor, iree_host_size_t capacity,
+    iree_task_dispatch_record_t* out_records);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
@@ -402,6 +498,13 @@ void iree_task_executor_flush(iree_task_executor_t* executor);
 // Especially in large applications it's almost certainly better to do something
 // useful with the calling thread (even if that's go to sleep).
 //
+// Threadless executors (created with no topology groups) only make progress
+// when a caller is donated and will run all ready work on the calling thread
+// without waking any other threads. The donated thread also services the
+// executor wait tasks as there is no poller thread. When no work is available
+// the caller blocks on |wait_source| along with all outstanding wait tasks and
+// is woken when work is posted by other threads.
+//
 // Safe to call from any thread (though bad to reentrantly call from workers).
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
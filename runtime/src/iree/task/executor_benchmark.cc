@@ -0,0 +1,155 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/task/executor.h"
+
+namespace {
+
+//==============================================================================
+// Worker wake latency
+//==============================================================================
+
+// Latest time any tile in the current iteration began executing.
+static std::atomic<iree_time_t> latest_tile_start_ns = {0};
+
+static iree_status_t RecordTileStart(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  iree_time_t now_ns = iree_time_now();
+  iree_time_t latest_ns = latest_tile_start_ns.load();
+  while (latest_ns < now_ns &&
+         !latest_tile_start_ns.compare_exchange_weak(latest_ns, now_ns)) {
+  }
+  return iree_ok_status();
+}
+
+// Measures the time taken to wake N parked workers by issuing a dispatch with
+// one tile per worker. Workers are allowed to park between each iteration such
+// that every dispatch requires all workers to be woken from the kernel.
+//
+// The reported wake_latency_us counter is the average time from submission to
+// the last tile beginning execution - this is the tail latency of waking the
+// full set of workers.
+void BM_DispatchWake(benchmark::State& state) {
+  const iree_host_size_t worker_count = (iree_host_size_t)state.range(0);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_spin_ns = IREE_DURATION_ZERO;
+  options.worker_local_memory_size = 4 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(iree_task_executor_create(options, &topology,
+                                          iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("benchmark"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)worker_count, 1, 1};
+  iree_duration_t total_wake_latency_ns = 0;
+  for (auto _ : state) {
+    // Let all workers park themselves in the kernel.
+    state.PauseTiming();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    latest_tile_start_ns = 0;
+    state.ResumeTiming();
+
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope, iree_task_make_dispatch_closure(RecordTileStart, NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+
+    iree_time_t submit_ns = iree_time_now();
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    total_wake_latency_ns += latest_tile_start_ns.load() - submit_ns;
+  }
+  state.counters["wake_latency_us"] = benchmark::Counter(
+      total_wake_latency_ns / 1000.0, benchmark::Counter::kAvgIterations);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+BENCHMARK(BM_DispatchWake)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+//==============================================================================
+// Back-to-back dispatch latency
+//==============================================================================
+
+static iree_status_t NopTile(void* user_context,
+                             const iree_task_tile_context_t* tile_context,
+                             iree_task_submission_t* pending_submission) {
+  return iree_ok_status();
+}
+
+// Measures the round-trip time of small dispatches issued back-to-back as in a
+// decoder loop where each dispatch depends on the results of the previous one.
+// The second argument is the worker spin budget in microseconds: with spinning
+// disabled each dispatch pays a futex park/wake round trip on every worker.
+void BM_BackToBackDispatch(benchmark::State& state) {
+  const iree_host_size_t worker_count = (iree_host_size_t)state.range(0);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_spin_ns = (iree_duration_t)state.range(1) * 1000;
+  options.worker_local_memory_size = 4 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(iree_task_executor_create(options, &topology,
+                                          iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("benchmark"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)worker_count, 1, 1};
+  for (auto _ : state) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope, iree_task_make_dispatch_closure(NopTile, NULL), workgroup_size,
+        workgroup_count, &dispatch);
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+BENCHMARK(BM_BackToBackDispatch)
+    ->ArgNames({"workers", "spin_us"})
+    ->ArgsProduct({{1, 4, 8}, {0, 50}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
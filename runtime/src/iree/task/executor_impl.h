@@ -35,10 +35,24 @@ struct iree_task_executor_t {
   IREE_TRACE(const char* trace_name;)
 
   // Defines how work is selected across queues.
-  // TODO(benvanik): make mutable; currently always the same reserved value.
+  // TODO(benvanik): make mutable; currently fixed at executor creation.
   iree_task_scheduling_mode_t scheduling_mode;
 
-  // Time each worker should spin before parking itself to wait for more work.
+  // True if the executor has no worker threads and all work is performed by
+  // threads donated with iree_task_executor_donate_caller. Threadless executors
+  // have a single worker (without a thread) that is pumped by the donated
+  // thread holding |donation_mutex|.
+  bool threadless;
+
+  // Held by the donated thread pumping the worker of a threadless executor.
+  // Workers are single-threaded and only one thread may pump one at a time.
+  iree_slim_mutex_t donation_mutex;
+
+  // Serializes consumers of the per-worker dispatch record rings.
+  iree_slim_mutex_t record_drain_mutex;
+
+  // Maximum time each worker may spin before parking itself to wait for more
+  // work. Workers adapt their own spin duration within this budget.
   // IREE_DURATION_ZERO is used to disable spinning.
   iree_duration_t worker_spin_ns;
 
@@ -83,6 +97,11 @@ struct iree_task_executor_t {
   // them.
   iree_event_pool_t* event_pool;
 
+  // Shared wait address all workers park on when idle. Allows a post batch to
+  // wake any subset of workers with a single system call where supported.
+  // Workers use iree_notification_set_wake_bit(local_worker_index).
+  iree_notification_set_t worker_wake_set;
+
   // Guards coordination logic; only one thread at a time may be acting as the
   // coordinator.
   iree_slim_mutex_t coordinator_mutex;
@@ -94,18 +113,19 @@ struct iree_task_executor_t {
   // existing computation on the workers to finish).
   iree_task_poller_t poller;
 
-  // A bitset indicating which workers are likely to be live and usable; all
-  // attempts to push work onto a particular worker should check first with this
-  // mask. This may change over time either automatically or by user request
-  // ("don't use these cores for awhile I'm going to be using them" etc).
+  // A multi-word bitset indicating which workers are likely to be live and
+  // usable; all attempts to push work onto a particular worker should check
+  // first with this mask. This may change over time either automatically or by
+  // user request ("don't use these cores for awhile I'm going to be using them"
+  // etc).
   //
   // This mask is just a hint, accessed with memory_order_relaxed. Readers must
   // be OK with getting slightly out-of-date information. The only way to get
   // an authoritative answer to the question "is this worker live" is to
   // atomically query worker->state. This mask is for usage patterns where one
-  // needs a cheap (single relaxed atomic op) approximation of all N workers'
-  // live state without having to perform N expensive atomic ops.
-  iree_atomic_task_affinity_set_t worker_live_mask;
+  // needs a cheap (one relaxed atomic op per 64 workers) approximation of all N
+  // workers' live state without having to perform N expensive atomic ops.
+  iree_atomic_task_worker_set_t worker_live_mask;
 
   // A bitset indicating which workers are currently idle. Used to bias incoming
   // tasks to workers that aren't doing much else. This is a balance of latency
@@ -114,7 +134,7 @@ struct iree_task_executor_t {
   //
   // This mask is just a hint, accessed with memory_order_relaxed. See the
   // comment on worker_live_mask.
-  iree_atomic_task_affinity_set_t worker_idle_mask;
+  iree_atomic_task_worker_set_t worker_idle_mask;
 
   // Base value added to each executor-local worker index.
   // This allows workers to uniquely identify themselves in multi-executor
@@ -126,8 +146,29 @@ struct iree_task_executor_t {
   // live join/leave behavior we could change this to a registration mechanism.
   iree_host_size_t worker_count;
   iree_task_worker_t* workers;  // [worker_count]
+
+  // log2 of the number of workers represented by each bit in a task
+  // iree_task_affinity_set_t. 0 when there are <= 64 workers such that each
+  // affinity bit maps to exactly one worker.
+  uint32_t worker_cluster_shift;
+
+  // NUMA memory node shared by all workers in the executor or
+  // IREE_TASK_TOPOLOGY_NODE_ID_ANY if the workers span nodes.
+  iree_task_topology_node_id_t memory_node_id;
 };
 
+// Expands the cluster-granular |affinity_set| into the set of all workers it
+// covers in |executor|. Workers beyond the executor worker count are excluded.
+void iree_task_executor_expand_affinity_set(
+    iree_task_executor_t* executor, iree_task_affinity_set_t affinity_set,
+    iree_task_worker_set_t* out_worker_set);
+
+// Returns true if |lhs| should be scheduled before |rhs| based on the executor
+// scheduling mode. |user_data| is the iree_task_executor_t. Only valid to use
+// when the executor has a non-FIFO scheduling mode.
+bool iree_task_executor_task_less(void* user_data, const iree_task_t* lhs,
+                                  const iree_task_t* rhs);
+
 // Merges a submission into the primary FIFO queues.
 // Coordinators will fetch items from here as workers demand them but otherwise
 // not be notified of the changes (waiting until coordination runs again).
@@ -159,7 +200,7 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
 // May steal multiple tasks and add them to the |local_task_queue|.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
-    iree_task_affinity_set_t constructive_sharing_mask,
+    const iree_task_worker_set_t* constructive_sharing_mask,
     uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
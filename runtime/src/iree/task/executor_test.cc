@@ -6,13 +6,22 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <thread>
+#include <vector>
 
+#include "iree/base/internal/wait_handle.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
 namespace {
 
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
 // Tests that an executor can be created and destroyed repeatedly without
 // running out of system resources. Since all systems are different there's no
 // guarantee this will fail but it does give ASAN/TSAN some nice stuff to chew
@@ -135,4 +144,453 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that an executor with more workers than fit in a single affinity word
+// distributes dispatch tiles across all of its workers.
+TEST(ExecutorTest, ManyWorkers) {
+  const iree_host_size_t worker_count =
+      iree_min(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT, 130);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 4 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  ASSERT_EQ(worker_count, iree_task_topology_group_count(&topology));
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  EXPECT_EQ(worker_count, iree_task_executor_worker_count(executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  // Tiles are counted per worker so that we can check that workers beyond the
+  // first 64 (and first affinity set word) receive work. Each tile takes a
+  // little time so that the dispatch outlasts worker wake-up.
+  static std::atomic<int> tile_counts[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  for (auto& tile_count : tile_counts) tile_count = 0;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {64, 16, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            uint32_t worker_id = tile_context->worker_id;
+            if (worker_id >= IREE_TASK_EXECUTOR_MAX_WORKER_COUNT) {
+              return iree_make_status(IREE_STATUS_OUT_OF_RANGE);
+            }
+            ++tile_counts[worker_id];
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            return iree_ok_status();
+          },
+          NULL),
+      workgroup_size, workgroup_count, &dispatch);
+
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope));
+  int total_tile_count = 0;
+  int high_tile_count = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_EXECUTOR_MAX_WORKER_COUNT; ++i) {
+    if (i >= worker_count) {
+      EXPECT_EQ(0, tile_counts[i]) << "tiles ran on nonexistent worker " << i;
+    }
+    total_tile_count += tile_counts[i];
+    if (i >= 64) high_tile_count += tile_counts[i];
+  }
+  EXPECT_EQ(64 * 16, total_tile_count);
+  EXPECT_GT(high_tile_count, 0) << "no tiles ran on workers beyond index 63";
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that dispatches from a high priority scope are able to preempt a long
+// running dispatch from a lower priority scope.
+TEST(ExecutorTest, PriorityPreemption) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.scheduling_mode = IREE_TASK_SCHEDULING_MODE_PRIORITY |
+                            IREE_TASK_SCHEDULING_MODE_SHORTEST_JOB_FIRST;
+  options.worker_local_memory_size = 4 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t low_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("low"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &low_scope);
+  iree_task_scope_set_priority(&low_scope, IREE_TASK_SCOPE_PRIORITY_LOW);
+  iree_task_scope_t high_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("high"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &high_scope);
+  iree_task_scope_set_priority(&high_scope, IREE_TASK_SCOPE_PRIORITY_HIGH);
+
+  // Long running low priority dispatch where each tile takes ~1ms.
+  static std::atomic<int> low_tile_count = {0};
+  low_tile_count = 0;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t low_workgroup_count[3] = {1024, 1, 1};
+  iree_task_dispatch_t low_dispatch;
+  iree_task_dispatch_initialize(
+      &low_scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ++low_tile_count;
+            return iree_ok_status();
+          },
+          NULL),
+      workgroup_size, low_workgroup_count, &low_dispatch);
+  iree_task_fence_t* low_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &low_scope, &low_fence));
+  iree_task_set_completion_task(&low_dispatch.header, &low_fence->header);
+  iree_task_submission_t low_submission;
+  iree_task_submission_initialize(&low_submission);
+  iree_task_submission_enqueue(&low_submission, &low_dispatch.header);
+  iree_task_executor_submit(executor, &low_submission);
+  iree_task_executor_flush(executor);
+  while (low_tile_count == 0) std::this_thread::yield();
+
+  // Small high priority dispatch that should complete well before the low
+  // priority dispatch has drained.
+  static std::atomic<int> high_tile_count = {0};
+  high_tile_count = 0;
+  const uint32_t high_workgroup_count[3] = {4, 1, 1};
+  iree_task_dispatch_t high_dispatch;
+  iree_task_dispatch_initialize(
+      &high_scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            ++high_tile_count;
+            return iree_ok_status();
+          },
+          NULL),
+      workgroup_size, high_workgroup_count, &high_dispatch);
+  iree_task_fence_t* high_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &high_scope, &high_fence));
+  iree_task_set_completion_task(&high_dispatch.header, &high_fence->header);
+  iree_task_submission_t high_submission;
+  iree_task_submission_initialize(&high_submission);
+  iree_task_submission_enqueue(&high_submission, &high_dispatch.header);
+  iree_task_executor_submit(executor, &high_submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&high_scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(4, high_tile_count);
+  EXPECT_LT(low_tile_count, 1024);
+
+  // Yielded low priority shards must resume and complete all tiles.
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&low_scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(1024, low_tile_count);
+
+  iree_task_scope_deinitialize(&high_scope);
+  iree_task_scope_deinitialize(&low_scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that workers spinning within their budget pick up back-to-back
+// dispatches and that the executor shuts down with spinning workers.
+TEST(ExecutorTest, SpinBudget) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_spin_ns = 100 * 1000;
+  options.worker_local_memory_size = 4 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  static std::atomic<int> tile_count = {0};
+  tile_count = 0;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {4, 1, 1};
+  for (int i = 0; i < 100; ++i) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              ++tile_count;
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+  EXPECT_EQ(100 * 4, tile_count);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+#if IREE_STATISTICS_ENABLE
+// Tests that dispatch statistics, per-worker counters, and dispatch records all
+// account for every tile executed.
+TEST(ExecutorTest, Statistics) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 4 * 1024;
+  options.worker_dispatch_record_capacity = 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  static const int kDispatchCount = 10;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {8, 4, 1};
+  const uint64_t tiles_per_dispatch = 8 * 4;
+  for (int i = 0; i < kDispatchCount; ++i) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+  const uint64_t total_tiles = kDispatchCount * tiles_per_dispatch;
+
+  // Aggregate dispatch statistics are merged into the scope on retire.
+  iree_task_dispatch_statistics_t scope_statistics =
+      iree_task_scope_consume_statistics(&scope);
+  EXPECT_EQ(kDispatchCount,
+            iree_atomic_load_int64(&scope_statistics.dispatch_count,
+                                   iree_memory_order_relaxed));
+  EXPECT_EQ(total_tiles, iree_atomic_load_int64(&scope_statistics.tile_count,
+                                                iree_memory_order_relaxed));
+  EXPECT_GT(iree_atomic_load_int64(&scope_statistics.wall_time_ns,
+                                   iree_memory_order_relaxed),
+            0);
+
+  // Workers retire shards before their counters are updated; the fence only
+  // guarantees the former so spin briefly until the counters catch up.
+  uint64_t worker_tiles = 0;
+  for (int attempt = 0; attempt < 1000 && worker_tiles != total_tiles;
+       ++attempt) {
+    worker_tiles = 0;
+    for (iree_host_size_t i = 0; i < iree_task_executor_worker_count(executor);
+         ++i) {
+      iree_task_worker_statistics_t statistics;
+      IREE_ASSERT_OK(
+          iree_task_executor_query_worker_statistics(executor, i, &statistics));
+      EXPECT_EQ(0, statistics.dropped_record_count);
+      worker_tiles += statistics.tile_count;
+    }
+    if (worker_tiles != total_tiles) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_EQ(total_tiles, worker_tiles);
+  iree_task_worker_statistics_t statistics;
+  EXPECT_THAT(
+      Status(iree_task_executor_query_worker_statistics(executor, 4,
+                                                        &statistics)),
+      StatusIs(StatusCode::kOutOfRange));
+
+  // Every shard produced a record and the records cover all tiles.
+  std::vector<iree_task_dispatch_record_t> records(1024);
+  iree_host_size_t record_count = iree_task_executor_drain_dispatch_records(
+      executor, records.size(), records.data());
+  uint64_t record_tiles = 0;
+  for (iree_host_size_t i = 0; i < record_count; ++i) {
+    EXPECT_LE(records[i].start_time_ns, records[i].end_time_ns);
+    EXPECT_LT(records[i].worker_index, 4);
+    record_tiles += records[i].tile_count;
+  }
+  EXPECT_EQ(total_tiles, record_tiles);
+  EXPECT_EQ(0, iree_task_executor_drain_dispatch_records(
+                   executor, records.size(), records.data()));
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+#endif  // IREE_STATISTICS_ENABLE
+
+// Tests that a threadless executor runs all work on the donated caller thread.
+TEST(ExecutorTest, Threadless) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  EXPECT_EQ(1, iree_task_executor_worker_count(executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  // Tiles record whether they ran anywhere other than the caller thread.
+  static std::thread::id caller_id;
+  caller_id = std::this_thread::get_id();
+  static std::atomic<int> tile_count = {0};
+  static std::atomic<int> foreign_count = {0};
+  tile_count = 0;
+  foreign_count = 0;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {8, 4, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            ++tile_count;
+            if (std::this_thread::get_id() != caller_id) ++foreign_count;
+            return iree_ok_status();
+          },
+          NULL),
+      workgroup_size, workgroup_count, &dispatch);
+
+  // Signals the event the caller is waiting on after the dispatch completes.
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+  iree_task_call_t call;
+  iree_task_call_initialize(
+      &scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            iree_event_set((iree_event_t*)user_context);
+            return iree_ok_status();
+          },
+          &event),
+      &call);
+  iree_task_set_completion_task(&dispatch.header, &call.header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+
+  // Nothing runs until the caller is donated.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(0, tile_count);
+
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_event_await(&event), iree_infinite_timeout()));
+  EXPECT_EQ(8 * 4, tile_count);
+  EXPECT_EQ(0, foreign_count);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+  iree_event_deinitialize(&event);
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Tests that a threadless executor services wait tasks from the donated caller
+// thread without a poller thread and wakes when the wait resolves.
+TEST(ExecutorTest, ThreadlessWait) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  EXPECT_TRUE(iree_task_executor_is_threadless(executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  // Wait task on |signal_event| that is set from another thread, followed by a
+  // call that sets the |done_event| the caller is donated on.
+  iree_event_t signal_event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &signal_event));
+  iree_event_t done_event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &done_event));
+  iree_task_wait_t wait;
+  iree_task_wait_initialize(&scope, iree_event_await(&signal_event),
+                            IREE_TIME_INFINITE_FUTURE, &wait);
+  static std::thread::id call_id;
+  iree_task_call_t call;
+  iree_task_call_initialize(
+      &scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            call_id = std::this_thread::get_id();
+            iree_event_set((iree_event_t*)user_context);
+            return iree_ok_status();
+          },
+          &done_event),
+      &call);
+  iree_task_set_completion_task(&wait.header, &call.header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &wait.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+
+  std::thread signal_thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    iree_event_set(&signal_event);
+  });
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_event_await(&done_event), iree_infinite_timeout()));
+  signal_thread.join();
+  EXPECT_EQ(std::this_thread::get_id(), call_id);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+  iree_event_deinitialize(&done_event);
+  iree_event_deinitialize(&signal_event);
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
 }  // namespace
@@ -152,6 +152,89 @@ void iree_task_list_reverse(iree_task_list_t* list) {
   list->tail = tail;
 }
 
+// Merges two sorted, NULL-terminated task chains and returns the new head.
+// Tasks from |lhs| are ordered first when comparing equal to preserve stability.
+// |out_tail| receives the tail of the merged chain.
+static iree_task_t* iree_task_list_merge_chains(
+    iree_task_t* lhs, iree_task_t* lhs_tail, iree_task_t* rhs,
+    iree_task_t* rhs_tail, iree_task_list_less_fn_t less_fn, void* user_data,
+    iree_task_t** out_tail) {
+  iree_task_t* head = NULL;
+  iree_task_t** next_ptr = &head;
+  while (lhs && rhs) {
+    if (less_fn(user_data, rhs, lhs)) {
+      *next_ptr = rhs;
+      rhs = rhs->next_task;
+    } else {
+      *next_ptr = lhs;
+      lhs = lhs->next_task;
+    }
+    next_ptr = &(*next_ptr)->next_task;
+  }
+  // One chain was exhausted and the remainder of the other is appended as-is.
+  *next_ptr = lhs ? lhs : rhs;
+  *out_tail = lhs ? lhs_tail : rhs_tail;
+  return head;
+}
+
+void iree_task_list_sort(iree_task_list_t* list,
+                         iree_task_list_less_fn_t less_fn, void* user_data) {
+  if (list->head == list->tail) return;  // 0 or 1 tasks
+
+  // Bottom-up merge sort: bins[i] holds a sorted chain of 2^i tasks (or NULL).
+  // Lower bins always hold more recent tasks than higher bins and merges put
+  // older tasks on the left to keep the sort stable.
+  iree_task_t* bin_heads[64] = {NULL};
+  iree_task_t* bin_tails[64] = {NULL};
+  int bin_count = 0;
+  iree_task_t* p = list->head;
+  while (p) {
+    iree_task_t* carry_head = p;
+    iree_task_t* carry_tail = p;
+    p = p->next_task;
+    carry_head->next_task = NULL;
+    int i = 0;
+    for (; i < bin_count && bin_heads[i]; ++i) {
+      carry_head = iree_task_list_merge_chains(
+          bin_heads[i], bin_tails[i], carry_head, carry_tail, less_fn,
+          user_data, &carry_tail);
+      bin_heads[i] = NULL;
+    }
+    bin_heads[i] = carry_head;
+    bin_tails[i] = carry_tail;
+    if (i == bin_count) ++bin_count;
+  }
+
+  // Merge all bins from most recent (lowest) to oldest (highest).
+  iree_task_t* head = NULL;
+  iree_task_t* tail = NULL;
+  for (int i = 0; i < bin_count; ++i) {
+    if (!bin_heads[i]) continue;
+    if (!head) {
+      head = bin_heads[i];
+      tail = bin_tails[i];
+    } else {
+      head = iree_task_list_merge_chains(bin_heads[i], bin_tails[i], head, tail,
+                                         less_fn, user_data, &tail);
+    }
+  }
+  list->head = head;
+  list->tail = tail;
+}
+
+void iree_task_list_merge(iree_task_list_t* list, iree_task_list_t* source_list,
+                          iree_task_list_less_fn_t less_fn, void* user_data) {
+  if (iree_task_list_is_empty(source_list)) return;
+  if (iree_task_list_is_empty(list)) {
+    iree_task_list_move(source_list, list);
+    return;
+  }
+  list->head = iree_task_list_merge_chains(
+      list->head, list->tail, source_list->head, source_list->tail, less_fn,
+      user_data, &list->tail);
+  memset(source_list, 0, sizeof(*source_list));
+}
+
 void iree_task_list_split(iree_task_list_t* head_list,
                           iree_host_size_t max_tasks,
                           iree_task_list_t* out_tail_list) {
@@ -96,6 +96,24 @@ void iree_task_list_append_from_fifo_slist(iree_task_list_t* list,
 // Requires a full O(n) traversal.
 void iree_task_list_reverse(iree_task_list_t* list);
 
+// Returns true if |lhs| should be ordered before |rhs|.
+// Must define a strict weak ordering for lists to be ordered consistently.
+typedef bool (*iree_task_list_less_fn_t)(void* user_data,
+                                         const iree_task_t* lhs,
+                                         const iree_task_t* rhs);
+
+// Sorts the list in-place using |less_fn| for comparison.
+// The sort is stable such that tasks that compare equal retain their relative
+// order. O(n log n) comparisons and a full O(n) traversal.
+void iree_task_list_sort(iree_task_list_t* list,
+                         iree_task_list_less_fn_t less_fn, void* user_data);
+
+// Merges the |source_list| into |list| with both lists already sorted by
+// |less_fn|. Tasks from |list| are ordered before tasks from |source_list| that
+// compare equal. |source_list| will be empty upon return.
+void iree_task_list_merge(iree_task_list_t* list, iree_task_list_t* source_list,
+                          iree_task_list_less_fn_t less_fn, void* user_data);
+
 // Splits |head_list| in half (up to |max_tasks|) and retains the first half
 // in |head_list| and the second half in |tail_list|.
 void iree_task_list_split(iree_task_list_t* head_list,
@@ -652,4 +652,72 @@ TEST(TaskListTest, SplitMaxTasks2) {
   EXPECT_TRUE(CheckListOrderFIFO(&tail_list));
 }
 
+// Orders tasks by their value modulo 3 such that many tasks compare equal.
+static bool TaskLessMod3(void* user_data, const iree_task_t* lhs,
+                         const iree_task_t* rhs) {
+  return (lhs->flags % 3) < (rhs->flags % 3);
+}
+
+// Returns true if the list is ordered by TaskLessMod3 and tasks that compare
+// equal retain their original FIFO order.
+static bool CheckListOrderStableMod3(iree_task_list_t* list) {
+  for (iree_task_t* p = list->head; p && p->next_task; p = p->next_task) {
+    iree_task_t* q = p->next_task;
+    if (q->flags % 3 < p->flags % 3) return false;
+    if (q->flags % 3 == p->flags % 3 && q->flags <= p->flags) return false;
+  }
+  return true;
+}
+
+TEST(TaskListTest, SortEmpty) {
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  iree_task_list_sort(&list, TaskLessMod3, NULL);
+  EXPECT_TRUE(iree_task_list_is_empty(&list));
+}
+
+TEST(TaskListTest, SortStable) {
+  auto pool = AllocateNopPool();
+  auto scope = AllocateScope("a");
+
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  for (uint16_t i = 0; i < 23; ++i) {
+    iree_task_list_push_back(&list, AcquireNopTask(pool, scope, i));
+  }
+
+  iree_task_list_sort(&list, TaskLessMod3, NULL);
+
+  EXPECT_EQ(23, iree_task_list_calculate_size(&list));
+  EXPECT_TRUE(CheckListOrderStableMod3(&list));
+  EXPECT_EQ(0, list.head->flags);
+  EXPECT_EQ(20, list.tail->flags);
+  EXPECT_EQ(NULL, list.tail->next_task);
+}
+
+TEST(TaskListTest, MergeStable) {
+  auto pool = AllocateNopPool();
+  auto scope = AllocateScope("a");
+
+  // Tasks [0,6) are in list_a and [6,12) in list_b; list_a tasks must be
+  // ordered before list_b tasks that compare equal.
+  iree_task_list_t list_a, list_b;
+  iree_task_list_initialize(&list_a);
+  iree_task_list_initialize(&list_b);
+  for (uint16_t i = 0; i < 6; ++i) {
+    iree_task_list_push_back(&list_a, AcquireNopTask(pool, scope, i));
+    iree_task_list_push_back(&list_b, AcquireNopTask(pool, scope, 6 + i));
+  }
+  iree_task_list_sort(&list_a, TaskLessMod3, NULL);
+  iree_task_list_sort(&list_b, TaskLessMod3, NULL);
+
+  iree_task_list_merge(&list_a, &list_b, TaskLessMod3, NULL);
+
+  EXPECT_TRUE(iree_task_list_is_empty(&list_b));
+  EXPECT_EQ(12, iree_task_list_calculate_size(&list_a));
+  EXPECT_TRUE(CheckListOrderStableMod3(&list_a));
+  EXPECT_EQ(11, list_a.tail->flags);
+  EXPECT_EQ(NULL, list_a.tail->next_task);
+}
+
 }  // namespace
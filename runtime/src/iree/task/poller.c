@@ -53,6 +53,15 @@ iree_status_t iree_task_poller_initialize(
     status = iree_wait_set_insert(out_poller->wait_set, out_poller->wake_event);
   }
 
+  // Threadless executors pump the poller from donated threads. There is never
+  // a thread to exit and the poller starts as if it had already done so.
+  if (executor->threadless) {
+    iree_atomic_store_int32(&out_poller->state, IREE_TASK_POLLER_STATE_ZOMBIE,
+                            iree_memory_order_release);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   iree_thread_create_params_t thread_params;
   memset(&thread_params, 0, sizeof(thread_params));
   thread_params.name = iree_make_cstring_view("iree-poller");
@@ -482,6 +491,33 @@ static void iree_task_poller_commit_wait(iree_task_poller_t* poller,
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Merges incoming wait tasks and scans all waits in |poller| to see if any
+// have resolved. Resolved waits are submitted to the executor for retirement.
+// Returns the earliest deadline of any unresolved delay or wait.
+static iree_time_t iree_task_poller_scan(iree_task_poller_t* poller) {
+  // Reset the wake event and merge any incoming tasks to the wait list.
+  // To avoid races we reset and then merge: this allows another thread
+  // coming in and enqueuing tasks to set the event and ensure that we'll
+  // get the tasks as we'll fall through on the wait below and loop again.
+  iree_event_reset(&poller->wake_event);
+  iree_task_list_append_from_fifo_slist(&poller->wait_list,
+                                        &poller->mailbox_slist);
+
+  // Scan all wait tasks to see if any have resolved and if so we'll enqueue
+  // their retirement on the executor and drop them from the list.
+  iree_task_submission_t pending_submission;
+  iree_task_submission_initialize(&pending_submission);
+  iree_time_t earliest_deadline_ns = IREE_TIME_INFINITE_FUTURE;
+  iree_task_poller_prepare_wait(poller, &pending_submission,
+                                &earliest_deadline_ns);
+  if (!iree_task_submission_is_empty(&pending_submission)) {
+    iree_task_executor_submit(poller->executor, &pending_submission);
+    iree_task_executor_flush(poller->executor);
+  }
+
+  return earliest_deadline_ns;
+}
+
 // Pumps the |poller| until it is requested to exit.
 static void iree_task_poller_pump_until_exit(iree_task_poller_t* poller) {
   while (true) {
@@ -494,25 +530,7 @@ static void iree_task_poller_pump_until_exit(iree_task_poller_t* poller) {
 
     IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_task_poller_pump");
 
-    // Reset the wake event and merge any incoming tasks to the wait list.
-    // To avoid races we reset and then merge: this allows another thread
-    // coming in and enqueuing tasks to set the event and ensure that we'll
-    // get the tasks as we'll fall through on the wait below and loop again.
-    iree_event_reset(&poller->wake_event);
-    iree_task_list_append_from_fifo_slist(&poller->wait_list,
-                                          &poller->mailbox_slist);
-
-    // Scan all wait tasks to see if any have resolved and if so we'll enqueue
-    // their retirement on the executor and drop them from the list.
-    iree_task_submission_t pending_submission;
-    iree_task_submission_initialize(&pending_submission);
-    iree_time_t earliest_deadline_ns = IREE_TIME_INFINITE_FUTURE;
-    iree_task_poller_prepare_wait(poller, &pending_submission,
-                                  &earliest_deadline_ns);
-    if (!iree_task_submission_is_empty(&pending_submission)) {
-      iree_task_executor_submit(poller->executor, &pending_submission);
-      iree_task_executor_flush(poller->executor);
-    }
+    iree_time_t earliest_deadline_ns = iree_task_poller_scan(poller);
 
     // Enter the system multi-wait API.
     // We unconditionally do this: if we have nothing to wait on we'll still
@@ -550,3 +568,39 @@ static int iree_task_poller_main(iree_task_poller_t* poller) {
   iree_notification_post(&poller->state_notification, IREE_ALL_WAITERS);
   return 0;
 }
+
+iree_time_t iree_task_poller_pump_caller(iree_task_poller_t* poller) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_time_t earliest_deadline_ns = iree_task_poller_scan(poller);
+  IREE_TRACE_ZONE_END(z0);
+  return earliest_deadline_ns;
+}
+
+iree_status_t iree_task_poller_wait_caller(iree_task_poller_t* poller,
+                                           iree_wait_handle_t wait_handle,
+                                           iree_time_t deadline_ns) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The caller wait handle is only in the wait set for the duration of the
+  // wait so that the poller only ever tracks its own wait tasks.
+  const bool has_wait_handle = !iree_wait_handle_is_immediate(wait_handle);
+  if (has_wait_handle) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_wait_set_insert(poller->wait_set, wait_handle));
+  }
+
+  // Wakes on the caller handle, any wait task handle, or the wake event that
+  // is set whenever new waits or work are posted to the executor. Which
+  // resolved doesn't matter as the caller rescans everything afterward.
+  iree_status_t status =
+      iree_wait_any(poller->wait_set, deadline_ns, /*out_wake_handle=*/NULL);
+
+  if (has_wait_handle) iree_wait_set_erase(poller->wait_set, wait_handle);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_task_poller_wake(iree_task_poller_t* poller) {
+  iree_event_set(&poller->wake_event);
+}
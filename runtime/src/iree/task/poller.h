@@ -105,7 +105,10 @@ typedef struct {
 } iree_task_poller_t;
 
 // Initializes |out_poller| with a new poller.
-// |executor| will be used to submit woken tasks for processing.
+// |executor| will be used to submit woken tasks for processing. Pollers of
+// threadless executors have no wait thread and are instead pumped by the thread
+// donated to the executor with iree_task_poller_pump_caller and
+// iree_task_poller_wait_caller.
 iree_status_t iree_task_poller_initialize(
     iree_task_executor_t* executor,
     iree_thread_affinity_t ideal_thread_affinity,
@@ -139,6 +142,31 @@ void iree_task_poller_deinitialize(iree_task_poller_t* poller);
 void iree_task_poller_enqueue(iree_task_poller_t* poller,
                               iree_task_list_t* wait_tasks);
 
+// Wakes the thread servicing |poller| from its system wait, if any, so that it
+// can process new work. Used by threadless executors to wake the donated thread
+// when work is posted from other threads.
+//
+// May be called from any thread.
+void iree_task_poller_wake(iree_task_poller_t* poller);
+
+// Merges incoming waits and retires any that have resolved without blocking.
+// Returns the earliest deadline at which an unresolved wait must be checked.
+//
+// Only valid for pollers of threadless executors and must only be called by
+// the thread donated to the executor.
+iree_time_t iree_task_poller_pump_caller(iree_task_poller_t* poller);
+
+// Blocks the calling thread until |wait_handle| (if not immediate), the wait
+// handle of any wait managed by |poller|, or a wake of the poller resolves or
+// |deadline_ns| elapses. Callers must call iree_task_poller_pump_caller to
+// process any waits that resolved.
+//
+// Only valid for pollers of threadless executors and must only be called by
+// the thread donated to the executor.
+iree_status_t iree_task_poller_wait_caller(iree_task_poller_t* poller,
+                                           iree_wait_handle_t wait_handle,
+                                           iree_time_t deadline_ns);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
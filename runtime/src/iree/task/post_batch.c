@@ -21,7 +21,7 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
                                      iree_task_post_batch_t* out_post_batch) {
   out_post_batch->executor = executor;
   out_post_batch->current_worker = current_worker;
-  out_post_batch->worker_pending_mask = 0;
+  iree_task_worker_set_clear(&out_post_batch->worker_pending_mask);
   memset(&out_post_batch->worker_pending_lifos, 0,
          executor->worker_count * sizeof(iree_task_list_t));
 }
@@ -32,13 +32,16 @@ iree_host_size_t iree_task_post_batch_worker_count(
 }
 
 static iree_host_size_t iree_task_post_batch_select_random_worker(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
+    iree_task_post_batch_t* post_batch,
+    const iree_task_worker_set_t* worker_set) {
   // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_live_mask =
-      iree_atomic_task_affinity_set_load(
-          &post_batch->executor->worker_live_mask, iree_memory_order_relaxed);
-  iree_task_affinity_set_t valid_worker_mask = affinity_set & worker_live_mask;
-  if (!valid_worker_mask) {
+  iree_task_worker_set_t valid_worker_mask;
+  iree_atomic_task_worker_set_load(&post_batch->executor->worker_live_mask,
+                                   iree_memory_order_relaxed,
+                                   &valid_worker_mask);
+  iree_task_worker_set_and(&valid_worker_mask, worker_set);
+  int worker_index = iree_task_worker_set_find_next(&valid_worker_mask, 0);
+  if (worker_index < 0) {
     // No valid workers as desired; for now just bail to worker 0.
     return 0;
   }
@@ -46,19 +49,24 @@ static iree_host_size_t iree_task_post_batch_select_random_worker(
   // TODO(benvanik): rotate through workers here. Instead, if the affinity set
   // has the current_worker allowed we just use that to avoid needing a
   // cross-thread hop.
-  return iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
+  return (iree_host_size_t)worker_index;
 }
 
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
+  iree_task_worker_set_t worker_set;
+  iree_task_executor_expand_affinity_set(post_batch->executor, affinity_set,
+                                         &worker_set);
+
   if (post_batch->current_worker) {
     // Posting from a worker - prefer sending right back to this worker if we
     // haven't already scheduled for it.
-    if ((affinity_set & post_batch->current_worker->worker_bit) &&
-        !(post_batch->worker_pending_mask &
-          post_batch->current_worker->worker_bit)) {
-      return iree_task_affinity_set_count_trailing_zeros(
-          post_batch->current_worker->worker_bit);
+    iree_host_size_t current_index =
+        post_batch->current_worker->local_worker_index;
+    if (iree_task_worker_set_contains(&worker_set, current_index) &&
+        !iree_task_worker_set_contains(&post_batch->worker_pending_mask,
+                                       current_index)) {
+      return current_index;
     }
   }
 
@@ -69,19 +77,20 @@ iree_host_size_t iree_task_post_batch_select_worker(
   // ourselves in this batch haven't already queued work for them (as then they
   // aren't going to be idle).
   // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(
-          &post_batch->executor->worker_idle_mask, iree_memory_order_relaxed);
-  worker_idle_mask &= ~post_batch->worker_pending_mask;
-  iree_task_affinity_set_t idle_affinity_set = affinity_set & worker_idle_mask;
-  if (idle_affinity_set) {
+  iree_task_worker_set_t idle_worker_set;
+  iree_atomic_task_worker_set_load(&post_batch->executor->worker_idle_mask,
+                                   iree_memory_order_relaxed, &idle_worker_set);
+  iree_task_worker_set_and_not(&idle_worker_set,
+                               &post_batch->worker_pending_mask);
+  iree_task_worker_set_and(&idle_worker_set, &worker_set);
+  if (!iree_task_worker_set_is_empty(&idle_worker_set)) {
     return iree_task_post_batch_select_random_worker(post_batch,
-                                                     idle_affinity_set);
+                                                     &idle_worker_set);
   }
 
   // No more workers are idle; farm out at random. In the worst case work
   // stealing will help balance things out on the backend.
-  return iree_task_post_batch_select_random_worker(post_batch, affinity_set);
+  return iree_task_post_batch_select_random_worker(post_batch, &worker_set);
 }
 
 void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
@@ -89,62 +98,71 @@ void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
                                   iree_task_t* task) {
   iree_task_list_push_front(&post_batch->worker_pending_lifos[worker_index],
                             task);
-  post_batch->worker_pending_mask |=
-      iree_task_affinity_for_worker(worker_index);
+  iree_task_worker_set_insert(&post_batch->worker_pending_mask, worker_index);
 }
 
+static_assert(sizeof(iree_task_affinity_set_t) * 8 >=
+                  IREE_NOTIFICATION_SET_WAKE_BIT_COUNT,
+              "affinity sets must hold all wake set bits");
+
 // Wakes each worker indicated in the |wake_mask|, if needed.
 static void iree_task_post_batch_wake_workers(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t wake_mask) {
+    iree_task_post_batch_t* post_batch,
+    const iree_task_worker_set_t* wake_mask) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, iree_math_count_ones_u64(wake_mask));
-
-  // TODO(#4016): use a FUTEX_WAKE_BITSET here to wake all of the workers that
-  // have pending work in a single syscall (vs. popcnt(worker_pending_mask)
-  // syscalls). This will reduce wake latency for workers later in the set;
-  // for example today worker[31] will wait until workers[0-30] have had their
-  // syscalls performed before it's even requested to wake. This also loses
-  // information the kernel could use to avoid core migration as it knows when N
-  // threads will be needed simultaneously and can hopefully perform any needed
-  // migrations prior to beginning execution.
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0,
+                                   iree_task_worker_set_count_ones(wake_mask));
+
+  // All workers wait on the shared executor wake set such that we can update
+  // each worker notification and then wake all of the workers that have
+  // pending work in a single syscall (vs. popcnt(worker_pending_mask)
+  // syscalls) where supported. This reduces wake latency for workers later in
+  // the set as worker[N] does not need to wait until workers[0-(N-1)] have had
+  // their syscalls performed before it's even requested to wake. It also gives
+  // the kernel the information that N threads will be needed simultaneously.
+  // The wake set has one bit per worker for up to 64 workers (two syscalls if
+  // workers in both 32-bit halves need waking) and larger executors share bits
+  // at the cost of spurious wakes.
   iree_task_executor_t* executor = post_batch->executor;
-  int wake_count = iree_task_affinity_set_count_ones(wake_mask);
-  int worker_index = 0;
-  for (int i = 0; i < wake_count; ++i) {
-    int offset = iree_task_affinity_set_count_trailing_zeros(wake_mask);
-    int wake_index = worker_index + offset;
-    worker_index += offset + 1;
-    wake_mask = iree_shr(wake_mask, offset + 1);
-
-    // Wake workers if they are waiting - workers are the only thing that can
-    // wait on this notification so this should almost always be either free (an
-    // atomic load) if a particular worker isn't waiting or it's required to
-    // actually wake it and we can't avoid it.
+  iree_task_affinity_set_t set_wake_mask = 0;
+  for (int wake_index = iree_task_worker_set_find_next(wake_mask, 0);
+       wake_index >= 0;
+       wake_index = iree_task_worker_set_find_next(wake_mask, wake_index + 1)) {
+    // Notify workers and note if they are waiting - workers are the only thing
+    // that can wait on this notification so this should almost always be
+    // either free (an atomic op) if a particular worker isn't waiting or it's
+    // required to actually wake it and we can't avoid it.
     iree_task_worker_t* worker = &executor->workers[wake_index];
-    iree_notification_post(&worker->wake_notification, 1);
+    if (iree_notification_post_deferred(&worker->wake_notification)) {
+      set_wake_mask |= iree_notification_set_wake_bit(wake_index);
+    }
   }
+  iree_notification_set_wake(&executor->worker_wake_set, set_wake_mask);
+
+  // Threadless executors have no worker thread waiting on the notification and
+  // the donated thread pumping the worker instead waits on the poller.
+  if (executor->threadless) iree_task_poller_wake(&executor->poller);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
 bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
-  if (!post_batch->worker_pending_mask) return false;
+  if (iree_task_worker_set_is_empty(&post_batch->worker_pending_mask)) {
+    return false;
+  }
 
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Run through each worker that has a bit set in the pending mask and post
   // the pending tasks.
-  iree_task_affinity_set_t worker_mask = post_batch->worker_pending_mask;
-  post_batch->worker_pending_mask = 0;
-  int worker_index = 0;
-  int post_count = iree_task_affinity_set_count_ones(worker_mask);
-  iree_task_affinity_set_t worker_wake_mask = 0;
-  for (int i = 0; i < post_count; ++i) {
-    int offset = iree_task_affinity_set_count_trailing_zeros(worker_mask);
-    int target_index = worker_index + offset;
-    worker_index += offset + 1;
-    worker_mask = iree_shr(worker_mask, offset + 1);
-
+  iree_task_worker_set_t worker_mask = post_batch->worker_pending_mask;
+  iree_task_worker_set_clear(&post_batch->worker_pending_mask);
+  iree_task_worker_set_t worker_wake_mask;
+  iree_task_worker_set_clear(&worker_wake_mask);
+  bool any_woken = false;
+  for (int target_index = iree_task_worker_set_find_next(&worker_mask, 0);
+       target_index >= 0; target_index = iree_task_worker_set_find_next(
+                              &worker_mask, target_index + 1)) {
     iree_task_worker_t* worker = &post_batch->executor->workers[target_index];
     iree_task_list_t* target_pending_lifo =
         &post_batch->worker_pending_lifos[target_index];
@@ -157,16 +175,17 @@ bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
                                                    target_pending_lifo);
     } else {
       iree_task_worker_post_tasks(worker, target_pending_lifo);
-      worker_wake_mask |= iree_task_affinity_for_worker(target_index);
+      iree_task_worker_set_insert(&worker_wake_mask, target_index);
+      any_woken = true;
     }
   }
 
   // Wake all workers that now have pending work. If a worker is not already
   // waiting this will be cheap (no syscall).
-  if (worker_wake_mask != 0) {
-    iree_task_post_batch_wake_workers(post_batch, worker_wake_mask);
+  if (any_woken) {
+    iree_task_post_batch_wake_workers(post_batch, &worker_wake_mask);
   }
 
   IREE_TRACE_ZONE_END(z0);
-  return post_count != 0;
+  return true;
 }
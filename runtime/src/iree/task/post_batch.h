@@ -37,7 +37,7 @@ typedef struct iree_task_post_batch_t {
 
   // A bitmask of workers indicating which have pending tasks in their lists.
   // Used to quickly scan the lists and perform the posts only when required.
-  iree_task_affinity_set_t worker_pending_mask;
+  iree_task_worker_set_t worker_pending_mask;
 
   // A per-worker LIFO task list waiting to be posted.
   iree_task_list_t worker_pending_lifos[0];
@@ -51,7 +51,8 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
 iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
-// Selects a random worker from the given affinity set.
+// Selects a random worker from the workers covered by the given cluster-granular
+// affinity set.
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
 
@@ -9,6 +9,8 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/task/task_impl.h"
+
 void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
   memset(out_queue, 0, sizeof(*out_queue));
   iree_slim_mutex_initialize(&out_queue->mutex);
@@ -20,6 +22,26 @@ void iree_task_queue_deinitialize(iree_task_queue_t* queue) {
   iree_slim_mutex_deinitialize(&queue->mutex);
 }
 
+void iree_task_queue_set_order(iree_task_queue_t* queue,
+                               iree_task_list_less_fn_t less_fn,
+                               void* user_data) {
+  queue->less_fn = less_fn;
+  queue->less_user_data = user_data;
+}
+
+// Adds |list| (in FIFO order) to the queue either by appending or, if the queue
+// is ordered, merging by the queue predicate. |list| must already be sorted in
+// the ordered case. Requires the queue mutex be held.
+static void iree_task_queue_insert_locked(iree_task_queue_t* queue,
+                                          iree_task_list_t* list) {
+  if (queue->less_fn) {
+    iree_task_list_merge(&queue->list, list, queue->less_fn,
+                         queue->less_user_data);
+  } else {
+    iree_task_list_append(&queue->list, list);
+  }
+}
+
 bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
   iree_slim_mutex_lock(&queue->mutex);
   bool is_empty = iree_task_list_is_empty(&queue->list);
@@ -27,6 +49,15 @@ bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
   return is_empty;
 }
 
+int32_t iree_task_queue_front_priority(iree_task_queue_t* queue) {
+  iree_slim_mutex_lock(&queue->mutex);
+  iree_task_t* task = iree_task_list_front(&queue->list);
+  int32_t priority =
+      task ? iree_task_scheduling_priority(task) : IREE_TASK_PRIORITY_NONE;
+  iree_slim_mutex_unlock(&queue->mutex);
+  return priority;
+}
+
 void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
   iree_slim_mutex_lock(&queue->mutex);
   iree_task_list_push_front(&queue->list, task);
@@ -35,10 +66,13 @@ void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
 
 void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
                                                   iree_task_list_t* list) {
-  // NOTE: reversing the list outside of the lock.
+  // NOTE: reversing (and sorting) the list outside of the lock.
   iree_task_list_reverse(list);
+  if (queue->less_fn) {
+    iree_task_list_sort(list, queue->less_fn, queue->less_user_data);
+  }
   iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_append(&queue->list, list);
+  iree_task_queue_insert_locked(queue, list);
   iree_slim_mutex_unlock(&queue->mutex);
 }
 
@@ -51,10 +85,13 @@ iree_task_t* iree_task_queue_flush_from_lifo_slist(
   const bool did_flush = iree_atomic_task_slist_flush(
       source_slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
       &suffix.head, &suffix.tail);
+  if (did_flush && queue->less_fn) {
+    iree_task_list_sort(&suffix, queue->less_fn, queue->less_user_data);
+  }
 
   // Append the tasks and pop off the front for return.
   iree_slim_mutex_lock(&queue->mutex);
-  if (did_flush) iree_task_list_append(&queue->list, &suffix);
+  if (did_flush) iree_task_queue_insert_locked(queue, &suffix);
   iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
   iree_slim_mutex_unlock(&queue->mutex);
 
@@ -80,10 +117,17 @@ iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
   }
 
   // Add any stolen tasks to the target queue and pop off the head for return.
+  // Stolen tasks are a suffix of the source queue and as such are already
+  // sorted if the queues share an ordering.
   iree_task_t* next_task = NULL;
   if (!iree_task_list_is_empty(&stolen_tasks)) {
+    if (target_queue->less_fn &&
+        target_queue->less_fn != source_queue->less_fn) {
+      iree_task_list_sort(&stolen_tasks, target_queue->less_fn,
+                          target_queue->less_user_data);
+    }
     iree_slim_mutex_lock(&target_queue->mutex);
-    iree_task_list_append(&target_queue->list, &stolen_tasks);
+    iree_task_queue_insert_locked(target_queue, &stolen_tasks);
     next_task = iree_task_list_pop_front(&target_queue->list);
     iree_slim_mutex_unlock(&target_queue->mutex);
   }
@@ -108,6 +108,11 @@ typedef struct iree_task_queue_t {
 
   // FIFO task list.
   iree_task_list_t list IREE_GUARDED_BY(mutex);
+
+  // Optional ordering predicate used to keep |list| sorted as tasks arrive.
+  // When NULL the queue is strictly FIFO.
+  iree_task_list_less_fn_t less_fn;
+  void* less_user_data;
 } iree_task_queue_t;
 
 // Initializes a work-stealing task queue in-place.
@@ -117,10 +122,25 @@ void iree_task_queue_initialize(iree_task_queue_t* out_queue);
 // Must not be called while any other worker may be attempting to steal tasks.
 void iree_task_queue_deinitialize(iree_task_queue_t* queue);
 
+// Sets an ordering predicate used to keep the queue sorted as tasks are added.
+// Tasks flushed, appended, or stolen into the queue are merged in by |less_fn|
+// with equal tasks retaining FIFO order. Tasks pushed to the front (such as
+// yielded tasks) bypass the ordering. Passing NULL restores FIFO behavior.
+//
+// Must only be called before the queue is in use by other threads.
+void iree_task_queue_set_order(iree_task_queue_t* queue,
+                               iree_task_list_less_fn_t less_fn,
+                               void* user_data);
+
 // Returns true if the queue is empty.
 // Note that due to races this may return both false-positives and -negatives.
 bool iree_task_queue_is_empty(iree_task_queue_t* queue);
 
+// Returns the scheduling priority of the task at the front of the queue or
+// IREE_TASK_PRIORITY_NONE if the queue is empty.
+// Note that due to races the front task may change before this returns.
+int32_t iree_task_queue_front_priority(iree_task_queue_t* queue);
+
 // Pushes a task to the front of the queue.
 // Always prefer the multi-push variants (prepend/append) when adding more than
 // one task to the queue. This is mostly useful for exceptional cases such as
@@ -26,6 +26,8 @@ void iree_task_scope_initialize(iree_string_view_t name,
   out_scope->name[name_length] = 0;
 
   out_scope->flags = flags;
+  iree_atomic_store_int32(&out_scope->priority, IREE_TASK_SCOPE_PRIORITY_NORMAL,
+                          iree_memory_order_relaxed);
 
   // TODO(benvanik): pick trace colors based on name hash.
   IREE_TRACE(out_scope->task_trace_color = 0xFFFF0000u);
@@ -66,6 +68,18 @@ iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope) {
   return iree_make_cstring_view(scope->name);
 }
 
+iree_task_scope_priority_t iree_task_scope_priority(iree_task_scope_t* scope) {
+  // relaxed order as priority is only a scheduling hint.
+  return (iree_task_scope_priority_t)iree_atomic_load_int32(
+      &scope->priority, iree_memory_order_relaxed);
+}
+
+void iree_task_scope_set_priority(iree_task_scope_t* scope,
+                                  iree_task_scope_priority_t priority) {
+  iree_atomic_store_int32(&scope->priority, (int32_t)priority,
+                          iree_memory_order_relaxed);
+}
+
 iree_task_dispatch_statistics_t iree_task_scope_consume_statistics(
     iree_task_scope_t* scope) {
   iree_task_dispatch_statistics_t result = scope->dispatch_statistics;
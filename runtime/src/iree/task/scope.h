@@ -28,6 +28,19 @@ enum iree_task_scope_flag_bits_e {
 };
 typedef uint32_t iree_task_scope_flags_t;
 
+// Relative scheduling priority of tasks within a scope.
+// Only used by executors with IREE_TASK_SCHEDULING_MODE_PRIORITY set; all
+// scopes are treated equally otherwise. Values are compared numerically and
+// any value between the defined levels may be used.
+typedef enum iree_task_scope_priority_e {
+  // Background work that should only run when nothing else is pending.
+  IREE_TASK_SCOPE_PRIORITY_LOW = 0,
+  // Default priority of all scopes.
+  IREE_TASK_SCOPE_PRIORITY_NORMAL = 16,
+  // Latency-critical work that should jump ahead of all other work.
+  IREE_TASK_SCOPE_PRIORITY_HIGH = 32,
+} iree_task_scope_priority_t;
+
 // iree_task_scope_t is an atomic reference-counting helper posting a
 // notification when the reference count is decremended to 0.
 //
@@ -60,6 +73,10 @@ typedef struct iree_task_scope_t {
   // Flags controlling optional scope behavior.
   iree_task_scope_flags_t flags;
 
+  // Scheduling priority (iree_task_scope_priority_t) of tasks in the scope.
+  // May be changed at any time and will take effect as tasks are scheduled.
+  iree_atomic_int32_t priority;
+
   // Base color used for tasks in this scope.
   // The color will be modulated based on task type.
   IREE_TRACE(uint32_t task_trace_color;)
@@ -101,6 +118,15 @@ void iree_task_scope_deinitialize(iree_task_scope_t* scope);
 // string.
 iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope);
 
+// Returns the scheduling priority of tasks within the scope.
+iree_task_scope_priority_t iree_task_scope_priority(iree_task_scope_t* scope);
+
+// Sets the scheduling |priority| of tasks within the scope.
+// Tasks that have already been scheduled are not reordered until they are next
+// considered by the executor.
+void iree_task_scope_set_priority(iree_task_scope_t* scope,
+                                  iree_task_scope_priority_t priority);
+
 // Returns and resets the statistics for the scope.
 // Statistics may experience tearing (non-atomic update across fields) if this
 // is performed while tasks are in-flight.
@@ -23,6 +23,16 @@ TEST(ScopeTest, Lifetime) {
   iree_task_scope_deinitialize(&scope);
 }
 
+TEST(ScopeTest, Priority) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+  EXPECT_EQ(IREE_TASK_SCOPE_PRIORITY_NORMAL, iree_task_scope_priority(&scope));
+  iree_task_scope_set_priority(&scope, IREE_TASK_SCOPE_PRIORITY_HIGH);
+  EXPECT_EQ(IREE_TASK_SCOPE_PRIORITY_HIGH, iree_task_scope_priority(&scope));
+  iree_task_scope_deinitialize(&scope);
+}
+
 // NOTE: the exact capacity (and whether we store the name at all) is an
 // implementation detail.
 TEST(ScopeTest, LongNameTruncation) {
@@ -28,6 +28,7 @@ void iree_task_initialize(iree_task_type_t type, iree_task_scope_t* scope,
   out_task->scope = scope;
   out_task->affinity_set = iree_task_affinity_for_any_worker();
   out_task->type = type;
+  iree_task_scheduling_refresh_priority(out_task);
 }
 
 void iree_task_set_cleanup_fn(iree_task_t* task,
@@ -206,6 +207,53 @@ static void iree_task_retire(iree_task_t* task,
   task = NULL;
 }
 
+//==============================================================================
+// Scheduling utilities
+//==============================================================================
+
+void iree_task_scheduling_refresh_priority(iree_task_t* task) {
+  const int32_t priority = task->scope
+                               ? (int32_t)iree_task_scope_priority(task->scope)
+                               : IREE_TASK_SCOPE_PRIORITY_NORMAL;
+  task->priority = (int16_t)iree_min(iree_max(priority, INT16_MIN), INT16_MAX);
+}
+
+int32_t iree_task_scheduling_priority(const iree_task_t* task) {
+  return task->priority;
+}
+
+uint64_t iree_task_scheduling_cost(const iree_task_t* task) {
+  switch (task->type) {
+    default:
+    case IREE_TASK_TYPE_NOP:
+    case IREE_TASK_TYPE_BARRIER:
+    case IREE_TASK_TYPE_FENCE:
+    case IREE_TASK_TYPE_WAIT:
+      // Control tasks only unblock other work and should run ASAP.
+      return 0;
+    case IREE_TASK_TYPE_CALL:
+      // Calls are opaque; assume they are a single unit of work.
+      return 1;
+    case IREE_TASK_TYPE_DISPATCH: {
+      const iree_task_dispatch_t* dispatch_task =
+          (const iree_task_dispatch_t*)task;
+      if (task->flags & IREE_TASK_FLAG_DISPATCH_RETIRE) return 0;
+      if (task->flags & IREE_TASK_FLAG_DISPATCH_INDIRECT) return UINT64_MAX;
+      return (uint64_t)dispatch_task->workgroup_count.value[0] *
+             dispatch_task->workgroup_count.value[1] *
+             dispatch_task->workgroup_count.value[2];
+    }
+    case IREE_TASK_TYPE_DISPATCH_SHARD: {
+      // Shards share the work of their dispatch and are sized by its total
+      // tile count. This must not change while the shard is queued as ordered
+      // queues rely on it to stay sorted.
+      const iree_task_dispatch_t* dispatch_task =
+          (const iree_task_dispatch_t*)task->completion_task;
+      return dispatch_task->tile_count;
+    }
+  }
+}
+
 //==============================================================================
 // IREE_TASK_TYPE_NOP
 //==============================================================================
@@ -451,8 +499,6 @@ static uint32_t iree_task_tile_to_color(
 
 #if defined(IREE_TASK_TRACING_PER_TILE_COLORS)
 
-// TODO(#4017): optimize this to compute entire slices at once and fold in the
-// work grid location code.
 static uint32_t iree_math_hsv_to_xrgb(const uint8_t h, const uint8_t s,
                                       const uint8_t v) {
   // NOTE: this is matching with tracy's TracyColor.cpp implementation so that
@@ -482,24 +528,20 @@ static uint32_t iree_math_hsv_to_xrgb(const uint8_t h, const uint8_t s,
 
 static uint32_t iree_task_tile_to_color(
     const iree_task_tile_context_t* tile_context) {
-  // TODO(#4017): optimize such that it's always on when tracing is
-  // enabled by amortizing the cost across the entire slice.
-
   // Picked to try to make it easy to see gradients from tiles along the same x,
   // y, and z (in that order). x is the fastest changing dimension and as such
   // should all have the same hue, while z is the slowest changing dimension and
   // should have different hues.
-  uint8_t h = (tile_context->workgroup_xyz[1] /
-               (float)(tile_context->workgroup_count[1])) *
-              255;
+  //
+  // Only integer math is used so that this is cheap enough to always have on
+  // when tracing: workgroup indices are always less than their counts and the
+  // products fit in 64 bits.
+  const uint32_t* xyz = tile_context->workgroup_xyz;
+  const uint32_t* count = tile_context->workgroup_count;
+  uint8_t h = (uint8_t)(((uint64_t)xyz[1] * 255) / count[1]);
   h = (h * 11400714819323198485ull) & 0xFF;
-  uint8_t s = 100 - (tile_context->workgroup_xyz[2] /
-                     (float)(tile_context->workgroup_count[2])) *
-                        100;
-  uint8_t v = (tile_context->workgroup_xyz[0] /
-               (float)(tile_context->workgroup_count[0])) *
-                  50 +
-              50;
+  uint8_t s = (uint8_t)(100 - ((uint64_t)xyz[2] * 100) / count[2]);
+  uint8_t v = (uint8_t)(((uint64_t)xyz[0] * 50) / count[0] + 50);
   return iree_math_hsv_to_xrgb(h, s, v);
 }
 
@@ -515,7 +557,20 @@ static uint32_t iree_task_tile_to_color(
 void iree_task_dispatch_statistics_merge(
     const iree_task_dispatch_statistics_t* source,
     iree_task_dispatch_statistics_t* target) {
-  // TODO(benvanik): statistics.
+#if IREE_STATISTICS_ENABLE
+#define IREE_TASK_STATISTICS_MERGE_FIELD(field)                            \
+  iree_atomic_fetch_add_int64(                                            \
+      &target->field,                                                      \
+      iree_atomic_load_int64((iree_atomic_int64_t*)&source->field,         \
+                             iree_memory_order_relaxed),                   \
+      iree_memory_order_relaxed)
+  IREE_TASK_STATISTICS_MERGE_FIELD(dispatch_count);
+  IREE_TASK_STATISTICS_MERGE_FIELD(tile_count);
+  IREE_TASK_STATISTICS_MERGE_FIELD(steal_count);
+  IREE_TASK_STATISTICS_MERGE_FIELD(busy_time_ns);
+  IREE_TASK_STATISTICS_MERGE_FIELD(wall_time_ns);
+#undef IREE_TASK_STATISTICS_MERGE_FIELD
+#endif  // IREE_STATISTICS_ENABLE
 }
 
 //==============================================================================
@@ -532,12 +587,7 @@ static void iree_task_dispatch_initialize_base(
   out_task->local_memory_size = 0;
   iree_atomic_store_intptr(&out_task->status, 0, iree_memory_order_release);
   memset(&out_task->statistics, 0, sizeof(out_task->statistics));
-
-  IREE_TRACE({
-    static iree_atomic_int64_t next_dispatch_id = IREE_ATOMIC_VAR_INIT(0);
-    out_task->dispatch_id = iree_atomic_fetch_add_int64(
-        &next_dispatch_id, 1ll, iree_memory_order_acq_rel);
-  });
+  out_task->dispatch_id = 0;  // assigned on issue
 }
 
 void iree_task_dispatch_initialize(iree_task_scope_t* scope,
@@ -564,7 +614,16 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                               iree_task_submission_t* pending_submission,
                               iree_task_post_batch_t* post_batch) {
   IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Assign the identifier on issue instead of initialization so that dispatches
+  // copied from a template (such as by reusable command buffers) are unique.
+  static iree_atomic_int64_t next_dispatch_id = IREE_ATOMIC_VAR_INIT(0);
+  dispatch_task->dispatch_id = iree_atomic_fetch_add_int64(
+      &next_dispatch_id, 1ll, iree_memory_order_relaxed);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, dispatch_task->dispatch_id);
+#if IREE_STATISTICS_ENABLE
+  dispatch_task->issue_time_ns = iree_time_now();
+#endif  // IREE_STATISTICS_ENABLE
 
   // Mark the dispatch as having been issued; the next time it retires it'll be
   // because all work has completed.
@@ -575,9 +634,8 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
     // By the task being ready to execute we know any dependencies on the
     // indirection buffer have been satisfied and its safe to read. We perform
     // the indirection here and convert the dispatch to a direct one such that
-    // following code can read the value.
-    // TODO(benvanik): non-one-shot command buffers won't be able to do this as
-    // the intent is that they can be dynamic per execution.
+    // following code can read the value. Reusable command buffers issue a
+    // fresh copy of the dispatch each execution so the rewrite is not sticky.
     const uint32_t* source_ptr = dispatch_task->workgroup_count.ptr;
     memcpy(dispatch_task->workgroup_count.value, source_ptr,
            sizeof(dispatch_task->workgroup_count.value));
@@ -655,7 +713,20 @@ void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, dispatch_task->dispatch_id);
 
-  // TODO(benvanik): attach statistics to the tracy zone.
+#if IREE_STATISTICS_ENABLE
+  iree_task_dispatch_statistics_t* statistics = &dispatch_task->statistics;
+  iree_atomic_store_int64(&statistics->dispatch_count, 1,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&statistics->wall_time_ns,
+                          iree_time_now() - dispatch_task->issue_time_ns,
+                          iree_memory_order_relaxed);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(
+      z0, iree_atomic_load_int64(&statistics->tile_count,
+                                 iree_memory_order_relaxed));
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(
+      z0, iree_atomic_load_int64(&statistics->steal_count,
+                                 iree_memory_order_relaxed));
+#endif  // IREE_STATISTICS_ENABLE
 
   // Merge the statistics from the dispatch into the scope so we can track all
   // of the work without tracking all the dispatches at a global level.
@@ -693,6 +764,7 @@ void iree_task_dispatch_shard_initialize(iree_task_dispatch_t* dispatch_task,
   iree_task_initialize(IREE_TASK_TYPE_DISPATCH_SHARD,
                        dispatch_task->header.scope, &out_task->header);
   iree_task_set_completion_task(&out_task->header, &dispatch_task->header);
+  out_task->header.priority = dispatch_task->header.priority;
 }
 
 iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
@@ -709,9 +781,42 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
-void iree_task_dispatch_shard_execute(
+// Completes the statistics of a shard that executed |tile_count| tiles and
+// merges them into the dispatch. Called prior to the shard retiring or
+// yielding.
+static void iree_task_dispatch_shard_end_statistics(
+    iree_task_dispatch_shard_t* task, iree_task_dispatch_t* dispatch_task,
+    uint32_t tile_count, bool yielded,
+    iree_task_dispatch_statistics_t* shard_statistics,
+    iree_task_dispatch_record_t* record) {
+#if IREE_STATISTICS_ENABLE
+  const bool stolen = iree_any_bit_set(task->header.flags,
+                                       IREE_TASK_FLAG_DISPATCH_SHARD_STOLEN);
+  task->header.flags &= ~IREE_TASK_FLAG_DISPATCH_SHARD_STOLEN;
+  iree_atomic_store_int64(&shard_statistics->tile_count, tile_count,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&shard_statistics->steal_count, stolen ? 1 : 0,
+                          iree_memory_order_relaxed);
+  if (record) {
+    record->end_time_ns = iree_time_now();
+    record->dispatch_id = dispatch_task->dispatch_id;
+    record->tile_count = tile_count;
+    record->flags = (stolen ? IREE_TASK_DISPATCH_RECORD_FLAG_STOLEN : 0) |
+                    (yielded ? IREE_TASK_DISPATCH_RECORD_FLAG_YIELDED : 0);
+    iree_atomic_store_int64(&shard_statistics->busy_time_ns,
+                            record->end_time_ns - record->start_time_ns,
+                            iree_memory_order_relaxed);
+  }
+#endif  // IREE_STATISTICS_ENABLE
+  iree_task_dispatch_statistics_merge(shard_statistics,
+                                      &dispatch_task->statistics);
+}
+
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    const iree_atomic_int32_t* yield_priority,
+    iree_task_dispatch_record_t* record,
     iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -732,11 +837,20 @@ void iree_task_dispatch_shard_execute(
                          "%" PRIhsz "b is available per-worker",
                          dispatch_task->local_memory_size,
                          worker_local_memory.data_length));
+    iree_task_dispatch_statistics_t shard_statistics;
+    memset(&shard_statistics, 0, sizeof(shard_statistics));
+    iree_task_dispatch_shard_end_statistics(task, dispatch_task,
+                                            /*tile_count=*/0, /*yielded=*/false,
+                                            &shard_statistics, record);
     iree_task_retire(&task->header, pending_submission, iree_ok_status());
     IREE_TRACE_ZONE_END(z0);
-    return;
+    return true;
   }
 
+  // Priority the shard must be preempted by in order to yield, if yielding.
+  const int32_t shard_priority =
+      yield_priority ? iree_task_scheduling_priority(&task->header) : 0;
+
   // Prepare context shared for all tiles in the shard.
   iree_task_tile_context_t tile_context;
   memcpy(&tile_context.workgroup_size, dispatch_task->workgroup_size,
@@ -761,6 +875,7 @@ void iree_task_dispatch_shard_execute(
   // Loop over all tiles until they are all processed.
   const uint32_t tile_count = dispatch_task->tile_count;
   const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
+  uint32_t tiles_executed = 0;
   // relaxed order because we only care about atomic increments, not about
   // ordering of tile_index accesses w.r.t. other memory accesses.
   uint32_t tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
@@ -798,6 +913,7 @@ void iree_task_dispatch_shard_execute(
                                     &tile_context, pending_submission);
 
       IREE_TRACE_ZONE_END(z_tile);
+      ++tiles_executed;
 
       // If any tile fails we bail early from the loop. This doesn't match
       // what an accelerator would do but saves some unneeded work.
@@ -812,6 +928,22 @@ void iree_task_dispatch_shard_execute(
       }
     }
 
+    // If higher priority work has arrived for the worker yield before taking
+    // another reservation; the remaining tiles will be processed by other
+    // shards or this one when it is resumed.
+    // relaxed order as priority is only a scheduling hint.
+    if (yield_priority &&
+        IREE_UNLIKELY(iree_atomic_load_int32(
+                          (iree_atomic_int32_t*)yield_priority,
+                          iree_memory_order_relaxed) > shard_priority)) {
+      iree_task_dispatch_shard_end_statistics(task, dispatch_task,
+                                              tiles_executed, /*yielded=*/true,
+                                              &shard_statistics, record);
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "yielded");
+      IREE_TRACE_ZONE_END(z0);
+      return false;
+    }
+
     // Try to grab the next slice of tiles.
     tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
                                             tiles_per_reservation,
@@ -822,11 +954,13 @@ abort_shard:
   // Push aggregate statistics up to the dispatch.
   // Note that we may have partial information here if we errored out of the
   // loop but that's still useful to know.
-  iree_task_dispatch_statistics_merge(&shard_statistics,
-                                      &dispatch_task->statistics);
+  iree_task_dispatch_shard_end_statistics(task, dispatch_task, tiles_executed,
+                                          /*yielded=*/false, &shard_statistics,
+                                          record);
 
   // NOTE: even if an error was hit we retire OK - the error has already been
   // propagated to the dispatch and it'll clean up after all shards are joined.
   iree_task_retire(&task->header, pending_submission, iree_ok_status());
   IREE_TRACE_ZONE_END(z0);
+  return true;
 }
@@ -117,6 +117,11 @@ enum iree_task_flag_bits_t {
   // happens and may be available for querying before all tasks have been
   // cleaned up.
   IREE_TASK_FLAG_ABORTED = 1u << 5,
+
+  // The dispatch shard was stolen by a worker other than the one it was posted
+  // to. Set by the stealing worker and consumed when the shard executes so that
+  // steals can be attributed to the dispatch.
+  IREE_TASK_FLAG_DISPATCH_SHARD_STOLEN = 1u << 6,
 };
 typedef uint16_t iree_task_flags_t;
 
@@ -180,6 +185,12 @@ struct iree_alignas(iree_max_align_t) iree_task_t {
 
   // Task-specific flag bits.
   iree_task_flags_t flags;
+
+  // Scheduling priority (iree_task_scope_priority_t) captured from the scope
+  // when the task was last issued. Ordered queues compare this snapshot instead
+  // of the live scope priority so that changing the priority of a scope cannot
+  // reorder tasks that are already queued.
+  int16_t priority;
 };
 static_assert(offsetof(iree_task_t, next_task) == 0,
               "next_task intrusive pointer must be at offset 0");
@@ -492,10 +503,22 @@ void iree_task_wait_set_wait_any(iree_task_wait_t* task,
 // generic ones like 'l2 cache misses' or 'ipc') then we can sprinkle in some
 // #ifdefs.
 typedef struct iree_task_dispatch_statistics_t {
-  // TODO(benvanik): statistics counters.
-  // NOTE: each of these increases the command buffer storage requirements; we
-  // should always guard these with IREE_STATISTICS_ENABLE.
+#if IREE_STATISTICS_ENABLE
+  // Total number of dispatches that have retired.
+  iree_atomic_int64_t dispatch_count;
+  // Total number of tiles executed across all shards.
+  iree_atomic_int64_t tile_count;
+  // Total number of shards executed by a worker that stole them.
+  iree_atomic_int64_t steal_count;
+  // Total time spent by workers executing shards.
+  iree_atomic_int64_t busy_time_ns;
+  // Total time from dispatches being issued until they retired.
+  iree_atomic_int64_t wall_time_ns;
+#else
+  // NOTE: each counter increases the command buffer storage requirements and
+  // they are only present with IREE_STATISTICS_ENABLE.
   iree_atomic_int32_t reserved;
+#endif  // IREE_STATISTICS_ENABLE
 } iree_task_dispatch_statistics_t;
 
 // Merges statistics from |source| to |target| atomically per-field.
@@ -505,6 +528,34 @@ void iree_task_dispatch_statistics_merge(
     const iree_task_dispatch_statistics_t* source,
     iree_task_dispatch_statistics_t* target);
 
+enum iree_task_dispatch_record_flag_bits_t {
+  IREE_TASK_DISPATCH_RECORD_FLAG_NONE = 0u,
+  // The shard was stolen from the worker it was originally posted to.
+  IREE_TASK_DISPATCH_RECORD_FLAG_STOLEN = 1u << 0,
+  // The shard yielded to higher priority work before all tiles were reserved
+  // and will be resumed (producing another record) later.
+  IREE_TASK_DISPATCH_RECORD_FLAG_YIELDED = 1u << 1,
+};
+typedef uint32_t iree_task_dispatch_record_flags_t;
+
+// A record of one dispatch shard execution on a worker.
+// Workers append records to their own ring buffer as shards complete and they
+// can be drained with iree_task_executor_drain_dispatch_records. All shards of
+// a dispatch share the same |dispatch_id| such that the span of a dispatch
+// across workers can be reconstructed from the earliest start and latest end.
+typedef struct iree_task_dispatch_record_t {
+  // Process-lifetime identifier of the dispatch the shard belongs to.
+  int64_t dispatch_id;
+  // Time the worker began and finished executing the shard.
+  iree_time_t start_time_ns;
+  iree_time_t end_time_ns;
+  // Globally unique index of the worker that executed the shard.
+  uint32_t worker_index;
+  // Number of tiles the shard executed.
+  uint32_t tile_count;
+  iree_task_dispatch_record_flags_t flags;
+} iree_task_dispatch_record_t;
+
 typedef struct iree_task_tile_storage_t {
   // TODO(benvanik): coroutine storage.
   // Ideally we'll be able to have a fixed coroutine storage size per dispatch
@@ -653,8 +704,13 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // per shard instead of once per slice and are less of a concern.
   iree_atomic_int32_t tile_index;
 
+#if IREE_STATISTICS_ENABLE
+  // Time the dispatch was issued used to compute its wall time on retire.
+  iree_time_t issue_time_ns;
+#endif  // IREE_STATISTICS_ENABLE
+
   // Incrementing process-lifetime dispatch identifier.
-  IREE_TRACE(int64_t dispatch_id;)
+  int64_t dispatch_id;
 } iree_task_dispatch_t;
 
 void iree_task_dispatch_initialize(iree_task_scope_t* scope,
@@ -17,6 +17,28 @@
 extern "C" {
 #endif
 
+//==============================================================================
+// Scheduling utilities
+//==============================================================================
+
+// Sentinel priority indicating that no priority is available.
+#define IREE_TASK_PRIORITY_NONE (-1)
+
+// Captures the current priority of the scope of |task| for use in scheduling.
+// Tasks without a scope are treated as having normal priority. Must only be
+// called while the task is not in an ordered queue.
+void iree_task_scheduling_refresh_priority(iree_task_t* task);
+
+// Returns the scheduling priority (iree_task_scope_priority_t) of |task| as
+// captured by the last iree_task_scheduling_refresh_priority.
+int32_t iree_task_scheduling_priority(const iree_task_t* task);
+
+// Returns an estimate of the work in |task| used to order tasks for
+// shortest-job-first scheduling. Lower values are cheaper. Control tasks that
+// only unblock other work are 0 and tasks of unknown size are UINT64_MAX.
+// Only depends on state that is fixed while the task is queued.
+uint64_t iree_task_scheduling_cost(const iree_task_t* task);
+
 //==============================================================================
 // IREE_TASK_TYPE_NOP
 //==============================================================================
@@ -118,11 +140,22 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 // |worker_local_memory| is a block of memory exclusively available to the shard
 // during execution. Contents are undefined both before and after execution.
 //
+// |yield_priority| is an optional priority that, if raised above the priority
+// of the shard while executing, will cause the shard to yield between tile
+// reservations. Yielded shards return false and are not retired; the caller
+// must requeue them to continue processing the remaining tiles later.
+//
+// |record| is an optional record with start_time_ns set to when the caller
+// began executing the shard. When provided the shard contributes its busy time
+// to the dispatch statistics and fills in the remaining fields of the record.
+//
 // Errors are propagated to the parent scope and the dispatch will fail once
 // all shards have completed.
-void iree_task_dispatch_shard_execute(
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    const iree_atomic_int32_t* yield_priority,
+    iree_task_dispatch_record_t* record,
     iree_task_submission_t* pending_submission);
 
 #ifdef __cplusplus
@@ -12,13 +12,14 @@
 #include "iree/base/api.h"
 
 void iree_task_topology_group_initialize(
-    uint8_t group_index, iree_task_topology_group_t* out_group) {
+    uint16_t group_index, iree_task_topology_group_t* out_group) {
   memset(out_group, 0, sizeof(*out_group));
   out_group->group_index = group_index;
+  out_group->node_id = IREE_TASK_TOPOLOGY_NODE_ID_ANY;
   snprintf(out_group->name, IREE_ARRAYSIZE(out_group->name), "iree-worker-%u",
            group_index);
   iree_thread_affinity_set_any(&out_group->ideal_thread_affinity);
-  out_group->constructive_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
+  iree_task_worker_set_fill(&out_group->constructive_sharing_mask);
 }
 
 void iree_task_topology_initialize(iree_task_topology_t* out_topology) {
@@ -63,6 +64,18 @@ const iree_task_topology_group_t* iree_task_topology_get_group(
   return &topology->groups[group_index];
 }
 
+iree_task_topology_node_id_t iree_task_topology_memory_node(
+    const iree_task_topology_t* topology) {
+  if (topology->group_count == 0) return IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+  const iree_task_topology_node_id_t node_id = topology->groups[0].node_id;
+  for (iree_host_size_t i = 1; i < topology->group_count; ++i) {
+    if (topology->groups[i].node_id != node_id) {
+      return IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+    }
+  }
+  return node_id;
+}
+
 iree_status_t iree_task_topology_push_group(
     iree_task_topology_t* topology, const iree_task_topology_group_t* group) {
   if (topology->group_count + 1 > IREE_ARRAYSIZE(topology->groups)) {
@@ -115,7 +128,7 @@ iree_status_t iree_task_topology_initialize_from_thread_affinities(
     iree_task_topology_t* out_topology) {
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (group_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (group_count > IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many groups specified (%" PRIhsz
                             " provided for a max capacity of %zu)",
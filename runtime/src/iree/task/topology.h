@@ -13,6 +13,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/threading.h"
+#include "iree/task/affinity_set.h"
 #include "iree/task/tuning.h"
 
 #ifdef __cplusplus
@@ -37,17 +38,27 @@ iree_host_size_t iree_task_topology_query_node_count(void);
 // is not available on the platform.
 iree_task_topology_node_id_t iree_task_topology_query_current_node(void);
 
+// Returns the NUMA memory node that the logical processor with the given
+// platform |processor_index| is attached to or IREE_TASK_TOPOLOGY_NODE_ID_ANY
+// if the query is not available on the platform. Unlike the node IDs used to
+// partition topologies (which may be processor clusters) this is the node ID
+// used by the OS when placing memory.
+iree_task_topology_node_id_t iree_task_topology_query_processor_memory_node(
+    uint32_t processor_index);
+
 //===----------------------------------------------------------------------===//
 // Topology group (worker thread(s) assigned to a processor)
 //===----------------------------------------------------------------------===//
 
 // A bitmask indicating which other groups from 0 to N may constructively share
 // caches. For example, a value of 0b1100 indicates that group 2 and 3 share.
-typedef uint64_t iree_task_topology_group_mask_t;
+// Groups map 1:1 with executor workers and the mask uses the same multi-word
+// representation as the executor worker sets.
+typedef iree_task_worker_set_t iree_task_topology_group_mask_t;
 
-#define IREE_TASK_TOPOLOGY_GROUP_MASK_ALL UINT64_MAX
+// Total number of groups that can be represented in a group mask.
 #define IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT \
-  (sizeof(iree_task_topology_group_mask_t) * 8)
+  ((iree_host_size_t)IREE_TASK_EXECUTOR_MAX_WORKER_COUNT)
 
 // Total cache sizes (that we care about).
 // More information may be available but we shouldn't be specializing on it
@@ -66,14 +77,19 @@ typedef struct iree_task_topology_caches_t {
 typedef struct iree_task_topology_group_t {
   // Group index within the topology matching a particular bit in
   // iree_task_topology_group_mask_t.
-  uint8_t group_index;
+  uint16_t group_index;
 
   // A name assigned to executor workers used for logging/tracing.
-  char name[32 - /*group_index*/ 1];
+  char name[32 - /*group_index*/ 2];
 
   // Logical processor index.
   uint32_t processor_index;
 
+  // NUMA memory node the processor is attached to or
+  // IREE_TASK_TOPOLOGY_NODE_ID_ANY if unknown. Memory that is primarily
+  // accessed by workers in this group should be placed on this node.
+  iree_task_topology_node_id_t node_id;
+
   // Total cache sizes (that we care about).
   iree_task_topology_caches_t caches;
 
@@ -89,9 +105,11 @@ typedef struct iree_task_topology_group_t {
   // all share the same L3 cache.
   iree_task_topology_group_mask_t constructive_sharing_mask;
 } iree_task_topology_group_t;
+static_assert(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT <= UINT16_MAX + 1,
+              "group_index must be able to hold every worker index");
 
 // Initializes |out_group| with a |group_index| derived name.
-void iree_task_topology_group_initialize(uint8_t group_index,
+void iree_task_topology_group_initialize(uint16_t group_index,
                                          iree_task_topology_group_t* out_group);
 
 //===----------------------------------------------------------------------===//
@@ -148,6 +166,12 @@ iree_host_size_t iree_task_topology_group_count(
 const iree_task_topology_group_t* iree_task_topology_get_group(
     const iree_task_topology_t* topology, iree_host_size_t group_index);
 
+// Returns the NUMA memory node shared by all groups in the topology or
+// IREE_TASK_TOPOLOGY_NODE_ID_ANY if the groups span multiple nodes or have no
+// node assigned.
+iree_task_topology_node_id_t iree_task_topology_memory_node(
+    const iree_task_topology_t* topology);
+
 // Pushes a new group onto the topology set.
 // The provided group data will be copied into the topology structure.
 iree_status_t iree_task_topology_push_group(
@@ -28,6 +28,43 @@ static void iree_task_topology_initialize_fallback(
   IREE_TRACE_ZONE_END(z0);
 }
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+
+#include <dirent.h>
+#include <stdio.h>
+
+iree_task_topology_node_id_t iree_task_topology_query_processor_memory_node(
+    uint32_t processor_index) {
+  // The kernel exposes the memory node of each CPU as a `node<N>` link in its
+  // sysfs directory. Kernels built without NUMA support have no such link.
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u",
+           processor_index);
+  DIR* dir = opendir(path);
+  if (!dir) return IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+  iree_task_topology_node_id_t node_id = IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+  struct dirent* entry = NULL;
+  while ((entry = readdir(dir)) != NULL) {
+    unsigned int value = 0;
+    char trailing = 0;
+    if (sscanf(entry->d_name, "node%u%c", &value, &trailing) == 1) {
+      node_id = (iree_task_topology_node_id_t)value;
+      break;
+    }
+  }
+  closedir(dir);
+  return node_id;
+}
+
+#else
+
+iree_task_topology_node_id_t iree_task_topology_query_processor_memory_node(
+    uint32_t processor_index) {
+  return IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+}
+
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
 #if defined(IREE_TASK_CPUINFO_DISABLED)
 
 iree_host_size_t iree_task_topology_query_node_count(void) { return 1; }
@@ -47,7 +84,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
     iree_task_topology_t* out_topology) {
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (cpu_count > IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
                             " provided for a max capacity of %zu)",
@@ -64,6 +101,8 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
     iree_task_topology_group_t* group = &out_topology->groups[i];
     iree_task_topology_group_initialize(i, group);
     group->processor_index = cpu_ids[i];
+    group->node_id =
+        iree_task_topology_query_processor_memory_node(cpu_ids[i]);
 
     // NOTE: without cpuinfo we can't get cache sizes so we just guess some
     // conservative values.
@@ -182,6 +221,8 @@ static void iree_task_topology_group_initialize_from_processor(
   out_group->processor_index =
       processor->core->processor_start + processor->smt_id;
 #endif  // __linux__
+  out_group->node_id =
+      iree_task_topology_query_processor_memory_node(out_group->processor_index);
   out_group->caches.l1_data =
       processor->cache.l1d ? processor->cache.l1d->size : 0;
   out_group->caches.l2_data =
@@ -206,33 +247,22 @@ static void iree_task_topology_group_initialize_from_core(
                                                      out_group);
 }
 
-// Returns a bitset with all *processors* that share the same |cache|.
-static uint64_t iree_task_topology_calculate_cache_bits(
-    const struct cpuinfo_cache* cache) {
-  if (!cache) return 0;
-  uint64_t mask = 0;
-  for (uint32_t processor_i = 0; processor_i < cache->processor_count;
-       ++processor_i) {
-    uint32_t i = cache->processor_start + processor_i;
-    if (i < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
-      mask |= 1ull << i;
-    }
-  }
-  return mask;
+// Returns true if |cache| is present and shared by |a| and |b|.
+static bool iree_task_topology_is_cache_shared(
+    const struct cpuinfo_cache* a_cache, const struct cpuinfo_cache* b_cache) {
+  return a_cache && a_cache == b_cache;
 }
 
-// Constructs a constructive sharing mask for all *processors* that share the
-// same cache as the specified |processor|.
-static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
-    const struct cpuinfo_processor* processor) {
-  uint64_t mask = 0;
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
+// Returns true if processors |a| and |b| share a cache that we consider for
+// constructive sharing.
+static bool iree_task_topology_processors_constructively_share(
+    const struct cpuinfo_processor* a, const struct cpuinfo_processor* b) {
   // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
   // info purely for distribution and focus the group mask on lower-latency
   // caches?
-  return mask;
+  return iree_task_topology_is_cache_shared(a->cache.l1i, b->cache.l1i) ||
+         iree_task_topology_is_cache_shared(a->cache.l1d, b->cache.l1d) ||
+         iree_task_topology_is_cache_shared(a->cache.l2, b->cache.l2);
 }
 
 iree_status_t iree_task_topology_fixup_constructive_sharing_masks(
@@ -242,22 +272,23 @@ iree_status_t iree_task_topology_fixup_constructive_sharing_masks(
     return iree_ok_status();
   }
 
-  // O(n^2), but n is always <= 64 (and often <= 8).
+  // O(n^2), but n is always <= IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (and often
+  // <= 8). cpuinfo deduplicates caches so pointer equality is sufficient to
+  // determine whether two processors share one.
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
+    const struct cpuinfo_processor* processor =
+        cpuinfo_get_processor(group->processor_index);
 
-    // Compute the processors that we can constructively share with.
-    uint64_t constructive_sharing_mask =
-        iree_task_topology_calculate_constructive_sharing_mask(
-            cpuinfo_get_processor(group->processor_index));
-
-    iree_task_topology_group_mask_t group_mask = 0;
+    iree_task_topology_group_mask_t group_mask;
+    iree_task_worker_set_clear(&group_mask);
     for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
       const iree_task_topology_group_t* other_group = &topology->groups[j];
-      uint64_t group_processor_bits =
-          iree_math_rotl_u64(1ull, other_group->processor_index);
-      if (constructive_sharing_mask & group_processor_bits) {
-        group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
+      const struct cpuinfo_processor* other_processor =
+          cpuinfo_get_processor(other_group->processor_index);
+      if (iree_task_topology_processors_constructively_share(
+              processor, other_processor)) {
+        iree_task_worker_set_insert(&group_mask, other_group->group_index);
       }
     }
 
@@ -278,7 +309,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
 
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (cpu_count > IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
                             " provided for a max capacity of %zu)",
@@ -68,6 +68,12 @@ iree_task_topology_node_id_t iree_task_topology_query_current_node(void) {
   return (iree_task_topology_node_id_t)0;
 }
 
+iree_task_topology_node_id_t iree_task_topology_query_processor_memory_node(
+    uint32_t processor_index) {
+  // Apple platforms have unified memory and no memory placement APIs.
+  return IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+}
+
 //===----------------------------------------------------------------------===//
 // Topology initialization helpers
 //===----------------------------------------------------------------------===//
@@ -112,7 +112,36 @@ TEST(TopologyTest, FromGroupCount) {
     const iree_task_topology_group_t* group =
         iree_task_topology_get_group(&topology, i);
     EXPECT_EQ(i, group->group_index);
+    EXPECT_EQ(IREE_TASK_TOPOLOGY_NODE_ID_ANY, group->node_id);
   }
+  EXPECT_EQ(IREE_TASK_TOPOLOGY_NODE_ID_ANY,
+            iree_task_topology_memory_node(&topology));
+
+  iree_task_topology_deinitialize(&topology);
+}
+
+TEST(TopologyTest, MemoryNode) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  EXPECT_EQ(IREE_TASK_TOPOLOGY_NODE_ID_ANY,
+            iree_task_topology_memory_node(&topology));
+
+  // All groups on the same node.
+  for (iree_host_size_t i = 0; i < 4; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    group.node_id = 1;
+    IREE_ASSERT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+  EXPECT_EQ(1, iree_task_topology_memory_node(&topology));
+
+  // Groups spanning nodes have no single memory node.
+  iree_task_topology_group_t group;
+  iree_task_topology_group_initialize(4, &group);
+  group.node_id = 0;
+  IREE_ASSERT_OK(iree_task_topology_push_group(&topology, &group));
+  EXPECT_EQ(IREE_TASK_TOPOLOGY_NODE_ID_ANY,
+            iree_task_topology_memory_node(&topology));
 
   iree_task_topology_deinitialize(&topology);
 }
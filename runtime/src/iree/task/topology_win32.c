@@ -28,6 +28,36 @@ iree_task_topology_node_id_t iree_task_topology_query_current_node(void) {
   return (iree_task_topology_node_id_t)node_number;
 }
 
+// Returns the NUMA node of the processor |number| within processor |group|.
+static iree_task_topology_node_id_t
+iree_task_topology_query_processor_number_node(WORD group, BYTE number) {
+  PROCESSOR_NUMBER processor_number;
+  memset(&processor_number, 0, sizeof(processor_number));
+  processor_number.Group = group;
+  processor_number.Number = number;
+  USHORT node_number = 0;
+  if (!GetNumaProcessorNodeEx(&processor_number, &node_number) ||
+      node_number == (USHORT)0xFFFF) {
+    return IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+  }
+  return (iree_task_topology_node_id_t)node_number;
+}
+
+iree_task_topology_node_id_t iree_task_topology_query_processor_memory_node(
+    uint32_t processor_index) {
+  // Processor indices are flattened across all active processor groups.
+  WORD processor_group_count = GetActiveProcessorGroupCount();
+  for (WORD group = 0; group < processor_group_count; ++group) {
+    DWORD group_processor_count = GetActiveProcessorCount(group);
+    if (processor_index < group_processor_count) {
+      return iree_task_topology_query_processor_number_node(
+          group, (BYTE)processor_index);
+    }
+    processor_index -= group_processor_count;
+  }
+  return IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+}
+
 //===----------------------------------------------------------------------===//
 // Topology initialization helpers
 //===----------------------------------------------------------------------===//
@@ -111,7 +141,8 @@ static void iree_task_topology_assign_constructive_sharing(
         iree_task_topology_group_t* other = &topology->groups[group_j];
         if (other->ideal_thread_affinity.group == group_mask.Group &&
             (group_mask.Mask & (1ull << other->ideal_thread_affinity.id))) {
-          group->constructive_sharing_mask |= 1ull << group_j;
+          iree_task_worker_set_insert(&group->constructive_sharing_mask,
+                                      group_j);
         }
       }
     }
@@ -201,7 +232,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
     iree_task_topology_t* out_topology) {
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (cpu_count > IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
                             " provided for a max capacity of %zu)",
@@ -294,11 +325,12 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
       iree_host_size_t global_processor_index = global_processor_count++;
       if (included_processors[global_processor_index]) {
         // Setup the group for the processor.
-        uint8_t group_index = (uint8_t)out_topology->group_count++;
+        uint16_t group_index = (uint16_t)out_topology->group_count++;
         iree_task_topology_group_t* group = &out_topology->groups[group_index];
         iree_task_topology_group_initialize(group_index, group);
         group->processor_index = (uint32_t)global_processor_index;
-        group->constructive_sharing_mask = 0;  // set below
+        iree_task_worker_set_clear(
+            &group->constructive_sharing_mask);  // set below
 
         // Pin group to the processor.
         iree_thread_affinity_t* affinity = &group->ideal_thread_affinity;
@@ -307,6 +339,8 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
         affinity->smt = (p->Processor.Flags & LTP_PC_SMT) == LTP_PC_SMT;
         affinity->group = p->Processor.GroupMask[0].Group;
         affinity->id = group_offset + bit_offset;
+        group->node_id = iree_task_topology_query_processor_number_node(
+            (WORD)affinity->group, (BYTE)affinity->id);
       }
       group_offset += bit_offset + 1;
       if (out_topology->group_count >= cpu_count) break;
@@ -538,13 +572,17 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
     }
     ++used_core_index;
 
-    uint8_t group_index = (uint8_t)out_topology->group_count++;
+    uint16_t group_index = (uint16_t)out_topology->group_count++;
     iree_task_topology_group_t* group = &out_topology->groups[group_index];
     iree_task_topology_group_initialize(group_index, group);
     group->processor_index = (uint32_t)adjusted_core_index;
-    group->constructive_sharing_mask = 0;  // set below
+    iree_task_worker_set_clear(
+        &group->constructive_sharing_mask);  // set below
     iree_task_topology_set_affinity_from_processor(
         core, &group->ideal_thread_affinity);
+    group->node_id = iree_task_topology_query_processor_number_node(
+        (WORD)group->ideal_thread_affinity.group,
+        (BYTE)group->ideal_thread_affinity.id);
   }
 
   // Assign constructive sharing masks to each topology group.
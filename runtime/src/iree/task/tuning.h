@@ -12,10 +12,14 @@ extern "C" {
 #endif  // __cplusplus
 
 // Maximum number of workers that an executor can manage.
-// A 64 worker hard limit is based on us using uint64_t as a bitmask to select
-// workers. It's easy to go smaller (just use fewer bits) if it's known that
-// only <64 will ever be used (such as for devices with 2 cores).
-#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (64)
+// Workers are tracked in multi-word iree_task_worker_set_t bitsets sized to
+// this value and tasks select workers by cluster with a 64-bit affinity set
+// (see affinity_set.h). Each additional 64 workers adds one word to each of the
+// executor worker sets and grows iree_task_topology_t so it's worth reducing
+// this on devices known to have few cores (for example 8 on most phones).
+#if !defined(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT)
+#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (256)
+#endif  // !IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
 
 // Initial number of shard tasks that are allocated in the executor pool.
 // Increasing this number will decrease initial allocation storms in cases of
@@ -46,6 +50,28 @@ extern "C" {
 // sources.
 #define IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS (64 - 1)
 
+// Maximum amount of time a thread donated to a threadless executor will wait on
+// its wait source before checking whether it can take over pumping the
+// executor. Only used by donated threads contending with the one currently
+// pumping or when the wait source cannot be exported to a wait handle; the
+// pumping thread otherwise blocks until work is posted or the wait resolves.
+#define IREE_TASK_EXECUTOR_DONATION_POLL_INTERVAL_NS (1 /*ms*/ * 1000000)
+
+// Minimum duration a worker will spin for after a short park indicates that
+// spinning would have avoided the wake. Workers whose adaptive spin duration
+// has decayed to zero use this to start spinning again.
+#define IREE_TASK_WORKER_MIN_SPIN_NS (2 /*us*/ * 1000)
+
+// Maximum time between two polls of a spinning worker before it assumes it was
+// descheduled. When the system is oversubscribed spinning workers steal time
+// from the threads that would produce their work and they back off instead.
+#define IREE_TASK_WORKER_SPIN_PREEMPTION_NS (50 /*us*/ * 1000)
+
+// Maximum exponent of the number of parks a worker skips spinning for after it
+// was descheduled while spinning. Each consecutive preemption doubles the
+// number of parks (up to 2^N) until spinning succeeds again.
+#define IREE_TASK_WORKER_MAX_SPIN_BACKOFF_SHIFT 10
+
 // Amount of time that can remain in a delay task while still retiring.
 // This prevents additional system sleeps when the remaining time before the
 // deadline is less than the granularity the system is likely able to sleep for.
@@ -77,8 +103,7 @@ extern "C" {
 // In real-time systems too few tasks is better (slightly more work for much
 // lower variance in execution) while in batch mode systems too many tasks is
 // better (as latencies don't matter so long as throughput is maximized).
-#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
-  IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT (64)
 
 // Number of tiles that will be batched into a single reservation from the grid.
 // This is a maximum; if there are fewer tiles that would otherwise allow for
@@ -95,10 +120,16 @@ extern "C" {
 #define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
 
 // Whether to enable per-tile colors for each tile tracing zone based on the
-// tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
-// TODO(#4017): make per-tile color tracing fast enough to always have on.
+// tile grid xyz. Colors are computed with a handful of integer operations per
+// tile and can be disabled to shave the last bit of tracing overhead.
 #define IREE_TASK_TRACING_PER_TILE_COLORS 1
 
+// Default number of dispatch shard records retained per worker for
+// iree_task_executor_drain_dispatch_records. Records are only produced when
+// IREE_STATISTICS_ENABLE is set and the oldest undrained records are kept when
+// the ring is full (newer records are dropped and counted).
+#define IREE_TASK_WORKER_DEFAULT_DISPATCH_RECORD_CAPACITY (256)
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -25,12 +25,13 @@ iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
     iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
+    iree_byte_span_t record_storage, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   out_worker->executor = executor;
   out_worker->worker_index = executor->worker_base_index + worker_index;
-  out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
+  out_worker->local_worker_index = worker_index;
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
@@ -39,18 +40,44 @@ iree_status_t iree_task_worker_initialize(
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
   out_worker->local_memory = local_memory;
+  out_worker->spin_ns = executor->worker_spin_ns;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
+#if IREE_STATISTICS_ENABLE
+  // The storage may be padded beyond the requested power-of-two capacity so we
+  // round down to keep the ring indexable with a mask.
+  uint32_t record_capacity = (uint32_t)(record_storage.data_length /
+                                        sizeof(iree_task_dispatch_record_t));
+  if (record_capacity) {
+    record_capacity = 1u << (31 - iree_math_count_leading_zeros_u32(
+                                      record_capacity));
+  }
+  out_worker->record_ring.records =
+      (iree_task_dispatch_record_t*)record_storage.data;
+  out_worker->record_ring.capacity = record_capacity;
+#endif  // IREE_STATISTICS_ENABLE
 
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
   iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
   iree_task_queue_initialize(&out_worker->local_task_queue);
+  iree_atomic_store_int32(&out_worker->mailbox_priority,
+                          IREE_TASK_PRIORITY_NONE, iree_memory_order_relaxed);
+  if (executor->scheduling_mode != IREE_TASK_SCHEDULING_MODE_FIFO) {
+    iree_task_queue_set_order(&out_worker->local_task_queue,
+                              iree_task_executor_task_less, executor);
+  }
 
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
   iree_atomic_store_int32(&out_worker->state, initial_state,
                           iree_memory_order_release);
 
+  // Threadless executors pump the worker from donated threads.
+  if (executor->threadless) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
   iree_thread_create_params_t thread_params;
   memset(&thread_params, 0, sizeof(thread_params));
   thread_params.name = iree_make_cstring_view(topology_group->name);
@@ -93,7 +120,11 @@ void iree_task_worker_request_exit(iree_task_worker_t* worker) {
   }
 
   // Kick the worker in case it is waiting for work.
-  iree_notification_post(&worker->wake_notification, 1);
+  if (iree_notification_post_deferred(&worker->wake_notification)) {
+    iree_notification_set_wake(
+        &worker->executor->worker_wake_set,
+        iree_notification_set_wake_bit(worker->local_worker_index));
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -121,7 +152,7 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Must have called request_exit/await_exit.
-  IREE_ASSERT_TRUE(iree_task_worker_is_zombie(worker));
+  IREE_ASSERT_TRUE(!worker->thread || iree_task_worker_is_zombie(worker));
 
   iree_thread_release(worker->thread);
   worker->thread = NULL;
@@ -142,10 +173,32 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
 
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list) {
+  // Find the highest priority of the posted tasks prior to handing them off.
+  int32_t max_priority = IREE_TASK_PRIORITY_NONE;
+  if (worker->executor->scheduling_mode != IREE_TASK_SCHEDULING_MODE_FIFO) {
+    for (iree_task_t* task = list->head; task; task = task->next_task) {
+      max_priority = iree_max(max_priority, iree_task_scheduling_priority(task));
+    }
+  }
+
   // Move the list into the mailbox. Note that the mailbox is LIFO and this list
   // is concatenated with its current order preserved (which should be LIFO).
   iree_atomic_task_slist_concat(&worker->mailbox_slist, list->head, list->tail);
   memset(list, 0, sizeof(*list));
+
+  // Raise the mailbox priority such that the worker flushes the mailbox (and
+  // any lower priority shard it is executing yields) before continuing.
+  // relaxed order as priority is only a scheduling hint; the mailbox itself
+  // provides the ordering of the posted tasks.
+  if (max_priority != IREE_TASK_PRIORITY_NONE) {
+    int32_t current_priority = iree_atomic_load_int32(
+        &worker->mailbox_priority, iree_memory_order_relaxed);
+    while (current_priority < max_priority &&
+           !iree_atomic_compare_exchange_weak_int32(
+               &worker->mailbox_priority, &current_priority, max_priority,
+               iree_memory_order_relaxed, iree_memory_order_relaxed)) {
+    }
+  }
 }
 
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
@@ -164,12 +217,103 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
   return NULL;
 }
 
+void iree_task_worker_query_statistics(
+    iree_task_worker_t* worker, iree_task_worker_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+#if IREE_STATISTICS_ENABLE
+  iree_task_worker_counters_t* counters = &worker->counters;
+  out_statistics->task_count = (uint64_t)iree_atomic_load_int64(
+      &counters->task_count, iree_memory_order_relaxed);
+  out_statistics->shard_count = (uint64_t)iree_atomic_load_int64(
+      &counters->shard_count, iree_memory_order_relaxed);
+  out_statistics->tile_count = (uint64_t)iree_atomic_load_int64(
+      &counters->tile_count, iree_memory_order_relaxed);
+  out_statistics->steal_count = (uint64_t)iree_atomic_load_int64(
+      &counters->steal_count, iree_memory_order_relaxed);
+  out_statistics->busy_time_ns = (iree_duration_t)iree_atomic_load_int64(
+      &counters->busy_time_ns, iree_memory_order_relaxed);
+  out_statistics->dropped_record_count = (uint64_t)iree_atomic_load_int64(
+      &counters->dropped_record_count, iree_memory_order_relaxed);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+iree_host_size_t iree_task_worker_drain_records(
+    iree_task_worker_t* worker, iree_host_size_t capacity,
+    iree_task_dispatch_record_t* out_records) {
+#if IREE_STATISTICS_ENABLE
+  iree_task_worker_record_ring_t* ring = &worker->record_ring;
+  if (!ring->capacity) return 0;
+  // Acquire pairs with the release by the worker after writing the records.
+  int64_t read_index =
+      iree_atomic_load_int64(&ring->read_index, iree_memory_order_relaxed);
+  int64_t write_index =
+      iree_atomic_load_int64(&ring->write_index, iree_memory_order_acquire);
+  iree_host_size_t count =
+      iree_min((iree_host_size_t)(write_index - read_index), capacity);
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    out_records[i] =
+        ring->records[(read_index + i) & (int64_t)(ring->capacity - 1)];
+  }
+  // Release such that the worker does not overwrite the records until we have
+  // finished copying them out.
+  iree_atomic_store_int64(&ring->read_index, read_index + (int64_t)count,
+                          iree_memory_order_release);
+  return count;
+#else
+  return 0;
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+#if IREE_STATISTICS_ENABLE
+
+// Adds |delta| to a worker counter. Only the worker thread writes its counters
+// so a plain load/store pair avoids the cost of an atomic read-modify-write.
+static inline void iree_task_worker_counter_add(iree_atomic_int64_t* counter,
+                                                int64_t delta) {
+  iree_atomic_store_int64(
+      counter,
+      iree_atomic_load_int64(counter, iree_memory_order_relaxed) + delta,
+      iree_memory_order_relaxed);
+}
+
+// Appends |record| to the worker record ring or drops it if the ring is full.
+// Never blocks: telemetry must not stall the worker.
+static void iree_task_worker_append_record(
+    iree_task_worker_t* worker, const iree_task_dispatch_record_t* record) {
+  iree_task_worker_record_ring_t* ring = &worker->record_ring;
+  if (!ring->capacity) return;
+  int64_t write_index =
+      iree_atomic_load_int64(&ring->write_index, iree_memory_order_relaxed);
+  int64_t read_index =
+      iree_atomic_load_int64(&ring->read_index, iree_memory_order_acquire);
+  if (write_index - read_index >= (int64_t)ring->capacity) {
+    iree_task_worker_counter_add(&worker->counters.dropped_record_count, 1);
+    return;
+  }
+  ring->records[write_index & (int64_t)(ring->capacity - 1)] = *record;
+  iree_atomic_store_int64(&ring->write_index, write_index + 1,
+                          iree_memory_order_release);
+}
+
+#endif  // IREE_STATISTICS_ENABLE
+
 // Executes a task on a worker.
 // Only task types that are scheduled to workers are handled; all others must be
 // handled by the coordinator during scheduling.
 static void iree_task_worker_execute(
     iree_task_worker_t* worker, iree_task_t* task,
     iree_task_submission_t* pending_submission) {
+#if IREE_STATISTICS_ENABLE
+  iree_task_dispatch_record_t record = {
+      .start_time_ns = iree_time_now(),
+      .worker_index = (uint32_t)worker->worker_index,
+  };
+  iree_task_dispatch_record_t* shard_record = &record;
+  const bool is_shard = task->type == IREE_TASK_TYPE_DISPATCH_SHARD;
+#else
+  iree_task_dispatch_record_t* shard_record = NULL;
+#endif  // IREE_STATISTICS_ENABLE
+
   // Execute the task and resolve the task and gather any tasks that are now
   // ready for submission to the executor. They'll be scheduled the next time
   // the coordinator runs.
@@ -177,16 +321,25 @@ static void iree_task_worker_execute(
   // TODO(benvanik): think a bit more about this timing; this ensures we have
   // BFS behavior at the cost of the additional merge overhead - it's probably
   // worth it?
-  // TODO(benvanik): handle partial tasks and re-queuing.
   switch (task->type) {
     case IREE_TASK_TYPE_CALL: {
       iree_task_call_execute((iree_task_call_t*)task, pending_submission);
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
-      iree_task_dispatch_shard_execute(
-          (iree_task_dispatch_shard_t*)task, worker->processor_id,
-          worker->worker_index, worker->local_memory, pending_submission);
+      // Shards may yield to higher priority work posted to this worker. When
+      // they do they are requeued and resumed after the mailbox is flushed.
+      const iree_atomic_int32_t* yield_priority =
+          (worker->executor->scheduling_mode &
+           IREE_TASK_SCHEDULING_MODE_PRIORITY)
+              ? &worker->mailbox_priority
+              : NULL;
+      if (!iree_task_dispatch_shard_execute(
+              (iree_task_dispatch_shard_t*)task, worker->processor_id,
+              worker->worker_index, worker->local_memory, yield_priority,
+              shard_record, pending_submission)) {
+        iree_task_queue_push_front(&worker->local_task_queue, task);
+      }
       break;
     }
     default:
@@ -196,6 +349,21 @@ static void iree_task_worker_execute(
 
   // NOTE: task is invalidated above and must not be used!
   task = NULL;
+
+#if IREE_STATISTICS_ENABLE
+  iree_task_worker_counters_t* counters = &worker->counters;
+  if (is_shard) {
+    // Shards record their own end time prior to retiring.
+    iree_task_worker_append_record(worker, &record);
+    iree_task_worker_counter_add(&counters->shard_count, 1);
+    iree_task_worker_counter_add(&counters->tile_count, record.tile_count);
+  } else {
+    record.end_time_ns = iree_time_now();
+  }
+  iree_task_worker_counter_add(&counters->task_count, 1);
+  iree_task_worker_counter_add(&counters->busy_time_ns,
+                               record.end_time_ns - record.start_time_ns);
+#endif  // IREE_STATISTICS_ENABLE
 }
 
 // Pumps the worker thread once, processing a single task.
@@ -205,10 +373,25 @@ static bool iree_task_worker_pump_once(
     iree_task_worker_t* worker, iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // If prioritized work has been posted to the mailbox since we last looked
+  // then flush it into the local queue first. The ordered queue will merge it
+  // in such that it is processed ahead of any lower priority work.
+  iree_task_t* task = NULL;
+  if (worker->executor->scheduling_mode != IREE_TASK_SCHEDULING_MODE_FIFO &&
+      iree_atomic_load_int32(&worker->mailbox_priority,
+                             iree_memory_order_relaxed) !=
+          IREE_TASK_PRIORITY_NONE) {
+    iree_atomic_exchange_int32(&worker->mailbox_priority,
+                               IREE_TASK_PRIORITY_NONE,
+                               iree_memory_order_relaxed);
+    task = iree_task_queue_flush_from_lifo_slist(&worker->local_task_queue,
+                                                 &worker->mailbox_slist);
+  }
+
   // Check the local work queue for any work we know we should start
   // processing immediately. Other workers may try to steal some of this work
   // if we take too long.
-  iree_task_t* task = iree_task_queue_pop_front(&worker->local_task_queue);
+  if (!task) task = iree_task_queue_pop_front(&worker->local_task_queue);
 
   // Check the mailbox to see if we have incoming work that has been posted.
   // We try to greedily move it to our local work list so that we can work
@@ -231,9 +414,17 @@ static bool iree_task_worker_pump_once(
   // the first task in the queue is popped off and returned.
   if (!task) {
     task = iree_task_executor_try_steal_task(
-        worker->executor, worker->constructive_sharing_mask,
+        worker->executor, &worker->constructive_sharing_mask,
         worker->max_theft_attempts, &worker->theft_prng,
         &worker->local_task_queue);
+#if IREE_STATISTICS_ENABLE
+    if (task) {
+      iree_task_worker_counter_add(&worker->counters.steal_count, 1);
+      if (task->type == IREE_TASK_TYPE_DISPATCH_SHARD) {
+        task->flags |= IREE_TASK_FLAG_DISPATCH_SHARD_STOLEN;
+      }
+    }
+#endif  // IREE_STATISTICS_ENABLE
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -251,11 +442,150 @@ static bool iree_task_worker_pump_once(
   return true;  // try again
 }
 
+// Returns true if any task readied in |pending_submission| has a higher
+// scheduling priority than the next task in the local queue of |worker| and
+// would otherwise wait behind it. The ready list is unordered and the
+// priorities are refreshed as they would be when the tasks are issued.
+static bool iree_task_worker_has_preempting_tasks(
+    iree_task_worker_t* worker, iree_task_submission_t* pending_submission) {
+  if (iree_task_list_is_empty(&pending_submission->ready_list)) return false;
+  const int32_t next_priority =
+      iree_task_queue_front_priority(&worker->local_task_queue);
+  for (iree_task_t* task = pending_submission->ready_list.head; task;
+       task = task->next_task) {
+    iree_task_scheduling_refresh_priority(task);
+    if (iree_task_scheduling_priority(task) > next_priority) return true;
+  }
+  return false;
+}
+
 // Updates the cached processor ID field in the worker.
 static void iree_task_worker_update_processor_id(iree_task_worker_t* worker) {
   iree_cpu_requery_processor_id(&worker->processor_tag, &worker->processor_id);
 }
 
+bool iree_task_worker_pump_caller(iree_task_worker_t* worker) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // We don't know what FPU state the donated thread has been left in and need
+  // to match what the threaded workers use.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+
+  // The caller may have migrated since the last time it was donated.
+  iree_task_worker_update_processor_id(worker);
+
+  iree_task_submission_t pending_submission;
+  iree_task_submission_initialize(&pending_submission);
+  bool did_work = false;
+  while (iree_task_worker_pump_once(worker, &pending_submission)) {
+    did_work = true;
+  }
+  if (!iree_task_submission_is_empty(&pending_submission)) {
+    iree_task_executor_merge_submission(worker->executor, &pending_submission);
+  }
+
+  iree_fpu_state_pop(fpu_state);
+
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, did_work ? 1 : 0);
+  IREE_TRACE_ZONE_END(z0);
+  return did_work;
+}
+
+// Backs off spinning when the system appears to be oversubscribed: spinning
+// stops for an exponentially increasing number of parks so that the threads
+// the worker is competing with (likely including those producing its work)
+// can make progress.
+static void iree_task_worker_back_off_spin(iree_task_worker_t* worker) {
+  worker->spin_ns /= 4;
+  worker->spin_backoff_shift =
+      iree_min(worker->spin_backoff_shift + 1,
+               (uint32_t)IREE_TASK_WORKER_MAX_SPIN_BACKOFF_SHIFT);
+  worker->spin_backoff_parks = 1u << worker->spin_backoff_shift;
+}
+
+// Spins for up to the adaptive spin duration of |worker| waiting for its wake
+// notification to be posted after |wait_token| was acquired. The wait must have
+// been cancelled such that posters don't need to wake the worker from the
+// kernel while it spins.
+// Returns true if the notification was posted while spinning.
+static bool iree_task_worker_spin(iree_task_worker_t* worker,
+                                  iree_wait_token_t wait_token) {
+  const iree_duration_t spin_ns = worker->spin_ns;
+  if (spin_ns <= 0) return false;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, spin_ns);
+
+  // We compute an absolute deadline as we may be descheduled while spinning.
+  const iree_time_t start_ns = iree_time_now();
+  const iree_time_t spin_deadline_ns = start_ns + spin_ns;
+  iree_time_t last_ns = start_ns;
+  bool posted = false;
+  bool preempted = false;
+  do {
+    // Try to be nice to the processor when using SMT.
+    iree_processor_yield();
+    if (iree_notification_has_posted(&worker->wake_notification, wait_token)) {
+      posted = true;
+      break;
+    }
+    // If a large amount of time passed between polls we were likely
+    // descheduled: other threads want the processor and spinning is only
+    // making things worse for them (and likely the producers of our work).
+    const iree_time_t now_ns = iree_time_now();
+    if (now_ns - last_ns > IREE_TASK_WORKER_SPIN_PREEMPTION_NS) {
+      preempted = true;
+      break;
+    }
+    last_ns = now_ns;
+  } while (last_ns < spin_deadline_ns);
+
+  if (posted) {
+    // Spinning avoided a park; spin longer next time (within the budget) as
+    // work is arriving at a rate where it's paying off.
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "posted");
+    worker->spin_ns = iree_min(worker->executor->worker_spin_ns, spin_ns * 2);
+    worker->spin_backoff_shift = 0;
+  } else if (preempted) {
+    // Descheduled while spinning; the system is oversubscribed.
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "preempted");
+    iree_task_worker_back_off_spin(worker);
+  } else {
+    // Spun out; the park that follows determines how we adapt.
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "expired");
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return posted;
+}
+
+// Adapts the spin duration of |worker| after it has parked for |park_ns|.
+// Short parks indicate that spinning a bit longer would have avoided the park
+// while long parks indicate that the time spent spinning was wasted.
+static void iree_task_worker_adapt_spin_after_park(iree_task_worker_t* worker,
+                                                   iree_duration_t park_ns) {
+  if (worker->spin_backoff_parks > 0) {
+    // Backing off due to oversubscription; short parks are expected.
+    --worker->spin_backoff_parks;
+    return;
+  }
+  const iree_duration_t budget_ns = worker->executor->worker_spin_ns;
+  if (park_ns < budget_ns && worker->spin_ns >= budget_ns) {
+    // Spinning for the full budget missed work that arrived shortly after.
+    // When work arrives at a fixed rate growing the spin converts these into
+    // spin hits before reaching the budget; if instead work keeps arriving
+    // just after we give up it's likely that our spinning was delaying the
+    // producer (there are more runnable threads than processors).
+    iree_task_worker_back_off_spin(worker);
+  } else if (park_ns < budget_ns) {
+    const iree_duration_t spin_ns = iree_max(
+        worker->spin_ns * 2, (iree_duration_t)IREE_TASK_WORKER_MIN_SPIN_NS);
+    worker->spin_ns = iree_min(budget_ns, spin_ns);
+  } else {
+    worker->spin_ns /= 2;
+  }
+}
+
 // Alternates between pumping ready tasks in the worker queue and waiting
 // for more tasks to arrive. Only returns when the worker has been asked by
 // the executor to exit.
@@ -265,6 +595,10 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
   // be able to process it with the proper processor ID immediately.
   iree_task_worker_update_processor_id(worker);
 
+  // Set after spinning fails to find work such that the next time the worker
+  // runs out of work it parks immediately.
+  bool should_park = false;
+
   // Pump the thread loop to process more tasks.
   while (true) {
     // If we fail to find any work to do we'll wait at the end of this loop.
@@ -276,18 +610,16 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
         iree_notification_prepare_wait(&worker->wake_notification);
 
     // The masks are accessed with 'relaxed' order because they are just hints.
-    iree_task_affinity_set_t old_idle_mask =
-        iree_atomic_task_affinity_set_fetch_and(
-            &worker->executor->worker_idle_mask, ~worker->worker_bit,
-            iree_memory_order_relaxed);
-    (void)old_idle_mask;
+    iree_atomic_task_worker_set_erase(&worker->executor->worker_idle_mask,
+                                      worker->local_worker_index,
+                                      iree_memory_order_relaxed);
     IREE_TRACE_PLOT_VALUE_F32(
         worker->executor->trace_name,
-        old_idle_mask
-            ? (100.0f -
-               100.0f * (iree_task_affinity_set_count_ones(old_idle_mask) - 1) /
-                   (float)worker->executor->worker_count)
-            : 100.0f);
+        100.0f - 100.0f *
+                     iree_atomic_task_worker_set_count_ones(
+                         &worker->executor->worker_idle_mask,
+                         iree_memory_order_relaxed) /
+                     (float)worker->executor->worker_count);
 
     // Check state to see if we've been asked to exit.
     if (iree_atomic_load_int32(&worker->state, iree_memory_order_acquire) ==
@@ -306,6 +638,20 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
 
     while (iree_task_worker_pump_once(worker, &pending_submission)) {
       // All work done ^, which will return false when the worker should wait.
+      should_park = false;
+
+      // When prioritizing work we can't hold on to readied tasks until our
+      // local queue drains if they are of higher priority than the work
+      // remaining in it. Publish them and coordinate immediately so they can
+      // be scheduled (and preempt lower priority shards) without delay.
+      // Everything else is published in batches as in FIFO mode.
+      if ((worker->executor->scheduling_mode &
+           IREE_TASK_SCHEDULING_MODE_PRIORITY) &&
+          iree_task_worker_has_preempting_tasks(worker, &pending_submission)) {
+        iree_task_executor_merge_submission(worker->executor,
+                                            &pending_submission);
+        iree_task_executor_coordinate(worker->executor, worker);
+      }
     }
 
     bool schedule_dirty = false;
@@ -318,14 +664,15 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     // We've finished all the work we have scheduled so set our idle flag.
     // This ensures that if any other thread comes in and wants to give us
     // work we will properly coordinate/wake below.
-    old_idle_mask = iree_atomic_task_affinity_set_fetch_or(
-        &worker->executor->worker_idle_mask, worker->worker_bit,
-        iree_memory_order_relaxed);
-    (void)old_idle_mask;
+    iree_atomic_task_worker_set_insert(&worker->executor->worker_idle_mask,
+                                       worker->local_worker_index,
+                                       iree_memory_order_relaxed);
     IREE_TRACE_PLOT_VALUE_F32(
         worker->executor->trace_name,
         100.0f - 100.0f *
-                     (iree_task_affinity_set_count_ones(old_idle_mask) + 1) /
+                     iree_atomic_task_worker_set_count_ones(
+                         &worker->executor->worker_idle_mask,
+                         iree_memory_order_relaxed) /
                      (float)worker->executor->worker_count);
 
     // When we encounter a complete lack of work we can self-nominate to check
@@ -345,15 +692,32 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
         !iree_task_queue_is_empty(&worker->local_task_queue)) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
+    } else if (!should_park && worker->spin_ns > 0 &&
+               !worker->spin_backoff_parks) {
+      // Spin for a bit in case more work arrives soon (such as the next
+      // dispatch in a sequence). We cancel the wait so that posters don't need
+      // to wake us from the kernel and then loop around to either process the
+      // work that arrived or park (after checking for work one last time).
+      iree_notification_cancel_wait(&worker->wake_notification);
+      should_park = !iree_task_worker_spin(worker, wait_token);
     } else {
-      // Spin/wait in the kernel. We don't care if the condition fails as we're
+      // Wait in the kernel. We don't care if the condition fails as we're
       // just using it as a pulse.
       IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
                                   "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
+      const bool adapt_spin = worker->executor->worker_spin_ns > 0;
+      const iree_time_t park_start_ns = adapt_spin ? iree_time_now() : 0;
+      iree_notification_commit_wait_in_set(
           &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
+          &worker->executor->worker_wake_set,
+          iree_notification_set_wake_bit(worker->local_worker_index),
+          /*spin_ns=*/IREE_DURATION_ZERO,
           /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      if (adapt_spin) {
+        iree_task_worker_adapt_spin_after_park(
+            worker, iree_time_now() - park_start_ns);
+      }
+      should_park = false;
       IREE_TRACE_ZONE_END(z_wait);
 
       // Woke from a wait - query the processor ID in case we migrated during
@@ -47,6 +47,35 @@ typedef enum iree_task_worker_state_e {
   IREE_TASK_WORKER_STATE_ZOMBIE = 2,
 } iree_task_worker_state_t;
 
+#if IREE_STATISTICS_ENABLE
+
+// Cumulative counters of the work performed by a worker.
+// Only written by the thread pumping the worker and read with relaxed atomics
+// from any thread by iree_task_executor_query_worker_statistics.
+typedef struct iree_task_worker_counters_t {
+  iree_atomic_int64_t task_count;
+  iree_atomic_int64_t shard_count;
+  iree_atomic_int64_t tile_count;
+  iree_atomic_int64_t steal_count;
+  iree_atomic_int64_t busy_time_ns;
+  iree_atomic_int64_t dropped_record_count;
+} iree_task_worker_counters_t;
+
+// Lock-free single-producer single-consumer ring of dispatch shard records.
+// The worker thread is the only producer and appends records without blocking
+// (dropping them if the ring is full). Consumers are serialized by the
+// executor when draining.
+typedef struct iree_task_worker_record_ring_t {
+  // Power-of-two sized record storage or NULL if records are disabled.
+  iree_task_dispatch_record_t* records;
+  uint32_t capacity;
+  // Monotonically increasing indices; the ring holds [read_index, write_index).
+  iree_atomic_int64_t write_index;
+  iree_atomic_int64_t read_index;
+} iree_task_worker_record_ring_t;
+
+#endif  // IREE_STATISTICS_ENABLE
+
 // A worker within the executor pool.
 //
 // NOTE: fields in here are touched from multiple threads with lock-free
@@ -68,6 +97,12 @@ typedef struct iree_task_worker_t {
   //         accessed together.
   iree_atomic_int32_t state;
 
+  // Highest scheduling priority of tasks posted to the mailbox since it was
+  // last flushed or IREE_TASK_PRIORITY_NONE. Only used when the executor has a
+  // non-FIFO scheduling mode to flush newly posted work ahead of the local
+  // queue and preempt lower priority dispatch shards.
+  iree_atomic_int32_t mailbox_priority;
+
   // Notification signaled when the worker should wake (if it is idle).
   // LAYOUT: next to state for similar access patterns; when posting other
   //         threads will touch mailbox_slist and then send a wake
@@ -84,9 +119,9 @@ typedef struct iree_task_worker_t {
   // Globally unique worker index (worker_base_index + local worker_index).
   iree_host_size_t worker_index;
 
-  // Bit the worker represents in the various worker bitsets.
-  // Local to the executor owning the worker.
-  iree_task_affinity_set_t worker_bit;
+  // Executor-local worker index used as the bit the worker represents in the
+  // various executor worker sets.
+  iree_host_size_t local_worker_index;
 
   // Ideal thread affinity for the worker thread.
   iree_thread_affinity_t ideal_thread_affinity;
@@ -96,10 +131,10 @@ typedef struct iree_task_worker_t {
   // some cache levels higher up with these other groups. For example, if the
   // workers in a group all share an L2 cache then the groups indicated here may
   // all share the same L3 cache.
-  iree_task_affinity_set_t constructive_sharing_mask;
+  iree_task_worker_set_t constructive_sharing_mask;
 
   // Maximum number of attempts to make when trying to steal tasks from other
-  // workers. This could be 64 (try stealing from all workers) or just a handful
+  // workers. This could be all workers or just a handful
   // (try stealing from these 3 other cores that share your L3 cache).
   uint32_t max_theft_attempts;
 
@@ -111,6 +146,16 @@ typedef struct iree_task_worker_t {
   // remain valid so that the executor can query its state.
   iree_thread_t* thread;
 
+  // Current adaptive duration the worker spins for before parking. Grows
+  // (up to the executor worker_spin_ns budget) when work arrives while spinning
+  // or shortly after parking and decays when parks are long or the worker is
+  // descheduled while spinning. Only touched by the worker thread.
+  iree_duration_t spin_ns;
+  // Number of upcoming parks that will skip spinning due to oversubscription
+  // and the exponent used to compute it on the next preemption.
+  uint32_t spin_backoff_parks;
+  uint32_t spin_backoff_shift;
+
   // Guess at the current processor ID.
   // This is updated infrequently as it can be semi-expensive to determine
   // (on some platforms at least 1 syscall involved). We always update it upon
@@ -120,12 +165,18 @@ typedef struct iree_task_worker_t {
   // An opaque tag used to reduce the cost of processor ID queries.
   iree_cpu_processor_tag_t processor_tag;
 
+#if IREE_STATISTICS_ENABLE
+  // Counters and records of the work performed by the worker.
+  iree_task_worker_counters_t counters;
+  iree_task_worker_record_ring_t record_ring;
+#endif  // IREE_STATISTICS_ENABLE
+
   // Destructive interference padding between the mailbox and local task queue
   // to ensure that the worker - who is pounding on local_task_queue - doesn't
   // contend with submissions or coordinators dropping new tasks in the mailbox.
   //
   // Today we don't need this, however on 32-bit systems or if we adjust the
-  // size of iree_task_affinity_t/iree_task_affinity_set_t/etc we may need to
+  // size of iree_task_affinity_t/iree_task_worker_set_t/etc we may need to
   // add it back.
   //
   // NOTE: due to the layout requirements of this structure (to avoid cache
@@ -156,11 +207,18 @@ static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
 // tasks. Where supported the worker will be created in a suspended state so
 // that we aren't creating a thundering herd on startup:
 // https://en.wikipedia.org/wiki/Thundering_herd_problem
+//
+// Workers of threadless executors have no thread and are instead pumped by
+// threads donated to the executor with iree_task_worker_pump_caller.
+//
+// |record_storage| is used for the ring of dispatch shard records and must have
+// a power-of-two capacity (or be empty to disable records).
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
     iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
+    iree_byte_span_t record_storage, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker);
 
 // Requests that the worker begin exiting (if it hasn't already).
 // If the worker is actively processing tasks it will wait until it has
@@ -175,7 +233,8 @@ void iree_task_worker_request_exit(iree_task_worker_t* worker);
 void iree_task_worker_await_exit(iree_task_worker_t* worker);
 
 // Deinitializes a worker that has successfully exited.
-// The worker must be in the IREE_TASK_WORKER_STATE_ZOMBIE state.
+// The worker must be in the IREE_TASK_WORKER_STATE_ZOMBIE state unless it has
+// no thread (as with threadless executors).
 //
 // Expected shutdown sequence:
 //  - request_exit on all workers
@@ -190,6 +249,29 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list);
 
+// Pumps a threadless |worker| on the calling thread until it runs out of work.
+// Readied tasks are merged into the executor incoming ready list and the caller
+// must coordinate to have them posted back to the worker.
+// Returns true if any tasks were executed.
+//
+// Must only be called by one thread at a time.
+bool iree_task_worker_pump_caller(iree_task_worker_t* worker);
+
+// Queries the cumulative statistics of |worker|.
+// The counters are sampled independently and may tear.
+//
+// May be called from any thread.
+void iree_task_worker_query_statistics(
+    iree_task_worker_t* worker, iree_task_worker_statistics_t* out_statistics);
+
+// Moves up to |capacity| of the oldest dispatch shard records of |worker| into
+// |out_records| and returns the number moved.
+//
+// May be called from any thread but only one thread at a time.
+iree_host_size_t iree_task_worker_drain_records(
+    iree_task_worker_t* worker, iree_host_size_t capacity,
+    iree_task_dispatch_record_t* out_records);
+
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
 // that were at the tail of the worker FIFO will be moved to the |target_queue|
@@ -44,6 +44,21 @@ IREE_FLAG(
     "        warm-up time and variance as mapped pages are swapped\n"
     "        by the OS.");
 
+IREE_FLAG(
+    bool, module_lazy_verification, false,
+    "Defers verification of bytecode module functions until each is first\n"
+    "called. Reduces startup time of large modules when only a subset of\n"
+    "functions are used; combine with --module_mode=mmap to avoid paging in\n"
+    "the bytecode of functions that are never called.");
+
+IREE_FLAG(
+    string, module_profile_file, "",
+    "Collects function call, block execution, and import time counters for\n"
+    "bytecode modules and writes them to the given file after execution.\n"
+    "The profile can be passed to iree-dump-module --profile_file= to\n"
+    "annotate the module. Requires a runtime built with\n"
+    "IREE_VM_EXECUTION_PROFILING_ENABLE.");
+
 static iree_status_t iree_tooling_load_bytecode_module(
     iree_vm_instance_t* instance, iree_string_view_t path,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
@@ -80,8 +95,15 @@ static iree_status_t iree_tooling_load_bytecode_module(
   // We could sniff the file ID and switch off to other module types.
   // The module takes ownership of the file contents (when successful).
   iree_vm_module_t* module = NULL;
-  iree_status_t status = iree_vm_bytecode_module_create(
-      instance, file_contents->const_buffer,
+  iree_vm_bytecode_module_flags_t module_flags =
+      FLAG_module_lazy_verification
+          ? IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION
+          : IREE_VM_BYTECODE_MODULE_FLAG_NONE;
+  if (strlen(FLAG_module_profile_file) > 0) {
+    module_flags |= IREE_VM_BYTECODE_MODULE_FLAG_PROFILE_EXECUTION;
+  }
+  iree_status_t status = iree_vm_bytecode_module_create_with_flags(
+      instance, module_flags, file_contents->const_buffer,
       iree_file_contents_deallocator(file_contents), host_allocator, &module);
 
   if (iree_status_is_ok(status)) {
@@ -173,6 +195,13 @@ iree_status_t iree_tooling_load_modules_from_flags(
 // HAL execution model management
 //===----------------------------------------------------------------------===//
 
+IREE_FLAG(bool, hal_inline_execution, false,
+          "Allows one-shot command buffers to execute inline as they are "
+          "recorded.\n"
+          "Only valid with a single local-sync device where dispatches can "
+          "run\n"
+          "directly from the VM without command buffer replay.");
+
 static iree_status_t iree_tooling_load_hal_async_module(
     iree_vm_instance_t* instance, iree_string_view_t default_device_uri,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module,
@@ -216,11 +245,35 @@ static iree_status_t iree_tooling_load_hal_async_module(
   iree_hal_allocator_retain(device_allocator);
 
   // Create HAL module wrapping the device created above.
+  iree_status_t status = iree_ok_status();
   iree_hal_module_flags_t flags = IREE_HAL_MODULE_FLAG_NONE;
+  if (FLAG_hal_inline_execution) {
+    // Only local-sync runs all device work on the calling thread in program
+    // order. Other devices (including a single local-task device) may still
+    // have work in flight when a command buffer is recorded.
+    iree_string_view_t device_id = iree_hal_device_id(device);
+    if (device_list->count != 1) {
+      status = iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "--hal_inline_execution requires a single device but %" PRIhsz
+          " were specified",
+          device_list->count);
+    } else if (!iree_string_view_equal(device_id, IREE_SV("local-sync"))) {
+      status = iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "--hal_inline_execution requires a local-sync device but the device "
+          "is '%.*s'",
+          (int)device_id.size, device_id.data);
+    } else {
+      flags |= IREE_HAL_MODULE_FLAG_INLINE_EXECUTION;
+    }
+  }
   iree_vm_module_t* module = NULL;
-  iree_status_t status =
-      iree_hal_module_create(instance, device_list->count, device_list->devices,
-                             flags, host_allocator, &module);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_module_create(instance, device_list->count,
+                                    device_list->devices, flags,
+                                    host_allocator, &module);
+  }
 
   iree_hal_device_list_free(device_list);
 
@@ -656,3 +709,37 @@ iree_status_t iree_tooling_create_context_from_flags(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// Module profiling
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_tooling_write_module_profiles_from_flags(
+    iree_vm_context_t* context, iree_allocator_t host_allocator) {
+  if (strlen(FLAG_module_profile_file) == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, FLAG_module_profile_file);
+
+  // The file is written even if no modules were profiled so that users don't
+  // end up with stale data from previous runs.
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(host_allocator, &builder);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < iree_vm_context_module_count(context) && iree_status_is_ok(status);
+       ++i) {
+    iree_vm_module_t* module = iree_vm_context_module_at(context, i);
+    if (!iree_vm_bytecode_module_has_profile(module)) continue;
+    status = iree_vm_bytecode_module_append_profile(module, &builder);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_file_write_contents(
+        FLAG_module_profile_file,
+        iree_make_const_byte_span(iree_string_builder_buffer(&builder),
+                                  iree_string_builder_size(&builder)));
+  }
+  iree_string_builder_deinitialize(&builder);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
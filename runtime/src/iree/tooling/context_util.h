@@ -102,6 +102,12 @@ iree_status_t iree_tooling_create_context_from_flags(
     iree_hal_device_t** out_device,
     iree_hal_allocator_t** out_device_allocator);
 
+// Writes the execution profiles of all bytecode modules in |context| to the
+// file specified by the --module_profile_file= flag.
+// No-op if the flag was not specified.
+iree_status_t iree_tooling_write_module_profiles_from_flags(
+    iree_vm_context_t* context, iree_allocator_t host_allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -8,7 +8,9 @@
 
 #include "iree/base/internal/file_io.h"
 #include "iree/base/internal/flags.h"
+#include "iree/io/file_handle.h"
 #include "iree/io/formats/parser_registry.h"
+#include "iree/io/parameter_cache.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/parameter_index_provider.h"
 #include "iree/io/scope_map.h"
@@ -20,11 +22,27 @@
 
 IREE_FLAG(
     string, parameter_mode, "mmap",
-    "A parameter I/O mode of ['preload', 'mmap'].\n"
+    "A parameter I/O mode of ['preload', 'mmap', 'lazy', 'file'].\n"
     "  preload: read entire parameter files into wired memory on startup.\n"
     "  mmap: maps the parameter files into discardable memory - can increase\n"
     "        warm-up time and variance as mapped pages are swapped\n"
-    "        by the OS.");
+    "        by the OS.\n"
+    "  lazy: maps the parameter files as with mmap and tracks when each\n"
+    "        parameter is used (when loaded and when its memory is observed\n"
+    "        to be faulted in); the least recently used parameters are\n"
+    "        reclaimed when the measured resident size is over the\n"
+    "        --parameter_residency_budget= size.\n"
+    "  file: reads only the parameter file indices on startup and reads\n"
+    "        parameters from the files as they are used.");
+
+IREE_FLAG(int64_t, parameter_residency_budget, 0,
+          "Maximum bytes of parameter memory kept resident per scope when\n"
+          "using --parameter_mode=lazy or 0 for unlimited.");
+
+IREE_FLAG(int32_t, parameter_residency_trim_interval_ms, 1000,
+          "Interval in milliseconds between background trims of parameter\n"
+          "memory when using --parameter_mode=lazy with a budget or 0 to only\n"
+          "trim when parameters are loaded.");
 
 static void iree_file_contents_release_callback(
     void* user_data, iree_io_file_handle_primitive_t handle_primitive) {
@@ -33,22 +51,35 @@ static void iree_file_contents_release_callback(
 }
 
 // Opens the parameter file at |path| with the mode specified by the
-// --parameter_mode flag and returns its handle.
+// --parameter_mode flag and returns its handle. When |is_cached| the contents
+// are copied into the shared parameter cache instead of being used directly.
 static iree_status_t iree_io_open_parameter_file(
-    iree_string_view_t path, iree_allocator_t host_allocator,
+    iree_string_view_t path, bool is_cached, iree_allocator_t host_allocator,
     iree_io_file_handle_t** out_file_handle) {
   IREE_ASSERT_ARGUMENT(out_file_handle);
   *out_file_handle = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
 
+  // Files are opened directly and only their indices are read up-front.
+  if (strcmp(FLAG_parameter_mode, "file") == 0) {
+    iree_status_t status = iree_io_file_handle_open(
+        IREE_IO_FILE_MODE_READ, path, host_allocator, out_file_handle);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   char path_str[2048] = {0};
   iree_string_view_to_cstring(path, path_str, sizeof(path_str));
   iree_file_read_flags_t read_flags = 0;
-  if (strcmp(FLAG_parameter_mode, "mmap") == 0) {
+  if (strcmp(FLAG_parameter_mode, "mmap") == 0 ||
+      strcmp(FLAG_parameter_mode, "lazy") == 0) {
     read_flags |= IREE_FILE_READ_FLAG_MMAP;
   } else if (strcmp(FLAG_parameter_mode, "preload") == 0) {
-    read_flags |= IREE_FILE_READ_FLAG_PRELOAD;
+    // Cached parameters are only read from the file when populating the cache
+    // and mapping avoids reading those already cached by another process.
+    read_flags |=
+        is_cached ? IREE_FILE_READ_FLAG_MMAP : IREE_FILE_READ_FLAG_PRELOAD;
   } else {
     IREE_TRACE_ZONE_END(z0);
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
@@ -93,20 +124,81 @@ IREE_FLAG_LIST(
     "- .gguf (https://github.com/ggerganov/ggml/blob/master/docs/gguf.md)\n"
     "- .safetensors (https://github.com/huggingface/safetensors)");
 
+IREE_FLAG(
+    string, parameter_cache, "",
+    "Shares parameter contents with other processes using the same cache\n"
+    "namespace (such as `--parameter_cache=my_model`). Identical parameters\n"
+    "are stored once per host in shared memory and processes started while\n"
+    "they are cached skip reading them. Only used with\n"
+    "--parameter_mode=preload or file as mapped files are already shared by\n"
+    "the OS. Disabled if empty or unsupported on the platform.");
+
+IREE_FLAG(bool, parameter_cache_persistent, false,
+          "Keeps parameters in the --parameter_cache= after the last process\n"
+          "using them exits so that future processes start warm.");
+
+// Creates the shared parameter cache requested by flags, if any.
+// |out_cache| is set to NULL if the cache is disabled or unsupported.
+static iree_status_t iree_io_create_parameter_cache_from_flags(
+    iree_allocator_t host_allocator, iree_io_parameter_cache_t** out_cache) {
+  *out_cache = NULL;
+  iree_string_view_t namespace_name =
+      iree_make_cstring_view(FLAG_parameter_cache);
+  if (iree_string_view_is_empty(namespace_name)) return iree_ok_status();
+
+  // Mapped files share their pages through the OS page cache and copying them
+  // into the cache would only double their memory use.
+  if (strcmp(FLAG_parameter_mode, "preload") != 0 &&
+      strcmp(FLAG_parameter_mode, "file") != 0) {
+    return iree_ok_status();
+  }
+
+  iree_io_parameter_cache_options_t options =
+      iree_io_parameter_cache_options_default();
+  options.namespace_name = namespace_name;
+  if (FLAG_parameter_cache_persistent) {
+    options.flags |= IREE_IO_PARAMETER_CACHE_FLAG_PERSISTENT;
+  }
+  iree_status_t status =
+      iree_io_parameter_cache_create(options, host_allocator, out_cache);
+  if (iree_status_is_unavailable(status)) {
+    // The cache is an optimization; fall back to private copies.
+    status = iree_status_ignore(status);
+  }
+  return status;
+}
+
 // Appends the parameter file located at |path| to |index|.
+// If |cache| is provided the file-backed parameters are shared through it.
 static iree_status_t iree_io_append_parameter_file_to_index(
-    iree_string_view_t path, iree_io_parameter_index_t* index,
-    iree_allocator_t host_allocator) {
+    iree_string_view_t path, iree_io_parameter_cache_t* cache,
+    iree_io_parameter_index_t* index, iree_allocator_t host_allocator) {
   IREE_ASSERT_ARGUMENT(index);
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Open the file.
   iree_io_file_handle_t* file_handle = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_io_open_parameter_file(path, host_allocator, &file_handle));
+      z0, iree_io_open_parameter_file(path, cache != NULL, host_allocator,
+                                      &file_handle));
 
-  // Index the file based on its (inferred) format.
-  iree_status_t status = iree_io_parse_file_index(path, file_handle, index);
+  // Index the file based on its (inferred) format. When sharing, the file is
+  // indexed on its own first so that only its entries are redirected.
+  iree_status_t status = iree_ok_status();
+  if (cache) {
+    iree_io_parameter_index_t* file_index = NULL;
+    status = iree_io_parameter_index_create(host_allocator, &file_index);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parse_file_index(path, file_handle, file_index);
+    }
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_io_parameter_cache_share_index(cache, path, file_index, index);
+    }
+    iree_io_parameter_index_release(file_index);
+  } else {
+    status = iree_io_parse_file_index(path, file_handle, index);
+  }
 
   // Release our file reference - it's still retained by the index if it had any
   // parameters in it.
@@ -120,8 +212,19 @@ iree_status_t iree_tooling_build_parameter_indices_from_flags(
     iree_io_scope_map_t* scope_map) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Create the shared cache, if enabled. Cached parameters remain referenced by
+  // the indices after the cache itself is released.
+  iree_io_parameter_cache_t* cache = NULL;
+  if (FLAG_parameters_list().count > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_create_parameter_cache_from_flags(
+                scope_map->host_allocator, &cache));
+  }
+
   // Create one index per scope and add parameters to each.
-  for (iree_host_size_t i = 0; i < FLAG_parameters_list().count; ++i) {
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < FLAG_parameters_list().count && iree_status_is_ok(status); ++i) {
     // Parse the `scope=path` flag. Note that the scope is optional.
     iree_string_view_t flag = FLAG_parameters_list().values[i];
     iree_string_view_t scope, path;
@@ -133,17 +236,18 @@ iree_status_t iree_tooling_build_parameter_indices_from_flags(
 
     // Lookup (or create) the index for the given scope.
     iree_io_parameter_index_t* index = NULL;  // unowned
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_io_scope_map_lookup(scope_map, scope, &index));
+    status = iree_io_scope_map_lookup(scope_map, scope, &index);
 
     // Index the file.
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_io_append_parameter_file_to_index(path, index,
-                                                   scope_map->host_allocator));
+    if (iree_status_is_ok(status)) {
+      status = iree_io_append_parameter_file_to_index(
+          path, cache, index, scope_map->host_allocator);
+    }
   }
 
+  iree_io_parameter_cache_release(cache);
   IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();
+  return status;
 }
 
 iree_status_t iree_tooling_create_parameters_module_from_flags(
@@ -163,12 +267,23 @@ iree_status_t iree_tooling_create_parameters_module_from_flags(
   iree_io_parameter_provider_t** providers =
       (iree_io_parameter_provider_t**)iree_alloca(
           scope_map.count * sizeof(iree_io_parameter_provider_t*));
+  iree_io_parameter_residency_options_t residency_options =
+      iree_io_parameter_residency_options_default();
+  if (strcmp(FLAG_parameter_mode, "lazy") == 0) {
+    residency_options.mode = IREE_IO_PARAMETER_RESIDENCY_MODE_LAZY;
+    residency_options.budget =
+        (uint64_t)iree_max(0, FLAG_parameter_residency_budget);
+    residency_options.trim_interval =
+        (iree_duration_t)iree_max(0,
+                                  FLAG_parameter_residency_trim_interval_ms) *
+        1000000;
+  }
   if (iree_status_is_ok(status)) {
     for (iree_host_size_t i = 0; i < scope_map.count; ++i) {
-      status = iree_io_parameter_index_provider_create(
+      status = iree_io_parameter_index_provider_create_with_residency(
           scope_map.entries[i]->scope, scope_map.entries[i]->index,
           IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS,
-          host_allocator, &providers[i]);
+          residency_options, host_allocator, &providers[i]);
       if (!iree_status_is_ok(status)) break;
       ++provider_count;
     }
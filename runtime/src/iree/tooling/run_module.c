@@ -278,6 +278,13 @@ static iree_status_t iree_tooling_run_function(
         "processing instrument data");
   }
 
+  // Write the VM execution profile if requested.
+  if (iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(
+        iree_tooling_write_module_profiles_from_flags(context, host_allocator),
+        "writing module profiles");
+  }
+
   // Transfer outputs to the host so they can be processed. Only required when
   // using full HAL device-based execution.
   if (iree_status_is_ok(status) && device != NULL) {
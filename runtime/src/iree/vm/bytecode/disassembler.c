@@ -446,6 +446,21 @@ iree_status_t iree_vm_bytecode_disassemble_op(
       break;
     }
 
+    DISASM_OP(CORE, GlobalAddI32) {
+      uint32_t byte_offset = VM_ParseGlobalAttr("global");
+      uint16_t addend_reg = VM_ParseOperandRegI32("addend");
+      uint16_t result_reg = VM_ParseResultRegI32("result");
+      EMIT_I32_REG_NAME(result_reg);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+          b, " = vm.global.add.i32 .rwdata[%u]", byte_offset));
+      EMIT_OPTIONAL_VALUE_I32(
+          vm_global_load_i32(module_state->rwdata_storage.data, byte_offset));
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_I32_REG_NAME(addend_reg);
+      EMIT_OPTIONAL_VALUE_I32(regs->i32[addend_reg]);
+      break;
+    }
+
     DISASM_OP(CORE, GlobalLoadIndirectI32) {
       uint16_t byte_offset_reg = VM_ParseOperandRegI32("global");
       uint16_t value_reg = VM_ParseResultRegI32("value");
@@ -496,6 +511,20 @@ iree_status_t iree_vm_bytecode_disassemble_op(
       break;
     }
 
+    DISASM_OP(CORE, GlobalAddI64) {
+      uint32_t byte_offset = VM_ParseGlobalAttr("global");
+      uint16_t addend_reg = VM_ParseOperandRegI64("addend");
+      uint16_t result_reg = VM_ParseResultRegI64("result");
+      EMIT_I64_REG_NAME(result_reg);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+          b, " = vm.global.add.i64 .rwdata[%u]", byte_offset));
+      EMIT_OPTIONAL_VALUE_I64(module_state->rwdata_storage.data[byte_offset]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_I64_REG_NAME(addend_reg);
+      EMIT_OPTIONAL_VALUE_I64(regs->i32[addend_reg]);
+      break;
+    }
+
     DISASM_OP(CORE, GlobalLoadIndirectI64) {
       uint16_t byte_offset_reg = VM_ParseOperandRegI32("global");
       uint16_t value_reg = VM_ParseResultRegI64("value");
@@ -1213,6 +1242,64 @@ iree_status_t iree_vm_bytecode_disassemble_op(
       break;
     }
 
+    DISASM_OP(CORE, ListCopyToBuffer) {
+      bool source_list_is_move;
+      uint16_t source_list_reg =
+          VM_ParseOperandRegRef("source_list", &source_list_is_move);
+      uint16_t source_index_reg = VM_ParseOperandRegI32("source_index");
+      bool target_buffer_is_move;
+      uint16_t target_buffer_reg =
+          VM_ParseOperandRegRef("target_buffer", &target_buffer_is_move);
+      uint16_t target_offset_reg = VM_ParseOperandRegI64("target_offset");
+      uint16_t count_reg = VM_ParseOperandRegI32("count");
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_cstring(b, "vm.list.copy.to.buffer "));
+      EMIT_REF_REG_NAME(source_list_reg);
+      EMIT_OPTIONAL_VALUE_REF(&regs->ref[source_list_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_I32_REG_NAME(source_index_reg);
+      EMIT_OPTIONAL_VALUE_I32(regs->i32[source_index_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_REF_REG_NAME(target_buffer_reg);
+      EMIT_OPTIONAL_VALUE_REF(&regs->ref[target_buffer_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_I64_REG_NAME(target_offset_reg);
+      EMIT_OPTIONAL_VALUE_I64(regs->i32[target_offset_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_I32_REG_NAME(count_reg);
+      EMIT_OPTIONAL_VALUE_I32(regs->i32[count_reg]);
+      break;
+    }
+
+    DISASM_OP(CORE, ListCopyFromBuffer) {
+      bool source_buffer_is_move;
+      uint16_t source_buffer_reg =
+          VM_ParseOperandRegRef("source_buffer", &source_buffer_is_move);
+      uint16_t source_offset_reg = VM_ParseOperandRegI64("source_offset");
+      bool target_list_is_move;
+      uint16_t target_list_reg =
+          VM_ParseOperandRegRef("target_list", &target_list_is_move);
+      uint16_t target_index_reg = VM_ParseOperandRegI32("target_index");
+      uint16_t count_reg = VM_ParseOperandRegI32("count");
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_cstring(b, "vm.list.copy.from.buffer "));
+      EMIT_REF_REG_NAME(source_buffer_reg);
+      EMIT_OPTIONAL_VALUE_REF(&regs->ref[source_buffer_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_I64_REG_NAME(source_offset_reg);
+      EMIT_OPTIONAL_VALUE_I64(regs->i32[source_offset_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_REF_REG_NAME(target_list_reg);
+      EMIT_OPTIONAL_VALUE_REF(&regs->ref[target_list_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_I32_REG_NAME(target_index_reg);
+      EMIT_OPTIONAL_VALUE_I32(regs->i32[target_index_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));
+      EMIT_I32_REG_NAME(count_reg);
+      EMIT_OPTIONAL_VALUE_I32(regs->i32[count_reg]);
+      break;
+    }
+
     //===------------------------------------------------------------------===//
     // Conditional assignment
     //===------------------------------------------------------------------===//
@@ -1612,6 +1699,63 @@ iree_status_t iree_vm_bytecode_disassemble_op(
       break;
     }
 
+#define DISASM_OP_CORE_COND_BRANCH_CMP(op_name, op_mnemonic, VM_ParseReg,   \
+                                       EMIT_REG, EMIT_VALUE)                \
+  DISASM_OP(CORE, op_name) {                                                \
+    uint16_t lhs_reg = VM_ParseReg("lhs");                                  \
+    uint16_t rhs_reg = VM_ParseReg("rhs");                                  \
+    int32_t true_block_pc = VM_ParseBranchTarget("true_dest");              \
+    const iree_vm_register_remap_list_t* true_remap_list =                  \
+        VM_ParseBranchOperands("true_operands");                            \
+    int32_t false_block_pc = VM_ParseBranchTarget("false_dest");            \
+    const iree_vm_register_remap_list_t* false_remap_list =                 \
+        VM_ParseBranchOperands("false_operands");                           \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, "%s ", op_mnemonic));          \
+    EMIT_REG(lhs_reg);                                                      \
+    EMIT_VALUE(regs->i32[lhs_reg]);                                         \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));      \
+    EMIT_REG(rhs_reg);                                                      \
+    EMIT_VALUE(regs->i32[rhs_reg]);                                         \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, ", ^%08X(", true_block_pc));   \
+    EMIT_REMAP_LIST(true_remap_list);                                       \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, "), ^%08X(", false_block_pc)); \
+    EMIT_REMAP_LIST(false_remap_list);                                      \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ")"));       \
+    break;                                                                  \
+  }
+
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI32, "vm.cond_br.cmp.eq.i32",
+                                   VM_ParseOperandRegI32, EMIT_I32_REG_NAME,
+                                   EMIT_OPTIONAL_VALUE_I32);
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI32, "vm.cond_br.cmp.ne.i32",
+                                   VM_ParseOperandRegI32, EMIT_I32_REG_NAME,
+                                   EMIT_OPTIONAL_VALUE_I32);
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32S,
+                                   "vm.cond_br.cmp.lt.i32.s",
+                                   VM_ParseOperandRegI32, EMIT_I32_REG_NAME,
+                                   EMIT_OPTIONAL_VALUE_I32);
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32U,
+                                   "vm.cond_br.cmp.lt.i32.u",
+                                   VM_ParseOperandRegI32, EMIT_I32_REG_NAME,
+                                   EMIT_OPTIONAL_VALUE_I32);
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI64, "vm.cond_br.cmp.eq.i64",
+                                   VM_ParseOperandRegI64, EMIT_I64_REG_NAME,
+                                   EMIT_OPTIONAL_VALUE_I64);
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI64, "vm.cond_br.cmp.ne.i64",
+                                   VM_ParseOperandRegI64, EMIT_I64_REG_NAME,
+                                   EMIT_OPTIONAL_VALUE_I64);
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64S,
+                                   "vm.cond_br.cmp.lt.i64.s",
+                                   VM_ParseOperandRegI64, EMIT_I64_REG_NAME,
+                                   EMIT_OPTIONAL_VALUE_I64);
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64U,
+                                   "vm.cond_br.cmp.lt.i64.u",
+                                   VM_ParseOperandRegI64, EMIT_I64_REG_NAME,
+                                   EMIT_OPTIONAL_VALUE_I64);
+
     DISASM_OP(CORE, BranchTable) {
       uint16_t index_reg = VM_ParseOperandRegI32("index");
       IREE_RETURN_IF_ERROR(
@@ -1637,6 +1781,8 @@ iree_status_t iree_vm_bytecode_disassemble_op(
       break;
     }
 
+    // The branch following a CallBranch is disassembled as its own op.
+    DISASM_OP(CORE, CallBranch)
     DISASM_OP(CORE, Call) {
       int32_t function_ordinal = VM_ParseFuncAttr("callee");
       const iree_vm_register_list_t* src_reg_list =
@@ -102,6 +102,13 @@ static iree_status_t iree_vm_bytecode_function_enter(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "import ordinal out of range");
   }
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_module_ensure_verified(module, function.ordinal));
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  if (IREE_UNLIKELY(module->profile)) {
+    iree_vm_bytecode_profile_record_call(module->profile, function.ordinal);
+  }
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
   const iree_vm_FunctionDescriptor_t* target_descriptor =
       &module->function_descriptor_table[function.ordinal];
 
@@ -442,14 +449,36 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
 
 // Issues a populated import call and marshals the results into |dst_reg_list|.
 static iree_status_t iree_vm_bytecode_issue_import_call(
-    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
-    iree_string_view_t cconv_results,
+    iree_vm_stack_t* stack, const iree_vm_bytecode_module_state_t* module_state,
+    const iree_vm_bytecode_import_t* import, const iree_vm_function_call_t call,
     const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
     iree_vm_stack_frame_t* IREE_RESTRICT* out_caller_frame,
     iree_vm_registers_t* out_caller_registers) {
-  // Call external function.
-  iree_status_t call_status =
-      call.function.module->begin_call(call.function.module->self, stack, call);
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  const iree_time_t profile_start_ns =
+      module_state->profile ? iree_time_now() : 0;
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
+  // Call external function. Native module exports resolved to a direct-call
+  // target get their shim invoked without the begin_call indirection.
+  iree_status_t call_status = iree_ok_status();
+  if (import->direct_call.shim) {
+    call_status = iree_vm_native_module_begin_direct_call(
+        stack, &call.function, &import->direct_call, call.arguments,
+        call.results);
+  } else {
+    call_status = call.function.module->begin_call(call.function.module->self,
+                                                   stack, call);
+  }
+
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  // Time spent in a deferred call is only counted until it first yields.
+  if (module_state->profile) {
+    iree_vm_bytecode_profile_record_import(
+        module_state->profile, (uint32_t)(import - module_state->import_table),
+        iree_time_now() - profile_start_ns);
+  }
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
   if (iree_status_is_deferred(call_status)) {
     if (!iree_byte_span_is_empty(call.results)) {
       iree_status_ignore(call_status);
@@ -471,6 +500,7 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
       iree_vm_bytecode_get_register_storage(*out_caller_frame);
 
   // Marshal outputs from the ABI results buffer to registers.
+  iree_string_view_t cconv_results = import->results;
   iree_vm_registers_t caller_registers = *out_caller_registers;
   uint8_t* IREE_RESTRICT p = call.results.data;
   for (iree_host_size_t i = 0; i < cconv_results.size && i < dst_reg_list->size;
@@ -501,6 +531,54 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
   return iree_ok_status();
 }
 
+static_assert(IREE_VM_NATIVE_REGISTER_REF_MASK == IREE_REF_REGISTER_MASK,
+              "native register calls must decode ref registers the same");
+
+// Issues an import call through the register-call target of its native export.
+// Arguments are read from and results written to the caller registers in place
+// so no ABI storage or stack frame is required.
+static iree_status_t iree_vm_bytecode_issue_import_register_call(
+    iree_vm_stack_t* stack, const iree_vm_bytecode_module_state_t* module_state,
+    const iree_vm_bytecode_import_t* import,
+    const iree_vm_registers_t caller_registers,
+    const iree_vm_register_list_t* IREE_RESTRICT segment_size_list,
+    const iree_vm_register_list_t* IREE_RESTRICT src_reg_list,
+    const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
+    iree_vm_stack_frame_t* IREE_RESTRICT* out_caller_frame,
+    iree_vm_registers_t* out_caller_registers) {
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  const iree_time_t profile_start_ns =
+      module_state->profile ? iree_time_now() : 0;
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
+  const iree_vm_native_register_call_t call = {
+      .i32 = caller_registers.i32,
+      .ref = caller_registers.ref,
+      .segment_sizes = segment_size_list,
+      .arguments = src_reg_list,
+      .results = dst_reg_list,
+  };
+  iree_status_t call_status = iree_vm_native_module_begin_register_call(
+      stack, &import->function, &import->direct_call, &call);
+
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  if (module_state->profile) {
+    iree_vm_bytecode_profile_record_import(
+        module_state->profile, (uint32_t)(import - module_state->import_table),
+        iree_time_now() - profile_start_ns);
+  }
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+  if (IREE_UNLIKELY(!iree_status_is_ok(call_status))) {
+    return iree_status_annotate(call_status,
+                                iree_make_cstring_view("while calling import"));
+  }
+
+  // Register calls never touch the stack so the caller frame is unchanged.
+  *out_caller_frame = iree_vm_stack_current_frame(stack);
+  *out_caller_registers = caller_registers;
+  return iree_ok_status();
+}
+
 // Verifies that the requested import is valid and returns its table entry.
 static iree_status_t iree_vm_bytecode_verify_import(
     iree_vm_stack_t* stack, const iree_vm_bytecode_module_state_t* module_state,
@@ -549,6 +627,14 @@ static iree_status_t iree_vm_bytecode_call_import(
   IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_import(stack, module_state,
                                                       import_ordinal, &import));
 
+  // Native exports with a register-call target take the registers in place.
+  if (import->direct_call.register_target) {
+    return iree_vm_bytecode_issue_import_register_call(
+        stack, module_state, import, caller_registers,
+        /*segment_size_list=*/NULL, src_reg_list, dst_reg_list,
+        out_caller_frame, out_caller_registers);
+  }
+
   iree_vm_function_call_t call;
   memset(&call, 0, sizeof(call));
   call.function = import->function;
@@ -565,9 +651,9 @@ static iree_status_t iree_vm_bytecode_call_import(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
-                                            out_caller_registers);
+  return iree_vm_bytecode_issue_import_call(
+      stack, module_state, import, call, dst_reg_list, out_caller_frame,
+      out_caller_registers);
 }
 
 // Calls a variadic imported function from another module.
@@ -586,6 +672,13 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
   IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_import(stack, module_state,
                                                       import_ordinal, &import));
 
+  // Native exports with a register-call target take the registers in place.
+  if (import->direct_call.register_target) {
+    return iree_vm_bytecode_issue_import_register_call(
+        stack, module_state, import, caller_registers, segment_size_list,
+        src_reg_list, dst_reg_list, out_caller_frame, out_caller_registers);
+  }
+
   iree_vm_function_call_t call;
   memset(&call, 0, sizeof(call));
   call.function = import->function;
@@ -606,9 +699,9 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
-                                            out_caller_registers);
+  return iree_vm_bytecode_issue_import_call(
+      stack, module_state, import, call, dst_reg_list, out_caller_frame,
+      out_caller_registers);
 }
 
 //===----------------------------------------------------------------------===//
@@ -704,6 +797,19 @@ static iree_status_t iree_vm_bytecode_dispatch(
                           value);
     });
 
+    DISPATCH_OP(CORE, GlobalAddI32, {
+      uint32_t byte_offset = VM_DecGlobalAttr("global");
+      IREE_ASSERT(byte_offset + 4 <= module_state->rwdata_storage.data_length);
+      int32_t addend = VM_DecOperandRegI32("addend");
+      int32_t* result = VM_DecResultRegI32("result");
+      const int32_t global_value = vm_add_i32(
+          vm_global_load_i32(module_state->rwdata_storage.data, byte_offset),
+          addend);
+      vm_global_store_i32(module_state->rwdata_storage.data, byte_offset,
+                          global_value);
+      *result = global_value;
+    });
+
     DISPATCH_OP(CORE, GlobalLoadIndirectI32, {
       uint32_t byte_offset = VM_DecOperandRegI32("global");
       if (IREE_UNLIKELY(byte_offset + 4 >
@@ -750,6 +856,19 @@ static iree_status_t iree_vm_bytecode_dispatch(
                           value);
     });
 
+    DISPATCH_OP(CORE, GlobalAddI64, {
+      uint32_t byte_offset = VM_DecGlobalAttr("global");
+      IREE_ASSERT(byte_offset + 8 <= module_state->rwdata_storage.data_length);
+      int64_t addend = VM_DecOperandRegI64("addend");
+      int64_t* result = VM_DecResultRegI64("result");
+      const int64_t global_value = vm_add_i64(
+          vm_global_load_i64(module_state->rwdata_storage.data, byte_offset),
+          addend);
+      vm_global_store_i64(module_state->rwdata_storage.data, byte_offset,
+                          global_value);
+      *result = global_value;
+    });
+
     DISPATCH_OP(CORE, GlobalLoadIndirectI64, {
       uint32_t byte_offset = VM_DecOperandRegI32("global");
       if (IREE_UNLIKELY(byte_offset + 8 >
@@ -886,10 +1005,12 @@ static iree_status_t iree_vm_bytecode_dispatch(
       iree_host_size_t alignment = VM_DecOperandRegI32("alignment");
       bool result_is_move;
       iree_vm_ref_t* result_ref = VM_DecResultRegRef("result", &result_is_move);
+      iree_allocator_t allocator =
+          iree_vm_stack_object_allocator(stack, module_state->allocator);
       iree_vm_buffer_t* buffer = NULL;
       IREE_RETURN_IF_ERROR(iree_vm_buffer_create(
           IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_GUEST,
-          length, alignment, module_state->allocator, &buffer));
+          length, alignment, allocator, &buffer));
       IREE_RETURN_IF_ERROR(
           iree_vm_ref_wrap_assign(buffer, iree_vm_buffer_type(), result_ref));
     });
@@ -907,10 +1028,12 @@ static iree_status_t iree_vm_bytecode_dispatch(
       iree_host_size_t alignment = VM_DecOperandRegI32("alignment");
       bool result_is_move;
       iree_vm_ref_t* result_ref = VM_DecResultRegRef("result", &result_is_move);
+      iree_allocator_t allocator =
+          iree_vm_stack_object_allocator(stack, module_state->allocator);
       iree_vm_buffer_t* result = NULL;
       IREE_RETURN_IF_ERROR(iree_vm_buffer_clone(
           IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_GUEST,
-          source, offset, length, alignment, module_state->allocator, &result));
+          source, offset, length, alignment, allocator, &result));
       IREE_RETURN_IF_ERROR(
           iree_vm_ref_wrap_assign(result, iree_vm_buffer_type(), result_ref));
     });
@@ -1203,9 +1326,11 @@ static iree_status_t iree_vm_bytecode_dispatch(
       uint32_t initial_capacity = VM_DecOperandRegI32("initial_capacity");
       bool result_is_move;
       iree_vm_ref_t* result = VM_DecResultRegRef("result", &result_is_move);
+      iree_allocator_t allocator =
+          iree_vm_stack_object_allocator(stack, module_state->allocator);
       iree_vm_list_t* list = NULL;
       IREE_RETURN_IF_ERROR(iree_vm_list_create(
-          element_type_def, initial_capacity, module_state->allocator, &list));
+          element_type_def, initial_capacity, allocator, &list));
       IREE_RETURN_IF_ERROR(
           iree_vm_ref_wrap_assign(list, iree_vm_list_type(), result));
     });
@@ -1338,6 +1463,58 @@ static iree_status_t iree_vm_bytecode_dispatch(
       }
     });
 
+    DISPATCH_OP(CORE, ListCopyToBuffer, {
+      bool source_list_is_move;
+      iree_vm_ref_t* source_list_ref =
+          VM_DecOperandRegRef("source_list", &source_list_is_move);
+      iree_vm_list_t* source_list = iree_vm_list_deref(*source_list_ref);
+      if (IREE_UNLIKELY(!source_list)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "source_list is null");
+      }
+      uint32_t source_index = VM_DecOperandRegI32("source_index");
+      bool target_buffer_is_move;
+      iree_vm_ref_t* target_buffer_ref =
+          VM_DecOperandRegRef("target_buffer", &target_buffer_is_move);
+      iree_vm_buffer_t* target_buffer =
+          iree_vm_buffer_deref(*target_buffer_ref);
+      if (IREE_UNLIKELY(!target_buffer)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "target_buffer is null");
+      }
+      iree_host_size_t target_offset =
+          VM_DecOperandRegI64HostSize("target_offset");
+      uint32_t count = VM_DecOperandRegI32("count");
+      IREE_RETURN_IF_ERROR(vm_list_copy_to_buffer(
+          source_list, source_index, target_buffer, target_offset, count));
+    });
+
+    DISPATCH_OP(CORE, ListCopyFromBuffer, {
+      bool source_buffer_is_move;
+      iree_vm_ref_t* source_buffer_ref =
+          VM_DecOperandRegRef("source_buffer", &source_buffer_is_move);
+      iree_vm_buffer_t* source_buffer =
+          iree_vm_buffer_deref(*source_buffer_ref);
+      if (IREE_UNLIKELY(!source_buffer)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "source_buffer is null");
+      }
+      iree_host_size_t source_offset =
+          VM_DecOperandRegI64HostSize("source_offset");
+      bool target_list_is_move;
+      iree_vm_ref_t* target_list_ref =
+          VM_DecOperandRegRef("target_list", &target_list_is_move);
+      iree_vm_list_t* target_list = iree_vm_list_deref(*target_list_ref);
+      if (IREE_UNLIKELY(!target_list)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "target_list is null");
+      }
+      uint32_t target_index = VM_DecOperandRegI32("target_index");
+      uint32_t count = VM_DecOperandRegI32("count");
+      IREE_RETURN_IF_ERROR(vm_list_copy_from_buffer(
+          source_buffer, source_offset, target_list, target_index, count));
+    });
+
     //===------------------------------------------------------------------===//
     // Conditional assignment
     //===------------------------------------------------------------------===//
@@ -1609,14 +1786,27 @@ static iree_status_t iree_vm_bytecode_dispatch(
     // Control flow
     //===------------------------------------------------------------------===//
 
-    // No-op in the interpreter.
-    DISPATCH_OP(CORE, Block, {});
+    // No-op in the interpreter. Branches skip block markers so this is only
+    // reached on function entry where native code may take over until it
+    // reaches an op it cannot handle.
+    DISPATCH_OP(CORE, Block, {
+#if IREE_VM_BYTECODE_JIT_ENABLE
+      iree_vm_bytecode_jit_entry_fn_t jit_entry = iree_vm_bytecode_jit_lookup(
+          &module->jit, current_frame->function.ordinal);
+#if IREE_VM_EXECUTION_TRACING_ENABLE
+      // Native code does not trace so tracing runs everything interpreted.
+      if (IREE_IS_DISPATCH_TRACING_ENABLED()) jit_entry = NULL;
+#endif  // IREE_VM_EXECUTION_TRACING_ENABLE
+      if (jit_entry) pc = jit_entry(regs_i32);
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
+    });
 
     DISPATCH_OP(CORE, Branch, {
       int32_t block_pc = VM_DecBranchTarget("dest");
       const iree_vm_register_remap_list_t* remap_list =
           VM_DecBranchOperands("operands");
       pc = block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+      IREE_DISPATCH_PROFILE_BLOCK(block_pc);
       if (IREE_UNLIKELY(remap_list->size > 0)) {
         iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                          remap_list);
@@ -1633,12 +1823,14 @@ static iree_status_t iree_vm_bytecode_dispatch(
           VM_DecBranchOperands("false_operands");
       if (condition) {
         pc = true_block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        IREE_DISPATCH_PROFILE_BLOCK(true_block_pc);
         if (IREE_UNLIKELY(true_remap_list->size > 0)) {
           iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                            true_remap_list);
         }
       } else {
         pc = false_block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        IREE_DISPATCH_PROFILE_BLOCK(false_block_pc);
         if (IREE_UNLIKELY(false_remap_list->size > 0)) {
           iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                            false_remap_list);
@@ -1646,6 +1838,52 @@ static iree_status_t iree_vm_bytecode_dispatch(
       }
     });
 
+    // Fused compare + cond_br. The comparison result is only used as the
+    // branch condition and never written to a register.
+#define DISPATCH_OP_CORE_COND_BRANCH_CMP(op_name, op_type, VM_DecReg, op_func) \
+  DISPATCH_OP(CORE, op_name, {                                                 \
+    op_type lhs = VM_DecReg("lhs");                                            \
+    op_type rhs = VM_DecReg("rhs");                                            \
+    int32_t true_block_pc = VM_DecBranchTarget("true_dest");                   \
+    const iree_vm_register_remap_list_t* true_remap_list =                     \
+        VM_DecBranchOperands("true_operands");                                 \
+    int32_t false_block_pc = VM_DecBranchTarget("false_dest");                 \
+    const iree_vm_register_remap_list_t* false_remap_list =                    \
+        VM_DecBranchOperands("false_operands");                                \
+    if (op_func(lhs, rhs)) {                                                   \
+      pc = true_block_pc + IREE_VM_BLOCK_MARKER_SIZE;                          \
+      IREE_DISPATCH_PROFILE_BLOCK(true_block_pc);                              \
+      if (IREE_UNLIKELY(true_remap_list->size > 0)) {                          \
+        iree_vm_bytecode_dispatch_remap_branch_registers(                      \
+            regs_i32, regs_ref, true_remap_list);                              \
+      }                                                                        \
+    } else {                                                                   \
+      pc = false_block_pc + IREE_VM_BLOCK_MARKER_SIZE;                         \
+      IREE_DISPATCH_PROFILE_BLOCK(false_block_pc);                             \
+      if (IREE_UNLIKELY(false_remap_list->size > 0)) {                         \
+        iree_vm_bytecode_dispatch_remap_branch_registers(                      \
+            regs_i32, regs_ref, false_remap_list);                             \
+      }                                                                        \
+    }                                                                          \
+  });
+
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI32, int32_t,
+                                     VM_DecOperandRegI32, vm_cmp_eq_i32);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI32, int32_t,
+                                     VM_DecOperandRegI32, vm_cmp_ne_i32);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32S, int32_t,
+                                     VM_DecOperandRegI32, vm_cmp_lt_i32s);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32U, int32_t,
+                                     VM_DecOperandRegI32, vm_cmp_lt_i32u);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI64, int64_t,
+                                     VM_DecOperandRegI64, vm_cmp_eq_i64);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI64, int64_t,
+                                     VM_DecOperandRegI64, vm_cmp_ne_i64);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64S, int64_t,
+                                     VM_DecOperandRegI64, vm_cmp_lt_i64s);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64U, int64_t,
+                                     VM_DecOperandRegI64, vm_cmp_lt_i64u);
+
     DISPATCH_OP(CORE, BranchTable, {
       int32_t index = VM_DecOperandRegI32("index");
       int32_t default_block_pc = VM_DecBranchTarget("default_dest");
@@ -1655,6 +1893,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       if (index < 0 || index >= table_size) {
         // Out-of-bounds index; jump to default block.
         pc = default_block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        IREE_DISPATCH_PROFILE_BLOCK(default_block_pc);
         if (IREE_UNLIKELY(default_remap_list->size > 0)) {
           iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                            default_remap_list);
@@ -1670,6 +1909,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
         const iree_vm_register_remap_list_t* case_remap_list =
             VM_DecBranchOperands("case_operands");
         pc = case_block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        IREE_DISPATCH_PROFILE_BLOCK(case_block_pc);
         if (IREE_UNLIKELY(case_remap_list->size > 0)) {
           iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                            case_remap_list);
@@ -1713,6 +1953,54 @@ static iree_status_t iree_vm_bytecode_dispatch(
       pc = current_frame->pc;
     });
 
+    // A Call immediately followed by the Branch consuming its results.
+    // Synchronous import calls execute the branch inline without returning to
+    // the dispatch loop. Internal calls (and yielding imports) resume at the
+    // Branch op as with a normal Call.
+    DISPATCH_OP(CORE, CallBranch, {
+      int32_t function_ordinal = VM_DecFuncAttr("callee");
+      const iree_vm_register_list_t* src_reg_list =
+          VM_DecVariadicOperands("operands");
+      const iree_vm_register_list_t* dst_reg_list =
+          VM_DecVariadicResults("results");
+      current_frame->pc = pc;
+
+      int is_import = (function_ordinal & 0x80000000u) != 0;
+      if (is_import) {
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_call_import(
+            stack, module_state, function_ordinal, regs, src_reg_list,
+            dst_reg_list, &current_frame, &regs));
+      } else {
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_internal_enter(
+            stack, current_frame->function.module, function_ordinal,
+            src_reg_list, dst_reg_list, &current_frame, &regs));
+        bytecode_data =
+            module->bytecode_data.data +
+            module->function_descriptor_table[function_ordinal].bytecode_offset;
+      }
+
+      regs_i32 = regs.i32;
+      IREE_BUILTIN_ASSUME_ALIGNED(regs_i32, 16);
+      regs_ref = regs.ref;
+      IREE_BUILTIN_ASSUME_ALIGNED(regs_ref, 16);
+      pc = current_frame->pc;
+
+      if (is_import) {
+        // Verified to be a Branch; skip its opcode and take it directly.
+        IREE_DISPATCH_TRACE_INSTRUCTION(0, "Branch");
+        ++pc;
+        int32_t block_pc = VM_DecBranchTarget("dest");
+        const iree_vm_register_remap_list_t* remap_list =
+            VM_DecBranchOperands("operands");
+        pc = block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        IREE_DISPATCH_PROFILE_BLOCK(block_pc);
+        if (IREE_UNLIKELY(remap_list->size > 0)) {
+          iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
+                                                           remap_list);
+        }
+      }
+    });
+
     DISPATCH_OP(CORE, CallVariadic, {
       // TODO(benvanik): dedupe with above or merge and always have the seg size
       // list be present (but empty) for non-variadic calls.
@@ -1814,6 +2102,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
                                                        remap_list);
       current_frame->pc =
           block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+      IREE_DISPATCH_PROFILE_BLOCK(block_pc);
 
       // Return magic status code indicating a yield.
       // This isn't an error, though callers not supporting coroutines will
@@ -1851,6 +2140,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                        remap_list);
       pc = block_pc;
+      IREE_DISPATCH_PROFILE_BLOCK(block_pc);
     });
 
     DISPATCH_OP(CORE, CondBreak, {
@@ -1864,6 +2154,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                        remap_list);
       pc = block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+      IREE_DISPATCH_PROFILE_BLOCK(block_pc);
     });
 
     //===------------------------------------------------------------------===//
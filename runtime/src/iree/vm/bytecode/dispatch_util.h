@@ -116,6 +116,16 @@ static inline iree_vm_type_def_t iree_vm_map_type(
 #define IREE_DISPATCH_TRACE_INSTRUCTION(...)
 #endif  // IREE_VM_EXECUTION_TRACING_ENABLE
 
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+#define IREE_DISPATCH_PROFILE_BLOCK(block_pc)                          \
+  if (IREE_UNLIKELY(module->profile)) {                                \
+    iree_vm_bytecode_profile_record_block(                             \
+        module->profile, current_frame->function.ordinal, (block_pc)); \
+  }
+#else
+#define IREE_DISPATCH_PROFILE_BLOCK(block_pc)
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
 #if defined(IREE_COMPILER_CLANG) && \
     IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE
 #define IREE_DISPATCH_MODE_COMPUTED_GOTO 1
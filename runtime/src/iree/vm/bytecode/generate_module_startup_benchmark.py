@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+# Copyright 2026 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+"""Generates the VM module used by BM_ModuleStartup in module_benchmark.cc.
+
+The module has many small exported functions for measuring load time. Only one
+function is called by the benchmarks to model large generated programs where
+most functions are unused in a particular deployment.
+
+Usage:
+  $ ./generate_module_startup_benchmark.py --output=module.mlir
+"""
+
+import argparse
+
+FUNCTION_TEMPLATE = """
+  vm.export @fn{index}
+  vm.func @fn{index}(%arg0: i32) -> i32 {{
+    %c0 = vm.const.i32 0
+    %c1 = vm.const.i32 1
+    %ck = vm.const.i32 {index}
+    vm.br ^loop(%c0, %ck : i32, i32)
+  ^loop(%i: i32, %sum: i32):
+    %sum_next = vm.add.i32 %sum, %i : i32
+    %i_next = vm.add.i32 %i, %c1 : i32
+    %cmp = vm.cmp.lt.i32.s %i_next, %arg0 : i32
+    vm.cond_br %cmp, ^loop(%i_next, %sum_next : i32, i32), ^exit(%sum_next : i32)
+  ^exit(%result: i32):
+    vm.return %result : i32
+  }}
+"""
+
+
+def generate_module(function_count):
+    functions = "".join(
+        FUNCTION_TEMPLATE.format(index=index) for index in range(function_count)
+    )
+    return f"vm.module @module_startup_benchmark {{\n{functions}}}\n"
+
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument(
+        "--output", required=True, help="Path of the .mlir file to write."
+    )
+    parser.add_argument(
+        "--function_count",
+        type=int,
+        default=128,
+        help="Number of exported functions in the module.",
+    )
+    return parser.parse_args()
+
+
+def main(args):
+    with open(args.output, "w") as file:
+        file.write(generate_module(args.function_count))
+
+
+if __name__ == "__main__":
+    main(parse_arguments())
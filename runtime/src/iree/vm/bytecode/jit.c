@@ -0,0 +1,848 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode/jit.h"
+
+#include "iree/base/internal/memory.h"
+#include "iree/vm/bytecode/utils/isa.h"
+
+#if defined(IREE_ARCH_X86_64)
+#define IREE_VM_BYTECODE_JIT_ARCH_X86_64 1
+#elif defined(IREE_ARCH_ARM_64) && IREE_VM_BYTECODE_JIT_ARM_64_ENABLE
+#define IREE_VM_BYTECODE_JIT_ARCH_ARM_64 1
+#endif  // IREE_ARCH_*
+
+//===----------------------------------------------------------------------===//
+// Code emission
+//===----------------------------------------------------------------------===//
+
+// Writes machine code into |data|. Each function is emitted twice: first with
+// a NULL |data| to measure the code size and find the offset of each block and
+// then again into the staging buffer with all block offsets known. Templates
+// have a fixed size regardless of their patched values so both passes produce
+// identical layouts.
+typedef struct iree_vm_bytecode_jit_emitter_t {
+  uint8_t* data;
+  iree_host_size_t offset;
+  // Set if a value could not be encoded (a register ordinal or displacement
+  // out of range of the template). The function will not be compiled.
+  bool overflow;
+} iree_vm_bytecode_jit_emitter_t;
+
+static void iree_vm_jit_emit_u8(iree_vm_bytecode_jit_emitter_t* e,
+                                uint8_t value) {
+  if (e->data) e->data[e->offset] = value;
+  e->offset += 1;
+}
+
+static void iree_vm_jit_emit_u32(iree_vm_bytecode_jit_emitter_t* e,
+                                 uint32_t value) {
+  if (e->data) {
+    iree_unaligned_store_le_u32((uint32_t*)&e->data[e->offset], value);
+  }
+  e->offset += 4;
+}
+
+static void iree_vm_jit_patch_u32(iree_vm_bytecode_jit_emitter_t* e,
+                                  iree_host_size_t offset, uint32_t value) {
+  if (e->data) iree_unaligned_store_le_u32((uint32_t*)&e->data[offset], value);
+}
+
+// Conditions tested by branches and comparisons. Each condition has its
+// inverse at |condition ^ 1|.
+typedef enum iree_vm_jit_condition_e {
+  IREE_VM_JIT_CONDITION_EQ = 0,
+  IREE_VM_JIT_CONDITION_NE = 1,
+  IREE_VM_JIT_CONDITION_LT = 2,   // signed
+  IREE_VM_JIT_CONDITION_GE = 3,   // signed
+  IREE_VM_JIT_CONDITION_LTU = 4,  // unsigned
+  IREE_VM_JIT_CONDITION_GEU = 5,  // unsigned
+} iree_vm_jit_condition_t;
+
+typedef enum iree_vm_jit_binary_op_e {
+  IREE_VM_JIT_BINARY_OP_ADD = 0,
+  IREE_VM_JIT_BINARY_OP_SUB,
+  IREE_VM_JIT_BINARY_OP_MUL,
+  IREE_VM_JIT_BINARY_OP_AND,
+  IREE_VM_JIT_BINARY_OP_OR,
+  IREE_VM_JIT_BINARY_OP_XOR,
+} iree_vm_jit_binary_op_t;
+
+#if defined(IREE_VM_BYTECODE_JIT_ARCH_X86_64)
+
+//===----------------------------------------------------------------------===//
+// x86-64 templates
+//===----------------------------------------------------------------------===//
+// The i32 register storage pointer arrives in the first argument register and
+// stays there for the lifetime of the function. eax and edx are used as scratch
+// as they are volatile in both the SysV and Windows ABIs.
+
+#if defined(IREE_PLATFORM_WINDOWS)
+#define IREE_VM_JIT_X86_REGS_BASE 1  // rcx
+#else
+#define IREE_VM_JIT_X86_REGS_BASE 7  // rdi
+#endif  // IREE_PLATFORM_WINDOWS
+
+#define IREE_VM_JIT_X86_EAX 0
+#define IREE_VM_JIT_X86_EDX 2
+
+// Emits `[opcode] reg, dword [base + ordinal * 4]` using a disp32 ModRM.
+static void iree_vm_jit_x86_emit_mem(iree_vm_bytecode_jit_emitter_t* e,
+                                     uint8_t reg, uint16_t ordinal) {
+  iree_vm_jit_emit_u8(e, 0x80 | (reg << 3) | IREE_VM_JIT_X86_REGS_BASE);
+  iree_vm_jit_emit_u32(e, (uint32_t)ordinal * sizeof(int32_t));
+}
+
+static void iree_vm_jit_emit_prologue(iree_vm_bytecode_jit_emitter_t* e) {
+  // endbr64; a nop on processors without CET.
+  iree_vm_jit_emit_u32(e, 0xFA1E0FF3u);
+}
+
+static void iree_vm_jit_emit_exit(iree_vm_bytecode_jit_emitter_t* e,
+                                  uint32_t pc) {
+  iree_vm_jit_emit_u8(e, 0xB8);  // mov eax, imm32
+  iree_vm_jit_emit_u32(e, pc);
+  iree_vm_jit_emit_u8(e, 0xC3);  // ret
+}
+
+static void iree_vm_jit_x86_emit_load(iree_vm_bytecode_jit_emitter_t* e,
+                                      uint8_t reg, uint16_t ordinal) {
+  iree_vm_jit_emit_u8(e, 0x8B);  // mov reg, [base + disp32]
+  iree_vm_jit_x86_emit_mem(e, reg, ordinal);
+}
+
+static void iree_vm_jit_x86_emit_store(iree_vm_bytecode_jit_emitter_t* e,
+                                       uint16_t ordinal, uint8_t reg) {
+  iree_vm_jit_emit_u8(e, 0x89);  // mov [base + disp32], reg
+  iree_vm_jit_x86_emit_mem(e, reg, ordinal);
+}
+
+static void iree_vm_jit_emit_move_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                      uint16_t src, uint16_t dst) {
+  iree_vm_jit_x86_emit_load(e, IREE_VM_JIT_X86_EAX, src);
+  iree_vm_jit_x86_emit_store(e, dst, IREE_VM_JIT_X86_EAX);
+}
+
+static void iree_vm_jit_emit_const_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                       uint16_t result, int32_t value) {
+  iree_vm_jit_emit_u8(e, 0xC7);  // mov dword [base + disp32], imm32
+  iree_vm_jit_x86_emit_mem(e, 0, result);
+  iree_vm_jit_emit_u32(e, (uint32_t)value);
+}
+
+static void iree_vm_jit_emit_binary_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                        iree_vm_jit_binary_op_t op,
+                                        uint16_t lhs, uint16_t rhs,
+                                        uint16_t result) {
+  static const uint8_t kOpcodes[] = {
+      [IREE_VM_JIT_BINARY_OP_ADD] = 0x03, [IREE_VM_JIT_BINARY_OP_SUB] = 0x2B,
+      [IREE_VM_JIT_BINARY_OP_MUL] = 0xAF, [IREE_VM_JIT_BINARY_OP_AND] = 0x23,
+      [IREE_VM_JIT_BINARY_OP_OR] = 0x0B,  [IREE_VM_JIT_BINARY_OP_XOR] = 0x33,
+  };
+  iree_vm_jit_x86_emit_load(e, IREE_VM_JIT_X86_EAX, lhs);
+  if (op == IREE_VM_JIT_BINARY_OP_MUL) {
+    iree_vm_jit_emit_u8(e, 0x0F);  // imul eax, [base + disp32]
+  }
+  iree_vm_jit_emit_u8(e, kOpcodes[op]);
+  iree_vm_jit_x86_emit_mem(e, IREE_VM_JIT_X86_EAX, rhs);
+  iree_vm_jit_x86_emit_store(e, result, IREE_VM_JIT_X86_EAX);
+}
+
+// Sets flags for |lhs| compared to |rhs|.
+static void iree_vm_jit_emit_compare_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                         uint16_t lhs, uint16_t rhs) {
+  iree_vm_jit_x86_emit_load(e, IREE_VM_JIT_X86_EAX, lhs);
+  iree_vm_jit_emit_u8(e, 0x3B);  // cmp eax, [base + disp32]
+  iree_vm_jit_x86_emit_mem(e, IREE_VM_JIT_X86_EAX, rhs);
+}
+
+// Sets flags for |operand| compared to 0.
+static void iree_vm_jit_emit_test_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                      uint16_t operand) {
+  iree_vm_jit_x86_emit_load(e, IREE_VM_JIT_X86_EAX, operand);
+  iree_vm_jit_emit_u8(e, 0x85);  // test eax, eax
+  iree_vm_jit_emit_u8(e, 0xC0);
+}
+
+static const uint8_t kX86ConditionCodes[] = {
+    [IREE_VM_JIT_CONDITION_EQ] = 0x4,  [IREE_VM_JIT_CONDITION_NE] = 0x5,
+    [IREE_VM_JIT_CONDITION_LT] = 0xC,  [IREE_VM_JIT_CONDITION_GE] = 0xD,
+    [IREE_VM_JIT_CONDITION_LTU] = 0x2, [IREE_VM_JIT_CONDITION_GEU] = 0x3,
+};
+
+// Stores 1 to |result| if |condition| holds for the current flags and 0
+// otherwise.
+static void iree_vm_jit_emit_set_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                     iree_vm_jit_condition_t condition,
+                                     uint16_t result) {
+  iree_vm_jit_emit_u8(e, 0x0F);  // setcc al
+  iree_vm_jit_emit_u8(e, 0x90 | kX86ConditionCodes[condition]);
+  iree_vm_jit_emit_u8(e, 0xC0);
+  iree_vm_jit_emit_u8(e, 0x0F);  // movzx eax, al
+  iree_vm_jit_emit_u8(e, 0xB6);
+  iree_vm_jit_emit_u8(e, 0xC0);
+  iree_vm_jit_x86_emit_store(e, result, IREE_VM_JIT_X86_EAX);
+}
+
+static void iree_vm_jit_emit_select_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                        uint16_t condition, uint16_t true_value,
+                                        uint16_t false_value, uint16_t result) {
+  iree_vm_jit_x86_emit_load(e, IREE_VM_JIT_X86_EAX, false_value);
+  iree_vm_jit_x86_emit_load(e, IREE_VM_JIT_X86_EDX, condition);
+  iree_vm_jit_emit_u8(e, 0x85);  // test edx, edx
+  iree_vm_jit_emit_u8(e, 0xD2);
+  iree_vm_jit_emit_u8(e, 0x0F);  // cmovne eax, [base + disp32]
+  iree_vm_jit_emit_u8(e, 0x45);
+  iree_vm_jit_x86_emit_mem(e, IREE_VM_JIT_X86_EAX, true_value);
+  iree_vm_jit_x86_emit_store(e, result, IREE_VM_JIT_X86_EAX);
+}
+
+// Emits a jump taken if |condition| holds for the current flags with an
+// unresolved target and returns the site to pass to iree_vm_jit_patch_jump.
+static iree_host_size_t iree_vm_jit_emit_jump_if(
+    iree_vm_bytecode_jit_emitter_t* e, iree_vm_jit_condition_t condition) {
+  iree_vm_jit_emit_u8(e, 0x0F);  // jcc rel32
+  iree_vm_jit_emit_u8(e, 0x80 | kX86ConditionCodes[condition]);
+  iree_vm_jit_emit_u32(e, 0);
+  return e->offset;
+}
+
+// Resolves the jump emitted at |site| to the current offset.
+static void iree_vm_jit_patch_jump(iree_vm_bytecode_jit_emitter_t* e,
+                                   iree_host_size_t site) {
+  iree_vm_jit_patch_u32(e, site - 4, (uint32_t)(e->offset - site));
+}
+
+static void iree_vm_jit_emit_jump(iree_vm_bytecode_jit_emitter_t* e,
+                                  iree_host_size_t target_offset) {
+  iree_vm_jit_emit_u8(e, 0xE9);  // jmp rel32
+  int64_t displacement = (int64_t)target_offset - (int64_t)(e->offset + 4);
+  if (e->data && (displacement < INT32_MIN || displacement > INT32_MAX)) {
+    e->overflow = true;
+  }
+  iree_vm_jit_emit_u32(e, (uint32_t)displacement);
+}
+
+static bool iree_vm_jit_is_encodable_register(uint16_t ordinal) {
+  return true;
+}
+
+#elif defined(IREE_VM_BYTECODE_JIT_ARCH_ARM_64)
+
+//===----------------------------------------------------------------------===//
+// arm64 templates
+//===----------------------------------------------------------------------===//
+// The i32 register storage pointer arrives in x0 and stays there for the
+// lifetime of the function. w9-w11 are used as scratch.
+
+#define IREE_VM_JIT_ARM64_X0 0
+#define IREE_VM_JIT_ARM64_W9 9
+#define IREE_VM_JIT_ARM64_W10 10
+#define IREE_VM_JIT_ARM64_W11 11
+#define IREE_VM_JIT_ARM64_WZR 31
+
+static void iree_vm_jit_emit_prologue(iree_vm_bytecode_jit_emitter_t* e) {}
+
+static uint32_t iree_vm_jit_load_u32(iree_vm_bytecode_jit_emitter_t* e,
+                                     iree_host_size_t offset) {
+  return e->data ? iree_unaligned_load_le_u32((uint32_t*)&e->data[offset]) : 0;
+}
+
+// Emits `movz wd, #lo; movk wd, #hi, lsl #16`.
+static void iree_vm_jit_arm64_emit_mov_imm(iree_vm_bytecode_jit_emitter_t* e,
+                                           uint32_t rd, uint32_t value) {
+  iree_vm_jit_emit_u32(e, 0x52800000u | ((value & 0xFFFFu) << 5) | rd);
+  iree_vm_jit_emit_u32(e, 0x72A00000u | ((value >> 16) << 5) | rd);
+}
+
+static void iree_vm_jit_emit_exit(iree_vm_bytecode_jit_emitter_t* e,
+                                  uint32_t pc) {
+  iree_vm_jit_arm64_emit_mov_imm(e, IREE_VM_JIT_ARM64_X0, pc);
+  iree_vm_jit_emit_u32(e, 0xD65F03C0u);  // ret
+}
+
+static void iree_vm_jit_arm64_emit_load(iree_vm_bytecode_jit_emitter_t* e,
+                                        uint32_t rt, uint16_t ordinal) {
+  // ldr wt, [x0, #ordinal * 4]
+  iree_vm_jit_emit_u32(e, 0xB9400000u | ((uint32_t)ordinal << 10) |
+                              (IREE_VM_JIT_ARM64_X0 << 5) | rt);
+}
+
+static void iree_vm_jit_arm64_emit_store(iree_vm_bytecode_jit_emitter_t* e,
+                                         uint16_t ordinal, uint32_t rt) {
+  // str wt, [x0, #ordinal * 4]
+  iree_vm_jit_emit_u32(e, 0xB9000000u | ((uint32_t)ordinal << 10) |
+                              (IREE_VM_JIT_ARM64_X0 << 5) | rt);
+}
+
+static void iree_vm_jit_emit_move_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                      uint16_t src, uint16_t dst) {
+  iree_vm_jit_arm64_emit_load(e, IREE_VM_JIT_ARM64_W9, src);
+  iree_vm_jit_arm64_emit_store(e, dst, IREE_VM_JIT_ARM64_W9);
+}
+
+static void iree_vm_jit_emit_const_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                       uint16_t result, int32_t value) {
+  iree_vm_jit_arm64_emit_mov_imm(e, IREE_VM_JIT_ARM64_W9, (uint32_t)value);
+  iree_vm_jit_arm64_emit_store(e, result, IREE_VM_JIT_ARM64_W9);
+}
+
+static void iree_vm_jit_emit_binary_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                        iree_vm_jit_binary_op_t op,
+                                        uint16_t lhs, uint16_t rhs,
+                                        uint16_t result) {
+  static const uint32_t kOpcodes[] = {
+      [IREE_VM_JIT_BINARY_OP_ADD] = 0x0B000000u,  // add
+      [IREE_VM_JIT_BINARY_OP_SUB] = 0x4B000000u,  // sub
+      [IREE_VM_JIT_BINARY_OP_MUL] = 0x1B007C00u,  // madd ..., wzr
+      [IREE_VM_JIT_BINARY_OP_AND] = 0x0A000000u,  // and
+      [IREE_VM_JIT_BINARY_OP_OR] = 0x2A000000u,   // orr
+      [IREE_VM_JIT_BINARY_OP_XOR] = 0x4A000000u,  // eor
+  };
+  iree_vm_jit_arm64_emit_load(e, IREE_VM_JIT_ARM64_W9, lhs);
+  iree_vm_jit_arm64_emit_load(e, IREE_VM_JIT_ARM64_W10, rhs);
+  // op w9, w9, w10
+  iree_vm_jit_emit_u32(e, kOpcodes[op] | (IREE_VM_JIT_ARM64_W10 << 16) |
+                              (IREE_VM_JIT_ARM64_W9 << 5) |
+                              IREE_VM_JIT_ARM64_W9);
+  iree_vm_jit_arm64_emit_store(e, result, IREE_VM_JIT_ARM64_W9);
+}
+
+// Sets flags for |lhs| compared to |rhs|.
+static void iree_vm_jit_emit_compare_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                         uint16_t lhs, uint16_t rhs) {
+  iree_vm_jit_arm64_emit_load(e, IREE_VM_JIT_ARM64_W9, lhs);
+  iree_vm_jit_arm64_emit_load(e, IREE_VM_JIT_ARM64_W10, rhs);
+  // cmp w9, w10
+  iree_vm_jit_emit_u32(e, 0x6B000000u | (IREE_VM_JIT_ARM64_W10 << 16) |
+                              (IREE_VM_JIT_ARM64_W9 << 5) |
+                              IREE_VM_JIT_ARM64_WZR);
+}
+
+// Sets flags for |operand| compared to 0.
+static void iree_vm_jit_emit_test_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                      uint16_t operand) {
+  iree_vm_jit_arm64_emit_load(e, IREE_VM_JIT_ARM64_W9, operand);
+  // cmp w9, #0
+  iree_vm_jit_emit_u32(e, 0x7100001Fu | (IREE_VM_JIT_ARM64_W9 << 5));
+}
+
+static const uint32_t kArm64ConditionCodes[] = {
+    [IREE_VM_JIT_CONDITION_EQ] = 0x0,  [IREE_VM_JIT_CONDITION_NE] = 0x1,
+    [IREE_VM_JIT_CONDITION_LT] = 0xB,  [IREE_VM_JIT_CONDITION_GE] = 0xA,
+    [IREE_VM_JIT_CONDITION_LTU] = 0x3, [IREE_VM_JIT_CONDITION_GEU] = 0x2,
+};
+
+// Stores 1 to |result| if |condition| holds for the current flags and 0
+// otherwise.
+static void iree_vm_jit_emit_set_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                     iree_vm_jit_condition_t condition,
+                                     uint16_t result) {
+  // cset w9, cond == csinc w9, wzr, wzr, !cond
+  iree_vm_jit_emit_u32(e, 0x1A9F07E0u |
+                              ((kArm64ConditionCodes[condition] ^ 1) << 12) |
+                              IREE_VM_JIT_ARM64_W9);
+  iree_vm_jit_arm64_emit_store(e, result, IREE_VM_JIT_ARM64_W9);
+}
+
+static void iree_vm_jit_emit_select_i32(iree_vm_bytecode_jit_emitter_t* e,
+                                        uint16_t condition, uint16_t true_value,
+                                        uint16_t false_value, uint16_t result) {
+  iree_vm_jit_arm64_emit_load(e, IREE_VM_JIT_ARM64_W10, true_value);
+  iree_vm_jit_arm64_emit_load(e, IREE_VM_JIT_ARM64_W11, false_value);
+  iree_vm_jit_emit_test_i32(e, condition);
+  // csel w9, w10, w11, ne
+  iree_vm_jit_emit_u32(
+      e, 0x1A800000u | (IREE_VM_JIT_ARM64_W11 << 16) |
+             (kArm64ConditionCodes[IREE_VM_JIT_CONDITION_NE] << 12) |
+             (IREE_VM_JIT_ARM64_W10 << 5) | IREE_VM_JIT_ARM64_W9);
+  iree_vm_jit_arm64_emit_store(e, result, IREE_VM_JIT_ARM64_W9);
+}
+
+// Emits a jump taken if |condition| holds for the current flags with an
+// unresolved target and returns the site to pass to iree_vm_jit_patch_jump.
+static iree_host_size_t iree_vm_jit_emit_jump_if(
+    iree_vm_bytecode_jit_emitter_t* e, iree_vm_jit_condition_t condition) {
+  iree_host_size_t site = e->offset;
+  // b.cond #0
+  iree_vm_jit_emit_u32(e, 0x54000000u | kArm64ConditionCodes[condition]);
+  return site;
+}
+
+// Resolves the jump emitted at |site| to the current offset.
+static void iree_vm_jit_patch_jump(iree_vm_bytecode_jit_emitter_t* e,
+                                   iree_host_size_t site) {
+  // b.cond has a +-1MB range.
+  iree_host_size_t displacement = (e->offset - site) / 4;
+  if (e->data && displacement >= (1u << 18)) e->overflow = true;
+  iree_vm_jit_patch_u32(e, site,
+                        iree_vm_jit_load_u32(e, site) |
+                            (uint32_t)((displacement & 0x7FFFFu) << 5));
+}
+
+static void iree_vm_jit_emit_jump(iree_vm_bytecode_jit_emitter_t* e,
+                                  iree_host_size_t target_offset) {
+  // b has a +-128MB range.
+  int64_t displacement =
+      ((int64_t)target_offset - (int64_t)e->offset) / (int64_t)4;
+  if (e->data && (displacement < -(1 << 25) || displacement >= (1 << 25))) {
+    e->overflow = true;
+  }
+  iree_vm_jit_emit_u32(e, 0x14000000u | ((uint32_t)displacement & 0x3FFFFFFu));
+}
+
+static bool iree_vm_jit_is_encodable_register(uint16_t ordinal) {
+  // ldr/str take a 12-bit scaled unsigned offset.
+  return ordinal < 4096;
+}
+
+#endif  // IREE_VM_BYTECODE_JIT_ARCH_*
+
+//===----------------------------------------------------------------------===//
+// Function compilation
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_VM_BYTECODE_JIT_ARCH_X86_64) || \
+    defined(IREE_VM_BYTECODE_JIT_ARCH_ARM_64)
+
+// Decoders advancing |pc| matching the VM_Dec* utilities used by the
+// interpreter.
+static uint16_t iree_vm_jit_decode_reg(const uint8_t* bytecode_data,
+                                       uint32_t* pc,
+                                       iree_vm_bytecode_jit_emitter_t* e) {
+  uint16_t ordinal = iree_unaligned_load_le_u16((uint16_t*)&bytecode_data[*pc]);
+  *pc += IREE_REGISTER_ORDINAL_SIZE;
+  if (!iree_vm_jit_is_encodable_register(ordinal)) e->overflow = true;
+  return ordinal;
+}
+
+static uint32_t iree_vm_jit_decode_i32(const uint8_t* bytecode_data,
+                                       uint32_t* pc) {
+  uint32_t value = iree_unaligned_load_le_u32((uint32_t*)&bytecode_data[*pc]);
+  *pc += 4;
+  return value;
+}
+
+static const iree_vm_register_remap_list_t* iree_vm_jit_decode_remap_list(
+    const uint8_t* bytecode_data, uint32_t* pc) {
+  VM_AlignPC(*pc, IREE_REGISTER_ORDINAL_SIZE);
+  const iree_vm_register_remap_list_t* list =
+      (const iree_vm_register_remap_list_t*)&bytecode_data[*pc];
+  *pc += IREE_REGISTER_ORDINAL_SIZE +
+         list->size * 2 * IREE_REGISTER_ORDINAL_SIZE;
+  return list;
+}
+
+// Returns true if the remap list only contains i32 registers. Ref remapping
+// requires retain/release and is left to the interpreter.
+static bool iree_vm_jit_is_remap_list_supported(
+    const iree_vm_register_remap_list_t* list,
+    iree_vm_bytecode_jit_emitter_t* e) {
+  for (uint16_t i = 0; i < list->size; ++i) {
+    if (list->pairs[i].src_reg & IREE_REF_REGISTER_TYPE_BIT) return false;
+    if (!iree_vm_jit_is_encodable_register(list->pairs[i].src_reg) ||
+        !iree_vm_jit_is_encodable_register(list->pairs[i].dst_reg)) {
+      e->overflow = true;
+    }
+  }
+  return true;
+}
+
+// Returns the offset of the block starting at |block_pc| in the function code.
+static iree_status_t iree_vm_jit_lookup_block(
+    const iree_vm_bytecode_block_list_t* block_list,
+    const iree_host_size_t* block_offsets, uint32_t block_pc,
+    iree_host_size_t* out_offset) {
+  iree_host_size_t ordinal = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_block_list_find(block_list, block_pc, &ordinal));
+  *out_offset = block_offsets[ordinal];
+  return iree_ok_status();
+}
+
+// Emits the remapping moves of a branch edge followed by a jump to the target.
+// Matches iree_vm_bytecode_dispatch_remap_branch_registers.
+static iree_status_t iree_vm_jit_emit_branch_edge(
+    iree_vm_bytecode_jit_emitter_t* e,
+    const iree_vm_bytecode_block_list_t* block_list,
+    const iree_host_size_t* block_offsets, uint32_t block_pc,
+    const iree_vm_register_remap_list_t* remap_list) {
+  for (uint16_t i = 0; i < remap_list->size; ++i) {
+    iree_vm_jit_emit_move_i32(e, remap_list->pairs[i].src_reg,
+                              remap_list->pairs[i].dst_reg);
+  }
+  iree_host_size_t target_offset = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_jit_lookup_block(block_list, block_offsets,
+                                                block_pc, &target_offset));
+  iree_vm_jit_emit_jump(e, target_offset);
+  return iree_ok_status();
+}
+
+// Emits a two-way branch on |condition| (evaluated against the current flags).
+static iree_status_t iree_vm_jit_emit_cond_branch(
+    iree_vm_bytecode_jit_emitter_t* e,
+    const iree_vm_bytecode_block_list_t* block_list,
+    const iree_host_size_t* block_offsets, iree_vm_jit_condition_t condition,
+    uint32_t true_block_pc, const iree_vm_register_remap_list_t* true_remap,
+    uint32_t false_block_pc, const iree_vm_register_remap_list_t* false_remap) {
+  iree_host_size_t false_site = iree_vm_jit_emit_jump_if(e, condition ^ 1);
+  IREE_RETURN_IF_ERROR(iree_vm_jit_emit_branch_edge(
+      e, block_list, block_offsets, true_block_pc, true_remap));
+  iree_vm_jit_patch_jump(e, false_site);
+  return iree_vm_jit_emit_branch_edge(e, block_list, block_offsets,
+                                      false_block_pc, false_remap);
+}
+
+// Emits the ops of the block starting at |block_pc| up to and including its
+// terminator or the first op that must be interpreted.
+static iree_status_t iree_vm_jit_emit_block(
+    iree_vm_bytecode_jit_emitter_t* e, iree_const_byte_span_t bytecode_span,
+    const iree_vm_bytecode_block_list_t* block_list,
+    const iree_host_size_t* block_offsets, uint32_t block_pc) {
+  const uint8_t* bytecode_data = bytecode_span.data;
+  const uint32_t max_pc = (uint32_t)bytecode_span.data_length;
+  uint32_t pc = block_pc + 1;  // skip block marker
+  while (pc < max_pc) {
+    const uint32_t op_pc = pc++;
+    switch (bytecode_data[op_pc]) {
+      case IREE_VM_OP_CORE_ConstI32: {
+        int32_t value = (int32_t)iree_vm_jit_decode_i32(bytecode_data, &pc);
+        uint16_t result = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        iree_vm_jit_emit_const_i32(e, result, value);
+        break;
+      }
+      case IREE_VM_OP_CORE_ConstI32Zero: {
+        uint16_t result = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        iree_vm_jit_emit_const_i32(e, result, 0);
+        break;
+      }
+
+#define IREE_VM_JIT_BINARY_I32(op_name, binary_op)                        \
+  case IREE_VM_OP_CORE_##op_name: {                                       \
+    uint16_t lhs = iree_vm_jit_decode_reg(bytecode_data, &pc, e);         \
+    uint16_t rhs = iree_vm_jit_decode_reg(bytecode_data, &pc, e);         \
+    uint16_t result = iree_vm_jit_decode_reg(bytecode_data, &pc, e);      \
+    iree_vm_jit_emit_binary_i32(e, IREE_VM_JIT_BINARY_OP_##binary_op, lhs, \
+                                rhs, result);                             \
+    break;                                                                \
+  }
+        IREE_VM_JIT_BINARY_I32(AddI32, ADD)
+        IREE_VM_JIT_BINARY_I32(SubI32, SUB)
+        IREE_VM_JIT_BINARY_I32(MulI32, MUL)
+        IREE_VM_JIT_BINARY_I32(AndI32, AND)
+        IREE_VM_JIT_BINARY_I32(OrI32, OR)
+        IREE_VM_JIT_BINARY_I32(XorI32, XOR)
+#undef IREE_VM_JIT_BINARY_I32
+
+#define IREE_VM_JIT_CMP_I32(op_name, condition)                      \
+  case IREE_VM_OP_CORE_##op_name: {                                  \
+    uint16_t lhs = iree_vm_jit_decode_reg(bytecode_data, &pc, e);    \
+    uint16_t rhs = iree_vm_jit_decode_reg(bytecode_data, &pc, e);    \
+    uint16_t result = iree_vm_jit_decode_reg(bytecode_data, &pc, e); \
+    iree_vm_jit_emit_compare_i32(e, lhs, rhs);                       \
+    iree_vm_jit_emit_set_i32(e, IREE_VM_JIT_CONDITION_##condition,   \
+                             result);                                \
+    break;                                                           \
+  }
+        IREE_VM_JIT_CMP_I32(CmpEQI32, EQ)
+        IREE_VM_JIT_CMP_I32(CmpNEI32, NE)
+        IREE_VM_JIT_CMP_I32(CmpLTI32S, LT)
+        IREE_VM_JIT_CMP_I32(CmpLTI32U, LTU)
+#undef IREE_VM_JIT_CMP_I32
+
+      case IREE_VM_OP_CORE_CmpNZI32: {
+        uint16_t operand = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        uint16_t result = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        iree_vm_jit_emit_test_i32(e, operand);
+        iree_vm_jit_emit_set_i32(e, IREE_VM_JIT_CONDITION_NE, result);
+        break;
+      }
+      case IREE_VM_OP_CORE_SelectI32: {
+        uint16_t condition = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        uint16_t true_value = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        uint16_t false_value = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        uint16_t result = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        iree_vm_jit_emit_select_i32(e, condition, true_value, false_value,
+                                    result);
+        break;
+      }
+
+      case IREE_VM_OP_CORE_Branch: {
+        uint32_t target_pc = iree_vm_jit_decode_i32(bytecode_data, &pc);
+        const iree_vm_register_remap_list_t* remap_list =
+            iree_vm_jit_decode_remap_list(bytecode_data, &pc);
+        if (!iree_vm_jit_is_remap_list_supported(remap_list, e)) {
+          iree_vm_jit_emit_exit(e, op_pc);
+          return iree_ok_status();
+        }
+        return iree_vm_jit_emit_branch_edge(e, block_list, block_offsets,
+                                            target_pc, remap_list);
+      }
+      case IREE_VM_OP_CORE_CondBranch: {
+        uint16_t condition = iree_vm_jit_decode_reg(bytecode_data, &pc, e);
+        uint32_t true_pc = iree_vm_jit_decode_i32(bytecode_data, &pc);
+        const iree_vm_register_remap_list_t* true_remap =
+            iree_vm_jit_decode_remap_list(bytecode_data, &pc);
+        uint32_t false_pc = iree_vm_jit_decode_i32(bytecode_data, &pc);
+        const iree_vm_register_remap_list_t* false_remap =
+            iree_vm_jit_decode_remap_list(bytecode_data, &pc);
+        if (!iree_vm_jit_is_remap_list_supported(true_remap, e) ||
+            !iree_vm_jit_is_remap_list_supported(false_remap, e)) {
+          iree_vm_jit_emit_exit(e, op_pc);
+          return iree_ok_status();
+        }
+        iree_vm_jit_emit_test_i32(e, condition);
+        return iree_vm_jit_emit_cond_branch(
+            e, block_list, block_offsets, IREE_VM_JIT_CONDITION_NE, true_pc,
+            true_remap, false_pc, false_remap);
+      }
+
+#define IREE_VM_JIT_COND_BRANCH_CMP_I32(op_name, condition)                  \
+  case IREE_VM_OP_CORE_##op_name: {                                          \
+    uint16_t lhs = iree_vm_jit_decode_reg(bytecode_data, &pc, e);            \
+    uint16_t rhs = iree_vm_jit_decode_reg(bytecode_data, &pc, e);            \
+    uint32_t true_pc = iree_vm_jit_decode_i32(bytecode_data, &pc);           \
+    const iree_vm_register_remap_list_t* true_remap =                        \
+        iree_vm_jit_decode_remap_list(bytecode_data, &pc);                   \
+    uint32_t false_pc = iree_vm_jit_decode_i32(bytecode_data, &pc);          \
+    const iree_vm_register_remap_list_t* false_remap =                       \
+        iree_vm_jit_decode_remap_list(bytecode_data, &pc);                   \
+    if (!iree_vm_jit_is_remap_list_supported(true_remap, e) ||               \
+        !iree_vm_jit_is_remap_list_supported(false_remap, e)) {              \
+      iree_vm_jit_emit_exit(e, op_pc);                                       \
+      return iree_ok_status();                                               \
+    }                                                                        \
+    iree_vm_jit_emit_compare_i32(e, lhs, rhs);                               \
+    return iree_vm_jit_emit_cond_branch(                                     \
+        e, block_list, block_offsets, IREE_VM_JIT_CONDITION_##condition,     \
+        true_pc, true_remap, false_pc, false_remap);                         \
+  }
+        IREE_VM_JIT_COND_BRANCH_CMP_I32(CondBranchCmpEQI32, EQ)
+        IREE_VM_JIT_COND_BRANCH_CMP_I32(CondBranchCmpNEI32, NE)
+        IREE_VM_JIT_COND_BRANCH_CMP_I32(CondBranchCmpLTI32S, LT)
+        IREE_VM_JIT_COND_BRANCH_CMP_I32(CondBranchCmpLTI32U, LTU)
+#undef IREE_VM_JIT_COND_BRANCH_CMP_I32
+
+      default:
+        // Everything else is handled by the interpreter.
+        iree_vm_jit_emit_exit(e, op_pc);
+        return iree_ok_status();
+    }
+  }
+  // Verified functions always end blocks with a terminator.
+  return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                          "block at pc %08X missing terminator", block_pc);
+}
+
+// Emits all blocks of the function. When |block_offsets| is NULL the layout is
+// measured and the offset of each block is stored in |out_block_offsets|.
+static iree_status_t iree_vm_jit_emit_function(
+    iree_vm_bytecode_jit_emitter_t* e, iree_const_byte_span_t bytecode_span,
+    const iree_vm_bytecode_block_list_t* block_list,
+    const iree_host_size_t* block_offsets,
+    iree_host_size_t* out_block_offsets) {
+  if (!block_offsets) block_offsets = out_block_offsets;
+  iree_vm_jit_emit_prologue(e);
+  for (uint32_t i = 0; i < block_list->count; ++i) {
+    if (out_block_offsets) out_block_offsets[i] = e->offset;
+    IREE_RETURN_IF_ERROR(iree_vm_jit_emit_block(
+        e, bytecode_span, block_list, block_offsets, block_list->values[i].pc));
+  }
+  return iree_ok_status();
+}
+
+// Returns true if the first op of the entry block would run natively.
+static bool iree_vm_jit_is_entry_op_supported(
+    iree_const_byte_span_t bytecode_span) {
+  if (bytecode_span.data_length < 2) return false;
+  switch (bytecode_span.data[1]) {
+    case IREE_VM_OP_CORE_ConstI32:
+    case IREE_VM_OP_CORE_ConstI32Zero:
+    case IREE_VM_OP_CORE_AddI32:
+    case IREE_VM_OP_CORE_SubI32:
+    case IREE_VM_OP_CORE_MulI32:
+    case IREE_VM_OP_CORE_AndI32:
+    case IREE_VM_OP_CORE_OrI32:
+    case IREE_VM_OP_CORE_XorI32:
+    case IREE_VM_OP_CORE_CmpEQI32:
+    case IREE_VM_OP_CORE_CmpNEI32:
+    case IREE_VM_OP_CORE_CmpLTI32S:
+    case IREE_VM_OP_CORE_CmpLTI32U:
+    case IREE_VM_OP_CORE_CmpNZI32:
+    case IREE_VM_OP_CORE_SelectI32:
+    case IREE_VM_OP_CORE_Branch:
+    case IREE_VM_OP_CORE_CondBranch:
+    case IREE_VM_OP_CORE_CondBranchCmpEQI32:
+    case IREE_VM_OP_CORE_CondBranchCmpNEI32:
+    case IREE_VM_OP_CORE_CondBranchCmpLTI32S:
+    case IREE_VM_OP_CORE_CondBranchCmpLTI32U:
+      return true;
+    default:
+      return false;
+  }
+}
+
+#endif  // IREE_VM_BYTECODE_JIT_ARCH_*
+
+//===----------------------------------------------------------------------===//
+// iree_vm_bytecode_jit_t
+//===----------------------------------------------------------------------===//
+
+bool iree_vm_bytecode_jit_is_supported(void) {
+#if defined(IREE_VM_BYTECODE_JIT_ARCH_X86_64) || \
+    defined(IREE_VM_BYTECODE_JIT_ARCH_ARM_64)
+  return (iree_memory_query_info().supported_features &
+          IREE_MEMORY_FEATURE_ALLOCATABLE_EXECUTABLE_PAGES) != 0;
+#else
+  return false;
+#endif  // IREE_VM_BYTECODE_JIT_ARCH_*
+}
+
+iree_status_t iree_vm_bytecode_jit_initialize(
+    iree_host_size_t function_count, iree_allocator_t host_allocator,
+    iree_vm_bytecode_jit_t* out_jit) {
+  IREE_ASSERT_ARGUMENT(out_jit);
+  memset(out_jit, 0, sizeof(*out_jit));
+  out_jit->host_allocator = host_allocator;
+  out_jit->function_count = function_count;
+  if (function_count == 0) return iree_ok_status();
+
+  // Entry pointers and offsets share a single allocation.
+  iree_host_size_t table_size =
+      function_count * sizeof(out_jit->entry_table[0]);
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator,
+      table_size + function_count * sizeof(out_jit->entry_offsets[0]),
+      (void**)&out_jit->entry_table));
+  out_jit->entry_offsets =
+      (iree_host_size_t*)((uint8_t*)out_jit->entry_table + table_size);
+  for (iree_host_size_t i = 0; i < function_count; ++i) {
+    out_jit->entry_offsets[i] = IREE_HOST_SIZE_MAX;
+  }
+  return iree_ok_status();
+}
+
+void iree_vm_bytecode_jit_deinitialize(iree_vm_bytecode_jit_t* jit) {
+  if (!jit) return;
+  iree_memory_executable_free(jit->code_base, jit->code_size);
+  iree_allocator_free(jit->host_allocator, jit->staging_data);
+  iree_allocator_free(jit->host_allocator, jit->entry_table);
+  memset(jit, 0, sizeof(*jit));
+}
+
+iree_status_t iree_vm_bytecode_jit_compile_function(
+    iree_vm_bytecode_jit_t* jit, uint16_t function_ordinal,
+    iree_const_byte_span_t bytecode_data,
+    const iree_vm_bytecode_block_list_t* block_list) {
+  IREE_ASSERT_ARGUMENT(jit);
+  IREE_ASSERT_ARGUMENT(block_list);
+  if (function_ordinal >= jit->function_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "function ordinal %u out of range",
+                            function_ordinal);
+  }
+  if (jit->code_base) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "code already finalized");
+  }
+#if defined(IREE_VM_BYTECODE_JIT_ARCH_X86_64) || \
+    defined(IREE_VM_BYTECODE_JIT_ARCH_ARM_64)
+  if (block_list->count == 0 || block_list->values[0].pc != 0 ||
+      !iree_vm_jit_is_entry_op_supported(bytecode_data)) {
+    // Nothing would run natively before returning to the interpreter.
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t* block_offsets = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(jit->host_allocator,
+                                block_list->count * sizeof(block_offsets[0]),
+                                (void**)&block_offsets));
+
+  // Measure the code size and block layout.
+  iree_vm_bytecode_jit_emitter_t measure = {0};
+  iree_status_t status = iree_vm_jit_emit_function(
+      &measure, bytecode_data, block_list, NULL, block_offsets);
+
+  // Grow the staging buffer to fit the function.
+  iree_host_size_t function_offset = jit->staging_size;
+  if (iree_status_is_ok(status) && !measure.overflow &&
+      function_offset + measure.offset > jit->staging_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(jit->staging_capacity * 2, function_offset + measure.offset);
+    status = iree_allocator_realloc(jit->host_allocator, new_capacity,
+                                    (void**)&jit->staging_data);
+    if (iree_status_is_ok(status)) jit->staging_capacity = new_capacity;
+  }
+
+  // Emit the code with all block offsets known.
+  if (iree_status_is_ok(status) && !measure.overflow) {
+    iree_vm_bytecode_jit_emitter_t emitter = {
+        .data = jit->staging_data + function_offset,
+    };
+    status = iree_vm_jit_emit_function(&emitter, bytecode_data, block_list,
+                                       block_offsets, NULL);
+    if (iree_status_is_ok(status) && !emitter.overflow) {
+      IREE_ASSERT_EQ(emitter.offset, measure.offset);
+      jit->entry_offsets[function_ordinal] = function_offset;
+      jit->staging_size += emitter.offset;
+    }
+  }
+
+  iree_allocator_free(jit->host_allocator, block_offsets);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_ok_status();
+#endif  // IREE_VM_BYTECODE_JIT_ARCH_*
+}
+
+iree_status_t iree_vm_bytecode_jit_finalize(iree_vm_bytecode_jit_t* jit) {
+  IREE_ASSERT_ARGUMENT(jit);
+  if (!jit->staging_size) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, jit->staging_size);
+
+  iree_host_size_t code_size = iree_host_align(
+      jit->staging_size, iree_memory_query_info().normal_page_size);
+  void* code_base = NULL;
+  iree_status_t status =
+      iree_memory_executable_allocate(code_size, &code_base);
+  if (iree_status_is_ok(status)) {
+    iree_memory_jit_context_begin();
+    memcpy(code_base, jit->staging_data, jit->staging_size);
+    iree_memory_jit_context_end();
+    status = iree_memory_executable_seal(code_base, code_size);
+  }
+  if (iree_status_is_ok(status)) {
+    jit->code_base = code_base;
+    jit->code_size = code_size;
+    for (iree_host_size_t i = 0; i < jit->function_count; ++i) {
+      if (jit->entry_offsets[i] == IREE_HOST_SIZE_MAX) continue;
+      jit->entry_table[i] = (iree_vm_bytecode_jit_entry_fn_t)(
+          (uintptr_t)code_base + jit->entry_offsets[i]);
+    }
+  } else {
+    // Executable pages may be unavailable on the platform or denied by the
+    // process policy (hardened runtimes, SELinux execmem, etc). Native code is
+    // only an optimization and all functions remain interpretable.
+    IREE_TRACE_ZONE_APPEND_TEXT(
+        z0, iree_status_code_string(iree_status_code(status)));
+    iree_status_ignore(status);
+    status = iree_ok_status();
+    iree_memory_executable_free(code_base, code_size);
+  }
+
+  // Staging code is no longer needed.
+  iree_allocator_free(jit->host_allocator, jit->staging_data);
+  jit->staging_data = NULL;
+  jit->staging_capacity = 0;
+  jit->staging_size = 0;
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
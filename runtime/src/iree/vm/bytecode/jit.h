@@ -0,0 +1,101 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_BYTECODE_JIT_H_
+#define IREE_VM_BYTECODE_JIT_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/bytecode/utils/block_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Bytecode template compiler
+//===----------------------------------------------------------------------===//
+// Translates verified bytecode functions into native host code by copying
+// fixed machine code templates per op and patching in register offsets,
+// immediates, and branch displacements. The generated code operates directly
+// on the i32 register storage of the interpreter frame so control can move
+// between native code and the interpreter at any op boundary without any state
+// translation.
+//
+// Only integer arithmetic, comparison, and intra-function control flow ops are
+// compiled. Any other op (calls, returns, ref ops, etc) becomes an exit that
+// returns the pc of the op to the interpreter which then continues execution
+// from there. Native code is only entered at the start of a function.
+//
+// NOTE: the compiler trusts the bytecode and must only be used on functions
+// that have passed iree_vm_bytecode_function_verify.
+
+// Native entry point of a compiled function. Executes from the op following the
+// entry block marker and returns the pc of the first op that must be handled by
+// the interpreter. |regs_i32| is the i32 register storage of the frame.
+typedef uint32_t (*iree_vm_bytecode_jit_entry_fn_t)(int32_t* regs_i32);
+
+// Native code for all compiled functions in a module.
+typedef struct iree_vm_bytecode_jit_t {
+  // Allocator used for the tables and staging storage.
+  iree_allocator_t host_allocator;
+
+  // Number of functions in the module and the compiled entry points of each.
+  // Entries are NULL for functions that were not compiled or until
+  // iree_vm_bytecode_jit_finalize has been called.
+  iree_host_size_t function_count;
+  iree_vm_bytecode_jit_entry_fn_t* entry_table;
+  // Offsets of each function entry in the code, or IREE_HOST_SIZE_MAX if the
+  // function was not compiled.
+  iree_host_size_t* entry_offsets;
+
+  // Position-independent code emitted for all functions prior to finalization.
+  uint8_t* staging_data;
+  iree_host_size_t staging_capacity;
+  iree_host_size_t staging_size;
+
+  // Sealed executable pages containing the code after finalization.
+  void* code_base;
+  iree_host_size_t code_size;
+} iree_vm_bytecode_jit_t;
+
+// Returns true if the template compiler can generate code for the host.
+bool iree_vm_bytecode_jit_is_supported(void);
+
+// Initializes |out_jit| for a module with |function_count| functions.
+iree_status_t iree_vm_bytecode_jit_initialize(
+    iree_host_size_t function_count, iree_allocator_t host_allocator,
+    iree_vm_bytecode_jit_t* out_jit);
+
+// Releases the code and tables owned by |jit|.
+void iree_vm_bytecode_jit_deinitialize(iree_vm_bytecode_jit_t* jit);
+
+// Compiles the function |function_ordinal| with the given |bytecode_data| into
+// the staging code. |block_list| must contain every block in the function as
+// produced by the verifier. Functions that would not execute any ops natively
+// are skipped.
+iree_status_t iree_vm_bytecode_jit_compile_function(
+    iree_vm_bytecode_jit_t* jit, uint16_t function_ordinal,
+    iree_const_byte_span_t bytecode_data,
+    const iree_vm_bytecode_block_list_t* block_list);
+
+// Copies all staged code into executable pages and populates the entry table.
+// If executable pages cannot be allocated or sealed (the platform or process
+// policy does not allow them) no functions will have native code and the
+// module will run entirely in the interpreter.
+iree_status_t iree_vm_bytecode_jit_finalize(iree_vm_bytecode_jit_t* jit);
+
+// Returns the native entry point of |function_ordinal| or NULL if the function
+// must be interpreted.
+static inline iree_vm_bytecode_jit_entry_fn_t iree_vm_bytecode_jit_lookup(
+    const iree_vm_bytecode_jit_t* jit, uint16_t function_ordinal) {
+  return jit->entry_table ? jit->entry_table[function_ordinal] : NULL;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_BYTECODE_JIT_H_
@@ -0,0 +1,265 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode/jit.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Builds function bytecode matching the encoding produced by the compiler.
+class BytecodeBuilder {
+ public:
+  uint32_t pc() const { return static_cast<uint32_t>(data_.size()); }
+
+  // Starts a new block and returns its pc.
+  uint32_t Block() {
+    uint32_t block_pc = pc();
+    block_pcs_.push_back(block_pc);
+    Op(IREE_VM_OP_CORE_Block);
+    return block_pc;
+  }
+
+  void Op(uint8_t opcode) { data_.push_back(opcode); }
+
+  void Reg(uint16_t ordinal) {
+    data_.push_back(ordinal & 0xFF);
+    data_.push_back(ordinal >> 8);
+  }
+
+  // Appends a 32-bit value and returns its offset for patching.
+  uint32_t I32(uint32_t value) {
+    uint32_t offset = pc();
+    for (int i = 0; i < 4; ++i) data_.push_back((value >> (i * 8)) & 0xFF);
+    return offset;
+  }
+
+  void PatchI32(uint32_t offset, uint32_t value) {
+    for (int i = 0; i < 4; ++i) data_[offset + i] = (value >> (i * 8)) & 0xFF;
+  }
+
+  void RemapList(std::vector<std::pair<uint16_t, uint16_t>> pairs = {}) {
+    if (pc() % 2) data_.push_back(0);
+    Reg(static_cast<uint16_t>(pairs.size()));
+    for (auto& pair : pairs) {
+      Reg(pair.first);
+      Reg(pair.second);
+    }
+  }
+
+  void Binary(uint8_t opcode, uint16_t lhs, uint16_t rhs, uint16_t result) {
+    Op(opcode);
+    Reg(lhs);
+    Reg(rhs);
+    Reg(result);
+  }
+
+  iree_const_byte_span_t span() const {
+    return iree_make_const_byte_span(data_.data(), data_.size());
+  }
+
+  // Populates |block_list| as the verifier would for the function.
+  void BuildBlockList(iree_vm_bytecode_block_list_t* block_list) {
+    IREE_ASSERT_OK(iree_vm_bytecode_block_list_initialize(
+        static_cast<uint32_t>(block_pcs_.size()), iree_allocator_system(),
+        block_list));
+    for (uint32_t block_pc : block_pcs_) {
+      iree_vm_bytecode_block_t* block = NULL;
+      IREE_ASSERT_OK(
+          iree_vm_bytecode_block_list_insert(block_list, block_pc, &block));
+      block->defined = 1;
+    }
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+  std::vector<uint32_t> block_pcs_;
+};
+
+class JitTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!iree_vm_bytecode_jit_is_supported()) {
+      GTEST_SKIP() << "template compiler not supported on this host";
+    }
+  }
+
+  // Compiles |functions| as a module and returns the native entry points.
+  std::vector<iree_vm_bytecode_jit_entry_fn_t> Compile(
+      std::vector<BytecodeBuilder*> functions) {
+    IREE_CHECK_OK(iree_vm_bytecode_jit_initialize(
+        functions.size(), iree_allocator_system(), &jit_));
+    initialized_ = true;
+    for (size_t i = 0; i < functions.size(); ++i) {
+      iree_vm_bytecode_block_list_t block_list;
+      functions[i]->BuildBlockList(&block_list);
+      IREE_CHECK_OK(iree_vm_bytecode_jit_compile_function(
+          &jit_, static_cast<uint16_t>(i), functions[i]->span(), &block_list));
+      iree_vm_bytecode_block_list_deinitialize(&block_list,
+                                               iree_allocator_system());
+    }
+    IREE_CHECK_OK(iree_vm_bytecode_jit_finalize(&jit_));
+    std::vector<iree_vm_bytecode_jit_entry_fn_t> entries;
+    for (size_t i = 0; i < functions.size(); ++i) {
+      entries.push_back(
+          iree_vm_bytecode_jit_lookup(&jit_, static_cast<uint16_t>(i)));
+    }
+    return entries;
+  }
+
+  void TearDown() override {
+    if (initialized_) iree_vm_bytecode_jit_deinitialize(&jit_);
+  }
+
+  iree_vm_bytecode_jit_t jit_;
+  bool initialized_ = false;
+};
+
+// Loops summing 0..N-1 with the fused compare-and-branch op. Exits to the
+// interpreter at the return.
+TEST_F(JitTest, LoopSum) {
+  // r0 = N, r1 = i, r2 = sum, r3 = 1
+  BytecodeBuilder b;
+  b.Block();
+  b.Op(IREE_VM_OP_CORE_ConstI32Zero);
+  b.Reg(1);
+  b.Op(IREE_VM_OP_CORE_ConstI32Zero);
+  b.Reg(2);
+  b.Op(IREE_VM_OP_CORE_ConstI32);
+  b.I32(1);
+  b.Reg(3);
+  b.Op(IREE_VM_OP_CORE_Branch);
+  uint32_t entry_target = b.I32(0);
+  b.RemapList();
+  uint32_t loop_pc = b.Block();
+  b.PatchI32(entry_target, loop_pc);
+  b.Op(IREE_VM_OP_CORE_CondBranchCmpLTI32S);
+  b.Reg(1);
+  b.Reg(0);
+  uint32_t body_target = b.I32(0);
+  b.RemapList();
+  uint32_t exit_target = b.I32(0);
+  b.RemapList();
+  uint32_t body_pc = b.Block();
+  b.PatchI32(body_target, body_pc);
+  b.Binary(IREE_VM_OP_CORE_AddI32, 2, 1, 2);
+  b.Binary(IREE_VM_OP_CORE_AddI32, 1, 3, 1);
+  b.Op(IREE_VM_OP_CORE_Branch);
+  b.I32(loop_pc);
+  b.RemapList();
+  uint32_t exit_pc = b.Block();
+  b.PatchI32(exit_target, exit_pc);
+  uint32_t return_pc = b.pc();
+  b.Op(IREE_VM_OP_CORE_Return);
+
+  auto entries = Compile({&b});
+  ASSERT_NE(entries[0], nullptr);
+  alignas(16) int32_t regs[4] = {10, -1, -1, -1};
+  EXPECT_EQ(entries[0](regs), return_pc);
+  EXPECT_EQ(regs[1], 10);
+  EXPECT_EQ(regs[2], 45);
+}
+
+// Straight-line integer ops up to an op the interpreter must handle.
+TEST_F(JitTest, Arithmetic) {
+  BytecodeBuilder b;
+  b.Block();
+  b.Binary(IREE_VM_OP_CORE_MulI32, 0, 1, 2);
+  b.Binary(IREE_VM_OP_CORE_SubI32, 1, 0, 3);
+  b.Binary(IREE_VM_OP_CORE_AndI32, 0, 1, 4);
+  b.Binary(IREE_VM_OP_CORE_OrI32, 0, 1, 5);
+  b.Binary(IREE_VM_OP_CORE_XorI32, 0, 1, 6);
+  b.Binary(IREE_VM_OP_CORE_CmpLTI32S, 3, 0, 7);
+  b.Binary(IREE_VM_OP_CORE_CmpLTI32U, 3, 0, 8);
+  b.Binary(IREE_VM_OP_CORE_CmpEQI32, 0, 0, 9);
+  b.Binary(IREE_VM_OP_CORE_CmpNEI32, 0, 0, 10);
+  b.Op(IREE_VM_OP_CORE_CmpNZI32);
+  b.Reg(3);
+  b.Reg(11);
+  b.Op(IREE_VM_OP_CORE_SelectI32);
+  b.Reg(10);
+  b.Reg(0);
+  b.Reg(1);
+  b.Reg(12);
+  uint32_t return_pc = b.pc();
+  b.Op(IREE_VM_OP_CORE_Return);
+
+  auto entries = Compile({&b});
+  ASSERT_NE(entries[0], nullptr);
+  alignas(16) int32_t regs[16] = {7, 3};
+  EXPECT_EQ(entries[0](regs), return_pc);
+  EXPECT_EQ(regs[2], 21);
+  EXPECT_EQ(regs[3], -4);
+  EXPECT_EQ(regs[4], 7 & 3);
+  EXPECT_EQ(regs[5], 7 | 3);
+  EXPECT_EQ(regs[6], 7 ^ 3);
+  EXPECT_EQ(regs[7], 1);  // -4 < 7 signed
+  EXPECT_EQ(regs[8], 0);  // 0xFFFFFFFC > 7 unsigned
+  EXPECT_EQ(regs[9], 1);
+  EXPECT_EQ(regs[10], 0);
+  EXPECT_EQ(regs[11], 1);
+  EXPECT_EQ(regs[12], 3);
+}
+
+// Branch edges apply their i32 register remapping. Edges remapping refs exit to
+// the interpreter before any remapping occurs.
+TEST_F(JitTest, CondBranchRemap) {
+  BytecodeBuilder b;
+  b.Block();
+  b.Op(IREE_VM_OP_CORE_CondBranch);
+  b.Reg(0);
+  uint32_t true_target = b.I32(0);
+  b.RemapList({{1, 3}, {2, 4}});
+  uint32_t false_target = b.I32(0);
+  b.RemapList({{2, 3}});
+  uint32_t true_pc = b.Block();
+  b.PatchI32(true_target, true_pc);
+  uint32_t true_return_pc = b.pc();
+  b.Op(IREE_VM_OP_CORE_Return);
+  uint32_t false_pc = b.Block();
+  b.PatchI32(false_target, false_pc);
+  uint32_t ref_branch_pc = b.pc();
+  b.Op(IREE_VM_OP_CORE_Branch);
+  b.I32(true_pc);
+  b.RemapList({{IREE_REF_REGISTER_TYPE_BIT | 0, IREE_REF_REGISTER_TYPE_BIT}});
+
+  auto entries = Compile({&b});
+  ASSERT_NE(entries[0], nullptr);
+
+  alignas(16) int32_t true_regs[8] = {1, 10, 20, 0, 0};
+  EXPECT_EQ(entries[0](true_regs), true_return_pc);
+  EXPECT_EQ(true_regs[3], 10);
+  EXPECT_EQ(true_regs[4], 20);
+
+  alignas(16) int32_t false_regs[8] = {0, 10, 20, 0, 0};
+  EXPECT_EQ(entries[0](false_regs), ref_branch_pc);
+  EXPECT_EQ(false_regs[3], 20);
+  EXPECT_EQ(false_regs[4], 0);
+}
+
+// Functions that would immediately return to the interpreter are not compiled.
+TEST_F(JitTest, UnsupportedEntry) {
+  BytecodeBuilder interpreted;
+  interpreted.Block();
+  interpreted.Op(IREE_VM_OP_CORE_Return);
+  BytecodeBuilder compiled;
+  compiled.Block();
+  compiled.Op(IREE_VM_OP_CORE_ConstI32Zero);
+  compiled.Reg(0);
+  compiled.Op(IREE_VM_OP_CORE_Return);
+
+  auto entries = Compile({&interpreted, &compiled});
+  EXPECT_EQ(entries[0], nullptr);
+  EXPECT_NE(entries[1], nullptr);
+}
+
+}  // namespace
@@ -152,6 +152,13 @@ static void iree_vm_bytecode_module_destroy(void* self) {
     iree_vm_buffer_deinitialize(ref);
   }
 
+#if IREE_VM_BYTECODE_JIT_ENABLE
+  iree_vm_bytecode_jit_deinitialize(&module->jit);
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  iree_vm_bytecode_profile_free(module->profile);
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
   module->def = NULL;
   iree_allocator_free(module->archive_allocator,
                       (void*)module->archive_contents.data);
@@ -460,6 +467,10 @@ static iree_status_t iree_vm_bytecode_location_format(
           (iree_vm_CallSiteLocDef_table_t)location.value;
       IREE_RETURN_IF_ERROR(iree_vm_bytecode_location_format(
           iree_vm_CallSiteLocDef_callee(loc), location_table, flags, builder));
+      if (iree_all_bits_set(flags,
+                            IREE_VM_SOURCE_LOCATION_FORMAT_FLAG_SINGLE_LINE)) {
+        return iree_ok_status();
+      }
       IREE_RETURN_IF_ERROR(
           iree_string_builder_append_cstring(builder, "\n      at "));
       return iree_vm_bytecode_location_format(
@@ -483,8 +494,18 @@ static iree_status_t iree_vm_bytecode_location_format(
             builder, "<%.*s>", (int)flatbuffers_string_len(metadata),
             metadata));
       }
-      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "[\n"));
       flatbuffers_int32_vec_t child_locs = iree_vm_FusedLocDef_locations(loc);
+      if (iree_all_bits_set(flags,
+                            IREE_VM_SOURCE_LOCATION_FORMAT_FLAG_SINGLE_LINE)) {
+        // Only the first (primary) location of the fusion is printed.
+        if (flatbuffers_int32_vec_len(child_locs) == 0) {
+          return iree_string_builder_append_cstring(builder, "[unknown]");
+        }
+        return iree_vm_bytecode_location_format(
+            flatbuffers_int32_vec_at(child_locs, 0), location_table, flags,
+            builder);
+      }
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "[\n"));
       for (size_t i = 0; i < flatbuffers_int32_vec_len(child_locs); ++i) {
         if (i == 0) {
           IREE_RETURN_IF_ERROR(
@@ -661,6 +682,9 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
 
   // Perform layout to get the pointers into the storage for each nested table.
   iree_vm_bytecode_module_layout_state(module_def, state);
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  state->profile = module->profile;
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
 
   *out_module_state = (iree_vm_module_state_t*)state;
   IREE_TRACE_ZONE_END(z0);
@@ -685,6 +709,44 @@ static void iree_vm_bytecode_module_free_state(
   IREE_TRACE_ZONE_END(z0);
 }
 
+static iree_status_t iree_vm_bytecode_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  IREE_ASSERT_ARGUMENT(parent_state);
+  IREE_ASSERT_ARGUMENT(out_module_state);
+  *out_module_state = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_bytecode_module_state_t* parent =
+      (iree_vm_bytecode_module_state_t*)parent_state;
+  iree_vm_bytecode_module_state_t* state = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_module_alloc_state(
+              self, allocator, (iree_vm_module_state_t**)&state));
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, state->rwdata_storage.data_length);
+
+  // rwdata is the only mutable non-ref storage and is copied wholesale.
+  // Constant data (rodata) lives in the module and is already shared.
+  memcpy(state->rwdata_storage.data, parent->rwdata_storage.data,
+         state->rwdata_storage.data_length);
+
+  // Ref globals get their own slots but reference the same objects as the
+  // parent. Immutable globals such as executables are shared this way.
+  for (iree_host_size_t i = 0; i < state->global_ref_count; ++i) {
+    iree_vm_ref_retain(&parent->global_ref_table[i],
+                       &state->global_ref_table[i]);
+  }
+
+  // Resolved imports reference functions on modules and not module states so
+  // they are valid in any context with the same module registration.
+  memcpy(state->import_table, parent->import_table,
+         state->import_count * sizeof(*state->import_table));
+
+  *out_module_state = (iree_vm_module_state_t*)state;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -727,6 +789,10 @@ static iree_status_t iree_vm_bytecode_module_resolve_import(
   import->argument_buffer_size = (uint16_t)argument_buffer_size;
   import->result_buffer_size = (uint16_t)result_buffer_size;
 
+  // Calls into native modules can skip the begin_call indirection as we
+  // already marshal arguments and results per the verified signature.
+  iree_vm_native_module_resolve_direct_call(function, &import->direct_call);
+
   return iree_ok_status();
 }
 
@@ -788,10 +854,60 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
   return iree_vm_bytecode_dispatch_resume(stack, module, call_results);  // tail
 }
 
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+iree_status_t iree_vm_bytecode_module_verify_function_lazy(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_vm_bytecode_function_verify");
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, function_ordinal);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_function_verify(module, function_ordinal,
+                                           module->allocator, NULL));
+  iree_atomic_fetch_or_int32(&module->verified_bitmap[function_ordinal / 32],
+                             (int32_t)(1u << (function_ordinal % 32)),
+                             iree_memory_order_release);
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module) {
+  return iree_vm_bytecode_module_create_with_flags(
+      instance, IREE_VM_BYTECODE_MODULE_FLAG_NONE, archive_contents,
+      archive_allocator, allocator, out_module);
+}
+
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+// Allocates the execution profile counters for |module|.
+static iree_status_t iree_vm_bytecode_module_allocate_profile(
+    iree_vm_bytecode_module_t* module) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_host_size_t function_count = module->function_descriptor_count;
+  uint32_t* block_counts = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(module->allocator,
+                                iree_max(1, function_count) * sizeof(uint32_t),
+                                (void**)&block_counts));
+  for (iree_host_size_t i = 0; i < function_count; ++i) {
+    block_counts[i] = module->function_descriptor_table[i].block_count;
+  }
+  iree_status_t status = iree_vm_bytecode_profile_allocate(
+      function_count, block_counts,
+      iree_vm_ImportFunctionDef_vec_len(
+          iree_vm_BytecodeModuleDef_imported_functions(module->def)),
+      module->allocator, &module->profile);
+  iree_allocator_free(module->allocator, block_counts);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_flags(
+    iree_vm_instance_t* instance, iree_vm_bytecode_module_flags_t flags,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
@@ -832,19 +948,42 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   size_t rodata_ref_table_size =
       iree_host_align(rodata_ref_count * sizeof(iree_vm_buffer_t), 16);
 
+  iree_vm_FunctionDescriptor_vec_t function_descriptors =
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
+  iree_host_size_t function_descriptor_count =
+      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+
+  // Functions verified on first call track their state in a bitmap.
+  size_t verified_bitmap_size = 0;
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  if (iree_all_bits_set(flags,
+                        IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION)) {
+    verified_bitmap_size = iree_host_align(
+        iree_host_size_ceil_div(function_descriptor_count, 32) *
+            sizeof(iree_atomic_int32_t),
+        16);
+  }
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(
-          allocator, sizeof(*module) + type_table_size + rodata_ref_table_size,
-          (void**)&module));
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    rodata_ref_table_size +
+                                    verified_bitmap_size,
+                                (void**)&module));
   module->allocator = allocator;
 
-  iree_vm_FunctionDescriptor_vec_t function_descriptors =
-      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
-  module->function_descriptor_count =
-      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+  module->function_descriptor_count = function_descriptor_count;
   module->function_descriptor_table = function_descriptors;
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  if (verified_bitmap_size > 0) {
+    // Storage is zeroed during allocation so no functions are verified yet.
+    module->verified_bitmap =
+        (iree_atomic_int32_t*)((uint8_t*)module + sizeof(*module) +
+                               type_table_size + rodata_ref_table_size);
+  }
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
 
   flatbuffers_uint8_vec_t bytecode_data =
       iree_vm_BytecodeModuleDef_bytecode_data(module_def);
@@ -881,6 +1020,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
 #endif  // IREE_VM_BACKTRACE_ENABLE
   module->interface.alloc_state = iree_vm_bytecode_module_alloc_state;
   module->interface.free_state = iree_vm_bytecode_module_free_state;
+  module->interface.fork_state = iree_vm_bytecode_module_fork_state;
   module->interface.resolve_import = iree_vm_bytecode_module_resolve_import;
   module->interface.notify = iree_vm_bytecode_module_notify;
   module->interface.begin_call = iree_vm_bytecode_module_begin_call;
@@ -918,20 +1058,220 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   // Verify functions in the module now that we've verified the metadata that we
   // need to do so.
   iree_status_t verify_status = iree_ok_status();
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  if (iree_all_bits_set(flags,
+                        IREE_VM_BYTECODE_MODULE_FLAG_PROFILE_EXECUTION)) {
+    verify_status = iree_vm_bytecode_module_allocate_profile(module);
+  }
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+#if IREE_VM_BYTECODE_JIT_ENABLE
+  // Functions are compiled as they are verified so that the compiler can reuse
+  // the block list produced during verification.
+  if (iree_status_is_ok(verify_status)) {
+    verify_status = iree_vm_bytecode_jit_initialize(
+        module->function_descriptor_count, allocator, &module->jit);
+  }
+  bool jit_enabled = iree_vm_bytecode_jit_is_supported();
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  // Native code does not count block executions.
+  if (module->profile) jit_enabled = false;
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
 #if IREE_VM_BYTECODE_VERIFICATION_ENABLE
-  for (uint16_t i = 0; i < module->function_descriptor_count; ++i) {
+  // Lazily verified modules skip verification here and verify each function
+  // upon first entry. The JIT is left with no compiled functions.
+  const iree_host_size_t eager_verify_count =
+      module->verified_bitmap ? 0 : module->function_descriptor_count;
+  for (uint16_t i = 0; i < eager_verify_count; ++i) {
+    if (!iree_status_is_ok(verify_status)) break;
+#if IREE_VM_BYTECODE_JIT_ENABLE
+    iree_vm_bytecode_block_list_t block_list;
     IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
-    verify_status = iree_vm_bytecode_function_verify(module, i, allocator);
+    verify_status = iree_vm_bytecode_function_verify(
+        module, i, allocator, jit_enabled ? &block_list : NULL);
     IREE_TRACE_ZONE_END(z1);
-    if (!iree_status_is_ok(verify_status)) break;
+    if (jit_enabled && iree_status_is_ok(verify_status)) {
+      const iree_vm_FunctionDescriptor_t* function_descriptor =
+          &module->function_descriptor_table[i];
+      verify_status = iree_vm_bytecode_jit_compile_function(
+          &module->jit, i,
+          iree_make_const_byte_span(
+              module->bytecode_data.data + function_descriptor->bytecode_offset,
+              function_descriptor->bytecode_length),
+          &block_list);
+      iree_vm_bytecode_block_list_deinitialize(&block_list, allocator);
+    }
+#else
+    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
+    verify_status =
+        iree_vm_bytecode_function_verify(module, i, allocator, NULL);
+    IREE_TRACE_ZONE_END(z1);
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
   }
 #endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+#if IREE_VM_BYTECODE_JIT_ENABLE
+  if (iree_status_is_ok(verify_status)) {
+    verify_status = iree_vm_bytecode_jit_finalize(&module->jit);
+  }
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
   if (iree_status_is_ok(verify_status)) {
     *out_module = &module->interface;
   } else {
+#if IREE_VM_BYTECODE_JIT_ENABLE
+    iree_vm_bytecode_jit_deinitialize(&module->jit);
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+    iree_vm_bytecode_profile_free(module->profile);
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
     iree_allocator_free(allocator, module);
   }
 
   IREE_TRACE_ZONE_END(z0);
   return verify_status;
 }
+
+IREE_API_EXPORT bool iree_vm_bytecode_module_has_profile(
+    const iree_vm_module_t* module) {
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  if (!module || module->begin_call != iree_vm_bytecode_module_begin_call) {
+    return false;
+  }
+  return ((const iree_vm_bytecode_module_t*)module->self)->profile != NULL;
+#else
+  return false;
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+}
+
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+// Appends the source location of the block at |block_pc| in the internal
+// function |function_ordinal| to |builder| as a single line. Block markers
+// carry no location so the location of the first op following the marker that
+// has one is used. Appends `-` if the module has no source map for the
+// function.
+static iree_status_t iree_vm_bytecode_module_append_block_location(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal,
+    uint32_t block_pc, iree_string_builder_t* builder) {
+  iree_vm_DebugDatabaseDef_table_t debug_database_def =
+      iree_vm_BytecodeModuleDef_debug_database(module->def);
+  iree_vm_FunctionSourceMapDef_vec_t source_maps_vec =
+      debug_database_def
+          ? iree_vm_DebugDatabaseDef_functions(debug_database_def)
+          : NULL;
+  iree_vm_FunctionSourceMapDef_table_t source_map_def =
+      function_ordinal < iree_vm_FunctionSourceMapDef_vec_len(source_maps_vec)
+          ? iree_vm_FunctionSourceMapDef_vec_at(source_maps_vec,
+                                                function_ordinal)
+          : NULL;
+  iree_vm_BytecodeLocationDef_vec_t locations =
+      source_map_def ? iree_vm_FunctionSourceMapDef_locations(source_map_def)
+                     : NULL;
+  // Locations are stored in bytecode order.
+  for (size_t i = 0; i < iree_vm_BytecodeLocationDef_vec_len(locations); ++i) {
+    iree_vm_BytecodeLocationDef_struct_t location_def =
+        iree_vm_BytecodeLocationDef_vec_at(locations, i);
+    if (location_def->bytecode_offset < (int32_t)block_pc) continue;
+    return iree_vm_bytecode_location_format(
+        location_def->location,
+        iree_vm_DebugDatabaseDef_location_table_union(debug_database_def),
+        IREE_VM_SOURCE_LOCATION_FORMAT_FLAG_SINGLE_LINE, builder);
+  }
+  return iree_string_builder_append_cstring(builder, "-");
+}
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_append_profile(
+    const iree_vm_module_t* module, iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(builder);
+  if (!iree_vm_bytecode_module_has_profile(module)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "module is not collecting an execution profile");
+  }
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_bytecode_module_t* bytecode_module =
+      (iree_vm_bytecode_module_t*)module->self;
+  const iree_vm_bytecode_profile_t* profile = bytecode_module->profile;
+
+  iree_string_view_t module_name =
+      iree_vm_bytecode_module_name(bytecode_module);
+  iree_status_t status = iree_string_builder_append_format(
+      builder, "module %.*s\n", (int)module_name.size, module_name.data);
+
+  // Scratch storage for sorting block counters of the largest function.
+  uint32_t max_block_capacity = 0;
+  for (iree_host_size_t i = 0; i < profile->function_count; ++i) {
+    max_block_capacity =
+        iree_max(max_block_capacity, profile->functions[i].block_capacity);
+  }
+  iree_vm_bytecode_profile_block_count_t* blocks = NULL;
+  if (iree_status_is_ok(status) && max_block_capacity > 0) {
+    status = iree_allocator_malloc(bytecode_module->allocator,
+                                   max_block_capacity * sizeof(*blocks),
+                                   (void**)&blocks);
+  }
+
+  for (iree_host_size_t i = 0;
+       i < profile->function_count && iree_status_is_ok(status); ++i) {
+    const int64_t call_count = iree_atomic_load_int64(
+        &profile->functions[i].call_count, iree_memory_order_relaxed);
+    if (!call_count) continue;
+    iree_string_view_t name = iree_string_view_empty();
+    iree_status_ignore(iree_vm_bytecode_module_get_function(
+        bytecode_module, IREE_VM_FUNCTION_LINKAGE_INTERNAL, i, NULL, &name,
+        NULL));
+    if (iree_string_view_is_empty(name)) name = IREE_SV("-");
+    status = iree_string_builder_append_format(
+        builder, "function %" PRIhsz " %.*s %" PRIi64 "\n", i,
+        (int)name.size, name.data, call_count);
+    const iree_host_size_t block_count =
+        blocks ? iree_vm_bytecode_profile_snapshot_blocks(profile, (uint16_t)i,
+                                                          blocks)
+               : 0;
+    for (iree_host_size_t j = 0; j < block_count && iree_status_is_ok(status);
+         ++j) {
+      if (!blocks[j].count) continue;
+      status = iree_string_builder_append_format(
+          builder, "block %" PRIhsz " %u %" PRIi64 " ", i, blocks[j].pc,
+          blocks[j].count);
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_bytecode_module_append_block_location(
+            bytecode_module, (uint16_t)i, blocks[j].pc, builder);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_string_builder_append_cstring(builder, "\n");
+      }
+    }
+  }
+  iree_allocator_free(bytecode_module->allocator, blocks);
+
+  for (iree_host_size_t i = 0;
+       i < profile->import_count && iree_status_is_ok(status); ++i) {
+    const int64_t call_count = iree_atomic_load_int64(
+        &profile->imports[i].call_count, iree_memory_order_relaxed);
+    if (!call_count) continue;
+    iree_string_view_t name = iree_string_view_empty();
+    iree_status_ignore(iree_vm_bytecode_module_get_function(
+        bytecode_module, IREE_VM_FUNCTION_LINKAGE_IMPORT, i, NULL, &name,
+        NULL));
+    status = iree_string_builder_append_format(
+        builder, "import %" PRIhsz " %.*s %" PRIi64 " %" PRIi64 "\n", i,
+        (int)name.size, name.data, call_count,
+        iree_atomic_load_int64(&profile->imports[i].duration_ns,
+                               iree_memory_order_relaxed));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_ok_status();
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+}
+
+IREE_API_EXPORT void iree_vm_bytecode_module_reset_profile(
+    iree_vm_module_t* module) {
+  if (!iree_vm_bytecode_module_has_profile(module)) return;
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  iree_vm_bytecode_profile_reset(
+      ((iree_vm_bytecode_module_t*)module->self)->profile);
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+}
@@ -14,6 +14,31 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Controls bytecode module loading behavior.
+enum iree_vm_bytecode_module_flag_bits_t {
+  IREE_VM_BYTECODE_MODULE_FLAG_NONE = 0u,
+
+  // Defers verification of function bytecode until each function is first
+  // called. Module metadata is still verified during creation. This reduces
+  // load time of large modules where only a subset of functions are used and
+  // pairs well with memory-mapped archives as the bytecode of functions never
+  // called is never paged in. Functions that fail verification return an error
+  // when called instead of failing module creation.
+  //
+  // Functions verified lazily are always interpreted and do not use the
+  // load-time template compiler.
+  IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION = 1u << 0,
+
+  // Counts function calls, block executions, and time spent in imported
+  // functions for use in profile-guided optimization. Counters are shared by
+  // all contexts using the module and can be retrieved with
+  // iree_vm_bytecode_module_append_profile. Native code generation is
+  // disabled for the module so that all blocks are observed. Ignored unless
+  // the runtime is built with IREE_VM_EXECUTION_PROFILING_ENABLE.
+  IREE_VM_BYTECODE_MODULE_FLAG_PROFILE_EXECUTION = 1u << 1,
+};
+typedef uint32_t iree_vm_bytecode_module_flags_t;
+
 // Creates a VM module from an in-memory ModuleDef FlatBuffer archive.
 // If a |archive_allocator| is provided then it will be used to free the
 // |archive_contents| when the module is destroyed and otherwise the ownership
@@ -23,6 +48,46 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module from an in-memory ModuleDef FlatBuffer archive with the
+// given |flags| controlling loading behavior.
+// See iree_vm_bytecode_module_create for more information.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_flags(
+    iree_vm_instance_t* instance, iree_vm_bytecode_module_flags_t flags,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
+
+// Returns true if |module| is a bytecode module collecting an execution
+// profile (created with IREE_VM_BYTECODE_MODULE_FLAG_PROFILE_EXECUTION).
+IREE_API_EXPORT bool iree_vm_bytecode_module_has_profile(
+    const iree_vm_module_t* module);
+
+// Appends the execution profile counters of |module| to |builder|.
+// Returns IREE_STATUS_FAILED_PRECONDITION if the module is not collecting a
+// profile. The profile is line-oriented text with whitespace-separated fields
+// and may contain the profiles of multiple modules concatenated together:
+//
+//   module <name>
+//   function <ordinal> <name> <call count>
+//   block <function ordinal> <block pc> <branch count> <source location>
+//   import <ordinal> <name> <call count> <total duration ns>
+//
+// Function ordinals are internal function ordinals and block pcs are the
+// offsets of block markers relative to the start of the function bytecode as
+// shown by iree-dump-module. Unnamed functions are listed with a name of `-`.
+// Block pcs are only meaningful for the module that produced the profile and
+// consumers applying the profile to a recompiled program should instead key
+// blocks by their source location: the single-line location from the module
+// source map of the first op in the block, which takes the remainder of the
+// line and is `-` when the module was compiled without debug information.
+// Functions and blocks that were never executed are omitted.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_append_profile(
+    const iree_vm_module_t* module, iree_string_builder_t* builder);
+
+// Resets all execution profile counters of |module| to zero.
+// No-op if the module is not collecting a profile.
+IREE_API_EXPORT void iree_vm_bytecode_module_reset_profile(
+    iree_vm_module_t* module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
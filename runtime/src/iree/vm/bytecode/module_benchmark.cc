@@ -12,6 +12,8 @@
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode/module.h"
 #include "iree/vm/bytecode/module_benchmark_module_c.h"
+#include "iree/vm/bytecode/module_benchmark_module_unfused_c.h"
+#include "iree/vm/bytecode/module_startup_benchmark_module_c.h"
 
 namespace {
 
@@ -71,10 +73,13 @@ static iree_status_t native_import_module_create(
 }
 
 // Benchmarks the given exported function, optionally passing in arguments.
+// When |superinstructions| is false the module is loaded from a variant
+// compiled without superinstruction fusion.
 static iree_status_t RunFunction(benchmark::State& state,
                                  iree_string_view_t function_name,
                                  std::vector<int32_t> i32_args,
-                                 int result_count, int64_t batch_size = 1) {
+                                 int result_count, int64_t batch_size = 1,
+                                 bool superinstructions = true) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                         iree_allocator_system(), &instance));
@@ -84,7 +89,9 @@ static iree_status_t RunFunction(benchmark::State& state,
                                             &import_module));
 
   const auto* module_file_toc =
-      iree_vm_bytecode_module_benchmark_module_create();
+      superinstructions
+          ? iree_vm_bytecode_module_benchmark_module_create()
+          : iree_vm_bytecode_module_benchmark_module_unfused_create();
   iree_vm_module_t* bytecode_module = nullptr;
   IREE_CHECK_OK(iree_vm_bytecode_module_create(
       instance,
@@ -219,6 +226,61 @@ static void BM_FullModuleInit(benchmark::State& state) {
 }
 BENCHMARK(BM_FullModuleInit);
 
+// Measures time from module creation through the first call of a single
+// function in a module with many functions generated at build time by
+// generate_module_startup_benchmark.py. |state.range(0)| is the
+// iree_vm_bytecode_module_flags_t used to create the module.
+static void BM_ModuleStartup(benchmark::State& state) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+  const auto* module_file_toc =
+      iree_vm_bytecode_module_startup_benchmark_module_create();
+  const iree_vm_bytecode_module_flags_t flags =
+      (iree_vm_bytecode_module_flags_t)state.range(0);
+
+  while (state.KeepRunning()) {
+    iree_vm_module_t* module = nullptr;
+    IREE_CHECK_OK(iree_vm_bytecode_module_create_with_flags(
+        instance, flags,
+        iree_const_byte_span_t{
+            reinterpret_cast<const uint8_t*>(module_file_toc->data),
+            static_cast<iree_host_size_t>(module_file_toc->size)},
+        iree_allocator_null(), iree_allocator_system(), &module));
+    iree_vm_context_t* context = nullptr;
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance, IREE_VM_CONTEXT_FLAG_NONE, 1, &module,
+        iree_allocator_system(), &context));
+
+    iree_vm_function_t function;
+    IREE_CHECK_OK(iree_vm_module_lookup_function_by_name(
+        module, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("fn0"), &function));
+    IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                    iree_vm_context_state_resolver(context),
+                                    iree_allocator_system());
+    int32_t arg = 1;
+    int32_t ret = 0;
+    iree_vm_function_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.function = function;
+    call.arguments = iree_make_byte_span(&arg, sizeof(arg));
+    call.results = iree_make_byte_span(&ret, sizeof(ret));
+    IREE_CHECK_OK(function.module->begin_call(function.module->self, stack,
+                                              call));
+    iree_vm_stack_deinitialize(stack);
+    benchmark::DoNotOptimize(ret);
+
+    iree_vm_context_release(context);
+    iree_vm_module_release(module);
+  }
+
+  iree_vm_instance_release(instance);
+}
+BENCHMARK(BM_ModuleStartup)
+    ->ArgName("lazy")
+    ->Arg(IREE_VM_BYTECODE_MODULE_FLAG_NONE)
+    ->Arg(IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION);
+
 IREE_ATTRIBUTE_NOINLINE static int empty_fn(void) {
   int ret = 1;
   benchmark::DoNotOptimize(ret);
@@ -314,14 +376,46 @@ static void BM_LoopSumReference(benchmark::State& state) {
 }
 BENCHMARK(BM_LoopSumReference)->Arg(100000);
 
+// The second argument selects whether the module is encoded with
+// superinstructions so that fused and unfused dispatch can be compared.
 static void BM_LoopSumBytecode(benchmark::State& state) {
   IREE_CHECK_OK(RunFunction(
       state, iree_make_cstring_view("bytecode_module_benchmark.loop_sum"),
       {static_cast<int32_t>(state.range(0))},
       /*result_count=*/1,
-      /*batch_size=*/state.range(0)));
+      /*batch_size=*/state.range(0),
+      /*superinstructions=*/state.range(1) != 0));
+}
+BENCHMARK(BM_LoopSumBytecode)
+    ->ArgNames({"count", "superinstructions"})
+    ->ArgsProduct({{100000}, {0, 1}});
+
+static void BM_LoopGlobalCounterBytecode(benchmark::State& state) {
+  IREE_CHECK_OK(RunFunction(
+      state,
+      iree_make_cstring_view("bytecode_module_benchmark.loop_global_counter"),
+      {static_cast<int32_t>(state.range(0))},
+      /*result_count=*/1,
+      /*batch_size=*/state.range(0),
+      /*superinstructions=*/state.range(1) != 0));
+}
+BENCHMARK(BM_LoopGlobalCounterBytecode)
+    ->ArgNames({"count", "superinstructions"})
+    ->ArgsProduct({{100000}, {0, 1}});
+
+static void BM_LoopCallImportedFuncBytecode(benchmark::State& state) {
+  IREE_CHECK_OK(RunFunction(
+      state,
+      iree_make_cstring_view(
+          "bytecode_module_benchmark.loop_call_imported_func"),
+      {static_cast<int32_t>(state.range(0))},
+      /*result_count=*/1,
+      /*batch_size=*/state.range(0),
+      /*superinstructions=*/state.range(1) != 0));
 }
-BENCHMARK(BM_LoopSumBytecode)->Arg(100000);
+BENCHMARK(BM_LoopCallImportedFuncBytecode)
+    ->ArgNames({"count", "superinstructions"})
+    ->ArgsProduct({{10000}, {0, 1}});
 
 static void BM_BufferReduceReference(benchmark::State& state) {
   static auto work = +[](int32_t* buffer, int i, int sum) {
@@ -77,6 +77,43 @@ vm.module @bytecode_module_benchmark {
     vm.return %ie : i32
   }
 
+  // Measures the cost of a loop updating a global each iteration.
+  // The load/add/store and compare/branch sequences are fused into
+  // superinstructions by the bytecode encoder.
+  vm.global.i64 private mutable @counter = 0 : i64
+  vm.export @loop_global_counter
+  vm.func @loop_global_counter(%count : i32) -> i32 {
+    %c1 = vm.const.i32 1
+    %c1_i64 = vm.const.i64 1
+    %i0 = vm.const.i32.zero
+    vm.br ^loop(%i0 : i32)
+  ^loop(%i : i32):
+    %counter = vm.global.load.i64 @counter : i64
+    %counter_next = vm.add.i64 %counter, %c1_i64 : i64
+    vm.global.store.i64 %counter_next, @counter : i64
+    %in = vm.add.i32 %i, %c1 : i32
+    %cmp = vm.cmp.lt.i32.s %in, %count : i32
+    vm.cond_br %cmp, ^loop(%in : i32), ^loop_exit(%in : i32)
+  ^loop_exit(%ie : i32):
+    vm.return %ie : i32
+  }
+
+  // Measures the cost of a loop calling an import each iteration.
+  // The call and the branch consuming its result are fused.
+  vm.export @loop_call_imported_func
+  vm.func @loop_call_imported_func(%count : i32) -> i32 {
+    %i0 = vm.const.i32.zero
+    vm.br ^check(%i0 : i32)
+  ^check(%i : i32):
+    %cmp = vm.cmp.lt.i32.s %i, %count : i32
+    vm.cond_br %cmp, ^body, ^loop_exit
+  ^body:
+    %in = vm.call @native_import_module.add_1(%i) : (i32) -> i32
+    vm.br ^check(%in : i32)
+  ^loop_exit:
+    vm.return %i : i32
+  }
+
   // Measures the cost of lots of buffer loads.
   vm.export @buffer_reduce
   vm.func @buffer_reduce(%count : i32) -> i32 {
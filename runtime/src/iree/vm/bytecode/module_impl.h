@@ -11,9 +11,16 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/vm/api.h"
+#include "iree/vm/bytecode/jit.h"
+#include "iree/vm/bytecode/profile.h"
 #include "iree/vm/bytecode/utils/isa.h"
 
+#if IREE_VM_BYTECODE_JIT_ENABLE && !IREE_VM_BYTECODE_VERIFICATION_ENABLE
+#error "IREE_VM_BYTECODE_JIT_ENABLE requires IREE_VM_BYTECODE_VERIFICATION_ENABLE"
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE && !IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
@@ -48,6 +55,25 @@ typedef struct iree_vm_bytecode_module_t {
   iree_host_size_t rodata_ref_count;
   iree_vm_buffer_t* rodata_ref_table;
 
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  // Bitmap with one bit per internal function set once the function bytecode
+  // has been verified. NULL if all functions were verified during creation.
+  // Bits are only ever set and verification is idempotent so concurrent callers
+  // racing to verify the same function is benign.
+  iree_atomic_int32_t* verified_bitmap;
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
+#if IREE_VM_BYTECODE_JIT_ENABLE
+  // Native code for functions compiled at load time.
+  iree_vm_bytecode_jit_t jit;
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
+
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  // Execution profile counters shared by all states of the module.
+  // NULL if the module was not created with profiling enabled.
+  iree_vm_bytecode_profile_t* profile;
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
@@ -73,6 +99,12 @@ typedef struct iree_vm_bytecode_import_t {
   // don't support variadic values (yet).
   uint16_t argument_buffer_size;
   uint16_t result_buffer_size;
+
+  // Direct-call target when the import resolved to a native module export.
+  // When set calls bypass the module begin_call and invoke the shim directly.
+  // Arguments and results are still marshaled through the ABI buffers.
+  // Resolved per state along with the rest of the import.
+  iree_vm_native_function_direct_call_t direct_call;
 } iree_vm_bytecode_import_t;
 
 // Per-instance module state.
@@ -92,10 +124,44 @@ typedef struct iree_vm_bytecode_module_state_t {
   iree_host_size_t import_count;
   iree_vm_bytecode_import_t* import_table;
 
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  // Module execution profile counters or NULL if profiling is not enabled.
+  iree_vm_bytecode_profile_t* profile;
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
   // Allocator used for the state itself and any runtime allocations needed.
   iree_allocator_t allocator;
 } iree_vm_bytecode_module_state_t;
 
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
+// Verifies |function_ordinal| and marks it as verified in the module bitmap.
+iree_status_t iree_vm_bytecode_module_verify_function_lazy(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal);
+
+// Ensures |function_ordinal| has been verified prior to executing it.
+static inline iree_status_t iree_vm_bytecode_module_ensure_verified(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  if (IREE_LIKELY(!module->verified_bitmap)) return iree_ok_status();
+  const int32_t bit = (int32_t)(1u << (function_ordinal % 32));
+  if (IREE_LIKELY(iree_atomic_load_int32(
+                      &module->verified_bitmap[function_ordinal / 32],
+                      iree_memory_order_acquire) &
+                  bit)) {
+    return iree_ok_status();
+  }
+  return iree_vm_bytecode_module_verify_function_lazy(module, function_ordinal);
+}
+
+#else
+
+static inline iree_status_t iree_vm_bytecode_module_ensure_verified(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  return iree_ok_status();
+}
+
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
 // Begins execution of the current frame and continues until either a yield or
 // return.
 iree_status_t iree_vm_bytecode_dispatch_begin(
@@ -11,6 +11,7 @@
 #include "iree/vm/bytecode/module.h"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "iree/base/api.h"
@@ -134,7 +135,8 @@ class VMBytecodeModuleTest : public ::testing::Test {
   }
 
   StatusOr<std::vector<iree_vm_value_t>> RunFunction(
-      const char* function_name, std::vector<iree_vm_value_t> inputs) {
+      const char* function_name, std::vector<iree_vm_value_t> inputs,
+      iree_vm_context_t* context = nullptr) {
     ref<iree_vm_list_t> input_list;
     IREE_RETURN_IF_ERROR(
         iree_vm_list_create(iree_vm_make_undefined_type_def(), inputs.size(),
@@ -155,7 +157,8 @@ class VMBytecodeModuleTest : public ::testing::Test {
         bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
         iree_make_cstring_view(function_name), &function));
     IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        iree_vm_invoke(context ? context : context_, function,
+                       IREE_VM_INVOCATION_FLAG_NONE,
                        /*policy=*/nullptr, input_list.get(), output_list.get(),
                        iree_allocator_system()));
 
@@ -169,7 +172,8 @@ class VMBytecodeModuleTest : public ::testing::Test {
   }
 
   StatusOr<std::vector<iree_vm_ref_t>> RunFunction(
-      const char* function_name, std::vector<iree_vm_ref_t> inputs) {
+      const char* function_name, std::vector<iree_vm_ref_t> inputs,
+      iree_vm_context_t* context = nullptr) {
     ref<iree_vm_list_t> input_list;
     IREE_RETURN_IF_ERROR(
         iree_vm_list_create(iree_vm_make_undefined_type_def(), inputs.size(),
@@ -190,7 +194,8 @@ class VMBytecodeModuleTest : public ::testing::Test {
         bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
         iree_make_cstring_view(function_name), &function));
     IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        iree_vm_invoke(context ? context : context_, function,
+                       IREE_VM_INVOCATION_FLAG_NONE,
                        /*policy=*/nullptr, input_list.get(), output_list.get(),
                        iree_allocator_system()));
 
@@ -228,4 +233,76 @@ TEST_F(VMBytecodeModuleTest, FuncIO600) {
               IsOkAndHolds(Eq(MakeNullRefList(600))));
 }
 
+TEST_F(VMBytecodeModuleTest, LazyVerification) {
+  const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
+  iree_vm_module_t* lazy_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_bytecode_module_create_with_flags(
+      instance_, IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION,
+      iree_const_byte_span_t{
+          reinterpret_cast<const uint8_t*>(module_file_toc->data),
+          static_cast<iree_host_size_t>(module_file_toc->size)},
+      iree_allocator_null(), iree_allocator_system(), &lazy_module));
+  iree_vm_context_t* lazy_context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &lazy_module,
+      iree_allocator_system(), &lazy_context));
+
+  // Functions are verified on first call and then called as normal.
+  // RunFunction looks up functions on |bytecode_module_| so swap it out.
+  std::swap(bytecode_module_, lazy_module);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_THAT(RunFunction("FuncIO8", MakeValueRangeList(0, 7), lazy_context),
+                IsOkAndHolds(Eq(MakeValueRangeList(7, 0))));
+  }
+  EXPECT_THAT(RunFunction("Increment", std::vector<iree_vm_value_t>(),
+                          lazy_context),
+              IsOkAndHolds(Eq(MakeValuesList({101}))));
+  std::swap(bytecode_module_, lazy_module);
+
+  iree_vm_context_release(lazy_context);
+  iree_vm_module_release(lazy_module);
+}
+
+TEST_F(VMBytecodeModuleTest, ForkContext) {
+  // Mutate the parent state prior to forking.
+  IREE_ASSERT_OK(RunFunction("AllocShared", std::vector<iree_vm_value_t>()));
+  EXPECT_THAT(RunFunction("Increment", std::vector<iree_vm_value_t>()),
+              IsOkAndHolds(Eq(MakeValuesList({101}))));
+
+  iree_vm_context_t* fork = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &fork));
+  EXPECT_EQ(iree_vm_context_module_count(fork), 1);
+
+  // rwdata globals start from the parent values and then diverge.
+  EXPECT_THAT(RunFunction("Increment", std::vector<iree_vm_value_t>(), fork),
+              IsOkAndHolds(Eq(MakeValuesList({102}))));
+  EXPECT_THAT(RunFunction("Increment", std::vector<iree_vm_value_t>(), fork),
+              IsOkAndHolds(Eq(MakeValuesList({103}))));
+  EXPECT_THAT(RunFunction("Increment", std::vector<iree_vm_value_t>()),
+              IsOkAndHolds(Eq(MakeValuesList({102}))));
+
+  // Ref globals reference the parent objects until reassigned.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      auto parent_refs,
+      RunFunction("GetShared", std::vector<iree_vm_ref_t>()));
+  IREE_ASSERT_OK_AND_ASSIGN(
+      auto fork_refs,
+      RunFunction("GetShared", std::vector<iree_vm_ref_t>(), fork));
+  ASSERT_EQ(parent_refs.size(), 1);
+  ASSERT_EQ(fork_refs.size(), 1);
+  EXPECT_NE(parent_refs[0].ptr, nullptr);
+  EXPECT_EQ(parent_refs[0].ptr, fork_refs[0].ptr);
+  iree_vm_ref_release(&fork_refs[0]);
+  IREE_ASSERT_OK(
+      RunFunction("AllocShared", std::vector<iree_vm_value_t>(), fork));
+  IREE_ASSERT_OK_AND_ASSIGN(
+      fork_refs, RunFunction("GetShared", std::vector<iree_vm_ref_t>(), fork));
+  EXPECT_NE(parent_refs[0].ptr, fork_refs[0].ptr);
+  iree_vm_ref_release(&parent_refs[0]);
+  iree_vm_ref_release(&fork_refs[0]);
+
+  iree_vm_context_release(fork);
+}
+
 }  // namespace
@@ -17,6 +17,35 @@ vm.module @bytecode_module_test {
     vm.return %7, %6, %5, %4, %3, %2, %1, %0 : i32, i32, i32, i32, i32, i32, i32, i32
   }
 
+  // Tests forked contexts: rwdata globals are copied while ref globals share
+  // the parent objects.
+  vm.global.i32 private mutable @counter = 100 : i32
+  vm.global.ref private mutable @shared : !vm.buffer
+
+  vm.export @Increment
+  vm.func @Increment() -> i32 {
+    %c1 = vm.const.i32 1
+    %0 = vm.global.load.i32 @counter : i32
+    %1 = vm.add.i32 %0, %c1 : i32
+    vm.global.store.i32 %1, @counter : i32
+    vm.return %1 : i32
+  }
+
+  vm.export @AllocShared
+  vm.func @AllocShared() {
+    %c16 = vm.const.i64 16
+    %c1 = vm.const.i32 1
+    %buffer = vm.buffer.alloc %c16, %c1 : !vm.buffer
+    vm.global.store.ref %buffer, @shared : !vm.buffer
+    vm.return
+  }
+
+  vm.export @GetShared
+  vm.func @GetShared() -> !vm.buffer {
+    %buffer = vm.global.load.ref @shared : !vm.buffer
+    vm.return %buffer : !vm.buffer
+  }
+
   // Tests boundary conditions on stack allocation of arguments and results:
   // several hundred should trip heap allocation. This looks silly but some ML
   // frameworks like to generate functions with thousands of arguments and
@@ -0,0 +1,150 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode/profile.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/math.h"
+
+// Returns the block table capacity used for a function with |block_count|.
+// Half-full tables keep probe sequences short.
+static uint32_t iree_vm_bytecode_profile_block_capacity(uint32_t block_count) {
+  return block_count ? iree_math_round_up_to_pow2_u32(block_count * 2) : 0;
+}
+
+iree_status_t iree_vm_bytecode_profile_allocate(
+    iree_host_size_t function_count, const uint32_t* function_block_counts,
+    iree_host_size_t import_count, iree_allocator_t host_allocator,
+    iree_vm_bytecode_profile_t** out_profile) {
+  IREE_ASSERT_ARGUMENT(!function_count || function_block_counts);
+  IREE_ASSERT_ARGUMENT(out_profile);
+  *out_profile = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t total_block_capacity = 0;
+  for (iree_host_size_t i = 0; i < function_count; ++i) {
+    total_block_capacity +=
+        iree_vm_bytecode_profile_block_capacity(function_block_counts[i]);
+  }
+
+  iree_vm_bytecode_profile_t* profile = NULL;
+  const iree_host_size_t functions_offset =
+      iree_host_align(sizeof(*profile), iree_max_align_t);
+  const iree_host_size_t imports_offset = iree_host_align(
+      functions_offset + function_count * sizeof(*profile->functions),
+      iree_max_align_t);
+  const iree_host_size_t blocks_offset = iree_host_align(
+      imports_offset + import_count * sizeof(*profile->imports),
+      iree_max_align_t);
+  const iree_host_size_t total_size =
+      blocks_offset +
+      total_block_capacity * sizeof(iree_vm_bytecode_profile_block_t);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&profile));
+  profile->host_allocator = host_allocator;
+  profile->function_count = function_count;
+  profile->functions =
+      (iree_vm_bytecode_profile_function_t*)((uint8_t*)profile +
+                                             functions_offset);
+  profile->import_count = import_count;
+  profile->imports =
+      (iree_vm_bytecode_profile_import_t*)((uint8_t*)profile + imports_offset);
+
+  iree_vm_bytecode_profile_block_t* blocks =
+      (iree_vm_bytecode_profile_block_t*)((uint8_t*)profile + blocks_offset);
+  for (iree_host_size_t i = 0; i < function_count; ++i) {
+    iree_vm_bytecode_profile_function_t* function = &profile->functions[i];
+    function->block_capacity =
+        iree_vm_bytecode_profile_block_capacity(function_block_counts[i]);
+    function->blocks = function->block_capacity ? blocks : NULL;
+    blocks += function->block_capacity;
+  }
+
+  *out_profile = profile;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_vm_bytecode_profile_free(iree_vm_bytecode_profile_t* profile) {
+  if (!profile) return;
+  iree_allocator_free(profile->host_allocator, profile);
+}
+
+void iree_vm_bytecode_profile_reset(iree_vm_bytecode_profile_t* profile) {
+  for (iree_host_size_t i = 0; i < profile->function_count; ++i) {
+    iree_vm_bytecode_profile_function_t* function = &profile->functions[i];
+    iree_atomic_store_int64(&function->call_count, 0,
+                            iree_memory_order_relaxed);
+    for (uint32_t j = 0; j < function->block_capacity; ++j) {
+      iree_atomic_store_int64(&function->blocks[j].count, 0,
+                              iree_memory_order_relaxed);
+    }
+  }
+  for (iree_host_size_t i = 0; i < profile->import_count; ++i) {
+    iree_atomic_store_int64(&profile->imports[i].call_count, 0,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&profile->imports[i].duration_ns, 0,
+                            iree_memory_order_relaxed);
+  }
+}
+
+void iree_vm_bytecode_profile_record_block(iree_vm_bytecode_profile_t* profile,
+                                           uint16_t function_ordinal,
+                                           uint32_t block_pc) {
+  iree_vm_bytecode_profile_function_t* function =
+      &profile->functions[function_ordinal];
+  const uint32_t mask = function->block_capacity - 1;
+  const int32_t pc_key = (int32_t)(block_pc + 1);
+  uint32_t i = (block_pc * 0x9E3779B1u) >> 7;
+  for (uint32_t probe = 0; probe < function->block_capacity; ++probe, ++i) {
+    iree_vm_bytecode_profile_block_t* block = &function->blocks[i & mask];
+    int32_t existing_key =
+        iree_atomic_load_int32(&block->pc_key, iree_memory_order_relaxed);
+    if (existing_key == 0) {
+      // Claim the empty slot; another thread may race us for it (possibly
+      // with a different pc) in which case |existing_key| is updated.
+      if (iree_atomic_compare_exchange_strong_int32(
+              &block->pc_key, &existing_key, pc_key, iree_memory_order_relaxed,
+              iree_memory_order_relaxed)) {
+        existing_key = pc_key;
+      }
+    }
+    if (existing_key == pc_key) {
+      iree_atomic_fetch_add_int64(&block->count, 1, iree_memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+static int iree_vm_bytecode_profile_block_count_compare(const void* a,
+                                                        const void* b) {
+  const uint32_t pc_a = ((const iree_vm_bytecode_profile_block_count_t*)a)->pc;
+  const uint32_t pc_b = ((const iree_vm_bytecode_profile_block_count_t*)b)->pc;
+  return pc_a < pc_b ? -1 : (pc_a > pc_b ? 1 : 0);
+}
+
+iree_host_size_t iree_vm_bytecode_profile_snapshot_blocks(
+    const iree_vm_bytecode_profile_t* profile, uint16_t function_ordinal,
+    iree_vm_bytecode_profile_block_count_t* out_blocks) {
+  const iree_vm_bytecode_profile_function_t* function =
+      &profile->functions[function_ordinal];
+  iree_host_size_t count = 0;
+  for (uint32_t i = 0; i < function->block_capacity; ++i) {
+    iree_vm_bytecode_profile_block_t* block = &function->blocks[i];
+    int32_t pc_key =
+        iree_atomic_load_int32(&block->pc_key, iree_memory_order_relaxed);
+    if (pc_key == 0) continue;
+    out_blocks[count].pc = (uint32_t)(pc_key - 1);
+    out_blocks[count].count =
+        iree_atomic_load_int64(&block->count, iree_memory_order_relaxed);
+    ++count;
+  }
+  qsort(out_blocks, count, sizeof(*out_blocks),
+        iree_vm_bytecode_profile_block_count_compare);
+  return count;
+}
@@ -0,0 +1,118 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_BYTECODE_PROFILE_H_
+#define IREE_VM_BYTECODE_PROFILE_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Bytecode execution profile counters
+//===----------------------------------------------------------------------===//
+// Counts function calls, block executions, and time spent in imported
+// functions as a module executes. Counters are shared by all contexts and
+// threads executing the module and are updated with relaxed atomics: totals
+// are exact once execution has quiesced but may be torn while running.
+//
+// Blocks are identified by the pc of their block marker within the function
+// bytecode. Branches skip block markers so blocks are counted when branched to
+// and function entry blocks are counted by the function call count.
+
+// Execution counter for a block within a function.
+typedef struct iree_vm_bytecode_profile_block_t {
+  // Block marker pc + 1 or 0 if the slot is unused.
+  iree_atomic_int32_t pc_key;
+  // Total number of times the block has been branched to.
+  iree_atomic_int64_t count;
+} iree_vm_bytecode_profile_block_t;
+
+// Execution counters for a function.
+typedef struct iree_vm_bytecode_profile_function_t {
+  // Total number of times the function has been entered.
+  iree_atomic_int64_t call_count;
+  // Open-addressed table of block counters with a power-of-two capacity at
+  // least twice the function block count.
+  uint32_t block_capacity;
+  iree_vm_bytecode_profile_block_t* blocks;
+} iree_vm_bytecode_profile_function_t;
+
+// Execution counters for an imported function.
+typedef struct iree_vm_bytecode_profile_import_t {
+  // Total number of calls made to the import.
+  iree_atomic_int64_t call_count;
+  // Total time spent in the import from the caller's perspective.
+  iree_atomic_int64_t duration_ns;
+} iree_vm_bytecode_profile_import_t;
+
+// Execution counters for a module allocated as a single block.
+typedef struct iree_vm_bytecode_profile_t {
+  iree_allocator_t host_allocator;
+  iree_host_size_t function_count;
+  iree_vm_bytecode_profile_function_t* functions;
+  iree_host_size_t import_count;
+  iree_vm_bytecode_profile_import_t* imports;
+} iree_vm_bytecode_profile_t;
+
+// Allocates zeroed counters for |function_count| functions with the block
+// counts in |function_block_counts| and |import_count| imports.
+iree_status_t iree_vm_bytecode_profile_allocate(
+    iree_host_size_t function_count, const uint32_t* function_block_counts,
+    iree_host_size_t import_count, iree_allocator_t host_allocator,
+    iree_vm_bytecode_profile_t** out_profile);
+
+// Frees |profile| and all counters.
+void iree_vm_bytecode_profile_free(iree_vm_bytecode_profile_t* profile);
+
+// Resets all counters in |profile| to zero.
+void iree_vm_bytecode_profile_reset(iree_vm_bytecode_profile_t* profile);
+
+// Records an entry into |function_ordinal|.
+static inline void iree_vm_bytecode_profile_record_call(
+    iree_vm_bytecode_profile_t* profile, uint16_t function_ordinal) {
+  iree_atomic_fetch_add_int64(&profile->functions[function_ordinal].call_count,
+                              1, iree_memory_order_relaxed);
+}
+
+// Records a branch to the block at |block_pc| in |function_ordinal|.
+// Blocks beyond the capacity of the function table are dropped.
+void iree_vm_bytecode_profile_record_block(iree_vm_bytecode_profile_t* profile,
+                                           uint16_t function_ordinal,
+                                           uint32_t block_pc);
+
+// Records a call to |import_ordinal| that took |duration_ns|.
+static inline void iree_vm_bytecode_profile_record_import(
+    iree_vm_bytecode_profile_t* profile, uint32_t import_ordinal,
+    iree_duration_t duration_ns) {
+  iree_vm_bytecode_profile_import_t* import = &profile->imports[import_ordinal];
+  iree_atomic_fetch_add_int64(&import->call_count, 1,
+                              iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&import->duration_ns, duration_ns,
+                              iree_memory_order_relaxed);
+}
+
+// Block counter snapshot produced by iree_vm_bytecode_profile_snapshot_blocks.
+typedef struct iree_vm_bytecode_profile_block_count_t {
+  uint32_t pc;
+  int64_t count;
+} iree_vm_bytecode_profile_block_count_t;
+
+// Captures the block counters of |function_ordinal| sorted by pc into
+// |out_blocks|, which must have capacity for the function block_capacity.
+// Returns the number of blocks stored.
+iree_host_size_t iree_vm_bytecode_profile_snapshot_blocks(
+    const iree_vm_bytecode_profile_t* profile, uint16_t function_ordinal,
+    iree_vm_bytecode_profile_block_count_t* out_blocks);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_BYTECODE_PROFILE_H_
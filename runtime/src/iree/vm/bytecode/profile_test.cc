@@ -0,0 +1,100 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode/profile.h"
+
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Returns the sorted block counts recorded for |function_ordinal|.
+std::vector<iree_vm_bytecode_profile_block_count_t> SnapshotBlocks(
+    const iree_vm_bytecode_profile_t* profile, uint16_t function_ordinal) {
+  std::vector<iree_vm_bytecode_profile_block_count_t> blocks(
+      profile->functions[function_ordinal].block_capacity);
+  blocks.resize(iree_vm_bytecode_profile_snapshot_blocks(
+      profile, function_ordinal, blocks.data()));
+  return blocks;
+}
+
+TEST(BytecodeProfileTest, CountsCallsBlocksAndImports) {
+  const uint32_t block_counts[] = {1, 3};
+  iree_vm_bytecode_profile_t* profile = NULL;
+  IREE_ASSERT_OK(iree_vm_bytecode_profile_allocate(
+      IREE_ARRAYSIZE(block_counts), block_counts, /*import_count=*/1,
+      iree_allocator_system(), &profile));
+
+  iree_vm_bytecode_profile_record_call(profile, 1);
+  iree_vm_bytecode_profile_record_call(profile, 1);
+  for (int i = 0; i < 5; ++i) {
+    iree_vm_bytecode_profile_record_block(profile, 1, 24);
+  }
+  iree_vm_bytecode_profile_record_block(profile, 1, 8);
+  iree_vm_bytecode_profile_record_import(profile, 0, 100);
+  iree_vm_bytecode_profile_record_import(profile, 0, 50);
+
+  EXPECT_EQ(iree_atomic_load_int64(&profile->functions[0].call_count,
+                                   iree_memory_order_relaxed),
+            0);
+  EXPECT_EQ(iree_atomic_load_int64(&profile->functions[1].call_count,
+                                   iree_memory_order_relaxed),
+            2);
+  EXPECT_TRUE(SnapshotBlocks(profile, 0).empty());
+  auto blocks = SnapshotBlocks(profile, 1);
+  ASSERT_EQ(blocks.size(), 2);
+  EXPECT_EQ(blocks[0].pc, 8);
+  EXPECT_EQ(blocks[0].count, 1);
+  EXPECT_EQ(blocks[1].pc, 24);
+  EXPECT_EQ(blocks[1].count, 5);
+  EXPECT_EQ(iree_atomic_load_int64(&profile->imports[0].call_count,
+                                   iree_memory_order_relaxed),
+            2);
+  EXPECT_EQ(iree_atomic_load_int64(&profile->imports[0].duration_ns,
+                                   iree_memory_order_relaxed),
+            150);
+
+  iree_vm_bytecode_profile_reset(profile);
+  EXPECT_EQ(iree_atomic_load_int64(&profile->functions[1].call_count,
+                                   iree_memory_order_relaxed),
+            0);
+  blocks = SnapshotBlocks(profile, 1);
+  ASSERT_EQ(blocks.size(), 2);
+  EXPECT_EQ(blocks[0].count, 0);
+  EXPECT_EQ(blocks[1].count, 0);
+
+  iree_vm_bytecode_profile_free(profile);
+}
+
+// Tests that every block of a function gets its own counter even when the
+// block pcs collide in the hash table.
+TEST(BytecodeProfileTest, AllBlocksFit) {
+  const uint32_t block_counts[] = {64};
+  iree_vm_bytecode_profile_t* profile = NULL;
+  IREE_ASSERT_OK(iree_vm_bytecode_profile_allocate(
+      IREE_ARRAYSIZE(block_counts), block_counts, /*import_count=*/0,
+      iree_allocator_system(), &profile));
+
+  for (uint32_t i = 0; i < 64; ++i) {
+    for (uint32_t j = 0; j <= i; ++j) {
+      iree_vm_bytecode_profile_record_block(profile, 0, i * 128);
+    }
+  }
+
+  auto blocks = SnapshotBlocks(profile, 0);
+  ASSERT_EQ(blocks.size(), 64);
+  for (uint32_t i = 0; i < 64; ++i) {
+    EXPECT_EQ(blocks[i].pc, i * 128);
+    EXPECT_EQ(blocks[i].count, i + 1);
+  }
+
+  iree_vm_bytecode_profile_free(profile);
+}
+
+}  // namespace
@@ -140,19 +140,19 @@ typedef enum {
   IREE_VM_OP_CORE_CastAnyRef = 0x82,
   IREE_VM_OP_CORE_BranchTable = 0x83,
   IREE_VM_OP_CORE_BufferHash = 0x84,
-  IREE_VM_OP_CORE_RSV_0x85,
-  IREE_VM_OP_CORE_RSV_0x86,
-  IREE_VM_OP_CORE_RSV_0x87,
-  IREE_VM_OP_CORE_RSV_0x88,
-  IREE_VM_OP_CORE_RSV_0x89,
-  IREE_VM_OP_CORE_RSV_0x8A,
-  IREE_VM_OP_CORE_RSV_0x8B,
-  IREE_VM_OP_CORE_RSV_0x8C,
-  IREE_VM_OP_CORE_RSV_0x8D,
-  IREE_VM_OP_CORE_RSV_0x8E,
-  IREE_VM_OP_CORE_RSV_0x8F,
-  IREE_VM_OP_CORE_RSV_0x90,
-  IREE_VM_OP_CORE_RSV_0x91,
+  IREE_VM_OP_CORE_CondBranchCmpEQI32 = 0x85,
+  IREE_VM_OP_CORE_CondBranchCmpNEI32 = 0x86,
+  IREE_VM_OP_CORE_CondBranchCmpLTI32S = 0x87,
+  IREE_VM_OP_CORE_CondBranchCmpLTI32U = 0x88,
+  IREE_VM_OP_CORE_CondBranchCmpEQI64 = 0x89,
+  IREE_VM_OP_CORE_CondBranchCmpNEI64 = 0x8A,
+  IREE_VM_OP_CORE_CondBranchCmpLTI64S = 0x8B,
+  IREE_VM_OP_CORE_CondBranchCmpLTI64U = 0x8C,
+  IREE_VM_OP_CORE_GlobalAddI32 = 0x8D,
+  IREE_VM_OP_CORE_GlobalAddI64 = 0x8E,
+  IREE_VM_OP_CORE_CallBranch = 0x8F,
+  IREE_VM_OP_CORE_ListCopyToBuffer = 0x90,
+  IREE_VM_OP_CORE_ListCopyFromBuffer = 0x91,
   IREE_VM_OP_CORE_RSV_0x92,
   IREE_VM_OP_CORE_RSV_0x93,
   IREE_VM_OP_CORE_RSV_0x94,
@@ -399,19 +399,19 @@ typedef enum {
     OPC(0x82, CastAnyRef) \
     OPC(0x83, BranchTable) \
     OPC(0x84, BufferHash) \
-    RSV(0x85) \
-    RSV(0x86) \
-    RSV(0x87) \
-    RSV(0x88) \
-    RSV(0x89) \
-    RSV(0x8A) \
-    RSV(0x8B) \
-    RSV(0x8C) \
-    RSV(0x8D) \
-    RSV(0x8E) \
-    RSV(0x8F) \
-    RSV(0x90) \
-    RSV(0x91) \
+    OPC(0x85, CondBranchCmpEQI32) \
+    OPC(0x86, CondBranchCmpNEI32) \
+    OPC(0x87, CondBranchCmpLTI32S) \
+    OPC(0x88, CondBranchCmpLTI32U) \
+    OPC(0x89, CondBranchCmpEQI64) \
+    OPC(0x8A, CondBranchCmpNEI64) \
+    OPC(0x8B, CondBranchCmpLTI64S) \
+    OPC(0x8C, CondBranchCmpLTI64U) \
+    OPC(0x8D, GlobalAddI32) \
+    OPC(0x8E, GlobalAddI64) \
+    OPC(0x8F, CallBranch) \
+    OPC(0x90, ListCopyToBuffer) \
+    OPC(0x91, ListCopyFromBuffer) \
     RSV(0x92) \
     RSV(0x93) \
     RSV(0x94) \
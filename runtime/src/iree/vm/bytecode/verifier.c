@@ -238,7 +238,7 @@ typedef struct iree_vm_bytecode_verify_state_t {
   iree_string_view_t cconv_results;
 
   // All block branch points.
-  iree_vm_bytecode_block_list_t block_list;
+  iree_vm_bytecode_block_list_t* block_list;
 
   // Quick lookups of flatbuffer properties.
   const iree_vm_ImportFunctionDef_vec_t imported_functions;
@@ -276,7 +276,8 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
 // function bytecode and capabilities!
 iree_status_t iree_vm_bytecode_function_verify(
     iree_vm_bytecode_module_t* module, uint16_t function_ordinal,
-    iree_allocator_t scratch_allocator) {
+    iree_allocator_t scratch_allocator,
+    iree_vm_bytecode_block_list_t* out_block_list) {
   if (function_ordinal >= module->function_descriptor_count) {
     return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
                             "invalid function ordinal");
@@ -369,11 +370,14 @@ iree_status_t iree_vm_bytecode_function_verify(
   const uint32_t max_pc = (uint32_t)function_descriptor->bytecode_length;
 
   // Reserve the block list. As we walk the bytecode we'll declare/define blocks
-  // and then afterward verify all were found.
+  // and then afterward verify all were found. The list is either returned to
+  // the caller or discarded after verification.
   IREE_ASSERT(function_descriptor->block_count > 0);
+  iree_vm_bytecode_block_list_t local_block_list;
+  verify_state.block_list = out_block_list ? out_block_list : &local_block_list;
   IREE_RETURN_IF_ERROR(iree_vm_bytecode_block_list_initialize(
       function_descriptor->block_count, scratch_allocator,
-      &verify_state.block_list));
+      verify_state.block_list));
 
   // Perform bytecode verification by performing a single-pass walk of all
   // function bytecode.
@@ -417,12 +421,14 @@ iree_status_t iree_vm_bytecode_function_verify(
 
   // Verify all blocks are defined and have proper markers.
   if (iree_status_is_ok(status)) {
-    status = iree_vm_bytecode_block_list_verify(&verify_state.block_list,
+    status = iree_vm_bytecode_block_list_verify(verify_state.block_list,
                                                 bytecode_data);
   }
 
-  iree_vm_bytecode_block_list_deinitialize(&verify_state.block_list,
-                                           scratch_allocator);
+  if (!out_block_list || !iree_status_is_ok(status)) {
+    iree_vm_bytecode_block_list_deinitialize(verify_state.block_list,
+                                             scratch_allocator);
+  }
 
   return status;
 }
@@ -613,7 +619,7 @@ iree_status_t iree_vm_bytecode_function_verify(
   VM_VerifyConstI32(name##_pc);                            \
   iree_vm_bytecode_block_t* name = NULL;                   \
   IREE_RETURN_IF_ERROR(iree_vm_bytecode_block_list_insert( \
-      &verify_state->block_list, name##_pc, &name));
+      verify_state->block_list, name##_pc, &name));
 #define VM_VerifyBranchOperands(name)                                         \
   VM_AlignPC(pc, IREE_REGISTER_ORDINAL_SIZE);                                 \
   IREE_VM_VERIFY_PC_RANGE(pc + IREE_REGISTER_ORDINAL_SIZE, max_pc);           \
@@ -986,6 +992,37 @@ static iree_status_t iree_vm_bytecode_function_verify_call(
   return iree_ok_status();
 }
 
+// Verifies a non-variadic call to |callee_ordinal| (import or internal).
+static iree_status_t iree_vm_bytecode_function_verify_callee(
+    const iree_vm_bytecode_verify_state_t* verify_state,
+    uint32_t callee_ordinal,
+    const iree_vm_register_list_t* IREE_RESTRICT src_reg_list,
+    const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list) {
+  if (VM_IsImportOrdinal(callee_ordinal)) {
+    VM_UnmaskImportOrdinal(callee_ordinal);
+    VM_VerifyImportOrdinal(callee_ordinal);
+    iree_vm_ImportFunctionDef_table_t import_def =
+        iree_vm_ImportFunctionDef_vec_at(verify_state->imported_functions,
+                                         callee_ordinal);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_bytecode_function_verify_call(
+            verify_state, iree_vm_ImportFunctionDef_signature(import_def),
+            /*segment_sizes=*/NULL, src_reg_list, dst_reg_list),
+        "call to import '%s'",
+        iree_vm_ImportFunctionDef_full_name(import_def));
+  } else {
+    VM_VerifyFunctionOrdinal(callee_ordinal);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_bytecode_function_verify_call(
+            verify_state,
+            iree_vm_FunctionSignatureDef_vec_at(
+                verify_state->function_signatures, callee_ordinal),
+            /*segment_sizes=*/NULL, src_reg_list, dst_reg_list),
+        "call to internal function %d", callee_ordinal);
+  }
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // Bytecode verification
 //===----------------------------------------------------------------------===//
@@ -1064,6 +1101,13 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
       VM_VerifyOperandRegI32(value);
     });
 
+    VERIFY_OP(CORE, GlobalAddI32, {
+      VM_VerifyGlobalAttr(byte_offset);
+      VM_VerifyRwdataOffset(byte_offset, 4);
+      VM_VerifyOperandRegI32(addend);
+      VM_VerifyResultRegI32(result);
+    });
+
     VERIFY_OP(CORE, GlobalLoadIndirectI32, {
       VM_VerifyOperandRegI32(byte_offset);
       // NOTE: we have to verify the offset at runtime.
@@ -1088,6 +1132,13 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
       VM_VerifyOperandRegI64(value);
     });
 
+    VERIFY_OP(CORE, GlobalAddI64, {
+      VM_VerifyGlobalAttr(byte_offset);
+      VM_VerifyRwdataOffset(byte_offset, 8);
+      VM_VerifyOperandRegI64(addend);
+      VM_VerifyResultRegI64(result);
+    });
+
     VERIFY_OP(CORE, GlobalLoadIndirectI64, {
       VM_VerifyOperandRegI32(byte_offset);
       // NOTE: we have to verify the offset at runtime.
@@ -1339,6 +1390,22 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
       VM_VerifyOperandRegRef(value);
     });
 
+    VERIFY_OP(CORE, ListCopyToBuffer, {
+      VM_VerifyOperandRegRef(source_list);
+      VM_VerifyOperandRegI32(source_index);
+      VM_VerifyOperandRegRef(target_buffer);
+      VM_VerifyOperandRegI64HostSize(target_offset);
+      VM_VerifyOperandRegI32(count);
+    });
+
+    VERIFY_OP(CORE, ListCopyFromBuffer, {
+      VM_VerifyOperandRegRef(source_buffer);
+      VM_VerifyOperandRegI64HostSize(source_offset);
+      VM_VerifyOperandRegRef(target_list);
+      VM_VerifyOperandRegI32(target_index);
+      VM_VerifyOperandRegI32(count);
+    });
+
     //===------------------------------------------------------------------===//
     // Conditional assignment
     //===------------------------------------------------------------------===//
@@ -1539,7 +1606,7 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
       // a prior branch.
       iree_vm_bytecode_block_t* block = NULL;
       IREE_RETURN_IF_ERROR(iree_vm_bytecode_block_list_insert(
-          &verify_state->block_list, pc - 1, &block));
+          verify_state->block_list, pc - 1, &block));
       block->defined = 1;
       verify_state->in_block = 1;
     });
@@ -1559,6 +1626,26 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
       verify_state->in_block = 0;  // terminator
     });
 
+#define VERIFY_OP_CORE_COND_BRANCH_CMP(op_name, VM_VerifyReg) \
+  VERIFY_OP(CORE, op_name, {                                  \
+    VM_VerifyReg(lhs);                                        \
+    VM_VerifyReg(rhs);                                        \
+    VM_VerifyBranchTarget(true_dest_pc);                      \
+    VM_VerifyBranchOperands(true_operands);                   \
+    VM_VerifyBranchTarget(false_dest_pc);                     \
+    VM_VerifyBranchOperands(false_operands);                  \
+    verify_state->in_block = 0; /* terminator */              \
+  });
+
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI32, VM_VerifyOperandRegI32);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI32, VM_VerifyOperandRegI32);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32S, VM_VerifyOperandRegI32);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32U, VM_VerifyOperandRegI32);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI64, VM_VerifyOperandRegI64);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI64, VM_VerifyOperandRegI64);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64S, VM_VerifyOperandRegI64);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64U, VM_VerifyOperandRegI64);
+
     VERIFY_OP(CORE, BranchTable, {
       VM_VerifyOperandRegI32(index);
       VM_VerifyBranchTarget(default_dest_pc);
@@ -1575,27 +1662,23 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
       VM_VerifyFuncAttr(callee_ordinal);
       VM_VerifyVariadicOperandsAny(operands);
       VM_VerifyVariadicResultsAny(results);
-      if (VM_IsImportOrdinal(callee_ordinal)) {
-        VM_UnmaskImportOrdinal(callee_ordinal);
-        VM_VerifyImportOrdinal(callee_ordinal);
-        iree_vm_ImportFunctionDef_table_t import_def =
-            iree_vm_ImportFunctionDef_vec_at(verify_state->imported_functions,
-                                             callee_ordinal);
-        IREE_RETURN_IF_ERROR(
-            iree_vm_bytecode_function_verify_call(
-                verify_state, iree_vm_ImportFunctionDef_signature(import_def),
-                /*segment_sizes=*/NULL, operands, results),
-            "call to import '%s'",
-            iree_vm_ImportFunctionDef_full_name(import_def));
-      } else {
-        VM_VerifyFunctionOrdinal(callee_ordinal);
-        IREE_RETURN_IF_ERROR(
-            iree_vm_bytecode_function_verify_call(
-                verify_state,
-                iree_vm_FunctionSignatureDef_vec_at(
-                    verify_state->function_signatures, callee_ordinal),
-                /*segment_sizes=*/NULL, operands, results),
-            "call to internal function %d", callee_ordinal);
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_function_verify_callee(
+          verify_state, callee_ordinal, operands, results));
+    });
+
+    VERIFY_OP(CORE, CallBranch, {
+      VM_VerifyFuncAttr(callee_ordinal);
+      VM_VerifyVariadicOperandsAny(operands);
+      VM_VerifyVariadicResultsAny(results);
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_function_verify_callee(
+          verify_state, callee_ordinal, operands, results));
+      // The branch consuming the call results must immediately follow as the
+      // dispatcher may execute it inline. It is verified as the next op.
+      IREE_VM_VERIFY_PC_RANGE(pc + 1, max_pc);
+      if (IREE_UNLIKELY(bytecode_data[pc] != IREE_VM_OP_CORE_Branch)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "call.br at pc %08X not followed by a branch",
+                                pc);
       }
     });
 
@@ -10,6 +10,7 @@
 #include "iree/base/api.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode/module_impl.h"
+#include "iree/vm/bytecode/utils/block_list.h"
 
 // Verifies the structure of the FlatBuffer so that we can avoid doing so during
 // runtime. There are still some conditions we must be aware of (such as omitted
@@ -31,8 +32,13 @@ iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
 // If verification requires transient allocations for tracking they will be made
 // from |scratch_allocator|. No allocation will live outside of the function and
 // callers may provide stack-based arenas.
+//
+// If |out_block_list| is provided it will be initialized with every block in
+// the function upon success and must be deinitialized by the caller with
+// |scratch_allocator|.
 iree_status_t iree_vm_bytecode_function_verify(
     iree_vm_bytecode_module_t* module, uint16_t function_ordinal,
-    iree_allocator_t scratch_allocator);
+    iree_allocator_t scratch_allocator,
+    iree_vm_bytecode_block_list_t* out_block_list);
 
 #endif  // IREE_VM_BYTECODE_VERIFIER_H_
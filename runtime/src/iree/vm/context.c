@@ -300,12 +300,12 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create(
       out_context);
 }
 
-IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
+// Allocates a context with storage for a static list of |module_count|
+// modules. The module list is empty upon return.
+static iree_status_t iree_vm_context_allocate(
     iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
-    iree_host_size_t module_count, iree_vm_module_t** modules,
-    iree_allocator_t allocator, iree_vm_context_t** out_context) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_ASSERT_ARGUMENT(out_context);
+    iree_host_size_t module_count, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
   *out_context = NULL;
 
   iree_host_size_t context_size =
@@ -313,8 +313,8 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
       sizeof(iree_vm_module_state_t*) * module_count;
 
   iree_vm_context_t* context = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(allocator, context_size, (void**)&context));
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, context_size, (void**)&context));
   iree_atomic_ref_count_init(&context->ref_count);
   context->instance = instance;
   iree_vm_instance_retain(context->instance);
@@ -335,6 +335,23 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   context->list.count = 0;
   context->list.capacity = module_count;
 
+  *out_context = context;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
+    iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
+    iree_host_size_t module_count, iree_vm_module_t** modules,
+    iree_allocator_t allocator, iree_vm_context_t** out_context) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_context_allocate(instance, flags, module_count, allocator,
+                                   &context));
+
   iree_status_t register_status =
       iree_vm_context_register_modules(context, module_count, modules);
   if (!iree_status_is_ok(register_status)) {
@@ -348,6 +365,64 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    const iree_vm_context_t* context, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)context->list.count);
+
+  // Check all modules up front so that we don't fork some states only to fail
+  // and throw them away.
+  for (iree_host_size_t i = 0; i < context->list.count; ++i) {
+    iree_vm_module_t* module = context->list.modules[i];
+    if (!module->fork_state) {
+      iree_string_view_t module_name = iree_vm_module_name(module);
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "module '%.*s' does not support state forking",
+                              (int)module_name.size, module_name.data);
+    }
+  }
+
+  iree_vm_context_t* fork = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_context_allocate(context->instance, context->flags,
+                                   context->list.count, allocator, &fork));
+  fork->is_frozen = 1;
+
+  // Fork module states in registration order. The list count is bumped prior
+  // to forking each state so that on failure the module is released with the
+  // context; states that were not forked are NULL and skipped during cleanup.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < context->list.count; ++i) {
+    iree_vm_module_t* module = context->list.modules[i];
+    fork->list.modules[i] = module;
+    fork->list.module_states[i] = NULL;
+    iree_vm_module_retain(module);
+    ++fork->list.count;
+    status = module->fork_state(module->self, context->list.module_states[i],
+                                allocator, &fork->list.module_states[i]);
+    if (!iree_status_is_ok(status)) {
+      iree_string_view_t module_name = iree_vm_module_name(module);
+      (void)module_name;
+      status = iree_status_annotate_f(status, "forking module '%.*s' state",
+                                      (int)module_name.size, module_name.data);
+      break;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_context = fork;
+  } else {
+    iree_vm_context_destroy(fork);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_vm_context_destroy(iree_vm_context_t* context) {
   if (!context) return;
 
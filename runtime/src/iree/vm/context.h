@@ -69,6 +69,28 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
     iree_host_size_t module_count, iree_vm_module_t** modules,
     iree_allocator_t allocator, iree_vm_context_t** out_context);
 
+// Forks a new context from a fully initialized |context|.
+// The forked context has the same modules registered in the same order and
+// each module state is forked from the parent state instead of being allocated
+// and initialized: module __init functions are not run and imports are not
+// re-resolved. Immutable module resources such as loaded executables are
+// shared with the parent while mutable state such as bytecode rwdata globals
+// is copied. Ref globals are retained and reference the same objects as the
+// parent: assigning a new value to a global in either context is isolated but
+// mutating the contents of a shared object (such as a buffer) is not.
+//
+// This allows an application to initialize a context once and use it as a
+// snapshot to cheaply stamp out per-session contexts. The parent |context|
+// must not be executing while being forked. It is recommended that the parent
+// be frozen and only used for forking.
+//
+// The forked context is frozen and cannot have additional modules registered.
+// Returns IREE_STATUS_UNIMPLEMENTED if any module does not support forking.
+// |out_context| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    const iree_vm_context_t* context, iree_allocator_t allocator,
+    iree_vm_context_t** out_context);
+
 // Retains the given |context| for the caller.
 IREE_API_EXPORT void iree_vm_context_retain(iree_vm_context_t* context);
 
@@ -34,9 +34,11 @@ extern "C" {
 typedef uint32_t iree_vm_dynamic_module_version_t;
 
 #define IREE_VM_DYNAMIC_MODULE_VERSION_0_1 0x00000001u
+// Added iree_vm_module_t::fork_state.
+#define IREE_VM_DYNAMIC_MODULE_VERSION_0_2 0x00000002u
 
 // The latest version of the dynamic module API.
-#define IREE_VM_DYNAMIC_MODULE_VERSION_LATEST IREE_VM_DYNAMIC_MODULE_VERSION_0_1
+#define IREE_VM_DYNAMIC_MODULE_VERSION_LATEST IREE_VM_DYNAMIC_MODULE_VERSION_0_2
 
 // Exported function from dynamic libraries for creating dynamic modules.
 // This should be implemented as pure as possible and may be called many times
@@ -11,7 +11,10 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/debugging.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/wait_handle.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
 #include "iree/vm/value.h"
@@ -479,6 +482,20 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
 
   // NOTE: at this point the stack must be properly deinitialized if we bail.
 
+  // Route objects created by the invocation to the caller's arena, if any.
+  if (policy && policy->arena) {
+    status = iree_vm_stack_set_arena(stack, policy->arena);
+    if (!iree_status_is_ok(status)) {
+      iree_vm_stack_deinitialize(stack);
+      iree_vm_invoke_release_argument_storage(
+          cconv_arguments, arguments, arguments_on_heap, host_allocator);
+      iree_vm_invoke_release_result_storage(
+          cconv_results, results, state->stack_storage, host_allocator);
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+  }
+
   // Initialize state now that we are confident we're returning OK.
   // If we return a failure the user won't know they have to end() and clean
   // these up.
@@ -717,14 +734,20 @@ static iree_status_t iree_vm_async_complete_invoke(
     iree_vm_async_invoke_state_t* state, iree_loop_t loop,
     iree_status_t status);
 
-IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
+// Initializes |state| and launches the invocation on |loop|.
+// |cancel_source| is optional (ctl == NULL) and when resolved cancels the
+// invocation. |cancel_flag| must be set before |cancel_source| is resolved and
+// is required if |cancel_source| is provided.
+static iree_status_t iree_vm_async_launch_invoke(
     iree_loop_t loop, iree_vm_async_invoke_state_t* state,
     iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
     iree_vm_list_t* inputs, iree_vm_list_t* outputs,
-    iree_allocator_t host_allocator,
+    iree_allocator_t host_allocator, iree_wait_source_t cancel_source,
+    iree_atomic_int32_t* cancel_flag,
     iree_vm_async_invoke_callback_fn_t callback, void* user_data) {
   IREE_ASSERT_ARGUMENT(state);
+  IREE_ASSERT(!cancel_source.ctl || cancel_flag);
   IREE_ASSERT_ARGUMENT(context);
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -742,6 +765,8 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
   iree_vm_list_retain(outputs);
   state->callback = callback;
   state->user_data = user_data;
+  state->cancel_source = cancel_source;
+  state->cancel_flag = cancel_flag;
 
   // Launch the invocation; if this fails we'll need to cleanup the state we've
   // already initialized.
@@ -758,6 +783,30 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
+    iree_loop_t loop, iree_vm_async_invoke_state_t* state,
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_allocator_t host_allocator,
+    iree_vm_async_invoke_callback_fn_t callback, void* user_data) {
+  iree_wait_source_t no_cancel_source = {0};
+  return iree_vm_async_launch_invoke(loop, state, context, function, flags,
+                                     policy, inputs, outputs, host_allocator,
+                                     no_cancel_source, /*cancel_flag=*/NULL,
+                                     callback, user_data);
+}
+
+// Returns true if the invocation has been cancelled.
+// This is checked on every tick and only loads the cancel flag; the
+// cancel_source is resolved after the flag is set and only wakes waits.
+static bool iree_vm_async_is_cancelled(
+    const iree_vm_async_invoke_state_t* state) {
+  return state->cancel_flag &&
+         iree_atomic_load_int32(state->cancel_flag,
+                                iree_memory_order_acquire) != 0;
+}
+
 // Begins the invocation from the first loop callback.
 // The begin_params on the state will have everything we need to initialize the
 // call but since we alias with the base invocation state we must be sure to
@@ -773,7 +822,12 @@ static iree_status_t iree_vm_async_begin_invoke(void* user_data,
   iree_vm_async_invoke_state_t* state =
       (iree_vm_async_invoke_state_t*)user_data;
 
-  // Check to see if the loop has failed before we even begin.
+  // Check to see if the loop has failed or the invocation was cancelled before
+  // we even begin.
+  if (IREE_UNLIKELY(iree_status_is_ok(loop_status) &&
+                    iree_vm_async_is_cancelled(state))) {
+    loop_status = iree_status_from_code(IREE_STATUS_CANCELLED);
+  }
   if (IREE_UNLIKELY(!iree_status_is_ok(loop_status))) {
     // We release our retained resources because we don't guarantee they live to
     // the callback. This allows callbacks to reuse memory.
@@ -909,6 +963,39 @@ static iree_status_t iree_vm_async_wake_invoke(void* user_data,
       iree_vm_stack_current_frame(state->base.stack);
   iree_vm_wait_frame_t* wait_frame =
       (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(current_frame);
+  if (state->cancel_source.ctl) {
+    if (iree_vm_async_is_cancelled(state)) {
+      // Cancellation woke the wait; the waiter (such as a HAL fence await)
+      // will observe the cancellation as its wait result.
+      iree_status_ignore(loop_status);
+      loop_status = iree_status_from_code(IREE_STATUS_CANCELLED);
+    } else if (wait_frame->wait_type == IREE_VM_WAIT_UNTIL &&
+               iree_status_is_deadline_exceeded(loop_status)) {
+      // Cancellable sleeps are waits on the cancel source that time out.
+      iree_status_ignore(loop_status);
+      loop_status = iree_ok_status();
+    } else if (wait_frame->wait_type == IREE_VM_WAIT_ALL &&
+               iree_status_is_ok(loop_status)) {
+      // Cancellable wait-alls wait on the first unresolved source each tick;
+      // retire it and continue waiting if any sources remain.
+      bool retired = false;
+      for (iree_host_size_t i = 0; i < wait_frame->count; ++i) {
+        if (iree_wait_source_is_immediate(wait_frame->wait_sources[i])) {
+          continue;
+        } else if (!retired) {
+          wait_frame->wait_sources[i] = iree_wait_source_immediate();
+          retired = true;
+        } else {
+          IREE_TRACE_ZONE_END(z0);
+          iree_status_t status = iree_vm_async_tick_invoke(state, loop);
+          if (!iree_status_is_ok(status)) {
+            status = iree_vm_async_complete_invoke(state, loop, status);
+          }
+          return status;
+        }
+      }
+    }
+  }
   wait_frame->wait_status = loop_status;
 
   IREE_ASSERT(iree_status_is_deferred(state->base.status));
@@ -924,8 +1011,48 @@ static iree_status_t iree_vm_async_wake_invoke(void* user_data,
   return iree_vm_async_resume_invoke(user_data, loop, iree_ok_status());
 }
 
+// Waits on |wait_frame| or the cancel source of |state|, whichever resolves
+// first. Wait-all operations are performed one unresolved source at a time so
+// that cancellation can be observed without additional storage.
+static iree_status_t iree_vm_async_wait_cancellable(
+    iree_vm_async_invoke_state_t* state, iree_loop_t loop,
+    iree_vm_wait_frame_t* wait_frame, iree_timeout_t timeout) {
+  iree_host_size_t count = 0;
+  switch (wait_frame->wait_type) {
+    default:
+    case IREE_VM_WAIT_UNTIL:
+      // Only the cancel source; the timeout resolves the wait.
+      break;
+    case IREE_VM_WAIT_ANY:
+      for (iree_host_size_t i = 0; i < wait_frame->count; ++i) {
+        state->cancel_wait_sources[count++] = wait_frame->wait_sources[i];
+      }
+      break;
+    case IREE_VM_WAIT_ALL:
+      // If all sources have resolved we still go through the loop (with an
+      // immediately resolved source) so that resumption is uniform.
+      state->cancel_wait_sources[count++] = iree_wait_source_immediate();
+      for (iree_host_size_t i = 0; i < wait_frame->count; ++i) {
+        if (!iree_wait_source_is_immediate(wait_frame->wait_sources[i])) {
+          state->cancel_wait_sources[0] = wait_frame->wait_sources[i];
+          break;
+        }
+      }
+      break;
+  }
+  state->cancel_wait_sources[count++] = state->cancel_source;
+  return iree_loop_wait_any(loop, count, state->cancel_wait_sources, timeout,
+                            iree_vm_async_wake_invoke, state);
+}
+
 static iree_status_t iree_vm_async_tick_invoke(
     iree_vm_async_invoke_state_t* state, iree_loop_t loop) {
+  // Cancellation is observed when the invocation yields; if it is in the middle
+  // of executing it will stop at the next yield or wait.
+  if (IREE_UNLIKELY(iree_vm_async_is_cancelled(state))) {
+    return iree_status_from_code(IREE_STATUS_CANCELLED);
+  }
+
   // Grab the wait frame from the stack holding the wait parameters.
   // This is optional: if an invocation yields for cooperative scheduling
   // purposes there will not be a wait frame on the stack and we'll just
@@ -946,6 +1073,11 @@ static iree_status_t iree_vm_async_tick_invoke(
     // worrying whether user programs request to wait forever.
     iree_timeout_t timeout = iree_make_deadline(
         iree_min(state->deadline_ns, wait_frame->deadline_ns));
+    if (state->cancel_source.ctl &&
+        (wait_frame->wait_type != IREE_VM_WAIT_ANY ||
+         wait_frame->count <= IREE_VM_ASYNC_INVOKE_CANCELLABLE_WAIT_CAPACITY)) {
+      return iree_vm_async_wait_cancellable(state, loop, wait_frame, timeout);
+    }
     switch (wait_frame->wait_type) {
       default:
       case IREE_VM_WAIT_UNTIL:
@@ -995,3 +1127,351 @@ static iree_status_t iree_vm_async_complete_invoke(
   iree_vm_list_t* outputs = state->outputs;
   return state->callback(state->user_data, loop, status, outputs);
 }
+
+//===----------------------------------------------------------------------===//
+// Asynchronous stateful invocation
+//===----------------------------------------------------------------------===//
+
+struct iree_vm_invocation_t {
+  iree_atomic_ref_count_t ref_count;
+  // Allocator used for the invocation storage.
+  iree_allocator_t host_allocator;
+  // Pool the invocation is returned to when released, if any. Retained while
+  // the invocation is live.
+  iree_vm_invocation_pool_t* pool;
+  // Next unused invocation in the pool free list.
+  iree_vm_invocation_t* next;
+
+  // Input and output storage reused across invocations.
+  iree_vm_list_t* inputs;
+  iree_vm_list_t* outputs;
+
+  // Copy of the caller-provided policy as it must outlive the call to create.
+  iree_vm_invocation_policy_t policy;
+
+  // Set to 1 when the invocation is cancelled and used as the cancel_flag of
+  // the async state.
+  iree_atomic_int32_t cancelled;
+  // Event signaled after |cancelled| is set and used as the cancel_source of
+  // the async state to wake blocked waits.
+  iree_event_t cancel_event;
+
+  // Set to 1 with release semantics once |status| and |outputs| are available.
+  iree_atomic_int32_t completed;
+  // Result of the invocation once completed.
+  iree_status_t status;
+  // Posted when the invocation completes.
+  iree_notification_t completion_notification;
+
+  // Storage for the async invocation, including the inline VM stack.
+  iree_vm_async_invoke_state_t state;
+};
+
+struct iree_vm_invocation_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  // Guards |free_list|.
+  iree_slim_mutex_t mutex;
+  // Singly-linked list of unused invocations.
+  iree_vm_invocation_t* free_list IREE_GUARDED_BY(mutex);
+};
+
+// Allocates a new invocation and its reusable resources.
+static iree_status_t iree_vm_invocation_allocate(
+    iree_allocator_t host_allocator, iree_vm_invocation_t** out_invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  *out_invocation = NULL;
+
+  iree_vm_invocation_t* invocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*invocation),
+                                (void**)&invocation));
+  invocation->host_allocator = host_allocator;
+  iree_notification_initialize(&invocation->completion_notification);
+
+  iree_status_t status =
+      iree_event_initialize(/*initial_state=*/false, &invocation->cancel_event);
+  if (!iree_status_is_ok(status)) {
+    iree_notification_deinitialize(&invocation->completion_notification);
+    iree_allocator_free(host_allocator, invocation);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  status = iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                               /*initial_capacity=*/4, host_allocator,
+                               &invocation->inputs);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                 /*initial_capacity=*/4, host_allocator,
+                                 &invocation->outputs);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_invocation = invocation;
+  } else {
+    iree_vm_list_release(invocation->inputs);
+    iree_event_deinitialize(&invocation->cancel_event);
+    iree_notification_deinitialize(&invocation->completion_notification);
+    iree_allocator_free(host_allocator, invocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Frees an unused |invocation| and its resources.
+static void iree_vm_invocation_free(iree_vm_invocation_t* invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_list_release(invocation->outputs);
+  iree_vm_list_release(invocation->inputs);
+  iree_event_deinitialize(&invocation->cancel_event);
+  iree_notification_deinitialize(&invocation->completion_notification);
+  iree_allocator_free(invocation->host_allocator, invocation);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Resets |invocation| to its initial state for reuse. List storage and the
+// cancel event are retained.
+static void iree_vm_invocation_reset(iree_vm_invocation_t* invocation) {
+  iree_vm_list_clear(invocation->inputs);
+  iree_vm_list_clear(invocation->outputs);
+  iree_atomic_store_int32(&invocation->cancelled, 0, iree_memory_order_relaxed);
+  iree_event_reset(&invocation->cancel_event);
+  iree_status_free(invocation->status);
+  invocation->status = iree_ok_status();
+  iree_atomic_store_int32(&invocation->completed, 0, iree_memory_order_relaxed);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_pool_create(
+    iree_allocator_t host_allocator, iree_vm_invocation_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_invocation_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&pool->mutex);
+  pool->free_list = NULL;
+
+  *out_pool = pool;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_vm_invocation_pool_destroy(iree_vm_invocation_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_invocation_pool_trim(pool);
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  iree_allocator_free(pool->host_allocator, pool);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_vm_invocation_pool_retain(
+    iree_vm_invocation_pool_t* pool) {
+  if (pool) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_invocation_pool_release(
+    iree_vm_invocation_pool_t* pool) {
+  if (pool && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_vm_invocation_pool_destroy(pool);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_invocation_pool_trim(
+    iree_vm_invocation_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_vm_invocation_t* free_list = pool->free_list;
+  pool->free_list = NULL;
+  iree_slim_mutex_unlock(&pool->mutex);
+  while (free_list) {
+    iree_vm_invocation_t* next = free_list->next;
+    iree_vm_invocation_free(free_list);
+    free_list = next;
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Acquires an unused invocation from |pool| or allocates a new one.
+static iree_status_t iree_vm_invocation_pool_acquire(
+    iree_vm_invocation_pool_t* pool, iree_vm_invocation_t** out_invocation) {
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_vm_invocation_t* invocation = pool->free_list;
+  if (invocation) pool->free_list = invocation->next;
+  iree_slim_mutex_unlock(&pool->mutex);
+  if (invocation) {
+    invocation->next = NULL;
+    *out_invocation = invocation;
+    return iree_ok_status();
+  }
+  return iree_vm_invocation_allocate(pool->host_allocator, out_invocation);
+}
+
+// Returns an unused |invocation| to |pool|.
+static void iree_vm_invocation_pool_recycle(iree_vm_invocation_pool_t* pool,
+                                            iree_vm_invocation_t* invocation) {
+  iree_slim_mutex_lock(&pool->mutex);
+  invocation->next = pool->free_list;
+  pool->free_list = invocation;
+  iree_slim_mutex_unlock(&pool->mutex);
+}
+
+static bool iree_vm_invocation_is_completed(void* arg) {
+  iree_vm_invocation_t* invocation = (iree_vm_invocation_t*)arg;
+  return iree_atomic_load_int32(&invocation->completed,
+                                iree_memory_order_acquire) != 0;
+}
+
+// Completion callback from iree_vm_async_invoke. Stores the result, wakes any
+// waiters, and drops the reference held by the in-flight invocation.
+static iree_status_t iree_vm_invocation_complete(void* user_data,
+                                                 iree_loop_t loop,
+                                                 iree_status_t status,
+                                                 iree_vm_list_t* outputs) {
+  iree_vm_invocation_t* invocation = (iree_vm_invocation_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The invocation holds its own reference to the outputs list.
+  iree_vm_list_release(outputs);
+  iree_vm_list_clear(invocation->inputs);
+
+  invocation->status = status;
+  iree_atomic_store_int32(&invocation->completed, 1, iree_memory_order_release);
+  iree_notification_post(&invocation->completion_notification,
+                         IREE_ALL_WAITERS);
+  iree_vm_invocation_release(invocation);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_create(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    const iree_vm_list_t* inputs, iree_loop_t loop,
+    iree_vm_invocation_pool_t* pool, iree_allocator_t allocator,
+    iree_vm_invocation_t** out_invocation) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_invocation);
+  *out_invocation = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_invocation_t* invocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, pool ? iree_vm_invocation_pool_acquire(pool, &invocation)
+               : iree_vm_invocation_allocate(allocator, &invocation));
+  iree_atomic_ref_count_init(&invocation->ref_count);
+  invocation->pool = pool;
+  iree_vm_invocation_pool_retain(pool);
+  if (policy) {
+    invocation->policy = *policy;
+  } else {
+    memset(&invocation->policy, 0, sizeof(invocation->policy));
+  }
+
+  // Copy inputs into the invocation-owned list. This only allocates if the
+  // list has not yet grown to the input count.
+  iree_host_size_t input_count = inputs ? iree_vm_list_size(inputs) : 0;
+  iree_status_t status = iree_vm_list_resize(invocation->inputs, input_count);
+  if (iree_status_is_ok(status) && input_count > 0) {
+    status = iree_vm_list_copy((iree_vm_list_t*)inputs, 0, invocation->inputs,
+                               0, input_count);
+  }
+
+  // Launch the invocation with a reference held until it completes.
+  // NOTE: the invocation may complete before this returns.
+  if (iree_status_is_ok(status)) {
+    iree_vm_invocation_retain(invocation);
+    status = iree_vm_async_launch_invoke(
+        loop, &invocation->state, context, function, flags,
+        &invocation->policy, invocation->inputs, invocation->outputs, allocator,
+        iree_event_await(&invocation->cancel_event), &invocation->cancelled,
+        iree_vm_invocation_complete, invocation);
+    if (!iree_status_is_ok(status)) {
+      iree_vm_invocation_release(invocation);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_invocation = invocation;
+  } else {
+    iree_vm_invocation_release(invocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_vm_invocation_destroy(iree_vm_invocation_t* invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_invocation_pool_t* pool = invocation->pool;
+  invocation->pool = NULL;
+  iree_vm_invocation_reset(invocation);
+  if (pool) {
+    iree_vm_invocation_pool_recycle(pool, invocation);
+    iree_vm_invocation_pool_release(pool);
+  } else {
+    iree_vm_invocation_free(invocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_vm_invocation_retain(
+    iree_vm_invocation_t* invocation) {
+  if (invocation) {
+    iree_atomic_ref_count_inc(&invocation->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_invocation_release(
+    iree_vm_invocation_t* invocation) {
+  if (invocation && iree_atomic_ref_count_dec(&invocation->ref_count) == 1) {
+    iree_vm_invocation_destroy(invocation);
+  }
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_query_status(iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (!iree_vm_invocation_is_completed(invocation)) {
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  return iree_status_clone(invocation->status);
+}
+
+IREE_API_EXPORT const iree_vm_list_t* iree_vm_invocation_outputs(
+    iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (!iree_vm_invocation_is_completed(invocation) ||
+      !iree_status_is_ok(invocation->status)) {
+    return NULL;
+  }
+  return invocation->outputs;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_await(
+    iree_vm_invocation_t* invocation, iree_time_t deadline) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (!iree_notification_await(&invocation->completion_notification,
+                               iree_vm_invocation_is_completed, invocation,
+                               iree_make_deadline(deadline))) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_vm_invocation_query_status(invocation);
+}
+
+IREE_API_EXPORT void iree_vm_invocation_cancel(
+    iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (iree_vm_invocation_is_completed(invocation)) return;
+  iree_atomic_store_int32(&invocation->cancelled, 1, iree_memory_order_release);
+  iree_event_set(&invocation->cancel_event);
+}
@@ -14,13 +14,25 @@
 #include "iree/vm/list.h"
 #include "iree/vm/module.h"
 #include "iree/vm/ref.h"
+#include "iree/vm/stack.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
 typedef struct iree_vm_invocation_t iree_vm_invocation_t;
-typedef struct iree_vm_invocation_policy_t iree_vm_invocation_policy_t;
+
+// Options controlling how an invocation is scheduled and where the resources it
+// creates are allocated.
+typedef struct iree_vm_invocation_policy_t {
+  // Optional arena used for VM objects created during the invocation such as
+  // lists, buffers, HAL buffer views, and fences. When provided invocations
+  // perform no per-object heap allocations in steady state. Objects returned in
+  // the invocation outputs are allocated from the arena and must be released
+  // before the caller resets it with iree_vm_invocation_arena_reset. Programs
+  // must not store objects created by the invocation in module globals.
+  iree_vm_invocation_arena_t* arena;
+} iree_vm_invocation_policy_t;
 
 //===----------------------------------------------------------------------===//
 // Synchronous invocation
@@ -32,8 +44,8 @@ typedef struct iree_vm_invocation_policy_t iree_vm_invocation_policy_t;
 // in-flight then iree_vm_invocation_t should be used.
 //
 // |policy| is used to schedule the invocation relative to other pending or
-// in-flight invocations. It may be omitted to leave the behavior up to the
-// implementation.
+// in-flight invocations and to control where objects it creates are allocated.
+// It may be omitted to leave the behavior up to the implementation.
 //
 // |inputs| is used to pass values and objects into the target function and must
 // match the signature defined by the compiled function. List ownership remains
@@ -102,8 +114,8 @@ typedef struct iree_vm_invoke_state_t {
 // clean up resources from the sequence.
 //
 // |policy| is used to schedule the invocation relative to other pending or
-// in-flight invocations. It may be omitted to leave the behavior up to the
-// implementation.
+// in-flight invocations and to control where objects it creates are allocated.
+// It may be omitted to leave the behavior up to the implementation.
 //
 // |inputs| is used to pass values and objects into the target function and must
 // match the signature defined by the target |function|. List contents are
@@ -198,6 +210,12 @@ typedef iree_status_t(IREE_API_PTR* iree_vm_async_invoke_callback_fn_t)(
     void* user_data, iree_loop_t loop, iree_status_t status,
     iree_vm_list_t* outputs);
 
+// Maximum number of wait sources in a wait-any operation that can be woken by
+// cancellation. Larger wait-any operations observe cancellation only once they
+// resolve. Wait-all operations are waited one source at a time and always
+// observe cancellation.
+#define IREE_VM_ASYNC_INVOKE_CANCELLABLE_WAIT_CAPACITY 4
+
 // Storage for iree_vm_async_invoke state.
 // This is intended to be embedded within higher-level invocation objects or on
 // the heap. When possible (and outputs are provided) the async invocation will
@@ -214,7 +232,8 @@ typedef struct iree_vm_async_invoke_state_t {
       iree_vm_function_t function;
       // Flags controlling invocation behavior.
       iree_vm_invocation_flags_t flags;
-      // TBD.
+      // Optional invocation policy. Must remain valid until the invocation
+      // completes.
       const iree_vm_invocation_policy_t* policy;
       // Optional input storage list used to call the target function.
       // Released after the function is entered.
@@ -236,6 +255,17 @@ typedef struct iree_vm_async_invoke_state_t {
   // Callback issued when the invocation completes.
   iree_vm_async_invoke_callback_fn_t callback;
   void* user_data;
+  // Optional wait source that cancels the invocation when resolved. Set by
+  // iree_vm_invocation_t and unused (ctl == NULL) for iree_vm_async_invoke.
+  // Only used to wake blocked waits; |cancel_flag| is checked on each tick.
+  iree_wait_source_t cancel_source;
+  // Optional flag set to non-zero before |cancel_source| is resolved. Present
+  // whenever |cancel_source| is.
+  iree_atomic_int32_t* cancel_flag;
+  // Storage for cancellable waits that combine the wait sources of the current
+  // wait frame with |cancel_source|. Loops may modify the list while waiting.
+  iree_wait_source_t
+      cancel_wait_sources[IREE_VM_ASYNC_INVOKE_CANCELLABLE_WAIT_CAPACITY + 1];
 } iree_vm_async_invoke_state_t;
 
 // Asynchronously invokes |function| in |context| on the given |loop|.
@@ -294,20 +324,67 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
 // Asynchronous stateful invocation
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): document and implement.
+// A pool of reusable invocation objects.
+// Each pooled invocation owns its VM stack storage, input/output lists, and
+// cancellation event and all are reused when an invocation is released back to
+// the pool. Once the pool has warmed up to the peak number of concurrent
+// invocations and the lists have grown to the largest argument/result counts
+// used no further heap allocations are made when invoking functions that fit
+// within the inline stack storage.
+//
+// Thread-safe: invocations may be created and released from any thread.
+typedef struct iree_vm_invocation_pool_t iree_vm_invocation_pool_t;
+
+// Creates an empty invocation pool allocating from |host_allocator|.
+IREE_API_EXPORT iree_status_t iree_vm_invocation_pool_create(
+    iree_allocator_t host_allocator, iree_vm_invocation_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+IREE_API_EXPORT void iree_vm_invocation_pool_retain(
+    iree_vm_invocation_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+// Invocations created from the pool retain it until they are released.
+IREE_API_EXPORT void iree_vm_invocation_pool_release(
+    iree_vm_invocation_pool_t* pool);
+
+// Frees all invocations currently unused in the pool.
+IREE_API_EXPORT void iree_vm_invocation_pool_trim(
+    iree_vm_invocation_pool_t* pool);
+
+// Creates and launches an asynchronous invocation of |function| in |context|
+// on the given |loop|. The invocation is scheduled with iree_vm_async_invoke
+// and progresses as the loop runs; callers can poll it with
+// iree_vm_invocation_query_status or block on it with iree_vm_invocation_await.
+// Note that with inline loops the invocation may complete before this returns.
+//
+// |inputs| are copied into storage owned by the invocation and the list can be
+// reused by the caller immediately after this returns.
+//
+// If |pool| is provided the invocation is acquired from and returned to it.
+// Otherwise it is allocated from |allocator| and freed when released.
+// |allocator| is also used for any transient allocations made during the
+// invocation such as when the VM stack must grow beyond its inline storage.
+//
+// |policy| is copied into the invocation. If it specifies an arena the outputs
+// are allocated from it and the invocation must be released before the arena
+// is reset.
 IREE_API_EXPORT iree_status_t iree_vm_invocation_create(
     iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
-    const iree_vm_list_t* inputs, iree_allocator_t allocator,
+    const iree_vm_list_t* inputs, iree_loop_t loop,
+    iree_vm_invocation_pool_t* pool, iree_allocator_t allocator,
     iree_vm_invocation_t** out_invocation);
 
 // Retains the given |invocation| for the caller.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_retain(iree_vm_invocation_t* invocation);
+IREE_API_EXPORT void iree_vm_invocation_retain(
+    iree_vm_invocation_t* invocation);
 
 // Releases the given |invocation| from the caller.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_release(iree_vm_invocation_t* invocation);
+// In-flight invocations keep running until they complete and are then
+// returned to their pool.
+IREE_API_EXPORT void iree_vm_invocation_release(
+    iree_vm_invocation_t* invocation);
 
 // Queries the completion status of the invocation.
 // Returns one of the following:
@@ -329,6 +406,8 @@ IREE_API_EXPORT const iree_vm_list_t* iree_vm_invocation_outputs(
     iree_vm_invocation_t* invocation);
 
 // Blocks the caller until the invocation completes (successfully or otherwise).
+// The loop the invocation was created with must be run by another thread; loops
+// driven by the caller (such as iree_loop_sync_t) must be drained first.
 //
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if |deadline| elapses before the
 // invocation completes and otherwise returns iree_vm_invocation_query_status.
@@ -338,6 +417,11 @@ IREE_API_EXPORT iree_status_t iree_vm_invocation_await(
 // Attempts to cancel the invocation if it is in-flight.
 // Cancellation is not guaranteed to work and should be considered a hint.
 // A no-op if the invocation has already completed.
+//
+// Pending waits (such as on HAL fences) are woken and resume with
+// IREE_STATUS_CANCELLED as their wait status and yielded invocations fail with
+// IREE_STATUS_CANCELLED when next scheduled. Work already submitted by the
+// program (such as to devices) is not cancelled.
 IREE_API_EXPORT void iree_vm_invocation_cancel(
     iree_vm_invocation_t* invocation);
 
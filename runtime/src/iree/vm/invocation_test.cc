@@ -0,0 +1,471 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/invocation.h"
+
+#include "iree/base/api.h"
+#include "iree/base/internal/wait_handle.h"
+#include "iree/base/loop_sync.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_semaphore.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/list.h"
+#include "iree/vm/native_module.h"
+#include "iree/vm/ref_cc.h"
+#include "iree/vm/stack.h"
+#include "iree/vm/value.h"
+
+namespace {
+
+using ::iree::Status;
+using ::iree::StatusCode;
+using ::iree::testing::status::StatusIs;
+
+// Module self pointer holding the objects the test functions wait on.
+typedef struct {
+  iree_event_t event;
+  iree_hal_semaphore_t* semaphore;
+} test_module_t;
+
+typedef struct {
+  int32_t arg0;
+} args_i32_t;
+typedef struct {
+  int32_t ret0;
+} rets_i32_t;
+
+// test.add_1(%arg0 : i32) -> i32
+static iree_status_t test_add_1_shim(
+    iree_vm_stack_t* stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target_t target_fn, void* module,
+    void* module_state) {
+  const args_i32_t* args = (const args_i32_t*)args_storage.data;
+  rets_i32_t* rets = (rets_i32_t*)rets_storage.data;
+  rets->ret0 = args->arg0 + 1;
+  return iree_ok_status();
+}
+
+// Yields to the scheduler with a wait-all on |wait_source| and returns |arg0|
+// once the wait succeeds. Wait failures are propagated as invocation failures,
+// like HAL fence waits.
+static iree_status_t test_wait_on(iree_vm_stack_t* stack,
+                                  iree_vm_native_function_flags_t flags,
+                                  iree_byte_span_t args_storage,
+                                  iree_byte_span_t rets_storage,
+                                  iree_wait_source_t wait_source) {
+  rets_i32_t* rets = (rets_i32_t*)rets_storage.data;
+  if (flags & IREE_VM_NATIVE_FUNCTION_CALL_BEGIN) {
+    // Results storage is stable across the yield so the argument is stashed
+    // there until resumed.
+    const args_i32_t* args = (const args_i32_t*)args_storage.data;
+    rets->ret0 = args->arg0;
+    iree_vm_wait_frame_t* wait_frame = NULL;
+    IREE_RETURN_IF_ERROR(iree_vm_stack_wait_enter(
+        stack, IREE_VM_WAIT_ALL, 1, iree_infinite_timeout(),
+        /*trace_zone=*/0, &wait_frame));
+    wait_frame->wait_sources[0] = wait_source;
+    wait_frame->count = 1;
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  iree_vm_wait_result_t wait_result;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_wait_leave(stack, &wait_result));
+  return wait_result.status;
+}
+
+// test.wait(%arg0 : i32) -> i32
+// Waits on the module event and returns |arg0|.
+static iree_status_t test_wait_shim(iree_vm_stack_t* stack,
+                                    iree_vm_native_function_flags_t flags,
+                                    iree_byte_span_t args_storage,
+                                    iree_byte_span_t rets_storage,
+                                    iree_vm_native_function_target_t target_fn,
+                                    void* module, void* module_state) {
+  return test_wait_on(stack, flags, args_storage, rets_storage,
+                      iree_event_await(&((test_module_t*)module)->event));
+}
+
+// test.wait_semaphore(%arg0 : i32) -> i32
+// Waits on the module semaphore reaching 1 as HAL fence awaits do and returns
+// |arg0|.
+static iree_status_t test_wait_semaphore_shim(
+    iree_vm_stack_t* stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target_t target_fn, void* module,
+    void* module_state) {
+  return test_wait_on(
+      stack, flags, args_storage, rets_storage,
+      iree_hal_semaphore_await(((test_module_t*)module)->semaphore, 1));
+}
+
+// test.iota(%arg0 : i32) -> !vm.list<i32>
+// Returns a list of [0, arg0) grown one element at a time from the invocation
+// object allocator.
+static iree_status_t test_iota_shim(iree_vm_stack_t* stack,
+                                    iree_vm_native_function_flags_t flags,
+                                    iree_byte_span_t args_storage,
+                                    iree_byte_span_t rets_storage,
+                                    iree_vm_native_function_target_t target_fn,
+                                    void* module, void* module_state) {
+  const args_i32_t* args = (const args_i32_t*)args_storage.data;
+  iree_vm_ref_t* ret0 = (iree_vm_ref_t*)rets_storage.data;
+  iree_vm_list_t* list = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_create(
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32), 1,
+      iree_vm_stack_object_allocator(stack, iree_allocator_system()), &list));
+  iree_status_t status = iree_ok_status();
+  for (int32_t i = 0; i < args->arg0 && iree_status_is_ok(status); ++i) {
+    iree_vm_value_t value = iree_vm_value_make_i32(i);
+    status = iree_vm_list_push_value(list, &value);
+  }
+  if (iree_status_is_ok(status)) {
+    *ret0 = iree_vm_list_move_ref(list);
+  } else {
+    iree_vm_list_release(list);
+  }
+  return status;
+}
+
+static const iree_vm_native_export_descriptor_t test_exports_[] = {
+    {iree_make_cstring_view("add_1"), iree_make_cstring_view("0i_i"), 0, NULL},
+    {iree_make_cstring_view("iota"), iree_make_cstring_view("0i_r"), 0, NULL},
+    {iree_make_cstring_view("wait"), iree_make_cstring_view("0i_i"), 0, NULL},
+    {iree_make_cstring_view("wait_semaphore"), iree_make_cstring_view("0i_i"),
+     0, NULL},
+};
+static const iree_vm_native_function_ptr_t test_funcs_[] = {
+    {(iree_vm_native_function_shim_t)test_add_1_shim, NULL},
+    {(iree_vm_native_function_shim_t)test_iota_shim, NULL},
+    {(iree_vm_native_function_shim_t)test_wait_shim, NULL},
+    {(iree_vm_native_function_shim_t)test_wait_semaphore_shim, NULL},
+};
+static const iree_vm_native_module_descriptor_t test_descriptor_ = {
+    /*name=*/iree_make_cstring_view("test"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(test_exports_),
+    /*exports=*/test_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(test_funcs_),
+    /*functions=*/test_funcs_,
+};
+
+// Allocator forwarding to the system allocator that counts allocations.
+struct CountingAllocator {
+  int allocation_count = 0;
+
+  iree_allocator_t allocator() { return {this, Ctl}; }
+
+  static iree_status_t Ctl(void* self, iree_allocator_command_t command,
+                           const void* params, void** inout_ptr) {
+    auto* counting = static_cast<CountingAllocator*>(self);
+    if (command == IREE_ALLOCATOR_COMMAND_MALLOC ||
+        command == IREE_ALLOCATOR_COMMAND_CALLOC ||
+        command == IREE_ALLOCATOR_COMMAND_REALLOC) {
+      ++counting->allocation_count;
+    }
+    iree_allocator_t system = iree_allocator_system();
+    return system.ctl(system.self, command, params, inout_ptr);
+  }
+};
+
+class VMInvocationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(
+        iree_event_initialize(/*initial_state=*/false, &test_module_.event));
+    iree_hal_sync_semaphore_state_initialize(&semaphore_state_);
+    IREE_ASSERT_OK(iree_hal_sync_semaphore_create(&semaphore_state_, 0ull,
+                                                  iree_allocator_system(),
+                                                  &test_module_.semaphore));
+    IREE_ASSERT_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                           iree_allocator_system(),
+                                           &instance_));
+    iree_vm_module_t interface;
+    IREE_ASSERT_OK(iree_vm_module_initialize(&interface, &test_module_));
+    iree_vm_module_t* module = NULL;
+    IREE_ASSERT_OK(iree_vm_native_module_create(&interface, &test_descriptor_,
+                                                instance_,
+                                                iree_allocator_system(),
+                                                &module));
+    IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &module,
+        iree_allocator_system(), &context_));
+    iree_vm_module_release(module);
+    IREE_ASSERT_OK(
+        iree_vm_invocation_pool_create(iree_allocator_system(), &pool_));
+    IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                       iree_allocator_system(), &inputs_));
+
+    iree_loop_sync_options_t options = {0};
+    options.max_queue_depth = 16;
+    options.max_wait_count = 16;
+    IREE_ASSERT_OK(iree_loop_sync_allocate(options, iree_allocator_system(),
+                                           &loop_sync_));
+    iree_loop_sync_scope_initialize(
+        loop_sync_,
+        +[](void* user_data, iree_status_t status) {
+          iree_status_ignore(status);
+        },
+        NULL, &scope_);
+  }
+
+  void TearDown() override {
+    iree_loop_sync_scope_deinitialize(&scope_);
+    iree_loop_sync_free(loop_sync_);
+    iree_vm_list_release(inputs_);
+    iree_vm_invocation_pool_release(pool_);
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+    iree_hal_semaphore_release(test_module_.semaphore);
+    iree_hal_sync_semaphore_state_deinitialize(&semaphore_state_);
+    iree_event_deinitialize(&test_module_.event);
+  }
+
+  // Creates an invocation of test.|name| with an i32 |arg0| on |loop|.
+  iree_vm_invocation_t* Invoke(
+      const char* name, int32_t arg0, iree_loop_t loop,
+      const iree_vm_invocation_policy_t* policy = NULL,
+      iree_allocator_t host_allocator = iree_allocator_system()) {
+    iree_vm_function_t function;
+    IREE_CHECK_OK(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view(name), &function));
+    iree_vm_list_clear(inputs_);
+    iree_vm_value_t arg0_value = iree_vm_value_make_i32(arg0);
+    IREE_CHECK_OK(iree_vm_list_push_value(inputs_, &arg0_value));
+    iree_vm_invocation_t* invocation = NULL;
+    IREE_CHECK_OK(iree_vm_invocation_create(
+        context_, function, IREE_VM_INVOCATION_FLAG_NONE, policy, inputs_, loop,
+        pool_, host_allocator, &invocation));
+    return invocation;
+  }
+
+  // Returns the i32 result of a successfully completed |invocation|.
+  int32_t Result(iree_vm_invocation_t* invocation) {
+    const iree_vm_list_t* outputs = iree_vm_invocation_outputs(invocation);
+    EXPECT_NE(outputs, nullptr);
+    if (!outputs) return -1;
+    iree_vm_value_t value;
+    IREE_CHECK_OK(iree_vm_list_get_value((iree_vm_list_t*)outputs, 0, &value));
+    return value.i32;
+  }
+
+  iree_loop_t sync_loop() { return iree_loop_sync_scope(&scope_); }
+
+  test_module_t test_module_;
+  iree_hal_sync_semaphore_state_t semaphore_state_;
+  iree_vm_instance_t* instance_ = NULL;
+  iree_vm_context_t* context_ = NULL;
+  iree_vm_invocation_pool_t* pool_ = NULL;
+  iree_vm_list_t* inputs_ = NULL;
+  iree_loop_sync_t* loop_sync_ = NULL;
+  iree_loop_sync_scope_t scope_;
+};
+
+// Invocations on an inline loop complete before creation returns.
+TEST_F(VMInvocationTest, InlineCompletion) {
+  iree_status_t loop_status = iree_ok_status();
+  iree_vm_invocation_t* invocation =
+      Invoke("test.add_1", 41, iree_loop_inline(&loop_status));
+  IREE_ASSERT_OK(loop_status);
+  IREE_EXPECT_OK(iree_vm_invocation_query_status(invocation));
+  IREE_EXPECT_OK(
+      iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(Result(invocation), 42);
+  iree_vm_invocation_release(invocation);
+}
+
+// Released invocations are reused by the pool.
+TEST_F(VMInvocationTest, PoolReuse) {
+  iree_status_t loop_status = iree_ok_status();
+  iree_vm_invocation_t* first =
+      Invoke("test.add_1", 1, iree_loop_inline(&loop_status));
+  EXPECT_EQ(Result(first), 2);
+  iree_vm_invocation_release(first);
+  iree_vm_invocation_t* second =
+      Invoke("test.add_1", 2, iree_loop_inline(&loop_status));
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(Result(second), 3);
+  iree_vm_invocation_release(second);
+  IREE_ASSERT_OK(loop_status);
+}
+
+// Once warmed up invocations recycled from the pool perform no allocations.
+TEST_F(VMInvocationTest, PoolReuseWithoutAllocations) {
+  CountingAllocator counting_allocator;
+  iree_vm_invocation_pool_release(pool_);
+  IREE_ASSERT_OK(
+      iree_vm_invocation_pool_create(counting_allocator.allocator(), &pool_));
+  iree_status_t loop_status = iree_ok_status();
+  for (int32_t i = 0; i < 4; ++i) {
+    if (i == 1) {
+      // The first invocation allocates the pooled storage.
+      EXPECT_GT(counting_allocator.allocation_count, 0);
+      counting_allocator.allocation_count = 0;
+    }
+    iree_vm_invocation_t* invocation =
+        Invoke("test.add_1", i, iree_loop_inline(&loop_status),
+               /*policy=*/NULL, counting_allocator.allocator());
+    IREE_ASSERT_OK(loop_status);
+    EXPECT_EQ(Result(invocation), i + 1);
+    iree_vm_invocation_release(invocation);
+  }
+  EXPECT_EQ(counting_allocator.allocation_count, 0);
+}
+
+// Invocations waiting on the loop complete once their wait resolves.
+TEST_F(VMInvocationTest, WaitCompletion) {
+  iree_vm_invocation_t* invocation = Invoke("test.wait", 7, sync_loop());
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_immediate_timeout()));
+  EXPECT_THAT(Status(iree_vm_invocation_query_status(invocation)),
+              StatusIs(StatusCode::kDeferred));
+  EXPECT_THAT(Status(iree_vm_invocation_await(invocation, 0)),
+              StatusIs(StatusCode::kDeadlineExceeded));
+  EXPECT_EQ(iree_vm_invocation_outputs(invocation), nullptr);
+  iree_event_set(&test_module_.event);
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_infinite_timeout()));
+  IREE_EXPECT_OK(
+      iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(Result(invocation), 7);
+  iree_vm_invocation_release(invocation);
+}
+
+// Cancellation wakes pending waits and fails the invocation.
+TEST_F(VMInvocationTest, CancelWait) {
+  iree_vm_invocation_t* invocation = Invoke("test.wait", 7, sync_loop());
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_immediate_timeout()));
+  iree_vm_invocation_cancel(invocation);
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_infinite_timeout()));
+  EXPECT_THAT(Status(iree_vm_invocation_await(invocation,
+                                              IREE_TIME_INFINITE_FUTURE)),
+              StatusIs(StatusCode::kCancelled));
+  EXPECT_EQ(iree_vm_invocation_outputs(invocation), nullptr);
+  iree_vm_invocation_release(invocation);
+
+  // The recycled invocation is no longer cancelled.
+  iree_event_set(&test_module_.event);
+  invocation = Invoke("test.wait", 8, sync_loop());
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_infinite_timeout()));
+  EXPECT_EQ(Result(invocation), 8);
+  iree_vm_invocation_release(invocation);
+}
+
+// Cancellation wakes invocations blocked on HAL semaphore waits, which cannot
+// be exported to the loop as wait handles.
+TEST_F(VMInvocationTest, CancelSemaphoreWait) {
+  iree_vm_invocation_t* invocation =
+      Invoke("test.wait_semaphore", 7, sync_loop());
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_immediate_timeout()));
+  EXPECT_THAT(Status(iree_vm_invocation_query_status(invocation)),
+              StatusIs(StatusCode::kDeferred));
+  iree_vm_invocation_cancel(invocation);
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_infinite_timeout()));
+  EXPECT_THAT(Status(iree_vm_invocation_await(invocation,
+                                              IREE_TIME_INFINITE_FUTURE)),
+              StatusIs(StatusCode::kCancelled));
+  EXPECT_EQ(iree_vm_invocation_outputs(invocation), nullptr);
+  iree_vm_invocation_release(invocation);
+
+  // Uncancelled invocations complete once the semaphore is signaled.
+  invocation = Invoke("test.wait_semaphore", 8, sync_loop());
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_immediate_timeout()));
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(test_module_.semaphore, 1));
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_infinite_timeout()));
+  EXPECT_EQ(Result(invocation), 8);
+  iree_vm_invocation_release(invocation);
+}
+
+// Objects created by invocations with an arena are allocated from it and the
+// arena can only be reset once they have all been released.
+TEST_F(VMInvocationTest, Arena) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(256, iree_allocator_system(), &block_pool);
+  iree_vm_invocation_arena_t arena;
+  iree_vm_invocation_arena_initialize(&block_pool, &arena);
+  iree_vm_invocation_policy_t policy = {&arena};
+
+  for (int32_t count = 1; count <= 64; count *= 8) {
+    iree_status_t loop_status = iree_ok_status();
+    iree_vm_invocation_t* invocation = Invoke(
+        "test.iota", count, iree_loop_inline(&loop_status), &policy);
+    IREE_ASSERT_OK(loop_status);
+    IREE_ASSERT_OK(
+        iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE));
+    iree_vm_list_t* list = (iree_vm_list_t*)iree_vm_list_get_ref_deref(
+        iree_vm_invocation_outputs(invocation), 0, iree_vm_list_type());
+    ASSERT_NE(list, nullptr);
+    ASSERT_EQ(iree_vm_list_size(list), count);
+    for (int32_t i = 0; i < count; ++i) {
+      iree_vm_value_t value;
+      IREE_ASSERT_OK(iree_vm_list_get_value(list, i, &value));
+      EXPECT_EQ(value.i32, i);
+    }
+    EXPECT_GT(
+        iree_atomic_load_int64(&arena.live_count, iree_memory_order_relaxed),
+        0);
+
+    // The list in the outputs is still live.
+    EXPECT_THAT(Status(iree_vm_invocation_arena_reset(&arena)),
+                StatusIs(StatusCode::kFailedPrecondition));
+    EXPECT_THAT(Status(iree_vm_invocation_arena_deinitialize(&arena)),
+                StatusIs(StatusCode::kFailedPrecondition));
+    iree_vm_invocation_release(invocation);
+    EXPECT_EQ(
+        iree_atomic_load_int64(&arena.live_count, iree_memory_order_relaxed),
+        0);
+    IREE_ASSERT_OK(iree_vm_invocation_arena_reset(&arena));
+  }
+
+  IREE_ASSERT_OK(iree_vm_invocation_arena_deinitialize(&arena));
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+// An arena can only be used by one invocation at a time.
+TEST_F(VMInvocationTest, ArenaRejectsConcurrentInvocations) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(256, iree_allocator_system(), &block_pool);
+  iree_vm_invocation_arena_t arena;
+  iree_vm_invocation_arena_initialize(&block_pool, &arena);
+  iree_vm_invocation_policy_t policy = {&arena};
+
+  iree_vm_invocation_t* pending = Invoke("test.wait", 7, sync_loop(), &policy);
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_immediate_timeout()));
+
+  // Invocations begin on the loop and fail there.
+  iree_vm_invocation_t* concurrent =
+      Invoke("test.add_1", 1, sync_loop(), &policy);
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_immediate_timeout()));
+  EXPECT_THAT(Status(iree_vm_invocation_await(concurrent,
+                                              IREE_TIME_INFINITE_FUTURE)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  iree_vm_invocation_release(concurrent);
+  EXPECT_THAT(Status(iree_vm_invocation_arena_reset(&arena)),
+              StatusIs(StatusCode::kFailedPrecondition));
+
+  // Once the pending invocation completes the arena can be used again.
+  iree_event_set(&test_module_.event);
+  IREE_ASSERT_OK(iree_loop_drain(sync_loop(), iree_infinite_timeout()));
+  EXPECT_EQ(Result(pending), 7);
+  iree_vm_invocation_release(pending);
+  iree_status_t loop_status = iree_ok_status();
+  iree_vm_invocation_t* invocation = Invoke(
+      "test.add_1", 1, iree_loop_inline(&loop_status), &policy);
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_EQ(Result(invocation), 2);
+  iree_vm_invocation_release(invocation);
+
+  IREE_ASSERT_OK(iree_vm_invocation_arena_deinitialize(&arena));
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+}  // namespace
@@ -784,6 +784,91 @@ iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   return iree_vm_list_set_value(list, i, value);
 }
 
+// Returns an error if the range [i, i + count) is not within the list size.
+static iree_status_t iree_vm_list_check_range(const iree_vm_list_t* list,
+                                              iree_host_size_t i,
+                                              iree_host_size_t count) {
+  if (IREE_UNLIKELY(i > list->count || count > list->count - i)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%" PRIhsz ", %" PRIhsz
+                            ") out of bounds (%" PRIhsz ")",
+                            i, i + count, list->count);
+  }
+  return iree_ok_status();
+}
+
+// Returns true if |list| stores |value_type| elements as a dense array.
+static bool iree_vm_list_stores_value_type(const iree_vm_list_t* list,
+                                           iree_vm_value_type_t value_type) {
+  return list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE &&
+         iree_vm_type_def_as_value(list->element_type) == value_type;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, void* out_values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, i, count));
+  const iree_host_size_t value_size =
+      iree_vm_value_type_size(iree_vm_make_value_type_def(value_type));
+  if (iree_vm_list_stores_value_type(list, value_type)) {
+    memcpy(out_values, (uint8_t*)list->storage + i * value_size,
+           count * value_size);
+    return iree_ok_status();
+  }
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_value_t value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value_as(list, i + j, value_type, &value));
+    memcpy((uint8_t*)out_values + j * value_size, value.value_storage,
+           value_size);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, i, count));
+  const iree_host_size_t value_size =
+      iree_vm_value_type_size(iree_vm_make_value_type_def(value_type));
+  if (iree_vm_list_stores_value_type(list, value_type)) {
+    memcpy((uint8_t*)list->storage + i * value_size, values,
+           count * value_size);
+    return iree_ok_status();
+  }
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_value_t value;
+    memset(&value, 0, sizeof(value));
+    value.type = value_type;
+    memcpy(value.value_storage, (const uint8_t*)values + j * value_size,
+           value_size);
+    IREE_RETURN_IF_ERROR(iree_vm_list_set_value(list, i + j, &value));
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_push_values(
+    iree_vm_list_t* list, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values) {
+  iree_host_size_t i = iree_vm_list_size(list);
+  IREE_RETURN_IF_ERROR(iree_vm_list_resize(list, i + count));
+  return iree_vm_list_set_values(list, i, count, value_type, values);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_list_map_values(iree_vm_list_t* list, iree_vm_value_type_t value_type,
+                        iree_byte_span_t* out_storage) {
+  *out_storage = iree_make_byte_span(NULL, 0);
+  if (IREE_UNLIKELY(!iree_vm_list_stores_value_type(list, value_type))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "list does not store elements of value type %d",
+                            (int)value_type);
+  }
+  *out_storage =
+      iree_make_byte_span(list->storage, list->count * list->element_size);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
                                                  iree_host_size_t i,
                                                  iree_vm_ref_type_t type) {
@@ -906,6 +991,99 @@ IREE_API_EXPORT iree_status_t iree_vm_list_push_ref_move(iree_vm_list_t* list,
   return iree_vm_list_set_ref_move(list, i, value);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* out_values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, i, count));
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_REF) {
+    // Variant lists need each element checked; release what we retained if
+    // any element is not a ref.
+    for (iree_host_size_t j = 0; j < count; ++j) {
+      iree_status_t status =
+          iree_vm_list_get_ref_retain(list, i + j, &out_values[j]);
+      if (!iree_status_is_ok(status)) {
+        for (iree_host_size_t k = 0; k < j; ++k) {
+          iree_vm_ref_release(&out_values[k]);
+        }
+        return status;
+      }
+    }
+    return iree_ok_status();
+  }
+  const iree_vm_ref_t* ref_storage = (const iree_vm_ref_t*)list->storage + i;
+  memcpy(out_values, ref_storage, count * sizeof(*out_values));
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_ref_retain_inplace(&out_values[j]);
+  }
+  return iree_ok_status();
+}
+
+// Sets |count| elements starting at |i| to |values| after type checking all of
+// them. If |is_move|=true ownership of the values is transferred to the list.
+static iree_status_t iree_vm_list_set_refs(iree_vm_list_t* list,
+                                           iree_host_size_t i,
+                                           iree_host_size_t count, bool is_move,
+                                           iree_vm_ref_t* values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, i, count));
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_REF: {
+      iree_vm_ref_type_t element_type =
+          iree_vm_type_def_as_ref(list->element_type);
+      if (element_type != IREE_VM_REF_TYPE_ANY) {
+        for (iree_host_size_t j = 0; j < count; ++j) {
+          if (IREE_UNLIKELY(values[j].type != IREE_VM_REF_TYPE_NULL &&
+                            values[j].type != element_type)) {
+            return iree_make_status(
+                IREE_STATUS_INVALID_ARGUMENT,
+                "source ref type mismatch at index %" PRIhsz, i + j);
+          }
+        }
+      }
+      iree_vm_ref_t* ref_storage = (iree_vm_ref_t*)list->storage + i;
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        iree_vm_ref_retain_or_move(is_move, &values[j], &ref_storage[j]);
+      }
+      return iree_ok_status();
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      // Variant lists accept any ref type.
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        IREE_RETURN_IF_ERROR(
+            iree_vm_list_set_ref(list, i + j, is_move, &values[j]));
+      }
+      return iree_ok_status();
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list cannot store refs");
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    const iree_vm_ref_t* values) {
+  return iree_vm_list_set_refs(list, i, count, /*is_move=*/false,
+                               (iree_vm_ref_t*)values);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_move(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* values) {
+  return iree_vm_list_set_refs(list, i, count, /*is_move=*/true, values);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_push_refs_move(
+    iree_vm_list_t* list, iree_host_size_t count, iree_vm_ref_t* values) {
+  iree_host_size_t i = iree_vm_list_size(list);
+  IREE_RETURN_IF_ERROR(iree_vm_list_resize(list, i + count));
+  iree_status_t status = iree_vm_list_set_refs_move(list, i, count, values);
+  if (!iree_status_is_ok(status)) {
+    // Drop the (null) elements we added so the list is unchanged.
+    iree_status_ignore(iree_vm_list_resize(list, i));
+  }
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_list_pop_front_ref_move(
     iree_vm_list_t* list, iree_vm_ref_t* out_value) {
   iree_host_size_t list_size = iree_vm_list_size(list);
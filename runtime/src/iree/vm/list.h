@@ -157,6 +157,38 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value);
 
+// Copies |count| elements starting at index |i| into the dense |out_values|
+// array of |value_type| elements. If the list stores |value_type| values
+// directly this is a single memcpy; otherwise each element is converted as with
+// iree_vm_list_get_value_as.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, void* out_values);
+
+// Sets |count| elements starting at index |i| from the dense |values| array of
+// |value_type| elements. If the list stores |value_type| values directly this
+// is a single memcpy; otherwise each element is converted as with
+// iree_vm_list_set_value.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values);
+
+// Pushes |count| elements from the dense |values| array of |value_type|
+// elements to the end of the list.
+IREE_API_EXPORT iree_status_t iree_vm_list_push_values(
+    iree_vm_list_t* list, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values);
+
+// Returns a zero-copy view of the storage of a primitive |list| holding
+// elements of |value_type| in |out_storage|. The view covers the current size
+// of the list and may be read and written directly. It is invalidated by any
+// operation that may reallocate the list storage (resize, reserve, push, swap).
+// Fails if the list does not store |value_type| elements directly, such as
+// when it is a variant list.
+IREE_API_EXPORT iree_status_t
+iree_vm_list_map_values(iree_vm_list_t* list, iree_vm_value_type_t value_type,
+                        iree_byte_span_t* out_storage);
+
 // Returns a dereferenced pointer to the given type if the element at the
 // given index |i| matches the |type|. Returns NULL on error.
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
@@ -195,6 +227,31 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_ref_move(iree_vm_list_t* list,
 IREE_API_EXPORT iree_status_t iree_vm_list_push_ref_move(iree_vm_list_t* list,
                                                          iree_vm_ref_t* value);
 
+// Returns the |count| ref values starting at index |i| in |out_values|.
+// The refs will be retained and must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* out_values);
+
+// Sets the |count| elements starting at index |i| to the given ref |values|,
+// retaining a reference to each in the list. All values are type checked
+// before any element is changed.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    const iree_vm_ref_t* values);
+
+// Sets the |count| elements starting at index |i| to the given ref |values|,
+// moving ownership of each reference to the list. All values are type checked
+// before any element is changed and on failure no ownership is transferred.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_move(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* values);
+
+// Pushes the |count| ref |values| to the end of the list, moving ownership of
+// each reference to the list.
+IREE_API_EXPORT iree_status_t iree_vm_list_push_refs_move(
+    iree_vm_list_t* list, iree_host_size_t count, iree_vm_ref_t* values);
+
 // Pops the front ref value from the list and transfers ownership to the caller.
 IREE_API_EXPORT iree_status_t
 iree_vm_list_pop_front_ref_move(iree_vm_list_t* list, iree_vm_ref_t* out_value);
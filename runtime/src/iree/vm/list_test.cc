@@ -1253,6 +1253,88 @@ TEST_F(VMListTest, PushPopRef) {
   iree_vm_list_release(list);
 }
 
+// Tests bulk get/set of primitive values with and without conversion.
+TEST_F(VMListTest, BulkValues) {
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I64),
+                          4, iree_allocator_system(), &list));
+  const int64_t values[5] = {0, 1, 2, -3, 4};
+  IREE_ASSERT_OK(
+      iree_vm_list_push_values(list, 5, IREE_VM_VALUE_TYPE_I64, values));
+  EXPECT_EQ(5, iree_vm_list_size(list));
+
+  // Same type (memcpy).
+  int64_t i64_values[3] = {0};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 2, 3, IREE_VM_VALUE_TYPE_I64, i64_values));
+  EXPECT_EQ(2, i64_values[0]);
+  EXPECT_EQ(-3, i64_values[1]);
+  EXPECT_EQ(4, i64_values[2]);
+
+  // Converted.
+  int32_t i32_values[2] = {10, 11};
+  IREE_ASSERT_OK(
+      iree_vm_list_set_values(list, 0, 2, IREE_VM_VALUE_TYPE_I32, i32_values));
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 2, 2, IREE_VM_VALUE_TYPE_I32, i32_values));
+  EXPECT_EQ(2, i32_values[0]);
+  EXPECT_EQ(-3, i32_values[1]);
+
+  // Zero-copy view.
+  iree_byte_span_t storage;
+  IREE_ASSERT_OK(
+      iree_vm_list_map_values(list, IREE_VM_VALUE_TYPE_I64, &storage));
+  ASSERT_EQ(5 * sizeof(int64_t), storage.data_length);
+  EXPECT_EQ(10, ((int64_t*)storage.data)[0]);
+  EXPECT_EQ(11, ((int64_t*)storage.data)[1]);
+  EXPECT_THAT(
+      Status(iree_vm_list_map_values(list, IREE_VM_VALUE_TYPE_I32, &storage)),
+      StatusIs(StatusCode::kInvalidArgument));
+
+  EXPECT_THAT(Status(iree_vm_list_get_values(list, 4, 2, IREE_VM_VALUE_TYPE_I64,
+                                             i64_values)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk get/set of refs including type checking.
+TEST_F(VMListTest, BulkRefs) {
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_ref_type_def(test_a_type()),
+                                     4, iree_allocator_system(), &list));
+  iree_vm_ref_t refs[3] = {MakeRef<A>(0.0f), MakeRef<A>(1.0f),
+                           MakeRef<A>(2.0f)};
+  IREE_ASSERT_OK(iree_vm_list_push_refs_move(list, 3, refs));
+  EXPECT_EQ(3, iree_vm_list_size(list));
+  for (auto& ref : refs) EXPECT_EQ(nullptr, ref.ptr);
+
+  // Mismatched types fail without changing the list or consuming refs.
+  iree_vm_ref_t mixed_refs[2] = {MakeRef<A>(3.0f), MakeRef<B>(4)};
+  EXPECT_THAT(Status(iree_vm_list_set_refs_move(list, 0, 2, mixed_refs)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_NE(nullptr, mixed_refs[0].ptr);
+  iree_vm_ref_release(&mixed_refs[0]);
+  iree_vm_ref_release(&mixed_refs[1]);
+
+  iree_vm_ref_t out_refs[3] = {{0}};
+  IREE_ASSERT_OK(iree_vm_list_get_refs_retain(list, 0, 3, out_refs));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(test_a_isa(out_refs[i]));
+    EXPECT_EQ(i, test_a_deref(out_refs[i])->data());
+  }
+
+  // Retaining sets keep the caller references.
+  IREE_ASSERT_OK(iree_vm_list_set_refs_retain(list, 1, 2, out_refs));
+  auto* a = (A*)iree_vm_list_get_ref_deref(list, 1, test_a_type());
+  ASSERT_NE(nullptr, a);
+  EXPECT_EQ(0, a->data());
+  for (auto& ref : out_refs) iree_vm_ref_release(&ref);
+
+  iree_vm_list_release(list);
+}
+
 // TODO(benvanik): test primitive variant get/set.
 
 // TODO(benvanik): test ref variant get/set.
@@ -417,6 +417,18 @@ typedef struct iree_vm_module_t {
   void(IREE_API_PTR* free_state)(void* self,
                                  iree_vm_module_state_t* module_state);
 
+  // Forks an initialized |parent_state| into a new independent module state.
+  // The new state must behave as if it had been allocated and initialized with
+  // the same sequence of operations as the parent: mutable data (rwdata,
+  // global slots, etc) is copied while immutable resources (executables,
+  // caches, rodata) may be shared by retaining them. Resolved imports are
+  // carried over from the parent and not re-resolved.
+  //
+  // Optional: modules that do not support forking leave this NULL.
+  iree_status_t(IREE_API_PTR* fork_state)(
+      void* self, iree_vm_module_state_t* parent_state,
+      iree_allocator_t allocator, iree_vm_module_state_t** out_module_state);
+
   // Resolves the import with the given ordinal to |function|.
   // The function is guaranteed to remain valid for the lifetime of the module
   // state.
@@ -304,6 +304,24 @@ static void IREE_API_PTR iree_vm_native_module_free_state(
   IREE_ASSERT_EQ(module_state, NULL);
 }
 
+static iree_status_t IREE_API_PTR iree_vm_native_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
+  *out_module_state = NULL;
+  if (module->user_interface.fork_state) {
+    return module->user_interface.fork_state(module->self, parent_state,
+                                             allocator, out_module_state);
+  } else if (module->user_interface.alloc_state) {
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "native module '%.*s' has state but does not support forking",
+        (int)module->descriptor->name.size, module->descriptor->name.data);
+  }
+  // Default to no state.
+  return iree_ok_status();
+}
+
 static iree_status_t IREE_API_PTR iree_vm_native_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -326,6 +344,26 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_notify(
   return iree_ok_status();
 }
 
+// Annotates a failing |status| from the native function at |function_ordinal|.
+static iree_status_t iree_vm_native_module_annotate_call_status(
+    iree_vm_native_module_t* module, uint16_t function_ordinal,
+    iree_status_t status) {
+#if IREE_STATUS_FEATURES & IREE_STATUS_FEATURE_ANNOTATIONS
+  iree_string_view_t module_name IREE_ATTRIBUTE_UNUSED =
+      iree_vm_native_module_name(module);
+  iree_string_view_t function_name IREE_ATTRIBUTE_UNUSED =
+      iree_string_view_empty();
+  iree_status_ignore(iree_vm_native_module_get_export_function(
+      module, function_ordinal, NULL, &function_name, NULL));
+  return iree_status_annotate_f(status,
+                                "while invoking native function %.*s.%.*s",
+                                (int)module_name.size, module_name.data,
+                                (int)function_name.size, function_name.data);
+#else
+  return status;
+#endif  // IREE_STATUS_FEATURES & IREE_STATUS_FEATURE_ANNOTATIONS
+}
+
 static iree_status_t iree_vm_native_module_issue_call(
     iree_vm_native_module_t* module, iree_vm_stack_t* stack,
     iree_vm_stack_frame_t* callee_frame, iree_vm_native_function_flags_t flags,
@@ -346,20 +384,8 @@ static iree_status_t iree_vm_native_module_issue_call(
   }
 
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
-#if IREE_STATUS_FEATURES & IREE_STATUS_FEATURE_ANNOTATIONS
-    iree_string_view_t module_name IREE_ATTRIBUTE_UNUSED =
-        iree_vm_native_module_name(module);
-    iree_string_view_t function_name IREE_ATTRIBUTE_UNUSED =
-        iree_string_view_empty();
-    iree_status_ignore(iree_vm_native_module_get_export_function(
-        module, function_ordinal, NULL, &function_name, NULL));
-    return iree_status_annotate_f(status,
-                                  "while invoking native function %.*s.%.*s",
-                                  (int)module_name.size, module_name.data,
-                                  (int)function_name.size, function_name.data);
-#else
-    return status;
-#endif  // IREE_STATUS_FEATURES & IREE_STATUS_FEATURE_ANNOTATIONS
+    return iree_vm_native_module_annotate_call_status(module, function_ordinal,
+                                                      status);
   }
 
   // Call completed successfully; pop the stack and return to caller.
@@ -415,6 +441,82 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_resume_call(
       iree_byte_span_empty(), call_results);  // tail
 }
 
+IREE_API_EXPORT bool iree_vm_native_module_resolve_direct_call(
+    const iree_vm_function_t* function,
+    iree_vm_native_function_direct_call_t* out_direct_call) {
+  IREE_ASSERT_ARGUMENT(function);
+  IREE_ASSERT_ARGUMENT(out_direct_call);
+  memset(out_direct_call, 0, sizeof(*out_direct_call));
+
+  // Only modules routing calls through our default begin_call are known to
+  // use the descriptor function table; anything else (including native
+  // modules wrapped by another module implementation) must use begin_call.
+  iree_vm_module_t* base_module = function->module;
+  if (!base_module ||
+      base_module->begin_call != iree_vm_native_module_begin_call) {
+    return false;
+  }
+  iree_vm_native_module_t* module = (iree_vm_native_module_t*)base_module->self;
+  if (module->user_interface.begin_call ||
+      function->linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT ||
+      function->ordinal >= module->descriptor->export_count) {
+    return false;
+  }
+
+  const iree_vm_native_function_ptr_t* function_ptr =
+      &module->descriptor->functions[function->ordinal];
+  out_direct_call->shim = function_ptr->shim;
+  out_direct_call->target = function_ptr->target;
+  out_direct_call->register_target = function_ptr->register_target;
+  out_direct_call->module = module->self;
+  return true;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_native_module_begin_direct_call(
+    iree_vm_stack_t* stack, const iree_vm_function_t* function,
+    const iree_vm_native_function_direct_call_t* direct_call,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage) {
+  iree_vm_stack_frame_t* callee_frame = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter(
+      stack, function, IREE_VM_STACK_FRAME_NATIVE, /*frame_size=*/0,
+      /*frame_cleanup_fn=*/NULL, &callee_frame));
+  iree_status_t status = direct_call->shim(
+      stack, IREE_VM_NATIVE_FUNCTION_CALL_BEGIN, args_storage, rets_storage,
+      direct_call->target, direct_call->module, callee_frame->module_state);
+  if (IREE_LIKELY(iree_status_is_ok(status))) {
+    return iree_vm_stack_function_leave(stack);
+  } else if (iree_status_is_deferred(status)) {
+    return status;  // resumed via resume_call using the preserved frame
+  }
+  return iree_vm_native_module_annotate_call_status(
+      (iree_vm_native_module_t*)function->module->self, function->ordinal,
+      status);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_native_module_begin_register_call(
+    iree_vm_stack_t* stack, const iree_vm_function_t* function,
+    const iree_vm_native_function_direct_call_t* direct_call,
+    const iree_vm_native_register_call_t* call) {
+  IREE_ASSERT(direct_call->register_target);
+
+  // Entering a frame may grow the stack and relocate the caller registers so
+  // register calls only query the (cached) module state.
+  iree_vm_module_state_t* module_state = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_query_module_state(stack, function->module,
+                                                        &module_state));
+  iree_status_t status = direct_call->register_target(
+      stack, direct_call->module, module_state, call);
+  if (IREE_LIKELY(iree_status_is_ok(status))) return status;
+  if (iree_status_is_deferred(status)) {
+    iree_status_ignore(status);
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "register-call targets must not yield");
+  }
+  return iree_vm_native_module_annotate_call_status(
+      (iree_vm_native_module_t*)function->module->self, function->ordinal,
+      status);
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_native_module_create(
     const iree_vm_module_t* module_interface,
     const iree_vm_native_module_descriptor_t* module_descriptor,
@@ -519,6 +621,7 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
       iree_vm_native_module_get_function_attr;
   module->base_interface.alloc_state = iree_vm_native_module_alloc_state;
   module->base_interface.free_state = iree_vm_native_module_free_state;
+  module->base_interface.fork_state = iree_vm_native_module_fork_state;
   module->base_interface.resolve_import = iree_vm_native_module_resolve_import;
   module->base_interface.notify = iree_vm_native_module_notify;
   module->base_interface.begin_call = iree_vm_native_module_begin_call;
@@ -10,6 +10,7 @@
 #define IREE_VM_NATIVE_MODULE_H_
 
 #include <stdint.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/vm/instance.h"
@@ -66,12 +67,91 @@ typedef iree_status_t(IREE_API_PTR* iree_vm_native_function_shim_t)(
     iree_vm_native_function_target_t target_fn, void* module,
     void* module_state);
 
+// Mask of the register ordinal in a ref register list entry.
+// Matches the bytecode register encoding where the upper bits of ref ordinals
+// carry flags such as whether the caller is moving the reference.
+#define IREE_VM_NATIVE_REGISTER_REF_MASK 0x3FFFu
+
+// Caller register file passed to a register-call target function.
+// Register-call targets read arguments from and write results to the caller
+// registers in place instead of the packed ABI buffers used by shims.
+//
+// Entries in |arguments| and |results| are ordered by the function calling
+// convention with one entry per value (i64/f64 values span two consecutive i32
+// registers starting at the listed ordinal). Variadic spans are flattened and
+// |segment_sizes| contains the element count of each span by cconv position.
+typedef struct iree_vm_native_register_call_t {
+  // Base of the caller i32 register bank.
+  int32_t* i32;
+  // Base of the caller ref register bank.
+  iree_vm_ref_t* ref;
+  // Segment sizes for variadic calls or NULL if the call is not variadic.
+  const iree_vm_register_list_t* segment_sizes;
+  // Caller registers holding the arguments.
+  const iree_vm_register_list_t* arguments;
+  // Caller registers receiving the results.
+  const iree_vm_register_list_t* results;
+} iree_vm_native_register_call_t;
+
+// Returns the i32 argument at position |i| in the register list.
+static inline int32_t iree_vm_native_register_call_arg_i32(
+    const iree_vm_native_register_call_t* call, iree_host_size_t i) {
+  return call->i32[call->arguments->registers[i]];
+}
+
+// Returns the i64 argument at position |i| in the register list.
+static inline int64_t iree_vm_native_register_call_arg_i64(
+    const iree_vm_native_register_call_t* call, iree_host_size_t i) {
+  int64_t value = 0;
+  memcpy(&value, &call->i32[call->arguments->registers[i]], sizeof(value));
+  return value;
+}
+
+// Returns the ref argument at position |i| in the register list.
+// The reference is borrowed from the caller and must be retained if it is
+// stored beyond the call.
+static inline iree_vm_ref_t* iree_vm_native_register_call_arg_ref(
+    const iree_vm_native_register_call_t* call, iree_host_size_t i) {
+  return &call->ref[call->arguments->registers[i] &
+                    IREE_VM_NATIVE_REGISTER_REF_MASK];
+}
+
+// Stores |value| into the i32 result at position |i| in the register list.
+static inline void iree_vm_native_register_call_set_i32(
+    const iree_vm_native_register_call_t* call, iree_host_size_t i,
+    int32_t value) {
+  call->i32[call->results->registers[i]] = value;
+}
+
+// Moves |ref| into the ref result at position |i| in the register list.
+// Result registers may alias argument registers and must only be written once
+// all arguments have been consumed.
+static inline void iree_vm_native_register_call_move_ref(
+    const iree_vm_native_register_call_t* call, iree_host_size_t i,
+    iree_vm_ref_t* ref) {
+  iree_vm_ref_move(ref, &call->ref[call->results->registers[i] &
+                                   IREE_VM_NATIVE_REGISTER_REF_MASK]);
+}
+
+// Target function taking arguments and results in caller registers.
+// Register-call targets must complete synchronously (never returning a deferred
+// status) and must not enter the VM stack as the caller register storage is
+// only valid until the stack is modified.
+typedef iree_status_t(IREE_API_PTR* iree_vm_native_function_register_target_t)(
+    iree_vm_stack_t* stack, void* module, void* module_state,
+    const iree_vm_native_register_call_t* call);
+
 // An entry in the function pointer table.
 typedef struct iree_vm_native_function_ptr_t {
   // A shim function that takes the VM ABI and maps it to the target ABI.
   iree_vm_native_function_shim_t shim;
   // Target function passed to the shim.
   iree_vm_native_function_target_t target;
+  // Optional target taking arguments and results in caller registers.
+  // Callers with a register file (such as the bytecode interpreter) use this
+  // to avoid marshaling through the packed ABI buffers. The function must
+  // behave identically to |target| called through |shim|.
+  iree_vm_native_function_register_target_t register_target;
 } iree_vm_native_function_ptr_t;
 
 // Describes a native module implementation by way of descriptor tables.
@@ -146,6 +226,53 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
     iree_vm_instance_t* instance, iree_allocator_t allocator,
     iree_vm_module_t* module);
 
+// A resolved direct-call target for a native module export.
+// Callers that marshal arguments and results per the function calling
+// convention themselves (such as the bytecode interpreter after verifying its
+// import signatures) can use this to call the function shim directly instead
+// of going through the module begin_call indirection on every call.
+//
+// Functions providing a register-call target can also be called with their
+// arguments and results in the caller registers via
+// iree_vm_native_module_begin_register_call.
+typedef struct iree_vm_native_function_direct_call_t {
+  // Shim function that takes the VM ABI and maps it to the target ABI.
+  // NULL if the function does not support direct calls.
+  iree_vm_native_function_shim_t shim;
+  // Target function passed to the shim.
+  iree_vm_native_function_target_t target;
+  // Optional target taking arguments and results in caller registers.
+  iree_vm_native_function_register_target_t register_target;
+  // Module self pointer passed to the shim.
+  void* module;
+} iree_vm_native_function_direct_call_t;
+
+// Resolves |function| to a direct-call target if it is an exported function of
+// a native module using the default begin_call implementation. Returns false
+// and zeroes |out_direct_call| if the function must be called with begin_call.
+// The resolved target is valid for the lifetime of the module.
+IREE_API_EXPORT bool iree_vm_native_module_resolve_direct_call(
+    const iree_vm_function_t* function,
+    iree_vm_native_function_direct_call_t* out_direct_call);
+
+// Begins a call to |function| using its resolved |direct_call| target.
+// Behaves the same as the module begin_call with the ABI |args_storage| and
+// |rets_storage| buffers matching the function calling convention. Deferred
+// calls are resumed with the module resume_call as usual.
+IREE_API_EXPORT iree_status_t iree_vm_native_module_begin_direct_call(
+    iree_vm_stack_t* stack, const iree_vm_function_t* function,
+    const iree_vm_native_function_direct_call_t* direct_call,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage);
+
+// Calls |function| using the register-call target of its resolved
+// |direct_call| with arguments and results in the caller registers of |call|.
+// No stack frame is entered for the call and the caller registers remain valid
+// upon return. Must only be used when |direct_call| has a register_target.
+IREE_API_EXPORT iree_status_t iree_vm_native_module_begin_register_call(
+    iree_vm_stack_t* stack, const iree_vm_function_t* function,
+    const iree_vm_native_function_direct_call_t* direct_call,
+    const iree_vm_native_register_call_t* call);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
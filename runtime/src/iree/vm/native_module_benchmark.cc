@@ -4,6 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cstring>
+
 #include "benchmark/benchmark.h"
 #include "iree/base/api.h"
 #include "iree/vm/module.h"
@@ -13,6 +15,125 @@
 
 namespace {
 
-// TODO(benvanik): native module benchmarks.
+// Shared setup for calling module_a.add_1 from native_module_test.h.
+struct NativeCallFixture {
+  NativeCallFixture() {
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance));
+    IREE_CHECK_OK(module_a_create(instance, iree_allocator_system(), &module));
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance, IREE_VM_CONTEXT_FLAG_NONE, 1, &module,
+        iree_allocator_system(), &context));
+    IREE_CHECK_OK(iree_vm_module_lookup_function_by_name(
+        module, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("add_1"),
+        &function));
+  }
+  ~NativeCallFixture() {
+    iree_vm_context_release(context);
+    iree_vm_module_release(module);
+    iree_vm_instance_release(instance);
+  }
+  iree_vm_instance_t* instance = nullptr;
+  iree_vm_module_t* module = nullptr;
+  iree_vm_context_t* context = nullptr;
+  iree_vm_function_t function;
+};
+
+// Calls the target function directly as a baseline for the VM ABI overhead.
+static void BM_NativeCallReference(benchmark::State& state) {
+  int32_t value = 0;
+  while (state.KeepRunning()) {
+    IREE_CHECK_OK(module_a_add_1(nullptr, nullptr, nullptr, value, &value));
+    benchmark::DoNotOptimize(value);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_NativeCallReference);
+
+// Calls through the module begin_call as any caller of the VM ABI would.
+static void BM_NativeCallBeginCall(benchmark::State& state) {
+  NativeCallFixture fixture;
+  IREE_VM_INLINE_STACK_INITIALIZE(
+      stack, IREE_VM_INVOCATION_FLAG_NONE,
+      iree_vm_context_state_resolver(fixture.context), iree_allocator_system());
+  int32_t arg = 0;
+  int32_t ret = 0;
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = fixture.function;
+  call.arguments = iree_make_byte_span(&arg, sizeof(arg));
+  call.results = iree_make_byte_span(&ret, sizeof(ret));
+  while (state.KeepRunning()) {
+    IREE_CHECK_OK(fixture.module->begin_call(fixture.module->self, stack,
+                                             call));
+    arg = ret;
+    benchmark::DoNotOptimize(ret);
+  }
+  iree_vm_stack_deinitialize(stack);
+}
+BENCHMARK(BM_NativeCallBeginCall);
+
+// Calls through the direct-call target as the bytecode interpreter does for
+// imports resolved to native module exports. Arguments are packed the same as
+// with begin_call so the difference is only the dispatch overhead.
+static void BM_NativeCallDirect(benchmark::State& state) {
+  NativeCallFixture fixture;
+  iree_vm_native_function_direct_call_t direct_call;
+  if (!iree_vm_native_module_resolve_direct_call(&fixture.function,
+                                                 &direct_call)) {
+    state.SkipWithError("function does not support direct calls");
+    return;
+  }
+  IREE_VM_INLINE_STACK_INITIALIZE(
+      stack, IREE_VM_INVOCATION_FLAG_NONE,
+      iree_vm_context_state_resolver(fixture.context), iree_allocator_system());
+  int32_t arg = 0;
+  int32_t ret = 0;
+  while (state.KeepRunning()) {
+    IREE_CHECK_OK(iree_vm_native_module_begin_direct_call(
+        stack, &fixture.function, &direct_call,
+        iree_make_byte_span(&arg, sizeof(arg)),
+        iree_make_byte_span(&ret, sizeof(ret))));
+    arg = ret;
+    benchmark::DoNotOptimize(ret);
+  }
+  iree_vm_stack_deinitialize(stack);
+}
+BENCHMARK(BM_NativeCallDirect);
+
+// Calls through the register-call target with arguments and results in a
+// caller register file as the bytecode interpreter does when available. No
+// marshaling or stack frame is required.
+static void BM_NativeCallRegister(benchmark::State& state) {
+  NativeCallFixture fixture;
+  iree_vm_native_function_direct_call_t direct_call;
+  if (!iree_vm_native_module_resolve_direct_call(&fixture.function,
+                                                 &direct_call) ||
+      !direct_call.register_target) {
+    state.SkipWithError("function does not support register calls");
+    return;
+  }
+  IREE_VM_INLINE_STACK_INITIALIZE(
+      stack, IREE_VM_INVOCATION_FLAG_NONE,
+      iree_vm_context_state_resolver(fixture.context), iree_allocator_system());
+  int32_t registers[2] = {0, 0};
+  struct {
+    uint16_t size;
+    uint16_t registers[1];
+  } arguments = {1, {0}}, results = {1, {1}};
+  iree_vm_native_register_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.i32 = registers;
+  call.arguments = (const iree_vm_register_list_t*)&arguments;
+  call.results = (const iree_vm_register_list_t*)&results;
+  while (state.KeepRunning()) {
+    IREE_CHECK_OK(iree_vm_native_module_begin_register_call(
+        stack, &fixture.function, &direct_call, &call));
+    registers[0] = registers[1];
+    benchmark::DoNotOptimize(registers[1]);
+  }
+  iree_vm_stack_deinitialize(stack);
+}
+BENCHMARK(BM_NativeCallRegister);
 
 }  // namespace
@@ -15,7 +15,9 @@
 #include "iree/vm/instance.h"
 #include "iree/vm/invocation.h"
 #include "iree/vm/list.h"
+#include "iree/vm/native_module.h"
 #include "iree/vm/ref.h"
+#include "iree/vm/stack.h"
 #include "iree/vm/value.h"
 
 namespace iree {
@@ -111,5 +113,60 @@ TEST_F(VMNativeModuleTest, Example) {
   ASSERT_EQ(v2, 8);
 }
 
+// Tests calling module_a.add_1 through its register-call target with a caller
+// register file as the bytecode interpreter does for imports.
+TEST(VMNativeModuleRegisterCallTest, AddOne) {
+  iree_vm_instance_t* instance = nullptr;
+  IREE_ASSERT_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                         iree_allocator_system(), &instance));
+  iree_vm_module_t* module = nullptr;
+  IREE_ASSERT_OK(module_a_create(instance, iree_allocator_system(), &module));
+  iree_vm_context_t* context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, 1, &module, iree_allocator_system(),
+      &context));
+
+  // add_1 provides a register-call target while sub_1 does not.
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      module, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("sub_1"), &function));
+  iree_vm_native_function_direct_call_t direct_call;
+  ASSERT_TRUE(iree_vm_native_module_resolve_direct_call(&function,
+                                                        &direct_call));
+  EXPECT_EQ(direct_call.register_target, nullptr);
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      module, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("add_1"), &function));
+  ASSERT_TRUE(iree_vm_native_module_resolve_direct_call(&function,
+                                                        &direct_call));
+  ASSERT_NE(direct_call.register_target, nullptr);
+
+  // Argument in register 2 and result in register 5 of the caller.
+  int32_t i32_registers[8] = {0};
+  i32_registers[2] = 41;
+  struct {
+    uint16_t size;
+    uint16_t registers[1];
+  } arguments = {1, {2}}, results = {1, {5}};
+  iree_vm_native_register_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.i32 = i32_registers;
+  call.arguments = (const iree_vm_register_list_t*)&arguments;
+  call.results = (const iree_vm_register_list_t*)&results;
+
+  IREE_VM_INLINE_STACK_INITIALIZE(
+      stack, IREE_VM_INVOCATION_FLAG_NONE,
+      iree_vm_context_state_resolver(context), iree_allocator_system());
+  IREE_EXPECT_OK(iree_vm_native_module_begin_register_call(
+      stack, &function, &direct_call, &call));
+  EXPECT_EQ(iree_vm_stack_current_frame(stack), nullptr);
+  iree_vm_stack_deinitialize(stack);
+  EXPECT_EQ(i32_registers[2], 41);
+  EXPECT_EQ(i32_registers[5], 42);
+
+  iree_vm_context_release(context);
+  iree_vm_module_release(module);
+  iree_vm_instance_release(instance);
+}
+
 }  // namespace
 }  // namespace iree
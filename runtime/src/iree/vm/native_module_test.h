@@ -86,6 +86,18 @@ static iree_status_t module_a_add_1(iree_vm_stack_t* stack, module_a_t* module,
   return iree_ok_status();
 }
 
+// Register-call variant of module_a.add_1.
+// Callers with a register file (like the bytecode interpreter) can use this to
+// pass arguments and results in place instead of marshaling them through the
+// packed ABI buffers the shim expects.
+static iree_status_t module_a_add_1_registers(
+    iree_vm_stack_t* stack, module_a_t* module, module_a_state_t* module_state,
+    const iree_vm_native_register_call_t* call) {
+  int32_t arg0 = iree_vm_native_register_call_arg_i32(call, 0);
+  iree_vm_native_register_call_set_i32(call, 0, arg0 + 1);
+  return iree_ok_status();
+}
+
 // vm.import private @module_a.sub_1(%arg0 : i32) -> i32
 static iree_status_t module_a_sub_1(iree_vm_stack_t* stack, module_a_t* module,
                                     module_a_state_t* module_state,
@@ -101,9 +113,10 @@ static const iree_vm_native_export_descriptor_t module_a_exports_[] = {
 };
 static const iree_vm_native_function_ptr_t module_a_funcs_[] = {
     {(iree_vm_native_function_shim_t)call_shim_i32_i32,
-     (iree_vm_native_function_target_t)module_a_add_1},
+     (iree_vm_native_function_target_t)module_a_add_1,
+     (iree_vm_native_function_register_target_t)module_a_add_1_registers},
     {(iree_vm_native_function_shim_t)call_shim_i32_i32,
-     (iree_vm_native_function_target_t)module_a_sub_1},
+     (iree_vm_native_function_target_t)module_a_sub_1, NULL},
 };
 static_assert(IREE_ARRAYSIZE(module_a_funcs_) ==
                   IREE_ARRAYSIZE(module_a_exports_),
@@ -240,7 +253,7 @@ static iree_status_t module_b_entry(iree_vm_stack_t* stack, module_b_t* module,
 // on versions, access rights, etc.
 static const iree_vm_native_function_ptr_t module_b_funcs_[] = {
     {(iree_vm_native_function_shim_t)call_shim_i32_i32,
-     (iree_vm_native_function_target_t)module_b_entry},
+     (iree_vm_native_function_target_t)module_b_entry, NULL},
 };
 
 static const iree_vm_native_import_descriptor_t module_b_imports_[] = {
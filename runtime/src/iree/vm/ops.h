@@ -224,6 +224,72 @@ static inline iree_status_t vm_buffer_store_i64(iree_vm_buffer_t* buffer,
   return iree_ok_status();
 }
 
+//===------------------------------------------------------------------===//
+// Lists
+//===------------------------------------------------------------------===//
+
+// Returns the value type and storage size of the primitive elements of |list|.
+static inline iree_status_t vm_list_query_value_type(
+    const iree_vm_list_t* list, iree_vm_value_type_t* out_value_type,
+    iree_host_size_t* out_value_size) {
+  iree_vm_type_def_t element_type = iree_vm_list_element_type(list);
+  if (IREE_UNLIKELY(!iree_vm_type_def_is_value(element_type))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "list must have a primitive element type");
+  }
+  *out_value_type = iree_vm_type_def_as_value(element_type);
+  switch (*out_value_type) {
+    case IREE_VM_VALUE_TYPE_I8:
+      *out_value_size = 1;
+      break;
+    case IREE_VM_VALUE_TYPE_I16:
+      *out_value_size = 2;
+      break;
+    case IREE_VM_VALUE_TYPE_I32:
+    case IREE_VM_VALUE_TYPE_F32:
+      *out_value_size = 4;
+      break;
+    case IREE_VM_VALUE_TYPE_I64:
+    case IREE_VM_VALUE_TYPE_F64:
+      *out_value_size = 8;
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unsupported list element type");
+  }
+  return iree_ok_status();
+}
+
+static inline iree_status_t vm_list_copy_to_buffer(
+    const iree_vm_list_t* source_list, iree_host_size_t source_index,
+    iree_vm_buffer_t* target_buffer, iree_host_size_t target_offset,
+    iree_host_size_t count) {
+  iree_vm_value_type_t value_type = IREE_VM_VALUE_TYPE_NONE;
+  iree_host_size_t value_size = 0;
+  IREE_RETURN_IF_ERROR(
+      vm_list_query_value_type(source_list, &value_type, &value_size));
+  iree_byte_span_t target_span = iree_byte_span_empty();
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_map_rw(
+      target_buffer, target_offset, count * value_size, 1, &target_span));
+  return iree_vm_list_get_values(source_list, source_index, count, value_type,
+                                 target_span.data);
+}
+
+static inline iree_status_t vm_list_copy_from_buffer(
+    const iree_vm_buffer_t* source_buffer, iree_host_size_t source_offset,
+    iree_vm_list_t* target_list, iree_host_size_t target_index,
+    iree_host_size_t count) {
+  iree_vm_value_type_t value_type = IREE_VM_VALUE_TYPE_NONE;
+  iree_host_size_t value_size = 0;
+  IREE_RETURN_IF_ERROR(
+      vm_list_query_value_type(target_list, &value_type, &value_size));
+  iree_const_byte_span_t source_span = iree_const_byte_span_empty();
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_map_ro(
+      source_buffer, source_offset, count * value_size, 1, &source_span));
+  return iree_vm_list_set_values(target_list, target_index, count, value_type,
+                                 source_span.data);
+}
+
 //===------------------------------------------------------------------===//
 // Conditional assignment
 //===------------------------------------------------------------------===//
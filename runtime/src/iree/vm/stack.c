@@ -14,6 +14,138 @@
 #include "iree/base/api.h"
 #include "iree/vm/module.h"
 
+//===----------------------------------------------------------------------===//
+// iree_vm_invocation_arena_t
+//===----------------------------------------------------------------------===//
+
+// Header prefixed to each arena allocation recording its size so that
+// reallocations can copy the original contents. Sized to preserve the
+// alignment of the arena allocations.
+typedef union iree_vm_invocation_arena_header_t {
+  iree_host_size_t byte_length;
+  uint8_t alignment[iree_max_align_t];
+} iree_vm_invocation_arena_header_t;
+
+IREE_API_EXPORT void iree_vm_invocation_arena_initialize(
+    iree_arena_block_pool_t* block_pool,
+    iree_vm_invocation_arena_t* out_arena) {
+  iree_arena_initialize(block_pool, &out_arena->arena);
+  iree_atomic_store_int64(&out_arena->live_count, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&out_arena->is_attached, 0,
+                          iree_memory_order_relaxed);
+}
+
+// Returns FAILED_PRECONDITION if the memory of |arena| may still be in use.
+static iree_status_t iree_vm_invocation_arena_check_idle(
+    iree_vm_invocation_arena_t* arena) {
+  if (IREE_UNLIKELY(iree_atomic_load_int32(&arena->is_attached,
+                                           iree_memory_order_acquire))) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "invocation arena is attached to a stack; the invocation using it must "
+        "complete first");
+  }
+  // Acquire pairs with the release in frees so that all uses of the objects
+  // happen before their memory is reused.
+  const int64_t live_count =
+      iree_atomic_load_int64(&arena->live_count, iree_memory_order_acquire);
+  if (IREE_UNLIKELY(live_count > 0)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "%" PRId64
+                            " objects allocated from the invocation arena are "
+                            "still live; results must be released first",
+                            live_count);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_arena_deinitialize(iree_vm_invocation_arena_t* arena) {
+  IREE_RETURN_IF_ERROR(iree_vm_invocation_arena_check_idle(arena));
+  iree_arena_deinitialize(&arena->arena);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_arena_reset(iree_vm_invocation_arena_t* arena) {
+  IREE_RETURN_IF_ERROR(iree_vm_invocation_arena_check_idle(arena));
+  iree_arena_reset(&arena->arena);
+  return iree_ok_status();
+}
+
+// Allocates |byte_length| bytes with a size header from |arena|.
+static iree_status_t iree_vm_invocation_arena_allocate(
+    iree_vm_invocation_arena_t* arena, iree_host_size_t byte_length,
+    void** out_ptr) {
+  iree_vm_invocation_arena_header_t* header = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &arena->arena, sizeof(*header) + byte_length, (void**)&header));
+  header->byte_length = byte_length;
+  *out_ptr = header + 1;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_invocation_arena_ctl(
+    void* self, iree_allocator_command_t command, const void* params,
+    void** inout_ptr) {
+  iree_vm_invocation_arena_t* arena = (iree_vm_invocation_arena_t*)self;
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC: {
+      iree_host_size_t byte_length =
+          ((const iree_allocator_alloc_params_t*)params)->byte_length;
+      IREE_RETURN_IF_ERROR(
+          iree_vm_invocation_arena_allocate(arena, byte_length, inout_ptr));
+      if (command == IREE_ALLOCATOR_COMMAND_CALLOC) {
+        memset(*inout_ptr, 0, byte_length);
+      }
+      iree_atomic_fetch_add_int64(&arena->live_count, 1,
+                                  iree_memory_order_relaxed);
+      return iree_ok_status();
+    }
+    case IREE_ALLOCATOR_COMMAND_REALLOC: {
+      iree_host_size_t byte_length =
+          ((const iree_allocator_alloc_params_t*)params)->byte_length;
+      void* old_ptr = *inout_ptr;
+      if (!old_ptr) {
+        IREE_RETURN_IF_ERROR(
+            iree_vm_invocation_arena_allocate(arena, byte_length, inout_ptr));
+        iree_atomic_fetch_add_int64(&arena->live_count, 1,
+                                    iree_memory_order_relaxed);
+        return iree_ok_status();
+      }
+      iree_host_size_t old_byte_length =
+          ((iree_vm_invocation_arena_header_t*)old_ptr - 1)->byte_length;
+      if (byte_length <= old_byte_length) return iree_ok_status();
+      // The old allocation is abandoned in the arena until reset.
+      void* new_ptr = NULL;
+      IREE_RETURN_IF_ERROR(
+          iree_vm_invocation_arena_allocate(arena, byte_length, &new_ptr));
+      memcpy(new_ptr, old_ptr, old_byte_length);
+      *inout_ptr = new_ptr;
+      return iree_ok_status();
+    }
+    case IREE_ALLOCATOR_COMMAND_FREE: {
+      // Memory is reclaimed when the arena is reset.
+      iree_atomic_fetch_sub_int64(&arena->live_count, 1,
+                                  iree_memory_order_release);
+      return iree_ok_status();
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported invocation arena command");
+  }
+}
+
+IREE_API_EXPORT iree_allocator_t
+iree_vm_invocation_arena_allocator(iree_vm_invocation_arena_t* arena) {
+  iree_allocator_t allocator = {
+      .self = arena,
+      .ctl = iree_vm_invocation_arena_ctl,
+  };
+  return allocator;
+}
+
 //===----------------------------------------------------------------------===//
 // Stack implementation
 //===----------------------------------------------------------------------===//
@@ -180,6 +312,9 @@ struct iree_vm_stack_t {
   // Allocator used for dynamic stack allocations. May be the null allocator
   // if growth is prohibited.
   iree_allocator_t allocator;
+
+  // Optional arena used for VM objects created by the invocation.
+  iree_vm_invocation_arena_t* arena;
 };
 
 //===----------------------------------------------------------------------===//
@@ -239,6 +374,9 @@ IREE_API_EXPORT void iree_vm_stack_deinitialize(iree_vm_stack_t* stack) {
   // Release stack frame resources.
   iree_vm_stack_reset(stack);
 
+  // Detach the arena so that it may be reset or used by another invocation.
+  iree_status_ignore(iree_vm_stack_set_arena(stack, NULL));
+
   // Drop allocated frame storage.
   if (stack->owns_frame_storage) {
     iree_allocator_free(stack->allocator, stack->frame_storage);
@@ -286,6 +424,34 @@ iree_vm_stack_allocator(const iree_vm_stack_t* stack) {
   return stack->allocator;
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_stack_set_arena(
+    iree_vm_stack_t* stack, iree_vm_invocation_arena_t* arena) {
+  if (arena == stack->arena) return iree_ok_status();
+  if (arena) {
+    int32_t expected = 0;
+    if (!iree_atomic_compare_exchange_strong_int32(
+            &arena->is_attached, &expected, 1, iree_memory_order_acquire,
+            iree_memory_order_relaxed)) {
+      return iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "invocation arena is in use by another invocation; arenas must not "
+          "be shared by concurrent invocations");
+    }
+  }
+  if (stack->arena) {
+    iree_atomic_store_int32(&stack->arena->is_attached, 0,
+                            iree_memory_order_release);
+  }
+  stack->arena = arena;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_allocator_t iree_vm_stack_object_allocator(
+    const iree_vm_stack_t* stack, iree_allocator_t default_allocator) {
+  return stack->arena ? iree_vm_invocation_arena_allocator(stack->arena)
+                      : default_allocator;
+}
+
 IREE_API_EXPORT iree_vm_invocation_flags_t
 iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack) {
   return stack->flags;
@@ -11,6 +11,8 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/vm/module.h"
 #include "iree/vm/ref.h"
 
@@ -161,6 +163,58 @@ typedef struct iree_vm_state_resolver_t {
       iree_vm_module_state_t** out_module_state);
 } iree_vm_state_resolver_t;
 
+// An arena for VM objects created during invocations, such as lists and
+// buffers allocated by programs and HAL buffer views and fences. Objects are
+// bump-allocated from blocks acquired from a shared block pool and all memory
+// is reclaimed at once when the arena is reset, avoiding per-object heap
+// allocations and allocator contention when invoking at high rates.
+//
+// Objects allocated from the arena must not outlive it: callers must release
+// any results before resetting the arena and programs must not store objects
+// created during the invocation in module globals. Objects are still released
+// as normal and iree_vm_invocation_arena_reset fails if any remain live.
+//
+// Thread-compatible; an arena must not be shared by concurrent invocations.
+// Only one stack may have the arena attached at a time and
+// iree_vm_stack_set_arena fails if another invocation is still using it. Arenas
+// on multiple threads may share the same block pool and objects allocated from
+// the arena may be released from any thread.
+typedef struct iree_vm_invocation_arena_t {
+  // Underlying bump-pointer allocator.
+  iree_arena_allocator_t arena;
+  // Number of allocations made from the arena that have not been freed.
+  // Atomic as objects (such as HAL resources retained by asynchronous work)
+  // may be released on other threads.
+  iree_atomic_int64_t live_count;
+  // 1 while the arena is attached to a stack and otherwise 0.
+  iree_atomic_int32_t is_attached;
+} iree_vm_invocation_arena_t;
+
+// Initializes |out_arena| to acquire blocks from |block_pool|.
+IREE_API_EXPORT void iree_vm_invocation_arena_initialize(
+    iree_arena_block_pool_t* block_pool, iree_vm_invocation_arena_t* out_arena);
+
+// Deinitializes |arena| and returns all blocks to the pool.
+// Fails with IREE_STATUS_FAILED_PRECONDITION and leaves the arena unchanged if
+// any objects allocated from the arena are still live or it is attached to a
+// stack. Callers that cannot wait for the objects to be released must leak the
+// arena (and its block pool) instead of freeing the memory under them.
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_arena_deinitialize(iree_vm_invocation_arena_t* arena);
+
+// Resets |arena| and returns all blocks to the pool for reuse.
+// Fails with IREE_STATUS_FAILED_PRECONDITION and leaves the arena unchanged if
+// any objects allocated from the arena are still live or it is attached to a
+// stack.
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_arena_reset(iree_vm_invocation_arena_t* arena);
+
+// Returns an allocator that allocates from |arena|.
+// Unlike the base arena allocator this supports reallocation (as used by
+// growing lists) and tracks live allocations.
+IREE_API_EXPORT iree_allocator_t
+iree_vm_invocation_arena_allocator(iree_vm_invocation_arena_t* arena);
+
 // A fiber stack used for storing stack frame state during execution.
 // All required state is stored within the stack and no host thread-local state
 // is used allowing us to execute multiple fibers on the same host thread.
@@ -243,6 +297,21 @@ IREE_API_EXPORT void iree_vm_stack_free(iree_vm_stack_t* stack);
 IREE_API_EXPORT iree_allocator_t
 iree_vm_stack_allocator(const iree_vm_stack_t* stack);
 
+// Sets the optional invocation |arena| used for VM objects created by the
+// invocation running on |stack|. The arena must remain valid until the stack is
+// deinitialized and all objects allocated from it have been released.
+// The arena is detached when the stack is deinitialized or another arena (or
+// NULL) is set. Fails with IREE_STATUS_FAILED_PRECONDITION if |arena| is
+// already attached to another stack.
+IREE_API_EXPORT iree_status_t iree_vm_stack_set_arena(
+    iree_vm_stack_t* stack, iree_vm_invocation_arena_t* arena);
+
+// Returns the allocator that VM objects created by the invocation running on
+// |stack| should be allocated from. This is the invocation arena if one was set
+// and otherwise |default_allocator| (usually the module state allocator).
+IREE_API_EXPORT iree_allocator_t iree_vm_stack_object_allocator(
+    const iree_vm_stack_t* stack, iree_allocator_t default_allocator);
+
 // Returns the flags controlling the invocation this stack is used with.
 IREE_API_EXPORT iree_vm_invocation_flags_t
 iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack);
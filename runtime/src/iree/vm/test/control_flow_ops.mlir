@@ -124,6 +124,31 @@ vm.module @control_flow_ops {
     vm.return
   }
 
+  // The bytecode encoder fuses the compare into the cond_br and the call into
+  // the br that consumes its result.
+  vm.export @test_cond_br_cmp_loop
+  vm.func @test_cond_br_cmp_loop() {
+    %c0 = vm.const.i32 0
+    %c5 = vm.const.i32 5
+    %c5dno = util.optimization_barrier %c5 : i32
+    vm.br ^check(%c0 : i32)
+  ^check(%i : i32):
+    %cmp = vm.cmp.lt.i32.s %i, %c5dno : i32
+    vm.cond_br %cmp, ^loop, ^exit
+  ^loop:
+    %next = vm.call @_increment(%i) : (i32) -> i32
+    vm.br ^check(%next : i32)
+  ^exit:
+    vm.check.eq %i, %c5dno, "error!" : i32
+    vm.return
+  }
+
+  vm.func private @_increment(%arg0 : i32) -> i32 attributes {inlining_policy = #util.inline.never} {
+    %c1 = vm.const.i32 1
+    %0 = vm.add.i32 %arg0, %c1 : i32
+    vm.return %0 : i32
+  }
+
   vm.export @test_br_table_inbounds
   vm.func private @test_br_table_inbounds() {
     %c0 = vm.const.i32 0
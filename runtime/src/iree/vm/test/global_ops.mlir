@@ -6,6 +6,7 @@ vm.module @global_ops {
 
   vm.global.i32 private @c42 = 42 : i32
   vm.global.i32 private mutable @c107_mut = 107 : i32
+  vm.global.i32 private mutable @c10_mut = 10 : i32
   vm.global.ref mutable @g0 : !vm.buffer
 
   vm.rodata private @buffer dense<[1, 2, 3]> : tensor<3xi8>
@@ -36,6 +37,21 @@ vm.module @global_ops {
     vm.return
   }
 
+  // The bytecode encoder fuses the load-add-store sequence into a single op.
+  vm.export @test_global_add_i32
+  vm.func @test_global_add_i32() {
+    %c5 = vm.const.i32 5
+    %c5dno = util.optimization_barrier %c5 : i32
+    %0 = vm.global.load.i32 @c10_mut : i32
+    %1 = vm.add.i32 %0, %c5dno : i32
+    vm.global.store.i32 %1, @c10_mut : i32
+    %actual = vm.global.load.i32 @c10_mut : i32
+    %c15 = vm.const.i32 15
+    vm.check.eq %1, %c15, "sum != 15" : i32
+    vm.check.eq %actual, %c15, "@c10_mut != 15" : i32
+    vm.return
+  }
+
   vm.export @test_global_store_ref
   vm.func @test_global_store_ref() {
     %ref_buffer = vm.const.ref.rodata @buffer : !vm.buffer
@@ -6,6 +6,7 @@ vm.module @global_ops_i64 {
 
   vm.global.i64 private @c42 = 42 : i64
   vm.global.i64 private mutable @c107_mut = 107 : i64
+  vm.global.i64 private mutable @c10_mut = 10 : i64
 
   vm.export @test_global_load_i64
   vm.func @test_global_load_i64() {
@@ -24,4 +25,19 @@ vm.module @global_ops_i64 {
     vm.return
   }
 
+  // The bytecode encoder fuses the load-add-store sequence into a single op.
+  vm.export @test_global_add_i64
+  vm.func @test_global_add_i64() {
+    %c5 = vm.const.i64 5
+    %c5dno = util.optimization_barrier %c5 : i64
+    %0 = vm.global.load.i64 @c10_mut : i64
+    %1 = vm.add.i64 %c5dno, %0 : i64
+    vm.global.store.i64 %1, @c10_mut : i64
+    %actual = vm.global.load.i64 @c10_mut : i64
+    %c15 = vm.const.i64 15
+    vm.check.eq %1, %c15, "sum != 15" : i64
+    vm.check.eq %actual, %c15, "@c10_mut != 15" : i64
+    vm.return
+  }
+
 }
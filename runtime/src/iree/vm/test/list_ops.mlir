@@ -88,6 +88,64 @@ vm.module @list_ops {
     vm.return
   }
 
+  //===--------------------------------------------------------------------===//
+  // Bulk copies to and from buffers
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_copy_to_buffer
+  vm.func @test_copy_to_buffer() {
+    %c1 = vm.const.i32 1
+    %c2 = vm.const.i32 2
+    %c3 = vm.const.i32 3
+    %c27 = vm.const.i32 27
+    %c42 = vm.const.i32 42
+    %c1_i64 = vm.const.i64 1
+    %c2_i64 = vm.const.i64 2
+    %c4_i64 = vm.const.i64 4
+    %c16_i64 = vm.const.i64 16
+    %list = vm.list.alloc %c3 : (i32) -> !vm.list<i32>
+    vm.list.resize %list, %c3 : (!vm.list<i32>, i32)
+    vm.list.set.i32 %list, %c1, %c27 : (!vm.list<i32>, i32, i32)
+    vm.list.set.i32 %list, %c2, %c42 : (!vm.list<i32>, i32, i32)
+    %buf = vm.buffer.alloc %c16_i64, %c1 : !vm.buffer
+    // Copy list elements [1, 3) to byte offset 4 (buffer elements [1, 3)).
+    vm.list.copy.to.buffer %list, %c1, %buf, %c4_i64, %c2 : !vm.list<i32> -> !vm.buffer
+    %buf_dno = util.optimization_barrier %buf : !vm.buffer
+    %v1 = vm.buffer.load.i32 %buf_dno[%c1_i64] : !vm.buffer -> i32
+    vm.check.eq %v1, %c27, "buffer[1]=27" : i32
+    %v2 = vm.buffer.load.i32 %buf_dno[%c2_i64] : !vm.buffer -> i32
+    vm.check.eq %v2, %c42, "buffer[2]=42" : i32
+    vm.return
+  }
+
+  vm.export @test_copy_from_buffer
+  vm.func @test_copy_from_buffer() {
+    %c0 = vm.const.i32 0
+    %c1 = vm.const.i32 1
+    %c2 = vm.const.i32 2
+    %c3 = vm.const.i32 3
+    %c27 = vm.const.i32 27
+    %c42 = vm.const.i32 42
+    %c0_i64 = vm.const.i64 0
+    %c1_i64 = vm.const.i64 1
+    %c8_i64 = vm.const.i64 8
+    %buf = vm.buffer.alloc %c8_i64, %c1 : !vm.buffer
+    vm.buffer.store.i32 %c27, %buf[%c0_i64] : i32 -> !vm.buffer
+    vm.buffer.store.i32 %c42, %buf[%c1_i64] : i32 -> !vm.buffer
+    %list = vm.list.alloc %c3 : (i32) -> !vm.list<i32>
+    vm.list.resize %list, %c3 : (!vm.list<i32>, i32)
+    // Copy both buffer elements into list elements [1, 3).
+    vm.list.copy.from.buffer %buf, %c0_i64, %list, %c1, %c2 : !vm.buffer -> !vm.list<i32>
+    %list_dno = util.optimization_barrier %list : !vm.list<i32>
+    %v0 = vm.list.get.i32 %list_dno, %c0 : (!vm.list<i32>, i32) -> i32
+    vm.check.eq %v0, %c0, "list[0]=0" : i32
+    %v1 = vm.list.get.i32 %list_dno, %c1 : (!vm.list<i32>, i32) -> i32
+    vm.check.eq %v1, %c27, "list[1]=27" : i32
+    %v2 = vm.list.get.i32 %list_dno, %c2 : (!vm.list<i32>, i32) -> i32
+    vm.check.eq %v2, %c42, "list[2]=42" : i32
+    vm.return
+  }
+
   //===--------------------------------------------------------------------===//
   // Failure tests
   //===--------------------------------------------------------------------===//
@@ -113,6 +171,20 @@ vm.module @list_ops {
     vm.return
   }
 
+  vm.export @fail_copy_to_buffer_out_of_bounds
+  vm.func @fail_copy_to_buffer_out_of_bounds() {
+    %c0 = vm.const.i32 0
+    %c1 = vm.const.i32 1
+    %c2 = vm.const.i32 2
+    %c0_i64 = vm.const.i64 0
+    %c8_i64 = vm.const.i64 8
+    %list = vm.list.alloc %c1 : (i32) -> !vm.list<i32>
+    vm.list.resize %list, %c1 : (!vm.list<i32>, i32)
+    %buf = vm.buffer.alloc %c8_i64, %c1 : !vm.buffer
+    vm.list.copy.to.buffer %list, %c0, %buf, %c0_i64, %c2 : !vm.list<i32> -> !vm.buffer
+    vm.return
+  }
+
   vm.export @fail_out_of_bounds_write
   vm.func @fail_out_of_bounds_write() {
     %c1 = vm.const.i32 1
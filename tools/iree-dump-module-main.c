@@ -379,9 +379,117 @@ static void iree_tooling_print_function_descriptors(
   }
 }
 
+IREE_FLAG(string, profile_file, "",
+          "Execution profile written by `iree-run-module "
+          "--module_profile_file=`\n"
+          "used to annotate --output=metadata with call and block counts.");
+
+// Consumes the next space-separated token from |line|.
+static iree_string_view_t iree_tooling_consume_profile_token(
+    iree_string_view_t* line) {
+  iree_string_view_t token = iree_string_view_empty();
+  iree_string_view_split(*line, ' ', &token, line);
+  return token;
+}
+
+// Prints the function, block, and import counters from the execution profile
+// in |profile_contents| that apply to the module named |module_name|. See
+// iree_vm_bytecode_module_append_profile for the profile format.
+static iree_status_t iree_tooling_print_module_profile(
+    iree_string_view_t profile_contents, iree_string_view_t module_name) {
+  iree_tooling_printf_section_header("Execution Profile");
+  fprintf(stdout, "\n");
+
+  bool in_module = false;
+  bool any_entries = false;
+  int64_t function_call_count = 0;
+  while (!iree_string_view_is_empty(profile_contents)) {
+    iree_string_view_t line = iree_string_view_empty();
+    iree_string_view_split(profile_contents, '\n', &line, &profile_contents);
+    line = iree_string_view_trim(line);
+    if (iree_string_view_is_empty(line)) continue;
+    iree_string_view_t kind = iree_tooling_consume_profile_token(&line);
+    if (iree_string_view_equal(kind, IREE_SV("module"))) {
+      in_module = iree_string_view_equal(line, module_name);
+      continue;
+    } else if (!in_module) {
+      continue;
+    }
+    iree_string_view_t ordinal_str = iree_tooling_consume_profile_token(&line);
+    uint32_t ordinal = 0;
+    if (!iree_string_view_atoi_uint32(ordinal_str, &ordinal)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "malformed profile ordinal '%.*s'",
+                              (int)ordinal_str.size, ordinal_str.data);
+    }
+    if (iree_string_view_equal(kind, IREE_SV("function"))) {
+      iree_string_view_t name = iree_tooling_consume_profile_token(&line);
+      if (!iree_string_view_atoi_int64(line, &function_call_count)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "malformed profile function %u", ordinal);
+      }
+      if (!any_entries) {
+        fprintf(stdout, "  # |      Calls | Name\n");
+        fprintf(stdout,
+                "----+------------+--------------------------------------\n");
+      }
+      fprintf(stdout, "%3u | %10" PRIi64 " | %.*s\n", ordinal,
+              function_call_count, (int)name.size, name.data);
+      any_entries = true;
+    } else if (iree_string_view_equal(kind, IREE_SV("block"))) {
+      iree_string_view_t pc_str = iree_tooling_consume_profile_token(&line);
+      iree_string_view_t count_str = iree_tooling_consume_profile_token(&line);
+      uint32_t block_pc = 0;
+      int64_t block_count = 0;
+      if (!iree_string_view_atoi_uint32(pc_str, &block_pc) ||
+          !iree_string_view_atoi_int64(count_str, &block_count)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "malformed profile block in function %u",
+                                ordinal);
+      }
+      fprintf(stdout, "    |            |   block %08X: %" PRIi64, block_pc,
+              block_count);
+      if (function_call_count > 0) {
+        fprintf(stdout, " (%.2f/call)",
+                (double)block_count / (double)function_call_count);
+      }
+      if (!iree_string_view_is_empty(line) &&
+          !iree_string_view_equal(line, IREE_SV("-"))) {
+        fprintf(stdout, " @ %.*s", (int)line.size, line.data);
+      }
+      fprintf(stdout, "\n");
+    } else if (iree_string_view_equal(kind, IREE_SV("import"))) {
+      iree_string_view_t name = iree_tooling_consume_profile_token(&line);
+      iree_string_view_t calls_str = iree_tooling_consume_profile_token(&line);
+      int64_t call_count = 0;
+      int64_t duration_ns = 0;
+      if (!iree_string_view_atoi_int64(calls_str, &call_count) ||
+          !iree_string_view_atoi_int64(line, &duration_ns)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "malformed profile import %u", ordinal);
+      }
+      fprintf(stdout, "import[%3u] %" PRIi64 " calls, %.3f ms total",
+              ordinal, call_count, duration_ns / 1000000.0);
+      if (call_count > 0) {
+        fprintf(stdout, ", %.3f us/call",
+                duration_ns / 1000.0 / (double)call_count);
+      }
+      fprintf(stdout, ": %.*s\n", (int)name.size, name.data);
+      any_entries = true;
+    }
+  }
+  if (!any_entries) {
+    fprintf(stdout, "(no profile entries for module '%.*s')\n",
+            (int)module_name.size, module_name.data);
+  }
+  fprintf(stdout, "\n");
+  return iree_ok_status();
+}
+
 static iree_status_t iree_tooling_dump_module_metadata(
     iree_const_byte_span_t flatbuffer_contents,
-    iree_const_byte_span_t rodata_contents) {
+    iree_const_byte_span_t rodata_contents,
+    iree_const_byte_span_t profile_contents) {
   iree_vm_BytecodeModuleDef_table_t module_def =
       iree_vm_BytecodeModuleDef_as_root(flatbuffer_contents.data);
 
@@ -484,6 +592,13 @@ static iree_status_t iree_tooling_dump_module_metadata(
 
   fprintf(stdout, "\n");
 
+  if (profile_contents.data_length > 0) {
+    IREE_RETURN_IF_ERROR(iree_tooling_print_module_profile(
+        iree_make_string_view((const char*)profile_contents.data,
+                              profile_contents.data_length),
+        iree_make_cstring_view(iree_vm_BytecodeModuleDef_name(module_def))));
+  }
+
   if (iree_vm_BytecodeModuleDef_debug_database_is_present(module_def)) {
     iree_tooling_printf_section_header("Debug Information");
     iree_vm_DebugDatabaseDef_table_t database_def =
@@ -589,10 +704,18 @@ int main(int argc, char** argv) {
                                 flatcc_verify_error_string(verify_ret));
     }
   }
+  iree_file_contents_t* profile_contents = NULL;
+  if (iree_status_is_ok(status) && strlen(FLAG_profile_file) > 0) {
+    status =
+        iree_file_read_contents(FLAG_profile_file, IREE_FILE_READ_FLAG_DEFAULT,
+                                host_allocator, &profile_contents);
+  }
   if (iree_status_is_ok(status)) {
     if (strcmp(FLAG_output, "metadata") == 0) {
-      status = iree_tooling_dump_module_metadata(flatbuffer_contents,
-                                                 rodata_contents);
+      status = iree_tooling_dump_module_metadata(
+          flatbuffer_contents, rodata_contents,
+          profile_contents ? profile_contents->const_buffer
+                           : iree_const_byte_span_empty());
     } else if (strcmp(FLAG_output, "flatbuffer-binary") == 0) {
       status = iree_tooling_dump_module_flatbuffer_binary(flatbuffer_contents);
     } else if (strcmp(FLAG_output, "flatbuffer-json") == 0) {
@@ -604,6 +727,7 @@ int main(int argc, char** argv) {
     }
   }
 
+  iree_file_contents_free(profile_contents);
   iree_file_contents_free(file_contents);
 
   fflush(stdout);